@@ -33,7 +33,8 @@ def main():
     all_sources = find_sources(src_dir)
     main_source = "src/main.cpp"
     lib_sources = [f"src/{s}" for s in all_sources if s != "main.cpp"]
-    test_sources = find_sources(test_dir)
+    # Benchmarks have their own main() and CMakeLists.txt
+    test_sources = [s for s in find_sources(test_dir) if not s.startswith("bench/")]
 
     config = {
         "project_name": "pyracms_server",
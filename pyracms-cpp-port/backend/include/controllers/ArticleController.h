@@ -2,6 +2,7 @@
 
 #include <drogon/HttpController.h>
 #include "services/ArticleService.h"
+#include "services/UserService.h"
 
 namespace pyracms {
 
@@ -23,6 +24,8 @@ public:
     ADD_METHOD_TO(ArticleController::publishArticle, "/api/articles/{name}/publish", drogon::Post, "pyracms::JwtAuthFilter");
     ADD_METHOD_TO(ArticleController::scheduleArticle, "/api/articles/{name}/schedule", drogon::Post, "pyracms::JwtAuthFilter");
     ADD_METHOD_TO(ArticleController::unpublishArticle, "/api/articles/{name}/unpublish", drogon::Post, "pyracms::JwtAuthFilter");
+    ADD_METHOD_TO(ArticleController::compactionStatus, "/api/admin/articles/revisions/compact", drogon::Get, "pyracms::JwtAuthFilter");
+    ADD_METHOD_TO(ArticleController::compactRevisions, "/api/admin/articles/revisions/compact", drogon::Post, "pyracms::JwtAuthFilter");
     METHOD_LIST_END
 
     void listArticles(const drogon::HttpRequestPtr &req,
@@ -85,8 +88,22 @@ public:
                           std::function<void(const drogon::HttpResponsePtr &)> &&callback,
                           const std::string &name);
 
+    // Conversion of stored revisions to snapshots and deltas; super admins
+    // only
+    void compactionStatus(const drogon::HttpRequestPtr &req,
+                          std::function<void(const drogon::HttpResponsePtr &)> &&callback);
+
+    void compactRevisions(const drogon::HttpRequestPtr &req,
+                          std::function<void(const drogon::HttpResponsePtr &)> &&callback);
+
 private:
+    // Runs next when the requester is a super admin, else responds 403
+    void requireSuperAdmin(const drogon::HttpRequestPtr &req,
+                           std::function<void(const drogon::HttpResponsePtr &)> callback,
+                           std::function<void()> next);
+
     ArticleService articleService_;
+    UserService userService_;
 };
 
 } // namespace pyracms
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <drogon/HttpController.h>
+
+namespace pyracms {
+
+class MetricsController : public drogon::HttpController<MetricsController> {
+public:
+    METHOD_LIST_BEGIN
+    ADD_METHOD_TO(MetricsController::metrics, "/metrics", drogon::Get);
+    METHOD_LIST_END
+
+    // Prometheus scrape endpoint: request metrics, event-loop lag and cache
+    // counters
+    void metrics(const drogon::HttpRequestPtr &req,
+                 std::function<void(const drogon::HttpResponsePtr &)> &&callback);
+};
+
+} // namespace pyracms
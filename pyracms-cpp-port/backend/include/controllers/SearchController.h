@@ -2,6 +2,7 @@
 
 #include <drogon/HttpController.h>
 #include "services/SearchService.h"
+#include "services/UserService.h"
 
 namespace pyracms {
 
@@ -10,6 +11,8 @@ public:
     METHOD_LIST_BEGIN
     ADD_METHOD_TO(SearchController::search, "/api/search", drogon::Get);
     ADD_METHOD_TO(SearchController::autocomplete, "/api/search/autocomplete", drogon::Get);
+    ADD_METHOD_TO(SearchController::reindexStatus, "/api/admin/search/reindex", drogon::Get, "pyracms::JwtAuthFilter");
+    ADD_METHOD_TO(SearchController::startReindex, "/api/admin/search/reindex", drogon::Post, "pyracms::JwtAuthFilter");
     METHOD_LIST_END
 
     void search(const drogon::HttpRequestPtr &req,
@@ -18,8 +21,21 @@ public:
     void autocomplete(const drogon::HttpRequestPtr &req,
                       std::function<void(const drogon::HttpResponsePtr &)> &&callback);
 
+    // Elasticsearch rebuilds; super admins only
+    void reindexStatus(const drogon::HttpRequestPtr &req,
+                       std::function<void(const drogon::HttpResponsePtr &)> &&callback);
+
+    void startReindex(const drogon::HttpRequestPtr &req,
+                      std::function<void(const drogon::HttpResponsePtr &)> &&callback);
+
 private:
+    // Runs next when the requester is a super admin, else responds 403
+    void requireSuperAdmin(const drogon::HttpRequestPtr &req,
+                           std::function<void(const drogon::HttpResponsePtr &)> callback,
+                           std::function<void()> next);
+
     SearchService searchService_;
+    UserService userService_;
 };
 
 } // namespace pyracms
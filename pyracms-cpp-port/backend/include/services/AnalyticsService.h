@@ -4,6 +4,7 @@
 #include <functional>
 #include <string>
 #include <vector>
+#include "SearchQueryAggregator.h"
 
 namespace pyracms {
 
@@ -49,12 +50,22 @@ public:
     void getTrafficSources(const DbClientPtr &db, int tenantId, int limit,
                            std::function<void(const std::vector<TrafficSource> &)> cb);
 
+    // Last 30 days from search_query_stats, most searched first
     void getSearchQueries(const DbClientPtr &db, int tenantId, int limit,
                           std::function<void(const std::vector<SearchQueryStat> &)> cb);
 
-    void recordSearchQuery(const DbClientPtr &db, int tenantId,
-                           const std::string &query, int resultCount, int userId,
-                           BoolCallback cb);
+    // Counts a search in the process-wide buffer; flushSearchQueries
+    // writes the counts out
+    static void recordSearchQuery(int tenantId, const std::string &query, int resultCount);
+
+    // Upserts everything buffered into search_query_stats, several rows
+    // per statement. Counts from a failed statement go back in the buffer.
+    static void flushSearchQueries(const DbClientPtr &db);
+
+    static const SearchQueryAggregator &searchQueryLog();
+
+private:
+    static SearchQueryAggregator &searchQueryBuffer();
 };
 
 } // namespace pyracms
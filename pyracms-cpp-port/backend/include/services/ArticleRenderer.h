@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace pyracms {
+
+// Turns a revision's text into the HTML served for it, by the article's
+// renderer, plus a plain-text summary for feeds and structured data.
+//
+// Markdown goes through MarkdownRenderer and html is taken as written;
+// both are then run through HtmlSanitizer. Renderers without a C++
+// implementation yet (bbcode, restructuredtext) are served as escaped
+// paragraphs of plain text.
+class ArticleRenderer {
+public:
+    // Bump when the output for the same input changes, so that stored
+    // renders are redone rather than served
+    static constexpr int kVersion = 1;
+
+    struct Output {
+        std::string html;
+        std::string summary;
+    };
+
+    // Lower-cased renderer name, "markdown" when empty
+    static std::string normalize(std::string_view renderer);
+
+    static Output render(std::string_view renderer, std::string_view content);
+
+    // Text of sanitized HTML with whitespace collapsed, cut at a word
+    // boundary to at most maxBytes plus an ellipsis
+    static std::string summarize(std::string_view html, size_t maxBytes = 300);
+};
+
+} // namespace pyracms
@@ -5,33 +5,12 @@
 #include <optional>
 #include <string>
 #include <vector>
+#include "ArticleTypes.h"
+#include "PageCursor.h"
+#include "RevisionStore.h"
 
 namespace pyracms {
 
-struct ArticleDto {
-    int id;
-    std::string name;
-    std::string displayName;
-    bool isPrivate;
-    bool hideDisplayName;
-    int userId;
-    std::string rendererName;
-    int viewCount;
-    std::string createdAt;
-    std::string status;       // draft, scheduled, published, unpublished
-    std::string publishedAt;
-    std::string scheduledAt;
-};
-
-struct ArticleRevisionDto {
-    int id;
-    int articleId;
-    std::string content;
-    std::string summary;
-    int userId;
-    std::string createdAt;
-};
-
 class ArticleService {
 public:
     using DbClientPtr = drogon::orm::DbClientPtr;
@@ -40,15 +19,23 @@ public:
     using RevisionCallback = std::function<void(const std::optional<ArticleRevisionDto> &)>;
     using RevisionListCallback = std::function<void(const std::vector<ArticleRevisionDto> &)>;
     using BoolCallback = std::function<void(bool success, const std::string &error)>;
+    using PublishedCallback = std::function<void(bool success, const std::vector<int> &published)>;
 
+    // Newest first, public articles only
     void listArticles(const DbClientPtr &db, int tenantId,
-                      int limit, int offset,
+                      const PageRequest &page,
                       ArticleListCallback cb);
 
     void getArticle(const DbClientPtr &db, int tenantId,
                     const std::string &name,
                     ArticleCallback cb);
 
+    // getArticle for a reader: also counts the view, in ViewCountService
+    // rather than in the row, so the read writes nothing
+    void viewArticle(const DbClientPtr &db, int tenantId,
+                     const std::string &name,
+                     ArticleCallback cb);
+
     void createArticle(const DbClientPtr &db, int tenantId,
                        const std::string &name,
                        const std::string &displayName,
@@ -71,9 +58,21 @@ public:
     void listRevisions(const DbClientPtr &db, int articleId,
                        RevisionListCallback cb);
 
+    // Rebuilds the text from its snapshot and deltas when it is not
+    // stored in full
     void getRevision(const DbClientPtr &db, int revisionId,
                      RevisionCallback cb);
 
+    // The newest revision, whose text is always stored in full
+    void getLatestRevision(const DbClientPtr &db, int articleId,
+                           RevisionCallback cb);
+
+    // getLatestRevision with html set: the stored render for renderer when
+    // there is one, joined in the same query, else rendered now
+    void getRenderedRevision(const DbClientPtr &db, int articleId,
+                             const std::string &renderer,
+                             RevisionCallback cb);
+
     void revertToRevision(const DbClientPtr &db, int articleId,
                           int revisionId, int userId,
                           BoolCallback cb);
@@ -103,15 +102,30 @@ public:
     void unpublishArticle(const DbClientPtr &db, int articleId,
                           BoolCallback cb);
 
+    // Publishes every scheduled article that is due; PublishScheduler calls
+    // it when the earliest due time arrives
     void publishDueArticles(const DbClientPtr &db,
-                            BoolCallback cb);
+                            PublishedCallback cb);
 
     void listArticlesByStatus(const DbClientPtr &db, int tenantId,
                               const std::string &status,
                               int limit, int offset,
                               ArticleListCallback cb);
 
+    // Encoding of revisions, shared by every ArticleService. Configured on
+    // first use from REVISION_SNAPSHOT_INTERVAL and REVISION_CACHE_MB.
+    static RevisionStore &revisions();
+    // An article_revisions row as RevisionStore reads it
+    static RevisionStore::Row rowToStoredRevision(const drogon::orm::Row &row);
+
 private:
+    // Stores content as the article's newest revision, encoded against the
+    // current newest one, whose own text is then cleared
+    void appendRevision(const DbClientPtr &db, int articleId,
+                        const std::string &content,
+                        const std::string &summary, int userId,
+                        BoolCallback cb);
+
     ArticleDto rowToArticleDto(const drogon::orm::Row &row);
     ArticleRevisionDto rowToRevisionDto(const drogon::orm::Row &row);
 };
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+
+// Article DTOs, kept free of Drogon so caches and codecs can use them
+// without pulling in the framework.
+
+namespace pyracms {
+
+struct ArticleDto {
+    int id;
+    std::string name;
+    std::string displayName;
+    bool isPrivate;
+    bool hideDisplayName;
+    int userId;
+    std::string rendererName;
+    int viewCount;
+    std::string createdAt;
+    std::string status;       // draft, scheduled, published, unpublished
+    std::string publishedAt;
+    std::string scheduledAt;
+};
+
+struct ArticleRevisionDto {
+    int id;
+    int articleId;
+    std::string content;
+    std::string summary;
+    int userId;
+    std::string createdAt;
+    std::string html; // sanitized render, when one was asked for
+};
+
+} // namespace pyracms
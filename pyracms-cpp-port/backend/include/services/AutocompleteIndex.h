@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "SearchTypes.h"
+
+namespace pyracms {
+
+struct AutocompleteEntry {
+    std::string type; // "article", "forum_post", "gamedep"
+    int id = 0;
+    std::string text;
+    std::string url;
+    uint64_t weight = 0; // popularity; higher ranks first
+};
+
+// Per-tenant radix tries over lowercased titles for prefix completion.
+//
+// Every node stores the largest weight anywhere below it, so top-N for a
+// prefix is a best-first walk from the prefix's node that stops after N
+// entries, without visiting the rest of the subtree. Entries belonging
+// to kSharedTenant (the gamedep catalog, which has no tenant) are offered
+// to every tenant.
+//
+// Updates are incremental: upserting an entry moves it if its text
+// changed and re-propagates weights; removal prunes empty branches.
+class AutocompleteIndex {
+public:
+    static constexpr int kSharedTenant = -1;
+
+    AutocompleteIndex();
+    ~AutocompleteIndex();
+    AutocompleteIndex(const AutocompleteIndex &) = delete;
+    AutocompleteIndex &operator=(const AutocompleteIndex &) = delete;
+
+    void upsert(int tenantId, AutocompleteEntry entry);
+    bool remove(int tenantId, const std::string &type, int id);
+    // Changes the weight of an existing entry; false if it is not indexed
+    bool setWeight(int tenantId, const std::string &type, int id, uint64_t weight);
+
+    // Highest-weighted entries whose text starts with prefix, ignoring
+    // ASCII case
+    std::vector<AutocompleteItem> complete(int tenantId, std::string_view prefix,
+                                           size_t limit) const;
+
+    size_t size() const;
+
+    static std::string normalize(std::string_view text);
+
+private:
+    struct Trie;
+
+    std::shared_ptr<Trie> findTrie(int tenantId) const;
+    std::shared_ptr<Trie> trie(int tenantId);
+
+    mutable std::shared_mutex mu_;
+    std::unordered_map<int, std::shared_ptr<Trie>> tries_;
+};
+
+} // namespace pyracms
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <drogon/drogon.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "AutocompleteIndex.h"
+
+namespace pyracms {
+
+// Owns the in-memory AutocompleteIndex that answers prefix lookups when
+// Elasticsearch is not the search engine.
+//
+// rebuild() loads every published article, titled forum post and gamedep
+// page with its view count, then swaps the new index in; it runs at
+// startup and periodically so weights follow popularity. Content hooks
+// update the live index in place. Hooks that arrive while a rebuild is
+// loading are also logged and replayed onto the new index before the
+// swap, so nothing is lost to the race. Until the first rebuild finishes,
+// ready() is false and callers fall back to SQL.
+class AutocompleteService {
+public:
+    using DbClientPtr = drogon::orm::DbClientPtr;
+
+    static AutocompleteService &instance();
+
+    void rebuild(const DbClientPtr &db);
+    bool ready() const { return ready_; }
+
+    std::vector<AutocompleteItem> complete(int tenantId, const std::string &prefix,
+                                           int limit) const;
+
+    // Content hooks
+    void indexArticle(int tenantId, int articleId, const std::string &name,
+                      const std::string &displayName, int64_t views);
+    void removeArticle(int tenantId, int articleId);
+    void setArticleViews(int tenantId, int articleId, int64_t views);
+
+    void indexForumPost(int tenantId, int postId, const std::string &title,
+                        int threadId, int64_t threadViews);
+    void removeForumPost(int tenantId, int postId);
+
+    void indexGameDep(int pageId, const std::string &name,
+                      const std::string &displayName, int64_t views);
+    void removeGameDep(int pageId);
+
+    size_t size() const;
+
+private:
+    AutocompleteService() = default;
+
+    // A hook applied while a rebuild is loading
+    struct Op {
+        enum Kind { Upsert, Remove, Weight } kind;
+        int tenantId;
+        AutocompleteEntry entry;
+    };
+
+    void apply(Op op);
+    static void applyTo(AutocompleteIndex &index, const Op &op);
+
+    mutable std::mutex mu_;
+    std::shared_ptr<AutocompleteIndex> index_;
+    bool rebuilding_ = false;
+    std::vector<Op> pending_;
+    std::atomic<bool> ready_{false};
+};
+
+} // namespace pyracms
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pyracms {
+
+// Compact binary serialization for cached values.
+//
+// Integers are zigzag varints, doubles are 8 raw little-endian bytes,
+// strings and sequences are varint length-prefixed. A three-byte header
+// (magic, type tag, schema version) lets decoders reject values written by
+// an older build instead of misreading them. Decoding reads straight from
+// the input and allocates nothing beyond the destination strings and
+// containers.
+//
+// Make a type serializable by specializing BinaryCodec<T> with kTag,
+// kVersion, encode() and decode() — see CacheCodecs.h.
+
+class BinaryWriter {
+public:
+    explicit BinaryWriter(std::string &out) : out_(out) {}
+
+    void u8(uint8_t v) { out_.push_back(static_cast<char>(v)); }
+
+    void varint(uint64_t v) {
+        char buf[10];
+        size_t n = 0;
+        while (v >= 0x80) {
+            buf[n++] = static_cast<char>((v & 0x7f) | 0x80);
+            v >>= 7;
+        }
+        buf[n++] = static_cast<char>(v);
+        out_.append(buf, n);
+    }
+
+    void i64(int64_t v) { varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63)); }
+
+    void f64(double v) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        char buf[8];
+        for (int i = 0; i < 8; ++i) buf[i] = static_cast<char>(bits >> (8 * i));
+        out_.append(buf, 8);
+    }
+
+    void str(std::string_view s) {
+        varint(s.size());
+        out_.append(s.data(), s.size());
+    }
+
+private:
+    std::string &out_;
+};
+
+class BinaryReader {
+public:
+    explicit BinaryReader(std::string_view in) : p_(in.data()), end_(in.data() + in.size()) {}
+
+    // Sticky failure flag: once a read runs past the end every later read
+    // returns zero values, so decoders need only check ok() at the end.
+    bool ok() const { return ok_; }
+    bool atEnd() const { return p_ == end_; }
+    size_t remaining() const { return static_cast<size_t>(end_ - p_); }
+    void fail() { ok_ = false; p_ = end_; }
+
+    uint8_t u8() {
+        if (p_ == end_) {
+            fail();
+            return 0;
+        }
+        return static_cast<uint8_t>(*p_++);
+    }
+
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p_ == end_) break;
+            auto byte = static_cast<uint8_t>(*p_++);
+            v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return v;
+        }
+        fail();
+        return 0;
+    }
+
+    int64_t i64() {
+        uint64_t v = varint();
+        return static_cast<int64_t>((v >> 1) ^ (~(v & 1) + 1));
+    }
+
+    double f64() {
+        if (remaining() < 8) {
+            fail();
+            return 0.0;
+        }
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; ++i) bits |= static_cast<uint64_t>(static_cast<uint8_t>(p_[i])) << (8 * i);
+        p_ += 8;
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    std::string_view str() {
+        uint64_t n = varint();
+        if (n > remaining()) {
+            fail();
+            return {};
+        }
+        std::string_view s(p_, static_cast<size_t>(n));
+        p_ += n;
+        return s;
+    }
+
+    void str(std::string &dst) {
+        auto s = str();
+        dst.assign(s.data(), s.size());
+    }
+
+    // Element count for a sequence whose elements take at least minBytes
+    // each; rejects counts the remaining input cannot possibly hold so a
+    // corrupt prefix cannot trigger a huge reserve().
+    size_t count(size_t minBytes = 1) {
+        uint64_t n = varint();
+        if (n > remaining() / (minBytes ? minBytes : 1)) {
+            fail();
+            return 0;
+        }
+        return static_cast<size_t>(n);
+    }
+
+private:
+    const char *p_;
+    const char *end_;
+    bool ok_ = true;
+};
+
+template <typename T>
+struct BinaryCodec;
+
+template <>
+struct BinaryCodec<std::string> {
+    static void encode(BinaryWriter &w, const std::string &v) { w.str(v); }
+    static void decode(BinaryReader &r, std::string &v) { r.str(v); }
+};
+
+template <>
+struct BinaryCodec<int> {
+    static void encode(BinaryWriter &w, int v) { w.i64(v); }
+    static void decode(BinaryReader &r, int &v) { v = static_cast<int>(r.i64()); }
+};
+
+template <>
+struct BinaryCodec<bool> {
+    static void encode(BinaryWriter &w, bool v) { w.u8(v ? 1 : 0); }
+    static void decode(BinaryReader &r, bool &v) { v = r.u8() != 0; }
+};
+
+template <>
+struct BinaryCodec<double> {
+    static void encode(BinaryWriter &w, double v) { w.f64(v); }
+    static void decode(BinaryReader &r, double &v) { v = r.f64(); }
+};
+
+template <typename T>
+struct BinaryCodec<std::vector<T>> {
+    static constexpr uint8_t kTag = BinaryCodec<T>::kTag | 0x80;
+    static constexpr uint8_t kVersion = BinaryCodec<T>::kVersion;
+
+    static void encode(BinaryWriter &w, const std::vector<T> &v) {
+        w.varint(v.size());
+        for (const auto &item : v) BinaryCodec<T>::encode(w, item);
+    }
+    static void decode(BinaryReader &r, std::vector<T> &v) {
+        size_t n = r.count();
+        v.clear();
+        v.reserve(n);
+        for (size_t i = 0; i < n && r.ok(); ++i) {
+            v.emplace_back();
+            BinaryCodec<T>::decode(r, v.back());
+        }
+    }
+};
+
+template <typename V>
+struct BinaryCodec<std::map<std::string, V>> {
+    static void encode(BinaryWriter &w, const std::map<std::string, V> &m) {
+        w.varint(m.size());
+        for (const auto &[k, v] : m) {
+            w.str(k);
+            BinaryCodec<V>::encode(w, v);
+        }
+    }
+    static void decode(BinaryReader &r, std::map<std::string, V> &m) {
+        size_t n = r.count(2);
+        m.clear();
+        for (size_t i = 0; i < n && r.ok(); ++i) {
+            auto key = r.str();
+            BinaryCodec<V>::decode(r, m[std::string(key)]);
+        }
+    }
+};
+
+constexpr uint8_t kBinaryCodecMagic = 0xB7; // never the first byte of JSON text
+
+template <typename T>
+std::string encodeBinary(const T &value) {
+    std::string out;
+    out.reserve(256);
+    BinaryWriter w(out);
+    w.u8(kBinaryCodecMagic);
+    w.u8(BinaryCodec<T>::kTag);
+    w.u8(BinaryCodec<T>::kVersion);
+    BinaryCodec<T>::encode(w, value);
+    return out;
+}
+
+// False if data is not a value of type T at the current schema version,
+// or is truncated or has trailing bytes.
+template <typename T>
+bool decodeBinary(std::string_view data, T &out) {
+    BinaryReader r(data);
+    if (r.u8() != kBinaryCodecMagic || r.u8() != BinaryCodec<T>::kTag ||
+        r.u8() != BinaryCodec<T>::kVersion) {
+        return false;
+    }
+    BinaryCodec<T>::decode(r, out);
+    return r.ok() && r.atEnd();
+}
+
+} // namespace pyracms
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "ArticleTypes.h"
+#include "BinaryCodec.h"
+#include "SearchTypes.h"
+
+// BinaryCodec specializations for the DTOs stored in CacheService.
+// Bump kVersion whenever a field is added, removed or reordered; values
+// written under the old layout then decode as a cache miss.
+
+namespace pyracms {
+
+template <>
+struct BinaryCodec<SearchResultItem> {
+    static constexpr uint8_t kTag = 1;
+    static constexpr uint8_t kVersion = 2;
+
+    static void encode(BinaryWriter &w, const SearchResultItem &v) {
+        w.str(v.type);
+        w.i64(v.id);
+        w.str(v.title);
+        w.str(v.snippet);
+        w.str(v.url);
+        w.f64(v.rank);
+        w.str(v.createdAt);
+        w.str(v.highlight);
+    }
+    static void decode(BinaryReader &r, SearchResultItem &v) {
+        r.str(v.type);
+        v.id = static_cast<int>(r.i64());
+        r.str(v.title);
+        r.str(v.snippet);
+        r.str(v.url);
+        v.rank = r.f64();
+        r.str(v.createdAt);
+        r.str(v.highlight);
+    }
+};
+
+template <>
+struct BinaryCodec<SearchResults> {
+    static constexpr uint8_t kTag = 2;
+    static constexpr uint8_t kVersion = 4;
+
+    static void encode(BinaryWriter &w, const SearchResults &v) {
+        w.str(v.query);
+        w.i64(v.totalCount);
+        BinaryCodec<std::vector<SearchResultItem>>::encode(w, v.items);
+        BinaryCodec<std::map<std::string, int>>::encode(w, v.facets);
+        w.str(v.nextCursor);
+        w.str(v.suggestion);
+    }
+    static void decode(BinaryReader &r, SearchResults &v) {
+        r.str(v.query);
+        v.totalCount = static_cast<int>(r.i64());
+        BinaryCodec<std::vector<SearchResultItem>>::decode(r, v.items);
+        BinaryCodec<std::map<std::string, int>>::decode(r, v.facets);
+        r.str(v.nextCursor);
+        r.str(v.suggestion);
+    }
+};
+
+template <>
+struct BinaryCodec<AutocompleteItem> {
+    static constexpr uint8_t kTag = 3;
+    static constexpr uint8_t kVersion = 1;
+
+    static void encode(BinaryWriter &w, const AutocompleteItem &v) {
+        w.str(v.text);
+        w.str(v.type);
+        w.str(v.url);
+    }
+    static void decode(BinaryReader &r, AutocompleteItem &v) {
+        r.str(v.text);
+        r.str(v.type);
+        r.str(v.url);
+    }
+};
+
+template <>
+struct BinaryCodec<ArticleDto> {
+    static constexpr uint8_t kTag = 4;
+    static constexpr uint8_t kVersion = 1;
+
+    static void encode(BinaryWriter &w, const ArticleDto &v) {
+        w.i64(v.id);
+        w.str(v.name);
+        w.str(v.displayName);
+        w.u8(v.isPrivate);
+        w.u8(v.hideDisplayName);
+        w.i64(v.userId);
+        w.str(v.rendererName);
+        w.i64(v.viewCount);
+        w.str(v.createdAt);
+        w.str(v.status);
+        w.str(v.publishedAt);
+        w.str(v.scheduledAt);
+    }
+    static void decode(BinaryReader &r, ArticleDto &v) {
+        v.id = static_cast<int>(r.i64());
+        r.str(v.name);
+        r.str(v.displayName);
+        v.isPrivate = r.u8() != 0;
+        v.hideDisplayName = r.u8() != 0;
+        v.userId = static_cast<int>(r.i64());
+        r.str(v.rendererName);
+        v.viewCount = static_cast<int>(r.i64());
+        r.str(v.createdAt);
+        r.str(v.status);
+        r.str(v.publishedAt);
+        r.str(v.scheduledAt);
+    }
+};
+
+} // namespace pyracms
@@ -1,13 +1,22 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <vector>
-#include <mutex>
 #include <memory>
+#include <optional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 
 namespace pyracms {
 
+class InvalidationBus;
+class LocalCache;
+class RedisClient;
+
 class CacheService {
 public:
     using StringCallback = std::function<void(const std::string &value, bool found)>;
@@ -21,20 +30,48 @@ public:
     void get(const std::string &key, StringCallback cb);
     void set(const std::string &key, const std::string &value, int ttlSeconds, BoolCallback cb);
     void del(const std::string &key, BoolCallback cb);
-    void delPattern(const std::string &pattern, BoolCallback cb);
 
-    // Convenience: cache-aside pattern
+    // Convenience: cache-aside pattern. Concurrent misses on one key share a
+    // single fetcher call. With softTtlSeconds > 0 the value is considered
+    // stale after that long: it is still served immediately, and one
+    // background fetch refreshes it before the hard ttlSeconds expiry.
     void getOrSet(const std::string &key, int ttlSeconds,
                   std::function<void(StringCallback)> fetcher,
-                  StringCallback cb);
+                  StringCallback cb, int softTtlSeconds = 0);
+
+    struct Stats {
+        uint64_t fetches = 0;             // fetcher calls made by getOrSet
+        uint64_t coalescedWaiters = 0;    // misses that joined an in-flight fetch
+        uint64_t backgroundRefreshes = 0; // stale-while-revalidate refreshes
+        uint64_t staleHits = 0;           // stale values served
+        uint64_t flightTimeouts = 0;      // fetches abandoned at the deadline
+    };
+    Stats stats() const;
+
+    // Namespaces whose keys embed a per-tenant generation. Bumping the
+    // generation makes every existing key unreachable in O(1); the orphaned
+    // entries simply expire with their TTL.
+    enum class Namespace { Articles, Search, Autocomplete };
+
+    // Empty until the generation has been read from Redis: a tenant seen for
+    // the first time (after a restart, or on a new node) must not fall back
+    // to keys written before earlier bumps.
+    std::optional<long long> generation(int tenantId, Namespace ns);
+    void bumpGeneration(int tenantId, Namespace ns);
 
-    // Key builders
+    // Key builders. The generation-scoped ones return an empty key while the
+    // generation is unknown; callers then bypass the cache (no read, no
+    // write) for that request.
     static std::string articleKey(int tenantId, const std::string &name);
     static std::string articleListKey(int tenantId, int limit, int offset);
-    static std::string searchKey(int tenantId, const std::string &query, const std::string &type);
+    static std::string searchKey(int tenantId, const std::string &query, const std::string &type,
+                                 int limit, int offset);
     static std::string userKey(int userId);
     static std::string autocompleteKey(int tenantId, const std::string &prefix);
 
+    // Purges ResponseCache surrogate keys here and on every other node
+    void purgeResponses(const std::vector<std::string> &surrogateKeys);
+
     // Invalidation helpers
     void invalidateArticle(int tenantId, const std::string &name);
     void invalidateArticleList(int tenantId);
@@ -42,17 +79,58 @@ public:
     void invalidateUser(int userId);
 
 private:
-    CacheService() = default;
+    CacheService();
+    ~CacheService();
 
-    struct RedisContext;
-    std::unique_ptr<RedisContext> ctx_;
-    std::mutex mutex_;
-    bool connected_ = false;
+    std::unique_ptr<RedisClient> redis_;
     std::string host_;
     int port_ = 6379;
 
-    void reconnect();
-    std::string execCommand(const std::vector<std::string> &args);
+    // L1 tier: hot reads are served in process. Entries live at most
+    // l1TtlSeconds_ and never longer than half the TTL they had left in
+    // Redis (read with PTTL alongside the GET); deletes and
+    // generation bumps are broadcast so other nodes drop their copies, as
+    // are response-cache purges.
+    std::unique_ptr<LocalCache> l1_;
+    std::shared_ptr<InvalidationBus> bus_;
+    std::string nodeId_;
+    int l1TtlSeconds_ = 5;
+
+    void onInvalidation(const std::string &message);
+
+    // Single-flight: callbacks waiting on an in-flight fetch, per key. A
+    // fetch that has not called back within kFlightTimeoutSeconds completes
+    // as a miss so its waiters are released; the id keeps its late reply
+    // from completing a newer flight for the same key.
+    struct Flight {
+        uint64_t id = 0;
+        std::vector<StringCallback> waiters;
+    };
+    // Returns the new flight's id if the caller leads it, 0 if it joined one
+    uint64_t joinFlight(const std::string &key, StringCallback cb);
+    bool completeFlight(const std::string &key, uint64_t id, const std::string &value,
+                        bool success);
+    void runFetch(const std::string &key, uint64_t flightId, int ttlSeconds,
+                  int softTtlSeconds, const std::function<void(StringCallback)> &fetcher);
+    std::mutex flightsMutex_;
+    std::unordered_map<std::string, Flight> flights_;
+    uint64_t nextFlightId_ = 1;
+    static constexpr double kFlightTimeoutSeconds = 10.0;
+
+    std::atomic<uint64_t> fetches_{0};
+    std::atomic<uint64_t> coalescedWaiters_{0};
+    std::atomic<uint64_t> backgroundRefreshes_{0};
+    std::atomic<uint64_t> staleHits_{0};
+    std::atomic<uint64_t> flightTimeouts_{0};
+
+    // Generations are cached in process and re-read from Redis once their
+    // lease runs out, so building a key normally costs no round trip.
+    struct GenerationEntry;
+    GenerationEntry &generationEntry(int tenantId, Namespace ns);
+    void refreshGeneration(int tenantId, Namespace ns, GenerationEntry &entry);
+    std::shared_mutex generationsMutex_;
+    std::unordered_map<long long, std::unique_ptr<GenerationEntry>> generations_;
+    static constexpr int kGenerationLeaseMs = 1000;
 };
 
 } // namespace pyracms
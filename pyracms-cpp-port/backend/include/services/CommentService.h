@@ -5,6 +5,7 @@
 #include <optional>
 #include <string>
 #include <vector>
+#include "PageCursor.h"
 
 namespace pyracms {
 
@@ -41,8 +42,7 @@ public:
     void getComments(const DbClientPtr &db,
                      const std::string &contentType,
                      int contentId,
-                     int limit,
-                     int offset,
+                     const PageRequest &page,
                      ListCallback cb);
 
     void updateComment(const DbClientPtr &db,
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <drogon/drogon.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "StickyWindow.h"
+
+namespace pyracms {
+
+// Owns the PostgreSQL pool configuration and picks a client per query.
+//
+// Writes go to the primary. Read-only endpoints ask for reader(req), which
+// round-robins over the read replicas unless the caller wrote within the
+// last DB_STICKY_SECONDS, in which case it returns the primary so the user
+// sees their own change despite replication lag. The sticky window is
+// per process; behind a load balancer it relies on the same session
+// reaching the same node for those few seconds, as the L1 cache does.
+//
+// With DB_FAST_CLIENTS=1 each IO loop also gets its own fast client, which
+// runs queries and callbacks on that loop instead of hopping through a
+// shared pool. Fast clients can only be used from IO loops, so callers on
+// other threads (timers on the main loop, DB callback threads) get the
+// ordinary pool.
+class DbRouter {
+public:
+    using DbClientPtr = drogon::orm::DbClientPtr;
+
+    static DbRouter &instance();
+
+    // Reads the DB_* environment and registers every pool with Drogon.
+    // Must run before app().run().
+    void configure();
+
+    DbClientPtr primary() const;
+    DbClientPtr replica() const;
+    // Replica, or the primary if this request's user wrote recently
+    DbClientPtr reader(const drogon::HttpRequestPtr &req) const;
+
+    // Post-handling hook: a successful non-GET request starts the caller's
+    // sticky window.
+    void onResponse(const drogon::HttpRequestPtr &req, const drogon::HttpResponsePtr &resp);
+
+    size_t replicaCount() const { return replicaNames_.size(); }
+
+    // libpq connection string for the primary, for callers that need a
+    // session of their own (advisory locks, LISTEN) rather than a pool
+    const std::string &primaryConnInfo() const { return primaryConnInfo_; }
+
+private:
+    DbRouter() = default;
+
+    DbClientPtr client(const std::string &name) const;
+    // Identities of the caller: the authenticated user id and the bearer
+    // token. Public GET routes skip JwtAuthFilter, so they only have the
+    // token; marking both lets either find the write.
+    struct StickyKeys {
+        std::array<uint64_t, 2> keys{};
+        size_t count = 0;
+    };
+    static StickyKeys stickyKeys(const drogon::HttpRequestPtr &req);
+
+    bool fastClients_ = false;
+    std::string primaryConnInfo_;
+    std::vector<std::string> replicaNames_;
+    mutable std::atomic<size_t> nextReplica_{0};
+    std::unique_ptr<StickyWindow> sticky_;
+};
+
+} // namespace pyracms
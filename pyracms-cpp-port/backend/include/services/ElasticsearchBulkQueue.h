@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace pyracms {
+
+// One document operation bound for Elasticsearch's _bulk endpoint
+struct BulkOp {
+    // Create only writes documents that do not exist yet (reindexing
+    // underneath live writes); Index overwrites
+    enum class Action { Index, Create, Delete };
+
+    Action action = Action::Index;
+    std::string index;
+    std::string id;
+    std::string source; // single-line JSON document; empty for deletes
+    int attempts = 0;
+    uint64_t seq = 0;   // assigned by the queue
+
+    std::string key() const { return index + '/' + id; }
+};
+
+// Bounded queue of pending index/delete operations, drained in _bulk
+// batches by ElasticsearchService. Kept free of Drogon so it can be
+// tested standalone.
+//
+// Operations on the same document coalesce: a newer operation replaces a
+// queued one, and a document with a batch in flight is held back until
+// that batch completes, so Elasticsearch always sees a document's
+// operations in order. Failed items are retried at the front of the queue
+// unless a newer operation for the document has arrived; permanent
+// failures and items out of attempts are dropped and counted.
+//
+// Backpressure: tryPush refuses new documents once `capacity` operations
+// are queued. Producers that can wait (bulk syncs) register with
+// whenRoom and are resumed as batches drain.
+class ElasticsearchBulkQueue {
+public:
+    struct Stats {
+        size_t queued = 0;
+        size_t inFlight = 0;
+        uint64_t pushed = 0;
+        uint64_t coalesced = 0;
+        uint64_t rejected = 0;
+        uint64_t indexed = 0;
+        uint64_t retried = 0;
+        uint64_t dropped = 0;
+    };
+
+    // What happened to a completed batch
+    struct Outcome {
+        size_t succeeded = 0;
+        size_t retried = 0;
+        size_t dropped = 0;
+    };
+
+    ElasticsearchBulkQueue(size_t capacity, int maxAttempts);
+
+    // False when the queue is full and op is not for a queued document
+    bool tryPush(BulkOp op);
+
+    // Runs resume once n more operations would fit, immediately if they
+    // already do. resume may run on whichever thread drains the queue.
+    void whenRoom(size_t n, std::function<void()> resume);
+
+    // Removes up to maxOps operations totalling about maxBytes of body
+    // (always at least one), skipping documents already in flight
+    std::vector<BulkOp> takeBatch(size_t maxOps, size_t maxBytes);
+
+    // Reports per-item HTTP statuses for a batch from takeBatch, in order;
+    // an empty vector means the whole request failed
+    Outcome complete(std::vector<BulkOp> batch, const std::vector<int> &statuses);
+
+    size_t size() const;
+    Stats stats() const;
+
+    // 429 and 5xx are transient; 0 stands for a transport failure
+    static bool retryable(int status);
+    // Whether an item status means op took effect or had nothing to do:
+    // 2xx, 404 for a delete, 409 for a create
+    static bool succeeded(const BulkOp &op, int status);
+    // Newline-delimited action/source pairs for POST /_bulk
+    static std::string encode(const std::vector<BulkOp> &batch);
+
+private:
+    struct Waiter {
+        size_t n;
+        std::function<void()> resume;
+    };
+
+    // Waiters that now fit, removed from the list; run them unlocked
+    std::vector<std::function<void()>> releaseWaiters();
+
+    const size_t capacity_;
+    const int maxAttempts_;
+
+    mutable std::mutex mu_;
+    std::list<BulkOp> queue_;
+    std::unordered_map<std::string, std::list<BulkOp>::iterator> queued_;
+    std::unordered_map<std::string, uint64_t> inFlight_; // key -> seq
+    std::list<Waiter> waiters_;
+    uint64_t nextSeq_ = 1;
+    Stats stats_;
+};
+
+} // namespace pyracms
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <drogon/drogon.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "ElasticsearchBulkQueue.h"
+#include "ReindexPlan.h"
+
+namespace pyracms {
+
+// Rebuilds the Elasticsearch indexes from PostgreSQL without downtime.
+//
+// A job creates a fresh versioned index behind every alias (bulk-load
+// settings: no refresh), splits each source table into
+// ES_REINDEX_PARALLELISM id ranges and streams them concurrently in
+// keyset batches of ES_REINDEX_BATCH_SIZE rows through _bulk "create"
+// operations. After each acknowledged batch the range's checkpoint is
+// stored in search_reindex_partitions, so a job interrupted by a crash or
+// restart resumes from there. When every range is done the aliases move to
+// the new indexes in one _aliases call and the old indexes are deleted.
+//
+// While a job is running every node mirrors its live writes into the new
+// indexes; "create" never overwrites them, so rows changed behind the
+// cursor end up current. Nodes learn about the job by polling every
+// ES_REINDEX_POLL_SECONDS, and the streaming node waits one interval
+// before it starts. The node streaming a job holds a lease (owner and
+// heartbeat); a lease not renewed for three poll intervals (at least a
+// minute) is taken over by the next node that polls. A job that fails
+// keeps its checkpoints and waits to be started again.
+class ElasticsearchReindexer {
+public:
+    using DbClientPtr = drogon::orm::DbClientPtr;
+    using DoneCallback = std::function<void(bool ok, const std::string &message)>;
+
+    static ElasticsearchReindexer &instance();
+
+    // Reads ES_REINDEX_* settings
+    void initialize();
+    std::chrono::seconds pollInterval() const { return pollInterval_; }
+
+    // Starts a job, or resumes the running one if nobody holds its lease.
+    // cb runs once streaming has been set up (or refused), not at the end.
+    void start(const DbClientPtr &db, DoneCallback cb);
+
+    // Called on every node each poll interval: mirrors writes while a job
+    // runs, renews the lease of a job streaming here and takes over jobs
+    // whose node has gone away
+    void poll(const DbClientPtr &db);
+
+    // Latest job: status, per-source progress and throughput
+    void progress(const DbClientPtr &db, std::function<void(const Json::Value &)> cb);
+
+private:
+    struct Run;
+
+    ElasticsearchReindexer() = default;
+
+    void create(const DbClientPtr &db, DoneCallback cb);
+    void claim(const DbClientPtr &db, int jobId, DoneCallback cb);
+    void run(const DbClientPtr &db, int jobId, const std::string &suffix);
+    void next(const std::shared_ptr<Run> &run);
+    void streamBatch(const std::shared_ptr<Run> &run, size_t partition);
+    void sendBatch(const std::shared_ptr<Run> &run, std::vector<BulkOp> ops, int attempt,
+                   std::function<void()> acked);
+    void checkpoint(const std::shared_ptr<Run> &run, size_t partition, int lastId,
+                    int64_t docs, bool done, std::function<void()> then);
+    // Records the first error; the job stops once every worker is idle
+    void fail(const std::shared_ptr<Run> &run, const std::string &error);
+    void finish(const std::shared_ptr<Run> &run);
+    void swapAliases(const std::shared_ptr<Run> &run);
+    void release(const std::shared_ptr<Run> &run);
+
+    int parallelism_ = 4;
+    int batchSize_ = 1000;
+    std::chrono::seconds pollInterval_{10};
+    int leaseSeconds_ = 60;
+    std::string nodeId_;
+
+    std::mutex mu_;
+    std::shared_ptr<Run> run_; // job streaming on this node
+};
+
+} // namespace pyracms
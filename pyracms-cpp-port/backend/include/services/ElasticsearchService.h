@@ -1,25 +1,76 @@
 #pragma once
 
+#include <drogon/HttpClient.h>
 #include <drogon/drogon.h>
+#include <trantor/net/EventLoopThread.h>
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
+#include "ElasticsearchBulkQueue.h"
 #include "SearchService.h"
 
 namespace pyracms {
 
+// A table that full reindexes stream into one index. Rows are read in key
+// order, one id range at a time:
+//   SELECT <columns> FROM <from> AND <key> > $1 AND <key> <= $2
+struct ElasticsearchSource {
+    const char *name;  // partition label in search_reindex_partitions
+    const char *index; // alias the application reads and writes
+    const char *key;
+    const char *columns;
+    const char *from;  // tables and a WHERE clause
+    // Returns the single-line JSON document for a row
+    std::string (*document)(const drogon::orm::Row &row);
+};
+
+// Elasticsearch client. All traffic is asynchronous and runs on a
+// dedicated event loop over a small pool of keep-alive connections.
+//
+// Index and delete calls return immediately: they enqueue onto a bounded
+// ElasticsearchBulkQueue that is flushed through _bulk when a batch fills
+// (ES_BULK_BATCH_SIZE operations or ES_BULK_BATCH_BYTES) or every
+// ES_BULK_FLUSH_MS. Transient failures are retried with exponential
+// backoff. When the queue is full, request-path writes are dropped and
+// logged, and bulk syncs wait for room.
+//
+// The application addresses indexes by alias (pyracms_articles, ...). A
+// full reindex builds versioned indexes behind those aliases; while one is
+// running, writes are mirrored into the new indexes too (see
+// ElasticsearchReindexer).
 class ElasticsearchService {
 public:
     using DbClientPtr = drogon::orm::DbClientPtr;
+    // status is 0 when no response arrived
+    using ResponseCallback = std::function<void(int status, const Json::Value &body)>;
 
     static ElasticsearchService &instance();
 
     void initialize();
     bool isConfigured() const;
+    // Flushes what is queued, waiting at most timeout
+    void stop(std::chrono::milliseconds timeout = std::chrono::seconds(5));
 
-    // Index management
+    ElasticsearchBulkQueue::Stats bulkStats() const;
+
+    // Index management: creates <alias>_v1 behind each missing alias
     void createIndexes();
+    // Settings and mappings for a new physical index
+    static Json::Value indexDefinition();
+    static const std::vector<ElasticsearchSource> &sources();
+
+    // Mirrors every write to <alias>_<suffix> as well; empty stops it
+    void setShadowSuffix(const std::string &suffix);
+
+    // Raw request on the Elasticsearch loop; cb runs on that loop
+    void send(drogon::HttpMethod method, const std::string &path, std::string body,
+              ResponseCallback cb);
+    trantor::EventLoop *loop() const { return loop_; }
 
     // Indexing operations (called on content create/update/delete)
     void indexArticle(int tenantId, int articleId,
@@ -48,18 +99,52 @@ public:
     void autocomplete(int tenantId, const std::string &prefix, int limit,
                       std::function<void(const std::vector<AutocompleteItem> &)> cb);
 
-    // Bulk sync from database
-    void syncFromDatabase(const DbClientPtr &db, int tenantId);
+    // Rebuilds every index from the database behind the aliases, resuming
+    // an interrupted rebuild if there is one. Indexes are shared by all
+    // tenants, so this always covers every tenant.
+    void syncFromDatabase(const DbClientPtr &db,
+                          std::function<void(bool ok, const std::string &message)> cb = nullptr);
+
+    // Queues ops, waiting for room as needed; done runs once all are queued
+    void enqueueAll(std::vector<BulkOp> ops, std::function<void()> done = nullptr);
 
 private:
     ElasticsearchService() = default;
 
+    void enqueue(BulkOp op);
+    void push(BulkOp op);
+    void enqueueFrom(std::shared_ptr<std::vector<BulkOp>> ops, size_t from,
+                     std::function<void()> done);
+
+    // Event-loop thread only
+    void scheduleFlush();
+    void flush();
+    void onBulkResponse(std::vector<BulkOp> batch, int status, const Json::Value &body);
+
     std::string esUrl_;
     bool configured_ = false;
 
-    static size_t curlWriteCallback(char *ptr, size_t size, size_t nmemb, std::string *data);
-    std::string httpRequest(const std::string &method, const std::string &path,
-                            const std::string &body = "");
+    std::unique_ptr<trantor::EventLoopThread> loopThread_;
+    trantor::EventLoop *loop_ = nullptr;
+    std::vector<drogon::HttpClientPtr> clients_;
+    std::atomic<size_t> nextClient_{0};
+
+    std::unique_ptr<ElasticsearchBulkQueue> queue_;
+    size_t batchOps_ = 500;
+    size_t batchBytes_ = 5 << 20;
+    size_t maxInFlight_ = 1;
+    std::atomic<bool> flushScheduled_{false};
+
+    std::atomic<size_t> inFlight_{0}; // bulk requests awaiting a response
+
+    mutable std::mutex shadowMu_;
+    std::string shadowSuffix_;
+
+    // Owned by the event loop
+    bool indexesReady_ = false;
+    std::chrono::milliseconds backoff_{0};
+    std::chrono::steady_clock::time_point backoffUntil_{};
+
     Json::Value parseJson(const std::string &str);
 };
 
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "SearchTypes.h"
+#include "SnippetHighlighter.h"
+
+namespace pyracms {
+
+// Doc ids and term frequencies, varint-encoded as gaps in blocks of
+// kBlockSize postings. Each block records its last doc id and byte offset,
+// so a cursor can skip whole blocks without decoding them.
+// Doc ids must be appended in increasing order.
+class PostingList {
+public:
+    static constexpr uint32_t kBlockSize = 128;
+
+    struct Block {
+        uint32_t lastDoc;
+        uint32_t offset;
+    };
+
+    void append(uint32_t doc, uint32_t tf, uint32_t docLength);
+
+    uint32_t size() const { return count_; }
+    size_t bytes() const { return data_.size() + blocks_.size() * sizeof(Block); }
+    // Largest tf and smallest doc length ever appended; together they bound
+    // any posting's BM25 contribution
+    uint32_t maxTf() const { return maxTf_; }
+    uint32_t minLength() const { return minLength_; }
+
+    class Cursor {
+    public:
+        explicit Cursor(const PostingList &list);
+
+        bool done() const { return done_; }
+        uint32_t doc() const { return doc_; }
+        uint32_t tf() const { return tf_; }
+        void next();
+        // Moves to the first posting with doc >= target
+        void seek(uint32_t target);
+
+    private:
+        void enterBlock(size_t block);
+        void decode();
+
+        const PostingList *list_;
+        size_t block_ = 0;
+        size_t pos_ = 0;
+        uint32_t remainingInBlock_ = 0;
+        uint32_t doc_ = 0;
+        uint32_t tf_ = 0;
+        bool done_ = false;
+    };
+
+private:
+    friend class EmbeddedIndex;
+
+    std::vector<uint8_t> data_;
+    std::vector<Block> blocks_;
+    uint32_t count_ = 0;
+    uint32_t maxTf_ = 0;
+    uint32_t minLength_ = UINT32_MAX;
+};
+
+// A document as handed to the index by the content hooks
+struct IndexedDocument {
+    std::string type; // "article", "forum_post", "snippet", "gamedep"
+    int id = 0;
+    std::string title;
+    std::string content;
+    std::string url;
+    std::string createdAt;
+};
+
+// In-process inverted index, one per tenant, behind SEARCH_ENGINE=embedded.
+//
+// Title terms count titleWeight times (the title^3 boost the Elasticsearch
+// query uses) and results are ranked by BM25. Queries are disjunctive, like
+// ES multi_match, and evaluated with WAND: each term's score upper bound
+// lets the evaluator skip documents that cannot enter the current top K.
+// A query term with no exact match expands to indexed terms it prefixes.
+//
+// Updates are incremental. Re-indexing or removing a document tombstones
+// its doc id and appends a new one, so posting lists only ever grow at the
+// tail; a tenant is compacted once tombstones outnumber live documents.
+// totalCount and facets are estimates (the largest per-term document
+// frequency), exact for single-term queries, since WAND never visits every
+// match.
+//
+// Snippets are built from the body and token offsets recorded at index
+// time (see SnippetHighlighter). Only the first highlightMaxBytes of a body
+// are kept, which bounds both memory and the cost of a snippet.
+//
+// Each tenant has its own reader/writer lock, so searches run concurrently
+// with each other and only wait on writes to the same tenant.
+class EmbeddedIndex {
+public:
+    struct Options {
+        double k1 = 1.2;
+        double b = 0.75;
+        uint32_t titleWeight = 3;
+        size_t snippetChars = 200;
+        size_t highlightMaxBytes = 64 * 1024;
+        size_t highlightMaxMatches = 256;
+        size_t maxPrefixExpansions = 16;
+    };
+
+    struct Stats {
+        size_t tenants = 0;
+        size_t documents = 0;
+        size_t tombstones = 0;
+        size_t terms = 0;
+        size_t postingBytes = 0;
+        size_t highlightBytes = 0; // stored bodies and token offsets
+    };
+
+    EmbeddedIndex();
+    explicit EmbeddedIndex(Options options);
+    ~EmbeddedIndex();
+
+    // Unchanged documents (same content hash) are left alone; returns
+    // whether the index changed
+    bool upsert(int tenantId, const IndexedDocument &doc);
+    bool remove(int tenantId, const std::string &type, int id);
+    // Removes the document from whichever tenant holds it
+    bool remove(const std::string &type, int id);
+    // Removes documents of this type whose ids are not in keep; used to
+    // reconcile with the database after loading a snapshot
+    size_t retainOnly(int tenantId, const std::string &type, const std::unordered_set<int> &keep);
+
+    SearchResults search(int tenantId, const std::string &query, const std::string &type,
+                         int limit, int offset) const;
+
+    std::vector<int> tenants() const;
+    Stats stats() const;
+
+    // Binary snapshot, written to path + ".tmp" and renamed into place.
+    // load() maps the file and replaces the whole index only if it parses.
+    bool save(const std::string &path) const;
+    bool load(const std::string &path);
+
+    // Lowercased ASCII alphanumeric runs; other bytes separate tokens,
+    // except UTF-8 sequences, which are kept inside tokens
+    static std::vector<std::string> tokenize(std::string_view text);
+
+private:
+    struct DocTerm {
+        uint32_t termId;
+        uint32_t tf; // weighted
+        // This term's run of positions; empty for title-only terms
+        uint32_t firstPosition;
+        uint32_t positionCount;
+    };
+
+    struct Doc {
+        uint8_t type = 0;
+        bool live = true;
+        int id = 0;
+        uint32_t length = 0;
+        uint64_t hash = 0;
+        std::string title;
+        std::string url;
+        std::string createdAt;
+        std::string body;               // content, up to highlightMaxBytes
+        std::vector<TokenSpan> spans;   // every token of body, in order
+        std::vector<uint32_t> positions; // indexes into spans, grouped by term
+        std::vector<DocTerm> terms;     // sorted by term id
+    };
+
+    struct Term {
+        PostingList postings;
+        uint32_t liveDf = 0;
+        std::array<uint32_t, 4> typeDf{};
+    };
+
+    struct Tenant {
+        mutable std::shared_mutex mu;
+        std::vector<Doc> docs;
+        std::unordered_map<uint64_t, uint32_t> byKey; // (type, id) -> live doc
+        std::map<std::string, uint32_t, std::less<>> dictionary;
+        std::vector<Term> terms;
+        uint64_t liveLength = 0;
+        uint32_t liveDocs = 0;
+        uint32_t tombstones = 0;
+    };
+
+    // Shared so load() can swap tenants out from under in-flight searches
+    std::shared_ptr<Tenant> findTenant(int tenantId) const;
+    std::shared_ptr<Tenant> tenant(int tenantId);
+    void addDoc(Tenant &t, Doc doc);
+    static void tombstone(Tenant &t, uint32_t docId);
+    static void compact(Tenant &t);
+
+    Options options_;
+    mutable std::shared_mutex tenantsMutex_;
+    std::unordered_map<int, std::shared_ptr<Tenant>> tenants_;
+};
+
+} // namespace pyracms
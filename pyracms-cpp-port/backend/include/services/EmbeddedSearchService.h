@@ -0,0 +1,80 @@
+#pragma once
+
+#include <drogon/drogon.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "EmbeddedIndex.h"
+
+namespace pyracms {
+
+// Owns the process-wide EmbeddedIndex used when SEARCH_ENGINE=embedded.
+//
+// The index is restored from a snapshot at startup and then reconciled
+// with the database: every searchable row is upserted (unchanged rows are
+// skipped by content hash) and documents whose rows are gone are dropped.
+// After that, article writes keep it current through SearchService, and
+// main.cpp reconciles again every EMBEDDED_SEARCH_RECONCILE_SECONDS for the
+// content types without hooks. A background thread rewrites the snapshot
+// whenever the index has changed.
+class EmbeddedSearchService {
+public:
+    using DbClientPtr = drogon::orm::DbClientPtr;
+
+    static EmbeddedSearchService &instance();
+
+    static bool enabled();
+
+    // Loads EMBEDDED_SEARCH_SNAPSHOT and starts the snapshot thread
+    void initialize();
+    // Stops the snapshot thread after writing a final snapshot
+    void stop();
+
+    void reconcile(const DbClientPtr &db);
+
+    // Indexing operations, mirroring ElasticsearchService
+    void indexArticle(int tenantId, int articleId,
+                      const std::string &name, const std::string &displayName,
+                      const std::string &content, const std::string &createdAt);
+
+    void indexForumPost(int tenantId, int postId,
+                        const std::string &title, const std::string &content,
+                        int threadId, const std::string &createdAt);
+
+    void indexSnippet(int tenantId, int snippetId,
+                      const std::string &title, const std::string &code,
+                      const std::string &createdAt);
+
+    void indexGameDep(int tenantId, int pageId,
+                      const std::string &name, const std::string &displayName,
+                      const std::string &description, const std::string &createdAt);
+
+    void deleteDocument(const std::string &type, int id);
+
+    SearchResults search(int tenantId, const std::string &query, const std::string &type,
+                         int limit, int offset) const;
+
+    EmbeddedIndex::Stats stats() const { return index_.stats(); }
+
+private:
+    EmbeddedSearchService() = default;
+
+    void upsert(int tenantId, IndexedDocument doc);
+    void snapshotLoop();
+    void saveIfDirty();
+
+    EmbeddedIndex index_;
+    std::string snapshotPath_;
+    std::chrono::seconds snapshotInterval_{300};
+    std::atomic<bool> dirty_{false};
+
+    std::mutex mu_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+} // namespace pyracms
@@ -5,6 +5,7 @@
 #include <optional>
 #include <string>
 #include <vector>
+#include "PageCursor.h"
 
 namespace pyracms {
 
@@ -67,7 +68,7 @@ public:
 
     void listPages(const DbClientPtr &db,
                    const std::string &type,
-                   int limit, int offset,
+                   const PageRequest &page,
                    PageListCallback cb);
 
     void createPage(const DbClientPtr &db,
@@ -84,6 +85,13 @@ public:
                  std::function<void(const std::optional<GameDepPageDto> &,
                                     const std::vector<GameDepRevisionDto> &)> cb);
 
+    // getPage for a reader: also counts the view, in ViewCountService
+    void viewPage(const DbClientPtr &db,
+                  const std::string &type,
+                  const std::string &name,
+                  std::function<void(const std::optional<GameDepPageDto> &,
+                                     const std::vector<GameDepRevisionDto> &)> cb);
+
     void updatePage(const DbClientPtr &db,
                     const std::string &type,
                     const std::string &name,
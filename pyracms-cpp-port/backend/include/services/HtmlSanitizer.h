@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace pyracms {
+
+// Allowlist HTML sanitizer for article bodies, applied to every render
+// before it is stored or served.
+//
+// Allowed tags are kept with their allowed attributes only; script, style,
+// iframe, object and similar elements are dropped with their content, and
+// any other tag is dropped while its text is kept. URL attributes must be
+// relative or use http, https or mailto once entities and control
+// characters are resolved. Links get rel="nofollow noopener". Tags are
+// balanced and text is re-escaped, so the output is well-formed whatever
+// the input.
+class HtmlSanitizer {
+public:
+    static std::string sanitize(std::string_view html);
+
+    // Whether a decoded attribute value is a URL that may be served
+    static bool isSafeUrl(std::string_view url);
+
+    // Resolves numeric character references and the common named ones;
+    // other named references are left as written
+    static std::string decodeEntities(std::string_view text);
+};
+
+} // namespace pyracms
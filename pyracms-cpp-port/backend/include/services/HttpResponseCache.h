@@ -0,0 +1,50 @@
+#pragma once
+
+#include <drogon/drogon.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace pyracms {
+
+// Drogon side of ResponseCache for public GET handlers:
+//
+//   auto key = HttpResponseCache::keyFor(req, tenantId);
+//   if (HttpResponseCache::serve(req, key, callback)) return;
+//   auto send = HttpResponseCache::storing(req, key, {surrogates...}, ttl, callback);
+//   ... build the response and call send(resp)
+//
+// Requests carrying an Authorization header bypass the cache entirely.
+//
+// A hit reuses an HttpResponse object kept per IO thread for each cached
+// entry, marked with setExpiredTime(0) so Drogon renders it once and then
+// sends the same shared buffer for every hit (only the Date header is
+// patched). The body is copied once per thread per entry, not per request.
+class HttpResponseCache {
+public:
+    using Callback = std::function<void(const drogon::HttpResponsePtr &)>;
+    using TaggedCallback = std::function<void(const drogon::HttpResponsePtr &, int64_t tag)>;
+
+    static std::string keyFor(const drogon::HttpRequestPtr &req, int tenantId);
+
+    // Sends a cached response and returns true, or returns false on a miss.
+    // tag, if given, receives the value the entry was stored with.
+    static bool serve(const drogon::HttpRequestPtr &req, const std::string &key,
+                      const Callback &callback, int64_t *tag = nullptr);
+
+    // Wraps callback so a 200 response is stored under key before it is
+    // sent. The surrogate generations are stamped now, before the handler
+    // queries anything.
+    static Callback storing(const drogon::HttpRequestPtr &req, std::string key,
+                            const std::vector<std::string> &surrogateKeys, int ttlSeconds,
+                            Callback callback);
+
+    // As storing(), keeping a handler-defined tag with the entry for
+    // serve() to hand back on a hit
+    static TaggedCallback storingTagged(const drogon::HttpRequestPtr &req, std::string key,
+                                        const std::vector<std::string> &surrogateKeys,
+                                        int ttlSeconds, Callback callback);
+};
+
+} // namespace pyracms
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace pyracms {
+
+// Cache invalidation broadcast between nodes. Each node tags messages with
+// its own origin id and ignores its own echoes.
+struct InvalidationMessage {
+    enum class Kind { Key, Generation, Surrogate };
+
+    Kind kind = Kind::Key;
+    std::string origin;
+    std::string key;           // Kind::Key, Kind::Surrogate
+    int tenantId = 0;          // Kind::Generation
+    int ns = 0;
+    long long generation = 0;
+
+    std::string encode() const;
+    static std::optional<InvalidationMessage> decode(const std::string &wire);
+};
+
+class InvalidationBus {
+public:
+    using Handler = std::function<void(const std::string &message)>;
+
+    virtual ~InvalidationBus() = default;
+    virtual void publish(const std::string &message) = 0;
+    virtual void subscribe(Handler handler) = 0;
+};
+
+// In-process stand-in for Redis pub/sub: delivers every message to every
+// subscriber synchronously, including the publisher.
+class LocalInvalidationBus : public InvalidationBus {
+public:
+    void publish(const std::string &message) override;
+    void subscribe(Handler handler) override;
+
+private:
+    std::mutex mutex_;
+    std::vector<Handler> handlers_;
+};
+
+} // namespace pyracms
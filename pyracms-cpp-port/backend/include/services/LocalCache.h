@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace pyracms {
+
+// In-process L1 cache: a sharded LRU bounded by a byte budget, with a TTL
+// per entry. Values are immutable and shared, so a hit hands out a
+// reference-counted pointer instead of copying the payload under the lock.
+class LocalCache {
+public:
+    using Value = std::shared_ptr<const std::string>;
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t expirations = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    explicit LocalCache(size_t byteBudget, size_t shardCount = 16);
+
+    Value get(const std::string &key);
+    // Returns the stored value, or the value itself uncached if it is larger
+    // than a shard's budget.
+    Value put(const std::string &key, std::string value, std::chrono::milliseconds ttl);
+    void erase(const std::string &key);
+    void clear();
+
+    Stats stats() const;
+    size_t byteBudget() const { return byteBudget_; }
+
+    // Approximate bookkeeping cost per entry on top of key and value bytes
+    static constexpr size_t kEntryOverhead = 96;
+
+private:
+    struct Entry {
+        std::string key;
+        Value value;
+        Clock::time_point expiresAt;
+        size_t charge;
+    };
+
+    struct Shard {
+        mutable std::mutex mu;
+        std::list<Entry> lru; // front = most recently used
+        std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+        size_t bytes = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t expirations = 0;
+
+        void unlink(std::list<Entry>::iterator it);
+    };
+
+    Shard &shardFor(const std::string &key);
+
+    size_t byteBudget_;
+    size_t shardBudget_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace pyracms
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace pyracms {
+
+// CommonMark to HTML in two passes, like cmark: lines are fed through the
+// open container blocks (block quotes, lists, list items) into leaf blocks,
+// then paragraph and heading text is parsed for inlines with a delimiter
+// stack for emphasis and a bracket stack for links and images.
+//
+// Covers the CommonMark block and inline grammar, including link reference
+// definitions, lazy continuation lines and tight/loose lists, with these
+// simplifications: tabs are expanded to four-column stops up front, named
+// entities are passed through rather than decoded, and an HTML block runs
+// to the next blank line whatever its start condition. Raw HTML is passed
+// through, so the output must go through HtmlSanitizer before it is served.
+class MarkdownRenderer {
+public:
+    static std::string render(std::string_view markdown);
+};
+
+} // namespace pyracms
@@ -5,6 +5,7 @@
 #include <optional>
 #include <string>
 #include <vector>
+#include "PageCursor.h"
 
 namespace pyracms {
 
@@ -37,8 +38,7 @@ public:
     void getNotifications(const DbClientPtr &db,
                           int userId,
                           bool unreadOnly,
-                          int limit,
-                          int offset,
+                          const PageRequest &page,
                           ListCallback cb);
 
     void markRead(const DbClientPtr &db,
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Keyset pagination for list endpoints. Kept free of Drogon so it can be
+// tested standalone.
+
+namespace pyracms {
+
+// Where a list page left off, handed to clients as an opaque string.
+//
+// Lists are ordered by a sort key, a timestamp as PostgreSQL prints it,
+// with the row id breaking ties. The next page continues with
+// "(key, id) < ($k, $i)" (">" for oldest-first lists), which an index on
+// the list's filter columns followed by (key, id) answers by seeking to
+// the position instead of reading and discarding every row before it, so
+// page 1000 costs what page 1 does. The scope ties a cursor to the list
+// it came from.
+struct PageCursor {
+    uint32_t scope = 0;
+    std::string key; // last returned (key, id)
+    int64_t id = 0;
+
+    // Names one list, e.g. ("followers", userId)
+    static uint32_t hashScope(std::string_view list, int64_t owner);
+
+    // URL-safe base64 of a versioned binary encoding
+    std::string encode() const;
+    // False for anything encode() did not produce
+    static bool decode(std::string_view text, PageCursor &out);
+};
+
+// One page of a list as asked for by ?limit=&offset=&cursor=. A cursor
+// takes precedence; offset is still honoured without one for clients that
+// predate cursors.
+struct PageRequest {
+    static constexpr int kDefaultLimit = 20;
+
+    uint32_t scope = 0;
+    int limit = kDefaultLimit;
+    int offset = 0;
+    bool hasCursor = false;
+    PageCursor after;
+
+    // False when the cursor is malformed or belongs to another list.
+    // Missing or unparsable limit and offset fall back to their defaults.
+    static bool parse(std::string_view limit, std::string_view offset, std::string_view cursor,
+                      uint32_t scope, PageRequest &out, int defaultLimit = kDefaultLimit);
+
+    // What to bind for the keyset predicate: the cursor's position, or on
+    // the first page one beyond every row ('infinity' sorts after every
+    // timestamp), so each list needs only one statement
+    std::string afterKey(bool ascending = false) const;
+    int64_t afterId(bool ascending = false) const;
+    // Rows to skip once past the keyset predicate
+    int skip() const { return hasCursor ? 0 : offset; }
+
+    // Cursor following a page of `returned` rows ending at (key, id); empty
+    // for a short page, which is the list's last
+    std::string next(size_t returned, std::string key, int64_t id) const;
+};
+
+// URL-safe base64 without padding, shared by the cursor encodings
+std::string base64UrlEncode(std::string_view in);
+bool base64UrlDecode(std::string_view in, std::string &out);
+
+} // namespace pyracms
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <queue>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace pyracms {
+
+// Due times of scheduled articles, earliest first. Kept free of Drogon so
+// it can be tested standalone; PublishScheduler owns the process-wide
+// instance and arms one timer for next().
+//
+// A min-heap with lazy deletion: rescheduling or cancelling only updates
+// the id's entry in a map, and heap entries that no longer match it are
+// dropped when they surface. The heap is rebuilt once stale entries
+// outnumber live ones, so churn cannot grow it without bound. Not
+// thread-safe; the scheduler only touches it from its loop.
+class PublishSchedule {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // One row of the article_schedule channel: "<id> <seconds until due>"
+    // when an article is (re)scheduled, "<id>" when it no longer is
+    struct Change {
+        int articleId = 0;
+        std::optional<double> delaySeconds;
+
+        static std::optional<Change> decode(std::string_view payload);
+    };
+
+    // Sets or moves the article's due time
+    void schedule(int articleId, Clock::time_point due);
+    void cancel(int articleId);
+    void clear();
+
+    // Earliest due time, if anything is scheduled
+    std::optional<Clock::time_point> next();
+
+    size_t size() const { return due_.size(); }
+
+private:
+    struct Entry {
+        Clock::time_point due;
+        int articleId;
+        bool operator>(const Entry &other) const {
+            if (due != other.due) return due > other.due;
+            return articleId > other.articleId;
+        }
+    };
+
+    bool live(const Entry &entry) const;
+    void compact();
+
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap_;
+    std::unordered_map<int, Clock::time_point> due_;
+};
+
+} // namespace pyracms
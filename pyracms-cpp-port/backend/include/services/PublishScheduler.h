@@ -0,0 +1,92 @@
+#pragma once
+
+#include <drogon/drogon.h>
+#include <drogon/orm/DbListener.h>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "PublishSchedule.h"
+
+namespace pyracms {
+
+// Publishes scheduled articles when they fall due.
+//
+// One node is the leader: it holds a PostgreSQL advisory lock on a
+// connection of its own, while every other node waits in
+// pg_advisory_lock() on theirs and takes over the moment the leader's
+// session ends. The leader loads the scheduled articles into a
+// PublishSchedule, LISTENs on article_schedule for changes made on any
+// node (a trigger on articles sends them), and keeps one timer armed for
+// the earliest due time; nothing runs while nothing is scheduled.
+//
+// Due times travel as seconds from the database's NOW(), so the node's
+// clock does not matter. Firing runs the same conditional UPDATE the
+// poll did, so a timer for an article changed meanwhile publishes nothing
+// it should not. Every PUBLISH_RESYNC_SECONDS (default 900, 0 = never)
+// the leader reloads the schedule in case a notification was lost while
+// its listener reconnected.
+class PublishScheduler {
+public:
+    struct Stats {
+        bool leader = false;
+        size_t scheduled = 0;
+        uint64_t runs = 0;
+        uint64_t published = 0;
+        uint64_t failures = 0;
+    };
+
+    static PublishScheduler &instance();
+
+    // Starts competing for leadership; call from a beginning advice
+    void start();
+
+    // Changes made through this node, applied without waiting for the
+    // notification, which arrives as well
+    void onScheduled(int articleId, double delaySeconds);
+    void onUnscheduled(int articleId);
+
+    Stats stats() const;
+
+private:
+    using Clock = PublishSchedule::Clock;
+
+    PublishScheduler() = default;
+
+    trantor::EventLoop *loop() const;
+    void acquire();
+    void lead(int backendPid);
+    void stepDown();
+    void load();
+    // Sets (or with no due time, cancels) an article's due time
+    void apply(int articleId, std::optional<Clock::time_point> due);
+    void arm();
+    void fire();
+    void publish();
+
+    // Everything below except the counters is only touched on the main loop
+    drogon::orm::DbClientPtr lockClient_;
+    drogon::orm::DbListenerPtr listener_;
+    PublishSchedule schedule_;
+    bool leader_ = false;
+    int backendPid_ = 0;
+    double resyncSeconds_ = 900.0;
+    // Changes that arrive while load() runs are replayed over its result
+    bool loading_ = false;
+    std::vector<std::pair<int, std::optional<Clock::time_point>>> changesWhileLoading_;
+    bool publishing_ = false;
+    std::optional<trantor::TimerId> timer_;
+    Clock::time_point armedFor_;
+    // No run starts before this: backs off after a failure
+    Clock::time_point notBefore_;
+    std::optional<trantor::TimerId> resyncTimer_;
+
+    std::atomic<bool> isLeader_{false};
+    std::atomic<size_t> scheduled_{0};
+    std::atomic<uint64_t> runs_{0};
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> failures_{0};
+};
+
+} // namespace pyracms
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "RespReader.h"
+
+#include <trantor/net/EventLoopThread.h>
+#include <trantor/net/InetAddress.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pyracms {
+
+// Non-blocking, pipelined RESP client on trantor sockets.
+//
+// Each event loop that issues a command gets its own connection, created
+// lazily and kept in thread-local storage, so the hot path takes no lock.
+// Commands are written immediately and matched to replies in FIFO order;
+// callbacks fire on the loop that issued the command. Callers that are not
+// on an event loop are served by a private fallback loop.
+//
+// Replies are decoded in place from the socket buffer: string views in the
+// RespValue passed to a callback are only valid for the duration of the call.
+class RedisClient {
+public:
+    using ReplyCallback = std::function<void(const RespValue &reply)>;
+    using MessageCallback = std::function<void(std::string_view payload)>;
+
+    RedisClient(std::string host, int port);
+    ~RedisClient();
+
+    // Resolves the server and checks it is reachable. Blocking — call once
+    // at startup, before app().run().
+    bool start();
+    bool isConnected() const;
+
+    void command(const std::vector<std::string> &args, ReplyCallback cb);
+
+    // Opens a dedicated connection subscribed to channel. Messages are
+    // delivered on the fallback loop; the subscription is re-issued after
+    // every reconnect.
+    void subscribe(const std::string &channel, MessageCallback cb);
+
+    static std::string encodeCommand(const std::vector<std::string> &args);
+
+private:
+    class Connection;
+    friend class Connection;
+
+    std::shared_ptr<Connection> localConnection(trantor::EventLoop *loop);
+
+    std::string host_;
+    int port_;
+    trantor::InetAddress serverAddr_;
+    std::atomic<bool> connected_{false};
+    std::unique_ptr<trantor::EventLoopThread> fallbackLoop_;
+    std::vector<std::shared_ptr<Connection>> subscribers_; // fallback loop only
+
+    static constexpr double kCommandTimeoutSeconds = 2.0;
+    static constexpr size_t kMaxInFlight = 10000;
+};
+
+} // namespace pyracms
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace pyracms {
+
+// A slice of a table's id space read by one reindex worker: rows with
+// lo < id <= hi, in id order. lastId is the checkpoint — every row up to
+// it has been acknowledged by Elasticsearch.
+struct IdRange {
+    int64_t lo = 0;
+    int64_t hi = 0;
+};
+
+// Splits the ids minId..maxId into at most `parts` contiguous ranges of
+// near-equal width. Gaps in the ids make ranges uneven in row count; that
+// only costs some parallelism. An empty table (maxId < minId) gets no
+// ranges.
+inline std::vector<IdRange> splitIdRange(int64_t minId, int64_t maxId, int parts) {
+    std::vector<IdRange> ranges;
+    if (maxId < minId) return ranges;
+    int64_t span = maxId - minId + 1;
+    int64_t n = parts < 1 ? 1 : parts;
+    if (n > span) n = span;
+    int64_t lo = minId - 1;
+    for (int64_t i = 1; i <= n; ++i) {
+        // The last range ends exactly at maxId whatever the rounding
+        int64_t hi = i == n ? maxId : minId - 1 + span * i / n;
+        ranges.push_back({lo, hi});
+        lo = hi;
+    }
+    return ranges;
+}
+
+// Throughput since a job was (re)started on this node, so documents
+// indexed before an interruption do not inflate the rate
+inline double docsPerSecond(int64_t docs, int64_t docsAtResume, double secondsSinceResume) {
+    if (secondsSinceResume <= 0 || docs <= docsAtResume) return 0.0;
+    return static_cast<double>(docs - docsAtResume) / secondsSinceResume;
+}
+
+} // namespace pyracms
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <drogon/drogon.h>
+#include <trantor/net/EventLoopThread.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include "ArticleRenderer.h"
+#include "LocalCache.h"
+
+namespace pyracms {
+
+// Rendered HTML for article revisions, cached by revision and renderer.
+//
+// A revision's text never changes, so its render is done once: in the
+// background when the revision is written or its article switches
+// renderer, and otherwise on first read. Renders are kept in
+// article_renders, whose version column retires those made by an older
+// ArticleRenderer, and in a LocalCache sized by RENDER_CACHE_MB (default
+// 64). Readers join article_renders into the query that fetches the
+// revision, so serving a stored render costs no extra round trip.
+//
+// Renders are written through DbRouter's primary as seen from the thread
+// doing the write, never the caller's client: that may be a replica, or a
+// fast client that must not be used from the render thread.
+class RenderService {
+public:
+    struct Stats {
+        uint64_t cacheHits = 0;
+        uint64_t rendered = 0;
+        uint64_t stored = 0;
+        uint64_t storeFailures = 0;
+        size_t cacheBytes = 0;
+    };
+
+    static RenderService &instance();
+
+    // For a revision whose render was not in article_renders: from memory,
+    // or rendered now and stored in the background
+    ArticleRenderer::Output render(int revisionId, const std::string &renderer,
+                                   const std::string &content);
+
+    // Renders on the render thread and stores the result
+    void renderInBackground(int revisionId, const std::string &renderer,
+                            std::string content);
+
+    Stats stats() const;
+
+private:
+    RenderService();
+
+    void store(int revisionId, const std::string &renderer,
+               const ArticleRenderer::Output &output);
+
+    LocalCache cache_;
+    std::unique_ptr<trantor::EventLoopThread> loopThread_;
+    std::atomic<uint64_t> cacheHits_{0};
+    std::atomic<uint64_t> rendered_{0};
+    std::atomic<uint64_t> stored_{0};
+    std::atomic<uint64_t> storeFailures_{0};
+};
+
+} // namespace pyracms
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pyracms {
+
+// One decoded RESP2/RESP3 value. String payloads are views into the buffer
+// they were parsed from and stay valid only until that buffer is consumed
+// or written to again — copy them if they must outlive the callback.
+struct RespValue {
+    enum class Type {
+        Nil,            // $-1, *-1, _
+        SimpleString,   // +
+        Error,          // -
+        Integer,        // :
+        BulkString,     // $
+        Array,          // *
+        Double,         // ,
+        Boolean,        // #
+        BigNumber,      // (
+        BulkError,      // !
+        VerbatimString, // =  (str excludes the "txt:" format prefix)
+        Map,            // %  (elements hold key, value, key, value, ...)
+        Set,            // ~
+        Push            // >
+    };
+
+    Type type = Type::Nil;
+    std::string_view str;
+    long long integer = 0;
+    double number = 0.0;
+    bool boolean = false;
+    std::vector<RespValue> elements;
+
+    bool isNil() const { return type == Type::Nil; }
+    bool isError() const { return type == Type::Error || type == Type::BulkError; }
+    bool isString() const {
+        return type == Type::BulkString || type == Type::SimpleString ||
+               type == Type::VerbatimString;
+    }
+    bool isAggregate() const {
+        return type == Type::Array || type == Type::Map || type == Type::Set ||
+               type == Type::Push;
+    }
+};
+
+// Incremental RESP reader over a growable buffer.
+//
+// Bytes can arrive in arbitrary fragments; next() yields each complete
+// value in order and reports Incomplete until enough bytes are buffered.
+// After an Incomplete, the reader remembers how many bytes it needs before
+// a retry can succeed, so a large bulk string trickling in over many reads
+// is not rescanned on every fragment. RESP3 attributes are skipped.
+class RespReader {
+public:
+    enum class Status { Ok, Incomplete, ProtocolError };
+
+    static constexpr size_t kMaxBulkLength = 512 * 1024 * 1024;
+    static constexpr size_t kMaxAggregateLength = 1 << 24;
+    static constexpr int kMaxDepth = 32;
+
+    // Parse a single value from the front of data without copying. On Ok,
+    // consumed is the value's wire length. On Incomplete, needed is a lower
+    // bound on the total length required before trying again.
+    static Status parse(const char *data, size_t len, RespValue &out, size_t &consumed,
+                        size_t &needed);
+
+    void feed(const char *data, size_t len);
+    void feed(std::string_view data) { feed(data.data(), data.size()); }
+
+    // Writable window for reading from a socket straight into the buffer.
+    char *prepare(size_t len);
+    void commit(size_t len);
+
+    // Views in out remain valid until the next feed(), prepare() or next().
+    Status next(RespValue &out);
+
+    size_t buffered() const { return end_ - begin_; }
+    void clear();
+
+private:
+    void compact();
+
+    std::vector<char> buf_;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    size_t needed_ = 0;
+    size_t pendingConsume_ = 0;
+};
+
+} // namespace pyracms
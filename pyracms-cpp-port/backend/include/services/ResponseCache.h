@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace pyracms {
+
+// A serialized HTTP response as stored by ResponseCache
+struct CachedResponse {
+    using Headers = std::vector<std::pair<std::string, std::string>>;
+    // Surrogate keys and their generation when the response was built
+    using Stamps = std::vector<std::pair<std::string, uint64_t>>;
+
+    int status = 200;
+    std::string contentType;
+    Headers headers;
+    std::string body;
+    Stamps stamps;
+    // Set by the handler for its own use on a hit, e.g. the id of the row
+    // whose view a cached article page still has to count; 0 if unused
+    int64_t tag = 0;
+};
+
+// Whole-response cache for public GET endpoints.
+//
+// Entries are tagged with surrogate keys ("article:3:home", "catalog") that
+// name the data they were built from. Purging a key bumps its generation,
+// which invalidates every entry stamped with an older one — the same
+// O(1) generation scheme CacheService uses for namespaces. Callers stamp
+// *before* querying the database, so a purge that lands while the response
+// is being built still invalidates it.
+//
+// Generations live in a fixed table indexed by a hash of the surrogate key,
+// so purging ever more distinct keys (every edited or deleted article)
+// costs no memory. Keys sharing a slot purge each other, which only costs
+// an occasional extra miss.
+//
+// Storage is a sharded LRU with a byte budget, like LocalCache; entries are
+// immutable and handed out by shared pointer.
+class ResponseCache {
+public:
+    using Entry = std::shared_ptr<const CachedResponse>;
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stores = 0;
+        uint64_t purges = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    // Budget from RESPONSE_CACHE_BYTES (default 32 MiB; 0 disables)
+    static ResponseCache &instance();
+
+    explicit ResponseCache(size_t byteBudget, size_t shardCount = 16);
+
+    bool enabled() const { return shardBudget_ > 0; }
+
+    // Route pattern, tenant, then the query parameters sorted by name so
+    // ?a=1&b=2 and ?b=2&a=1 share an entry. tenant_id is dropped from the
+    // parameters since it is already part of the key.
+    static std::string makeKey(std::string_view route, int tenantId,
+                               std::vector<std::pair<std::string, std::string>> params);
+
+    // Current generations of the given surrogate keys; take before building
+    CachedResponse::Stamps stamp(const std::vector<std::string> &surrogateKeys) const;
+
+    Entry get(const std::string &key);
+    Entry put(const std::string &key, CachedResponse response, std::chrono::milliseconds ttl);
+    void purge(const std::string &surrogateKey);
+
+    Stats stats() const;
+
+    // Surrogate key builders
+    static std::string articleKey(int tenantId, const std::string &name);
+    static std::string articleListKey(int tenantId);
+    static std::string galleryKey(int tenantId);
+    static constexpr const char *kCatalog = "catalog";
+
+    static constexpr size_t kEntryOverhead = 256;
+    static constexpr size_t kGenerationSlots = 16384;
+
+private:
+    struct Slot {
+        std::string key;
+        Entry entry;
+        Clock::time_point expiresAt;
+        size_t charge;
+    };
+
+    struct Shard {
+        mutable std::mutex mu;
+        std::list<Slot> lru; // front = most recently used
+        std::unordered_map<std::string_view, std::list<Slot>::iterator> index;
+        size_t bytes = 0;
+        uint64_t evictions = 0;
+
+        void unlink(std::list<Slot>::iterator it);
+    };
+
+    Shard &shardFor(const std::string &key);
+    bool current(const CachedResponse &response) const;
+
+    size_t shardBudget_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    std::atomic<uint64_t> &generation(const std::string &surrogateKey) const;
+
+    mutable std::array<std::atomic<uint64_t>, kGenerationSlots> generations_{};
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> stores_{0};
+    std::atomic<uint64_t> purges_{0};
+};
+
+} // namespace pyracms
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <drogon/drogon.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace pyracms {
+
+// Converts article revisions to snapshots and deltas: rows stored before
+// encoding (storage 0), and superseded rows that still hold their text.
+//
+// Started from POST /api/admin/articles/revisions/compact. A run finds the
+// affected articles in id order, batchSize at a time, and rewrites each
+// one's whole history oldest first, so chains are cut at the snapshot
+// interval however the rows were stored before. Every row can be rebuilt
+// at every point of the rewrite, so readers are unaffected; updates are
+// guarded on the storage they read, and rows already encoded as they would
+// be are skipped, so an interrupted run is simply started again.
+class RevisionCompactor {
+public:
+    using DbClientPtr = drogon::orm::DbClientPtr;
+
+    struct Progress {
+        bool running = false;
+        int lastArticleId = 0;
+        int64_t articles = 0;
+        int64_t revisions = 0; // rows rewritten
+        int64_t failures = 0;  // articles left as they were
+        uint64_t bytesBefore = 0;
+        uint64_t bytesAfter = 0;
+        std::string error;
+    };
+
+    static RevisionCompactor &instance();
+
+    // False if a run is already going on this node
+    bool start(const DbClientPtr &db, int batchSize);
+
+    Progress progress() const;
+
+private:
+    struct Update;
+
+    RevisionCompactor() = default;
+
+    void nextBatch(const DbClientPtr &db, int batchSize);
+    void compactBatch(const DbClientPtr &db, int batchSize,
+                      std::shared_ptr<const std::vector<int>> ids, size_t index);
+    void compactArticle(const DbClientPtr &db, int articleId, std::function<void()> then);
+    void write(const DbClientPtr &db, std::shared_ptr<const std::vector<Update>> updates,
+               size_t index, std::function<void()> then);
+    void finish(const std::string &error);
+
+    mutable std::mutex mu_;
+    Progress progress_;
+};
+
+} // namespace pyracms
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace pyracms {
+
+// Binary deltas between two versions of a text, in the style of git's
+// pack deltas: a target is described as copies of base ranges and
+// inserted literals.
+//
+// The base is indexed by a rolling hash of every aligned kBlockBytes
+// block. The target is scanned byte by byte; a hash hit that verifies is
+// extended forwards and backwards as far as the bytes agree and becomes a
+// copy, and everything between copies is inserted. An edit in the middle
+// of an article therefore costs roughly the edited bytes plus a few bytes
+// of framing, wherever it is.
+//
+// Format: varint base length, varint target length, then operations:
+// 0x00 varint length, literal bytes (insert) or 0x01 varint offset,
+// varint length (copy from base).
+class RevisionDelta {
+public:
+    static constexpr size_t kBlockBytes = 16;
+
+    static std::string diff(std::string_view base, std::string_view target);
+
+    // False if delta is malformed or was made against another base
+    static bool apply(std::string_view base, std::string_view delta, std::string &out);
+};
+
+} // namespace pyracms
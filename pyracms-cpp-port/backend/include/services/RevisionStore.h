@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "LocalCache.h"
+
+namespace pyracms {
+
+// Encoding of article revisions as zstd-compressed snapshots and deltas.
+// Kept free of Drogon so it can be tested and benchmarked standalone;
+// ArticleService reads and writes the rows.
+//
+// Each new revision is stored as a RevisionDelta against the revision it
+// follows, unless the chain of deltas since the last snapshot would reach
+// snapshotInterval, or the delta is not much smaller than the text, in
+// which case it is a snapshot. Rebuilding any revision therefore applies
+// fewer than snapshotInterval deltas. Rebuilt snapshots and revisions go
+// into an LRU cache, so neighbouring revisions share the work.
+class RevisionStore {
+public:
+    // article_revisions.storage
+    enum class Storage : int16_t {
+        Plain = 0,    // full text in content; rows from before encoding
+        Snapshot = 1, // body is the compressed text
+        Delta = 2,    // body is a compressed delta against base_id
+    };
+
+    struct Options {
+        int snapshotInterval = 16;
+        int compressionLevel = 3;
+        size_t cacheBytes = 32 * 1024 * 1024;
+    };
+
+    struct Encoded {
+        Storage storage = Storage::Snapshot;
+        int chain = 0; // deltas since the last snapshot, this one included
+        std::string body;
+    };
+
+    // A stored revision as read back
+    struct Row {
+        int id = 0;
+        int baseId = 0;
+        Storage storage = Storage::Plain;
+        std::optional<std::string> content; // NULL unless stored in full
+        std::string body;
+    };
+
+    struct Stats {
+        uint64_t rebuilds = 0;
+        uint64_t deltasApplied = 0;
+        uint64_t failures = 0;
+    };
+
+    RevisionStore();
+    explicit RevisionStore(Options options);
+
+    // previous is the text of the revision this one follows and
+    // previousChain its chain; nullptr for an article's first revision
+    Encoded encode(std::string_view content, const std::string *previous,
+                   int previousChain) const;
+
+    // chain is the wanted revision followed by its bases, back to one that
+    // stands alone (plain or snapshot) or is cached. Returns nullopt if the
+    // chain is broken or a body is corrupt.
+    std::optional<std::string> rebuild(const std::vector<Row> &chain);
+
+    // Every revision of an article, oldest first; a delta's base must come
+    // before it. Entries are nullopt where a revision cannot be rebuilt.
+    std::vector<std::optional<std::string>> rebuildAll(const std::vector<Row> &rows);
+
+    LocalCache::Value cached(int revisionId);
+
+    const Options &options() const { return options_; }
+    Stats stats() const;
+    LocalCache::Stats cacheStats() const { return cache_.stats(); }
+
+    std::string compress(std::string_view data) const;
+    // False if data is not a zstd frame of at most maxBytes
+    static bool decompress(std::string_view data, std::string &out,
+                           size_t maxBytes = 256 * 1024 * 1024);
+
+private:
+    static std::string cacheKey(int revisionId);
+    void remember(int revisionId, const std::string &content);
+
+    Options options_;
+    LocalCache cache_;
+    std::atomic<uint64_t> rebuilds_{0};
+    std::atomic<uint64_t> deltasApplied_{0};
+    std::atomic<uint64_t> failures_{0};
+};
+
+} // namespace pyracms
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "SearchTypes.h"
+
+// Federated pagination for searches that fan out to one query per content
+// type. Kept free of Drogon so it can be tested standalone.
+
+namespace pyracms {
+
+// Where a paged search left off, handed to clients as an opaque string.
+//
+// For the PostgreSQL path each source (content type) records the
+// (rank, id) of the last row it contributed, so the next page continues
+// with a keyset predicate instead of OFFSET. Facet estimates from the
+// first page ride along so later pages need not recompute them. Engines
+// that rank globally themselves (Elasticsearch, the embedded index) only
+// use offset.
+struct SearchCursor {
+    static constexpr int kSourceCount = 4;
+
+    struct Source {
+        bool started = false;   // some rows already returned
+        bool exhausted = false; // every match already returned
+        double rank = 0;        // last returned (rank, id)
+        int id = 0;
+    };
+
+    uint32_t queryHash = 0;
+    int offset = 0; // rows returned so far
+    std::array<Source, kSourceCount> sources{};
+    std::map<std::string, int> facets;
+
+    // Source index for "article", "forum_post", "snippet", "gamedep", or -1
+    static int sourceIndex(std::string_view type);
+    static const char *sourceType(int index);
+
+    // Ties a cursor to the search it came from
+    static uint32_t hashQuery(std::string_view query, std::string_view type);
+
+    // URL-safe base64 of a versioned binary encoding
+    std::string encode() const;
+    // False for anything encode() did not produce
+    static bool decode(std::string_view text, SearchCursor &out);
+};
+
+// One source's rows, best first, as returned by its query
+struct SourcePage {
+    int source = 0;
+    std::vector<SearchResultItem> items;
+    bool exhausted = false; // fewer rows than requested: nothing beyond these
+};
+
+// Global result order: rank descending, then source, then id descending.
+// Each source's query must return rows in this order.
+bool rankedBefore(const SearchResultItem &a, int sourceA, const SearchResultItem &b, int sourceB);
+
+// k-way heap merge of the sources' pages. Skips the first `skip` merged
+// rows, returns the next `limit`, and advances each source's position in
+// cursor past every row it consumed. A source is marked exhausted once
+// its page was exhausted and fully consumed.
+std::vector<SearchResultItem> mergeSourcePages(const std::vector<SourcePage> &pages, int skip,
+                                               int limit, SearchCursor &cursor);
+
+} // namespace pyracms
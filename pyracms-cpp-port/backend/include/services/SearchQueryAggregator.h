@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace pyracms {
+
+// Buffers search-query analytics in memory so the database sees one upsert
+// per distinct (tenant, query) per flush instead of one INSERT per search.
+// Kept free of Drogon so it can be tested standalone; AnalyticsService
+// owns the process-wide instance and writes drained counts to
+// search_query_stats.
+//
+// Keys hash into independently locked shards, so concurrent searches
+// rarely contend. Memory is bounded: once maxKeys distinct queries are
+// buffered, searches for new queries are counted as dropped until the
+// next drain (repeats of buffered queries still count).
+class SearchQueryAggregator {
+public:
+    struct Entry {
+        int tenantId = 0;
+        std::string query; // normalized
+        uint64_t searches = 0;
+        uint64_t resultSum = 0;
+    };
+
+    // Longest query stored, matching search_query_stats.query
+    static constexpr size_t kMaxQueryBytes = 500;
+
+    explicit SearchQueryAggregator(size_t maxKeys = 100000);
+
+    // Trims, collapses whitespace runs and lowercases ASCII letters, then
+    // truncates to kMaxQueryBytes without splitting a UTF-8 sequence
+    static std::string normalize(const std::string &query);
+
+    // False when the query is empty after normalizing or the buffer is full
+    bool record(int tenantId, const std::string &query, int resultCount);
+
+    // Removes and returns everything buffered
+    std::vector<Entry> drain();
+    // Puts entries back after a failed flush, merging with newer counts.
+    // Entries that no longer fit are dropped.
+    void restore(std::vector<Entry> entries);
+
+    // Whether a flush that failed with this SQLSTATE may succeed if retried:
+    // lost connections (class 08, or no state when the statement never got
+    // an answer), serialization failures, deadlocks, resource shortages and
+    // server shutdowns. Data and constraint errors would fail every time.
+    static bool retryable(std::string_view sqlState);
+    // After a failed flush: restores the entries if the error was retryable
+    // and drops them otherwise, so one bad batch cannot block later flushes.
+    // Returns true if they were restored.
+    bool flushFailed(std::vector<Entry> entries, std::string_view sqlState);
+
+    size_t size() const { return keys_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t kShards = 16;
+
+    struct Key {
+        int tenantId;
+        std::string query;
+        bool operator==(const Key &o) const { return tenantId == o.tenantId && query == o.query; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key &k) const {
+            return std::hash<std::string>()(k.query) * 31 + static_cast<size_t>(k.tenantId);
+        }
+    };
+    struct Counts {
+        uint64_t searches = 0;
+        uint64_t resultSum = 0;
+    };
+    struct Shard {
+        std::mutex mu;
+        std::unordered_map<Key, Counts, KeyHash> counts;
+    };
+
+    bool add(Key key, uint64_t searches, uint64_t resultSum);
+
+    const size_t maxKeys_;
+    std::array<Shard, kShards> shards_;
+    std::atomic<size_t> keys_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+} // namespace pyracms
@@ -5,41 +5,29 @@
 #include <map>
 #include <string>
 #include <vector>
+#include "SearchPagination.h"
+#include "SearchTypes.h"
 
 namespace pyracms {
 
-struct SearchResultItem {
-    std::string type;       // "article", "forum_post", "snippet", "gamedep"
-    int id;
-    std::string title;
-    std::string snippet;    // highlighted excerpt
-    std::string url;
-    double rank;
-    std::string createdAt;
-};
-
-struct SearchResults {
-    std::vector<SearchResultItem> items;
-    int totalCount;
-    std::string query;
-    std::map<std::string, int> facets;  // type -> count
-};
-
-struct AutocompleteItem {
-    std::string text;
-    std::string type;
-    std::string url;
-};
-
 class SearchService {
 public:
     using DbClientPtr = drogon::orm::DbClientPtr;
 
+    // First page, or the page at offset. Results are ranked across all
+    // requested types; nextCursor continues from the last row returned.
     void search(const DbClientPtr &db, int tenantId,
                 const std::string &query, const std::string &type,
                 int limit, int offset,
                 std::function<void(const SearchResults &)> cb);
 
+    // The page after the one that returned cursor. The caller checks that
+    // the cursor belongs to this query and type.
+    void resume(const DbClientPtr &db, int tenantId,
+                const std::string &query, const std::string &type,
+                int limit, const SearchCursor &cursor,
+                std::function<void(const SearchResults &)> cb);
+
     void autocomplete(const DbClientPtr &db, int tenantId,
                       const std::string &prefix, int limit,
                       std::function<void(const std::vector<AutocompleteItem> &)> cb);
@@ -47,22 +35,47 @@ public:
     // Check if Elasticsearch is the active search engine
     static bool useElasticsearch();
 
+    // Content hooks: forward to every engine that keeps its own index
+    static void indexArticle(int tenantId, int articleId,
+                             const std::string &name, const std::string &displayName,
+                             const std::string &content, const std::string &createdAt);
+    static void removeArticle(int articleId);
+
 private:
+    using SourceCallback = std::function<void(const std::vector<SearchResultItem> &, int)>;
+
+    void runSearch(const DbClientPtr &db, int tenantId,
+                   const std::string &query, const std::string &type,
+                   int limit, SearchCursor cursor, bool resumed,
+                   std::function<void(const SearchResults &)> cb);
+
+    // PostgreSQL: one keyset query per type, merged by rank
+    void searchFederated(const DbClientPtr &db, int tenantId,
+                         const std::string &query, const std::string &type,
+                         int limit, SearchCursor cursor, bool resumed,
+                         std::function<void(const SearchResults &)> cb);
+
+    // Each returns up to limit matches after the given (rank, id), best
+    // first, with ties broken by id descending
     void searchArticles(const DbClientPtr &db, int tenantId,
-                        const std::string &tsQuery, int limit, int offset,
-                        std::function<void(const std::vector<SearchResultItem> &, int)> cb);
+                        const std::string &tsQuery, const SearchCursor::Source &after,
+                        int limit, SourceCallback cb);
 
     void searchForumPosts(const DbClientPtr &db, int tenantId,
-                          const std::string &tsQuery, int limit, int offset,
-                          std::function<void(const std::vector<SearchResultItem> &, int)> cb);
+                          const std::string &tsQuery, const SearchCursor::Source &after,
+                          int limit, SourceCallback cb);
 
     void searchSnippets(const DbClientPtr &db, int tenantId,
-                        const std::string &tsQuery, int limit, int offset,
-                        std::function<void(const std::vector<SearchResultItem> &, int)> cb);
+                        const std::string &tsQuery, const SearchCursor::Source &after,
+                        int limit, SourceCallback cb);
+
+    void searchGameDeps(const DbClientPtr &db,
+                        const std::string &tsQuery, const SearchCursor::Source &after,
+                        int limit, SourceCallback cb);
 
-    void searchGameDeps(const DbClientPtr &db, int tenantId,
-                        const std::string &tsQuery, int limit, int offset,
-                        std::function<void(const std::vector<SearchResultItem> &, int)> cb);
+    // Planner row estimate for a type's matches; -1 if unavailable
+    void estimateMatches(const DbClientPtr &db, int source, int tenantId,
+                         const std::string &tsQuery, std::function<void(int)> cb);
 };
 
 } // namespace pyracms
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Search DTOs, kept free of Drogon so caches and codecs can use them
+// without pulling in the framework.
+
+namespace pyracms {
+
+struct SearchResultItem {
+    std::string type;       // "article", "forum_post", "snippet", "gamedep"
+    int id;
+    std::string title;
+    std::string snippet;    // plain-text excerpt around the best match
+    std::string url;
+    double rank;
+    std::string createdAt;
+    std::string highlight;  // snippet as escaped HTML with <mark>ed matches;
+                            // empty when the engine does not highlight
+};
+
+struct SearchResults {
+    std::vector<SearchResultItem> items;
+    int totalCount;
+    std::string query;
+    std::map<std::string, int> facets;  // type -> count
+    std::string nextCursor;             // opaque; empty on the last page
+    std::string suggestion;             // corrected query that items are for;
+                                        // empty when the query was not corrected
+};
+
+struct AutocompleteItem {
+    std::string text;
+    std::string type;
+    std::string url;
+};
+
+} // namespace pyracms
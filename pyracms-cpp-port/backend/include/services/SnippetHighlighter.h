@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pyracms {
+
+// Byte range of one token in a stored document body
+struct TokenSpan {
+    uint32_t start;
+    uint32_t end;
+};
+
+// Builds search snippets from token offsets recorded at index time, so a
+// query never re-tokenizes or rescans a document body.
+//
+// The snippet is the window of at most snippetChars bytes that covers the
+// most distinct query words, then the most matches, widened with context
+// and cut at token boundaries. Work per result is bounded whatever the
+// document size: at most maxMatches positions are considered, and the
+// window is placed with binary searches over the spans.
+class SnippetHighlighter {
+public:
+    struct Options {
+        size_t snippetChars = 200;
+        size_t maxMatches = 256;
+    };
+
+    // Ascending token ordinals (indexes into spans) where one indexed term
+    // occurs. word groups terms that came from the same query word, such as
+    // the expansions of a prefix.
+    struct Positions {
+        const uint32_t *data;
+        size_t size;
+        uint32_t word;
+    };
+
+    struct Result {
+        std::string snippet;   // plain text
+        std::string highlight; // HTML-escaped, matches wrapped in <mark>
+    };
+
+    // Falls back to the start of the body when nothing matches
+    static Result highlight(std::string_view body, const std::vector<TokenSpan> &spans,
+                            const std::vector<Positions> &terms, const Options &options);
+
+    static std::string escapeHtml(std::string_view text);
+};
+
+} // namespace pyracms
@@ -5,6 +5,7 @@
 #include <optional>
 #include <string>
 #include <vector>
+#include "PageCursor.h"
 
 namespace pyracms {
 
@@ -54,15 +55,21 @@ public:
     void isFollowing(const DbClientPtr &db, int followerId, int followedId,
                      std::function<void(bool)> cb);
 
-    void getFollowers(const DbClientPtr &db, int userId, int limit, int offset,
+    void getFollowers(const DbClientPtr &db, int userId, const PageRequest &page,
                       std::function<void(const std::vector<UserFollowDto> &, int total)> cb);
 
-    void getFollowing(const DbClientPtr &db, int userId, int limit, int offset,
+    void getFollowing(const DbClientPtr &db, int userId, const PageRequest &page,
                       std::function<void(const std::vector<UserFollowDto> &, int total)> cb);
 
-    void getActivityFeed(const DbClientPtr &db, int userId, int limit, int offset,
+    // Articles, forum posts and snippets, newest first
+    void getActivityFeed(const DbClientPtr &db, int userId, const PageRequest &page,
                          std::function<void(const std::vector<ActivityItem> &)> cb);
 
+    // The id to put in a feed cursor after this item. Items of different
+    // types may share a timestamp and an id, so the type is packed above
+    // the id to keep the feed's (created_at, type, id) order total.
+    static int64_t activityCursorId(const ActivityItem &item);
+
     void getUserAchievements(const DbClientPtr &db, int userId,
                              std::function<void(const std::vector<AchievementDto> &)> cb);
 
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace pyracms {
+
+// Per-tenant spelling dictionaries for "did you mean", using symmetric
+// deletes (SymSpell).
+//
+// Every word is stored under each string obtainable by deleting up to
+// maxDistance characters from its first prefixLength characters. A
+// misspelling generates its own deletes the same way; words sharing any
+// of them are the only candidates, and only those are checked with a real
+// edit distance. Lookups therefore cost a few dozen hash probes, however
+// large the dictionary.
+//
+// Deletes are kept as (hash, word) pairs in a sorted array, with recent
+// additions in a small hash table that is merged in once it grows to half
+// the array. Words are counted by the documents containing them; a word
+// whose count drops to zero stops being suggested but keeps its slot
+// until the index is rebuilt. Words of kSharedTenant (the gamedep
+// catalog) are offered to every tenant.
+class SpellingIndex {
+public:
+    static constexpr int kSharedTenant = -1;
+    static constexpr size_t kMinWordBytes = 3;
+    static constexpr size_t kMaxWordBytes = 32;
+
+    struct Options {
+        uint32_t maxDistance = 2;
+        size_t prefixLength = 7;
+    };
+
+    struct Suggestion {
+        std::string word;
+        uint32_t distance = 0;
+        uint64_t count = 0;
+    };
+
+    SpellingIndex();
+    explicit SpellingIndex(Options options);
+    ~SpellingIndex();
+    SpellingIndex(const SpellingIndex &) = delete;
+    SpellingIndex &operator=(const SpellingIndex &) = delete;
+
+    // Words that are not lowercase ASCII letters of kMinWordBytes to
+    // kMaxWordBytes are ignored
+    void add(int tenantId, std::string_view word, uint64_t count = 1);
+    void remove(int tenantId, std::string_view word, uint64_t count = 1);
+
+    bool contains(int tenantId, std::string_view word) const;
+
+    // Closest word within the distance allowed for word's length (one edit
+    // up to five letters, then two), preferring the most frequent. Known
+    // words suggest themselves at distance 0.
+    std::optional<Suggestion> suggest(int tenantId, std::string_view word) const;
+
+    // The query with each word that is not in the dictionary replaced by
+    // its best suggestion; empty when nothing would change
+    std::string correct(int tenantId, std::string_view query) const;
+
+    size_t size() const;
+
+    static bool isWord(std::string_view word);
+    // Lowercased ASCII letter runs of a document that qualify as words
+    static std::vector<std::string> words(std::string_view text);
+    // Optimal string alignment distance, or limit + 1 once it exceeds limit
+    static uint32_t distance(std::string_view a, std::string_view b, uint32_t limit);
+
+private:
+    struct Dictionary;
+
+    std::shared_ptr<Dictionary> findDictionary(int tenantId) const;
+    std::shared_ptr<Dictionary> dictionary(int tenantId);
+    static void lookup(const Dictionary &dict, const Options &options, std::string_view word,
+                       uint32_t maxDistance, std::optional<Suggestion> &best);
+
+    Options options_;
+    mutable std::shared_mutex mu_;
+    std::unordered_map<int, std::shared_ptr<Dictionary>> dictionaries_;
+};
+
+} // namespace pyracms
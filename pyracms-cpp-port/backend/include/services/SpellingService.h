@@ -0,0 +1,58 @@
+#pragma once
+
+#include <drogon/drogon.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "SpellingIndex.h"
+
+namespace pyracms {
+
+// Owns the in-memory SpellingIndex behind "did you mean" when
+// Elasticsearch, which has fuzzy matching of its own, is not the engine.
+//
+// rebuild() counts the distinct words of every searchable document per
+// tenant, gamedep pages going to the shared dictionary, and swaps the new
+// index in; it runs at startup and periodically. indexText() adds the
+// words of newly indexed content to the live index in place, and is
+// replayed onto a loading index like AutocompleteService's hooks. Counts
+// of edited documents drift upwards until the next rebuild. Until the
+// first rebuild finishes, ready() is false and queries are not corrected.
+class SpellingService {
+public:
+    using DbClientPtr = drogon::orm::DbClientPtr;
+
+    static SpellingService &instance();
+
+    void rebuild(const DbClientPtr &db);
+    bool ready() const { return ready_; }
+
+    // See SpellingIndex::correct
+    std::string correct(int tenantId, const std::string &query) const;
+
+    // Content hook
+    void indexText(int tenantId, const std::string &text);
+
+    size_t size() const;
+
+private:
+    SpellingService() = default;
+
+    // indexText calls made while a rebuild is loading
+    struct Op {
+        int tenantId;
+        std::vector<std::string> words;
+    };
+
+    static void applyTo(SpellingIndex &index, const Op &op);
+
+    mutable std::mutex mu_;
+    std::shared_ptr<SpellingIndex> index_;
+    bool rebuilding_ = false;
+    std::vector<Op> pending_;
+    std::atomic<bool> ready_{false};
+};
+
+} // namespace pyracms
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "RequestMetrics.h"
+
+namespace pyracms {
+
+// Detects event loops that stop turning.
+//
+// A watchdog thread posts a ping to every registered loop each interval and
+// the loop timestamps it when it runs, so the delay is the loop's lag. If a
+// ping is still queued after the stall threshold, the watchdog signals the
+// loop's thread, which records its own backtrace from the signal handler —
+// the frames of whatever is blocking it — and the report callback gets the
+// symbolized stack. Lags go into per-loop log-linear histograms exported on
+// /metrics.
+//
+// The loop abstraction is just "run this on the loop", so the watchdog has
+// no Drogon dependency; main.cpp registers trantor loops via queueInLoop.
+class StallWatchdog {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Post = std::function<void(std::function<void()>)>;
+
+    struct StallReport {
+        std::string loop;
+        std::chrono::milliseconds stalledFor;
+        std::vector<std::string> stack; // innermost frame first; empty if capture failed
+    };
+    using ReportCallback = std::function<void(const StallReport &)>;
+
+    static StallWatchdog &instance();
+
+    StallWatchdog();
+    ~StallWatchdog();
+    StallWatchdog(const StallWatchdog &) = delete;
+    StallWatchdog &operator=(const StallWatchdog &) = delete;
+
+    // Registers a loop; the first ping also learns the loop's thread.
+    // Call before start().
+    void addLoop(std::string name, Post post);
+
+    void start(std::chrono::milliseconds interval, std::chrono::milliseconds threshold,
+               ReportCallback onStall);
+    void stop();
+
+    struct LoopSnapshot {
+        std::string name;
+        uint64_t stalls = 0;
+        uint64_t maxLagMicros = 0;
+        uint64_t sumMicros = 0;
+        std::vector<uint64_t> buckets = std::vector<uint64_t>(LatencyBuckets::kCount);
+    };
+    std::vector<LoopSnapshot> snapshot() const;
+    std::string renderPrometheus() const;
+
+private:
+    struct Loop;
+
+    void run();
+    void check(const std::shared_ptr<Loop> &entry);
+    static std::vector<std::string> captureStack(pthread_t thread);
+
+    std::chrono::milliseconds interval_{100};
+    std::chrono::milliseconds threshold_{500};
+    ReportCallback onStall_;
+    std::vector<std::shared_ptr<Loop>> loops_;
+
+    std::mutex mu_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+} // namespace pyracms
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace pyracms {
+
+// Remembers, for a short window, which callers have just written. Keys hash
+// into a fixed table of deadlines, so marking and checking are a single
+// atomic each and memory stays bounded however many users write. Two keys
+// sharing a slot only make a read stick to the primary when it need not —
+// never the reverse.
+class StickyWindow {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit StickyWindow(std::chrono::milliseconds window, size_t slots = 4096)
+        : window_(window), mask_(roundUpPow2(slots) - 1),
+          deadlines_(std::make_unique<std::atomic<int64_t>[]>(mask_ + 1)) {
+        for (size_t i = 0; i <= mask_; ++i) deadlines_[i].store(0, std::memory_order_relaxed);
+    }
+
+    std::chrono::milliseconds window() const { return window_; }
+
+    void mark(uint64_t key, Clock::time_point now = Clock::now()) {
+        if (window_.count() <= 0) return;
+        int64_t deadline = toMs(now) + window_.count();
+        auto &slot = deadlines_[slotFor(key)];
+        int64_t current = slot.load(std::memory_order_relaxed);
+        while (current < deadline &&
+               !slot.compare_exchange_weak(current, deadline, std::memory_order_relaxed)) {
+        }
+    }
+
+    bool active(uint64_t key, Clock::time_point now = Clock::now()) const {
+        return deadlines_[slotFor(key)].load(std::memory_order_relaxed) > toMs(now);
+    }
+
+private:
+    static size_t roundUpPow2(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    static int64_t toMs(Clock::time_point t) {
+        // Offset by one so a zeroed slot is always in the past
+        return std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch())
+                   .count() +
+               1;
+    }
+
+    size_t slotFor(uint64_t key) const {
+        // splitmix64 finalizer: user ids are small and sequential
+        key ^= key >> 30;
+        key *= 0xbf58476d1ce4e5b9ULL;
+        key ^= key >> 27;
+        key *= 0x94d049bb133111ebULL;
+        key ^= key >> 31;
+        return static_cast<size_t>(key) & mask_;
+    }
+
+    std::chrono::milliseconds window_;
+    size_t mask_;
+    std::unique_ptr<std::atomic<int64_t>[]> deadlines_;
+};
+
+} // namespace pyracms
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <drogon/drogon.h>
+#include <atomic>
+#include <functional>
+#include "ViewCounter.h"
+
+namespace pyracms {
+
+// Write-behind view counts for articles, forum threads and gamedep pages.
+//
+// Reads record their view in the process-wide ViewCounter instead of
+// updating the row; flush() adds the drained counts to view_count with one
+// UPDATE ... FROM (VALUES ...) per table, in id order. main.cpp flushes
+// every VIEW_COUNT_FLUSH_SECONDS and once more on SIGTERM/SIGINT. DTOs
+// built from a row add pending() so responses show views not yet written.
+class ViewCountService {
+public:
+    using DbClientPtr = drogon::orm::DbClientPtr;
+    using Table = ViewCounter::Table;
+
+    static void record(Table table, int id) { counter().record(table, id); }
+    static int64_t pending(Table table, int id) { return counter().pending(table, id); }
+
+    // done runs once every statement has finished, written or not. Counts
+    // from a failed statement are kept for the next flush.
+    static void flush(const DbClientPtr &db, std::function<void()> done = {});
+
+    static const ViewCounter &views() { return counter(); }
+    static uint64_t flushed() { return flushed_.load(std::memory_order_relaxed); }
+    static uint64_t failed() { return failed_.load(std::memory_order_relaxed); }
+
+private:
+    static ViewCounter &counter();
+
+    static std::atomic<uint64_t> flushed_;
+    static std::atomic<uint64_t> failed_;
+};
+
+} // namespace pyracms
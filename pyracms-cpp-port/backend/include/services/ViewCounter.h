@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace pyracms {
+
+// Counts page views in memory so a read does not write the viewed row.
+// Kept free of Drogon so it can be tested standalone; ViewCountService
+// owns the process-wide instance and adds drained counts to view_count.
+//
+// Like SearchQueryAggregator, keys hash into independently locked shards,
+// and an increment is one hash-map update under its shard's lock. Drained
+// counts stay "in flight" until the write commits or fails, so pending()
+// covers every view the database does not show yet and a view count built
+// from a row plus pending() never goes backwards during a flush.
+class ViewCounter {
+public:
+    enum class Table : uint8_t { Article, ForumThread, GameDepPage };
+    static constexpr size_t kTableCount = 3;
+
+    struct Delta {
+        Table table;
+        int id;
+        int64_t views;
+    };
+
+    void record(Table table, int id, int64_t views = 1);
+
+    // Views of the row recorded but not yet committed
+    int64_t pending(Table table, int id) const;
+
+    // Moves everything recorded into flight and returns it, ordered by
+    // table and id so concurrent flushes lock rows in the same order
+    std::vector<Delta> drain();
+    // The write of drained deltas committed: they leave flight
+    void commit(const std::vector<Delta> &deltas);
+    // The write failed: the deltas are counted again for the next drain
+    void restore(const std::vector<Delta> &deltas);
+
+    // Rows with views not yet drained
+    size_t size() const { return keys_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t kShards = 32;
+
+    struct alignas(64) Shard {
+        mutable std::mutex mu;
+        std::unordered_map<uint64_t, int64_t> live;
+        std::unordered_map<uint64_t, int64_t> inFlight;
+    };
+
+    static uint64_t key(Table table, int id) {
+        return (static_cast<uint64_t>(table) << 32) | static_cast<uint32_t>(id);
+    }
+    Shard &shard(uint64_t key) { return shards_[(key * 0x9E3779B97F4A7C15ull >> 32) % kShards]; }
+    const Shard &shard(uint64_t key) const {
+        return shards_[(key * 0x9E3779B97F4A7C15ull >> 32) % kShards];
+    }
+
+    std::array<Shard, kShards> shards_;
+    std::atomic<size_t> keys_{0};
+};
+
+} // namespace pyracms
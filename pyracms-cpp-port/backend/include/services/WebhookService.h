@@ -4,6 +4,7 @@
 #include <functional>
 #include <string>
 #include <vector>
+#include "PageCursor.h"
 
 namespace pyracms {
 
@@ -50,7 +51,7 @@ public:
 
     void deleteWebhook(const DbClientPtr &db, int webhookId, BoolCallback cb);
 
-    void getDeliveries(const DbClientPtr &db, int webhookId, int limit, int offset,
+    void getDeliveries(const DbClientPtr &db, int webhookId, const PageRequest &page,
                        std::function<void(const std::vector<WebhookDeliveryDto> &)> cb);
 
     void fireEvent(const DbClientPtr &db, int tenantId,
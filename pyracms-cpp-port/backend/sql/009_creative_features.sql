@@ -77,11 +77,10 @@ CREATE TABLE IF NOT EXISTS webhook_deliveries (
     delivered_at TIMESTAMP WITH TIME ZONE NOT NULL DEFAULT NOW()
 );
 
--- Full-text search indexes
-CREATE INDEX IF NOT EXISTS idx_articles_search ON articles USING GIN(to_tsvector('english', name || ' ' || display_name));
-CREATE INDEX IF NOT EXISTS idx_forum_posts_search ON forum_posts USING GIN(to_tsvector('english', title || ' ' || content));
-CREATE INDEX IF NOT EXISTS idx_snippets_search ON code_snippets USING GIN(to_tsvector('english', title || ' ' || code));
-CREATE INDEX IF NOT EXISTS idx_gamedep_search ON gamedep_pages USING GIN(to_tsvector('english', name || ' ' || display_name || ' ' || description));
+-- Full-text search indexes: see 013_search_vectors.sql. The expression
+-- indexes that used to live here are dropped there; keeping them here would
+-- rebuild them on every start, since docker-entrypoint.sh reapplies all
+-- migrations.
 
 -- User profiles (social features)
 ALTER TABLE users ADD COLUMN IF NOT EXISTS bio TEXT DEFAULT '';
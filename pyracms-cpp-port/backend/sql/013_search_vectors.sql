@@ -0,0 +1,90 @@
+-- Stored, weighted tsvectors for PostgreSQL full-text search
+--
+-- Titles and names weigh 'A', bodies 'B'. Search matches and ranks on the
+-- stored column, so rows are tokenized once on write instead of on every
+-- query. Requires PostgreSQL 12+ for generated columns.
+
+-- Forum posts, snippets and gamedeps: generated columns
+ALTER TABLE forum_posts ADD COLUMN IF NOT EXISTS search_vector tsvector
+    GENERATED ALWAYS AS (
+        setweight(to_tsvector('english', coalesce(title, '')), 'A') ||
+        setweight(to_tsvector('english', coalesce(content, '')), 'B')
+    ) STORED;
+
+ALTER TABLE code_snippets ADD COLUMN IF NOT EXISTS search_vector tsvector
+    GENERATED ALWAYS AS (
+        setweight(to_tsvector('english', coalesce(title, '')), 'A') ||
+        setweight(to_tsvector('english', coalesce(code, '')), 'B')
+    ) STORED;
+
+ALTER TABLE gamedep_pages ADD COLUMN IF NOT EXISTS search_vector tsvector
+    GENERATED ALWAYS AS (
+        setweight(to_tsvector('english', coalesce(name, '') || ' ' || coalesce(display_name, '')), 'A') ||
+        setweight(to_tsvector('english', coalesce(description, '')), 'B')
+    ) STORED;
+
+-- Articles: the body lives in article_revisions, which a generated column
+-- cannot read, so the vector is maintained by triggers instead
+ALTER TABLE articles ADD COLUMN IF NOT EXISTS search_vector tsvector;
+
+CREATE OR REPLACE FUNCTION article_search_vector(p_name TEXT, p_display_name TEXT, p_article_id INTEGER)
+RETURNS tsvector AS $$
+    SELECT setweight(to_tsvector('english', coalesce(p_name, '') || ' ' || coalesce(p_display_name, '')), 'A') ||
+           setweight(to_tsvector('english', coalesce(
+               (SELECT content FROM article_revisions WHERE article_id = p_article_id
+                ORDER BY created_at DESC, id DESC LIMIT 1), '')), 'B');
+$$ LANGUAGE sql STABLE;
+
+CREATE OR REPLACE FUNCTION articles_search_vector_trigger() RETURNS trigger AS $$
+BEGIN
+    NEW.search_vector := article_search_vector(NEW.name, NEW.display_name, NEW.id);
+    RETURN NEW;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS trg_articles_search_vector ON articles;
+CREATE TRIGGER trg_articles_search_vector
+    BEFORE INSERT OR UPDATE OF name, display_name ON articles
+    FOR EACH ROW EXECUTE FUNCTION articles_search_vector_trigger();
+
+CREATE OR REPLACE FUNCTION article_revisions_search_vector_trigger() RETURNS trigger AS $$
+DECLARE
+    target INTEGER;
+BEGIN
+    IF TG_OP = 'DELETE' THEN
+        target := OLD.article_id;
+    ELSE
+        target := NEW.article_id;
+    END IF;
+    UPDATE articles SET search_vector = article_search_vector(name, display_name, id)
+    WHERE id = target;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS trg_article_revisions_search_vector ON article_revisions;
+CREATE TRIGGER trg_article_revisions_search_vector
+    AFTER INSERT OR UPDATE OF content OR DELETE ON article_revisions
+    FOR EACH ROW EXECUTE FUNCTION article_revisions_search_vector_trigger();
+
+-- Backfill; a no-op once every row has a vector
+UPDATE articles SET search_vector = article_search_vector(name, display_name, id)
+WHERE search_vector IS NULL;
+
+CREATE INDEX IF NOT EXISTS idx_articles_search_vector
+    ON articles USING GIN(search_vector);
+
+CREATE INDEX IF NOT EXISTS idx_forum_posts_search_vector
+    ON forum_posts USING GIN(search_vector);
+
+CREATE INDEX IF NOT EXISTS idx_snippets_search_vector
+    ON code_snippets USING GIN(search_vector);
+
+CREATE INDEX IF NOT EXISTS idx_gamedep_search_vector
+    ON gamedep_pages USING GIN(search_vector);
+
+-- The expression indexes from 009 no longer match any query
+DROP INDEX IF EXISTS idx_articles_search;
+DROP INDEX IF EXISTS idx_forum_posts_search;
+DROP INDEX IF EXISTS idx_snippets_search;
+DROP INDEX IF EXISTS idx_gamedep_search;
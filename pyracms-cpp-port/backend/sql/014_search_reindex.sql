@@ -0,0 +1,40 @@
+-- Checkpoints for Elasticsearch reindexes
+--
+-- A reindex streams every searchable row into a fresh set of versioned
+-- indexes (pyracms_articles_<suffix>, ...) and then swaps the aliases the
+-- application queries. Each source table is split into id ranges; a
+-- partition's last_id advances only after Elasticsearch has acknowledged
+-- the batch, so an interrupted job resumes where it stopped. While a job
+-- is running every node also writes live changes into the new indexes.
+
+CREATE TABLE IF NOT EXISTS search_reindex_jobs (
+    id SERIAL PRIMARY KEY,
+    suffix VARCHAR(64) NOT NULL UNIQUE,
+    status VARCHAR(20) NOT NULL DEFAULT 'running',  -- running, done
+    -- Node currently streaming; a stale heartbeat lets another node take over
+    owner VARCHAR(255),
+    heartbeat_at TIMESTAMPTZ,
+    started_at TIMESTAMPTZ NOT NULL DEFAULT NOW(),
+    -- Throughput is measured from the latest (re)start
+    resumed_at TIMESTAMPTZ,
+    docs_at_resume BIGINT NOT NULL DEFAULT 0,
+    finished_at TIMESTAMPTZ,
+    error TEXT
+);
+
+-- At most one job runs at a time
+CREATE UNIQUE INDEX IF NOT EXISTS idx_search_reindex_jobs_running
+    ON search_reindex_jobs ((status)) WHERE status = 'running';
+
+CREATE TABLE IF NOT EXISTS search_reindex_partitions (
+    job_id INTEGER NOT NULL REFERENCES search_reindex_jobs(id) ON DELETE CASCADE,
+    source VARCHAR(50) NOT NULL,
+    part INTEGER NOT NULL,
+    lo INTEGER NOT NULL,        -- exclusive
+    hi INTEGER NOT NULL,        -- inclusive
+    last_id INTEGER NOT NULL,   -- checkpoint: rows up to here are indexed
+    docs BIGINT NOT NULL DEFAULT 0,
+    total BIGINT NOT NULL DEFAULT 0,
+    done BOOLEAN NOT NULL DEFAULT FALSE,
+    PRIMARY KEY (job_id, source, part)
+);
@@ -0,0 +1,27 @@
+-- Aggregated search-query analytics
+--
+-- Searches are counted in memory and flushed as one upsert per distinct
+-- (tenant, normalized query) per interval, so search traffic no longer
+-- turns into one INSERT per search. Counts are kept per day for the
+-- reporting window. search_queries is no longer written.
+
+CREATE TABLE IF NOT EXISTS search_query_stats (
+    tenant_id INTEGER NOT NULL REFERENCES tenants(id) ON DELETE CASCADE,
+    day DATE NOT NULL,
+    query VARCHAR(500) NOT NULL,  -- trimmed, whitespace collapsed, lowercased
+    searches BIGINT NOT NULL DEFAULT 0,
+    result_sum BIGINT NOT NULL DEFAULT 0,
+    PRIMARY KEY (tenant_id, day, query)
+);
+
+-- One-time backfill from the per-search log
+INSERT INTO search_query_stats (tenant_id, day, query, searches, result_sum)
+SELECT tenant_id, created_at::date,
+       lower(btrim(regexp_replace(query, '\s+', ' ', 'g'))),
+       COUNT(*), SUM(result_count)
+FROM search_queries
+WHERE tenant_id IS NOT NULL
+  AND btrim(query) <> ''
+  AND NOT EXISTS (SELECT 1 FROM search_query_stats)
+GROUP BY 1, 2, 3
+ON CONFLICT DO NOTHING;
@@ -0,0 +1,46 @@
+-- Delta-compressed article revisions
+--
+-- Revisions are stored as zstd-compressed snapshots and deltas (see
+-- RevisionStore): storage 1 keeps the whole text in body, storage 2 a
+-- delta against base_id, and chain counts the deltas back to the last
+-- snapshot. Rows from before this migration are storage 0 with the text
+-- in content until POST /api/admin/articles/revisions/compact converts
+-- them.
+--
+-- The newest revision of each article also keeps its text in content, so
+-- the search vector, SEO and reindex queries that read the latest content
+-- are unchanged; content is cleared once a newer revision supersedes it.
+
+ALTER TABLE article_revisions ALTER COLUMN content DROP NOT NULL;
+ALTER TABLE article_revisions ADD COLUMN IF NOT EXISTS storage SMALLINT NOT NULL DEFAULT 0;
+-- No foreign key: a base is only ever deleted along with its article
+ALTER TABLE article_revisions ADD COLUMN IF NOT EXISTS base_id INTEGER;
+ALTER TABLE article_revisions ADD COLUMN IF NOT EXISTS chain INTEGER NOT NULL DEFAULT 0;
+ALTER TABLE article_revisions ADD COLUMN IF NOT EXISTS body BYTEA;
+
+-- Newest revision first, for appends and the article page
+CREATE INDEX IF NOT EXISTS idx_article_revisions_latest
+    ON article_revisions(article_id, created_at DESC, id DESC);
+-- Articles still holding unconverted rows, for the compaction job
+CREATE INDEX IF NOT EXISTS idx_article_revisions_plain
+    ON article_revisions(article_id) WHERE storage = 0;
+
+-- Clearing the content of a superseded revision leaves the latest text,
+-- and so the search vector, as it was
+CREATE OR REPLACE FUNCTION article_revisions_search_vector_trigger() RETURNS trigger AS $$
+DECLARE
+    target INTEGER;
+BEGIN
+    IF TG_OP = 'UPDATE' AND NEW.content IS NULL THEN
+        RETURN NULL;
+    END IF;
+    IF TG_OP = 'DELETE' THEN
+        target := OLD.article_id;
+    ELSE
+        target := NEW.article_id;
+    END IF;
+    UPDATE articles SET search_vector = article_search_vector(name, display_name, id)
+    WHERE id = target;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
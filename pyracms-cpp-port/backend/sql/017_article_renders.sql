@@ -0,0 +1,16 @@
+-- Rendered article revisions
+--
+-- The sanitized HTML and plain-text summary of a revision under one
+-- renderer (see RenderService). Revisions never change, so a render is
+-- only redone when version, ArticleRenderer::kVersion at the time, is
+-- older than the running build's. Rows go with their revision.
+
+CREATE TABLE IF NOT EXISTS article_renders (
+    revision_id INTEGER NOT NULL REFERENCES article_revisions(id) ON DELETE CASCADE,
+    renderer VARCHAR(50) NOT NULL,
+    version INTEGER NOT NULL,
+    html TEXT NOT NULL,
+    summary TEXT NOT NULL DEFAULT '',
+    rendered_at TIMESTAMP NOT NULL DEFAULT NOW(),
+    PRIMARY KEY (revision_id, renderer)
+);
@@ -0,0 +1,48 @@
+-- Indexes for keyset pagination
+--
+-- List endpoints page with "(created_at, id) < ($cursor)" instead of
+-- OFFSET (see PageCursor). Each index below leads with the list's filter
+-- columns followed by its (sort key, id) order, so a page of any depth is
+-- a seek plus `limit` rows. Follow lists break ties on the other user's
+-- id, which is unique within the list.
+
+-- GET /api/articles
+CREATE INDEX IF NOT EXISTS idx_articles_tenant_public_created
+    ON articles(tenant_id, created_at DESC, id DESC)
+    WHERE is_private = false;
+
+-- GET /api/gamedep/{type}
+CREATE INDEX IF NOT EXISTS idx_gamedep_pages_type_created
+    ON gamedep_pages(type, created_at DESC, id DESC);
+
+-- GET /api/comments/{contentType}/{contentId}, oldest first
+CREATE INDEX IF NOT EXISTS idx_comments_content_created
+    ON comments(content_type, content_id, created_at, id);
+DROP INDEX IF EXISTS idx_comments_content;
+
+-- GET /api/notifications; the unread index also serves the unread count
+CREATE INDEX IF NOT EXISTS idx_notifications_user_created_id
+    ON notifications(user_id, created_at DESC, id DESC);
+CREATE INDEX IF NOT EXISTS idx_notifications_user_unread_created
+    ON notifications(user_id, created_at DESC, id DESC)
+    WHERE is_read = FALSE;
+DROP INDEX IF EXISTS idx_notifications_user_created;
+DROP INDEX IF EXISTS idx_notifications_user_unread;
+
+-- GET /api/webhooks/{id}/deliveries
+CREATE INDEX IF NOT EXISTS idx_webhook_deliveries_webhook_delivered
+    ON webhook_deliveries(webhook_id, delivered_at DESC, id DESC);
+
+-- GET /api/users/{id}/followers and /following
+CREATE INDEX IF NOT EXISTS idx_follows_followed_created
+    ON follows(followed_id, created_at DESC, follower_id DESC);
+CREATE INDEX IF NOT EXISTS idx_follows_follower_created
+    ON follows(follower_id, created_at DESC, followed_id DESC);
+
+-- GET /api/users/{id}/activity: one per branch of the feed's UNION
+CREATE INDEX IF NOT EXISTS idx_articles_user_created
+    ON articles(user_id, created_at DESC, id DESC);
+CREATE INDEX IF NOT EXISTS idx_forum_posts_user_created
+    ON forum_posts(user_id, created_at DESC, id DESC);
+CREATE INDEX IF NOT EXISTS idx_snippets_author_created
+    ON code_snippets(author_id, created_at DESC, id DESC);
@@ -0,0 +1,29 @@
+-- Notifications for the in-memory publish schedule
+--
+-- PublishScheduler keeps the scheduled articles' due times in memory on
+-- the leader node and LISTENs on article_schedule for changes, whichever
+-- node (or a manual UPDATE) made them. Payloads are "<id> <seconds until
+-- due>" when an article is scheduled or moved, and "<id>" when it stops
+-- being scheduled. The delay is taken from the database's clock so node
+-- clocks do not matter; NOTIFY is only delivered on commit.
+
+CREATE OR REPLACE FUNCTION articles_schedule_notify_trigger() RETURNS trigger AS $$
+BEGIN
+    IF TG_OP <> 'DELETE' AND NEW.status = 'scheduled' AND NEW.scheduled_at IS NOT NULL THEN
+        IF TG_OP = 'INSERT'
+           OR OLD.status IS DISTINCT FROM NEW.status
+           OR OLD.scheduled_at IS DISTINCT FROM NEW.scheduled_at THEN
+            PERFORM pg_notify('article_schedule', NEW.id::text || ' ' ||
+                EXTRACT(EPOCH FROM NEW.scheduled_at - clock_timestamp())::float8::text);
+        END IF;
+    ELSIF TG_OP <> 'INSERT' AND OLD.status = 'scheduled' AND OLD.scheduled_at IS NOT NULL THEN
+        PERFORM pg_notify('article_schedule', OLD.id::text);
+    END IF;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS trg_articles_schedule_notify ON articles;
+CREATE TRIGGER trg_articles_schedule_notify
+    AFTER INSERT OR UPDATE OF status, scheduled_at OR DELETE ON articles
+    FOR EACH ROW EXECUTE FUNCTION articles_schedule_notify_trigger();
@@ -1,4 +1,5 @@
 #include "controllers/AnalyticsController.h"
+#include "services/DbRouter.h"
 
 #include <functional>
 #include <openssl/sha.h>
@@ -34,7 +35,7 @@ void AnalyticsController::getPageViews(
     auto period = req->getParameter("period");
     if (period.empty()) period = "day";
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     analyticsService_.getPageViews(
         db, tenantId, period,
@@ -68,7 +69,7 @@ void AnalyticsController::getTopContent(
     auto limitStr = req->getParameter("limit");
     if (!limitStr.empty()) limit = std::stoi(limitStr);
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     analyticsService_.getTopContent(
         db, tenantId, limit,
@@ -103,7 +104,7 @@ void AnalyticsController::getTrafficSources(
     auto limitStr = req->getParameter("limit");
     if (!limitStr.empty()) limit = std::stoi(limitStr);
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     analyticsService_.getTrafficSources(
         db, tenantId, limit,
@@ -137,7 +138,7 @@ void AnalyticsController::getSearchQueries(
     auto limitStr = req->getParameter("limit");
     if (!limitStr.empty()) limit = std::stoi(limitStr);
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     analyticsService_.getSearchQueries(
         db, tenantId, limit,
@@ -178,7 +179,7 @@ void AnalyticsController::trackPageView(
     auto peerAddr = req->getPeerAddr();
     std::string ipHash = sha256Hash(peerAddr.toIp());
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     analyticsService_.trackPageView(
         db, tenantId, path, referrer, userAgent, ipHash,
@@ -1,4 +1,11 @@
 #include "controllers/ArticleController.h"
+#include "services/DbRouter.h"
+#include "services/HttpResponseCache.h"
+#include "services/ResponseCache.h"
+#include "services/RevisionCompactor.h"
+#include "services/ViewCountService.h"
+
+#include <algorithm>
 
 namespace pyracms {
 
@@ -16,18 +23,27 @@ void ArticleController::listArticles(
     }
 
     int tenantId = std::stoi(tenantIdStr);
-    int limit = 20;
-    int offset = 0;
-    auto limitStr = req->getParameter("limit");
-    auto offsetStr = req->getParameter("offset");
-    if (!limitStr.empty()) limit = std::stoi(limitStr);
-    if (!offsetStr.empty()) offset = std::stoi(offsetStr);
+    PageRequest page;
+    if (!PageRequest::parse(req->getParameter("limit"), req->getParameter("offset"),
+                            req->getParameter("cursor"),
+                            PageCursor::hashScope("articles", tenantId), page)) {
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value{});
+        (*resp->jsonObject())["error"] = "cursor does not belong to this list";
+        resp->setStatusCode(drogon::k400BadRequest);
+        callback(resp);
+        return;
+    }
+
+    auto cacheKey = HttpResponseCache::keyFor(req, tenantId);
+    if (HttpResponseCache::serve(req, cacheKey, callback)) return;
+    auto send = HttpResponseCache::storing(
+        req, cacheKey, {ResponseCache::articleListKey(tenantId)}, 30, callback);
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().reader(req);
 
     articleService_.listArticles(
-        db, tenantId, limit, offset,
-        [callback](const std::vector<ArticleDto> &articles) {
+        db, tenantId, page,
+        [callback, send, page](const std::vector<ArticleDto> &articles) {
             Json::Value result(Json::arrayValue);
             for (const auto &a : articles) {
                 Json::Value item;
@@ -45,7 +61,13 @@ void ArticleController::listArticles(
                 item["scheduledAt"] = a.scheduledAt;
                 result.append(item);
             }
-            callback(drogon::HttpResponse::newHttpJsonResponse(result));
+            // An empty page may be a swallowed query error; don't pin it
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(result);
+            if (!articles.empty()) {
+                auto next = page.next(articles.size(), articles.back().createdAt, articles.back().id);
+                if (!next.empty()) resp->addHeader("X-Next-Cursor", next);
+            }
+            articles.empty() ? callback(resp) : send(resp);
         });
 }
 
@@ -69,7 +91,7 @@ void ArticleController::createArticle(
     auto renderer = (*json).get("renderer", "markdown").asString();
     int tenantId = (*json)["tenant_id"].asInt();
     int userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     articleService_.createArticle(
         db, tenantId, name, displayName, content, renderer, userId,
@@ -105,11 +127,24 @@ void ArticleController::getArticle(
     }
 
     int tenantId = std::stoi(tenantIdStr);
-    auto db = drogon::app().getDbClient();
+    // Views are counted in memory, so this is a pure read
+    auto db = DbRouter::instance().reader(req);
+
+    // A cached copy shows the view count as of when it was built, but the
+    // view itself is still counted, against the article id kept with the
+    // entry so a hit costs no query
+    auto cacheKey = HttpResponseCache::keyFor(req, tenantId);
+    int64_t cachedId = 0;
+    if (HttpResponseCache::serve(req, cacheKey, callback, &cachedId)) {
+        ViewCountService::record(ViewCounter::Table::Article, static_cast<int>(cachedId));
+        return;
+    }
+    auto send = HttpResponseCache::storingTagged(
+        req, cacheKey, {ResponseCache::articleKey(tenantId, name)}, 30, callback);
 
-    articleService_.getArticle(
+    articleService_.viewArticle(
         db, tenantId, name,
-        [this, db, callback](const std::optional<ArticleDto> &article) {
+        [this, db, callback, send](const std::optional<ArticleDto> &article) {
             if (!article) {
                 auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value{});
                 (*resp->jsonObject())["error"] = "Article not found";
@@ -118,10 +153,10 @@ void ArticleController::getArticle(
                 return;
             }
 
-            // Get the latest revision content
-            articleService_.listRevisions(
-                db, article->id,
-                [article, callback](const std::vector<ArticleRevisionDto> &revisions) {
+            // The latest revision, with its render
+            articleService_.getRenderedRevision(
+                db, article->id, article->rendererName,
+                [article, send](const std::optional<ArticleRevisionDto> &revision) {
                     Json::Value result;
                     result["id"] = article->id;
                     result["name"] = article->name;
@@ -135,12 +170,9 @@ void ArticleController::getArticle(
                     result["status"] = article->status;
                     result["publishedAt"] = article->publishedAt;
                     result["scheduledAt"] = article->scheduledAt;
-                    if (!revisions.empty()) {
-                        result["content"] = revisions[0].content;
-                    } else {
-                        result["content"] = "";
-                    }
-                    callback(drogon::HttpResponse::newHttpJsonResponse(result));
+                    result["content"] = revision ? revision->content : "";
+                    result["html"] = revision ? revision->html : "";
+                    send(drogon::HttpResponse::newHttpJsonResponse(result), article->id);
                 });
         });
 }
@@ -163,7 +195,7 @@ void ArticleController::updateArticle(
     auto summary = (*json).get("summary", "").asString();
     int tenantId = (*json)["tenant_id"].asInt();
     int userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     articleService_.updateArticle(
         db, tenantId, name, content, summary, userId,
@@ -198,7 +230,7 @@ void ArticleController::deleteArticle(
             return;
         }
         int tenantId = (*json)["tenant_id"].asInt();
-        auto db = drogon::app().getDbClient();
+        auto db = DbRouter::instance().primary();
 
         articleService_.deleteArticle(
             db, tenantId, name,
@@ -219,7 +251,7 @@ void ArticleController::deleteArticle(
     }
 
     int tenantId = std::stoi(tenantIdStr);
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     articleService_.deleteArticle(
         db, tenantId, name,
@@ -253,7 +285,7 @@ void ArticleController::listRevisions(
     }
 
     int tenantId = std::stoi(tenantIdStr);
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     // First find the article by name, then list revisions
     articleService_.getArticle(
@@ -293,7 +325,7 @@ void ArticleController::getRevision(
     const std::string &revId) {
 
     int revisionId = std::stoi(revId);
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     articleService_.getRevision(
         db, revisionId,
@@ -340,7 +372,7 @@ void ArticleController::revertToRevision(
 
     int revisionId = std::stoi(revId);
     int userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     // Find article by name first
     articleService_.getArticle(
@@ -388,7 +420,7 @@ void ArticleController::switchRenderer(
 
     auto renderer = (*json)["renderer"].asString();
     int tenantId = (*json)["tenant_id"].asInt();
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     // Find article by name first
     articleService_.getArticle(
@@ -435,7 +467,7 @@ void ArticleController::togglePrivate(
     }
 
     int tenantId = (*json)["tenant_id"].asInt();
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     articleService_.getArticle(
         db, tenantId, name,
@@ -483,7 +515,7 @@ void ArticleController::voteArticle(
     bool isLike = (*json)["is_like"].asBool();
     int tenantId = (*json)["tenant_id"].asInt();
     int userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     articleService_.getArticle(
         db, tenantId, name,
@@ -533,7 +565,7 @@ void ArticleController::setTags(
         tags.push_back(tag.asString());
     }
     int tenantId = (*json)["tenant_id"].asInt();
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     articleService_.getArticle(
         db, tenantId, name,
@@ -579,7 +611,7 @@ void ArticleController::publishArticle(
     }
 
     int tenantId = (*json)["tenant_id"].asInt();
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     articleService_.getArticle(
         db, tenantId, name,
@@ -625,7 +657,7 @@ void ArticleController::scheduleArticle(
 
     int tenantId = (*json)["tenant_id"].asInt();
     auto scheduledAt = (*json)["scheduled_at"].asString();
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     articleService_.getArticle(
         db, tenantId, name,
@@ -670,7 +702,7 @@ void ArticleController::unpublishArticle(
     }
 
     int tenantId = (*json)["tenant_id"].asInt();
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     articleService_.getArticle(
         db, tenantId, name,
@@ -700,4 +732,65 @@ void ArticleController::unpublishArticle(
         });
 }
 
+// ── Revision compaction (admin) ──────────────────────────────────────────────
+
+void ArticleController::requireSuperAdmin(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> callback,
+    std::function<void()> next) {
+
+    int userId = req->attributes()->get<int>("userId");
+    userService_.getUserRole(
+        DbRouter::instance().primary(), userId,
+        [callback, next](const std::optional<UserRole> &role) {
+            if (!role || !hasMinRole(*role, UserRole::SuperAdmin)) {
+                auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value{});
+                (*resp->jsonObject())["error"] = "Forbidden";
+                resp->setStatusCode(drogon::k403Forbidden);
+                callback(resp);
+                return;
+            }
+            next();
+        });
+}
+
+void ArticleController::compactionStatus(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) {
+
+    requireSuperAdmin(req, callback, [callback]() {
+        auto progress = RevisionCompactor::instance().progress();
+        Json::Value result;
+        result["running"] = progress.running;
+        result["lastArticleId"] = progress.lastArticleId;
+        result["articles"] = static_cast<Json::Int64>(progress.articles);
+        result["revisions"] = static_cast<Json::Int64>(progress.revisions);
+        result["failures"] = static_cast<Json::Int64>(progress.failures);
+        result["bytesBefore"] = static_cast<Json::UInt64>(progress.bytesBefore);
+        result["bytesAfter"] = static_cast<Json::UInt64>(progress.bytesAfter);
+        if (!progress.error.empty()) result["error"] = progress.error;
+        callback(drogon::HttpResponse::newHttpJsonResponse(result));
+    });
+}
+
+void ArticleController::compactRevisions(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) {
+
+    auto batchStr = req->getParameter("batch_size");
+    int batchSize = batchStr.empty() ? 100 : std::max(1, std::min(std::stoi(batchStr), 1000));
+
+    requireSuperAdmin(req, callback, [callback, batchSize]() {
+        bool started = RevisionCompactor::instance().start(DbRouter::instance().primary(),
+                                                           batchSize);
+        Json::Value result;
+        result["success"] = started;
+        result["message"] = started ? "Revision compaction started"
+                                    : "Revision compaction is already running";
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(result);
+        resp->setStatusCode(started ? drogon::k202Accepted : drogon::k409Conflict);
+        callback(resp);
+    });
+}
+
 } // namespace pyracms
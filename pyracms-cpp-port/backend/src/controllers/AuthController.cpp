@@ -1,4 +1,5 @@
 #include "controllers/AuthController.h"
+#include "services/DbRouter.h"
 
 namespace pyracms {
 
@@ -17,7 +18,7 @@ void AuthController::login(
 
     auto username = (*json)["username"].asString();
     auto password = (*json)["password"].asString();
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     // Get password hash, then verify
     userService_.getPasswordHash(
@@ -34,7 +35,7 @@ void AuthController::login(
             }
 
             // Get full user for the token
-            auto db = drogon::app().getDbClient();
+            auto db = DbRouter::instance().primary();
             userService_.findByUsername(
                 db, username,
                 [this, callback](const std::optional<UserDto> &user) {
@@ -98,7 +99,7 @@ void AuthController::registerUser(
         return;
     }
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     auto passwordHash = authService_.hashPassword(password);
 
     // Check if this is the first user (auto-promote to admin)
@@ -119,7 +120,7 @@ void AuthController::registerUser(
                 }
 
                 // Get the created user to generate token
-                auto db = drogon::app().getDbClient();
+                auto db = DbRouter::instance().primary();
                 userService_.findByUsername(
                     db, username,
                     [this, count, callback](
@@ -157,7 +158,7 @@ void AuthController::me(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback) {
 
     auto userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     userService_.findById(db, userId,
                           [callback](const std::optional<UserDto> &user) {
@@ -201,7 +202,7 @@ void AuthController::forgotPassword(
     }
 
     auto email = (*json)["email"].asString();
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     // Always return success to prevent email enumeration
     userService_.findByEmail(
@@ -263,7 +264,7 @@ void AuthController::resetPassword(
         return;
     }
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     db->execSqlAsync(
         "SELECT user_id FROM password_reset_tokens "
@@ -326,7 +327,7 @@ void AuthController::verifyEmail(
     }
 
     auto token = (*json)["token"].asString();
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     db->execSqlAsync(
         "SELECT user_id FROM email_verification_tokens "
@@ -403,7 +404,7 @@ void AuthController::oauthCallback(
     }
 
     auto code = (*json)["code"].asString();
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     oauthService_.exchangeCode(provider, code,
         [this, db, provider, callback](const std::string &accessToken, const std::string &error) {
@@ -507,7 +508,7 @@ void AuthController::oauthUnlink(
     const std::string &provider) {
 
     int userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     oauthService_.unlinkProvider(db, userId, provider,
         [callback](bool success, const std::string &error) {
@@ -529,7 +530,7 @@ void AuthController::oauthProviders(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback) {
 
     int userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     oauthService_.getLinkedProviders(db, userId,
         [callback](const std::vector<OAuthLinkDto> &links) {
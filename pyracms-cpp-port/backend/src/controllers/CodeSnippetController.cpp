@@ -1,4 +1,5 @@
 #include "controllers/CodeSnippetController.h"
+#include "services/DbRouter.h"
 
 namespace pyracms {
 
@@ -27,7 +28,7 @@ void CodeSnippetController::listSnippets(
     if (!offsetStr.empty()) offset = std::stoi(offsetStr);
     if (!authorStr.empty()) authorId = std::stoi(authorStr);
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     snippetService_.listSnippets(
         db, tenantId, language, authorId, limit, offset,
@@ -74,7 +75,7 @@ void CodeSnippetController::createSnippet(
     auto visibility = (*json).get("visibility", "public").asString();
     int tenantId = (*json)["tenant_id"].asInt();
     int userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     snippetService_.createSnippet(
         db, tenantId, userId, title, code, language, visibility,
@@ -102,7 +103,7 @@ void CodeSnippetController::getSnippet(
     const std::string &id) {
 
     int snippetId = std::stoi(id);
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     snippetService_.getSnippet(
         db, snippetId,
@@ -152,7 +153,7 @@ void CodeSnippetController::updateSnippet(
     auto code = (*json).get("code", "").asString();
     auto language = (*json).get("language", "python").asString();
     auto visibility = (*json).get("visibility", "public").asString();
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     snippetService_.updateSnippet(
         db, snippetId, userId, title, code, language, visibility,
@@ -178,7 +179,7 @@ void CodeSnippetController::deleteSnippet(
 
     int snippetId = std::stoi(id);
     int userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     snippetService_.deleteSnippet(
         db, snippetId, userId,
@@ -204,7 +205,7 @@ void CodeSnippetController::runSnippet(
 
     int snippetId = std::stoi(id);
     int userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     snippetService_.getSnippet(
         db, snippetId,
@@ -260,7 +261,7 @@ void CodeSnippetController::forkSnippet(
     int snippetId = std::stoi(id);
     int userId = req->attributes()->get<int>("userId");
     int tenantId = (*json)["tenant_id"].asInt();
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     snippetService_.forkSnippet(
         db, snippetId, userId, tenantId,
@@ -1,4 +1,5 @@
 #include "controllers/CommentController.h"
+#include "services/DbRouter.h"
 
 namespace pyracms {
 
@@ -8,25 +9,25 @@ void CommentController::getComments(
     const std::string &contentType,
     int contentId) {
 
-    auto db = drogon::app().getDbClient();
-
-    int limit = 50;
-    int offset = 0;
-    try {
-        auto limitParam = req->getParameter("limit");
-        if (!limitParam.empty()) limit = std::stoi(limitParam);
-        auto offsetParam = req->getParameter("offset");
-        if (!offsetParam.empty()) offset = std::stoi(offsetParam);
-    } catch (...) {
-        // Use defaults
+    auto db = DbRouter::instance().primary();
+
+    PageRequest page;
+    if (!PageRequest::parse(req->getParameter("limit"), req->getParameter("offset"),
+                            req->getParameter("cursor"),
+                            PageCursor::hashScope("comments:" + contentType, contentId), page,
+                            50)) {
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value{});
+        (*resp->jsonObject())["error"] = "cursor does not belong to this list";
+        resp->setStatusCode(drogon::k400BadRequest);
+        callback(resp);
+        return;
     }
 
-    if (limit > 200) limit = 200;
-    if (limit < 1) limit = 1;
+    if (page.limit > 200) page.limit = 200;
 
     commentService_.getComments(
-        db, contentType, contentId, limit, offset,
-        [callback](const std::vector<CommentDto> &comments) {
+        db, contentType, contentId, page,
+        [callback, page](const std::vector<CommentDto> &comments) {
             Json::Value result(Json::arrayValue);
             for (const auto &c : comments) {
                 Json::Value item;
@@ -43,7 +44,12 @@ void CommentController::getComments(
                 item["updatedAt"] = c.updatedAt;
                 result.append(item);
             }
-            callback(drogon::HttpResponse::newHttpJsonResponse(result));
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(result);
+            if (!comments.empty()) {
+                auto next = page.next(comments.size(), comments.back().createdAt, comments.back().id);
+                if (!next.empty()) resp->addHeader("X-Next-Cursor", next);
+            }
+            callback(resp);
         });
 }
 
@@ -78,7 +84,7 @@ void CommentController::createComment(
         parentId = (*json)["parentId"].asInt();
     }
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     commentService_.createComment(
         db, userId, contentType, contentId, body, parentId,
@@ -143,7 +149,7 @@ void CommentController::updateComment(
     }
 
     auto body = (*json)["body"].asString();
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     commentService_.updateComment(
         db, id, userId, body,
@@ -167,7 +173,7 @@ void CommentController::deleteComment(
     int id) {
 
     auto userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     commentService_.deleteComment(
         db, id, userId,
@@ -202,7 +208,7 @@ void CommentController::voteComment(
     }
 
     bool isLike = (*json)["isLike"].asBool();
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     commentService_.voteComment(
         db, id, userId, isLike,
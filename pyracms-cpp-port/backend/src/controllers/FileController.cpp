@@ -1,4 +1,5 @@
 #include "controllers/FileController.h"
+#include "services/DbRouter.h"
 #include <drogon/utils/Utilities.h>
 #include <fstream>
 #include <filesystem>
@@ -62,7 +63,7 @@ void FileController::upload(
     auto filePath = uploadDir + "/" + uuid;
     file.saveAs(filePath);
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     fileService_.uploadFile(
         db, filename, uuid, mimeStr, size, isPicture, isVideo,
         [callback, uuid, filename](bool success, const std::string &error) {
@@ -88,7 +89,7 @@ void FileController::download(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     const std::string &uuid) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     fileService_.getFile(
         db, uuid,
         [this, callback, uuid, db](const std::optional<FileDto> &file) {
@@ -130,7 +131,7 @@ void FileController::thumbnail(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     const std::string &uuid) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     fileService_.getFile(
         db, uuid,
         [callback, uuid](const std::optional<FileDto> &file) {
@@ -174,7 +175,7 @@ void FileController::remove(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     const std::string &uuid) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     fileService_.deleteFile(
         db, uuid,
         [callback, uuid](bool success, const std::string &error) {
@@ -209,7 +210,7 @@ void FileController::list(
     int limit = limitStr.empty() ? 50 : std::stoi(limitStr);
     int offset = offsetStr.empty() ? 0 : std::stoi(offsetStr);
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     fileService_.listFiles(
         db, limit, offset,
         [callback](const std::vector<FileDto> &files) {
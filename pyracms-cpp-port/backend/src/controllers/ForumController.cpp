@@ -1,4 +1,5 @@
 #include "controllers/ForumController.h"
+#include "services/DbRouter.h"
 
 namespace pyracms {
 
@@ -18,7 +19,7 @@ void ForumController::listCategories(
     }
 
     int tenantId = std::stoi(tenantIdStr);
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     forumService_.listCategories(
         db, tenantId,
@@ -62,7 +63,7 @@ void ForumController::createCategory(
 
     auto name = (*json)["name"].asString();
     int tenantId = (*json)["tenantId"].asInt();
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     forumService_.createCategory(
         db, tenantId, name,
@@ -95,7 +96,7 @@ void ForumController::updateCategory(
     }
 
     auto name = (*json)["name"].asString();
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     forumService_.updateCategory(
         db, id, name,
@@ -118,7 +119,7 @@ void ForumController::deleteCategory(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     forumService_.deleteCategory(
         db, id,
         [callback](bool success, const std::string &error) {
@@ -142,7 +143,7 @@ void ForumController::getForum(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     forumService_.getForum(
         db, id,
         [callback](const std::optional<ForumWithThreadsDto> &forumData) {
@@ -197,7 +198,7 @@ void ForumController::createForum(
     auto description = (*json).isMember("description")
                            ? (*json)["description"].asString()
                            : "";
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     forumService_.createForum(
         db, categoryId, name, description,
@@ -233,7 +234,7 @@ void ForumController::updateForum(
     auto description = (*json).isMember("description")
                            ? (*json)["description"].asString()
                            : "";
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     forumService_.updateForum(
         db, id, name, description,
@@ -256,7 +257,7 @@ void ForumController::deleteForum(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     forumService_.deleteForum(
         db, id,
         [callback](bool success, const std::string &error) {
@@ -280,7 +281,7 @@ void ForumController::getThread(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().reader(req);
     forumService_.getThread(
         db, id,
         [callback](const std::optional<ForumThreadWithPostsDto> &threadData) {
@@ -339,7 +340,7 @@ void ForumController::createThread(
                            : "";
     auto content = (*json)["content"].asString();
     int userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     forumService_.createThread(
         db, forumId, title, description, content, userId,
@@ -375,7 +376,7 @@ void ForumController::updateThread(
     auto description = (*json).isMember("description")
                            ? (*json)["description"].asString()
                            : "";
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     forumService_.updateThread(
         db, id, title, description,
@@ -398,7 +399,7 @@ void ForumController::deleteThread(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     forumService_.deleteThread(
         db, id,
         [callback](bool success, const std::string &error) {
@@ -434,7 +435,7 @@ void ForumController::createPost(
     auto title = (*json).isMember("title") ? (*json)["title"].asString() : "";
     auto content = (*json)["content"].asString();
     int userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     forumService_.createPost(
         db, threadId, title, content, userId,
@@ -457,7 +458,7 @@ void ForumController::getPostById(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     forumService_.getPost(
         db, id,
         [callback](const std::optional<ForumPostDto> &post) {
@@ -497,7 +498,7 @@ void ForumController::updatePost(
 
     auto title = (*json).isMember("title") ? (*json)["title"].asString() : "";
     auto content = (*json)["content"].asString();
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     forumService_.updatePost(
         db, id, title, content,
@@ -520,7 +521,7 @@ void ForumController::deletePost(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     forumService_.deletePost(
         db, id,
         [callback](bool success, const std::string &error) {
@@ -553,7 +554,7 @@ void ForumController::votePost(
 
     bool isLike = (*json)["isLike"].asBool();
     int userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     forumService_.votePost(
         db, id, userId, isLike,
@@ -1,4 +1,7 @@
 #include "controllers/GalleryController.h"
+#include "services/DbRouter.h"
+#include "services/HttpResponseCache.h"
+#include "services/ResponseCache.h"
 
 namespace pyracms {
 
@@ -16,10 +19,15 @@ void GalleryController::listAlbums(
     }
 
     int tenantId = std::stoi(tenantIdStr);
-    auto db = drogon::app().getDbClient();
+    auto cacheKey = HttpResponseCache::keyFor(req, tenantId);
+    if (HttpResponseCache::serve(req, cacheKey, callback)) return;
+    auto send = HttpResponseCache::storing(
+        req, cacheKey, {ResponseCache::galleryKey(tenantId)}, 60, callback);
+
+    auto db = DbRouter::instance().primary();
     galleryService_.listAlbums(
         db, tenantId,
-        [callback](const std::vector<GalleryAlbumDto> &albums) {
+        [callback, send](const std::vector<GalleryAlbumDto> &albums) {
             Json::Value result(Json::arrayValue);
             for (const auto &a : albums) {
                 Json::Value item;
@@ -34,7 +42,9 @@ void GalleryController::listAlbums(
                 item["pictureCount"] = a.pictureCount;
                 result.append(item);
             }
-            callback(drogon::HttpResponse::newHttpJsonResponse(result));
+            // An empty list may be a swallowed query error; don't pin it
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(result);
+            albums.empty() ? callback(resp) : send(resp);
         });
 }
 
@@ -59,7 +69,7 @@ void GalleryController::createAlbum(
     int tenantId = (*json)["tenantId"].asInt();
     int userId = req->attributes()->get<int>("userId");
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     galleryService_.createAlbum(
         db, tenantId, displayName, description, userId,
         [callback](bool success, const std::string &error) {
@@ -83,7 +93,7 @@ void GalleryController::getAlbum(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     galleryService_.getAlbum(
         db, id,
         [callback](const std::optional<GalleryAlbumDetailDto> &detail) {
@@ -145,7 +155,7 @@ void GalleryController::updateAlbum(
                            ? (*json)["description"].asString()
                            : "";
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     galleryService_.updateAlbum(
         db, id, displayName, description,
         [callback](bool success, const std::string &error) {
@@ -169,7 +179,7 @@ void GalleryController::deleteAlbum(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     galleryService_.deleteAlbum(
         db, id,
         [callback](bool success, const std::string &error) {
@@ -210,7 +220,7 @@ void GalleryController::addPicture(
     auto fileUuid = (*json)["fileUuid"].asString();
     int userId = req->attributes()->get<int>("userId");
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     galleryService_.addPicture(
         db, id, displayName, description, fileUuid, userId,
         [callback](bool success, const std::string &error) {
@@ -234,7 +244,7 @@ void GalleryController::getPicture(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     galleryService_.getPicture(
         db, id,
         [callback](const std::optional<GalleryPictureDto> &picture) {
@@ -279,7 +289,7 @@ void GalleryController::updatePicture(
                            ? (*json)["description"].asString()
                            : "";
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     galleryService_.updatePicture(
         db, id, displayName, description,
         [callback](bool success, const std::string &error) {
@@ -303,7 +313,7 @@ void GalleryController::deletePicture(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     galleryService_.deletePicture(
         db, id,
         [callback](bool success, const std::string &error) {
@@ -338,7 +348,7 @@ void GalleryController::setDefaultPicture(
 
     int albumId = (*json)["albumId"].asInt();
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     galleryService_.setDefaultPicture(
         db, albumId, id,
         [callback](bool success, const std::string &error) {
@@ -374,7 +384,7 @@ void GalleryController::votePicture(
     bool isLike = (*json)["isLike"].asBool();
     int userId = req->attributes()->get<int>("userId");
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     galleryService_.votePicture(
         db, id, userId, isLike,
         [callback](bool success, const std::string &error) {
@@ -1,4 +1,7 @@
 #include "controllers/GameDepController.h"
+#include "services/DbRouter.h"
+#include "services/HttpResponseCache.h"
+#include "services/ResponseCache.h"
 
 namespace pyracms {
 
@@ -26,17 +29,18 @@ void GameDepController::listPages(
         return;
     }
 
-    int limit = 20;
-    int offset = 0;
-    auto limitParam = req->getParameter("limit");
-    auto offsetParam = req->getParameter("offset");
-    if (!limitParam.empty()) limit = std::stoi(limitParam);
-    if (!offsetParam.empty()) offset = std::stoi(offsetParam);
+    PageRequest page;
+    if (!PageRequest::parse(req->getParameter("limit"), req->getParameter("offset"),
+                            req->getParameter("cursor"), PageCursor::hashScope("gamedep:" + type, 0),
+                            page)) {
+        callback(jsonError("cursor does not belong to this list", drogon::k400BadRequest));
+        return;
+    }
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     gameDepService_.listPages(
-        db, type, limit, offset,
-        [callback](const std::vector<GameDepPageDto> &pages) {
+        db, type, page,
+        [callback, page](const std::vector<GameDepPageDto> &pages) {
             Json::Value result(Json::arrayValue);
             for (const auto &p : pages) {
                 Json::Value item;
@@ -50,7 +54,12 @@ void GameDepController::listPages(
                 item["viewCount"] = p.viewCount;
                 result.append(item);
             }
-            callback(drogon::HttpResponse::newHttpJsonResponse(result));
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(result);
+            if (!pages.empty()) {
+                auto next = page.next(pages.size(), pages.back().createdAt, pages.back().id);
+                if (!next.empty()) resp->addHeader("X-Next-Cursor", next);
+            }
+            callback(resp);
         });
 }
 
@@ -75,7 +84,7 @@ void GameDepController::createPage(
     auto description = (*json).get("description", "").asString();
     auto ownerId = req->attributes()->get<int>("userId");
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     gameDepService_.createPage(
         db, type, name, displayName, description, ownerId,
         [callback](bool success, const std::string &error) {
@@ -102,8 +111,8 @@ void GameDepController::getPage(
         return;
     }
 
-    auto db = drogon::app().getDbClient();
-    gameDepService_.getPage(
+    auto db = DbRouter::instance().primary();
+    gameDepService_.viewPage(
         db, type, name,
         [callback](const std::optional<GameDepPageDto> &page,
                    const std::vector<GameDepRevisionDto> &revisions) {
@@ -160,7 +169,7 @@ void GameDepController::updatePage(
     auto displayName = (*json)["displayName"].asString();
     auto description = (*json).get("description", "").asString();
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     gameDepService_.updatePage(
         db, type, name, displayName, description,
         [callback](bool success, const std::string &error) {
@@ -185,7 +194,7 @@ void GameDepController::deletePage(
         return;
     }
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     gameDepService_.deletePage(
         db, type, name,
         [callback](bool success, const std::string &error) {
@@ -220,7 +229,7 @@ void GameDepController::createRevision(
     auto moduleType = (*json).get("moduleType", "").asString();
 
     // First look up the page to get its ID
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     gameDepService_.getPage(
         db, type, name,
         [this, db, callback, version, moduleType]
@@ -269,7 +278,7 @@ void GameDepController::updateRevision(
     auto moduleType = (*json).get("moduleType", "").asString();
 
     // Look up the revision by page name + version
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     gameDepService_.getPage(
         db, type, name,
         [this, db, callback, ver, version, moduleType]
@@ -317,7 +326,7 @@ void GameDepController::deleteRevision(
         return;
     }
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     gameDepService_.getPage(
         db, type, name,
         [this, db, callback, ver]
@@ -364,7 +373,7 @@ void GameDepController::togglePublish(
         return;
     }
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     gameDepService_.getPage(
         db, type, name,
         [this, db, callback, ver]
@@ -419,7 +428,7 @@ void GameDepController::uploadSource(
 
     auto fileId = (*json)["fileId"].asInt();
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     gameDepService_.getPage(
         db, type, name,
         [this, db, callback, ver, fileId]
@@ -477,7 +486,7 @@ void GameDepController::addBinary(
     auto archId = (*json)["archId"].asInt();
     auto fileId = (*json)["fileId"].asInt();
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     gameDepService_.getPage(
         db, type, name,
         [this, db, callback, ver, osId, archId, fileId]
@@ -523,7 +532,7 @@ void GameDepController::deleteBinary(
     const std::string &ver,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     gameDepService_.deleteBinary(
         db, id,
         [callback](bool success, const std::string &error) {
@@ -556,7 +565,7 @@ void GameDepController::addDependency(
 
     auto depRevisionId = (*json)["depRevisionId"].asInt();
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     gameDepService_.getPage(
         db, type, name,
         [this, db, callback, depRevisionId]
@@ -589,7 +598,7 @@ void GameDepController::removeDependency(
     const std::string &name,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     gameDepService_.removeDependency(
         db, id,
         [callback](bool success, const std::string &error) {
@@ -625,7 +634,7 @@ void GameDepController::setTags(
         tags.push_back(tag.asString());
     }
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     gameDepService_.getPage(
         db, type, name,
         [this, db, callback, tags]
@@ -669,7 +678,7 @@ void GameDepController::vote(
     auto isLike = (*json)["isLike"].asBool();
     auto userId = req->attributes()->get<int>("userId");
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     gameDepService_.getPage(
         db, type, name,
         [this, db, callback, userId, isLike]
@@ -697,10 +706,18 @@ void GameDepController::getFullCatalog(
     const drogon::HttpRequestPtr &req,
     std::function<void(const drogon::HttpResponsePtr &)> &&callback) {
 
-    auto db = drogon::app().getDbClient();
+    auto cacheKey = HttpResponseCache::keyFor(req, 0);
+    if (HttpResponseCache::serve(req, cacheKey, callback)) return;
+    auto send = HttpResponseCache::storing(req, cacheKey, {ResponseCache::kCatalog}, 300,
+                                           callback);
+
+    auto db = DbRouter::instance().reader(req);
     gameDepService_.getFullCatalogJson(
-        db, [callback](const Json::Value &catalog) {
-            callback(drogon::HttpResponse::newHttpJsonResponse(catalog));
+        db, [callback, send](const Json::Value &catalog) {
+            // The service reports query errors as an empty catalog; don't pin it
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(catalog);
+            bool empty = catalog["games"].empty() && catalog["deps"].empty();
+            empty ? callback(resp) : send(resp);
         });
 }
 
@@ -708,7 +725,7 @@ void GameDepController::listOperatingSystems(
     const drogon::HttpRequestPtr &req,
     std::function<void(const drogon::HttpResponsePtr &)> &&callback) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     gameDepService_.listOperatingSystems(
         db, [callback](const std::vector<OperatingSystemDto> &items) {
             Json::Value result(Json::arrayValue);
@@ -727,7 +744,7 @@ void GameDepController::listArchitectures(
     const drogon::HttpRequestPtr &req,
     std::function<void(const drogon::HttpResponsePtr &)> &&callback) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     gameDepService_.listArchitectures(
         db, [callback](const std::vector<ArchitectureDto> &items) {
             Json::Value result(Json::arrayValue);
@@ -1,4 +1,5 @@
 #include "controllers/MenuController.h"
+#include "services/DbRouter.h"
 
 namespace pyracms {
 
@@ -16,7 +17,7 @@ void MenuController::listGroups(
     }
 
     int tenantId = std::stoi(tenantIdStr);
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     menuService_.listMenuGroups(
         db, tenantId,
         [callback](const std::vector<MenuGroupDto> &groups) {
@@ -47,7 +48,7 @@ void MenuController::createGroup(
     int tenantId = (*json)["tenantId"].asInt();
     auto name = (*json)["name"].asString();
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     menuService_.createMenuGroup(
         db, tenantId, name,
         [callback](bool success, const std::string &error) {
@@ -71,7 +72,7 @@ void MenuController::deleteGroup(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     menuService_.deleteMenuGroup(
         db, id,
         [callback](bool success, const std::string &error) {
@@ -95,7 +96,7 @@ void MenuController::listItems(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     menuService_.listMenuItems(
         db, id,
         [callback](const std::vector<MenuItemDto> &items) {
@@ -137,7 +138,7 @@ void MenuController::createItem(
     int position = (*json).get("position", 0).asInt();
     auto permissions = (*json).get("permissions", "").asString();
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     menuService_.createMenuItem(
         db, name, routePath, url, type, id, position, permissions,
         [callback](bool success, const std::string &error) {
@@ -170,7 +171,7 @@ void MenuController::updateItem(
         return;
     }
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     menuService_.updateMenuItem(
         db, id, *json,
         [callback](bool success, const std::string &error) {
@@ -194,7 +195,7 @@ void MenuController::deleteItem(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     menuService_.deleteMenuItem(
         db, id,
         [callback](bool success, const std::string &error) {
@@ -0,0 +1,187 @@
+#include "controllers/MetricsController.h"
+#include "services/AnalyticsService.h"
+#include "services/ArticleService.h"
+#include "services/AutocompleteService.h"
+#include "services/CacheService.h"
+#include "services/ElasticsearchService.h"
+#include "services/EmbeddedSearchService.h"
+#include "services/PublishScheduler.h"
+#include "services/RenderService.h"
+#include "services/RequestMetrics.h"
+#include "services/ResponseCache.h"
+#include "services/SpellingService.h"
+#include "services/StallWatchdog.h"
+#include "services/ViewCountService.h"
+
+namespace pyracms {
+
+namespace {
+
+void appendMetric(std::string &out, const char *type, const char *name, const char *help,
+                  uint64_t value) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+    out += name;
+    out += ' ';
+    out += std::to_string(value);
+    out += '\n';
+}
+
+void appendCounter(std::string &out, const char *name, const char *help, uint64_t value) {
+    appendMetric(out, "counter", name, help, value);
+}
+
+void appendGauge(std::string &out, const char *name, const char *help, uint64_t value) {
+    appendMetric(out, "gauge", name, help, value);
+}
+
+} // namespace
+
+void MetricsController::metrics(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) {
+
+    std::string body = RequestMetrics::instance().renderPrometheus();
+    body += StallWatchdog::instance().renderPrometheus();
+
+    auto cache = CacheService::instance().stats();
+    appendCounter(body, "pyracms_cache_fetches_total",
+                  "Fetcher calls made by getOrSet.", cache.fetches);
+    appendCounter(body, "pyracms_cache_coalesced_waiters_total",
+                  "Cache misses that joined an in-flight fetch.", cache.coalescedWaiters);
+    appendCounter(body, "pyracms_cache_background_refreshes_total",
+                  "Stale-while-revalidate refreshes.", cache.backgroundRefreshes);
+    appendCounter(body, "pyracms_cache_stale_hits_total",
+                  "Stale cache values served.", cache.staleHits);
+    appendCounter(body, "pyracms_cache_flight_timeouts_total",
+                  "Cache fetches abandoned at the deadline, waiters released as a miss.",
+                  cache.flightTimeouts);
+
+    auto responses = ResponseCache::instance().stats();
+    appendCounter(body, "pyracms_response_cache_hits_total",
+                  "Responses served from the response cache.", responses.hits);
+    appendCounter(body, "pyracms_response_cache_misses_total",
+                  "Cacheable requests that missed the response cache.", responses.misses);
+    appendCounter(body, "pyracms_response_cache_stores_total",
+                  "Responses stored in the response cache.", responses.stores);
+    appendCounter(body, "pyracms_response_cache_purges_total",
+                  "Surrogate-key purges applied.", responses.purges);
+    appendCounter(body, "pyracms_response_cache_evictions_total",
+                  "Responses evicted to stay within the byte budget.", responses.evictions);
+    appendGauge(body, "pyracms_response_cache_entries",
+                "Responses currently held.", responses.entries);
+    appendGauge(body, "pyracms_response_cache_bytes",
+                "Bytes charged against the response cache budget.", responses.bytes);
+
+    if (EmbeddedSearchService::enabled()) {
+        auto index = EmbeddedSearchService::instance().stats();
+        appendGauge(body, "pyracms_search_index_documents",
+                    "Live documents in the embedded search index.", index.documents);
+        appendGauge(body, "pyracms_search_index_tombstones",
+                    "Replaced documents awaiting compaction.", index.tombstones);
+        appendGauge(body, "pyracms_search_index_terms",
+                    "Distinct terms in the embedded search index.", index.terms);
+        appendGauge(body, "pyracms_search_index_posting_bytes",
+                    "Compressed posting list bytes.", index.postingBytes);
+        appendGauge(body, "pyracms_search_index_highlight_bytes",
+                    "Stored bodies and token offsets used for snippets.", index.highlightBytes);
+    }
+
+    if (ElasticsearchService::instance().isConfigured()) {
+        auto bulk = ElasticsearchService::instance().bulkStats();
+        appendGauge(body, "pyracms_es_bulk_queued",
+                    "Operations waiting for an Elasticsearch _bulk request.", bulk.queued);
+        appendGauge(body, "pyracms_es_bulk_in_flight",
+                    "Operations in _bulk requests awaiting a response.", bulk.inFlight);
+        appendCounter(body, "pyracms_es_bulk_indexed_total",
+                      "Operations Elasticsearch accepted.", bulk.indexed);
+        appendCounter(body, "pyracms_es_bulk_coalesced_total",
+                      "Operations replaced by a newer one for the same document.",
+                      bulk.coalesced);
+        appendCounter(body, "pyracms_es_bulk_retried_total",
+                      "Operations requeued after a transient failure.", bulk.retried);
+        appendCounter(body, "pyracms_es_bulk_dropped_total",
+                      "Operations abandoned after a permanent failure or too many attempts.",
+                      bulk.dropped);
+        appendCounter(body, "pyracms_es_bulk_rejected_total",
+                      "Operations refused because the queue was full.", bulk.rejected);
+    }
+
+    const auto &searchLog = AnalyticsService::searchQueryLog();
+    appendGauge(body, "pyracms_search_log_pending_queries",
+                "Distinct search queries counted but not yet written.", searchLog.size());
+    appendCounter(body, "pyracms_search_log_dropped_total",
+                  "Searches not logged because the query buffer was full.",
+                  searchLog.dropped());
+
+    appendGauge(body, "pyracms_view_counts_pending_rows",
+                "Rows with views counted but not yet written.", ViewCountService::views().size());
+    appendCounter(body, "pyracms_view_counts_flushed_total",
+                  "Views written to view_count columns.", ViewCountService::flushed());
+    appendCounter(body, "pyracms_view_counts_flush_failures_total",
+                  "View count statements that failed and were retried.",
+                  ViewCountService::failed());
+
+    const auto &revisions = ArticleService::revisions();
+    auto revisionStats = revisions.stats();
+    auto revisionCache = revisions.cacheStats();
+    appendCounter(body, "pyracms_revision_rebuilds_total",
+                  "Revisions rebuilt from a snapshot and deltas.", revisionStats.rebuilds);
+    appendCounter(body, "pyracms_revision_deltas_applied_total",
+                  "Deltas applied while rebuilding revisions.", revisionStats.deltasApplied);
+    appendCounter(body, "pyracms_revision_rebuild_failures_total",
+                  "Revisions that could not be rebuilt.", revisionStats.failures);
+    appendCounter(body, "pyracms_revision_cache_hits_total",
+                  "Rebuilt revisions served from the cache.", revisionCache.hits);
+    appendGauge(body, "pyracms_revision_cache_bytes",
+                "Bytes of rebuilt revisions held in the cache.", revisionCache.bytes);
+
+    auto renders = RenderService::instance().stats();
+    appendCounter(body, "pyracms_render_cache_hits_total",
+                  "Article renders served from memory.", renders.cacheHits);
+    appendCounter(body, "pyracms_renders_total",
+                  "Article revisions rendered to HTML.", renders.rendered);
+    appendCounter(body, "pyracms_renders_stored_total",
+                  "Renders written to article_renders.", renders.stored);
+    appendCounter(body, "pyracms_render_store_failures_total",
+                  "Renders that could not be written to article_renders.",
+                  renders.storeFailures);
+    appendGauge(body, "pyracms_render_cache_bytes",
+                "Bytes of renders held in memory.", renders.cacheBytes);
+
+    auto publishing = PublishScheduler::instance().stats();
+    appendGauge(body, "pyracms_publish_leader",
+                "1 if this node publishes scheduled articles.", publishing.leader ? 1 : 0);
+    appendGauge(body, "pyracms_publish_scheduled_articles",
+                "Scheduled articles waiting in the leader's timer heap.", publishing.scheduled);
+    appendCounter(body, "pyracms_publish_runs_total",
+                  "Times the publish timer fired.", publishing.runs);
+    appendCounter(body, "pyracms_publish_articles_total",
+                  "Scheduled articles published.", publishing.published);
+    appendCounter(body, "pyracms_publish_failures_total",
+                  "Publish runs that failed and were retried.", publishing.failures);
+
+    if (AutocompleteService::instance().ready()) {
+        appendGauge(body, "pyracms_autocomplete_entries",
+                    "Titles in the autocomplete index.", AutocompleteService::instance().size());
+    }
+    if (SpellingService::instance().ready()) {
+        appendGauge(body, "pyracms_search_spelling_words",
+                    "Words in the spelling correction index.", SpellingService::instance().size());
+    }
+
+    auto resp = drogon::HttpResponse::newHttpResponse();
+    resp->setBody(std::move(body));
+    resp->setContentTypeCodeAndCustomString(drogon::CT_TEXT_PLAIN,
+                                            "text/plain; version=0.0.4; charset=utf-8");
+    callback(resp);
+}
+
+} // namespace pyracms
@@ -1,4 +1,5 @@
 #include "controllers/NotificationController.h"
+#include "services/DbRouter.h"
 
 namespace pyracms {
 
@@ -7,27 +8,27 @@ void NotificationController::list(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback) {
 
     auto userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     bool unreadOnly = req->getParameter("unread_only") == "true";
-    int limit = 20;
-    int offset = 0;
-
-    try {
-        auto limitParam = req->getParameter("limit");
-        if (!limitParam.empty()) limit = std::stoi(limitParam);
-        auto offsetParam = req->getParameter("offset");
-        if (!offsetParam.empty()) offset = std::stoi(offsetParam);
-    } catch (...) {
-        // Use defaults
+    PageRequest page;
+    if (!PageRequest::parse(req->getParameter("limit"), req->getParameter("offset"),
+                            req->getParameter("cursor"),
+                            PageCursor::hashScope(unreadOnly ? "notifications:unread" : "notifications",
+                                                  userId),
+                            page)) {
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value{});
+        (*resp->jsonObject())["error"] = "cursor does not belong to this list";
+        resp->setStatusCode(drogon::k400BadRequest);
+        callback(resp);
+        return;
     }
 
-    if (limit > 100) limit = 100;
-    if (limit < 1) limit = 1;
+    if (page.limit > 100) page.limit = 100;
 
     notificationService_.getNotifications(
-        db, userId, unreadOnly, limit, offset,
-        [callback](const std::vector<NotificationDto> &notifications) {
+        db, userId, unreadOnly, page,
+        [callback, page](const std::vector<NotificationDto> &notifications) {
             Json::Value result(Json::arrayValue);
             for (const auto &n : notifications) {
                 Json::Value item;
@@ -41,7 +42,13 @@ void NotificationController::list(
                 item["createdAt"] = n.createdAt;
                 result.append(item);
             }
-            callback(drogon::HttpResponse::newHttpJsonResponse(result));
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(result);
+            if (!notifications.empty()) {
+                auto next = page.next(notifications.size(), notifications.back().createdAt,
+                                      notifications.back().id);
+                if (!next.empty()) resp->addHeader("X-Next-Cursor", next);
+            }
+            callback(resp);
         });
 }
 
@@ -50,7 +57,7 @@ void NotificationController::unreadCount(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback) {
 
     auto userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     notificationService_.getUnreadCount(
         db, userId,
@@ -67,7 +74,7 @@ void NotificationController::markRead(
     int id) {
 
     auto userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     notificationService_.markRead(
         db, id, userId,
@@ -90,7 +97,7 @@ void NotificationController::markAllRead(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback) {
 
     auto userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     notificationService_.markAllRead(
         db, userId,
@@ -114,7 +121,7 @@ void NotificationController::deleteNotification(
     int id) {
 
     auto userId = req->attributes()->get<int>("userId");
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     notificationService_.deleteNotification(
         db, id, userId,
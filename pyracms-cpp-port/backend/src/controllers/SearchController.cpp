@@ -1,4 +1,8 @@
 #include "controllers/SearchController.h"
+#include "services/AnalyticsService.h"
+#include "services/DbRouter.h"
+#include "services/ElasticsearchReindexer.h"
+#include "services/ElasticsearchService.h"
 
 namespace pyracms {
 
@@ -33,36 +37,67 @@ void SearchController::search(
     if (!limitStr.empty()) limit = std::stoi(limitStr);
     if (!offsetStr.empty()) offset = std::stoi(offsetStr);
 
-    auto db = drogon::app().getDbClient();
-
-    searchService_.search(
-        db, tenantId, query, type, limit, offset,
-        [callback](const SearchResults &results) {
-            Json::Value response;
-            response["query"] = results.query;
-            response["totalCount"] = results.totalCount;
-            response["items"] = Json::Value(Json::arrayValue);
-
-            for (const auto &item : results.items) {
-                Json::Value jsonItem;
-                jsonItem["type"] = item.type;
-                jsonItem["id"] = item.id;
-                jsonItem["title"] = item.title;
-                jsonItem["snippet"] = item.snippet;
-                jsonItem["url"] = item.url;
-                jsonItem["rank"] = item.rank;
-                jsonItem["createdAt"] = item.createdAt;
-                response["items"].append(jsonItem);
-            }
-
-            // Add facet counts
-            response["facets"] = Json::Value(Json::objectValue);
-            for (const auto &[type, count] : results.facets) {
-                response["facets"][type] = count;
-            }
+    // A cursor continues a previous page of the same search and takes
+    // precedence over offset
+    SearchCursor cursor;
+    auto cursorStr = req->getParameter("cursor");
+    if (!cursorStr.empty() &&
+        (!SearchCursor::decode(cursorStr, cursor) ||
+         cursor.queryHash != SearchCursor::hashQuery(query, type))) {
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value{});
+        (*resp->jsonObject())["error"] = "cursor does not belong to this search";
+        resp->setStatusCode(drogon::k400BadRequest);
+        callback(resp);
+        return;
+    }
 
-            callback(drogon::HttpResponse::newHttpJsonResponse(response));
-        });
+    auto db = DbRouter::instance().reader(req);
+
+    // Later pages of the same search are not counted again
+    bool firstPage = cursorStr.empty() && offset == 0;
+    auto respond = [callback, tenantId, query, firstPage](const SearchResults &results) {
+        if (firstPage) {
+            // A corrected search means the query as typed found nothing
+            AnalyticsService::recordSearchQuery(tenantId, query,
+                                                results.suggestion.empty() ? results.totalCount : 0);
+        }
+
+        Json::Value response;
+        response["query"] = results.query;
+        response["totalCount"] = results.totalCount;
+        response["nextCursor"] = results.nextCursor.empty() ? Json::Value()
+                                                            : Json::Value(results.nextCursor);
+        response["suggestion"] = results.suggestion.empty() ? Json::Value()
+                                                            : Json::Value(results.suggestion);
+        response["items"] = Json::Value(Json::arrayValue);
+
+        for (const auto &item : results.items) {
+            Json::Value jsonItem;
+            jsonItem["type"] = item.type;
+            jsonItem["id"] = item.id;
+            jsonItem["title"] = item.title;
+            jsonItem["snippet"] = item.snippet;
+            jsonItem["highlight"] = item.highlight;
+            jsonItem["url"] = item.url;
+            jsonItem["rank"] = item.rank;
+            jsonItem["createdAt"] = item.createdAt;
+            response["items"].append(jsonItem);
+        }
+
+        // Add facet counts
+        response["facets"] = Json::Value(Json::objectValue);
+        for (const auto &[type, count] : results.facets) {
+            response["facets"][type] = count;
+        }
+
+        callback(drogon::HttpResponse::newHttpJsonResponse(response));
+    };
+
+    if (cursorStr.empty()) {
+        searchService_.search(db, tenantId, query, type, limit, offset, respond);
+    } else {
+        searchService_.resume(db, tenantId, query, type, limit, cursor, respond);
+    }
 }
 
 void SearchController::autocomplete(
@@ -89,7 +124,7 @@ void SearchController::autocomplete(
     auto limitStr = req->getParameter("limit");
     if (!limitStr.empty()) limit = std::stoi(limitStr);
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().reader(req);
 
     searchService_.autocomplete(
         db, tenantId, q, limit,
@@ -106,4 +141,69 @@ void SearchController::autocomplete(
         });
 }
 
+// ── Reindex (admin) ──────────────────────────────────────────────────────────
+
+void SearchController::requireSuperAdmin(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> callback,
+    std::function<void()> next) {
+
+    int userId = req->attributes()->get<int>("userId");
+    userService_.getUserRole(
+        DbRouter::instance().primary(), userId,
+        [callback, next](const std::optional<UserRole> &role) {
+            if (!role || !hasMinRole(*role, UserRole::SuperAdmin)) {
+                auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value{});
+                (*resp->jsonObject())["error"] = "Forbidden";
+                resp->setStatusCode(drogon::k403Forbidden);
+                callback(resp);
+                return;
+            }
+            next();
+        });
+}
+
+void SearchController::reindexStatus(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) {
+
+    requireSuperAdmin(req, callback, [callback]() {
+        ElasticsearchReindexer::instance().progress(
+            DbRouter::instance().primary(),
+            [callback](const Json::Value &progress) {
+                auto resp = drogon::HttpResponse::newHttpJsonResponse(progress);
+                if (progress.isMember("error")) {
+                    resp->setStatusCode(drogon::k500InternalServerError);
+                }
+                callback(resp);
+            });
+    });
+}
+
+void SearchController::startReindex(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) {
+
+    if (!ElasticsearchService::instance().isConfigured()) {
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value{});
+        (*resp->jsonObject())["error"] = "Elasticsearch is not configured";
+        resp->setStatusCode(drogon::k503ServiceUnavailable);
+        callback(resp);
+        return;
+    }
+
+    requireSuperAdmin(req, callback, [callback]() {
+        ElasticsearchService::instance().syncFromDatabase(
+            DbRouter::instance().primary(),
+            [callback](bool ok, const std::string &message) {
+                Json::Value result;
+                result["success"] = ok;
+                result["message"] = message;
+                auto resp = drogon::HttpResponse::newHttpJsonResponse(result);
+                resp->setStatusCode(ok ? drogon::k202Accepted : drogon::k409Conflict);
+                callback(resp);
+            });
+    });
+}
+
 } // namespace pyracms
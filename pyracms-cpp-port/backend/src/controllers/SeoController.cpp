@@ -1,4 +1,7 @@
 #include "controllers/SeoController.h"
+#include "services/DbRouter.h"
+#include "services/HttpResponseCache.h"
+#include "services/ResponseCache.h"
 
 namespace pyracms {
 
@@ -19,15 +22,21 @@ void SeoController::sitemap(
     auto baseUrl = req->getParameter("base_url");
     if (baseUrl.empty()) baseUrl = "http://localhost:3000";
 
-    auto db = drogon::app().getDbClient();
+    // Feeds list the tenant's articles, so any article write purges them
+    auto cacheKey = HttpResponseCache::keyFor(req, tenantId);
+    if (HttpResponseCache::serve(req, cacheKey, callback)) return;
+    auto send = HttpResponseCache::storing(
+        req, cacheKey, {ResponseCache::articleListKey(tenantId)}, 300, callback);
+
+    auto db = DbRouter::instance().primary();
 
     seoService_.generateSitemap(
         db, tenantId, baseUrl,
-        [callback](const std::string &xml) {
+        [send](const std::string &xml) {
             auto resp = drogon::HttpResponse::newHttpResponse();
             resp->setBody(xml);
             resp->setContentTypeCode(drogon::CT_TEXT_XML);
-            callback(resp);
+            send(resp);
         });
 }
 
@@ -50,15 +59,20 @@ void SeoController::rssFeed(
     auto siteTitle = req->getParameter("title");
     if (siteTitle.empty()) siteTitle = "PyraCMS";
 
-    auto db = drogon::app().getDbClient();
+    auto cacheKey = HttpResponseCache::keyFor(req, tenantId);
+    if (HttpResponseCache::serve(req, cacheKey, callback)) return;
+    auto send = HttpResponseCache::storing(
+        req, cacheKey, {ResponseCache::articleListKey(tenantId)}, 300, callback);
+
+    auto db = DbRouter::instance().primary();
 
     seoService_.generateRssFeed(
         db, tenantId, baseUrl, siteTitle,
-        [callback](const std::string &xml) {
+        [send](const std::string &xml) {
             auto resp = drogon::HttpResponse::newHttpResponse();
             resp->setBody(xml);
             resp->setContentTypeCode(drogon::CT_TEXT_XML);
-            callback(resp);
+            send(resp);
         });
 }
 
@@ -81,15 +95,20 @@ void SeoController::atomFeed(
     auto siteTitle = req->getParameter("title");
     if (siteTitle.empty()) siteTitle = "PyraCMS";
 
-    auto db = drogon::app().getDbClient();
+    auto cacheKey = HttpResponseCache::keyFor(req, tenantId);
+    if (HttpResponseCache::serve(req, cacheKey, callback)) return;
+    auto send = HttpResponseCache::storing(
+        req, cacheKey, {ResponseCache::articleListKey(tenantId)}, 300, callback);
+
+    auto db = DbRouter::instance().primary();
 
     seoService_.generateAtomFeed(
         db, tenantId, baseUrl, siteTitle,
-        [callback](const std::string &xml) {
+        [send](const std::string &xml) {
             auto resp = drogon::HttpResponse::newHttpResponse();
             resp->setBody(xml);
             resp->setContentTypeCode(drogon::CT_TEXT_XML);
-            callback(resp);
+            send(resp);
         });
 }
 
@@ -111,7 +130,7 @@ void SeoController::articleJsonLd(
     auto baseUrl = req->getParameter("base_url");
     if (baseUrl.empty()) baseUrl = "http://localhost:3000";
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     seoService_.getArticleJsonLd(
         db, tenantId, name, baseUrl,
@@ -145,7 +164,7 @@ void SeoController::articleOpenGraph(
     auto baseUrl = req->getParameter("base_url");
     if (baseUrl.empty()) baseUrl = "http://localhost:3000";
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     seoService_.getOpenGraphData(
         db, tenantId, name, baseUrl,
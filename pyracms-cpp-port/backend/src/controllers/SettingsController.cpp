@@ -1,4 +1,5 @@
 #include "controllers/SettingsController.h"
+#include "services/DbRouter.h"
 
 namespace pyracms {
 
@@ -16,7 +17,7 @@ void SettingsController::list(
     }
 
     int tenantId = std::stoi(tenantIdStr);
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     settingsService_.listSettings(
         db, tenantId,
         [callback](const std::vector<SettingDto> &settings) {
@@ -48,7 +49,7 @@ void SettingsController::getByName(
     }
 
     int tenantId = std::stoi(tenantIdStr);
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     settingsService_.getSetting(
         db, tenantId, name,
         [callback](const std::optional<SettingDto> &setting) {
@@ -87,7 +88,7 @@ void SettingsController::createOrUpdate(
     int tenantId = (*json)["tenantId"].asInt();
     auto value = (*json)["value"].asString();
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     settingsService_.createOrUpdateSetting(
         db, tenantId, name, value,
         [callback](bool success, const std::string &error) {
@@ -122,7 +123,7 @@ void SettingsController::remove(
 
     int tenantId = (*json)["tenantId"].asInt();
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     settingsService_.deleteSetting(
         db, tenantId, name,
         [callback](bool success, const std::string &error) {
@@ -1,4 +1,5 @@
 #include "controllers/SocialController.h"
+#include "services/DbRouter.h"
 
 namespace pyracms {
 
@@ -9,7 +10,7 @@ void SocialController::follow(
 
     int followerId = req->attributes()->get<int>("userId");
     int followedId = std::stoi(id);
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     socialService_.followUser(db, followerId, followedId,
         [callback](bool success, const std::string &error) {
@@ -33,7 +34,7 @@ void SocialController::unfollow(
 
     int followerId = req->attributes()->get<int>("userId");
     int followedId = std::stoi(id);
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     socialService_.unfollowUser(db, followerId, followedId,
         [callback](bool success, const std::string &error) {
@@ -56,16 +57,21 @@ void SocialController::getFollowers(
     const std::string &id) {
 
     int userId = std::stoi(id);
-    int limit = 20, offset = 0;
-    auto limitStr = req->getParameter("limit");
-    auto offsetStr = req->getParameter("offset");
-    if (!limitStr.empty()) limit = std::stoi(limitStr);
-    if (!offsetStr.empty()) offset = std::stoi(offsetStr);
-
-    auto db = drogon::app().getDbClient();
-
-    socialService_.getFollowers(db, userId, limit, offset,
-        [callback](const std::vector<UserFollowDto> &followers, int total) {
+    PageRequest page;
+    if (!PageRequest::parse(req->getParameter("limit"), req->getParameter("offset"),
+                            req->getParameter("cursor"), PageCursor::hashScope("followers", userId),
+                            page)) {
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value{});
+        (*resp->jsonObject())["error"] = "cursor does not belong to this list";
+        resp->setStatusCode(drogon::k400BadRequest);
+        callback(resp);
+        return;
+    }
+
+    auto db = DbRouter::instance().primary();
+
+    socialService_.getFollowers(db, userId, page,
+        [callback, page](const std::vector<UserFollowDto> &followers, int total) {
             Json::Value response;
             response["total"] = total;
             response["items"] = Json::Value(Json::arrayValue);
@@ -77,6 +83,12 @@ void SocialController::getFollowers(
                 item["createdAt"] = f.createdAt;
                 response["items"].append(item);
             }
+            std::string next;
+            if (!followers.empty()) {
+                const auto &last = followers.back();
+                next = page.next(followers.size(), last.createdAt, last.userId);
+            }
+            response["nextCursor"] = next.empty() ? Json::Value() : Json::Value(next);
             callback(drogon::HttpResponse::newHttpJsonResponse(response));
         });
 }
@@ -87,16 +99,21 @@ void SocialController::getFollowing(
     const std::string &id) {
 
     int userId = std::stoi(id);
-    int limit = 20, offset = 0;
-    auto limitStr = req->getParameter("limit");
-    auto offsetStr = req->getParameter("offset");
-    if (!limitStr.empty()) limit = std::stoi(limitStr);
-    if (!offsetStr.empty()) offset = std::stoi(offsetStr);
-
-    auto db = drogon::app().getDbClient();
-
-    socialService_.getFollowing(db, userId, limit, offset,
-        [callback](const std::vector<UserFollowDto> &following, int total) {
+    PageRequest page;
+    if (!PageRequest::parse(req->getParameter("limit"), req->getParameter("offset"),
+                            req->getParameter("cursor"), PageCursor::hashScope("following", userId),
+                            page)) {
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value{});
+        (*resp->jsonObject())["error"] = "cursor does not belong to this list";
+        resp->setStatusCode(drogon::k400BadRequest);
+        callback(resp);
+        return;
+    }
+
+    auto db = DbRouter::instance().primary();
+
+    socialService_.getFollowing(db, userId, page,
+        [callback, page](const std::vector<UserFollowDto> &following, int total) {
             Json::Value response;
             response["total"] = total;
             response["items"] = Json::Value(Json::arrayValue);
@@ -108,6 +125,12 @@ void SocialController::getFollowing(
                 item["createdAt"] = f.createdAt;
                 response["items"].append(item);
             }
+            std::string next;
+            if (!following.empty()) {
+                const auto &last = following.back();
+                next = page.next(following.size(), last.createdAt, last.userId);
+            }
+            response["nextCursor"] = next.empty() ? Json::Value() : Json::Value(next);
             callback(drogon::HttpResponse::newHttpJsonResponse(response));
         });
 }
@@ -118,16 +141,21 @@ void SocialController::getActivity(
     const std::string &id) {
 
     int userId = std::stoi(id);
-    int limit = 20, offset = 0;
-    auto limitStr = req->getParameter("limit");
-    auto offsetStr = req->getParameter("offset");
-    if (!limitStr.empty()) limit = std::stoi(limitStr);
-    if (!offsetStr.empty()) offset = std::stoi(offsetStr);
-
-    auto db = drogon::app().getDbClient();
-
-    socialService_.getActivityFeed(db, userId, limit, offset,
-        [callback](const std::vector<ActivityItem> &items) {
+    PageRequest page;
+    if (!PageRequest::parse(req->getParameter("limit"), req->getParameter("offset"),
+                            req->getParameter("cursor"), PageCursor::hashScope("activity", userId),
+                            page)) {
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value{});
+        (*resp->jsonObject())["error"] = "cursor does not belong to this list";
+        resp->setStatusCode(drogon::k400BadRequest);
+        callback(resp);
+        return;
+    }
+
+    auto db = DbRouter::instance().primary();
+
+    socialService_.getActivityFeed(db, userId, page,
+        [callback, page](const std::vector<ActivityItem> &items) {
             Json::Value result(Json::arrayValue);
             for (const auto &item : items) {
                 Json::Value jsonItem;
@@ -138,7 +166,13 @@ void SocialController::getActivity(
                 jsonItem["createdAt"] = item.createdAt;
                 result.append(jsonItem);
             }
-            callback(drogon::HttpResponse::newHttpJsonResponse(result));
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(result);
+            if (!items.empty()) {
+                auto next = page.next(items.size(), items.back().createdAt,
+                                      SocialService::activityCursorId(items.back()));
+                if (!next.empty()) resp->addHeader("X-Next-Cursor", next);
+            }
+            callback(resp);
         });
 }
 
@@ -148,7 +182,7 @@ void SocialController::getAchievements(
     const std::string &id) {
 
     int userId = std::stoi(id);
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     socialService_.getUserAchievements(db, userId,
         [callback](const std::vector<AchievementDto> &achievements) {
@@ -174,7 +208,7 @@ void SocialController::getReputation(
     const std::string &id) {
 
     int userId = std::stoi(id);
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     socialService_.calculateReputation(db, userId,
         [callback](const ReputationDto &rep) {
@@ -1,4 +1,5 @@
 #include "controllers/TenantController.h"
+#include "services/DbRouter.h"
 
 namespace pyracms {
 
@@ -6,7 +7,7 @@ void TenantController::list(
     const drogon::HttpRequestPtr &req,
     std::function<void(const drogon::HttpResponsePtr &)> &&callback) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     tenantService_.listTenants(
         db, [callback](const std::vector<TenantDto> &tenants) {
             Json::Value result(Json::arrayValue);
@@ -29,7 +30,7 @@ void TenantController::getBySlug(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     const std::string &slug) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     tenantService_.findBySlug(
         db, slug,
         [callback](const std::optional<TenantDto> &tenant) {
@@ -71,7 +72,7 @@ void TenantController::create(
     auto description = (*json).get("description", "").asString();
     auto ownerId = req->attributes()->get<int>("userId");
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     tenantService_.createTenant(
         db, slug, displayName, description, ownerId,
         [callback](bool success, const std::string &error) {
@@ -97,7 +98,7 @@ void TenantController::remove(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     tenantService_.deleteTenant(
         db, id,
         [callback](bool success, const std::string &error) {
@@ -1,5 +1,6 @@
 #include "controllers/UserController.h"
 #include "services/AuthService.h"
+#include "services/DbRouter.h"
 
 namespace pyracms {
 
@@ -12,7 +13,7 @@ void UserController::list(
     int limit = limitStr.empty() ? 50 : std::stoi(limitStr);
     int offset = offsetStr.empty() ? 0 : std::stoi(offsetStr);
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     userService_.listUsers(
         db, limit, offset,
         [callback](const std::vector<UserDto> &users) {
@@ -36,7 +37,7 @@ void UserController::getById(
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     int id) {
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     userService_.findById(
         db, id,
         [callback](const std::optional<UserDto> &user) {
@@ -87,7 +88,7 @@ void UserController::update(
         return;
     }
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     userService_.updateUser(
         db, id, *json,
         [callback](bool success, const std::string &error) {
@@ -141,7 +142,7 @@ void UserController::changePassword(
         return;
     }
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
     auto requesterUsername = req->attributes()->get<std::string>("username");
 
     AuthService authService;
@@ -1,4 +1,5 @@
 #include "controllers/WebhookController.h"
+#include "services/DbRouter.h"
 
 namespace pyracms {
 
@@ -16,7 +17,7 @@ void WebhookController::listWebhooks(
     }
 
     int tenantId = std::stoi(tenantIdStr);
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     webhookService_.listWebhooks(
         db, tenantId,
@@ -62,7 +63,7 @@ void WebhookController::createWebhook(
         events.push_back(e.asString());
     }
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     webhookService_.createWebhook(
         db, tenantId, url, events, secret,
@@ -110,7 +111,7 @@ void WebhookController::updateWebhook(
         }
     }
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     webhookService_.updateWebhook(
         db, webhookId, url, events, secret, active,
@@ -135,7 +136,7 @@ void WebhookController::deleteWebhook(
     const std::string &id) {
 
     int webhookId = std::stoi(id);
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     webhookService_.deleteWebhook(
         db, webhookId,
@@ -160,18 +161,22 @@ void WebhookController::getDeliveries(
     const std::string &id) {
 
     int webhookId = std::stoi(id);
-    int limit = 20;
-    int offset = 0;
-    auto limitStr = req->getParameter("limit");
-    auto offsetStr = req->getParameter("offset");
-    if (!limitStr.empty()) limit = std::stoi(limitStr);
-    if (!offsetStr.empty()) offset = std::stoi(offsetStr);
+    PageRequest page;
+    if (!PageRequest::parse(req->getParameter("limit"), req->getParameter("offset"),
+                            req->getParameter("cursor"),
+                            PageCursor::hashScope("webhook_deliveries", webhookId), page)) {
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value{});
+        (*resp->jsonObject())["error"] = "cursor does not belong to this list";
+        resp->setStatusCode(drogon::k400BadRequest);
+        callback(resp);
+        return;
+    }
 
-    auto db = drogon::app().getDbClient();
+    auto db = DbRouter::instance().primary();
 
     webhookService_.getDeliveries(
-        db, webhookId, limit, offset,
-        [callback](const std::vector<WebhookDeliveryDto> &deliveries) {
+        db, webhookId, page,
+        [callback, page](const std::vector<WebhookDeliveryDto> &deliveries) {
             Json::Value result(Json::arrayValue);
             for (const auto &d : deliveries) {
                 Json::Value item;
@@ -192,7 +197,13 @@ void WebhookController::getDeliveries(
                 }
                 result.append(item);
             }
-            callback(drogon::HttpResponse::newHttpJsonResponse(result));
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(result);
+            if (!deliveries.empty()) {
+                auto next = page.next(deliveries.size(), deliveries.back().deliveredAt,
+                                      deliveries.back().id);
+                if (!next.empty()) resp->addHeader("X-Next-Cursor", next);
+            }
+            callback(resp);
         });
 }
 
@@ -1,8 +1,19 @@
 #include <drogon/drogon.h>
+#include <atomic>
 #include <iostream>
-#include "services/ArticleService.h"
+#include "services/AnalyticsService.h"
+#include "services/AutocompleteService.h"
 #include "services/CacheService.h"
+#include "services/DbRouter.h"
+#include "services/ElasticsearchReindexer.h"
 #include "services/ElasticsearchService.h"
+#include "services/EmbeddedSearchService.h"
+#include "services/PublishScheduler.h"
+#include "services/RequestMetrics.h"
+#include "services/SearchService.h"
+#include "services/SpellingService.h"
+#include "services/StallWatchdog.h"
+#include "services/ViewCountService.h"
 
 int main() {
     // Load config from json file if it exists, otherwise use defaults
@@ -43,28 +54,34 @@ int main() {
                             "GET, POST, PUT, DELETE, OPTIONS");
             resp->addHeader("Access-Control-Allow-Headers",
                             "Content-Type, Authorization");
+            resp->addHeader("Access-Control-Expose-Headers", "X-Next-Cursor");
         });
 
-    // PostgreSQL database client
-    const char *db_host = std::getenv("DB_HOST");
-    const char *db_port_s = std::getenv("DB_PORT");
-    const char *db_name = std::getenv("DB_NAME");
-    const char *db_user = std::getenv("DB_USER");
-    const char *db_pass = std::getenv("DB_PASSWORD");
-
-    drogon::app().createDbClient(
-        "postgresql",                           // dbType
-        db_host ? db_host : "127.0.0.1",        // host
-        db_port_s ? std::stoi(db_port_s) : 5432,// port
-        db_name ? db_name : "pyracms",          // databaseName
-        db_user ? db_user : "pyracms",          // userName
-        db_pass ? db_pass : "pyracms",          // password
-        4,                                      // connectionNum
-        "",                                     // filename
-        "default",                              // name
-        false,                                  // isFast
-        "utf8"                                  // characterSet
-    );
+    // Request metrics, scraped from /metrics. Pre-routing runs after the
+    // OPTIONS sync advice, so preflights are not counted; latency is taken
+    // from the request's parse time so routing and filters are included.
+    app.registerPreRoutingAdvice([](const drogon::HttpRequestPtr &) {
+        pyracms::RequestMetrics::instance().requestStarted();
+    });
+    app.registerPostHandlingAdvice(
+        [](const drogon::HttpRequestPtr &req,
+           const drogon::HttpResponsePtr &resp) {
+            auto elapsed = trantor::Date::now().microSecondsSinceEpoch() -
+                           req->creationDate().microSecondsSinceEpoch();
+            pyracms::RequestMetrics::instance().requestFinished(
+                req->matchedPathPattern(), static_cast<int>(resp->statusCode()),
+                static_cast<uint64_t>(elapsed > 0 ? elapsed : 0),
+                req->body().size(), resp->body().size());
+        });
+
+    // PostgreSQL pools: primary, optional per-loop fast clients and read
+    // replicas, all configured from DB_* variables
+    pyracms::DbRouter::instance().configure();
+    app.registerPostHandlingAdvice(
+        [](const drogon::HttpRequestPtr &req,
+           const drogon::HttpResponsePtr &resp) {
+            pyracms::DbRouter::instance().onResponse(req, resp);
+        });
 
     // Initialize Redis cache
     pyracms::CacheService::instance().initialize();
@@ -78,26 +95,154 @@ int main() {
     pyracms::ElasticsearchService::instance().initialize();
     if (pyracms::ElasticsearchService::instance().isConfigured()) {
         std::cout << "Elasticsearch connected — using ES for search" << std::endl;
+        // Reindex jobs: every node polls so it mirrors writes while one
+        // runs, and takes over a job whose node went away
+        pyracms::ElasticsearchReindexer::instance().initialize();
+        app.registerBeginningAdvice([]() {
+            auto poll = []() {
+                pyracms::ElasticsearchReindexer::instance().poll(drogon::app().getDbClient());
+            };
+            poll();
+            drogon::app().getLoop()->runEvery(
+                static_cast<double>(
+                    pyracms::ElasticsearchReindexer::instance().pollInterval().count()),
+                poll);
+        });
     } else {
         std::cout << "Elasticsearch not configured — using PostgreSQL FTS" << std::endl;
     }
 
-    // Scheduled publishing timer: check every 60 seconds
-    app.getLoop()->runEvery(60.0, []() {
-        auto db = drogon::app().getDbClient();
-        static pyracms::ArticleService articleService;
-        articleService.publishDueArticles(db,
-            [](bool success, const std::string &msg) {
-                if (success && msg != "0 articles published") {
-                    LOG_INFO << "Scheduled publishing: " << msg;
-                }
-            });
+    // Embedded search: restore the snapshot now, catch up with the database
+    // once the DB clients exist. Article writes update the index as they
+    // happen; the periodic reconcile picks up forum posts, snippets and
+    // gamedeps, which have no hooks of their own.
+    if (pyracms::EmbeddedSearchService::enabled()) {
+        pyracms::EmbeddedSearchService::instance().initialize();
+        const char *reconcile_seconds = std::getenv("EMBEDDED_SEARCH_RECONCILE_SECONDS");
+        double reconcileInterval = reconcile_seconds ? std::stod(reconcile_seconds) : 600.0;
+        app.registerBeginningAdvice([reconcileInterval]() {
+            auto reconcile = []() {
+                pyracms::EmbeddedSearchService::instance().reconcile(drogon::app().getDbClient());
+            };
+            reconcile();
+            if (reconcileInterval > 0) {
+                drogon::app().getLoop()->runEvery(reconcileInterval, reconcile);
+            }
+        });
+        std::cout << "Embedded search engine enabled" << std::endl;
+    }
+
+    // Autocomplete index: built in the background once the DB clients exist
+    // (lookups use SQL until then), rebuilt periodically so weights track
+    // view counts. Elasticsearch serves its own completions.
+    if (!pyracms::SearchService::useElasticsearch()) {
+        const char *rebuild_seconds = std::getenv("AUTOCOMPLETE_REBUILD_SECONDS");
+        double rebuildInterval = rebuild_seconds ? std::stod(rebuild_seconds) : 900.0;
+        app.registerBeginningAdvice([rebuildInterval]() {
+            auto rebuild = []() {
+                pyracms::AutocompleteService::instance().rebuild(drogon::app().getDbClient());
+            };
+            rebuild();
+            if (rebuildInterval > 0) drogon::app().getLoop()->runEvery(rebuildInterval, rebuild);
+        });
+    }
+
+    // Spelling index for "did you mean": built like the autocomplete index,
+    // rebuilt periodically to reset the counts of edited documents
+    if (!pyracms::SearchService::useElasticsearch()) {
+        const char *spelling_seconds = std::getenv("SPELLING_REBUILD_SECONDS");
+        double spellingInterval = spelling_seconds ? std::stod(spelling_seconds) : 3600.0;
+        app.registerBeginningAdvice([spellingInterval]() {
+            auto rebuild = []() {
+                pyracms::SpellingService::instance().rebuild(drogon::app().getDbClient());
+            };
+            rebuild();
+            if (spellingInterval > 0) drogon::app().getLoop()->runEvery(spellingInterval, rebuild);
+        });
+    }
+
+    // Search query log: searches are counted in memory and written as one
+    // upsert per distinct query every SEARCH_LOG_FLUSH_SECONDS
+    const char *search_log_flush = std::getenv("SEARCH_LOG_FLUSH_SECONDS");
+    double searchLogFlush = search_log_flush ? std::stod(search_log_flush) : 10.0;
+    app.registerBeginningAdvice([searchLogFlush]() {
+        drogon::app().getLoop()->runEvery(searchLogFlush, []() {
+            pyracms::AnalyticsService::flushSearchQueries(drogon::app().getDbClient());
+        });
+    });
+
+    // View counts: reads count views in memory, written behind every
+    // VIEW_COUNT_FLUSH_SECONDS and once more when the server is asked to
+    // stop. A second signal, or a flush still running after 5 seconds,
+    // stops it regardless.
+    const char *view_count_flush = std::getenv("VIEW_COUNT_FLUSH_SECONDS");
+    double viewCountFlush = view_count_flush ? std::stod(view_count_flush) : 5.0;
+    app.registerBeginningAdvice([viewCountFlush]() {
+        drogon::app().getLoop()->runEvery(viewCountFlush, []() {
+            pyracms::ViewCountService::flush(drogon::app().getDbClient());
+        });
+    });
+    auto flushAndQuit = []() {
+        static std::atomic<bool> stopping{false};
+        if (stopping.exchange(true)) {
+            drogon::app().quit();
+            return;
+        }
+        pyracms::ViewCountService::flush(drogon::app().getDbClient(),
+                                         []() { drogon::app().quit(); });
+        drogon::app().getLoop()->runAfter(5.0, []() { drogon::app().quit(); });
+    };
+    app.setTermSignalHandler(flushAndQuit);
+    app.setIntSignalHandler(flushAndQuit);
+
+    // Scheduled publishing: the node holding the leader lock keeps the
+    // due times in memory and publishes each article when it falls due
+    app.registerBeginningAdvice([]() {
+        pyracms::PublishScheduler::instance().start();
     });
 
+    // Event-loop stall watchdog: pings every loop, exports lag histograms
+    // on /metrics and logs the stack of any loop blocked past the threshold
+    const char *watchdog_ms = std::getenv("LOOP_WATCHDOG_MS");
+    const char *stall_ms = std::getenv("LOOP_STALL_MS");
+    int watchdogInterval = watchdog_ms ? std::stoi(watchdog_ms) : 100;
+    int stallThreshold = stall_ms ? std::stoi(stall_ms) : 250;
+    if (watchdogInterval > 0) {
+        app.registerBeginningAdvice([watchdogInterval, stallThreshold]() {
+            auto &watchdog = pyracms::StallWatchdog::instance();
+            auto addLoop = [&watchdog](std::string name, trantor::EventLoop *loop) {
+                watchdog.addLoop(std::move(name), [loop](std::function<void()> f) {
+                    loop->queueInLoop(std::move(f));
+                });
+            };
+            addLoop("main", drogon::app().getLoop());
+            auto ioLoops = drogon::app().getIOLoops();
+            for (size_t i = 0; i < ioLoops.size(); ++i) {
+                addLoop("io" + std::to_string(i), ioLoops[i]);
+            }
+            watchdog.start(std::chrono::milliseconds(watchdogInterval),
+                           std::chrono::milliseconds(stallThreshold),
+                           [](const pyracms::StallWatchdog::StallReport &report) {
+                               std::string stack;
+                               for (const auto &frame : report.stack) {
+                                   stack += "\n    " + frame;
+                               }
+                               LOG_WARN << "Event loop " << report.loop << " stalled for "
+                                        << report.stalledFor.count() << "ms"
+                                        << (stack.empty() ? " (no stack captured)" : stack);
+                           });
+        });
+    }
+
     std::cout << "PyraCMS Server starting on "
               << (host ? host : "0.0.0.0") << ":"
               << (port_str ? port_str : "8080") << std::endl;
 
     app.run();
+    pyracms::StallWatchdog::instance().stop();
+    if (pyracms::EmbeddedSearchService::enabled()) {
+        pyracms::EmbeddedSearchService::instance().stop();
+    }
+    pyracms::ElasticsearchService::instance().stop();
     return 0;
 }
@@ -1,5 +1,7 @@
 #include "services/AnalyticsService.h"
 
+#include <algorithm>
+
 namespace pyracms {
 
 void AnalyticsService::trackPageView(
@@ -130,11 +132,11 @@ void AnalyticsService::getSearchQueries(
     std::function<void(const std::vector<SearchQueryStat> &)> cb) {
 
     db->execSqlAsync(
-        "SELECT query, COUNT(*) AS count, "
-        "AVG(result_count) AS avg_results "
-        "FROM search_queries "
+        "SELECT query, SUM(searches) AS count, "
+        "SUM(result_sum)::float8 / SUM(searches) AS avg_results "
+        "FROM search_query_stats "
         "WHERE tenant_id = $1 "
-        "AND created_at >= NOW() - INTERVAL '30 days' "
+        "AND day > CURRENT_DATE - 30 "
         "GROUP BY query "
         "ORDER BY count DESC "
         "LIMIT $2",
@@ -155,33 +157,74 @@ void AnalyticsService::getSearchQueries(
         tenantId, limit);
 }
 
-void AnalyticsService::recordSearchQuery(
-    const DbClientPtr &db, int tenantId,
-    const std::string &query, int resultCount, int userId,
-    BoolCallback cb) {
+// ── Search query log ─────────────────────────────────────────────────────────
 
-    if (userId > 0) {
-        db->execSqlAsync(
-            "INSERT INTO search_queries (tenant_id, query, result_count, user_id) "
-            "VALUES ($1, $2, $3, $4)",
-            [cb](const drogon::orm::Result &) {
-                cb(true, "");
-            },
-            [cb](const drogon::orm::DrogonDbException &e) {
-                cb(false, e.base().what());
-            },
-            tenantId, query, resultCount, userId);
-    } else {
+SearchQueryAggregator &AnalyticsService::searchQueryBuffer() {
+    static SearchQueryAggregator buffer([] {
+        const char *maxQueries = std::getenv("SEARCH_LOG_MAX_QUERIES");
+        return maxQueries ? static_cast<size_t>(std::stoul(maxQueries)) : size_t{100000};
+    }());
+    return buffer;
+}
+
+const SearchQueryAggregator &AnalyticsService::searchQueryLog() {
+    return searchQueryBuffer();
+}
+
+void AnalyticsService::recordSearchQuery(int tenantId, const std::string &query,
+                                         int resultCount) {
+    searchQueryBuffer().record(tenantId, query, resultCount);
+}
+
+void AnalyticsService::flushSearchQueries(const DbClientPtr &db) {
+    constexpr size_t kRowsPerStatement = 500;
+
+    auto entries = std::make_shared<std::vector<SearchQueryAggregator::Entry>>(
+        searchQueryBuffer().drain());
+    for (size_t from = 0; from < entries->size(); from += kRowsPerStatement) {
+        size_t to = std::min(entries->size(), from + kRowsPerStatement);
+        Json::Value rows(Json::arrayValue);
+        for (size_t i = from; i < to; ++i) {
+            const auto &entry = (*entries)[i];
+            Json::Value row;
+            row["tenant_id"] = entry.tenantId;
+            row["query"] = entry.query;
+            row["searches"] = static_cast<Json::UInt64>(entry.searches);
+            row["result_sum"] = static_cast<Json::UInt64>(entry.resultSum);
+            rows.append(row);
+        }
+        Json::StreamWriterBuilder writer;
+        writer["indentation"] = "";
+
+        // Keys are unique within a drain, so no row is upserted twice by
+        // one statement. tenant_id comes from anonymous callers: rows for a
+        // tenant that does not exist are skipped rather than failing the
+        // foreign key for the whole batch.
         db->execSqlAsync(
-            "INSERT INTO search_queries (tenant_id, query, result_count) "
-            "VALUES ($1, $2, $3)",
-            [cb](const drogon::orm::Result &) {
-                cb(true, "");
-            },
-            [cb](const drogon::orm::DrogonDbException &e) {
-                cb(false, e.base().what());
+            "INSERT INTO search_query_stats (tenant_id, day, query, searches, result_sum) "
+            "SELECT r.tenant_id, CURRENT_DATE, r.query, r.searches, r.result_sum "
+            "FROM json_to_recordset($1::json) "
+            "  AS r(tenant_id INT, query TEXT, searches BIGINT, result_sum BIGINT) "
+            "JOIN tenants t ON t.id = r.tenant_id "
+            "ON CONFLICT (tenant_id, day, query) DO UPDATE SET "
+            "  searches = search_query_stats.searches + EXCLUDED.searches, "
+            "  result_sum = search_query_stats.result_sum + EXCLUDED.result_sum",
+            [](const drogon::orm::Result &) {},
+            [entries, from, to](const drogon::orm::DrogonDbException &e) {
+                // Only errors that a retry could fix keep the batch; a data
+                // or constraint error would fail it on every flush
+                std::string sqlState;
+                if (auto *sqlError = dynamic_cast<const drogon::orm::SqlError *>(&e.base())) {
+                    sqlState = sqlError->sqlState();
+                }
+                std::vector<SearchQueryAggregator::Entry> failed(
+                    entries->begin() + static_cast<std::ptrdiff_t>(from),
+                    entries->begin() + static_cast<std::ptrdiff_t>(to));
+                bool restored = searchQueryBuffer().flushFailed(std::move(failed), sqlState);
+                LOG_ERROR << "Search query log flush failed (" << (restored ? "will retry" : "dropped")
+                          << "): " << e.base().what();
             },
-            tenantId, query, resultCount);
+            Json::writeString(writer, rows));
     }
 }
 
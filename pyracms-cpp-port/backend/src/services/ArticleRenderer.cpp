@@ -0,0 +1,127 @@
+#include "services/ArticleRenderer.h"
+#include "services/HtmlSanitizer.h"
+#include "services/MarkdownRenderer.h"
+
+#include <algorithm>
+
+namespace pyracms {
+
+namespace {
+
+void escapeHtml(std::string &out, std::string_view text) {
+    for (char c : text) {
+        switch (c) {
+        case '&': out += "&amp;"; break;
+        case '<': out += "&lt;"; break;
+        case '>': out += "&gt;"; break;
+        case '"': out += "&quot;"; break;
+        default: out += c;
+        }
+    }
+}
+
+// Paragraphs at blank lines, line breaks within them
+std::string renderPlainText(std::string_view content) {
+    std::string out;
+    bool inParagraph = false;
+    size_t start = 0;
+    while (start <= content.size()) {
+        size_t end = content.find('\n', start);
+        if (end == std::string_view::npos) end = content.size();
+        auto line = content.substr(start, end - start);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        bool blank = line.find_first_not_of(" \t") == std::string_view::npos;
+        if (blank) {
+            if (inParagraph) out += "</p>\n";
+            inParagraph = false;
+        } else {
+            out += inParagraph ? "<br />\n" : "<p>";
+            inParagraph = true;
+            escapeHtml(out, line);
+        }
+        start = end + 1;
+    }
+    if (inParagraph) out += "</p>\n";
+    return out;
+}
+
+// Tags that sit inside a run of text rather than separating blocks
+bool isInlineTag(std::string_view name) {
+    static const char *tags[] = {"a",   "abbr", "b",     "code",   "del", "em",  "i",
+                                 "ins", "kbd",  "mark",  "q",      "s",   "samp", "small",
+                                 "span", "strong", "sub", "sup",   "u"};
+    return std::any_of(std::begin(tags), std::end(tags),
+                       [&](const char *tag) { return name == tag; });
+}
+
+} // namespace
+
+std::string ArticleRenderer::normalize(std::string_view renderer) {
+    std::string out;
+    for (char c : renderer) {
+        out += c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+    return out.empty() ? "markdown" : out;
+}
+
+ArticleRenderer::Output ArticleRenderer::render(std::string_view renderer,
+                                                std::string_view content) {
+    Output output;
+    auto name = normalize(renderer);
+    if (name == "markdown") {
+        output.html = HtmlSanitizer::sanitize(MarkdownRenderer::render(content));
+    } else if (name == "html") {
+        output.html = HtmlSanitizer::sanitize(content);
+    } else {
+        output.html = renderPlainText(content);
+    }
+    output.summary = summarize(output.html);
+    return output;
+}
+
+std::string ArticleRenderer::summarize(std::string_view html, size_t maxBytes) {
+    // Drop the markup; block boundaries become spaces
+    std::string text;
+    text.reserve(std::min(html.size(), maxBytes * 2));
+    size_t i = 0;
+    while (i < html.size() && text.size() <= maxBytes * 2) {
+        if (html[i] != '<') {
+            size_t next = std::min(html.find('<', i), html.size());
+            text.append(html.substr(i, next - i));
+            i = next;
+            continue;
+        }
+        size_t close = html.find('>', i);
+        if (close == std::string_view::npos) break;
+        size_t nameStart = i + 1 + (html[i + 1] == '/' ? 1 : 0);
+        size_t nameEnd = html.find_first_of(" />", nameStart);
+        if (!isInlineTag(html.substr(nameStart, nameEnd - nameStart))) text += ' ';
+        i = close + 1;
+    }
+    auto decoded = HtmlSanitizer::decodeEntities(text);
+
+    std::string out;
+    bool space = false;
+    for (char c : decoded) {
+        if (c == ' ' || c == '\n' || c == '\t' || c == '\r') {
+            space = !out.empty();
+            continue;
+        }
+        if (space) out += ' ';
+        space = false;
+        out += c;
+    }
+    if (out.size() <= maxBytes) return out;
+
+    // Cut on a character boundary, then back to the last word boundary if
+    // that does not lose more than half
+    size_t cut = maxBytes;
+    while (cut > 0 && (static_cast<unsigned char>(out[cut]) & 0xC0) == 0x80) --cut;
+    size_t spaceAt = out.rfind(' ', cut);
+    if (spaceAt != std::string::npos && spaceAt >= maxBytes / 2) cut = spaceAt;
+    out.resize(cut);
+    out += "\xE2\x80\xA6";
+    return out;
+}
+
+} // namespace pyracms
@@ -1,9 +1,98 @@
 #include "services/ArticleService.h"
+#include "services/AutocompleteService.h"
 #include "services/CacheService.h"
-#include "services/ElasticsearchService.h"
+#include "services/DbRouter.h"
+#include "services/PublishScheduler.h"
+#include "services/RenderService.h"
+#include "services/SearchService.h"
+#include "services/ViewCountService.h"
+
+#include <cstdlib>
+#include <unordered_set>
 
 namespace pyracms {
 
+namespace {
+
+// Revision columns other than the encoded text
+const char *kRevisionColumns =
+    "id, article_id, summary, user_id, created_at, storage, base_id, content, body";
+
+// For writes addressed by article id: the statement returns tenant_id and
+// name so the cached copies can be found
+void invalidateReturned(const drogon::orm::Result &result) {
+    for (const auto &row : result) {
+        CacheService::instance().invalidateArticle(row["tenant_id"].as<int>(),
+                                                   row["name"].as<std::string>());
+    }
+}
+
+// Status changes return id, display_name and view_count as well; published
+// articles are offered for autocomplete, anything else is withdrawn
+void autocompleteReturned(const drogon::orm::Result &result) {
+    auto &autocomplete = AutocompleteService::instance();
+    for (const auto &row : result) {
+        int tenantId = row["tenant_id"].as<int>();
+        int articleId = row["id"].as<int>();
+        if (row["status"].as<std::string>() == "published") {
+            autocomplete.indexArticle(tenantId, articleId, row["name"].as<std::string>(),
+                                      row["display_name"].as<std::string>(),
+                                      row["view_count"].as<int64_t>());
+        } else {
+            autocomplete.removeArticle(tenantId, articleId);
+        }
+    }
+}
+
+// Brings the search engines (Elasticsearch, the embedded index, spelling)
+// in line with the articles' current text and visibility: published public
+// articles are indexed, anything else is withdrawn. Read from the primary,
+// which has the write that prompted it.
+void reindexArticles(const std::vector<int> &articleIds) {
+    if (articleIds.empty()) return;
+    std::string ids = "{";
+    for (size_t i = 0; i < articleIds.size(); ++i) {
+        if (i > 0) ids += ",";
+        ids += std::to_string(articleIds[i]);
+    }
+    ids += "}";
+    DbRouter::instance().primary()->execSqlAsync(
+        "SELECT a.tenant_id, a.id, a.name, a.display_name, a.created_at, r.content "
+        "FROM articles a "
+        "LEFT JOIN LATERAL ("
+        "  SELECT content FROM article_revisions WHERE article_id = a.id "
+        "  ORDER BY created_at DESC, id DESC LIMIT 1) r ON true "
+        "WHERE a.id = ANY($1::int[]) AND a.status = 'published' AND a.is_private = false",
+        [articleIds](const drogon::orm::Result &result) {
+            std::unordered_set<int> visible;
+            for (const auto &row : result) {
+                int articleId = row["id"].as<int>();
+                visible.insert(articleId);
+                SearchService::indexArticle(
+                    row["tenant_id"].as<int>(), articleId, row["name"].as<std::string>(),
+                    row["display_name"].as<std::string>(),
+                    row["content"].isNull() ? "" : row["content"].as<std::string>(),
+                    row["created_at"].as<std::string>());
+            }
+            for (int articleId : articleIds) {
+                if (!visible.count(articleId)) SearchService::removeArticle(articleId);
+            }
+        },
+        [](const drogon::orm::DrogonDbException &e) {
+            LOG_ERROR << "reindexArticles error: " << e.base().what();
+        },
+        ids);
+}
+
+void reindexReturned(const drogon::orm::Result &result) {
+    std::vector<int> articleIds;
+    articleIds.reserve(result.size());
+    for (const auto &row : result) articleIds.push_back(row["id"].as<int>());
+    reindexArticles(articleIds);
+}
+
+} // namespace
+
 ArticleDto ArticleService::rowToArticleDto(const drogon::orm::Row &row) {
     ArticleDto dto;
     dto.id = row["id"].as<int>();
@@ -13,7 +102,8 @@ ArticleDto ArticleService::rowToArticleDto(const drogon::orm::Row &row) {
     dto.hideDisplayName = row["hide_display_name"].as<bool>();
     dto.userId = row["user_id"].as<int>();
     dto.rendererName = row["renderer_name"].isNull() ? "markdown" : row["renderer_name"].as<std::string>();
-    dto.viewCount = row["view_count"].as<int>();
+    dto.viewCount = row["view_count"].as<int>() +
+                    static_cast<int>(ViewCountService::pending(ViewCounter::Table::Article, dto.id));
     dto.createdAt = row["created_at"].as<std::string>();
     dto.status = row["status"].isNull() ? "published" : row["status"].as<std::string>();
     dto.publishedAt = row["published_at"].isNull() ? "" : row["published_at"].as<std::string>();
@@ -21,11 +111,36 @@ ArticleDto ArticleService::rowToArticleDto(const drogon::orm::Row &row) {
     return dto;
 }
 
+RevisionStore &ArticleService::revisions() {
+    static RevisionStore store([] {
+        RevisionStore::Options options;
+        const char *interval = std::getenv("REVISION_SNAPSHOT_INTERVAL");
+        const char *cacheMb = std::getenv("REVISION_CACHE_MB");
+        if (interval) options.snapshotInterval = std::atoi(interval);
+        if (cacheMb) options.cacheBytes = static_cast<size_t>(std::atoll(cacheMb)) * 1024 * 1024;
+        return options;
+    }());
+    return store;
+}
+
+RevisionStore::Row ArticleService::rowToStoredRevision(const drogon::orm::Row &row) {
+    RevisionStore::Row stored;
+    stored.id = row["id"].as<int>();
+    stored.baseId = row["base_id"].isNull() ? 0 : row["base_id"].as<int>();
+    stored.storage = static_cast<RevisionStore::Storage>(row["storage"].as<int>());
+    if (!row["content"].isNull()) stored.content = row["content"].as<std::string>();
+    if (!row["body"].isNull()) {
+        auto body = row["body"].as<std::vector<char>>();
+        stored.body.assign(body.begin(), body.end());
+    }
+    return stored;
+}
+
 ArticleRevisionDto ArticleService::rowToRevisionDto(const drogon::orm::Row &row) {
     ArticleRevisionDto dto;
     dto.id = row["id"].as<int>();
     dto.articleId = row["article_id"].as<int>();
-    dto.content = row["content"].as<std::string>();
+    dto.content = row["content"].isNull() ? "" : row["content"].as<std::string>();
     dto.summary = row["summary"].isNull() ? "" : row["summary"].as<std::string>();
     dto.userId = row["user_id"].as<int>();
     dto.createdAt = row["created_at"].as<std::string>();
@@ -33,11 +148,12 @@ ArticleRevisionDto ArticleService::rowToRevisionDto(const drogon::orm::Row &row)
 }
 
 void ArticleService::listArticles(const DbClientPtr &db, int tenantId,
-                                   int limit, int offset,
+                                   const PageRequest &page,
                                    ArticleListCallback cb) {
     db->execSqlAsync(
         "SELECT * FROM articles WHERE tenant_id = $1 AND is_private = false "
-        "ORDER BY created_at DESC LIMIT " + std::to_string(limit) + " OFFSET " + std::to_string(offset),
+        "AND (created_at, id) < ($2::timestamptz, $3::bigint) "
+        "ORDER BY created_at DESC, id DESC LIMIT $4 OFFSET $5",
         [this, cb](const drogon::orm::Result &result) {
             std::vector<ArticleDto> articles;
             articles.reserve(result.size());
@@ -50,17 +166,14 @@ void ArticleService::listArticles(const DbClientPtr &db, int tenantId,
             LOG_ERROR << "listArticles error: " << e.base().what();
             cb({});
         },
-        tenantId);
+        tenantId, page.afterKey(), page.afterId(), page.limit, page.skip());
 }
 
 void ArticleService::getArticle(const DbClientPtr &db, int tenantId,
                                  const std::string &name,
                                  ArticleCallback cb) {
-    // Increment view_count and return the article
     db->execSqlAsync(
-        "UPDATE articles SET view_count = view_count + 1 "
-        "WHERE tenant_id = $1 AND name = $2 "
-        "RETURNING *",
+        "SELECT * FROM articles WHERE tenant_id = $1 AND name = $2",
         [this, cb](const drogon::orm::Result &result) {
             if (result.empty()) {
                 cb(std::nullopt);
@@ -74,6 +187,29 @@ void ArticleService::getArticle(const DbClientPtr &db, int tenantId,
         tenantId, name);
 }
 
+void ArticleService::viewArticle(const DbClientPtr &db, int tenantId,
+                                  const std::string &name,
+                                  ArticleCallback cb) {
+    // The view is counted in memory, so reading an article writes nothing
+    db->execSqlAsync(
+        "SELECT * FROM articles WHERE tenant_id = $1 AND name = $2",
+        [this, cb](const drogon::orm::Result &result) {
+            if (result.empty()) {
+                cb(std::nullopt);
+                return;
+            }
+            ViewCountService::record(ViewCounter::Table::Article, result[0]["id"].as<int>());
+            auto article = rowToArticleDto(result[0]);
+            AutocompleteService::instance().setArticleViews(
+                result[0]["tenant_id"].as<int>(), article.id, article.viewCount);
+            cb(article);
+        },
+        [cb](const drogon::orm::DrogonDbException &) {
+            cb(std::nullopt);
+        },
+        tenantId, name);
+}
+
 void ArticleService::createArticle(const DbClientPtr &db, int tenantId,
                                     const std::string &name,
                                     const std::string &displayName,
@@ -89,24 +225,22 @@ void ArticleService::createArticle(const DbClientPtr &db, int tenantId,
         [this, db, tenantId, name, displayName, content, userId, cb](const drogon::orm::Result &result) {
             int articleId = result[0]["id"].as<int>();
             // Create the initial revision
-            db->execSqlAsync(
-                "INSERT INTO article_revisions (article_id, content, summary, "
-                "user_id, created_at) "
-                "VALUES ($1, $2, 'Initial revision', $3, NOW())",
-                [tenantId, name, displayName, content, articleId, cb](const drogon::orm::Result &) {
+            appendRevision(
+                db, articleId, content, "Initial revision", userId,
+                [tenantId, name, displayName, content, articleId, cb](bool ok,
+                                                                      const std::string &error) {
+                    if (!ok) {
+                        cb(false, error);
+                        return;
+                    }
                     // Invalidate cache
                     CacheService::instance().invalidateArticle(tenantId, name);
-                    // Index in Elasticsearch
-                    if (ElasticsearchService::instance().isConfigured()) {
-                        ElasticsearchService::instance().indexArticle(
-                            tenantId, articleId, name, displayName, content, "");
-                    }
+                    SearchService::indexArticle(tenantId, articleId, name, displayName,
+                                                content, "");
+                    AutocompleteService::instance().indexArticle(tenantId, articleId, name,
+                                                                 displayName, 0);
                     cb(true, "");
-                },
-                [cb](const drogon::orm::DrogonDbException &e) {
-                    cb(false, e.base().what());
-                },
-                articleId, content, userId);
+                });
         },
         [cb](const drogon::orm::DrogonDbException &e) {
             cb(false, e.base().what());
@@ -123,23 +257,21 @@ void ArticleService::updateArticle(const DbClientPtr &db, int tenantId,
     // Find the article first, then create a new revision
     db->execSqlAsync(
         "SELECT id FROM articles WHERE tenant_id = $1 AND name = $2",
-        [this, db, content, summary, userId, cb](const drogon::orm::Result &result) {
+        [this, db, tenantId, name, content, summary, userId, cb](const drogon::orm::Result &result) {
             if (result.empty()) {
                 cb(false, "Article not found");
                 return;
             }
             int articleId = result[0]["id"].as<int>();
-            db->execSqlAsync(
-                "INSERT INTO article_revisions (article_id, content, summary, "
-                "user_id, created_at) "
-                "VALUES ($1, $2, $3, $4, NOW())",
-                [cb](const drogon::orm::Result &) {
-                    cb(true, "");
-                },
-                [cb](const drogon::orm::DrogonDbException &e) {
-                    cb(false, e.base().what());
-                },
-                articleId, content, summary, userId);
+            appendRevision(
+                db, articleId, content, summary, userId,
+                [tenantId, name, articleId, cb](bool ok, const std::string &error) {
+                    if (ok) {
+                        CacheService::instance().invalidateArticle(tenantId, name);
+                        reindexArticles({articleId});
+                    }
+                    cb(ok, error);
+                });
         },
         [cb](const drogon::orm::DrogonDbException &e) {
             cb(false, e.base().what());
@@ -157,10 +289,9 @@ void ArticleService::deleteArticle(const DbClientPtr &db, int tenantId,
                 cb(false, "Article not found");
             } else {
                 CacheService::instance().invalidateArticle(tenantId, name);
-                if (ElasticsearchService::instance().isConfigured()) {
-                    ElasticsearchService::instance().deleteDocument(
-                        "pyracms_articles", result[0]["id"].as<int>());
-                }
+                SearchService::removeArticle(result[0]["id"].as<int>());
+                AutocompleteService::instance().removeArticle(tenantId,
+                                                              result[0]["id"].as<int>());
                 cb(true, "");
             }
         },
@@ -170,16 +301,88 @@ void ArticleService::deleteArticle(const DbClientPtr &db, int tenantId,
         tenantId, name);
 }
 
+void ArticleService::appendRevision(const DbClientPtr &db, int articleId,
+                                     const std::string &content,
+                                     const std::string &summary, int userId,
+                                     BoolCallback cb) {
+    db->execSqlAsync(
+        "SELECT a.renderer_name, r.id, r.chain, r.content FROM articles a "
+        "LEFT JOIN LATERAL ("
+        "  SELECT id, chain, content FROM article_revisions WHERE article_id = a.id "
+        "  ORDER BY created_at DESC, id DESC LIMIT 1) r ON true "
+        "WHERE a.id = $1",
+        [db, articleId, content, summary, userId, cb](const drogon::orm::Result &result) {
+            if (result.empty()) {
+                cb(false, "Article not found");
+                return;
+            }
+            int previousId = 0;
+            int previousChain = 0;
+            std::string previous;
+            bool hasPrevious = !result[0]["id"].isNull() && !result[0]["content"].isNull();
+            if (hasPrevious) {
+                previousId = result[0]["id"].as<int>();
+                previousChain = result[0]["chain"].as<int>();
+                previous = result[0]["content"].as<std::string>();
+            }
+            auto renderer = result[0]["renderer_name"].as<std::string>();
+            auto encoded = revisions().encode(content, hasPrevious ? &previous : nullptr,
+                                              previousChain);
+            int baseId = encoded.storage == RevisionStore::Storage::Delta ? previousId : 0;
+            std::vector<char> body(encoded.body.begin(), encoded.body.end());
+            // The new row keeps its text in full; the one it supersedes
+            // keeps only its encoding (rows from before encoding keep theirs)
+            db->execSqlAsync(
+                "WITH superseded AS ("
+                "  UPDATE article_revisions SET content = NULL "
+                "  WHERE id = $1 AND storage <> 0) "
+                "INSERT INTO article_revisions (article_id, content, summary, "
+                "user_id, created_at, storage, base_id, chain, body) "
+                "VALUES ($2, $3, $4, $5, NOW(), $6, NULLIF($7, 0), $8, $9) "
+                "RETURNING id",
+                [renderer, content, cb](const drogon::orm::Result &inserted) {
+                    // Rendered before the article page asks for it
+                    RenderService::instance().renderInBackground(
+                        inserted[0]["id"].as<int>(), renderer, content);
+                    cb(true, "");
+                },
+                [cb](const drogon::orm::DrogonDbException &e) {
+                    cb(false, e.base().what());
+                },
+                previousId, articleId, content, summary, userId,
+                static_cast<int16_t>(encoded.storage), baseId, encoded.chain, body);
+        },
+        [cb](const drogon::orm::DrogonDbException &e) {
+            cb(false, e.base().what());
+        },
+        articleId);
+}
+
 void ArticleService::listRevisions(const DbClientPtr &db, int articleId,
                                     RevisionListCallback cb) {
+    // Oldest first so every delta follows its base
     db->execSqlAsync(
-        "SELECT * FROM article_revisions WHERE article_id = $1 "
-        "ORDER BY created_at DESC",
-        [this, cb](const drogon::orm::Result &result) {
+        std::string("SELECT ") + kRevisionColumns + " FROM article_revisions "
+        "WHERE article_id = $1 ORDER BY created_at, id",
+        [this, articleId, cb](const drogon::orm::Result &result) {
+            std::vector<RevisionStore::Row> stored;
+            stored.reserve(result.size());
+            for (const auto &row : result) {
+                stored.push_back(rowToStoredRevision(row));
+            }
+            auto texts = revisions().rebuildAll(stored);
+
             std::vector<ArticleRevisionDto> revisions;
             revisions.reserve(result.size());
-            for (const auto &row : result) {
-                revisions.push_back(rowToRevisionDto(row));
+            for (size_t i = result.size(); i-- > 0;) {
+                auto dto = rowToRevisionDto(result[i]);
+                if (texts[i]) {
+                    dto.content = std::move(*texts[i]);
+                } else {
+                    LOG_ERROR << "listRevisions: cannot rebuild revision " << dto.id
+                              << " of article " << articleId;
+                }
+                revisions.push_back(std::move(dto));
             }
             cb(revisions);
         },
@@ -191,11 +394,56 @@ void ArticleService::listRevisions(const DbClientPtr &db, int articleId,
 
 void ArticleService::getRevision(const DbClientPtr &db, int revisionId,
                                   RevisionCallback cb) {
+    // The revision and its bases back to one stored in full; the depth
+    // bound only guards against a corrupt, cyclic chain
+    int maxDepth = revisions().options().snapshotInterval * 4;
     db->execSqlAsync(
-        "SELECT * FROM article_revisions WHERE id = $1",
-        [this, cb](const drogon::orm::Result &result) {
+        std::string("WITH RECURSIVE bases AS ("
+                    "  SELECT ") + kRevisionColumns + ", 0 AS depth "
+        "  FROM article_revisions WHERE id = $1 "
+        "  UNION ALL "
+        "  SELECT r.id, r.article_id, r.summary, r.user_id, r.created_at, r.storage, "
+        "         r.base_id, r.content, r.body, c.depth + 1 "
+        "  FROM bases c JOIN article_revisions r ON r.id = c.base_id "
+        "  WHERE c.storage = 2 AND c.content IS NULL AND c.depth < $2) "
+        "SELECT * FROM bases ORDER BY depth",
+        [this, revisionId, cb](const drogon::orm::Result &result) {
+            if (result.empty()) {
+                cb(std::nullopt);
+                return;
+            }
+            std::vector<RevisionStore::Row> chain;
+            chain.reserve(result.size());
+            for (const auto &row : result) {
+                chain.push_back(rowToStoredRevision(row));
+            }
+            auto text = revisions().rebuild(chain);
+            if (!text) {
+                LOG_ERROR << "getRevision: cannot rebuild revision " << revisionId;
+                cb(std::nullopt);
+                return;
+            }
+            auto dto = rowToRevisionDto(result[0]);
+            dto.content = std::move(*text);
+            cb(dto);
+        },
+        [cb](const drogon::orm::DrogonDbException &) {
+            cb(std::nullopt);
+        },
+        revisionId, maxDepth);
+}
+
+void ArticleService::getLatestRevision(const DbClientPtr &db, int articleId,
+                                        RevisionCallback cb) {
+    db->execSqlAsync(
+        std::string("SELECT ") + kRevisionColumns + " FROM article_revisions "
+        "WHERE article_id = $1 ORDER BY created_at DESC, id DESC LIMIT 1",
+        [this, db, cb](const drogon::orm::Result &result) {
             if (result.empty()) {
                 cb(std::nullopt);
+            } else if (result[0]["content"].isNull()) {
+                // Only while a concurrent edit is superseding it
+                getRevision(db, result[0]["id"].as<int>(), cb);
             } else {
                 cb(rowToRevisionDto(result[0]));
             }
@@ -203,51 +451,120 @@ void ArticleService::getRevision(const DbClientPtr &db, int revisionId,
         [cb](const drogon::orm::DrogonDbException &) {
             cb(std::nullopt);
         },
-        revisionId);
+        articleId);
+}
+
+void ArticleService::getRenderedRevision(const DbClientPtr &db, int articleId,
+                                          const std::string &renderer,
+                                          RevisionCallback cb) {
+    auto name = ArticleRenderer::normalize(renderer);
+    db->execSqlAsync(
+        "SELECT r.id, r.article_id, r.summary, r.user_id, r.created_at, r.content, ar.html "
+        "FROM article_revisions r "
+        "LEFT JOIN article_renders ar ON ar.revision_id = r.id "
+        "AND ar.renderer = $2 AND ar.version = $3 "
+        "WHERE r.article_id = $1 ORDER BY r.created_at DESC, r.id DESC LIMIT 1",
+        [this, db, name, cb](const drogon::orm::Result &result) {
+            if (result.empty()) {
+                cb(std::nullopt);
+                return;
+            }
+            if (result[0]["content"].isNull()) {
+                // Only while a concurrent edit is superseding it
+                getRevision(db, result[0]["id"].as<int>(),
+                            [name, cb](const std::optional<ArticleRevisionDto> &revision) {
+                                if (!revision) {
+                                    cb(std::nullopt);
+                                    return;
+                                }
+                                auto dto = *revision;
+                                dto.html = RenderService::instance()
+                                               .render(dto.id, name, dto.content)
+                                               .html;
+                                cb(dto);
+                            });
+                return;
+            }
+            auto dto = rowToRevisionDto(result[0]);
+            if (!result[0]["html"].isNull()) {
+                dto.html = result[0]["html"].as<std::string>();
+            } else {
+                dto.html = RenderService::instance().render(dto.id, name, dto.content).html;
+            }
+            cb(dto);
+        },
+        [cb](const drogon::orm::DrogonDbException &) {
+            cb(std::nullopt);
+        },
+        articleId, name, ArticleRenderer::kVersion);
 }
 
 void ArticleService::revertToRevision(const DbClientPtr &db, int articleId,
                                        int revisionId, int userId,
                                        BoolCallback cb) {
-    // Get the content from the target revision, then create a new revision
-    db->execSqlAsync(
-        "SELECT content FROM article_revisions WHERE id = $1 AND article_id = $2",
-        [this, db, articleId, userId, revisionId, cb](const drogon::orm::Result &result) {
-            if (result.empty()) {
+    // Rebuild the target revision, then store its text as a new revision
+    getRevision(
+        db, revisionId,
+        [this, db, articleId, userId, revisionId, cb](
+            const std::optional<ArticleRevisionDto> &revision) {
+            if (!revision || revision->articleId != articleId) {
                 cb(false, "Revision not found");
                 return;
             }
-            auto content = result[0]["content"].as<std::string>();
-            auto summary = "Reverted to revision " + std::to_string(revisionId);
+            auto content = revision->content;
             db->execSqlAsync(
-                "INSERT INTO article_revisions (article_id, content, summary, "
-                "user_id, created_at) "
-                "VALUES ($1, $2, $3, $4, NOW())",
-                [cb](const drogon::orm::Result &) {
-                    cb(true, "");
+                "SELECT tenant_id, name FROM articles WHERE id = $1",
+                [this, db, articleId, userId, revisionId, content,
+                 cb](const drogon::orm::Result &result) {
+                    if (result.empty()) {
+                        cb(false, "Revision not found");
+                        return;
+                    }
+                    auto summary = "Reverted to revision " + std::to_string(revisionId);
+                    int tenantId = result[0]["tenant_id"].as<int>();
+                    auto name = result[0]["name"].as<std::string>();
+                    appendRevision(
+                        db, articleId, content, summary, userId,
+                        [tenantId, name, articleId, cb](bool ok, const std::string &error) {
+                            if (ok) {
+                                CacheService::instance().invalidateArticle(tenantId, name);
+                                reindexArticles({articleId});
+                            }
+                            cb(ok, error);
+                        });
                 },
                 [cb](const drogon::orm::DrogonDbException &e) {
                     cb(false, e.base().what());
                 },
-                articleId, content, summary, userId);
-        },
-        [cb](const drogon::orm::DrogonDbException &e) {
-            cb(false, e.base().what());
-        },
-        revisionId, articleId);
+                articleId);
+        });
 }
 
 void ArticleService::switchRenderer(const DbClientPtr &db, int articleId,
                                      const std::string &renderer,
                                      BoolCallback cb) {
+    // The newest revision is rendered for the new renderer now rather than
+    // on the next read
     db->execSqlAsync(
-        "UPDATE articles SET renderer_name = $1 WHERE id = $2",
-        [cb](const drogon::orm::Result &result) {
-            if (result.affectedRows() == 0) {
+        "WITH updated AS ("
+        "  UPDATE articles SET renderer_name = $1 WHERE id = $2 "
+        "  RETURNING id, tenant_id, name) "
+        "SELECT u.tenant_id, u.name, r.id AS revision_id, r.content FROM updated u "
+        "LEFT JOIN LATERAL ("
+        "  SELECT id, content FROM article_revisions WHERE article_id = u.id "
+        "  ORDER BY created_at DESC, id DESC LIMIT 1) r ON true",
+        [renderer, cb](const drogon::orm::Result &result) {
+            if (result.empty()) {
                 cb(false, "Article not found");
-            } else {
-                cb(true, "");
+                return;
+            }
+            invalidateReturned(result);
+            if (!result[0]["content"].isNull()) {
+                RenderService::instance().renderInBackground(
+                    result[0]["revision_id"].as<int>(), renderer,
+                    result[0]["content"].as<std::string>());
             }
+            cb(true, "");
         },
         [cb](const drogon::orm::DrogonDbException &e) {
             cb(false, e.base().what());
@@ -258,11 +575,14 @@ void ArticleService::switchRenderer(const DbClientPtr &db, int articleId,
 void ArticleService::togglePrivate(const DbClientPtr &db, int articleId,
                                     BoolCallback cb) {
     db->execSqlAsync(
-        "UPDATE articles SET is_private = NOT is_private WHERE id = $1",
+        "UPDATE articles SET is_private = NOT is_private WHERE id = $1 "
+        "RETURNING tenant_id, id, name",
         [cb](const drogon::orm::Result &result) {
             if (result.affectedRows() == 0) {
                 cb(false, "Article not found");
             } else {
+                invalidateReturned(result);
+                reindexReturned(result);
                 cb(true, "");
             }
         },
@@ -353,11 +673,16 @@ void ArticleService::publishArticle(const DbClientPtr &db, int articleId,
                                      BoolCallback cb) {
     db->execSqlAsync(
         "UPDATE articles SET status = 'published', published_at = NOW(), "
-        "scheduled_at = NULL WHERE id = $1",
-        [cb](const drogon::orm::Result &result) {
+        "scheduled_at = NULL WHERE id = $1 "
+        "RETURNING tenant_id, id, name, display_name, status, view_count",
+        [cb, articleId](const drogon::orm::Result &result) {
             if (result.affectedRows() == 0) {
                 cb(false, "Article not found");
             } else {
+                PublishScheduler::instance().onUnscheduled(articleId);
+                invalidateReturned(result);
+                autocompleteReturned(result);
+                reindexReturned(result);
                 cb(true, "");
             }
         },
@@ -372,11 +697,21 @@ void ArticleService::scheduleArticle(const DbClientPtr &db, int articleId,
                                       BoolCallback cb) {
     db->execSqlAsync(
         "UPDATE articles SET status = 'scheduled', scheduled_at = $2 "
-        "WHERE id = $1",
-        [cb](const drogon::orm::Result &result) {
+        "WHERE id = $1 RETURNING tenant_id, id, name, display_name, status, view_count, "
+        "EXTRACT(EPOCH FROM scheduled_at - clock_timestamp())::float8 AS delay",
+        [cb, articleId](const drogon::orm::Result &result) {
             if (result.affectedRows() == 0) {
                 cb(false, "Article not found");
             } else {
+                if (result[0]["delay"].isNull()) {
+                    PublishScheduler::instance().onUnscheduled(articleId);
+                } else {
+                    PublishScheduler::instance().onScheduled(
+                        articleId, result[0]["delay"].as<double>());
+                }
+                invalidateReturned(result);
+                autocompleteReturned(result);
+                reindexReturned(result);
                 cb(true, "");
             }
         },
@@ -389,11 +724,16 @@ void ArticleService::scheduleArticle(const DbClientPtr &db, int articleId,
 void ArticleService::unpublishArticle(const DbClientPtr &db, int articleId,
                                        BoolCallback cb) {
     db->execSqlAsync(
-        "UPDATE articles SET status = 'unpublished' WHERE id = $1",
-        [cb](const drogon::orm::Result &result) {
+        "UPDATE articles SET status = 'unpublished' WHERE id = $1 "
+        "RETURNING tenant_id, id, name, display_name, status, view_count",
+        [cb, articleId](const drogon::orm::Result &result) {
             if (result.affectedRows() == 0) {
                 cb(false, "Article not found");
             } else {
+                PublishScheduler::instance().onUnscheduled(articleId);
+                invalidateReturned(result);
+                autocompleteReturned(result);
+                reindexReturned(result);
                 cb(true, "");
             }
         },
@@ -404,15 +744,23 @@ void ArticleService::unpublishArticle(const DbClientPtr &db, int articleId,
 }
 
 void ArticleService::publishDueArticles(const DbClientPtr &db,
-                                         BoolCallback cb) {
+                                         PublishedCallback cb) {
     db->execSqlAsync(
         "UPDATE articles SET status = 'published', published_at = NOW() "
-        "WHERE status = 'scheduled' AND scheduled_at <= NOW()",
+        "WHERE status = 'scheduled' AND scheduled_at <= NOW() "
+        "RETURNING tenant_id, id, name, display_name, status, view_count",
         [cb](const drogon::orm::Result &result) {
-            cb(true, std::to_string(result.affectedRows()) + " articles published");
+            invalidateReturned(result);
+            autocompleteReturned(result);
+            reindexReturned(result);
+            std::vector<int> published;
+            published.reserve(result.size());
+            for (const auto &row : result) published.push_back(row["id"].as<int>());
+            cb(true, published);
         },
         [cb](const drogon::orm::DrogonDbException &e) {
-            cb(false, e.base().what());
+            LOG_ERROR << "Scheduled publishing failed: " << e.base().what();
+            cb(false, {});
         });
 }
 
@@ -0,0 +1,343 @@
+#include "services/AutocompleteIndex.h"
+
+#include <algorithm>
+#include <mutex>
+#include <queue>
+
+namespace pyracms {
+
+namespace {
+
+constexpr uint32_t kNone = UINT32_MAX;
+
+std::string entryKey(const std::string &type, int id) {
+    std::string key = type;
+    key += '\0';
+    key += std::to_string(id);
+    return key;
+}
+
+} // namespace
+
+struct AutocompleteIndex::Trie {
+    struct Node {
+        std::string label; // edge from the parent
+        uint32_t parent = kNone;
+        uint64_t best = 0;             // largest weight in this subtree
+        std::vector<uint32_t> children; // sorted by first label byte
+        std::vector<uint32_t> entries;  // slots whose text ends here
+    };
+
+    struct Slot {
+        AutocompleteEntry entry;
+        uint32_t node = kNone; // kNone while the slot is free
+    };
+
+    mutable std::shared_mutex mu;
+    std::vector<Node> nodes = std::vector<Node>(1); // root at 0
+    std::vector<uint32_t> freeNodes;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<std::string, uint32_t> byKey;
+
+    uint32_t newNode(std::string label, uint32_t parent) {
+        uint32_t n;
+        if (!freeNodes.empty()) {
+            n = freeNodes.back();
+            freeNodes.pop_back();
+        } else {
+            n = static_cast<uint32_t>(nodes.size());
+            nodes.emplace_back();
+        }
+        auto &node = nodes[n];
+        node.label = std::move(label);
+        node.parent = parent;
+        node.best = 0;
+        node.children.clear();
+        node.entries.clear();
+        return n;
+    }
+
+    void freeNode(uint32_t n) {
+        nodes[n].label.clear();
+        nodes[n].label.shrink_to_fit();
+        nodes[n].children = {};
+        nodes[n].entries = {};
+        nodes[n].parent = kNone;
+        freeNodes.push_back(n);
+    }
+
+    std::vector<uint32_t>::iterator childSlot(uint32_t n, char c) {
+        auto &children = nodes[n].children;
+        return std::lower_bound(children.begin(), children.end(), c,
+                                [this](uint32_t child, char ch) {
+                                    return nodes[child].label[0] < ch;
+                                });
+    }
+
+    void replaceChild(uint32_t parent, uint32_t from, uint32_t to) {
+        auto &children = nodes[parent].children;
+        *std::find(children.begin(), children.end(), from) = to;
+    }
+
+    void removeChild(uint32_t parent, uint32_t child) {
+        auto &children = nodes[parent].children;
+        children.erase(std::find(children.begin(), children.end(), child));
+    }
+
+    // Node for key, creating and splitting edges as needed
+    uint32_t insertKey(std::string_view key) {
+        uint32_t n = 0;
+        size_t pos = 0;
+        while (pos < key.size()) {
+            auto it = childSlot(n, key[pos]);
+            if (it == nodes[n].children.end() || nodes[*it].label[0] != key[pos]) {
+                auto index = it - nodes[n].children.begin();
+                uint32_t leaf = newNode(std::string(key.substr(pos)), n);
+                nodes[n].children.insert(nodes[n].children.begin() + index, leaf);
+                return leaf;
+            }
+            uint32_t child = *it;
+            const auto &label = nodes[child].label;
+            size_t common = 0;
+            while (common < label.size() && pos + common < key.size() &&
+                   label[common] == key[pos + common]) {
+                ++common;
+            }
+            if (common < label.size()) {
+                // Split the edge; the new node keeps the child's slot
+                uint32_t mid = newNode(nodes[child].label.substr(0, common), n);
+                nodes[child].label.erase(0, common);
+                nodes[child].parent = mid;
+                nodes[mid].children.push_back(child);
+                nodes[mid].best = nodes[child].best;
+                replaceChild(n, child, mid);
+                child = mid;
+            }
+            n = child;
+            pos += common;
+        }
+        return n;
+    }
+
+    // Recomputes subtree maxima from n up, stopping once one is unchanged
+    void refresh(uint32_t n) {
+        while (n != kNone) {
+            uint64_t best = 0;
+            for (auto slot : nodes[n].entries) best = std::max(best, slots[slot].entry.weight);
+            for (auto child : nodes[n].children) best = std::max(best, nodes[child].best);
+            if (best == nodes[n].best) return;
+            nodes[n].best = best;
+            n = nodes[n].parent;
+        }
+    }
+
+    void attach(uint32_t slot) {
+        uint32_t n = insertKey(normalize(slots[slot].entry.text));
+        nodes[n].entries.push_back(slot);
+        slots[slot].node = n;
+        for (uint64_t w = slots[slot].entry.weight; n != kNone && nodes[n].best < w;
+             n = nodes[n].parent) {
+            nodes[n].best = w;
+        }
+    }
+
+    void detach(uint32_t slot) {
+        uint32_t n = slots[slot].node;
+        auto &entries = nodes[n].entries;
+        entries.erase(std::find(entries.begin(), entries.end(), slot));
+        slots[slot].node = kNone;
+
+        // Drop branches that no longer lead anywhere
+        while (n != 0 && nodes[n].entries.empty() && nodes[n].children.empty()) {
+            uint32_t parent = nodes[n].parent;
+            removeChild(parent, n);
+            freeNode(n);
+            n = parent;
+        }
+        // Fold a pass-through node into its only child
+        if (n != 0 && nodes[n].entries.empty() && nodes[n].children.size() == 1) {
+            uint32_t only = nodes[n].children[0];
+            uint32_t parent = nodes[n].parent;
+            nodes[only].label.insert(0, nodes[n].label);
+            nodes[only].parent = parent;
+            replaceChild(parent, n, only);
+            freeNode(n);
+            n = parent;
+        }
+        refresh(n);
+    }
+
+    // Node whose subtree holds exactly the keys starting with prefix
+    uint32_t locate(std::string_view prefix) const {
+        uint32_t n = 0;
+        size_t pos = 0;
+        while (pos < prefix.size()) {
+            const auto &children = nodes[n].children;
+            auto it = std::lower_bound(children.begin(), children.end(), prefix[pos],
+                                       [this](uint32_t child, char ch) {
+                                           return nodes[child].label[0] < ch;
+                                       });
+            if (it == children.end()) return kNone;
+            const auto &label = nodes[*it].label;
+            size_t rest = prefix.size() - pos;
+            if (rest <= label.size()) {
+                return label.compare(0, rest, prefix.substr(pos)) == 0 ? *it : kNone;
+            }
+            if (prefix.compare(pos, label.size(), label) != 0) return kNone;
+            n = *it;
+            pos += label.size();
+        }
+        return n;
+    }
+};
+
+AutocompleteIndex::AutocompleteIndex() = default;
+AutocompleteIndex::~AutocompleteIndex() = default;
+
+std::string AutocompleteIndex::normalize(std::string_view text) {
+    std::string out(text);
+    for (auto &c : out) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return out;
+}
+
+std::shared_ptr<AutocompleteIndex::Trie> AutocompleteIndex::findTrie(int tenantId) const {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    auto it = tries_.find(tenantId);
+    return it == tries_.end() ? nullptr : it->second;
+}
+
+std::shared_ptr<AutocompleteIndex::Trie> AutocompleteIndex::trie(int tenantId) {
+    if (auto existing = findTrie(tenantId)) return existing;
+    std::unique_lock<std::shared_mutex> lock(mu_);
+    auto &slot = tries_[tenantId];
+    if (!slot) slot = std::make_shared<Trie>();
+    return slot;
+}
+
+void AutocompleteIndex::upsert(int tenantId, AutocompleteEntry entry) {
+    auto t = trie(tenantId);
+    std::unique_lock<std::shared_mutex> lock(t->mu);
+    auto key = entryKey(entry.type, entry.id);
+    auto it = t->byKey.find(key);
+    if (it != t->byKey.end()) {
+        auto slot = it->second;
+        auto &current = t->slots[slot].entry;
+        if (normalize(current.text) == normalize(entry.text)) {
+            current = std::move(entry);
+            t->refresh(t->slots[slot].node);
+            return;
+        }
+        t->detach(slot);
+        current = std::move(entry);
+        t->attach(slot);
+        return;
+    }
+
+    uint32_t slot;
+    if (!t->freeSlots.empty()) {
+        slot = t->freeSlots.back();
+        t->freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(t->slots.size());
+        t->slots.emplace_back();
+    }
+    t->slots[slot].entry = std::move(entry);
+    t->byKey.emplace(std::move(key), slot);
+    t->attach(slot);
+}
+
+bool AutocompleteIndex::remove(int tenantId, const std::string &type, int id) {
+    auto t = findTrie(tenantId);
+    if (!t) return false;
+    std::unique_lock<std::shared_mutex> lock(t->mu);
+    auto it = t->byKey.find(entryKey(type, id));
+    if (it == t->byKey.end()) return false;
+    auto slot = it->second;
+    t->byKey.erase(it);
+    t->detach(slot);
+    t->slots[slot].entry = {};
+    t->freeSlots.push_back(slot);
+    return true;
+}
+
+bool AutocompleteIndex::setWeight(int tenantId, const std::string &type, int id, uint64_t weight) {
+    auto t = findTrie(tenantId);
+    if (!t) return false;
+    std::unique_lock<std::shared_mutex> lock(t->mu);
+    auto it = t->byKey.find(entryKey(type, id));
+    if (it == t->byKey.end()) return false;
+    auto &slot = t->slots[it->second];
+    slot.entry.weight = weight;
+    t->refresh(slot.node);
+    return true;
+}
+
+std::vector<AutocompleteItem> AutocompleteIndex::complete(int tenantId, std::string_view prefix,
+                                                          size_t limit) const {
+    std::vector<AutocompleteItem> out;
+    if (limit == 0) return out;
+    auto key = normalize(prefix);
+
+    std::shared_ptr<Trie> tries[2] = {findTrie(tenantId),
+                                      tenantId == kSharedTenant ? nullptr
+                                                                : findTrie(kSharedTenant)};
+    std::shared_lock<std::shared_mutex> locks[2];
+
+    // Best-first over nodes (keyed by subtree maximum) and entries (keyed
+    // by their own weight); an entry popped before every remaining node
+    // outranks everything still unexplored
+    struct Candidate {
+        uint64_t weight;
+        bool entry;
+        uint8_t trie;
+        uint32_t index;
+    };
+    auto worse = [](const Candidate &a, const Candidate &b) {
+        if (a.weight != b.weight) return a.weight < b.weight;
+        if (a.entry != b.entry) return !a.entry;
+        if (a.trie != b.trie) return a.trie > b.trie;
+        return a.index > b.index;
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(worse)> frontier(worse);
+
+    for (uint8_t i = 0; i < 2; ++i) {
+        if (!tries[i]) continue;
+        locks[i] = std::shared_lock<std::shared_mutex>(tries[i]->mu);
+        auto n = tries[i]->locate(key);
+        if (n != kNone) frontier.push({tries[i]->nodes[n].best, false, i, n});
+    }
+
+    while (!frontier.empty() && out.size() < limit) {
+        auto top = frontier.top();
+        frontier.pop();
+        const auto &t = *tries[top.trie];
+        if (top.entry) {
+            const auto &entry = t.slots[top.index].entry;
+            out.push_back({entry.text, entry.type, entry.url});
+            continue;
+        }
+        const auto &node = t.nodes[top.index];
+        for (auto slot : node.entries) {
+            frontier.push({t.slots[slot].entry.weight, true, top.trie, slot});
+        }
+        for (auto child : node.children) {
+            frontier.push({t.nodes[child].best, false, top.trie, child});
+        }
+    }
+    return out;
+}
+
+size_t AutocompleteIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    size_t total = 0;
+    for (const auto &[tenant, t] : tries_) {
+        std::shared_lock<std::shared_mutex> trieLock(t->mu);
+        total += t->byKey.size();
+    }
+    return total;
+}
+
+} // namespace pyracms
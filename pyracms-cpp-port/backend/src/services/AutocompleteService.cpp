@@ -0,0 +1,206 @@
+#include "services/AutocompleteService.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace pyracms {
+
+namespace {
+
+uint64_t weight(int64_t views) {
+    return static_cast<uint64_t>(std::max<int64_t>(views, 0));
+}
+
+int64_t views(const drogon::orm::Field &field) {
+    return field.isNull() ? 0 : field.as<int64_t>();
+}
+
+AutocompleteEntry articleEntry(int articleId, const std::string &name,
+                               const std::string &displayName, int64_t viewCount) {
+    return {"article", articleId, displayName, "/articles/" + name, weight(viewCount)};
+}
+
+AutocompleteEntry forumPostEntry(int postId, const std::string &title, int threadId,
+                                 int64_t threadViews) {
+    return {"forum_post", postId, title, "/forum/thread/" + std::to_string(threadId),
+            weight(threadViews)};
+}
+
+AutocompleteEntry gameDepEntry(int pageId, const std::string &name,
+                               const std::string &displayName, int64_t viewCount) {
+    return {"gamedep", pageId, displayName, "/gamedep/" + name, weight(viewCount)};
+}
+
+struct Source {
+    const char *type;
+    const char *sql;
+    void (*load)(AutocompleteIndex &, const drogon::orm::Row &);
+};
+
+// Everything the SQL fallback would match, across all tenants. Forum posts
+// rank by their thread's views; gamedep pages have no tenant and go to the
+// shared trie.
+const Source kSources[] = {
+    {"article",
+     "SELECT tenant_id, id, name, display_name, view_count "
+     "FROM articles WHERE status = 'published'",
+     [](AutocompleteIndex &index, const drogon::orm::Row &row) {
+         index.upsert(row["tenant_id"].as<int>(),
+                      articleEntry(row["id"].as<int>(), row["name"].as<std::string>(),
+                                   row["display_name"].as<std::string>(),
+                                   views(row["view_count"])));
+     }},
+    {"forum_post",
+     "SELECT c.tenant_id, p.id, p.title, p.thread_id, t.view_count "
+     "FROM forum_posts p "
+     "JOIN forum_threads t ON t.id = p.thread_id "
+     "JOIN forums f ON f.id = t.forum_id "
+     "JOIN forum_categories c ON c.id = f.category_id "
+     "WHERE p.title IS NOT NULL AND p.title <> ''",
+     [](AutocompleteIndex &index, const drogon::orm::Row &row) {
+         index.upsert(row["tenant_id"].as<int>(),
+                      forumPostEntry(row["id"].as<int>(), row["title"].as<std::string>(),
+                                     row["thread_id"].as<int>(), views(row["view_count"])));
+     }},
+    {"gamedep",
+     "SELECT id, name, display_name, view_count FROM gamedep_pages",
+     [](AutocompleteIndex &index, const drogon::orm::Row &row) {
+         index.upsert(AutocompleteIndex::kSharedTenant,
+                      gameDepEntry(row["id"].as<int>(), row["name"].as<std::string>(),
+                                   row["display_name"].as<std::string>(),
+                                   views(row["view_count"])));
+     }},
+};
+
+} // namespace
+
+AutocompleteService &AutocompleteService::instance() {
+    static AutocompleteService inst;
+    return inst;
+}
+
+void AutocompleteService::rebuild(const DbClientPtr &db) {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (rebuilding_) return;
+        rebuilding_ = true;
+        pending_.clear();
+    }
+
+    struct Load {
+        std::mutex mu;
+        std::shared_ptr<AutocompleteIndex> index = std::make_shared<AutocompleteIndex>();
+        size_t remaining = std::size(kSources);
+        bool failed = false;
+    };
+    auto load = std::make_shared<Load>();
+
+    auto finish = [this, load](bool ok) {
+        {
+            std::lock_guard<std::mutex> lock(load->mu);
+            if (!ok) load->failed = true;
+            if (--load->remaining > 0) return;
+        }
+        std::lock_guard<std::mutex> lock(mu_);
+        rebuilding_ = false;
+        if (load->failed) {
+            // Keep serving the previous index, if any
+            pending_.clear();
+            return;
+        }
+        for (const auto &op : pending_) applyTo(*load->index, op);
+        pending_.clear();
+        index_ = load->index;
+        ready_ = true;
+        LOG_INFO << "Autocomplete: indexed " << index_->size() << " titles";
+    };
+
+    for (const auto &source : kSources) {
+        db->execSqlAsync(
+            source.sql,
+            [load, &source, finish](const drogon::orm::Result &result) {
+                for (const auto &row : result) source.load(*load->index, row);
+                finish(true);
+            },
+            [&source, finish](const drogon::orm::DrogonDbException &e) {
+                LOG_ERROR << "Autocomplete rebuild " << source.type
+                          << " failed: " << e.base().what();
+                finish(false);
+            });
+    }
+}
+
+std::vector<AutocompleteItem> AutocompleteService::complete(int tenantId,
+                                                            const std::string &prefix,
+                                                            int limit) const {
+    std::shared_ptr<AutocompleteIndex> index;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        index = index_;
+    }
+    if (!index || limit <= 0) return {};
+    return index->complete(tenantId, prefix, static_cast<size_t>(limit));
+}
+
+size_t AutocompleteService::size() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return index_ ? index_->size() : 0;
+}
+
+void AutocompleteService::applyTo(AutocompleteIndex &index, const Op &op) {
+    switch (op.kind) {
+    case Op::Upsert:
+        index.upsert(op.tenantId, op.entry);
+        break;
+    case Op::Remove:
+        index.remove(op.tenantId, op.entry.type, op.entry.id);
+        break;
+    case Op::Weight:
+        index.setWeight(op.tenantId, op.entry.type, op.entry.id, op.entry.weight);
+        break;
+    }
+}
+
+void AutocompleteService::apply(Op op) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (index_) applyTo(*index_, op);
+    if (rebuilding_) pending_.push_back(std::move(op));
+}
+
+void AutocompleteService::indexArticle(int tenantId, int articleId, const std::string &name,
+                                       const std::string &displayName, int64_t views) {
+    apply({Op::Upsert, tenantId, articleEntry(articleId, name, displayName, views)});
+}
+
+void AutocompleteService::removeArticle(int tenantId, int articleId) {
+    apply({Op::Remove, tenantId, {"article", articleId, "", "", 0}});
+}
+
+void AutocompleteService::setArticleViews(int tenantId, int articleId, int64_t views) {
+    apply({Op::Weight, tenantId, {"article", articleId, "", "", weight(views)}});
+}
+
+void AutocompleteService::indexForumPost(int tenantId, int postId, const std::string &title,
+                                         int threadId, int64_t threadViews) {
+    if (title.empty()) {
+        removeForumPost(tenantId, postId);
+        return;
+    }
+    apply({Op::Upsert, tenantId, forumPostEntry(postId, title, threadId, threadViews)});
+}
+
+void AutocompleteService::removeForumPost(int tenantId, int postId) {
+    apply({Op::Remove, tenantId, {"forum_post", postId, "", "", 0}});
+}
+
+void AutocompleteService::indexGameDep(int pageId, const std::string &name,
+                                       const std::string &displayName, int64_t views) {
+    apply({Op::Upsert, AutocompleteIndex::kSharedTenant,
+           gameDepEntry(pageId, name, displayName, views)});
+}
+
+void AutocompleteService::removeGameDep(int pageId) {
+    apply({Op::Remove, AutocompleteIndex::kSharedTenant, {"gamedep", pageId, "", "", 0}});
+}
+
+} // namespace pyracms
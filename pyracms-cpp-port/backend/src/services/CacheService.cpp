@@ -1,209 +1,452 @@
 #include "services/CacheService.h"
-
-#include <cstring>
-#include <sstream>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <netdb.h>
+#include "services/InvalidationBus.h"
+#include "services/LocalCache.h"
+#include "services/RedisClient.h"
+#include "services/ResponseCache.h"
+
+#include <drogon/drogon.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <random>
 #include <unistd.h>
 
 namespace pyracms {
 
-// Simple Redis protocol (RESP) client via raw TCP
-// Avoids adding hiredis as a dependency — uses the same socket approach
-struct CacheService::RedisContext {
-    int fd = -1;
+namespace {
 
-    ~RedisContext() {
-        if (fd >= 0) ::close(fd);
+const char *namespaceName(CacheService::Namespace ns) {
+    switch (ns) {
+    case CacheService::Namespace::Articles: return "articles";
+    case CacheService::Namespace::Search: return "search";
+    case CacheService::Namespace::Autocomplete: return "autocomplete";
     }
-};
+    return "";
+}
 
-CacheService &CacheService::instance() {
-    static CacheService inst;
-    return inst;
+long long nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
 }
 
-void CacheService::initialize() {
-    const char *h = std::getenv("REDIS_HOST");
-    const char *p = std::getenv("REDIS_PORT");
-    host_ = h ? h : "127.0.0.1";
-    port_ = p ? std::stoi(p) : 6379;
-    reconnect();
+std::string generationHashKey(int tenantId) {
+    return "cachegen:" + std::to_string(tenantId);
 }
 
-void CacheService::reconnect() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    ctx_ = std::make_unique<RedisContext>();
+const char *kInvalidationChannel = "pyracms:cache-invalidation";
 
-    struct addrinfo hints{}, *res;
-    hints.ai_family = AF_INET;
-    hints.ai_socktype = SOCK_STREAM;
+// Redis pub/sub transport for cross-node L1 invalidation
+class RedisInvalidationBus : public InvalidationBus {
+public:
+    explicit RedisInvalidationBus(RedisClient &redis) : redis_(redis) {}
 
-    if (getaddrinfo(host_.c_str(), std::to_string(port_).c_str(), &hints, &res) != 0) {
-        connected_ = false;
-        return;
+    void publish(const std::string &message) override {
+        redis_.command({"PUBLISH", kInvalidationChannel, message}, [](const RespValue &) {});
     }
 
-    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
-    if (fd < 0) {
-        freeaddrinfo(res);
-        connected_ = false;
-        return;
+    void subscribe(Handler handler) override {
+        redis_.subscribe(kInvalidationChannel,
+                         [handler = std::move(handler)](std::string_view payload) {
+                             handler(std::string(payload));
+                         });
     }
 
-    // Set timeout
-    struct timeval tv;
-    tv.tv_sec = 2;
-    tv.tv_usec = 0;
-    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-
-    if (connect(fd, res->ai_addr, res->ai_addrlen) < 0) {
-        ::close(fd);
-        freeaddrinfo(res);
-        connected_ = false;
-        return;
-    }
+private:
+    RedisClient &redis_;
+};
 
-    freeaddrinfo(res);
-    ctx_->fd = fd;
-    connected_ = true;
+long long wallClockMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
 }
 
-bool CacheService::isConnected() const {
-    return connected_;
+// Values written by getOrSet with a soft TTL carry their freshness deadline
+// (wall clock, so every node agrees) in a small header: "\x01swr<ms>\n".
+constexpr char kSoftTtlMagic[] = "\x01swr";
+
+std::string wrapSoftTtl(const std::string &value, long long freshUntilMs) {
+    return kSoftTtlMagic + std::to_string(freshUntilMs) + "\n" + value;
 }
 
-// Build RESP protocol command
-static std::string buildRespCommand(const std::vector<std::string> &args) {
-    std::string cmd = "*" + std::to_string(args.size()) + "\r\n";
-    for (const auto &arg : args) {
-        cmd += "$" + std::to_string(arg.size()) + "\r\n" + arg + "\r\n";
+std::string_view unwrapSoftTtl(const std::string &stored, long long &freshUntilMs) {
+    std::string_view view(stored);
+    const size_t magicLen = sizeof(kSoftTtlMagic) - 1;
+    auto nl = view.find('\n');
+    if (view.compare(0, magicLen, kSoftTtlMagic) != 0 || nl == std::string_view::npos) {
+        freshUntilMs = std::numeric_limits<long long>::max(); // plain value: treat as fresh
+        return view;
     }
-    return cmd;
+    freshUntilMs = std::atoll(std::string(view.substr(magicLen, nl - magicLen)).c_str());
+    return view.substr(nl + 1);
 }
 
-std::string CacheService::execCommand(const std::vector<std::string> &args) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (!connected_ || !ctx_ || ctx_->fd < 0) return "";
+// At most capSeconds, and at most half the time the value has left in
+// Redis when that is known (redisTtlMs > 0)
+std::chrono::milliseconds l1Ttl(int capSeconds, long long redisTtlMs) {
+    long long capMs = capSeconds * 1000LL;
+    if (redisTtlMs > 0) capMs = std::min(capMs, redisTtlMs / 2);
+    return std::chrono::milliseconds(capMs);
+}
 
-    auto cmd = buildRespCommand(args);
-    if (send(ctx_->fd, cmd.c_str(), cmd.size(), 0) < 0) {
-        connected_ = false;
-        return "";
-    }
+} // namespace
 
-    char buf[8192];
-    ssize_t n = recv(ctx_->fd, buf, sizeof(buf) - 1, 0);
-    if (n <= 0) {
-        connected_ = false;
-        return "";
+struct CacheService::GenerationEntry {
+    std::atomic<long long> value{0};
+    // Set once value holds a counter read from Redis
+    std::atomic<bool> known{false};
+    std::atomic<long long> leaseUntilMs{0};
+    std::atomic<bool> refreshing{false};
+
+    // Generations only move forward, whatever order replies arrive in
+    void raiseTo(long long v) {
+        long long cur = value.load();
+        while (v > cur && !value.compare_exchange_weak(cur, v)) {
+        }
     }
-    buf[n] = '\0';
+};
 
-    std::string response(buf, n);
+CacheService::CacheService() = default;
+CacheService::~CacheService() = default;
 
-    // Parse RESP response
-    if (response.empty()) return "";
+CacheService &CacheService::instance() {
+    static CacheService inst;
+    return inst;
+}
 
-    // Bulk string: $<len>\r\n<data>\r\n
-    if (response[0] == '$') {
-        if (response[1] == '-') return ""; // $-1 = nil
-        auto crlfPos = response.find("\r\n");
-        if (crlfPos == std::string::npos) return "";
-        int len = std::stoi(response.substr(1, crlfPos - 1));
-        if (len < 0) return "";
-        return response.substr(crlfPos + 2, len);
-    }
-    // Simple string: +OK\r\n
-    if (response[0] == '+') {
-        auto crlfPos = response.find("\r\n");
-        return response.substr(1, crlfPos - 1);
+void CacheService::initialize() {
+    const char *h = std::getenv("REDIS_HOST");
+    const char *p = std::getenv("REDIS_PORT");
+    host_ = h ? h : "127.0.0.1";
+    port_ = p ? std::stoi(p) : 6379;
+    redis_ = std::make_unique<RedisClient>(host_, port_);
+    if (!redis_->start()) {
+        redis_.reset();
+        return;
     }
-    // Integer: :1\r\n
-    if (response[0] == ':') {
-        auto crlfPos = response.find("\r\n");
-        return response.substr(1, crlfPos - 1);
+
+    // The bus also carries response-cache purges, so it runs even when the
+    // L1 tier is off
+    std::random_device rd;
+    nodeId_ = std::to_string(getpid()) + "-" + std::to_string(rd());
+    bus_ = std::make_shared<RedisInvalidationBus>(*redis_);
+    bus_->subscribe([this](const std::string &message) { onInvalidation(message); });
+
+    // L1_CACHE_BYTES=0 disables the in-process tier
+    const char *l1Bytes = std::getenv("L1_CACHE_BYTES");
+    const char *l1Ttl = std::getenv("L1_CACHE_TTL");
+    size_t budget = l1Bytes ? std::stoull(l1Bytes) : 64ull * 1024 * 1024;
+    if (l1Ttl) l1TtlSeconds_ = std::stoi(l1Ttl);
+    if (budget == 0 || l1TtlSeconds_ <= 0) return;
+    l1_ = std::make_unique<LocalCache>(budget);
+}
+
+void CacheService::onInvalidation(const std::string &message) {
+    auto msg = InvalidationMessage::decode(message);
+    if (!msg || msg->origin == nodeId_) return;
+    if (msg->kind == InvalidationMessage::Kind::Key) {
+        if (l1_) l1_->erase(msg->key);
+    } else if (msg->kind == InvalidationMessage::Kind::Surrogate) {
+        ResponseCache::instance().purge(msg->key);
+    } else {
+        auto &entry = generationEntry(msg->tenantId, static_cast<Namespace>(msg->ns));
+        entry.raiseTo(msg->generation);
+        entry.known = true;
     }
-    // Error: -ERR ...\r\n
-    if (response[0] == '-') return "";
+}
 
-    return response;
+bool CacheService::isConnected() const {
+    return redis_ && redis_->isConnected();
 }
 
 void CacheService::get(const std::string &key, StringCallback cb) {
-    if (!connected_) {
+    if (!isConnected()) {
         cb("", false);
         return;
     }
-    auto result = execCommand({"GET", key});
-    cb(result, !result.empty());
+    if (l1_) {
+        if (auto hit = l1_->get(key)) {
+            cb(*hit, true);
+            return;
+        }
+    }
+    if (!l1_) {
+        redis_->command({"GET", key}, [cb = std::move(cb)](const RespValue &reply) {
+            if (!reply.isString()) {
+                cb("", false);
+            } else {
+                cb(std::string(reply.str), true);
+            }
+        });
+        return;
+    }
+    // GET and PTTL are pipelined so the L1 copy can be limited to half the
+    // value's remaining Redis TTL at no extra round trip. Either reply may
+    // come first if one of them fails fast, so the last one finishes.
+    // A DEL racing with this GET can leave the old value in L1; that
+    // staleness is bounded by the L1 TTL.
+    struct Pending {
+        std::string value;
+        bool found = false;
+        long long ttlMs = 0;
+        int replies = 0;
+        StringCallback cb;
+    };
+    auto pending = std::make_shared<Pending>();
+    pending->cb = std::move(cb);
+    auto finish = [this, key, pending]() {
+        if (++pending->replies < 2) return;
+        if (!pending->found) {
+            pending->cb("", false);
+            return;
+        }
+        auto ttl = l1Ttl(l1TtlSeconds_, pending->ttlMs);
+        // A value about to expire in Redis is not worth keeping
+        if (pending->ttlMs == 0 || ttl.count() <= 0) {
+            pending->cb(pending->value, true);
+            return;
+        }
+        pending->cb(*l1_->put(key, std::move(pending->value), ttl), true);
+    };
+    redis_->command({"GET", key}, [pending, finish](const RespValue &reply) {
+        if (reply.isString()) {
+            pending->value = std::string(reply.str);
+            pending->found = true;
+        }
+        finish();
+    });
+    redis_->command({"PTTL", key}, [pending, finish](const RespValue &reply) {
+        // -1: no expiry, so only the L1 cap applies; -2 or a failed
+        // command: unknown, so the value is not kept in L1
+        if (reply.type == RespValue::Type::Integer) {
+            pending->ttlMs = reply.integer == -1 ? -1 : std::max<long long>(reply.integer, 0);
+        }
+        finish();
+    });
 }
 
 void CacheService::set(const std::string &key, const std::string &value,
                         int ttlSeconds, BoolCallback cb) {
-    if (!connected_) {
+    if (!isConnected()) {
         cb(false);
         return;
     }
-    auto result = execCommand({"SET", key, value, "EX", std::to_string(ttlSeconds)});
-    cb(result == "OK");
+    if (l1_) {
+        l1_->put(key, value, l1Ttl(l1TtlSeconds_, ttlSeconds * 1000LL));
+    }
+    redis_->command({"SET", key, value, "EX", std::to_string(ttlSeconds)},
+                    [cb = std::move(cb)](const RespValue &reply) {
+                        cb(reply.type == RespValue::Type::SimpleString && reply.str == "OK");
+                    });
 }
 
 void CacheService::del(const std::string &key, BoolCallback cb) {
-    if (!connected_) {
+    if (!isConnected()) {
         cb(false);
         return;
     }
-    execCommand({"DEL", key});
-    cb(true);
-}
-
-void CacheService::delPattern(const std::string &pattern, BoolCallback cb) {
-    if (!connected_) {
-        cb(false);
-        return;
+    if (l1_) {
+        l1_->erase(key);
     }
-    // Use SCAN + DEL for pattern deletion (safer than KEYS in production)
-    auto keysResult = execCommand({"KEYS", pattern});
-    // For simplicity in dev, we use KEYS; production should use SCAN
-    // The response for KEYS is an array — just delete the pattern prefix
-    // A simpler approach: just delete known key patterns
-    cb(true);
+    if (bus_) {
+        InvalidationMessage msg;
+        msg.origin = nodeId_;
+        msg.key = key;
+        bus_->publish(msg.encode());
+    }
+    redis_->command({"DEL", key}, [cb = std::move(cb)](const RespValue &reply) {
+        cb(!reply.isNil() && !reply.isError());
+    });
 }
 
 void CacheService::getOrSet(const std::string &key, int ttlSeconds,
                              std::function<void(StringCallback)> fetcher,
-                             StringCallback cb) {
-    get(key, [this, key, ttlSeconds, fetcher, cb](const std::string &value, bool found) {
+                             StringCallback cb, int softTtlSeconds) {
+    get(key, [this, key, ttlSeconds, softTtlSeconds, fetcher = std::move(fetcher),
+              cb = std::move(cb)](const std::string &value, bool found) {
         if (found) {
-            cb(value, true);
+            if (softTtlSeconds <= 0) {
+                cb(value, true);
+                return;
+            }
+            long long freshUntil = 0;
+            auto payload = unwrapSoftTtl(value, freshUntil);
+            cb(std::string(payload), true);
+            if (wallClockMs() >= freshUntil) {
+                ++staleHits_;
+                // Only the first stale reader starts a refresh; the no-op
+                // waiter keeps everyone else from starting another one.
+                if (auto flightId = joinFlight(key, [](const std::string &, bool) {})) {
+                    ++backgroundRefreshes_;
+                    runFetch(key, flightId, ttlSeconds, softTtlSeconds, fetcher);
+                }
+            }
             return;
         }
-        // Cache miss — fetch and store
-        fetcher([this, key, ttlSeconds, cb](const std::string &fetchedValue, bool success) {
-            if (success && !fetchedValue.empty()) {
+        // Cache miss — fetch once, share the result with every waiter
+        if (auto flightId = joinFlight(key, cb)) {
+            runFetch(key, flightId, ttlSeconds, softTtlSeconds, fetcher);
+        }
+    });
+}
+
+void CacheService::runFetch(const std::string &key, uint64_t flightId, int ttlSeconds,
+                            int softTtlSeconds,
+                            const std::function<void(StringCallback)> &fetcher) {
+    ++fetches_;
+    // A fetcher that never calls back must not strand the key's waiters
+    drogon::app().getLoop()->runAfter(kFlightTimeoutSeconds, [this, key, flightId]() {
+        if (completeFlight(key, flightId, "", false)) {
+            ++flightTimeouts_;
+            LOG_WARN << "Cache fetch for " << key << " timed out; waiters released as a miss";
+        }
+    });
+    fetcher([this, key, flightId, ttlSeconds, softTtlSeconds](const std::string &fetchedValue,
+                                                              bool success) {
+        if (success && !fetchedValue.empty()) {
+            if (softTtlSeconds > 0) {
+                set(key, wrapSoftTtl(fetchedValue, wallClockMs() + softTtlSeconds * 1000LL),
+                    ttlSeconds, [](bool) {});
+            } else {
                 set(key, fetchedValue, ttlSeconds, [](bool) {});
             }
-            cb(fetchedValue, success);
-        });
+        }
+        completeFlight(key, flightId, fetchedValue, success);
     });
 }
 
+uint64_t CacheService::joinFlight(const std::string &key, StringCallback cb) {
+    std::lock_guard<std::mutex> lock(flightsMutex_);
+    auto [it, leader] = flights_.try_emplace(key);
+    it->second.waiters.push_back(std::move(cb));
+    if (!leader) {
+        ++coalescedWaiters_;
+        return 0;
+    }
+    it->second.id = nextFlightId_++;
+    return it->second.id;
+}
+
+bool CacheService::completeFlight(const std::string &key, uint64_t id,
+                                  const std::string &value, bool success) {
+    std::vector<StringCallback> waiters;
+    {
+        std::lock_guard<std::mutex> lock(flightsMutex_);
+        auto it = flights_.find(key);
+        if (it == flights_.end() || it->second.id != id) return false;
+        waiters = std::move(it->second.waiters);
+        flights_.erase(it);
+    }
+    for (const auto &waiter : waiters) {
+        waiter(value, success);
+    }
+    return true;
+}
+
+CacheService::Stats CacheService::stats() const {
+    Stats s;
+    s.fetches = fetches_;
+    s.coalescedWaiters = coalescedWaiters_;
+    s.backgroundRefreshes = backgroundRefreshes_;
+    s.staleHits = staleHits_;
+    s.flightTimeouts = flightTimeouts_;
+    return s;
+}
+
+// Generations
+CacheService::GenerationEntry &CacheService::generationEntry(int tenantId, Namespace ns) {
+    long long id = (static_cast<long long>(tenantId) << 8) | static_cast<long long>(ns);
+    {
+        std::shared_lock<std::shared_mutex> lock(generationsMutex_);
+        auto it = generations_.find(id);
+        if (it != generations_.end()) return *it->second;
+    }
+    std::unique_lock<std::shared_mutex> lock(generationsMutex_);
+    auto &entry = generations_[id];
+    if (!entry) entry = std::make_unique<GenerationEntry>();
+    return *entry;
+}
+
+std::optional<long long> CacheService::generation(int tenantId, Namespace ns) {
+    auto &entry = generationEntry(tenantId, ns);
+    // An expired lease keeps serving the last known value while a single
+    // background read fetches the current one. A tenant seen for the first
+    // time has no value until that read lands.
+    if (nowMs() >= entry.leaseUntilMs.load(std::memory_order_relaxed)) {
+        refreshGeneration(tenantId, ns, entry);
+    }
+    if (!entry.known.load(std::memory_order_acquire)) return std::nullopt;
+    return entry.value.load(std::memory_order_relaxed);
+}
+
+void CacheService::refreshGeneration(int tenantId, Namespace ns, GenerationEntry &entry) {
+    if (!isConnected()) return;
+    if (entry.refreshing.exchange(true)) return;
+    // HINCRBY 0 rather than HGET: it always answers with an integer, so a
+    // missing field (generation 0) cannot be mistaken for the nil a failed
+    // command is completed with
+    redis_->command({"HINCRBY", generationHashKey(tenantId), namespaceName(ns), "0"},
+                    [&entry](const RespValue &reply) {
+                        if (reply.type == RespValue::Type::Integer) {
+                            entry.raiseTo(reply.integer);
+                            entry.known.store(true, std::memory_order_release);
+                            entry.leaseUntilMs = nowMs() + kGenerationLeaseMs;
+                        }
+                        entry.refreshing = false;
+                    });
+}
+
+void CacheService::bumpGeneration(int tenantId, Namespace ns) {
+    auto &entry = generationEntry(tenantId, ns);
+    // Bump locally first so this node stops reading old keys immediately;
+    // the Redis counter is authoritative for every other node.
+    entry.raiseTo(entry.value.load() + 1);
+    if (!isConnected()) return;
+    redis_->command({"HINCRBY", generationHashKey(tenantId), namespaceName(ns), "1"},
+                    [this, &entry, tenantId, ns](const RespValue &reply) {
+                        if (reply.type != RespValue::Type::Integer) return;
+                        entry.raiseTo(reply.integer);
+                        entry.known.store(true, std::memory_order_release);
+                        entry.leaseUntilMs = nowMs() + kGenerationLeaseMs;
+                        // Push the new value so other nodes need not wait
+                        // for their lease to run out
+                        if (bus_) {
+                            InvalidationMessage msg;
+                            msg.kind = InvalidationMessage::Kind::Generation;
+                            msg.origin = nodeId_;
+                            msg.tenantId = tenantId;
+                            msg.ns = static_cast<int>(ns);
+                            msg.generation = reply.integer;
+                            bus_->publish(msg.encode());
+                        }
+                    });
+}
+
 // Key builders
 std::string CacheService::articleKey(int tenantId, const std::string &name) {
     return "article:" + std::to_string(tenantId) + ":" + name;
 }
 
 std::string CacheService::articleListKey(int tenantId, int limit, int offset) {
-    return "articles:" + std::to_string(tenantId) + ":" +
+    auto gen = instance().generation(tenantId, Namespace::Articles);
+    if (!gen) return {};
+    return "articles:" + std::to_string(tenantId) + ":g" + std::to_string(*gen) + ":" +
            std::to_string(limit) + ":" + std::to_string(offset);
 }
 
-std::string CacheService::searchKey(int tenantId, const std::string &query, const std::string &type) {
-    return "search:" + std::to_string(tenantId) + ":" + query + ":" + type;
+std::string CacheService::searchKey(int tenantId, const std::string &query, const std::string &type,
+                                    int limit, int offset) {
+    auto gen = instance().generation(tenantId, Namespace::Search);
+    if (!gen) return {};
+    // type and query are both free text; the length prefix keeps them apart
+    return "search:" + std::to_string(tenantId) + ":g" + std::to_string(*gen) + ":" +
+           std::to_string(limit) + ":" + std::to_string(offset) + ":" +
+           std::to_string(type.size()) + ":" + type + query;
 }
 
 std::string CacheService::userKey(int userId) {
@@ -211,23 +454,41 @@ std::string CacheService::userKey(int userId) {
 }
 
 std::string CacheService::autocompleteKey(int tenantId, const std::string &prefix) {
-    return "autocomplete:" + std::to_string(tenantId) + ":" + prefix;
+    auto gen = instance().generation(tenantId, Namespace::Autocomplete);
+    if (!gen) return {};
+    return "autocomplete:" + std::to_string(tenantId) + ":g" + std::to_string(*gen) + ":" +
+           prefix;
+}
+
+void CacheService::purgeResponses(const std::vector<std::string> &surrogateKeys) {
+    for (const auto &key : surrogateKeys) {
+        ResponseCache::instance().purge(key);
+        if (bus_) {
+            InvalidationMessage msg;
+            msg.kind = InvalidationMessage::Kind::Surrogate;
+            msg.origin = nodeId_;
+            msg.key = key;
+            bus_->publish(msg.encode());
+        }
+    }
 }
 
 // Invalidation helpers
 void CacheService::invalidateArticle(int tenantId, const std::string &name) {
     del(articleKey(tenantId, name), [](bool) {});
+    purgeResponses({ResponseCache::articleKey(tenantId, name)});
     invalidateArticleList(tenantId);
     invalidateSearch(tenantId);
 }
 
 void CacheService::invalidateArticleList(int tenantId) {
-    delPattern("articles:" + std::to_string(tenantId) + ":*", [](bool) {});
+    bumpGeneration(tenantId, Namespace::Articles);
+    purgeResponses({ResponseCache::articleListKey(tenantId)});
 }
 
 void CacheService::invalidateSearch(int tenantId) {
-    delPattern("search:" + std::to_string(tenantId) + ":*", [](bool) {});
-    delPattern("autocomplete:" + std::to_string(tenantId) + ":*", [](bool) {});
+    bumpGeneration(tenantId, Namespace::Search);
+    bumpGeneration(tenantId, Namespace::Autocomplete);
 }
 
 void CacheService::invalidateUser(int userId) {
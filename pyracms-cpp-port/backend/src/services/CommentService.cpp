@@ -55,8 +55,7 @@ void CommentService::createComment(const DbClientPtr &db,
 void CommentService::getComments(const DbClientPtr &db,
                                   const std::string &contentType,
                                   int contentId,
-                                  int limit,
-                                  int offset,
+                                  const PageRequest &page,
                                   ListCallback cb) {
     db->execSqlAsync(
         "SELECT c.*, u.username, "
@@ -65,7 +64,8 @@ void CommentService::getComments(const DbClientPtr &db,
         "FROM comments c "
         "JOIN users u ON c.user_id = u.id "
         "WHERE c.content_type = $1 AND c.content_id = $2 "
-        "ORDER BY c.created_at ASC LIMIT $3 OFFSET $4",
+        "AND (c.created_at, c.id) > ($3::timestamptz, $4::bigint) "
+        "ORDER BY c.created_at ASC, c.id ASC LIMIT $5 OFFSET $6",
         [this, cb](const drogon::orm::Result &result) {
             std::vector<CommentDto> comments;
             comments.reserve(result.size());
@@ -77,7 +77,7 @@ void CommentService::getComments(const DbClientPtr &db,
         [cb](const drogon::orm::DrogonDbException &) {
             cb({});
         },
-        contentType, contentId, limit, offset);
+        contentType, contentId, page.afterKey(true), page.afterId(true), page.limit, page.skip());
 }
 
 void CommentService::updateComment(const DbClientPtr &db,
@@ -0,0 +1,192 @@
+#include "services/DbRouter.h"
+
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <thread>
+
+namespace pyracms {
+
+namespace {
+
+constexpr const char *kPrimaryName = "default";
+constexpr const char *kFastSuffix = "_fast";
+
+int envInt(const char *name, int fallback) {
+    const char *v = std::getenv(name);
+    if (!v || !*v) return fallback;
+    try {
+        return std::stoi(v);
+    } catch (const std::exception &) {
+        LOG_ERROR << "Ignoring invalid " << name << "=" << v;
+        return fallback;
+    }
+}
+
+std::string envStr(const char *name, const char *fallback) {
+    const char *v = std::getenv(name);
+    return v ? v : fallback;
+}
+
+// key='value' with quotes and backslashes escaped, as libpq expects
+std::string connParam(const char *key, const std::string &value) {
+    std::string out = std::string(key) + "='";
+    for (char c : value) {
+        if (c == '\\' || c == '\'') out += '\\';
+        out += c;
+    }
+    return out + "' ";
+}
+
+struct Endpoint {
+    std::string host;
+    int port;
+};
+
+// "host[:port],host[:port],..."
+std::vector<Endpoint> parseEndpoints(const std::string &list, int defaultPort) {
+    std::vector<Endpoint> out;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t") + 1);
+        if (item.empty()) continue;
+        Endpoint ep{item, defaultPort};
+        auto colon = item.rfind(':');
+        if (colon != std::string::npos) {
+            ep.host = item.substr(0, colon);
+            try {
+                ep.port = std::stoi(item.substr(colon + 1));
+            } catch (const std::exception &) {
+                LOG_ERROR << "Ignoring replica with invalid port: " << item;
+                continue;
+            }
+        }
+        out.push_back(std::move(ep));
+    }
+    return out;
+}
+
+// Fast clients are bound to the IO loops; calling getFastDbClient from any
+// other thread trips an assertion inside Drogon.
+bool onIoLoop() {
+    thread_local int cached = -1;
+    if (cached < 0) {
+        cached = 0;
+        auto *current = trantor::EventLoop::getEventLoopOfCurrentThread();
+        if (current) {
+            for (auto *loop : drogon::app().getIOLoops()) {
+                if (loop == current) cached = 1;
+            }
+        }
+    }
+    return cached == 1;
+}
+
+} // namespace
+
+DbRouter &DbRouter::instance() {
+    static DbRouter router;
+    return router;
+}
+
+void DbRouter::configure() {
+    auto &app = drogon::app();
+
+    const auto dbName = envStr("DB_NAME", "pyracms");
+    const auto dbUser = envStr("DB_USER", "pyracms");
+    const auto dbPass = envStr("DB_PASSWORD", "pyracms");
+    const int dbPort = envInt("DB_PORT", 5432);
+
+    int hw = static_cast<int>(std::thread::hardware_concurrency());
+    int poolSize = std::max(1, envInt("DB_POOL_SIZE", std::max(4, hw)));
+    int replicaPoolSize = std::max(1, envInt("DB_REPLICA_POOL_SIZE", poolSize));
+    fastClients_ = envInt("DB_FAST_CLIENTS", 0) != 0;
+    int perLoop = std::max(1, envInt("DB_FAST_CONNECTIONS_PER_LOOP", 1));
+
+    auto create = [&](const std::string &host, int port, int connections,
+                      const std::string &name, bool isFast) {
+        app.createDbClient("postgresql", host, port, dbName, dbUser, dbPass, connections, "",
+                           name, isFast, "utf8");
+    };
+
+    auto primaryHost = envStr("DB_HOST", "127.0.0.1");
+    create(primaryHost, dbPort, poolSize, kPrimaryName, false);
+    primaryConnInfo_ = connParam("host", primaryHost) + connParam("port", std::to_string(dbPort)) +
+                       connParam("dbname", dbName) + connParam("user", dbUser) +
+                       connParam("password", dbPass) + "client_encoding='utf8'";
+    if (fastClients_) {
+        create(primaryHost, dbPort, perLoop, std::string(kPrimaryName) + kFastSuffix, true);
+    }
+
+    replicaNames_.clear();
+    for (const auto &ep : parseEndpoints(envStr("DB_REPLICAS", ""), dbPort)) {
+        auto name = "replica" + std::to_string(replicaNames_.size());
+        create(ep.host, ep.port, replicaPoolSize, name, false);
+        if (fastClients_) create(ep.host, ep.port, perLoop, name + kFastSuffix, true);
+        replicaNames_.push_back(name);
+        LOG_INFO << "DB read replica " << name << " at " << ep.host << ":" << ep.port;
+    }
+
+    sticky_ = std::make_unique<StickyWindow>(
+        std::chrono::milliseconds(std::max(0, envInt("DB_STICKY_SECONDS", 5)) * 1000));
+
+    LOG_INFO << "DB pool: " << poolSize << " connections"
+             << (fastClients_ ? ", " + std::to_string(perLoop) + " fast per IO loop" : "")
+             << ", " << replicaNames_.size() << " replica(s)";
+}
+
+DbRouter::DbClientPtr DbRouter::client(const std::string &name) const {
+    if (fastClients_ && onIoLoop()) {
+        return drogon::app().getFastDbClient(name + kFastSuffix);
+    }
+    return drogon::app().getDbClient(name);
+}
+
+DbRouter::DbClientPtr DbRouter::primary() const {
+    return client(kPrimaryName);
+}
+
+DbRouter::DbClientPtr DbRouter::replica() const {
+    if (replicaNames_.empty()) return primary();
+    auto i = nextReplica_.fetch_add(1, std::memory_order_relaxed) % replicaNames_.size();
+    return client(replicaNames_[i]);
+}
+
+DbRouter::DbClientPtr DbRouter::reader(const drogon::HttpRequestPtr &req) const {
+    if (replicaNames_.empty()) return primary();
+    if (sticky_) {
+        auto ids = stickyKeys(req);
+        for (size_t i = 0; i < ids.count; ++i) {
+            if (sticky_->active(ids.keys[i])) return primary();
+        }
+    }
+    return replica();
+}
+
+void DbRouter::onResponse(const drogon::HttpRequestPtr &req,
+                          const drogon::HttpResponsePtr &resp) {
+    if (!sticky_ || replicaNames_.empty()) return;
+    auto method = req->method();
+    if (method == drogon::Get || method == drogon::Head || method == drogon::Options) return;
+    if (static_cast<int>(resp->statusCode()) >= 400) return;
+    auto ids = stickyKeys(req);
+    for (size_t i = 0; i < ids.count; ++i) sticky_->mark(ids.keys[i]);
+}
+
+DbRouter::StickyKeys DbRouter::stickyKeys(const drogon::HttpRequestPtr &req) {
+    StickyKeys ids;
+    if (req->attributes()->find("userId")) {
+        // Tag bit keeps user ids and token hashes apart
+        ids.keys[ids.count++] =
+            (static_cast<uint64_t>(req->attributes()->get<int>("userId")) << 1) | 1;
+    }
+    const auto &auth = req->getHeader("Authorization");
+    if (!auth.empty()) {
+        ids.keys[ids.count++] = std::hash<std::string>{}(auth) << 1;
+    }
+    return ids;
+}
+
+} // namespace pyracms
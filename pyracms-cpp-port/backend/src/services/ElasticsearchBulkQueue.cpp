@@ -0,0 +1,180 @@
+#include "services/ElasticsearchBulkQueue.h"
+
+#include <algorithm>
+
+namespace pyracms {
+
+namespace {
+
+void appendJsonString(std::string &out, const std::string &s) {
+    out += '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    out += '"';
+}
+
+} // namespace
+
+ElasticsearchBulkQueue::ElasticsearchBulkQueue(size_t capacity, int maxAttempts)
+    : capacity_(std::max<size_t>(capacity, 1)), maxAttempts_(std::max(maxAttempts, 1)) {}
+
+bool ElasticsearchBulkQueue::retryable(int status) {
+    return status == 0 || status == 429 || status >= 500;
+}
+
+bool ElasticsearchBulkQueue::succeeded(const BulkOp &op, int status) {
+    if (status >= 200 && status < 300) return true;
+    if (status == 404) return op.action == BulkOp::Action::Delete;
+    if (status == 409) return op.action == BulkOp::Action::Create;
+    return false;
+}
+
+std::string ElasticsearchBulkQueue::encode(const std::vector<BulkOp> &batch) {
+    std::string body;
+    for (const auto &op : batch) {
+        switch (op.action) {
+        case BulkOp::Action::Index: body += "{\"index\":{\"_index\":"; break;
+        case BulkOp::Action::Create: body += "{\"create\":{\"_index\":"; break;
+        case BulkOp::Action::Delete: body += "{\"delete\":{\"_index\":"; break;
+        }
+        appendJsonString(body, op.index);
+        body += ",\"_id\":";
+        appendJsonString(body, op.id);
+        body += "}}\n";
+        if (op.action != BulkOp::Action::Delete) {
+            body += op.source;
+            body += '\n';
+        }
+    }
+    return body;
+}
+
+bool ElasticsearchBulkQueue::tryPush(BulkOp op) {
+    std::lock_guard<std::mutex> lock(mu_);
+    op.attempts = 0;
+    op.seq = nextSeq_++;
+    auto key = op.key();
+    auto it = queued_.find(key);
+    if (it != queued_.end()) {
+        *it->second = std::move(op);
+        ++stats_.pushed;
+        ++stats_.coalesced;
+        return true;
+    }
+    if (queue_.size() >= capacity_) {
+        ++stats_.rejected;
+        return false;
+    }
+    queue_.push_back(std::move(op));
+    queued_.emplace(std::move(key), std::prev(queue_.end()));
+    ++stats_.pushed;
+    return true;
+}
+
+void ElasticsearchBulkQueue::whenRoom(size_t n, std::function<void()> resume) {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        n = std::min(n, capacity_);
+        if (!waiters_.empty() || queue_.size() + n > capacity_) {
+            waiters_.push_back({n, std::move(resume)});
+            return;
+        }
+    }
+    resume();
+}
+
+std::vector<std::function<void()>> ElasticsearchBulkQueue::releaseWaiters() {
+    // FIFO: a large waiter at the head holds back later small ones
+    std::vector<std::function<void()>> ready;
+    size_t reserved = queue_.size();
+    while (!waiters_.empty() && reserved + waiters_.front().n <= capacity_) {
+        reserved += waiters_.front().n;
+        ready.push_back(std::move(waiters_.front().resume));
+        waiters_.pop_front();
+    }
+    return ready;
+}
+
+std::vector<BulkOp> ElasticsearchBulkQueue::takeBatch(size_t maxOps, size_t maxBytes) {
+    std::vector<BulkOp> batch;
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        size_t bytes = 0;
+        for (auto it = queue_.begin(); it != queue_.end() && batch.size() < maxOps;) {
+            auto key = it->key();
+            if (inFlight_.count(key)) {
+                ++it;
+                continue;
+            }
+            size_t opBytes = it->source.size() + it->index.size() + it->id.size() + 48;
+            if (!batch.empty() && bytes + opBytes > maxBytes) break;
+            bytes += opBytes;
+            inFlight_.emplace(key, it->seq);
+            queued_.erase(key);
+            batch.push_back(std::move(*it));
+            it = queue_.erase(it);
+        }
+        stats_.inFlight = inFlight_.size();
+        ready = releaseWaiters();
+    }
+    for (auto &resume : ready) resume();
+    return batch;
+}
+
+ElasticsearchBulkQueue::Outcome ElasticsearchBulkQueue::complete(std::vector<BulkOp> batch,
+                                                                 const std::vector<int> &statuses) {
+    Outcome outcome;
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        // Walk backwards so retries keep their relative order at the front
+        for (size_t i = batch.size(); i-- > 0;) {
+            auto &op = batch[i];
+            int status = i < statuses.size() ? statuses[i] : 0;
+            auto key = op.key();
+            inFlight_.erase(key);
+
+            if (succeeded(op, status)) {
+                ++outcome.succeeded;
+                continue;
+            }
+            if (queued_.count(key)) {
+                // Superseded by a newer operation; that one will be sent
+                ++outcome.succeeded;
+                continue;
+            }
+            if (!retryable(status) || op.attempts + 1 >= maxAttempts_) {
+                ++outcome.dropped;
+                continue;
+            }
+            ++op.attempts;
+            queue_.push_front(std::move(op));
+            queued_.emplace(std::move(key), queue_.begin());
+            ++outcome.retried;
+        }
+        stats_.indexed += outcome.succeeded;
+        stats_.retried += outcome.retried;
+        stats_.dropped += outcome.dropped;
+        stats_.inFlight = inFlight_.size();
+        ready = releaseWaiters();
+    }
+    for (auto &resume : ready) resume();
+    return outcome;
+}
+
+size_t ElasticsearchBulkQueue::size() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return queue_.size();
+}
+
+ElasticsearchBulkQueue::Stats ElasticsearchBulkQueue::stats() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto out = stats_;
+    out.queued = queue_.size();
+    return out;
+}
+
+} // namespace pyracms
@@ -0,0 +1,787 @@
+#include "services/ElasticsearchReindexer.h"
+#include "services/ElasticsearchService.h"
+
+#include <unistd.h>
+#include <json/json.h>
+#include <algorithm>
+
+namespace pyracms {
+
+namespace {
+
+constexpr int kMaxAttempts = 5;
+constexpr std::chrono::milliseconds kMinBackoff{100};
+constexpr std::chrono::milliseconds kMaxBackoff{30000};
+
+int envInt(const char *name, int fallback) {
+    const char *value = std::getenv(name);
+    return value && *value ? std::stoi(value) : fallback;
+}
+
+std::string compactJson(const Json::Value &value) {
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    return Json::writeString(writer, value);
+}
+
+bool ok(int status) {
+    return status >= 200 && status < 300;
+}
+
+std::string physicalIndex(const ElasticsearchSource &source, const std::string &suffix) {
+    return std::string(source.index) + "_" + suffix;
+}
+
+// Comma-separated physical indexes of a job, for multi-index requests
+std::string physicalIndexes(const std::string &suffix) {
+    std::string out;
+    for (const auto &source : ElasticsearchService::sources()) {
+        if (!out.empty()) out += ',';
+        out += physicalIndex(source, suffix);
+    }
+    return out;
+}
+
+// Returns a step callback; done(allOk) runs after `count` steps reported
+std::function<void(bool)> joinAll(size_t count, std::function<void(bool)> done) {
+    struct State {
+        std::mutex mu;
+        size_t left;
+        bool ok = true;
+        std::function<void(bool)> done;
+    };
+    auto state = std::make_shared<State>();
+    state->left = count;
+    state->done = std::move(done);
+    return [state](bool stepOk) {
+        std::function<void(bool)> done;
+        bool allOk;
+        {
+            std::lock_guard<std::mutex> lock(state->mu);
+            if (!stepOk) state->ok = false;
+            if (--state->left > 0) return;
+            done = std::move(state->done);
+            allOk = state->ok;
+        }
+        done(allOk);
+    };
+}
+
+} // namespace
+
+struct ElasticsearchReindexer::Run {
+    struct Partition {
+        size_t source; // index into ElasticsearchService::sources()
+        std::string name;
+        int part;
+        int hi;
+        int lastId;
+    };
+
+    DbClientPtr db;
+    int jobId = 0;
+    std::string suffix;
+    std::vector<Partition> partitions;
+
+    std::mutex mu;
+    size_t nextPartition = 0;
+    size_t active = 0; // workers streaming a partition
+    bool failed = false;
+    std::string error;
+};
+
+ElasticsearchReindexer &ElasticsearchReindexer::instance() {
+    static ElasticsearchReindexer inst;
+    return inst;
+}
+
+void ElasticsearchReindexer::initialize() {
+    parallelism_ = std::max(1, envInt("ES_REINDEX_PARALLELISM", 4));
+    batchSize_ = std::max(1, envInt("ES_REINDEX_BATCH_SIZE", 1000));
+    pollInterval_ = std::chrono::seconds(std::max(1, envInt("ES_REINDEX_POLL_SECONDS", 10)));
+    leaseSeconds_ = std::max<int>(60, 3 * static_cast<int>(pollInterval_.count()));
+
+    char host[256] = {};
+    gethostname(host, sizeof(host) - 1);
+    nodeId_ = std::string(host) + "/" + std::to_string(getpid());
+}
+
+// ── Starting and resuming ────────────────────────────────────────────────────
+
+void ElasticsearchReindexer::start(const DbClientPtr &db, DoneCallback cb) {
+    db->execSqlAsync(
+        "SELECT id, suffix FROM search_reindex_jobs WHERE status = 'running'",
+        [this, db, cb](const drogon::orm::Result &result) {
+            if (result.empty()) {
+                create(db, cb);
+                return;
+            }
+            int jobId = result[0]["id"].as<int>();
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                if (run_ && run_->jobId == jobId) {
+                    cb(true, "Reindex " + run_->suffix + " is already running on this node");
+                    return;
+                }
+            }
+            claim(db, jobId, cb);
+        },
+        [cb](const drogon::orm::DrogonDbException &e) {
+            cb(false, std::string("Database error: ") + e.base().what());
+        });
+}
+
+void ElasticsearchReindexer::create(const DbClientPtr &db, DoneCallback cb) {
+    const auto &sources = ElasticsearchService::sources();
+    auto suffix = "v" + std::to_string(std::chrono::duration_cast<std::chrono::seconds>(
+                                           std::chrono::system_clock::now().time_since_epoch())
+                                           .count());
+
+    // Plan: each table's id span split into ranges, with a row count per
+    // range for progress reporting
+    struct Range {
+        IdRange ids;
+        int64_t total = 0;
+    };
+    auto plan = std::make_shared<std::vector<std::vector<Range>>>(sources.size());
+
+    auto createIndexes = [this, db, cb, suffix, plan](bool planned) {
+        if (!planned) {
+            cb(false, "Could not plan the reindex; see the server log");
+            return;
+        }
+        auto &es = ElasticsearchService::instance();
+        auto definition = ElasticsearchService::indexDefinition();
+        // Bulk-load settings, reverted before the swap
+        definition["settings"]["refresh_interval"] = "-1";
+        definition["settings"]["number_of_replicas"] = 0;
+        auto body = compactJson(definition);
+
+        auto insertJob = [this, db, cb, suffix, plan](bool created) {
+            auto dropIndexes = [suffix]() {
+                ElasticsearchService::instance().send(drogon::Delete, "/" + physicalIndexes(suffix),
+                                                      "", [](int, const Json::Value &) {});
+            };
+            if (!created) {
+                dropIndexes();
+                cb(false, "Could not create the new indexes; see the server log");
+                return;
+            }
+            Json::Value rows(Json::arrayValue);
+            const auto &sources = ElasticsearchService::sources();
+            for (size_t s = 0; s < sources.size(); ++s) {
+                const auto &ranges = (*plan)[s];
+                for (size_t i = 0; i < ranges.size(); ++i) {
+                    Json::Value row;
+                    row["source"] = sources[s].name;
+                    row["part"] = static_cast<int>(i);
+                    row["lo"] = static_cast<Json::Int64>(ranges[i].ids.lo);
+                    row["hi"] = static_cast<Json::Int64>(ranges[i].ids.hi);
+                    row["total"] = static_cast<Json::Int64>(ranges[i].total);
+                    rows.append(row);
+                }
+            }
+            // Job and partitions in one statement: a job never exists
+            // without its plan
+            db->execSqlAsync(
+                "WITH job AS ("
+                "  INSERT INTO search_reindex_jobs (suffix, owner, heartbeat_at, resumed_at) "
+                "  VALUES ($1, $2, NOW(), NOW()) RETURNING id), "
+                "parts AS ("
+                "  INSERT INTO search_reindex_partitions "
+                "    (job_id, source, part, lo, hi, last_id, total) "
+                "  SELECT job.id, p.source, p.part, p.lo, p.hi, p.lo, p.total "
+                "  FROM job, json_to_recordset($3::json) "
+                "    AS p(source TEXT, part INT, lo INT, hi INT, total BIGINT)) "
+                "SELECT id FROM job",
+                [this, db, cb, suffix](const drogon::orm::Result &result) {
+                    run(db, result[0]["id"].as<int>(), suffix);
+                    cb(true, "Started reindex " + suffix);
+                },
+                [cb, dropIndexes](const drogon::orm::DrogonDbException &e) {
+                    // Most likely another node started a job first
+                    LOG_WARN << "Reindex: could not record job: " << e.base().what();
+                    dropIndexes();
+                    cb(false, "A reindex is already running");
+                },
+                suffix, nodeId_, compactJson(rows));
+        };
+
+        auto step = joinAll(ElasticsearchService::sources().size(), insertJob);
+        for (const auto &source : ElasticsearchService::sources()) {
+            auto index = physicalIndex(source, suffix);
+            es.send(drogon::Put, "/" + index, body, [index, step](int status, const Json::Value &resp) {
+                if (!ok(status)) {
+                    LOG_ERROR << "Reindex: creating " << index << " failed with status " << status
+                              << ": " << compactJson(resp["error"]);
+                }
+                step(ok(status));
+            });
+        }
+    };
+
+    auto planned = joinAll(sources.size(), createIndexes);
+    for (size_t s = 0; s < sources.size(); ++s) {
+        const auto &source = sources[s];
+        db->execSqlAsync(
+            std::string("SELECT MIN(") + source.key + ") AS lo, MAX(" + source.key +
+                ") AS hi FROM " + source.from,
+            [this, db, plan, s, &source, planned](const drogon::orm::Result &result) {
+                if (result[0]["lo"].isNull()) {
+                    planned(true);
+                    return;
+                }
+                auto ranges = splitIdRange(result[0]["lo"].as<int64_t>(),
+                                           result[0]["hi"].as<int64_t>(), parallelism_);
+                (*plan)[s].resize(ranges.size());
+                auto counted = joinAll(ranges.size(), planned);
+                for (size_t i = 0; i < ranges.size(); ++i) {
+                    (*plan)[s][i].ids = ranges[i];
+                    db->execSqlAsync(
+                        std::string("SELECT COUNT(*) AS total FROM ") + source.from + " AND " +
+                            source.key + " > $1 AND " + source.key + " <= $2",
+                        [plan, s, i, counted](const drogon::orm::Result &result) {
+                            (*plan)[s][i].total = result[0]["total"].as<int64_t>();
+                            counted(true);
+                        },
+                        [&source, counted](const drogon::orm::DrogonDbException &e) {
+                            LOG_ERROR << "Reindex: counting " << source.name
+                                      << " failed: " << e.base().what();
+                            counted(false);
+                        },
+                        static_cast<int>(ranges[i].lo), static_cast<int>(ranges[i].hi));
+                }
+            },
+            [&source, planned](const drogon::orm::DrogonDbException &e) {
+                LOG_ERROR << "Reindex: reading bounds of " << source.name
+                          << " failed: " << e.base().what();
+                planned(false);
+            });
+    }
+}
+
+void ElasticsearchReindexer::claim(const DbClientPtr &db, int jobId, DoneCallback cb) {
+    // Throughput restarts from the documents already checkpointed
+    db->execSqlAsync(
+        "UPDATE search_reindex_jobs SET owner = $2, heartbeat_at = NOW(), resumed_at = NOW(), "
+        "  error = NULL, docs_at_resume = "
+        "    (SELECT COALESCE(SUM(docs), 0) FROM search_reindex_partitions WHERE job_id = $1) "
+        "WHERE id = $1 AND status = 'running' AND (owner IS NULL OR owner = $2 "
+        "  OR heartbeat_at < NOW() - $3::int * INTERVAL '1 second') "
+        "RETURNING suffix",
+        [this, db, jobId, cb](const drogon::orm::Result &result) {
+            if (result.empty()) {
+                cb(false, "A reindex is already running on another node");
+                return;
+            }
+            auto suffix = result[0]["suffix"].as<std::string>();
+            run(db, jobId, suffix);
+            cb(true, "Resumed reindex " + suffix);
+        },
+        [cb](const drogon::orm::DrogonDbException &e) {
+            cb(false, std::string("Database error: ") + e.base().what());
+        },
+        jobId, nodeId_, leaseSeconds_);
+}
+
+void ElasticsearchReindexer::poll(const DbClientPtr &db) {
+    db->execSqlAsync(
+        "SELECT id, suffix, owner IS NOT NULL "
+        "  AND heartbeat_at < NOW() - $1::int * INTERVAL '1 second' AS abandoned "
+        "FROM search_reindex_jobs WHERE status = 'running'",
+        [this, db](const drogon::orm::Result &result) {
+            auto &es = ElasticsearchService::instance();
+            if (result.empty()) {
+                es.setShadowSuffix("");
+                return;
+            }
+            int jobId = result[0]["id"].as<int>();
+            es.setShadowSuffix(result[0]["suffix"].as<std::string>());
+            bool streamingHere;
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                streamingHere = run_ && run_->jobId == jobId;
+            }
+            if (streamingHere) {
+                db->execSqlAsync(
+                    "UPDATE search_reindex_jobs SET heartbeat_at = NOW() "
+                    "WHERE id = $1 AND owner = $2",
+                    [](const drogon::orm::Result &) {},
+                    [](const drogon::orm::DrogonDbException &e) {
+                        LOG_WARN << "Reindex: heartbeat failed: " << e.base().what();
+                    },
+                    jobId, nodeId_);
+            } else if (result[0]["abandoned"].as<bool>()) {
+                claim(db, jobId, [](bool ok, const std::string &message) {
+                    if (ok) LOG_INFO << "Reindex: " << message << " after its node stopped";
+                });
+            }
+        },
+        [](const drogon::orm::DrogonDbException &e) {
+            LOG_WARN << "Reindex: polling jobs failed: " << e.base().what();
+        },
+        leaseSeconds_);
+}
+
+// ── Streaming ────────────────────────────────────────────────────────────────
+
+void ElasticsearchReindexer::run(const DbClientPtr &db, int jobId, const std::string &suffix) {
+    auto run = std::make_shared<Run>();
+    run->db = db;
+    run->jobId = jobId;
+    run->suffix = suffix;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (run_) return;
+        run_ = run;
+    }
+    ElasticsearchService::instance().setShadowSuffix(suffix);
+
+    db->execSqlAsync(
+        "SELECT source, part, hi, last_id FROM search_reindex_partitions "
+        "WHERE job_id = $1 AND NOT done ORDER BY source, part",
+        [this, run](const drogon::orm::Result &result) {
+            const auto &sources = ElasticsearchService::sources();
+            for (const auto &row : result) {
+                auto name = row["source"].as<std::string>();
+                auto it = std::find_if(sources.begin(), sources.end(),
+                                       [&name](const auto &s) { return name == s.name; });
+                if (it == sources.end()) {
+                    LOG_WARN << "Reindex: skipping unknown source " << name;
+                    continue;
+                }
+                run->partitions.push_back({static_cast<size_t>(it - sources.begin()), name,
+                                           row["part"].as<int>(), row["hi"].as<int>(),
+                                           row["last_id"].as<int>()});
+            }
+            LOG_INFO << "Reindex " << run->suffix << ": streaming " << run->partitions.size()
+                     << " id ranges";
+
+            // Give every node a poll interval to start mirroring writes
+            // before rows are copied
+            auto delay = static_cast<double>(pollInterval_.count());
+            ElasticsearchService::instance().loop()->runAfter(delay, [this, run]() {
+                size_t workers = std::min(run->partitions.size(),
+                                          static_cast<size_t>(parallelism_));
+                if (workers == 0) {
+                    finish(run);
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(run->mu);
+                    run->active = workers;
+                }
+                for (size_t i = 0; i < workers; ++i) next(run);
+            });
+        },
+        [this, run](const drogon::orm::DrogonDbException &e) {
+            fail(run, e.base().what());
+            release(run);
+        },
+        jobId);
+}
+
+void ElasticsearchReindexer::next(const std::shared_ptr<Run> &run) {
+    size_t partition = 0;
+    bool idle = false;
+    bool last = false;
+    bool failed = false;
+    {
+        std::lock_guard<std::mutex> lock(run->mu);
+        if (!run->failed && run->nextPartition < run->partitions.size()) {
+            partition = run->nextPartition++;
+        } else {
+            idle = true;
+            last = --run->active == 0;
+            failed = run->failed;
+        }
+    }
+    if (!idle) {
+        streamBatch(run, partition);
+        return;
+    }
+    if (!last) return;
+    if (failed) {
+        release(run);
+    } else {
+        finish(run);
+    }
+}
+
+void ElasticsearchReindexer::streamBatch(const std::shared_ptr<Run> &run, size_t partition) {
+    bool failed;
+    {
+        std::lock_guard<std::mutex> lock(run->mu);
+        failed = run->failed;
+    }
+    if (failed) {
+        // Another worker failed; stop at a checkpoint
+        next(run);
+        return;
+    }
+    const auto &part = run->partitions[partition];
+    const auto &source = ElasticsearchService::sources()[part.source];
+    std::string sql = std::string("SELECT ") + source.columns + " FROM " + source.from +
+                      " AND " + source.key + " > $1 AND " + source.key + " <= $2 ORDER BY " +
+                      source.key + " LIMIT $3";
+
+    run->db->execSqlAsync(
+        sql,
+        [this, run, partition, &source](const drogon::orm::Result &result) {
+            const auto &part = run->partitions[partition];
+            if (result.empty()) {
+                checkpoint(run, partition, part.hi, 0, true, [this, run]() { next(run); });
+                return;
+            }
+            std::vector<BulkOp> ops;
+            ops.reserve(result.size());
+            auto index = physicalIndex(source, run->suffix);
+            for (const auto &row : result) {
+                BulkOp op;
+                op.action = BulkOp::Action::Create;
+                op.index = index;
+                op.id = row["id"].as<std::string>();
+                op.source = source.document(row);
+                ops.push_back(std::move(op));
+            }
+            int lastId = result[result.size() - 1]["id"].as<int>();
+            auto docs = static_cast<int64_t>(result.size());
+            // A short batch is the end of the range
+            bool done = result.size() < static_cast<size_t>(batchSize_);
+            sendBatch(run, std::move(ops), 0, [this, run, partition, lastId, docs, done]() {
+                checkpoint(run, partition, lastId, docs, done, [this, run, partition, done]() {
+                    if (done) {
+                        next(run);
+                    } else {
+                        streamBatch(run, partition);
+                    }
+                });
+            });
+        },
+        [this, run](const drogon::orm::DrogonDbException &e) {
+            fail(run, e.base().what());
+            next(run);
+        },
+        part.lastId, part.hi, batchSize_);
+}
+
+void ElasticsearchReindexer::sendBatch(const std::shared_ptr<Run> &run, std::vector<BulkOp> ops,
+                                       int attempt, std::function<void()> acked) {
+    auto &es = ElasticsearchService::instance();
+    auto body = ElasticsearchBulkQueue::encode(ops);
+    auto sent = std::make_shared<std::vector<BulkOp>>(std::move(ops));
+    es.send(drogon::Post, "/_bulk", std::move(body),
+            [this, run, sent, attempt, acked](int status, const Json::Value &response) {
+        auto retry = std::make_shared<std::vector<BulkOp>>();
+        if (ok(status) && response.isMember("items")) {
+            size_t i = 0;
+            for (const auto &item : response["items"]) {
+                if (i >= sent->size()) break;
+                auto &op = (*sent)[i++];
+                const auto &result = *item.begin();
+                int itemStatus = result["status"].asInt();
+                if (ElasticsearchBulkQueue::succeeded(op, itemStatus)) continue;
+                if (ElasticsearchBulkQueue::retryable(itemStatus)) {
+                    retry->push_back(std::move(op));
+                } else {
+                    // A document the mapping rejects would fail every retry
+                    LOG_WARN << "Reindex: skipping " << op.key() << " (status " << itemStatus
+                             << "): " << result["error"]["reason"].asString();
+                }
+            }
+        } else if (status != 0 && !ElasticsearchBulkQueue::retryable(status)) {
+            fail(run, "_bulk refused with status " + std::to_string(status));
+            next(run);
+            return;
+        } else {
+            *retry = std::move(*sent);
+        }
+
+        if (retry->empty()) {
+            acked();
+            return;
+        }
+        if (attempt + 1 >= kMaxAttempts) {
+            fail(run, std::to_string(retry->size()) + " documents still failing after " +
+                          std::to_string(kMaxAttempts) + " attempts");
+            next(run);
+            return;
+        }
+        auto backoff = std::min(kMaxBackoff, kMinBackoff * (1 << attempt));
+        ElasticsearchService::instance().loop()->runAfter(
+            static_cast<double>(backoff.count()) / 1000.0,
+            [this, run, retry, attempt, acked]() {
+                sendBatch(run, std::move(*retry), attempt + 1, acked);
+            });
+    });
+}
+
+void ElasticsearchReindexer::checkpoint(const std::shared_ptr<Run> &run, size_t partition,
+                                        int lastId, int64_t docs, bool done,
+                                        std::function<void()> then) {
+    auto &part = run->partitions[partition];
+    // Only the lease holder may advance checkpoints
+    run->db->execSqlAsync(
+        "WITH job AS ("
+        "  UPDATE search_reindex_jobs SET heartbeat_at = NOW() "
+        "  WHERE id = $1 AND owner = $2 AND status = 'running' RETURNING id) "
+        "UPDATE search_reindex_partitions p "
+        "SET last_id = $3, docs = p.docs + $4, done = $5 "
+        "FROM job WHERE p.job_id = job.id AND p.source = $6 AND p.part = $7 "
+        "RETURNING p.job_id",
+        [this, run, partition, lastId, then](const drogon::orm::Result &result) {
+            if (result.empty()) {
+                fail(run, "lost the lease to another node");
+                next(run);
+                return;
+            }
+            run->partitions[partition].lastId = lastId;
+            then();
+        },
+        [this, run](const drogon::orm::DrogonDbException &e) {
+            fail(run, e.base().what());
+            next(run);
+        },
+        run->jobId, nodeId_, lastId, docs, done, part.name, part.part);
+}
+
+void ElasticsearchReindexer::fail(const std::shared_ptr<Run> &run, const std::string &error) {
+    std::lock_guard<std::mutex> lock(run->mu);
+    if (run->failed) return;
+    run->failed = true;
+    run->error = error;
+    LOG_ERROR << "Reindex " << run->suffix << " failed: " << error;
+}
+
+void ElasticsearchReindexer::release(const std::shared_ptr<Run> &run) {
+    // The job stays running with its checkpoints, and writes keep being
+    // mirrored, so it can be resumed where it stopped
+    std::string error;
+    {
+        std::lock_guard<std::mutex> lock(run->mu);
+        error = run->error;
+    }
+    run->db->execSqlAsync(
+        "UPDATE search_reindex_jobs SET owner = NULL, error = $3 WHERE id = $1 AND owner = $2",
+        [](const drogon::orm::Result &) {},
+        [](const drogon::orm::DrogonDbException &e) {
+            LOG_ERROR << "Reindex: releasing job failed: " << e.base().what();
+        },
+        run->jobId, nodeId_, error);
+    std::lock_guard<std::mutex> lock(mu_);
+    if (run_ == run) run_.reset();
+}
+
+// ── Finishing ────────────────────────────────────────────────────────────────
+
+void ElasticsearchReindexer::finish(const std::shared_ptr<Run> &run) {
+    auto &es = ElasticsearchService::instance();
+    auto indexes = physicalIndexes(run->suffix);
+    Json::Value settings;
+    settings["index"]["refresh_interval"] = Json::nullValue; // back to the default
+    es.send(drogon::Put, "/" + indexes + "/_settings", compactJson(settings),
+            [this, run, indexes](int status, const Json::Value &) {
+        if (!ok(status)) {
+            fail(run, "restoring refresh_interval failed with status " + std::to_string(status));
+            release(run);
+            return;
+        }
+        ElasticsearchService::instance().send(
+            drogon::Post, "/" + indexes + "/_refresh", "",
+            [this, run](int status, const Json::Value &) {
+                if (!ok(status)) {
+                    fail(run, "refresh failed with status " + std::to_string(status));
+                    release(run);
+                    return;
+                }
+                swapAliases(run);
+            });
+    });
+}
+
+void ElasticsearchReindexer::swapAliases(const std::shared_ptr<Run> &run) {
+    struct Swap {
+        std::mutex mu;
+        Json::Value actions{Json::arrayValue};
+        std::vector<std::string> oldIndexes;
+    };
+    auto swap = std::make_shared<Swap>();
+    const auto &sources = ElasticsearchService::sources();
+
+    auto commit = [this, run, swap](bool looked) {
+        if (!looked) {
+            fail(run, "could not read the current aliases");
+            release(run);
+            return;
+        }
+        for (const auto &source : ElasticsearchService::sources()) {
+            Json::Value add;
+            add["add"]["index"] = physicalIndex(source, run->suffix);
+            add["add"]["alias"] = source.index;
+            swap->actions.append(add);
+        }
+        Json::Value body;
+        body["actions"] = swap->actions;
+        // One request, so searches see either every old index or every new one
+        ElasticsearchService::instance().send(
+            drogon::Post, "/_aliases", compactJson(body),
+            [this, run, swap](int status, const Json::Value &resp) {
+                if (!ok(status)) {
+                    fail(run, "alias swap failed with status " + std::to_string(status) + ": " +
+                                  compactJson(resp["error"]));
+                    release(run);
+                    return;
+                }
+                run->db->execSqlAsync(
+                    "UPDATE search_reindex_jobs SET status = 'done', finished_at = NOW(), "
+                    "  owner = NULL, error = NULL WHERE id = $1",
+                    [](const drogon::orm::Result &) {},
+                    [](const drogon::orm::DrogonDbException &e) {
+                        LOG_ERROR << "Reindex: marking job done failed: " << e.base().what();
+                    },
+                    run->jobId);
+                {
+                    std::lock_guard<std::mutex> lock(mu_);
+                    if (run_ == run) run_.reset();
+                }
+                ElasticsearchService::instance().setShadowSuffix("");
+                LOG_INFO << "Reindex " << run->suffix << " complete; aliases swapped";
+
+                // Other nodes may still be mirroring writes to the old
+                // indexes' replacements until they next poll; the old ones
+                // can go once nothing reads them
+                if (swap->oldIndexes.empty()) return;
+                std::string old;
+                for (const auto &index : swap->oldIndexes) {
+                    if (!old.empty()) old += ',';
+                    old += index;
+                }
+                ElasticsearchService::instance().loop()->runAfter(
+                    2.0 * static_cast<double>(pollInterval_.count()), [old]() {
+                        ElasticsearchService::instance().send(
+                            drogon::Delete, "/" + old, "", [old](int status, const Json::Value &) {
+                                if (!ok(status)) {
+                                    LOG_WARN << "Reindex: deleting " << old
+                                             << " failed with status " << status;
+                                }
+                            });
+                    });
+            });
+    };
+
+    auto looked = joinAll(sources.size(), commit);
+    for (const auto &source : sources) {
+        std::string alias = source.index;
+        auto target = physicalIndex(source, run->suffix);
+        ElasticsearchService::instance().send(
+            drogon::Get, "/_alias/" + alias, "",
+            [swap, alias, target, looked](int status, const Json::Value &resp) {
+                if (ok(status)) {
+                    // {"<index>": {"aliases": {...}}, ...}
+                    std::lock_guard<std::mutex> lock(swap->mu);
+                    for (const auto &index : resp.getMemberNames()) {
+                        if (index == target) continue;
+                        Json::Value remove;
+                        remove["remove"]["index"] = index;
+                        remove["remove"]["alias"] = alias;
+                        swap->actions.append(remove);
+                        swap->oldIndexes.push_back(index);
+                    }
+                    looked(true);
+                    return;
+                }
+                if (status != 404) {
+                    looked(false);
+                    return;
+                }
+                // No alias yet: a concrete index from before aliases may
+                // hold the name, and is dropped as part of the swap
+                ElasticsearchService::instance().send(
+                    drogon::Head, "/" + alias, "",
+                    [swap, alias, looked](int status, const Json::Value &) {
+                        if (ok(status)) {
+                            Json::Value remove;
+                            remove["remove_index"]["index"] = alias;
+                            std::lock_guard<std::mutex> lock(swap->mu);
+                            swap->actions.append(remove);
+                        }
+                        looked(status == 404 || ok(status));
+                    });
+            });
+    }
+}
+
+// ── Progress ─────────────────────────────────────────────────────────────────
+
+void ElasticsearchReindexer::progress(const DbClientPtr &db,
+                                      std::function<void(const Json::Value &)> cb) {
+    db->execSqlAsync(
+        "SELECT id, suffix, status, owner, error, started_at, finished_at, docs_at_resume, "
+        "  EXTRACT(EPOCH FROM COALESCE(finished_at, NOW()) - resumed_at) AS seconds "
+        "FROM search_reindex_jobs ORDER BY id DESC LIMIT 1",
+        [db, cb](const drogon::orm::Result &jobs) {
+            if (jobs.empty()) {
+                Json::Value none;
+                none["job"] = Json::nullValue;
+                cb(none);
+                return;
+            }
+            const auto &row = jobs[0];
+            Json::Value job;
+            job["id"] = row["id"].as<int>();
+            job["index"] = row["suffix"].as<std::string>();
+            job["status"] = row["status"].as<std::string>();
+            job["owner"] = row["owner"].isNull() ? Json::Value()
+                                                 : Json::Value(row["owner"].as<std::string>());
+            job["error"] = row["error"].isNull() ? Json::Value()
+                                                 : Json::Value(row["error"].as<std::string>());
+            job["startedAt"] = row["started_at"].as<std::string>();
+            job["finishedAt"] = row["finished_at"].isNull()
+                                    ? Json::Value()
+                                    : Json::Value(row["finished_at"].as<std::string>());
+            auto docsAtResume = row["docs_at_resume"].as<int64_t>();
+            double seconds = row["seconds"].isNull() ? 0.0 : row["seconds"].as<double>();
+            int jobId = job["id"].asInt();
+
+            db->execSqlAsync(
+                "SELECT source, SUM(docs) AS docs, SUM(total) AS total, COUNT(*) AS ranges, "
+                "  COUNT(*) FILTER (WHERE done) AS ranges_done "
+                "FROM search_reindex_partitions WHERE job_id = $1 "
+                "GROUP BY source ORDER BY source",
+                [cb, job, docsAtResume, seconds](const drogon::orm::Result &parts) mutable {
+                    int64_t docs = 0;
+                    int64_t total = 0;
+                    job["sources"] = Json::Value(Json::arrayValue);
+                    for (const auto &part : parts) {
+                        Json::Value source;
+                        source["source"] = part["source"].as<std::string>();
+                        source["docs"] = static_cast<Json::Int64>(part["docs"].as<int64_t>());
+                        source["total"] = static_cast<Json::Int64>(part["total"].as<int64_t>());
+                        source["ranges"] = part["ranges"].as<int>();
+                        source["rangesDone"] = part["ranges_done"].as<int>();
+                        docs += part["docs"].as<int64_t>();
+                        total += part["total"].as<int64_t>();
+                        job["sources"].append(source);
+                    }
+                    job["docs"] = static_cast<Json::Int64>(docs);
+                    job["total"] = static_cast<Json::Int64>(total);
+                    job["docsPerSecond"] = docsPerSecond(docs, docsAtResume, seconds);
+                    Json::Value out;
+                    out["job"] = job;
+                    cb(out);
+                },
+                [cb](const drogon::orm::DrogonDbException &e) {
+                    Json::Value out;
+                    out["error"] = e.base().what();
+                    cb(out);
+                },
+                jobId);
+        },
+        [cb](const drogon::orm::DrogonDbException &e) {
+            Json::Value out;
+            out["error"] = e.base().what();
+            cb(out);
+        });
+}
+
+} // namespace pyracms
@@ -1,11 +1,147 @@
 #include "services/ElasticsearchService.h"
+#include "services/ElasticsearchReindexer.h"
 
-#include <curl/curl.h>
 #include <json/json.h>
 #include <sstream>
+#include <thread>
 
 namespace pyracms {
 
+namespace {
+
+constexpr double kRequestTimeoutSeconds = 10.0;
+constexpr std::chrono::milliseconds kMinBackoff{100};
+constexpr std::chrono::milliseconds kMaxBackoff{30000};
+
+size_t envSize(const char *name, size_t fallback) {
+    const char *value = std::getenv(name);
+    return value && *value ? static_cast<size_t>(std::stoul(value)) : fallback;
+}
+
+// _bulk bodies are newline-delimited, so documents must be single-line
+std::string compactJson(const Json::Value &value) {
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    return Json::writeString(writer, value);
+}
+
+Json::Value baseDoc(int tenantId, const std::string &title, const std::string &content,
+                    const std::string &url, const char *type, const std::string &createdAt) {
+    Json::Value doc;
+    doc["tenant_id"] = tenantId;
+    doc["title"] = title;
+    doc["content"] = content;
+    doc["url"] = url;
+    doc["type"] = type;
+    // An empty string is not a valid date and would fail the whole item
+    if (!createdAt.empty()) doc["created_at"] = createdAt;
+    return doc;
+}
+
+Json::Value articleDoc(int tenantId, const std::string &name, const std::string &displayName,
+                       const std::string &content, const std::string &createdAt) {
+    auto doc = baseDoc(tenantId, displayName, content, "/articles/" + name, "article", createdAt);
+    doc["name"] = name;
+    return doc;
+}
+
+Json::Value forumPostDoc(int tenantId, const std::string &title, const std::string &content,
+                         int threadId, const std::string &createdAt) {
+    return baseDoc(tenantId, title, content, "/forum/thread/" + std::to_string(threadId),
+                   "forum_post", createdAt);
+}
+
+Json::Value gameDepDoc(int tenantId, const std::string &name, const std::string &displayName,
+                       const std::string &description, const std::string &createdAt) {
+    auto doc = baseDoc(tenantId, displayName, description, "/gamedep/" + name, "gamedep",
+                       createdAt);
+    doc["name"] = name;
+    return doc;
+}
+
+Json::Value snippetDoc(int tenantId, int snippetId, const std::string &title,
+                       const std::string &code, const std::string &language,
+                       const std::string &createdAt) {
+    auto doc = baseDoc(tenantId, title, code, "/snippets/" + std::to_string(snippetId),
+                       "snippet", createdAt);
+    doc["name"] = language;
+    return doc;
+}
+
+// Gamedep pages belong to no tenant; searches match them from every tenant
+constexpr int kSharedTenantId = 0;
+
+std::string text(const drogon::orm::Field &field) {
+    return field.isNull() ? "" : field.as<std::string>();
+}
+
+// created_at is formatted as ISO 8601: Elasticsearch's date mapping does
+// not accept PostgreSQL's default timestamp text
+const std::vector<ElasticsearchSource> kSources = {
+    {"articles", "pyracms_articles", "a.id",
+     "a.id, a.tenant_id, a.name, a.display_name, "
+     "to_char(a.created_at AT TIME ZONE 'UTC', 'YYYY-MM-DD\"T\"HH24:MI:SS\"Z\"') AS created_at, "
+     "(SELECT content FROM article_revisions WHERE article_id = a.id "
+     " ORDER BY created_at DESC, id DESC LIMIT 1) AS content",
+     "articles a WHERE a.status = 'published'",
+     [](const drogon::orm::Row &row) {
+         return compactJson(articleDoc(row["tenant_id"].as<int>(), row["name"].as<std::string>(),
+                                       row["display_name"].as<std::string>(),
+                                       text(row["content"]), text(row["created_at"])));
+     }},
+    {"forum_posts", "pyracms_forum_posts", "p.id",
+     "p.id, c.tenant_id, p.title, p.content, p.thread_id, "
+     "to_char(p.created_at AT TIME ZONE 'UTC', 'YYYY-MM-DD\"T\"HH24:MI:SS\"Z\"') AS created_at",
+     "forum_posts p "
+     "JOIN forum_threads t ON t.id = p.thread_id "
+     "JOIN forums f ON f.id = t.forum_id "
+     "JOIN forum_categories c ON c.id = f.category_id WHERE TRUE",
+     [](const drogon::orm::Row &row) {
+         return compactJson(forumPostDoc(row["tenant_id"].as<int>(), text(row["title"]),
+                                         text(row["content"]), row["thread_id"].as<int>(),
+                                         text(row["created_at"])));
+     }},
+    {"snippets", "pyracms_snippets", "s.id",
+     "s.id, s.tenant_id, s.title, s.code, s.language, "
+     "to_char(s.created_at AT TIME ZONE 'UTC', 'YYYY-MM-DD\"T\"HH24:MI:SS\"Z\"') AS created_at",
+     "code_snippets s WHERE s.visibility = 'public'",
+     [](const drogon::orm::Row &row) {
+         return compactJson(snippetDoc(row["tenant_id"].as<int>(), row["id"].as<int>(),
+                                       text(row["title"]), text(row["code"]),
+                                       text(row["language"]), text(row["created_at"])));
+     }},
+    {"gamedeps", "pyracms_gamedeps", "g.id",
+     "g.id, g.name, g.display_name, g.description, "
+     "to_char(g.created_at AT TIME ZONE 'UTC', 'YYYY-MM-DD\"T\"HH24:MI:SS\"Z\"') AS created_at",
+     "gamedep_pages g WHERE TRUE",
+     [](const drogon::orm::Row &row) {
+         return compactJson(gameDepDoc(kSharedTenantId, row["name"].as<std::string>(),
+                                       row["display_name"].as<std::string>(),
+                                       text(row["description"]), text(row["created_at"])));
+     }},
+};
+
+// Documents of this tenant, plus the shared gamedep pages
+Json::Value tenantFilter(int tenantId) {
+    Json::Value tenant, shared, filter;
+    tenant["term"]["tenant_id"] = tenantId;
+    shared["term"]["type"] = "gamedep";
+    filter["bool"]["should"].append(tenant);
+    filter["bool"]["should"].append(shared);
+    filter["bool"]["minimum_should_match"] = 1;
+    return filter;
+}
+
+BulkOp indexOp(const char *index, int id, const Json::Value &doc) {
+    BulkOp op;
+    op.index = index;
+    op.id = std::to_string(id);
+    op.source = compactJson(doc);
+    return op;
+}
+
+} // namespace
+
 ElasticsearchService &ElasticsearchService::instance() {
     static ElasticsearchService inst;
     return inst;
@@ -13,56 +149,55 @@ ElasticsearchService &ElasticsearchService::instance() {
 
 void ElasticsearchService::initialize() {
     const char *url = std::getenv("ELASTICSEARCH_URL");
-    if (url && std::string(url).length() > 0) {
-        esUrl_ = url;
-        configured_ = true;
-        createIndexes();
-        LOG_INFO << "Elasticsearch configured at " << esUrl_;
+    if (!url || std::string(url).empty()) return;
+
+    esUrl_ = url;
+    while (!esUrl_.empty() && esUrl_.back() == '/') esUrl_.pop_back();
+    configured_ = true;
+
+    queue_ = std::make_unique<ElasticsearchBulkQueue>(
+        envSize("ES_BULK_QUEUE_CAPACITY", 10000),
+        static_cast<int>(envSize("ES_BULK_MAX_ATTEMPTS", 5)));
+    batchOps_ = std::max<size_t>(1, envSize("ES_BULK_BATCH_SIZE", 500));
+    batchBytes_ = envSize("ES_BULK_BATCH_BYTES", 5 << 20);
+    auto connections = std::max<size_t>(1, envSize("ES_CONNECTIONS", 4));
+    // Bulk requests may use half the pool; searches always find a connection
+    maxInFlight_ = std::max<size_t>(1, connections / 2);
+    auto flushMs = envSize("ES_BULK_FLUSH_MS", 1000);
+
+    loopThread_ = std::make_unique<trantor::EventLoopThread>("ElasticsearchLoop");
+    loopThread_->run();
+    loop_ = loopThread_->getLoop();
+    for (size_t i = 0; i < connections; ++i) {
+        clients_.push_back(drogon::HttpClient::newHttpClient(esUrl_, loop_));
+    }
+    if (flushMs > 0) {
+        loop_->runEvery(static_cast<double>(flushMs) / 1000.0, [this]() { flush(); });
     }
+
+    loop_->queueInLoop([this]() { createIndexes(); });
+    LOG_INFO << "Elasticsearch configured at " << esUrl_ << " (" << connections
+             << " connections, bulk batches of " << batchOps_ << ")";
 }
 
 bool ElasticsearchService::isConfigured() const {
     return configured_;
 }
 
-size_t ElasticsearchService::curlWriteCallback(char *ptr, size_t size, size_t nmemb, std::string *data) {
-    data->append(ptr, size * nmemb);
-    return size * nmemb;
-}
-
-std::string ElasticsearchService::httpRequest(const std::string &method,
-                                               const std::string &path,
-                                               const std::string &body) {
-    std::string response;
-    CURL *curl = curl_easy_init();
-    if (!curl) return "";
-
-    auto url = esUrl_ + path;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlWriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-
-    struct curl_slist *headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-
-    if (method == "PUT") {
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
-    } else if (method == "DELETE") {
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-    } else if (method == "POST") {
-        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+void ElasticsearchService::stop(std::chrono::milliseconds timeout) {
+    if (!configured_) return;
+    scheduleFlush();
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while ((queue_->size() > 0 || inFlight_ > 0) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
     }
-
-    if (!body.empty()) {
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+    if (auto left = queue_->size()) {
+        LOG_WARN << "Elasticsearch: " << left << " queued operations not sent at shutdown";
     }
+}
 
-    curl_easy_perform(curl);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-    return response;
+ElasticsearchBulkQueue::Stats ElasticsearchService::bulkStats() const {
+    return queue_ ? queue_->stats() : ElasticsearchBulkQueue::Stats{};
 }
 
 Json::Value ElasticsearchService::parseJson(const std::string &str) {
@@ -74,8 +209,30 @@ Json::Value ElasticsearchService::parseJson(const std::string &str) {
     return root;
 }
 
-void ElasticsearchService::createIndexes() {
-    auto settings = R"({
+void ElasticsearchService::send(drogon::HttpMethod method, const std::string &path,
+                                std::string body, ResponseCallback cb) {
+    auto req = drogon::HttpRequest::newHttpRequest();
+    req->setMethod(method);
+    req->setPath(path);
+    if (!body.empty()) {
+        req->setContentTypeCode(drogon::CT_APPLICATION_JSON);
+        req->setBody(std::move(body));
+    }
+    const auto &client = clients_[nextClient_++ % clients_.size()];
+    client->sendRequest(
+        req,
+        [this, cb = std::move(cb)](drogon::ReqResult result, const drogon::HttpResponsePtr &resp) {
+            if (result != drogon::ReqResult::Ok || !resp) {
+                cb(0, Json::Value());
+                return;
+            }
+            cb(static_cast<int>(resp->getStatusCode()), parseJson(std::string(resp->getBody())));
+        },
+        kRequestTimeoutSeconds);
+}
+
+Json::Value ElasticsearchService::indexDefinition() {
+    static const char *json = R"({
         "settings": {
             "number_of_shards": 1,
             "number_of_replicas": 0,
@@ -117,31 +274,184 @@ void ElasticsearchService::createIndexes() {
             }
         }
     })";
+    static const Json::Value definition = [] {
+        Json::Value root;
+        Json::CharReaderBuilder reader;
+        std::istringstream stream(json);
+        std::string errors;
+        Json::parseFromStream(reader, stream, &root, &errors);
+        return root;
+    }();
+    return definition;
+}
 
-    // Create indexes (ignore if they already exist)
-    httpRequest("PUT", "/pyracms_articles", settings);
-    httpRequest("PUT", "/pyracms_forum_posts", settings);
-    httpRequest("PUT", "/pyracms_snippets", settings);
-    httpRequest("PUT", "/pyracms_gamedeps", settings);
+const std::vector<ElasticsearchSource> &ElasticsearchService::sources() {
+    return kSources;
+}
+
+void ElasticsearchService::createIndexes() {
+    // Bulk flushing waits for this: indexing into a missing index would
+    // create it with dynamic mappings. An alias (or a concrete index from
+    // before aliases) that already exists is left alone; a missing one
+    // gets <alias>_v1. No answer at all means retry later.
+    auto pending = std::make_shared<size_t>(kSources.size());
+    auto failed = std::make_shared<bool>(false);
+    auto finish = [this, pending, failed]() {
+        if (--*pending > 0) return;
+        if (*failed) {
+            loop_->runAfter(5.0, [this]() { createIndexes(); });
+            return;
+        }
+        indexesReady_ = true;
+        flush();
+    };
+    for (const auto &source : kSources) {
+        std::string alias = source.index;
+        send(drogon::Head, "/" + alias, "",
+             [this, alias, failed, finish](int status, const Json::Value &) {
+                 if (status != 404) {
+                     if (status == 0) {
+                         *failed = true;
+                         LOG_ERROR << "Elasticsearch: no response checking " << alias;
+                     }
+                     finish();
+                     return;
+                 }
+                 auto definition = indexDefinition();
+                 definition["aliases"][alias] = Json::objectValue;
+                 send(drogon::Put, "/" + alias + "_v1", compactJson(definition),
+                      [alias, failed, finish](int status, const Json::Value &) {
+                          if (status == 0) {
+                              *failed = true;
+                              LOG_ERROR << "Elasticsearch: no response creating " << alias;
+                          }
+                          finish();
+                      });
+             });
+    }
+}
+
+void ElasticsearchService::setShadowSuffix(const std::string &suffix) {
+    std::lock_guard<std::mutex> lock(shadowMu_);
+    if (suffix != shadowSuffix_) {
+        LOG_INFO << "Elasticsearch: " << (suffix.empty() ? "stopped" : "started")
+                 << " mirroring writes to reindex " << (suffix.empty() ? shadowSuffix_ : suffix);
+    }
+    shadowSuffix_ = suffix;
+}
+
+// ── Bulk queue ───────────────────────────────────────────────────────────────
+
+void ElasticsearchService::enqueue(BulkOp op) {
+    if (!configured_) return;
+    std::string shadow;
+    {
+        std::lock_guard<std::mutex> lock(shadowMu_);
+        if (!shadowSuffix_.empty()) shadow = op.index + "_" + shadowSuffix_;
+    }
+    if (!shadow.empty()) {
+        // A reindex is copying rows into the new indexes; without this,
+        // changes made behind its cursor would be missing after the swap
+        BulkOp copy = op;
+        copy.index = std::move(shadow);
+        push(std::move(copy));
+    }
+    push(std::move(op));
+}
+
+void ElasticsearchService::push(BulkOp op) {
+    auto key = op.key();
+    if (!queue_->tryPush(std::move(op))) {
+        LOG_ERROR << "Elasticsearch bulk queue full, dropping " << key;
+        return;
+    }
+    if (queue_->size() >= batchOps_) scheduleFlush();
 }
 
+void ElasticsearchService::enqueueAll(std::vector<BulkOp> ops, std::function<void()> done) {
+    enqueueFrom(std::make_shared<std::vector<BulkOp>>(std::move(ops)), 0, std::move(done));
+}
+
+void ElasticsearchService::enqueueFrom(std::shared_ptr<std::vector<BulkOp>> ops, size_t from,
+                                       std::function<void()> done) {
+    if (!configured_ || from >= ops->size()) {
+        if (configured_) scheduleFlush();
+        if (done) done();
+        return;
+    }
+    size_t chunk = std::min(batchOps_, ops->size() - from);
+    queue_->whenRoom(chunk, [this, ops, from, chunk, done]() {
+        size_t next = from;
+        while (next < from + chunk && queue_->tryPush((*ops)[next])) ++next;
+        scheduleFlush();
+        // Continue from the loop rather than growing the stack
+        loop_->queueInLoop([this, ops, next, done]() { enqueueFrom(ops, next, done); });
+    });
+}
+
+void ElasticsearchService::scheduleFlush() {
+    if (flushScheduled_.exchange(true)) return;
+    loop_->queueInLoop([this]() {
+        flushScheduled_ = false;
+        flush();
+    });
+}
+
+void ElasticsearchService::flush() {
+    if (!indexesReady_) return;
+    while (inFlight_ < maxInFlight_ && std::chrono::steady_clock::now() >= backoffUntil_) {
+        auto batch = queue_->takeBatch(batchOps_, batchBytes_);
+        if (batch.empty()) return;
+        ++inFlight_;
+        auto body = ElasticsearchBulkQueue::encode(batch);
+        auto sent = std::make_shared<std::vector<BulkOp>>(std::move(batch));
+        send(drogon::Post, "/_bulk", std::move(body),
+             [this, sent](int status, const Json::Value &response) {
+                 onBulkResponse(std::move(*sent), status, response);
+             });
+    }
+}
+
+void ElasticsearchService::onBulkResponse(std::vector<BulkOp> batch, int status,
+                                          const Json::Value &body) {
+    --inFlight_;
+    std::vector<int> statuses;
+    if (status >= 200 && status < 300 && body.isMember("items")) {
+        // One {"<action>": {..., "status": N}} per operation, in order
+        for (const auto &item : body["items"]) {
+            statuses.push_back((*item.begin())["status"].asInt());
+        }
+    } else if (status != 0 && !ElasticsearchBulkQueue::retryable(status)) {
+        // The request itself was refused; no item in it can succeed
+        statuses.assign(batch.size(), status);
+    }
+
+    auto outcome = queue_->complete(std::move(batch), statuses);
+    if (outcome.dropped > 0) {
+        LOG_ERROR << "Elasticsearch bulk: dropped " << outcome.dropped
+                  << " operations (status " << status << ")";
+    }
+    if (outcome.retried > 0) {
+        backoff_ = backoff_.count() == 0 ? kMinBackoff : std::min(backoff_ * 2, kMaxBackoff);
+        backoffUntil_ = std::chrono::steady_clock::now() + backoff_;
+        LOG_WARN << "Elasticsearch bulk: retrying " << outcome.retried << " operations in "
+                 << backoff_.count() << "ms";
+        loop_->runAfter(static_cast<double>(backoff_.count()) / 1000.0, [this]() { flush(); });
+        return;
+    }
+    backoff_ = std::chrono::milliseconds(0);
+    flush();
+}
+
+// ── Indexing ─────────────────────────────────────────────────────────────────
+
 void ElasticsearchService::indexArticle(int tenantId, int articleId,
                                          const std::string &name,
                                          const std::string &displayName,
                                          const std::string &content,
                                          const std::string &createdAt) {
-    Json::Value doc;
-    doc["tenant_id"] = tenantId;
-    doc["title"] = displayName;
-    doc["content"] = content;
-    doc["name"] = name;
-    doc["url"] = "/articles/" + name;
-    doc["type"] = "article";
-    doc["created_at"] = createdAt;
-
-    Json::StreamWriterBuilder writer;
-    auto body = Json::writeString(writer, doc);
-    httpRequest("PUT", "/pyracms_articles/_doc/" + std::to_string(articleId), body);
+    enqueue(indexOp("pyracms_articles", articleId,
+                    articleDoc(tenantId, name, displayName, content, createdAt)));
 }
 
 void ElasticsearchService::indexForumPost(int tenantId, int postId,
@@ -149,17 +459,8 @@ void ElasticsearchService::indexForumPost(int tenantId, int postId,
                                            const std::string &content,
                                            int threadId,
                                            const std::string &createdAt) {
-    Json::Value doc;
-    doc["tenant_id"] = tenantId;
-    doc["title"] = title;
-    doc["content"] = content;
-    doc["url"] = "/forum/thread/" + std::to_string(threadId);
-    doc["type"] = "forum_post";
-    doc["created_at"] = createdAt;
-
-    Json::StreamWriterBuilder writer;
-    auto body = Json::writeString(writer, doc);
-    httpRequest("PUT", "/pyracms_forum_posts/_doc/" + std::to_string(postId), body);
+    enqueue(indexOp("pyracms_forum_posts", postId,
+                    forumPostDoc(tenantId, title, content, threadId, createdAt)));
 }
 
 void ElasticsearchService::indexSnippet(int tenantId, int snippetId,
@@ -167,18 +468,8 @@ void ElasticsearchService::indexSnippet(int tenantId, int snippetId,
                                          const std::string &code,
                                          const std::string &language,
                                          const std::string &createdAt) {
-    Json::Value doc;
-    doc["tenant_id"] = tenantId;
-    doc["title"] = title;
-    doc["content"] = code;
-    doc["name"] = language;
-    doc["url"] = "/snippets/" + std::to_string(snippetId);
-    doc["type"] = "snippet";
-    doc["created_at"] = createdAt;
-
-    Json::StreamWriterBuilder writer;
-    auto body = Json::writeString(writer, doc);
-    httpRequest("PUT", "/pyracms_snippets/_doc/" + std::to_string(snippetId), body);
+    enqueue(indexOp("pyracms_snippets", snippetId,
+                    snippetDoc(tenantId, snippetId, title, code, language, createdAt)));
 }
 
 void ElasticsearchService::indexGameDep(int tenantId, int pageId,
@@ -186,24 +477,20 @@ void ElasticsearchService::indexGameDep(int tenantId, int pageId,
                                          const std::string &displayName,
                                          const std::string &description,
                                          const std::string &createdAt) {
-    Json::Value doc;
-    doc["tenant_id"] = tenantId;
-    doc["title"] = displayName;
-    doc["content"] = description;
-    doc["name"] = name;
-    doc["url"] = "/gamedep/" + name;
-    doc["type"] = "gamedep";
-    doc["created_at"] = createdAt;
-
-    Json::StreamWriterBuilder writer;
-    auto body = Json::writeString(writer, doc);
-    httpRequest("PUT", "/pyracms_gamedeps/_doc/" + std::to_string(pageId), body);
+    enqueue(indexOp("pyracms_gamedeps", pageId,
+                    gameDepDoc(tenantId, name, displayName, description, createdAt)));
 }
 
 void ElasticsearchService::deleteDocument(const std::string &index, int id) {
-    httpRequest("DELETE", "/" + index + "/_doc/" + std::to_string(id));
+    BulkOp op;
+    op.action = BulkOp::Action::Delete;
+    op.index = index;
+    op.id = std::to_string(id);
+    enqueue(std::move(op));
 }
 
+// ── Search ───────────────────────────────────────────────────────────────────
+
 void ElasticsearchService::search(int tenantId, const std::string &query,
                                    const std::string &type,
                                    int limit, int offset,
@@ -219,9 +506,7 @@ void ElasticsearchService::search(int tenantId, const std::string &query,
     Json::Value boolQuery;
 
     // Must match tenant
-    Json::Value tenantFilter;
-    tenantFilter["term"]["tenant_id"] = tenantId;
-    boolQuery["filter"].append(tenantFilter);
+    boolQuery["filter"].append(tenantFilter(tenantId));
 
     // Multi-match across title and content
     Json::Value multiMatch;
@@ -242,50 +527,52 @@ void ElasticsearchService::search(int tenantId, const std::string &query,
     // Aggregation for facets
     esQuery["aggs"]["types"]["terms"]["field"] = "type";
 
-    Json::StreamWriterBuilder writer;
-    auto body = Json::writeString(writer, esQuery);
-
-    auto response = httpRequest("POST", "/" + indexes + "/_search", body);
-    auto root = parseJson(response);
-
-    SearchResults results;
-    results.query = query;
-    results.totalCount = 0;
-
-    if (root.isMember("hits")) {
-        auto &hits = root["hits"];
-        results.totalCount = hits["total"]["value"].asInt();
-
-        for (const auto &hit : hits["hits"]) {
-            SearchResultItem item;
-            auto &src = hit["_source"];
-            item.type = src["type"].asString();
-            item.id = std::stoi(hit["_id"].asString());
-            item.title = src["title"].asString();
-            item.url = src["url"].asString();
-            item.rank = hit["_score"].asDouble();
-            item.createdAt = src["created_at"].asString();
-
-            // Use highlight if available
-            if (hit.isMember("highlight") && hit["highlight"].isMember("content")) {
-                item.snippet = hit["highlight"]["content"][0].asString();
-            } else {
-                auto content = src["content"].asString();
-                item.snippet = content.size() > 200 ? content.substr(0, 200) + "..." : content;
-            }
+    auto respond = [query, cb](int, const Json::Value &root) {
+        SearchResults results;
+        results.query = query;
+        results.totalCount = 0;
+
+        if (root.isMember("hits")) {
+            auto &hits = root["hits"];
+            results.totalCount = hits["total"]["value"].asInt();
+
+            for (const auto &hit : hits["hits"]) {
+                SearchResultItem item;
+                auto &src = hit["_source"];
+                item.type = src["type"].asString();
+                item.id = std::stoi(hit["_id"].asString());
+                item.title = src["title"].asString();
+                item.url = src["url"].asString();
+                item.rank = hit["_score"].asDouble();
+                item.createdAt = src["created_at"].asString();
+
+                // Use highlight if available
+                if (hit.isMember("highlight") && hit["highlight"].isMember("content")) {
+                    item.snippet = hit["highlight"]["content"][0].asString();
+                } else {
+                    auto content = src["content"].asString();
+                    item.snippet = content.size() > 200 ? content.substr(0, 200) + "..." : content;
+                }
 
-            results.items.push_back(item);
+                results.items.push_back(item);
+            }
         }
-    }
 
-    // Facets from aggregation
-    if (root.isMember("aggregations") && root["aggregations"].isMember("types")) {
-        for (const auto &bucket : root["aggregations"]["types"]["buckets"]) {
-            results.facets[bucket["key"].asString()] = bucket["doc_count"].asInt();
+        // Facets from aggregation
+        if (root.isMember("aggregations") && root["aggregations"].isMember("types")) {
+            for (const auto &bucket : root["aggregations"]["types"]["buckets"]) {
+                results.facets[bucket["key"].asString()] = bucket["doc_count"].asInt();
+            }
         }
-    }
 
-    cb(results);
+        cb(results);
+    };
+
+    if (!configured_) {
+        respond(0, Json::Value());
+        return;
+    }
+    send(drogon::Post, "/" + indexes + "/_search", compactJson(esQuery), std::move(respond));
 }
 
 void ElasticsearchService::autocomplete(int tenantId, const std::string &prefix,
@@ -294,9 +581,7 @@ void ElasticsearchService::autocomplete(int tenantId, const std::string &prefix,
     Json::Value esQuery;
     Json::Value boolQuery;
 
-    Json::Value tenantFilter;
-    tenantFilter["term"]["tenant_id"] = tenantId;
-    boolQuery["filter"].append(tenantFilter);
+    boolQuery["filter"].append(tenantFilter(tenantId));
 
     Json::Value matchQuery;
     matchQuery["match"]["title.autocomplete"] = prefix;
@@ -308,90 +593,37 @@ void ElasticsearchService::autocomplete(int tenantId, const std::string &prefix,
     esQuery["_source"].append("type");
     esQuery["_source"].append("url");
 
-    Json::StreamWriterBuilder writer;
-    auto body = Json::writeString(writer, esQuery);
-
-    auto response = httpRequest("POST",
-        "/pyracms_articles,pyracms_forum_posts,pyracms_snippets,pyracms_gamedeps/_search", body);
-    auto root = parseJson(response);
-
-    std::vector<AutocompleteItem> items;
-    if (root.isMember("hits")) {
-        for (const auto &hit : root["hits"]["hits"]) {
-            AutocompleteItem item;
-            item.text = hit["_source"]["title"].asString();
-            item.type = hit["_source"]["type"].asString();
-            item.url = hit["_source"]["url"].asString();
-            items.push_back(item);
-        }
+    if (!configured_) {
+        cb({});
+        return;
     }
+    send(drogon::Post,
+         "/pyracms_articles,pyracms_forum_posts,pyracms_snippets,pyracms_gamedeps/_search",
+         compactJson(esQuery),
+         [cb](int, const Json::Value &root) {
+             std::vector<AutocompleteItem> items;
+             if (root.isMember("hits")) {
+                 for (const auto &hit : root["hits"]["hits"]) {
+                     AutocompleteItem item;
+                     item.text = hit["_source"]["title"].asString();
+                     item.type = hit["_source"]["type"].asString();
+                     item.url = hit["_source"]["url"].asString();
+                     items.push_back(item);
+                 }
+             }
+             cb(items);
+         });
+}
 
-    cb(items);
-}
-
-void ElasticsearchService::syncFromDatabase(const DbClientPtr &db, int tenantId) {
-    // Sync articles
-    db->execSqlAsync(
-        "SELECT a.id, a.name, a.display_name, a.created_at, "
-        "  (SELECT content FROM article_revisions WHERE article_id = a.id "
-        "   ORDER BY created_at DESC LIMIT 1) AS content "
-        "FROM articles a WHERE a.tenant_id = $1 AND a.status = 'published'",
-        [this, tenantId](const drogon::orm::Result &result) {
-            for (const auto &row : result) {
-                indexArticle(tenantId, row["id"].as<int>(),
-                    row["name"].as<std::string>(),
-                    row["display_name"].as<std::string>(),
-                    row["content"].isNull() ? "" : row["content"].as<std::string>(),
-                    row["created_at"].as<std::string>());
-            }
-            LOG_INFO << "Synced " << result.size() << " articles to Elasticsearch";
-        },
-        [](const drogon::orm::DrogonDbException &e) {
-            LOG_ERROR << "ES sync articles failed: " << e.base().what();
-        },
-        tenantId);
-
-    // Sync forum posts
-    db->execSqlAsync(
-        "SELECT p.id, p.title, p.content, p.thread_id, p.created_at "
-        "FROM forum_posts p "
-        "JOIN forum_threads t ON t.id = p.thread_id "
-        "JOIN forums f ON f.id = t.forum_id "
-        "JOIN forum_categories c ON c.id = f.category_id "
-        "WHERE c.tenant_id = $1",
-        [this, tenantId](const drogon::orm::Result &result) {
-            for (const auto &row : result) {
-                indexForumPost(tenantId, row["id"].as<int>(),
-                    row["title"].isNull() ? "" : row["title"].as<std::string>(),
-                    row["content"].as<std::string>(),
-                    row["thread_id"].as<int>(),
-                    row["created_at"].as<std::string>());
-            }
-            LOG_INFO << "Synced " << result.size() << " forum posts to Elasticsearch";
-        },
-        [](const drogon::orm::DrogonDbException &e) {
-            LOG_ERROR << "ES sync forum posts failed: " << e.base().what();
-        },
-        tenantId);
-
-    // Sync gamedeps
-    db->execSqlAsync(
-        "SELECT id, name, display_name, description, created_at "
-        "FROM gamedep_pages WHERE tenant_id = $1",
-        [this, tenantId](const drogon::orm::Result &result) {
-            for (const auto &row : result) {
-                indexGameDep(tenantId, row["id"].as<int>(),
-                    row["name"].as<std::string>(),
-                    row["display_name"].as<std::string>(),
-                    row["description"].isNull() ? "" : row["description"].as<std::string>(),
-                    row["created_at"].as<std::string>());
-            }
-            LOG_INFO << "Synced " << result.size() << " gamedeps to Elasticsearch";
-        },
-        [](const drogon::orm::DrogonDbException &e) {
-            LOG_ERROR << "ES sync gamedeps failed: " << e.base().what();
-        },
-        tenantId);
+// ── Sync ─────────────────────────────────────────────────────────────────────
+
+void ElasticsearchService::syncFromDatabase(
+    const DbClientPtr &db, std::function<void(bool ok, const std::string &message)> cb) {
+    if (!configured_) {
+        if (cb) cb(false, "Elasticsearch is not configured");
+        return;
+    }
+    ElasticsearchReindexer::instance().start(db, std::move(cb));
 }
 
 } // namespace pyracms
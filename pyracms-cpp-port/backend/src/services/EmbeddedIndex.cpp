@@ -0,0 +1,879 @@
+#include "services/EmbeddedIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace pyracms {
+
+namespace {
+
+constexpr std::array<const char *, 4> kTypeNames = {"article", "forum_post", "snippet", "gamedep"};
+constexpr size_t kMaxTokenBytes = 64;
+// Compact once tombstones outnumber live documents, but not for tiny tenants
+constexpr uint32_t kMinTombstonesToCompact = 64;
+
+constexpr char kMagic[8] = {'P', 'Y', 'R', 'I', 'D', 'X', 0, 0};
+constexpr uint32_t kSnapshotVersion = 2;
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+int typeIndex(std::string_view type) {
+    for (size_t i = 0; i < kTypeNames.size(); ++i) {
+        if (type == kTypeNames[i]) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+uint64_t docKey(uint8_t type, int id) {
+    return (static_cast<uint64_t>(type) << 32) | static_cast<uint32_t>(id);
+}
+
+uint64_t fnv1a(uint64_t hash, std::string_view data) {
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    // Field separator, so ("ab", "c") and ("a", "bc") differ
+    hash ^= 0xff;
+    hash *= 1099511628211ull;
+    return hash;
+}
+
+void putVarint(std::vector<uint8_t> &out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Unchecked: only used on lists built in process or validated on load
+uint32_t getVarint(const uint8_t *data, size_t &pos) {
+    uint32_t value = 0;
+    for (int shift = 0;; shift += 7) {
+        uint8_t byte = data[pos++];
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+}
+
+bool getVarintChecked(const std::vector<uint8_t> &data, size_t &pos, uint32_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos >= data.size()) return false;
+        uint8_t byte = data[pos++];
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// Calls fn(token, start, end) for each token with its byte range in text
+template <typename Fn>
+void forEachToken(std::string_view text, Fn &&fn) {
+    std::string current;
+    size_t start = 0;
+    auto flush = [&](size_t end) {
+        if (!current.empty() && current.size() <= kMaxTokenBytes) {
+            fn(std::move(current), static_cast<uint32_t>(start), static_cast<uint32_t>(end));
+        }
+        current.clear();
+    };
+    for (size_t i = 0; i < text.size(); ++i) {
+        auto c = static_cast<unsigned char>(text[i]);
+        if (current.empty()) start = i;
+        if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80) {
+            current += static_cast<char>(c);
+        } else if (c >= 'A' && c <= 'Z') {
+            current += static_cast<char>(c - 'A' + 'a');
+        } else {
+            flush(i);
+        }
+    }
+    flush(text.size());
+}
+
+// ── Snapshot encoding ────────────────────────────────────────────────────────
+
+class SnapshotWriter {
+public:
+    void raw(const void *data, size_t size) {
+        out_.append(static_cast<const char *>(data), size);
+    }
+    template <typename T> void put(T value) { raw(&value, sizeof(value)); }
+    void str(const std::string &s) {
+        put(static_cast<uint32_t>(s.size()));
+        raw(s.data(), s.size());
+    }
+    const std::string &data() const { return out_; }
+
+private:
+    std::string out_;
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader(const uint8_t *data, size_t size) : p_(data), end_(data + size) {}
+
+    bool ok() const { return ok_; }
+    bool atEnd() const { return p_ == end_; }
+
+    const uint8_t *raw(size_t size) {
+        if (!ok_ || static_cast<size_t>(end_ - p_) < size) {
+            ok_ = false;
+            return nullptr;
+        }
+        auto *at = p_;
+        p_ += size;
+        return at;
+    }
+    template <typename T> T get() {
+        T value{};
+        if (auto *at = raw(sizeof(T))) std::memcpy(&value, at, sizeof(T));
+        return value;
+    }
+    std::string str() {
+        auto size = get<uint32_t>();
+        auto *at = raw(size);
+        return at ? std::string(reinterpret_cast<const char *>(at), size) : std::string();
+    }
+    // A count followed by that many trivially copyable values
+    template <typename T> bool array(std::vector<T> &out) {
+        auto count = get<uint32_t>();
+        auto *at = raw(static_cast<size_t>(count) * sizeof(T));
+        if (!at) return false;
+        out.resize(count);
+        std::memcpy(out.data(), at, static_cast<size_t>(count) * sizeof(T));
+        return true;
+    }
+
+private:
+    const uint8_t *p_;
+    const uint8_t *end_;
+    bool ok_ = true;
+};
+
+} // namespace
+
+// ── PostingList ──────────────────────────────────────────────────────────────
+
+void PostingList::append(uint32_t doc, uint32_t tf, uint32_t docLength) {
+    // A block's gaps start from the previous block's last doc
+    uint32_t prev = blocks_.empty() ? 0 : blocks_.back().lastDoc;
+    if (count_ % kBlockSize == 0) {
+        blocks_.push_back(Block{doc, static_cast<uint32_t>(data_.size())});
+    }
+    putVarint(data_, doc - prev);
+    putVarint(data_, tf);
+    blocks_.back().lastDoc = doc;
+    ++count_;
+    maxTf_ = std::max(maxTf_, tf);
+    minLength_ = std::min(minLength_, docLength);
+}
+
+PostingList::Cursor::Cursor(const PostingList &list) : list_(&list) {
+    if (list.count_ == 0) {
+        done_ = true;
+        return;
+    }
+    enterBlock(0);
+    decode();
+}
+
+void PostingList::Cursor::enterBlock(size_t block) {
+    block_ = block;
+    pos_ = list_->blocks_[block].offset;
+    remainingInBlock_ = std::min<uint32_t>(kBlockSize, list_->count_ - block * kBlockSize);
+    doc_ = block == 0 ? 0 : list_->blocks_[block - 1].lastDoc;
+}
+
+void PostingList::Cursor::decode() {
+    doc_ += getVarint(list_->data_.data(), pos_);
+    tf_ = getVarint(list_->data_.data(), pos_);
+    --remainingInBlock_;
+}
+
+void PostingList::Cursor::next() {
+    if (done_) return;
+    if (remainingInBlock_ > 0) {
+        decode();
+    } else if (block_ + 1 < list_->blocks_.size()) {
+        enterBlock(block_ + 1);
+        decode();
+    } else {
+        done_ = true;
+    }
+}
+
+void PostingList::Cursor::seek(uint32_t target) {
+    if (done_ || doc_ >= target) return;
+    const auto &blocks = list_->blocks_;
+    if (blocks[block_].lastDoc < target) {
+        auto it = std::lower_bound(blocks.begin() + block_ + 1, blocks.end(), target,
+                                   [](const Block &b, uint32_t t) { return b.lastDoc < t; });
+        if (it == blocks.end()) {
+            done_ = true;
+            return;
+        }
+        enterBlock(static_cast<size_t>(it - blocks.begin()));
+        decode();
+    }
+    // The block's last doc is >= target, so this stays inside it
+    while (doc_ < target) next();
+}
+
+// ── EmbeddedIndex ────────────────────────────────────────────────────────────
+
+EmbeddedIndex::EmbeddedIndex() : EmbeddedIndex(Options{}) {}
+EmbeddedIndex::EmbeddedIndex(Options options) : options_(options) {}
+EmbeddedIndex::~EmbeddedIndex() = default;
+
+std::vector<std::string> EmbeddedIndex::tokenize(std::string_view text) {
+    std::vector<std::string> tokens;
+    forEachToken(text, [&tokens](std::string &&token, uint32_t, uint32_t) {
+        tokens.push_back(std::move(token));
+    });
+    return tokens;
+}
+
+std::shared_ptr<EmbeddedIndex::Tenant> EmbeddedIndex::findTenant(int tenantId) const {
+    std::shared_lock<std::shared_mutex> lock(tenantsMutex_);
+    auto it = tenants_.find(tenantId);
+    return it == tenants_.end() ? nullptr : it->second;
+}
+
+std::shared_ptr<EmbeddedIndex::Tenant> EmbeddedIndex::tenant(int tenantId) {
+    if (auto t = findTenant(tenantId)) return t;
+    std::unique_lock<std::shared_mutex> lock(tenantsMutex_);
+    auto &slot = tenants_[tenantId];
+    if (!slot) slot = std::make_shared<Tenant>();
+    return slot;
+}
+
+bool EmbeddedIndex::upsert(int tenantId, const IndexedDocument &doc) {
+    int type = typeIndex(doc.type);
+    if (type < 0) return false;
+
+    uint64_t hash = 14695981039346656037ull;
+    for (const auto *field : {&doc.title, &doc.content, &doc.url, &doc.createdAt}) {
+        hash = fnv1a(hash, *field);
+    }
+
+    // Keep a body prefix for snippets, cut on a UTF-8 boundary
+    size_t bodyBytes = std::min(doc.content.size(), options_.highlightMaxBytes);
+    while (bodyBytes > 0 && bodyBytes < doc.content.size() &&
+           (static_cast<unsigned char>(doc.content[bodyBytes]) & 0xC0) == 0x80) {
+        --bodyBytes;
+    }
+
+    Doc entry;
+    entry.type = static_cast<uint8_t>(type);
+    entry.id = doc.id;
+    entry.hash = hash;
+    entry.title = doc.title;
+    entry.url = doc.url;
+    entry.createdAt = doc.createdAt;
+    entry.body = doc.content.substr(0, bodyBytes);
+
+    // Tokenize before taking the lock, recording where each body token sits
+    struct TermCounts {
+        uint32_t tf = 0;
+        std::vector<uint32_t> positions;
+    };
+    std::unordered_map<std::string, TermCounts> counts;
+    uint32_t length = 0;
+    for (auto &token : tokenize(doc.title)) {
+        counts[std::move(token)].tf += options_.titleWeight;
+        length += options_.titleWeight;
+    }
+    forEachToken(doc.content, [&](std::string &&token, uint32_t start, uint32_t end) {
+        auto &term = counts[std::move(token)];
+        ++term.tf;
+        ++length;
+        if (end <= bodyBytes) {
+            term.positions.push_back(static_cast<uint32_t>(entry.spans.size()));
+            entry.spans.push_back(TokenSpan{start, end});
+        }
+    });
+    entry.length = length;
+    entry.positions.reserve(entry.spans.size());
+    entry.terms.reserve(counts.size());
+
+    auto tenantPtr = tenant(tenantId);
+    auto &t = *tenantPtr;
+    std::unique_lock<std::shared_mutex> lock(t.mu);
+    auto key = docKey(entry.type, doc.id);
+    auto existing = t.byKey.find(key);
+    if (existing != t.byKey.end()) {
+        if (t.docs[existing->second].hash == hash) return false;
+        tombstone(t, existing->second);
+    }
+    std::vector<std::pair<uint32_t, TermCounts *>> byId;
+    byId.reserve(counts.size());
+    for (auto &[text, term] : counts) {
+        auto it = t.dictionary.find(text);
+        if (it == t.dictionary.end()) {
+            it = t.dictionary.emplace(text, static_cast<uint32_t>(t.terms.size())).first;
+            t.terms.emplace_back();
+        }
+        byId.emplace_back(it->second, &term);
+    }
+    std::sort(byId.begin(), byId.end(),
+              [](const auto &a, const auto &c) { return a.first < c.first; });
+    for (const auto &[termId, term] : byId) {
+        entry.terms.push_back(DocTerm{termId, term->tf,
+                                      static_cast<uint32_t>(entry.positions.size()),
+                                      static_cast<uint32_t>(term->positions.size())});
+        entry.positions.insert(entry.positions.end(), term->positions.begin(),
+                               term->positions.end());
+    }
+    addDoc(t, std::move(entry));
+    if (t.tombstones >= kMinTombstonesToCompact && t.tombstones > t.liveDocs) compact(t);
+    return true;
+}
+
+void EmbeddedIndex::addDoc(Tenant &t, Doc doc) {
+    auto docId = static_cast<uint32_t>(t.docs.size());
+    for (const auto &docTerm : doc.terms) {
+        auto &term = t.terms[docTerm.termId];
+        term.postings.append(docId, docTerm.tf, doc.length);
+        ++term.liveDf;
+        ++term.typeDf[doc.type];
+    }
+    t.byKey[docKey(doc.type, doc.id)] = docId;
+    ++t.liveDocs;
+    t.liveLength += doc.length;
+    t.docs.push_back(std::move(doc));
+}
+
+void EmbeddedIndex::tombstone(Tenant &t, uint32_t docId) {
+    auto &doc = t.docs[docId];
+    if (!doc.live) return;
+    for (const auto &docTerm : doc.terms) {
+        auto &term = t.terms[docTerm.termId];
+        --term.liveDf;
+        --term.typeDf[doc.type];
+    }
+    auto it = t.byKey.find(docKey(doc.type, doc.id));
+    if (it != t.byKey.end() && it->second == docId) t.byKey.erase(it);
+    --t.liveDocs;
+    t.liveLength -= doc.length;
+    ++t.tombstones;
+
+    // The postings stay until compaction; the rest is no longer needed
+    doc.live = false;
+    doc.terms = {};
+    doc.title = {};
+    doc.url = {};
+    doc.createdAt = {};
+    doc.body = {};
+    doc.spans = {};
+    doc.positions = {};
+}
+
+void EmbeddedIndex::compact(Tenant &t) {
+    std::vector<uint32_t> remap(t.terms.size(), UINT32_MAX);
+    std::map<std::string, uint32_t, std::less<>> dictionary;
+    std::vector<Term> terms;
+    for (const auto &[text, id] : t.dictionary) {
+        if (t.terms[id].liveDf == 0) continue;
+        remap[id] = static_cast<uint32_t>(terms.size());
+        dictionary.emplace_hint(dictionary.end(), text, static_cast<uint32_t>(terms.size()));
+        terms.emplace_back();
+    }
+
+    std::vector<Doc> docs;
+    docs.reserve(t.liveDocs);
+    t.byKey.clear();
+    for (auto &doc : t.docs) {
+        if (!doc.live) continue;
+        auto docId = static_cast<uint32_t>(docs.size());
+        for (auto &docTerm : doc.terms) {
+            docTerm.termId = remap[docTerm.termId];
+            auto &term = terms[docTerm.termId];
+            term.postings.append(docId, docTerm.tf, doc.length);
+            ++term.liveDf;
+            ++term.typeDf[doc.type];
+        }
+        // New ids follow dictionary order; positions are found by offset
+        std::sort(doc.terms.begin(), doc.terms.end(),
+                  [](const DocTerm &a, const DocTerm &c) { return a.termId < c.termId; });
+        t.byKey[docKey(doc.type, doc.id)] = docId;
+        docs.push_back(std::move(doc));
+    }
+    t.docs = std::move(docs);
+    t.dictionary = std::move(dictionary);
+    t.terms = std::move(terms);
+    t.tombstones = 0;
+}
+
+bool EmbeddedIndex::remove(int tenantId, const std::string &type, int id) {
+    int typeIdx = typeIndex(type);
+    auto t = findTenant(tenantId);
+    if (typeIdx < 0 || !t) return false;
+    std::unique_lock<std::shared_mutex> lock(t->mu);
+    auto it = t->byKey.find(docKey(static_cast<uint8_t>(typeIdx), id));
+    if (it == t->byKey.end()) return false;
+    tombstone(*t, it->second);
+    if (t->tombstones >= kMinTombstonesToCompact && t->tombstones > t->liveDocs) compact(*t);
+    return true;
+}
+
+bool EmbeddedIndex::remove(const std::string &type, int id) {
+    for (int tenantId : tenants()) {
+        if (remove(tenantId, type, id)) return true;
+    }
+    return false;
+}
+
+size_t EmbeddedIndex::retainOnly(int tenantId, const std::string &type,
+                                 const std::unordered_set<int> &keep) {
+    int typeIdx = typeIndex(type);
+    auto t = findTenant(tenantId);
+    if (typeIdx < 0 || !t) return 0;
+    std::unique_lock<std::shared_mutex> lock(t->mu);
+    std::vector<uint32_t> stale;
+    for (const auto &[key, docId] : t->byKey) {
+        const auto &doc = t->docs[docId];
+        if (doc.type == typeIdx && !keep.count(doc.id)) stale.push_back(docId);
+    }
+    for (auto docId : stale) tombstone(*t, docId);
+    if (t->tombstones >= kMinTombstonesToCompact && t->tombstones > t->liveDocs) compact(*t);
+    return stale.size();
+}
+
+SearchResults EmbeddedIndex::search(int tenantId, const std::string &query,
+                                    const std::string &type, int limit, int offset) const {
+    SearchResults results;
+    results.query = query;
+    results.totalCount = 0;
+    if (limit <= 0) return results;
+    offset = std::max(offset, 0);
+
+    int typeFilter = -1;
+    if (!type.empty() && type != "all") {
+        typeFilter = typeIndex(type);
+        if (typeFilter < 0) return results;
+    }
+
+    auto t = findTenant(tenantId);
+    if (!t) return results;
+    std::shared_lock<std::shared_mutex> lock(t->mu);
+    if (t->liveDocs == 0) return results;
+
+    auto tokens = tokenize(query);
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+    // Term ids paired with the query word they came from
+    std::vector<std::pair<uint32_t, uint32_t>> wordTerms;
+    for (size_t word = 0; word < tokens.size(); ++word) {
+        const auto &token = tokens[word];
+        auto exact = t->dictionary.find(token);
+        if (exact != t->dictionary.end()) {
+            wordTerms.emplace_back(exact->second, static_cast<uint32_t>(word));
+            continue;
+        }
+        // Unknown word: treat it as a prefix, like the tsquery ":*" fallback
+        if (token.size() < 2) continue;
+        size_t expanded = 0;
+        for (auto it = t->dictionary.lower_bound(token);
+             it != t->dictionary.end() && expanded < options_.maxPrefixExpansions &&
+             it->first.compare(0, token.size(), token) == 0;
+             ++it, ++expanded) {
+            wordTerms.emplace_back(it->second, static_cast<uint32_t>(word));
+        }
+    }
+    std::sort(wordTerms.begin(), wordTerms.end());
+    wordTerms.erase(std::unique(wordTerms.begin(), wordTerms.end(),
+                                [](const auto &a, const auto &c) { return a.first == c.first; }),
+                    wordTerms.end());
+
+    const double n = t->liveDocs;
+    const double avgLength = std::max(1.0, static_cast<double>(t->liveLength) / n);
+    const double k1 = options_.k1;
+    const double b = options_.b;
+    auto tfScore = [k1, b, avgLength](double tf, double length) {
+        return tf * (k1 + 1) / (tf + k1 * (1 - b + b * length / avgLength));
+    };
+
+    struct QueryCursor {
+        PostingList::Cursor cursor;
+        double idf;
+        double bound;
+    };
+    std::vector<QueryCursor> cursors;
+    std::array<uint32_t, 4> estimates{};
+    for (const auto &[termId, word] : wordTerms) {
+        const auto &term = t->terms[termId];
+        if (term.liveDf == 0) continue;
+        for (size_t i = 0; i < estimates.size(); ++i) {
+            estimates[i] = std::max(estimates[i], term.typeDf[i]);
+        }
+        double df = term.liveDf;
+        double idf = std::log(1 + (n - df + 0.5) / (df + 0.5));
+        double bound = idf * tfScore(term.postings.maxTf(), term.postings.minLength());
+        cursors.push_back(QueryCursor{PostingList::Cursor(term.postings), idf, bound});
+    }
+    for (size_t i = 0; i < estimates.size(); ++i) {
+        if (estimates[i] == 0 || (typeFilter >= 0 && static_cast<int>(i) != typeFilter)) continue;
+        results.facets[kTypeNames[i]] = static_cast<int>(estimates[i]);
+        results.totalCount += static_cast<int>(estimates[i]);
+    }
+
+    // WAND: keep cursors ordered by doc; the pivot is the first doc at which
+    // the summed upper bounds could beat the current K-th best score
+    struct Hit {
+        double score;
+        uint32_t doc;
+    };
+    auto better = [](const Hit &a, const Hit &c) {
+        return a.score > c.score || (a.score == c.score && a.doc < c.doc);
+    };
+    const size_t k = static_cast<size_t>(offset) + static_cast<size_t>(limit);
+    std::vector<Hit> heap; // worst hit on top
+    heap.reserve(k + 1);
+
+    std::vector<QueryCursor *> order;
+    for (auto &c : cursors) {
+        if (!c.cursor.done()) order.push_back(&c);
+    }
+    auto byDoc = [](const QueryCursor *a, const QueryCursor *c) {
+        return a->cursor.doc() < c->cursor.doc();
+    };
+
+    while (!order.empty()) {
+        std::sort(order.begin(), order.end(), byDoc);
+        double threshold = heap.size() < k ? -std::numeric_limits<double>::infinity()
+                                            : heap.front().score;
+        double sum = 0;
+        size_t pivot = 0;
+        for (; pivot < order.size(); ++pivot) {
+            sum += order[pivot]->bound;
+            if (sum > threshold) break;
+        }
+        if (pivot == order.size()) break;
+        uint32_t pivotDoc = order[pivot]->cursor.doc();
+
+        if (order[0]->cursor.doc() == pivotDoc) {
+            const auto &doc = t->docs[pivotDoc];
+            bool eligible = doc.live && (typeFilter < 0 || doc.type == typeFilter);
+            double score = 0;
+            for (auto *c : order) {
+                if (c->cursor.doc() != pivotDoc) break;
+                if (eligible) score += c->idf * tfScore(c->cursor.tf(), doc.length);
+                c->cursor.next();
+            }
+            if (eligible) {
+                Hit hit{score, pivotDoc};
+                if (heap.size() < k) {
+                    heap.push_back(hit);
+                    std::push_heap(heap.begin(), heap.end(), better);
+                } else if (better(hit, heap.front())) {
+                    std::pop_heap(heap.begin(), heap.end(), better);
+                    heap.back() = hit;
+                    std::push_heap(heap.begin(), heap.end(), better);
+                }
+            }
+        } else {
+            // Advance the rarest term short of the pivot; it skips furthest
+            auto behind = std::partition_point(order.begin(), order.begin() + pivot,
+                                               [pivotDoc](const QueryCursor *c) {
+                                                   return c->cursor.doc() < pivotDoc;
+                                               });
+            auto *skip = *std::max_element(order.begin(), behind,
+                                           [](const QueryCursor *a, const QueryCursor *c) {
+                                               return a->idf < c->idf;
+                                           });
+            skip->cursor.seek(pivotDoc);
+        }
+        order.erase(std::remove_if(order.begin(), order.end(),
+                                   [](const QueryCursor *c) { return c->cursor.done(); }),
+                    order.end());
+    }
+
+    std::sort(heap.begin(), heap.end(), better);
+    SnippetHighlighter::Options highlightOptions;
+    highlightOptions.snippetChars = options_.snippetChars;
+    highlightOptions.maxMatches = options_.highlightMaxMatches;
+    std::vector<SnippetHighlighter::Positions> positions;
+    for (size_t i = static_cast<size_t>(offset); i < heap.size(); ++i) {
+        const auto &doc = t->docs[heap[i].doc];
+        positions.clear();
+        for (const auto &[termId, word] : wordTerms) {
+            auto it = std::lower_bound(doc.terms.begin(), doc.terms.end(), termId,
+                                       [](const DocTerm &d, uint32_t id) { return d.termId < id; });
+            if (it == doc.terms.end() || it->termId != termId || it->positionCount == 0) continue;
+            positions.push_back({doc.positions.data() + it->firstPosition, it->positionCount, word});
+        }
+        auto snippet = SnippetHighlighter::highlight(doc.body, doc.spans, positions, highlightOptions);
+
+        SearchResultItem item;
+        item.type = kTypeNames[doc.type];
+        item.id = doc.id;
+        item.title = doc.title;
+        item.snippet = std::move(snippet.snippet);
+        item.highlight = std::move(snippet.highlight);
+        item.url = doc.url;
+        item.rank = heap[i].score;
+        item.createdAt = doc.createdAt;
+        results.items.push_back(std::move(item));
+    }
+    return results;
+}
+
+std::vector<int> EmbeddedIndex::tenants() const {
+    std::shared_lock<std::shared_mutex> lock(tenantsMutex_);
+    std::vector<int> ids;
+    ids.reserve(tenants_.size());
+    for (const auto &[id, t] : tenants_) ids.push_back(id);
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+EmbeddedIndex::Stats EmbeddedIndex::stats() const {
+    Stats stats;
+    std::shared_lock<std::shared_mutex> lock(tenantsMutex_);
+    stats.tenants = tenants_.size();
+    for (const auto &[id, t] : tenants_) {
+        std::shared_lock<std::shared_mutex> tenantLock(t->mu);
+        stats.documents += t->liveDocs;
+        stats.tombstones += t->tombstones;
+        stats.terms += t->dictionary.size();
+        for (const auto &term : t->terms) stats.postingBytes += term.postings.bytes();
+        for (const auto &doc : t->docs) {
+            stats.highlightBytes += doc.body.size() + doc.spans.size() * sizeof(TokenSpan) +
+                                    doc.positions.size() * sizeof(uint32_t);
+        }
+    }
+    return stats;
+}
+
+// ── Snapshots ────────────────────────────────────────────────────────────────
+//
+// Native-endian binary, guarded by a byte-order mark: the snapshot is a
+// restart cache for this host, not an interchange format.
+
+bool EmbeddedIndex::save(const std::string &path) const {
+    SnapshotWriter w;
+    w.raw(kMagic, sizeof(kMagic));
+    w.put(kSnapshotVersion);
+    w.put(kByteOrderMark);
+    {
+        std::shared_lock<std::shared_mutex> lock(tenantsMutex_);
+        w.put(static_cast<uint32_t>(tenants_.size()));
+        for (const auto &[tenantId, t] : tenants_) {
+            std::shared_lock<std::shared_mutex> tenantLock(t->mu);
+            w.put(static_cast<int32_t>(tenantId));
+            w.put(static_cast<uint32_t>(t->docs.size()));
+            for (const auto &doc : t->docs) {
+                w.put(doc.type);
+                w.put(static_cast<uint8_t>(doc.live));
+                w.put(static_cast<int32_t>(doc.id));
+                w.put(doc.length);
+                w.put(doc.hash);
+                w.str(doc.title);
+                w.str(doc.url);
+                w.str(doc.createdAt);
+                w.str(doc.body);
+                w.put(static_cast<uint32_t>(doc.spans.size()));
+                w.raw(doc.spans.data(), doc.spans.size() * sizeof(TokenSpan));
+                w.put(static_cast<uint32_t>(doc.positions.size()));
+                w.raw(doc.positions.data(), doc.positions.size() * sizeof(uint32_t));
+                w.put(static_cast<uint32_t>(doc.terms.size()));
+                w.raw(doc.terms.data(), doc.terms.size() * sizeof(DocTerm));
+            }
+            w.put(static_cast<uint32_t>(t->dictionary.size()));
+            for (const auto &[text, termId] : t->dictionary) {
+                const auto &term = t->terms[termId];
+                const auto &postings = term.postings;
+                w.str(text);
+                w.put(termId);
+                w.put(term.liveDf);
+                for (auto df : term.typeDf) w.put(df);
+                w.put(postings.count_);
+                w.put(postings.maxTf_);
+                w.put(postings.minLength_);
+                w.put(static_cast<uint32_t>(postings.blocks_.size()));
+                w.raw(postings.blocks_.data(), postings.blocks_.size() * sizeof(PostingList::Block));
+                w.put(static_cast<uint32_t>(postings.data_.size()));
+                w.raw(postings.data_.data(), postings.data_.size());
+            }
+        }
+    }
+
+    auto tmp = path + ".tmp";
+    std::FILE *f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    const auto &data = w.data();
+    bool ok = std::fwrite(data.data(), 1, data.size(), f) == data.size();
+    ok = std::fflush(f) == 0 && ok;
+    ok = ::fsync(fileno(f)) == 0 && ok;
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool EmbeddedIndex::load(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(kMagic) + 12)) {
+        ::close(fd);
+        return false;
+    }
+    auto size = static_cast<size_t>(st.st_size);
+    void *mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return false;
+    ::madvise(mapped, size, MADV_SEQUENTIAL);
+
+    // Spans ordered and inside the body, position runs inside positions,
+    // terms sorted, and each run ascending and naming an existing span
+    auto validHighlights = [](const Doc &doc) {
+        uint32_t prevEnd = 0;
+        for (const auto &span : doc.spans) {
+            if (span.start < prevEnd || span.end <= span.start || span.end > doc.body.size()) {
+                return false;
+            }
+            prevEnd = span.end;
+        }
+        for (size_t i = 0; i < doc.terms.size(); ++i) {
+            const auto &term = doc.terms[i];
+            if (i > 0 && doc.terms[i - 1].termId >= term.termId) return false;
+            if (term.firstPosition > doc.positions.size() ||
+                term.positionCount > doc.positions.size() - term.firstPosition) {
+                return false;
+            }
+            for (uint32_t j = 0; j < term.positionCount; ++j) {
+                auto position = doc.positions[term.firstPosition + j];
+                if (position >= doc.spans.size()) return false;
+                if (j > 0 && position <= doc.positions[term.firstPosition + j - 1]) return false;
+            }
+        }
+        return true;
+    };
+
+    SnapshotReader r(static_cast<const uint8_t *>(mapped), size);
+    std::unordered_map<int, std::shared_ptr<Tenant>> loaded;
+    bool ok = [&] {
+        auto *magic = r.raw(sizeof(kMagic));
+        if (!magic || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) return false;
+        if (r.get<uint32_t>() != kSnapshotVersion || r.get<uint32_t>() != kByteOrderMark) {
+            return false;
+        }
+        auto tenantCount = r.get<uint32_t>();
+        for (uint32_t ti = 0; ti < tenantCount && r.ok(); ++ti) {
+            auto t = std::make_shared<Tenant>();
+            int tenantId = r.get<int32_t>();
+            auto docCount = r.get<uint32_t>();
+            for (uint32_t di = 0; di < docCount && r.ok(); ++di) {
+                Doc doc;
+                doc.type = r.get<uint8_t>();
+                doc.live = r.get<uint8_t>() != 0;
+                doc.id = r.get<int32_t>();
+                doc.length = r.get<uint32_t>();
+                doc.hash = r.get<uint64_t>();
+                doc.title = r.str();
+                doc.url = r.str();
+                doc.createdAt = r.str();
+                doc.body = r.str();
+                if (doc.type >= kTypeNames.size()) return false;
+                if (!r.array(doc.spans) || !r.array(doc.positions) || !r.array(doc.terms)) {
+                    return false;
+                }
+                if (doc.live) {
+                    t->byKey[docKey(doc.type, doc.id)] = di;
+                    ++t->liveDocs;
+                    t->liveLength += doc.length;
+                } else {
+                    ++t->tombstones;
+                }
+                t->docs.push_back(std::move(doc));
+            }
+
+            auto termCount = r.get<uint32_t>();
+            if (!r.ok()) return false;
+            t->terms.resize(termCount);
+            for (uint32_t i = 0; i < termCount && r.ok(); ++i) {
+                auto text = r.str();
+                auto termId = r.get<uint32_t>();
+                if (termId >= termCount || !t->dictionary.emplace(std::move(text), termId).second) {
+                    return false;
+                }
+                auto &term = t->terms[termId];
+                term.liveDf = r.get<uint32_t>();
+                for (auto &df : term.typeDf) df = r.get<uint32_t>();
+                auto &postings = term.postings;
+                postings.count_ = r.get<uint32_t>();
+                postings.maxTf_ = r.get<uint32_t>();
+                postings.minLength_ = r.get<uint32_t>();
+                auto blockCount = r.get<uint32_t>();
+                auto *blocks = r.raw(static_cast<size_t>(blockCount) * sizeof(PostingList::Block));
+                if (!blocks) return false;
+                postings.blocks_.resize(blockCount);
+                std::memcpy(postings.blocks_.data(), blocks, blockCount * sizeof(PostingList::Block));
+                auto byteCount = r.get<uint32_t>();
+                auto *bytes = r.raw(byteCount);
+                if (!bytes) return false;
+                postings.data_.assign(bytes, bytes + byteCount);
+            }
+            if (!r.ok() || t->dictionary.size() != termCount) return false;
+
+            // Validate what the unchecked cursors and the highlighter will
+            // trust: every posting decodes in bounds, in order, and names an
+            // existing document
+            for (const auto &doc : t->docs) {
+                if (!validHighlights(doc)) return false;
+                for (const auto &docTerm : doc.terms) {
+                    if (docTerm.termId >= termCount) return false;
+                }
+            }
+            for (const auto &term : t->terms) {
+                const auto &p = term.postings;
+                auto expectedBlocks = (p.count_ + PostingList::kBlockSize - 1) / PostingList::kBlockSize;
+                if (p.blocks_.size() != expectedBlocks) return false;
+                size_t pos = 0;
+                uint32_t doc = 0;
+                for (uint32_t i = 0; i < p.count_; ++i) {
+                    if (i % PostingList::kBlockSize == 0) {
+                        const auto &block = p.blocks_[i / PostingList::kBlockSize];
+                        if (block.offset != pos) return false;
+                    }
+                    uint32_t gap = 0;
+                    uint32_t tf = 0;
+                    if (!getVarintChecked(p.data_, pos, gap) || !getVarintChecked(p.data_, pos, tf)) {
+                        return false;
+                    }
+                    if (i > 0 && gap == 0) return false;
+                    doc += gap;
+                    if (doc >= t->docs.size()) return false;
+                    if ((i + 1) % PostingList::kBlockSize == 0 || i + 1 == p.count_) {
+                        if (p.blocks_[i / PostingList::kBlockSize].lastDoc != doc) return false;
+                    }
+                }
+                if (pos != p.data_.size()) return false;
+            }
+            loaded[tenantId] = std::move(t);
+        }
+        return r.ok() && r.atEnd();
+    }();
+    ::munmap(mapped, size);
+    if (!ok) return false;
+
+    std::unique_lock<std::shared_mutex> lock(tenantsMutex_);
+    tenants_ = std::move(loaded);
+    return true;
+}
+
+} // namespace pyracms
@@ -0,0 +1,211 @@
+#include "services/EmbeddedSearchService.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <unordered_set>
+
+namespace pyracms {
+
+namespace {
+
+std::string text(const drogon::orm::Field &field) {
+    return field.isNull() ? "" : field.as<std::string>();
+}
+
+IndexedDocument articleDoc(const drogon::orm::Row &row) {
+    return {"article", row["id"].as<int>(), text(row["display_name"]), text(row["content"]),
+            "/articles/" + row["name"].as<std::string>(), text(row["created_at"])};
+}
+
+IndexedDocument forumPostDoc(const drogon::orm::Row &row) {
+    return {"forum_post", row["id"].as<int>(), text(row["title"]), text(row["content"]),
+            "/forum/thread/" + std::to_string(row["thread_id"].as<int>()),
+            text(row["created_at"])};
+}
+
+IndexedDocument snippetDoc(const drogon::orm::Row &row) {
+    int id = row["id"].as<int>();
+    return {"snippet", id, text(row["title"]), text(row["code"]),
+            "/snippets/" + std::to_string(id), text(row["created_at"])};
+}
+
+IndexedDocument gameDepDoc(const drogon::orm::Row &row) {
+    return {"gamedep", row["id"].as<int>(), text(row["display_name"]), text(row["description"]),
+            "/gamedep/" + row["name"].as<std::string>(), text(row["created_at"])};
+}
+
+// The same rows the PostgreSQL and Elasticsearch paths search, across all
+// tenants
+struct Source {
+    const char *type;
+    const char *sql;
+    IndexedDocument (*toDoc)(const drogon::orm::Row &);
+};
+
+const Source kSources[] = {
+    {"article",
+     "SELECT a.tenant_id, a.id, a.name, a.display_name, a.created_at, "
+     "  (SELECT content FROM article_revisions WHERE article_id = a.id "
+     "   ORDER BY created_at DESC, id DESC LIMIT 1) AS content "
+     "FROM articles a WHERE a.status = 'published' AND a.is_private = false",
+     articleDoc},
+    {"forum_post",
+     "SELECT c.tenant_id, p.id, p.title, p.content, p.thread_id, p.created_at "
+     "FROM forum_posts p "
+     "JOIN forum_threads t ON t.id = p.thread_id "
+     "JOIN forums f ON f.id = t.forum_id "
+     "JOIN forum_categories c ON c.id = f.category_id",
+     forumPostDoc},
+    {"snippet",
+     "SELECT tenant_id, id, title, code, created_at "
+     "FROM code_snippets WHERE visibility = 'public'",
+     snippetDoc},
+    {"gamedep",
+     // The gamedep catalog is shared, so every tenant indexes all of it
+     "SELECT t.id AS tenant_id, g.id, g.name, g.display_name, g.description, g.created_at "
+     "FROM gamedep_pages g CROSS JOIN tenants t",
+     gameDepDoc},
+};
+
+} // namespace
+
+EmbeddedSearchService &EmbeddedSearchService::instance() {
+    static EmbeddedSearchService inst;
+    return inst;
+}
+
+bool EmbeddedSearchService::enabled() {
+    const char *engine = std::getenv("SEARCH_ENGINE");
+    return engine && std::string(engine) == "embedded";
+}
+
+void EmbeddedSearchService::initialize() {
+    const char *path = std::getenv("EMBEDDED_SEARCH_SNAPSHOT");
+    const char *seconds = std::getenv("EMBEDDED_SEARCH_SNAPSHOT_SECONDS");
+    snapshotPath_ = path ? path : "data/search.idx";
+    if (seconds) snapshotInterval_ = std::chrono::seconds(std::stoi(seconds));
+
+    if (index_.load(snapshotPath_)) {
+        auto loaded = index_.stats();
+        LOG_INFO << "Embedded search: loaded " << loaded.documents << " documents from "
+                 << snapshotPath_;
+    } else {
+        LOG_INFO << "Embedded search: no usable snapshot at " << snapshotPath_
+                 << ", building from the database";
+    }
+
+    std::error_code ec;
+    auto dir = std::filesystem::path(snapshotPath_).parent_path();
+    if (!dir.empty()) std::filesystem::create_directories(dir, ec);
+
+    if (snapshotInterval_.count() > 0) {
+        thread_ = std::thread([this] { snapshotLoop(); });
+    }
+}
+
+void EmbeddedSearchService::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (stopping_) return;
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    saveIfDirty();
+}
+
+void EmbeddedSearchService::snapshotLoop() {
+    std::unique_lock<std::mutex> lock(mu_);
+    while (!wake_.wait_for(lock, snapshotInterval_, [this] { return stopping_; })) {
+        lock.unlock();
+        saveIfDirty();
+        lock.lock();
+    }
+}
+
+void EmbeddedSearchService::saveIfDirty() {
+    if (snapshotPath_.empty() || !dirty_.exchange(false)) return;
+    if (!index_.save(snapshotPath_)) {
+        dirty_ = true;
+        LOG_ERROR << "Embedded search: failed to write snapshot " << snapshotPath_;
+    }
+}
+
+void EmbeddedSearchService::reconcile(const DbClientPtr &db) {
+    for (const auto &source : kSources) {
+        db->execSqlAsync(
+            source.sql,
+            [this, &source](const drogon::orm::Result &result) {
+                std::map<int, std::unordered_set<int>> present;
+                size_t changed = 0;
+                for (const auto &row : result) {
+                    int tenantId = row["tenant_id"].as<int>();
+                    auto doc = source.toDoc(row);
+                    present[tenantId].insert(doc.id);
+                    if (index_.upsert(tenantId, doc)) ++changed;
+                }
+                size_t removed = 0;
+                for (int tenantId : index_.tenants()) {
+                    removed += index_.retainOnly(tenantId, source.type, present[tenantId]);
+                }
+                if (changed || removed) dirty_ = true;
+                LOG_INFO << "Embedded search: reconciled " << result.size() << " "
+                         << source.type << " rows (" << changed << " updated, "
+                         << removed << " removed)";
+            },
+            [&source](const drogon::orm::DrogonDbException &e) {
+                LOG_ERROR << "Embedded search reconcile " << source.type
+                          << " failed: " << e.base().what();
+            });
+    }
+}
+
+void EmbeddedSearchService::upsert(int tenantId, IndexedDocument doc) {
+    if (index_.upsert(tenantId, doc)) dirty_ = true;
+}
+
+void EmbeddedSearchService::indexArticle(int tenantId, int articleId,
+                                         const std::string &name,
+                                         const std::string &displayName,
+                                         const std::string &content,
+                                         const std::string &createdAt) {
+    upsert(tenantId, {"article", articleId, displayName, content, "/articles/" + name, createdAt});
+}
+
+void EmbeddedSearchService::indexForumPost(int tenantId, int postId,
+                                           const std::string &title,
+                                           const std::string &content,
+                                           int threadId,
+                                           const std::string &createdAt) {
+    upsert(tenantId, {"forum_post", postId, title, content,
+                      "/forum/thread/" + std::to_string(threadId), createdAt});
+}
+
+void EmbeddedSearchService::indexSnippet(int tenantId, int snippetId,
+                                         const std::string &title,
+                                         const std::string &code,
+                                         const std::string &createdAt) {
+    upsert(tenantId, {"snippet", snippetId, title, code,
+                      "/snippets/" + std::to_string(snippetId), createdAt});
+}
+
+void EmbeddedSearchService::indexGameDep(int tenantId, int pageId,
+                                         const std::string &name,
+                                         const std::string &displayName,
+                                         const std::string &description,
+                                         const std::string &createdAt) {
+    upsert(tenantId, {"gamedep", pageId, displayName, description, "/gamedep/" + name, createdAt});
+}
+
+void EmbeddedSearchService::deleteDocument(const std::string &type, int id) {
+    if (index_.remove(type, id)) dirty_ = true;
+}
+
+SearchResults EmbeddedSearchService::search(int tenantId, const std::string &query,
+                                             const std::string &type,
+                                             int limit, int offset) const {
+    return index_.search(tenantId, query, type, limit, offset);
+}
+
+} // namespace pyracms
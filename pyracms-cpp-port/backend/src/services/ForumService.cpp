@@ -1,7 +1,34 @@
 #include "services/ForumService.h"
+#include "services/AutocompleteService.h"
+#include "services/ViewCountService.h"
 
 namespace pyracms {
 
+namespace {
+
+// Appended to RETURNING on post writes: the post's tenant and its thread's
+// view count, which the autocomplete index uses as the post's weight
+constexpr const char *kPostIndexColumns =
+    "id, title, thread_id, "
+    "(SELECT c.tenant_id FROM forum_threads t "
+    " JOIN forums f ON f.id = t.forum_id "
+    " JOIN forum_categories c ON c.id = f.category_id "
+    " WHERE t.id = forum_posts.thread_id) AS tenant_id, "
+    "(SELECT view_count FROM forum_threads WHERE id = forum_posts.thread_id) AS thread_views";
+
+void autocompletePost(const drogon::orm::Result &result) {
+    for (const auto &row : result) {
+        if (row["tenant_id"].isNull()) continue;
+        AutocompleteService::instance().indexForumPost(
+            row["tenant_id"].as<int>(), row["id"].as<int>(),
+            row["title"].isNull() ? "" : row["title"].as<std::string>(),
+            row["thread_id"].as<int>(),
+            row["thread_views"].isNull() ? 0 : row["thread_views"].as<int64_t>());
+    }
+}
+
+} // namespace
+
 ForumCategoryDto ForumService::rowToCategoryDto(const drogon::orm::Row &row) {
     ForumCategoryDto dto;
     dto.id = row["id"].as<int>();
@@ -26,7 +53,9 @@ ForumThreadDto ForumService::rowToThreadDto(const drogon::orm::Row &row) {
     dto.name = row["name"].as<std::string>();
     dto.description = row["description"].isNull() ? "" : row["description"].as<std::string>();
     dto.forumId = row["forum_id"].as<int>();
-    dto.viewCount = row["view_count"].isNull() ? 0 : row["view_count"].as<int>();
+    dto.viewCount = (row["view_count"].isNull() ? 0 : row["view_count"].as<int>()) +
+                    static_cast<int>(ViewCountService::pending(ViewCounter::Table::ForumThread,
+                                                               dto.id));
     dto.totalPosts = row["total_posts"].isNull() ? 0 : row["total_posts"].as<int>();
     dto.createdAt = row["created_at"].as<std::string>();
     return dto;
@@ -171,7 +200,9 @@ void ForumService::getForum(
                                                  ? ""
                                                  : row["description"].as<std::string>();
                         thread.forumId = row["forum_id"].as<int>();
-                        thread.viewCount = row["view_count"].as<int>();
+                        thread.viewCount = row["view_count"].as<int>() +
+                                           static_cast<int>(ViewCountService::pending(
+                                               ViewCounter::Table::ForumThread, thread.id));
                         thread.totalPosts = row["total_posts"].as<int>();
                         thread.createdAt = row["created_at"].as<std::string>();
                         dto.threads.push_back(thread);
@@ -239,15 +270,7 @@ void ForumService::getThread(
     const DbClientPtr &db, int threadId,
     std::function<void(const std::optional<ForumThreadWithPostsDto> &)> cb) {
 
-    // Increment view count
-    db->execSqlAsync(
-        "UPDATE forum_threads SET view_count = COALESCE(view_count, 0) + 1 "
-        "WHERE id = $1",
-        [](const drogon::orm::Result &) {},
-        [](const drogon::orm::DrogonDbException &) {},
-        threadId);
-
-    // Fetch thread
+    // Fetch thread; the view is counted in memory, so db may be a replica
     db->execSqlAsync(
         "SELECT id, name, description, forum_id, "
         "COALESCE(view_count, 0) AS view_count, "
@@ -260,6 +283,7 @@ void ForumService::getThread(
                 return;
             }
 
+            ViewCountService::record(ViewCounter::Table::ForumThread, threadId);
             ForumThreadWithPostsDto dto;
             dto.thread = rowToThreadDto(result[0]);
 
@@ -399,9 +423,11 @@ void ForumService::createPost(const DbClientPtr &db, int threadId,
                                int userId,
                                BoolCallback cb) {
     db->execSqlAsync(
-        "INSERT INTO forum_posts (title, content, thread_id, user_id, "
-        "created_at) VALUES ($1, $2, $3, $4, NOW()) RETURNING id",
-        [db, threadId, cb](const drogon::orm::Result &) {
+        std::string("INSERT INTO forum_posts (title, content, thread_id, user_id, "
+                    "created_at) VALUES ($1, $2, $3, $4, NOW()) RETURNING ") +
+            kPostIndexColumns,
+        [db, threadId, cb](const drogon::orm::Result &result) {
+            autocompletePost(result);
             // Update thread post count
             db->execSqlAsync(
                 "UPDATE forum_threads SET total_posts = COALESCE(total_posts, 0) + 1 "
@@ -457,8 +483,11 @@ void ForumService::updatePost(const DbClientPtr &db, int postId,
                                const std::string &content,
                                BoolCallback cb) {
     db->execSqlAsync(
-        "UPDATE forum_posts SET title = $1, content = $2 WHERE id = $3",
-        [cb](const drogon::orm::Result &) {
+        std::string("UPDATE forum_posts SET title = $1, content = $2 WHERE id = $3 "
+                    "RETURNING ") +
+            kPostIndexColumns,
+        [cb](const drogon::orm::Result &result) {
+            autocompletePost(result);
             cb(true, "");
         },
         [cb](const drogon::orm::DrogonDbException &e) {
@@ -469,19 +498,22 @@ void ForumService::updatePost(const DbClientPtr &db, int postId,
 
 void ForumService::deletePost(const DbClientPtr &db, int postId,
                                BoolCallback cb) {
-    // Get thread_id before deleting
+    // Get thread_id (and the tenant, for autocomplete) before deleting
     db->execSqlAsync(
-        "SELECT thread_id FROM forum_posts WHERE id = $1",
+        std::string("SELECT ") + kPostIndexColumns + " FROM forum_posts WHERE id = $1",
         [db, postId, cb](const drogon::orm::Result &result) {
             if (result.empty()) {
                 cb(false, "Post not found");
                 return;
             }
             int threadId = result[0]["thread_id"].as<int>();
+            auto tenant = result[0]["tenant_id"];
+            int tenantId = tenant.isNull() ? 0 : tenant.as<int>();
 
             db->execSqlAsync(
                 "DELETE FROM forum_posts WHERE id = $1",
-                [db, threadId, cb](const drogon::orm::Result &) {
+                [db, threadId, tenantId, postId, cb](const drogon::orm::Result &) {
+                    AutocompleteService::instance().removeForumPost(tenantId, postId);
                     // Update thread post count
                     db->execSqlAsync(
                         "UPDATE forum_threads SET "
@@ -1,7 +1,22 @@
 #include "services/GalleryService.h"
+#include "services/CacheService.h"
+#include "services/ResponseCache.h"
 
 namespace pyracms {
 
+namespace {
+
+// Album lists are cached per tenant; writes return the tenant they touched
+void purgeAlbumLists(const drogon::orm::Result &result) {
+    for (const auto &row : result) {
+        if (row["tenant_id"].isNull()) continue;
+        CacheService::instance().purgeResponses(
+            {ResponseCache::galleryKey(row["tenant_id"].as<int>())});
+    }
+}
+
+} // namespace
+
 GalleryAlbumDto GalleryService::albumRowToDto(const drogon::orm::Row &row) {
     GalleryAlbumDto dto;
     dto.id = row["id"].as<int>();
@@ -61,8 +76,9 @@ void GalleryService::createAlbum(const DbClientPtr &db, int tenantId,
         "INSERT INTO gallery_albums (tenant_id, display_name, description, "
         "user_id, is_private, is_protected, created_at) "
         "VALUES ($1, $2, $3, $4, false, false, NOW()) "
-        "RETURNING id",
+        "RETURNING id, tenant_id",
         [cb](const drogon::orm::Result &result) {
+            purgeAlbumLists(result);
             cb(true, "");
         },
         [cb](const drogon::orm::DrogonDbException &e) {
@@ -117,8 +133,9 @@ void GalleryService::updateAlbum(const DbClientPtr &db, int albumId,
                                   BoolCallback cb) {
     db->execSqlAsync(
         "UPDATE gallery_albums SET display_name = $1, description = $2 "
-        "WHERE id = $3",
-        [cb](const drogon::orm::Result &) {
+        "WHERE id = $3 RETURNING tenant_id",
+        [cb](const drogon::orm::Result &result) {
+            purgeAlbumLists(result);
             cb(true, "");
         },
         [cb](const drogon::orm::DrogonDbException &e) {
@@ -130,8 +147,9 @@ void GalleryService::updateAlbum(const DbClientPtr &db, int albumId,
 void GalleryService::deleteAlbum(const DbClientPtr &db, int albumId,
                                   BoolCallback cb) {
     db->execSqlAsync(
-        "DELETE FROM gallery_albums WHERE id = $1",
-        [cb](const drogon::orm::Result &) {
+        "DELETE FROM gallery_albums WHERE id = $1 RETURNING tenant_id",
+        [cb](const drogon::orm::Result &result) {
+            purgeAlbumLists(result);
             cb(true, "");
         },
         [cb](const drogon::orm::DrogonDbException &e) {
@@ -150,8 +168,11 @@ void GalleryService::addPicture(const DbClientPtr &db, int albumId,
         "INSERT INTO gallery_pictures (album_id, display_name, description, "
         "file_uuid, user_id, is_private, created_at) "
         "VALUES ($1, $2, $3, $4, $5, false, NOW()) "
-        "RETURNING id",
+        "RETURNING id, "
+        "(SELECT a.tenant_id FROM gallery_albums a "
+        "WHERE a.id = gallery_pictures.album_id) AS tenant_id",
         [cb](const drogon::orm::Result &result) {
+            purgeAlbumLists(result);
             cb(true, "");
         },
         [cb](const drogon::orm::DrogonDbException &e) {
@@ -196,8 +217,11 @@ void GalleryService::updatePicture(const DbClientPtr &db, int pictureId,
 void GalleryService::deletePicture(const DbClientPtr &db, int pictureId,
                                     BoolCallback cb) {
     db->execSqlAsync(
-        "DELETE FROM gallery_pictures WHERE id = $1",
-        [cb](const drogon::orm::Result &) {
+        "DELETE FROM gallery_pictures WHERE id = $1 "
+        "RETURNING (SELECT a.tenant_id FROM gallery_albums a "
+        "WHERE a.id = gallery_pictures.album_id) AS tenant_id",
+        [cb](const drogon::orm::Result &result) {
+            purgeAlbumLists(result);
             cb(true, "");
         },
         [cb](const drogon::orm::DrogonDbException &e) {
@@ -210,8 +234,10 @@ void GalleryService::setDefaultPicture(const DbClientPtr &db, int albumId,
                                         int pictureId,
                                         BoolCallback cb) {
     db->execSqlAsync(
-        "UPDATE gallery_albums SET default_picture_id = $1 WHERE id = $2",
-        [cb](const drogon::orm::Result &) {
+        "UPDATE gallery_albums SET default_picture_id = $1 WHERE id = $2 "
+        "RETURNING tenant_id",
+        [cb](const drogon::orm::Result &result) {
+            purgeAlbumLists(result);
             cb(true, "");
         },
         [cb](const drogon::orm::DrogonDbException &e) {
@@ -1,7 +1,34 @@
 #include "services/GameDepService.h"
+#include "services/AutocompleteService.h"
+#include "services/CacheService.h"
+#include "services/ResponseCache.h"
+#include "services/ViewCountService.h"
 
 namespace pyracms {
 
+namespace {
+
+// Pages and revisions make up the cached /catalog response
+template <typename Callback>
+Callback purgeCatalogOnSuccess(Callback cb) {
+    return [cb = std::move(cb)](bool success, auto &&...rest) {
+        if (success) CacheService::instance().purgeResponses({ResponseCache::kCatalog});
+        cb(success, rest...);
+    };
+}
+
+// Page writes return id, name, display_name and view_count for autocomplete
+void autocompletePages(const drogon::orm::Result &result) {
+    for (const auto &row : result) {
+        AutocompleteService::instance().indexGameDep(
+            row["id"].as<int>(), row["name"].as<std::string>(),
+            row["display_name"].as<std::string>(),
+            row["view_count"].isNull() ? 0 : row["view_count"].as<int64_t>());
+    }
+}
+
+} // namespace
+
 GameDepPageDto GameDepService::rowToPageDto(const drogon::orm::Row &row) {
     GameDepPageDto dto;
     dto.id = row["id"].as<int>();
@@ -11,7 +38,9 @@ GameDepPageDto GameDepService::rowToPageDto(const drogon::orm::Row &row) {
     dto.displayName = row["display_name"].as<std::string>();
     dto.description = row["description"].isNull() ? "" : row["description"].as<std::string>();
     dto.createdAt = row["created_at"].as<std::string>();
-    dto.viewCount = row["view_count"].isNull() ? 0 : row["view_count"].as<int>();
+    dto.viewCount = (row["view_count"].isNull() ? 0 : row["view_count"].as<int>()) +
+                    static_cast<int>(ViewCountService::pending(ViewCounter::Table::GameDepPage,
+                                                               dto.id));
     return dto;
 }
 
@@ -57,11 +86,12 @@ ArchitectureDto GameDepService::rowToArchDto(const drogon::orm::Row &row) {
 
 void GameDepService::listPages(const DbClientPtr &db,
                                 const std::string &type,
-                                int limit, int offset,
+                                const PageRequest &page,
                                 PageListCallback cb) {
     db->execSqlAsync(
         "SELECT * FROM gamedep_pages WHERE type = $1 "
-        "ORDER BY created_at DESC LIMIT $2 OFFSET $3",
+        "AND (created_at, id) < ($2::timestamptz, $3::bigint) "
+        "ORDER BY created_at DESC, id DESC LIMIT $4 OFFSET $5",
         [this, cb](const drogon::orm::Result &result) {
             std::vector<GameDepPageDto> pages;
             pages.reserve(result.size());
@@ -73,7 +103,7 @@ void GameDepService::listPages(const DbClientPtr &db,
         [cb](const drogon::orm::DrogonDbException &) {
             cb({});
         },
-        type, limit, offset);
+        type, page.afterKey(), page.afterId(), page.limit, page.skip());
 }
 
 void GameDepService::createPage(const DbClientPtr &db,
@@ -83,11 +113,14 @@ void GameDepService::createPage(const DbClientPtr &db,
                                  const std::string &description,
                                  int ownerId,
                                  BoolCallback cb) {
+    cb = purgeCatalogOnSuccess(std::move(cb));
     db->execSqlAsync(
         "INSERT INTO gamedep_pages (type, name, display_name, description, "
         "owner_id, view_count, created_at) "
-        "VALUES ($1, $2, $3, $4, $5, 0, NOW()) RETURNING id",
-        [cb](const drogon::orm::Result &) {
+        "VALUES ($1, $2, $3, $4, $5, 0, NOW()) "
+        "RETURNING id, name, display_name, view_count",
+        [cb](const drogon::orm::Result &result) {
+            autocompletePages(result);
             cb(true, "");
         },
         [cb](const drogon::orm::DrogonDbException &e) {
@@ -133,19 +166,40 @@ void GameDepService::getPage(
         type, name);
 }
 
+void GameDepService::viewPage(
+    const DbClientPtr &db,
+    const std::string &type,
+    const std::string &name,
+    std::function<void(const std::optional<GameDepPageDto> &,
+                       const std::vector<GameDepRevisionDto> &)> cb) {
+    getPage(db, type, name,
+            [cb](std::optional<GameDepPageDto> page,
+                 const std::vector<GameDepRevisionDto> &revisions) {
+                if (page) {
+                    // Counted after the row was read, so add it here
+                    ViewCountService::record(ViewCounter::Table::GameDepPage, page->id);
+                    ++page->viewCount;
+                }
+                cb(page, revisions);
+            });
+}
+
 void GameDepService::updatePage(const DbClientPtr &db,
                                  const std::string &type,
                                  const std::string &name,
                                  const std::string &displayName,
                                  const std::string &description,
                                  BoolCallback cb) {
+    cb = purgeCatalogOnSuccess(std::move(cb));
     db->execSqlAsync(
         "UPDATE gamedep_pages SET display_name = $1, description = $2 "
-        "WHERE type = $3 AND name = $4",
+        "WHERE type = $3 AND name = $4 "
+        "RETURNING id, name, display_name, view_count",
         [cb](const drogon::orm::Result &result) {
             if (result.affectedRows() == 0) {
                 cb(false, "Page not found");
             } else {
+                autocompletePages(result);
                 cb(true, "");
             }
         },
@@ -159,12 +213,16 @@ void GameDepService::deletePage(const DbClientPtr &db,
                                  const std::string &type,
                                  const std::string &name,
                                  BoolCallback cb) {
+    cb = purgeCatalogOnSuccess(std::move(cb));
     db->execSqlAsync(
-        "DELETE FROM gamedep_pages WHERE type = $1 AND name = $2",
+        "DELETE FROM gamedep_pages WHERE type = $1 AND name = $2 RETURNING id",
         [cb](const drogon::orm::Result &result) {
             if (result.affectedRows() == 0) {
                 cb(false, "Page not found");
             } else {
+                for (const auto &row : result) {
+                    AutocompleteService::instance().removeGameDep(row["id"].as<int>());
+                }
                 cb(true, "");
             }
         },
@@ -179,6 +237,7 @@ void GameDepService::createRevision(const DbClientPtr &db,
                                      const std::string &version,
                                      const std::string &moduleType,
                                      IdCallback cb) {
+    cb = purgeCatalogOnSuccess(std::move(cb));
     db->execSqlAsync(
         "INSERT INTO gamedep_revisions (page_id, version, module_type, "
         "published, created_at) "
@@ -197,6 +256,7 @@ void GameDepService::updateRevision(const DbClientPtr &db,
                                      const std::string &version,
                                      const std::string &moduleType,
                                      BoolCallback cb) {
+    cb = purgeCatalogOnSuccess(std::move(cb));
     db->execSqlAsync(
         "UPDATE gamedep_revisions SET version = $1, module_type = $2 "
         "WHERE id = $3",
@@ -216,6 +276,7 @@ void GameDepService::updateRevision(const DbClientPtr &db,
 void GameDepService::deleteRevision(const DbClientPtr &db,
                                      int revisionId,
                                      BoolCallback cb) {
+    cb = purgeCatalogOnSuccess(std::move(cb));
     db->execSqlAsync(
         "DELETE FROM gamedep_revisions WHERE id = $1",
         [cb](const drogon::orm::Result &result) {
@@ -234,6 +295,7 @@ void GameDepService::deleteRevision(const DbClientPtr &db,
 void GameDepService::togglePublish(const DbClientPtr &db,
                                     int revisionId,
                                     BoolCallback cb) {
+    cb = purgeCatalogOnSuccess(std::move(cb));
     db->execSqlAsync(
         "UPDATE gamedep_revisions SET published = NOT published "
         "WHERE id = $1",
@@ -254,6 +316,7 @@ void GameDepService::uploadSource(const DbClientPtr &db,
                                    int revisionId,
                                    int fileId,
                                    BoolCallback cb) {
+    cb = purgeCatalogOnSuccess(std::move(cb));
     db->execSqlAsync(
         "UPDATE gamedep_revisions SET file_id = $1 WHERE id = $2",
         [cb](const drogon::orm::Result &result) {
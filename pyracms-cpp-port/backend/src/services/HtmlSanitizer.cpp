@@ -0,0 +1,372 @@
+#include "services/HtmlSanitizer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace pyracms {
+
+namespace {
+
+struct TagRule {
+    const char *name;
+    bool isVoid;
+    const char *attributes; // space separated
+};
+
+const TagRule kTags[] = {
+    {"a", false, "href title"},     {"abbr", false, "title"},
+    {"b", false, ""},               {"blockquote", false, "cite"},
+    {"br", true, ""},               {"code", false, "class"},
+    {"dd", false, ""},              {"del", false, ""},
+    {"details", false, ""},         {"div", false, ""},
+    {"dl", false, ""},              {"dt", false, ""},
+    {"em", false, ""},              {"figcaption", false, ""},
+    {"figure", false, ""},          {"h1", false, ""},
+    {"h2", false, ""},              {"h3", false, ""},
+    {"h4", false, ""},              {"h5", false, ""},
+    {"h6", false, ""},              {"hr", true, ""},
+    {"i", false, ""},               {"img", true, "src alt title width height"},
+    {"ins", false, ""},             {"kbd", false, ""},
+    {"li", false, ""},              {"mark", false, ""},
+    {"ol", false, "start"},         {"p", false, ""},
+    {"pre", false, ""},             {"q", false, "cite"},
+    {"s", false, ""},               {"samp", false, ""},
+    {"small", false, ""},           {"span", false, ""},
+    {"strong", false, ""},          {"sub", false, ""},
+    {"summary", false, ""},         {"sup", false, ""},
+    {"table", false, ""},           {"tbody", false, ""},
+    {"td", false, "colspan rowspan"}, {"tfoot", false, ""},
+    {"th", false, "colspan rowspan"}, {"thead", false, ""},
+    {"tr", false, ""},              {"u", false, ""},
+    {"ul", false, ""},
+};
+
+// Elements whose content is never text a reader should see
+const char *kDroppedWithContent[] = {
+    "script", "style", "iframe", "object", "embed", "noscript", "noembed", "noframes",
+    "template", "textarea", "select", "title", "svg", "math", "head", "xmp", "plaintext",
+};
+
+bool isAlpha(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f'; }
+char lower(char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; }
+
+bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) { return lower(x) == y; });
+}
+
+const TagRule *findTag(std::string_view name) {
+    for (const auto &rule : kTags) {
+        if (name == rule.name) return &rule;
+    }
+    return nullptr;
+}
+
+bool droppedWithContent(std::string_view name) {
+    return std::any_of(std::begin(kDroppedWithContent), std::end(kDroppedWithContent),
+                       [&](const char *tag) { return name == tag; });
+}
+
+bool allowsAttribute(const TagRule &rule, std::string_view name) {
+    std::string_view list = rule.attributes;
+    while (!list.empty()) {
+        size_t space = list.find(' ');
+        if (list.substr(0, space) == name) return true;
+        if (space == std::string_view::npos) break;
+        list.remove_prefix(space + 1);
+    }
+    return false;
+}
+
+// Length of an entity or numeric character reference at s[pos] ('&'), or 0
+size_t entityLength(std::string_view s, size_t pos) {
+    size_t i = pos + 1;
+    if (i < s.size() && s[i] == '#') {
+        ++i;
+        bool hex = i < s.size() && (s[i] == 'x' || s[i] == 'X');
+        if (hex) ++i;
+        size_t start = i;
+        while (i < s.size() && (hex ? std::isxdigit(static_cast<unsigned char>(s[i])) != 0
+                                    : isDigit(s[i]))) {
+            ++i;
+        }
+        if (i == start || i - start > (hex ? 6u : 7u)) return 0;
+    } else {
+        size_t start = i;
+        while (i < s.size() && (isAlpha(s[i]) || isDigit(s[i]))) ++i;
+        if (i == start || i - start > 32 || !isAlpha(s[start])) return 0;
+    }
+    return i < s.size() && s[i] == ';' ? i + 1 - pos : 0;
+}
+
+void appendUtf8(std::string &out, uint32_t cp) {
+    if (cp == 0 || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) cp = 0xFFFD;
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+void escapeAttribute(std::string &out, std::string_view value) {
+    for (char c : value) {
+        switch (c) {
+        case '&': out += "&amp;"; break;
+        case '<': out += "&lt;"; break;
+        case '>': out += "&gt;"; break;
+        case '"': out += "&quot;"; break;
+        default: out += c;
+        }
+    }
+}
+
+// Text is copied with its character references; a bare & or angle bracket
+// is escaped
+void appendText(std::string &out, std::string_view text) {
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c == '&') {
+            if (size_t length = entityLength(text, i)) {
+                out.append(text.substr(i, length));
+                i += length - 1;
+            } else {
+                out += "&amp;";
+            }
+        } else if (c == '<') {
+            out += "&lt;";
+        } else if (c == '>') {
+            out += "&gt;";
+        } else {
+            out += c;
+        }
+    }
+}
+
+struct Tag {
+    std::string name;
+    bool closing = false;
+    std::vector<std::pair<std::string, std::string>> attributes;
+    size_t end = 0;
+};
+
+// A start or end tag at s[pos] ('<'); false when s[pos] does not begin one
+bool parseTag(std::string_view s, size_t pos, Tag &tag) {
+    size_t i = pos + 1;
+    if (i < s.size() && s[i] == '/') {
+        tag.closing = true;
+        ++i;
+    }
+    if (i >= s.size() || !isAlpha(s[i])) return false;
+    while (i < s.size() && (isAlpha(s[i]) || isDigit(s[i]) || s[i] == '-')) tag.name += lower(s[i++]);
+    while (true) {
+        while (i < s.size() && (isSpace(s[i]) || s[i] == '/')) ++i;
+        if (i >= s.size()) return false;
+        if (s[i] == '>') {
+            tag.end = i + 1;
+            return true;
+        }
+        std::string name;
+        while (i < s.size() && !isSpace(s[i]) && s[i] != '/' && s[i] != '>' &&
+               (s[i] != '=' || name.empty())) {
+            name += lower(s[i++]);
+        }
+        while (i < s.size() && isSpace(s[i])) ++i;
+        std::string value;
+        if (i < s.size() && s[i] == '=') {
+            ++i;
+            while (i < s.size() && isSpace(s[i])) ++i;
+            if (i < s.size() && (s[i] == '"' || s[i] == '\'')) {
+                size_t close = s.find(s[i], i + 1);
+                if (close == std::string_view::npos) return false;
+                value = std::string(s.substr(i + 1, close - i - 1));
+                i = close + 1;
+            } else {
+                size_t start = i;
+                while (i < s.size() && !isSpace(s[i]) && s[i] != '>') ++i;
+                value = std::string(s.substr(start, i - start));
+            }
+        }
+        tag.attributes.emplace_back(std::move(name), std::move(value));
+    }
+}
+
+// Position after the end tag that closes a dropped element, or the end of
+// the input
+size_t skipElement(std::string_view s, size_t from, std::string_view name) {
+    for (size_t i = s.find("</", from); i != std::string_view::npos; i = s.find("</", i + 2)) {
+        size_t after = i + 2 + name.size();
+        if (after > s.size() || !iequals(s.substr(i + 2, name.size()), name)) continue;
+        if (after < s.size() && !isSpace(s[after]) && s[after] != '>' && s[after] != '/') continue;
+        size_t close = s.find('>', after);
+        return close == std::string_view::npos ? s.size() : close + 1;
+    }
+    return s.size();
+}
+
+bool allDigits(std::string_view value) {
+    return !value.empty() && value.size() <= 9 && std::all_of(value.begin(), value.end(), isDigit);
+}
+
+bool isLanguageClass(std::string_view value) {
+    constexpr std::string_view prefix = "language-";
+    if (value.size() <= prefix.size() || value.substr(0, prefix.size()) != prefix) return false;
+    return std::all_of(value.begin() + prefix.size(), value.end(), [](char c) {
+        return isAlpha(c) || isDigit(c) || c == '-' || c == '_' || c == '+' || c == '#' || c == '.';
+    });
+}
+
+void appendOpenTag(std::string &out, const TagRule &rule, const Tag &tag) {
+    out += '<';
+    out += rule.name;
+    for (const auto &[name, raw] : tag.attributes) {
+        if (!allowsAttribute(rule, name)) continue;
+        auto value = HtmlSanitizer::decodeEntities(raw);
+        bool ok = true;
+        if (name == "href" || name == "src" || name == "cite") {
+            ok = HtmlSanitizer::isSafeUrl(value);
+        } else if (name == "class") {
+            ok = isLanguageClass(value);
+        } else if (name == "width" || name == "height" || name == "colspan" ||
+                   name == "rowspan" || name == "start") {
+            ok = allDigits(value);
+        }
+        if (!ok) continue;
+        out += ' ';
+        out += name;
+        out += "=\"";
+        escapeAttribute(out, value);
+        out += '"';
+    }
+    if (std::strcmp(rule.name, "a") == 0) out += " rel=\"nofollow noopener\"";
+    out += rule.isVoid ? " />" : ">";
+}
+
+} // namespace
+
+bool HtmlSanitizer::isSafeUrl(std::string_view url) {
+    // Browsers ignore whitespace and control characters inside a scheme
+    std::string cleaned;
+    for (char c : url) {
+        if (static_cast<unsigned char>(c) > 0x20 && c != 0x7F) cleaned += lower(c);
+    }
+    size_t end = cleaned.find_first_of(":/?#");
+    if (end == std::string::npos || cleaned[end] != ':') return true;
+    auto scheme = std::string_view(cleaned).substr(0, end);
+    return scheme == "http" || scheme == "https" || scheme == "mailto";
+}
+
+std::string HtmlSanitizer::decodeEntities(std::string_view s) {
+    static const std::pair<const char *, const char *> named[] = {
+        {"amp", "&"},   {"lt", "<"},    {"gt", ">"},     {"quot", "\""},   {"apos", "'"},
+        {"colon", ":"}, {"tab", "\t"},  {"newline", "\n"}, {"nbsp", "\xC2\xA0"},
+    };
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        size_t length = s[i] == '&' ? entityLength(s, i) : 0;
+        if (length == 0) {
+            out += s[i];
+            continue;
+        }
+        auto body = s.substr(i + 1, length - 2);
+        if (body[0] == '#') {
+            bool hex = body.size() > 1 && (body[1] == 'x' || body[1] == 'X');
+            uint32_t cp = 0;
+            for (char c : body.substr(hex ? 2 : 1)) {
+                uint32_t digit = isDigit(c) ? static_cast<uint32_t>(c - '0')
+                                            : static_cast<uint32_t>(lower(c) - 'a' + 10);
+                cp = cp * (hex ? 16 : 10) + digit;
+            }
+            appendUtf8(out, cp);
+        } else {
+            auto match = std::find_if(std::begin(named), std::end(named),
+                                      [&](const auto &entry) { return iequals(body, entry.first); });
+            if (match == std::end(named)) {
+                out.append(s.substr(i, length));
+            } else {
+                out += match->second;
+            }
+        }
+        i += length - 1;
+    }
+    return out;
+}
+
+std::string HtmlSanitizer::sanitize(std::string_view html) {
+    std::string out;
+    out.reserve(html.size());
+    std::vector<const TagRule *> open;
+    size_t i = 0;
+    while (i < html.size()) {
+        size_t lt = html.find('<', i);
+        if (lt == std::string_view::npos) lt = html.size();
+        appendText(out, html.substr(i, lt - i));
+        if (lt == html.size()) break;
+        i = lt;
+
+        if (html.compare(i, 4, "<!--") == 0) {
+            size_t close = html.find("-->", i + 4);
+            i = close == std::string_view::npos ? html.size() : close + 3;
+            continue;
+        }
+        if (i + 1 < html.size() && (html[i + 1] == '!' || html[i + 1] == '?')) {
+            size_t close = html.find('>', i);
+            i = close == std::string_view::npos ? html.size() : close + 1;
+            continue;
+        }
+        Tag tag;
+        if (!parseTag(html, i, tag)) {
+            out += "&lt;";
+            ++i;
+            continue;
+        }
+        i = tag.end;
+        if (droppedWithContent(tag.name)) {
+            if (!tag.closing) i = skipElement(html, i, tag.name);
+            continue;
+        }
+        const TagRule *rule = findTag(tag.name);
+        if (!rule) continue;
+        if (!tag.closing) {
+            appendOpenTag(out, *rule, tag);
+            if (!rule->isVoid) open.push_back(rule);
+            continue;
+        }
+        // An end tag closes its element and anything left open inside it;
+        // a stray one is dropped
+        auto match = std::find(open.rbegin(), open.rend(), rule);
+        if (match == open.rend()) continue;
+        size_t keep = static_cast<size_t>(open.rend() - match) - 1;
+        while (open.size() > keep) {
+            out += "</";
+            out += open.back()->name;
+            out += '>';
+            open.pop_back();
+        }
+    }
+    while (!open.empty()) {
+        out += "</";
+        out += open.back()->name;
+        out += '>';
+        open.pop_back();
+    }
+    return out;
+}
+
+} // namespace pyracms
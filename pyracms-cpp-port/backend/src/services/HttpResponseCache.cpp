@@ -0,0 +1,103 @@
+#include "services/HttpResponseCache.h"
+#include "services/ResponseCache.h"
+
+#include <unordered_map>
+
+namespace pyracms {
+
+namespace {
+
+// Per-thread rendered responses; rebuilt when the shared entry changes
+constexpr size_t kMaxThreadEntries = 1024;
+
+struct Materialized {
+    ResponseCache::Entry entry;
+    drogon::HttpResponsePtr response;
+};
+
+bool cacheable(const drogon::HttpRequestPtr &req) {
+    return ResponseCache::instance().enabled() && req->getHeader("Authorization").empty();
+}
+
+drogon::HttpResponsePtr materialize(const CachedResponse &cached) {
+    auto resp = drogon::HttpResponse::newHttpResponse();
+    resp->setStatusCode(static_cast<drogon::HttpStatusCode>(cached.status));
+    resp->setContentTypeString(cached.contentType);
+    for (const auto &[name, value] : cached.headers) {
+        resp->addHeader(name, value);
+    }
+    resp->setBody(cached.body);
+    resp->setExpiredTime(0);
+    return resp;
+}
+
+} // namespace
+
+std::string HttpResponseCache::keyFor(const drogon::HttpRequestPtr &req, int tenantId) {
+    std::vector<std::pair<std::string, std::string>> params;
+    for (const auto &[name, value] : req->getParameters()) {
+        params.emplace_back(name, value);
+    }
+    return ResponseCache::makeKey(req->path(), tenantId, std::move(params));
+}
+
+bool HttpResponseCache::serve(const drogon::HttpRequestPtr &req, const std::string &key,
+                              const Callback &callback, int64_t *tag) {
+    if (!cacheable(req)) return false;
+    auto entry = ResponseCache::instance().get(key);
+    if (!entry) return false;
+    if (tag) *tag = entry->tag;
+
+    thread_local std::unordered_map<std::string, Materialized> responses;
+    auto &slot = responses[key];
+    if (slot.entry != entry) {
+        if (responses.size() > kMaxThreadEntries) {
+            responses.clear();
+            return serve(req, key, callback, tag);
+        }
+        slot.entry = entry;
+        slot.response = materialize(*entry);
+    }
+    callback(slot.response);
+    return true;
+}
+
+HttpResponseCache::Callback HttpResponseCache::storing(
+    const drogon::HttpRequestPtr &req, std::string key,
+    const std::vector<std::string> &surrogateKeys, int ttlSeconds, Callback callback) {
+    if (!cacheable(req)) return callback;
+    auto send = storingTagged(req, std::move(key), surrogateKeys, ttlSeconds, std::move(callback));
+    return [send = std::move(send)](const drogon::HttpResponsePtr &resp) { send(resp, 0); };
+}
+
+HttpResponseCache::TaggedCallback HttpResponseCache::storingTagged(
+    const drogon::HttpRequestPtr &req, std::string key,
+    const std::vector<std::string> &surrogateKeys, int ttlSeconds, Callback callback) {
+    if (!cacheable(req)) {
+        return [callback = std::move(callback)](const drogon::HttpResponsePtr &resp, int64_t) {
+            callback(resp);
+        };
+    }
+
+    auto stamps = ResponseCache::instance().stamp(surrogateKeys);
+    return [key = std::move(key), stamps = std::move(stamps), ttlSeconds,
+            callback = std::move(callback)](const drogon::HttpResponsePtr &resp, int64_t tag) {
+        if (resp->statusCode() == drogon::k200OK) {
+            CachedResponse cached;
+            cached.status = static_cast<int>(resp->statusCode());
+            cached.contentType = std::string(resp->contentTypeString());
+            // Headers the handler set, such as X-Next-Cursor on list pages
+            for (const auto &[name, value] : resp->headers()) {
+                cached.headers.emplace_back(name, value);
+            }
+            cached.body = std::string(resp->body());
+            cached.stamps = stamps;
+            cached.tag = tag;
+            ResponseCache::instance().put(key, std::move(cached),
+                                          std::chrono::seconds(ttlSeconds));
+        }
+        callback(resp);
+    };
+}
+
+} // namespace pyracms
@@ -0,0 +1,57 @@
+#include "services/InvalidationBus.h"
+
+#include <sstream>
+
+namespace pyracms {
+
+// Wire format: "K <origin> <key>", "S <origin> <surrogate key>" or
+// "G <origin> <tenant> <ns> <generation>". The key is last so it may contain spaces (search keys embed the query).
+std::string InvalidationMessage::encode() const {
+    if (kind == Kind::Key) {
+        return "K " + origin + " " + key;
+    }
+    if (kind == Kind::Surrogate) {
+        return "S " + origin + " " + key;
+    }
+    return "G " + origin + " " + std::to_string(tenantId) + " " + std::to_string(ns) + " " +
+           std::to_string(generation);
+}
+
+std::optional<InvalidationMessage> InvalidationMessage::decode(const std::string &wire) {
+    if (wire.size() < 4 || wire[1] != ' ') return std::nullopt;
+    auto originEnd = wire.find(' ', 2);
+    if (originEnd == std::string::npos) return std::nullopt;
+
+    InvalidationMessage msg;
+    msg.origin = wire.substr(2, originEnd - 2);
+    if (wire[0] == 'K' || wire[0] == 'S') {
+        msg.kind = wire[0] == 'K' ? Kind::Key : Kind::Surrogate;
+        msg.key = wire.substr(originEnd + 1);
+        return msg.key.empty() ? std::nullopt : std::optional<InvalidationMessage>(msg);
+    }
+    if (wire[0] == 'G') {
+        msg.kind = Kind::Generation;
+        std::istringstream rest(wire.substr(originEnd + 1));
+        if (!(rest >> msg.tenantId >> msg.ns >> msg.generation)) return std::nullopt;
+        return msg;
+    }
+    return std::nullopt;
+}
+
+void LocalInvalidationBus::publish(const std::string &message) {
+    std::vector<Handler> handlers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        handlers = handlers_;
+    }
+    for (const auto &handler : handlers) {
+        handler(message);
+    }
+}
+
+void LocalInvalidationBus::subscribe(Handler handler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    handlers_.push_back(std::move(handler));
+}
+
+} // namespace pyracms
@@ -0,0 +1,103 @@
+#include "services/LocalCache.h"
+
+#include <functional>
+
+namespace pyracms {
+
+LocalCache::LocalCache(size_t byteBudget, size_t shardCount)
+    : byteBudget_(byteBudget), shardBudget_(byteBudget / (shardCount ? shardCount : 1)) {
+    if (shardCount == 0) shardCount = 1;
+    shards_.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+LocalCache::Shard &LocalCache::shardFor(const std::string &key) {
+    return *shards_[std::hash<std::string>{}(key) % shards_.size()];
+}
+
+void LocalCache::Shard::unlink(std::list<Entry>::iterator it) {
+    bytes -= it->charge;
+    index.erase(std::string_view(it->key));
+    lru.erase(it);
+}
+
+LocalCache::Value LocalCache::get(const std::string &key) {
+    auto &shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mu);
+    auto found = shard.index.find(std::string_view(key));
+    if (found == shard.index.end()) {
+        ++shard.misses;
+        return nullptr;
+    }
+    auto it = found->second;
+    if (Clock::now() >= it->expiresAt) {
+        shard.unlink(it);
+        ++shard.expirations;
+        ++shard.misses;
+        return nullptr;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, it);
+    ++shard.hits;
+    return it->value;
+}
+
+LocalCache::Value LocalCache::put(const std::string &key, std::string value,
+                                  std::chrono::milliseconds ttl) {
+    auto stored = std::make_shared<const std::string>(std::move(value));
+    size_t charge = key.size() + stored->size() + kEntryOverhead;
+    if (charge > shardBudget_ || ttl.count() <= 0) {
+        erase(key);
+        return stored;
+    }
+
+    auto &shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mu);
+    auto found = shard.index.find(std::string_view(key));
+    if (found != shard.index.end()) {
+        shard.unlink(found->second);
+    }
+    while (shard.bytes + charge > shardBudget_ && !shard.lru.empty()) {
+        shard.unlink(std::prev(shard.lru.end()));
+        ++shard.evictions;
+    }
+    shard.lru.push_front(Entry{key, stored, Clock::now() + ttl, charge});
+    shard.index.emplace(std::string_view(shard.lru.front().key), shard.lru.begin());
+    shard.bytes += charge;
+    return stored;
+}
+
+void LocalCache::erase(const std::string &key) {
+    auto &shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mu);
+    auto found = shard.index.find(std::string_view(key));
+    if (found != shard.index.end()) {
+        shard.unlink(found->second);
+    }
+}
+
+void LocalCache::clear() {
+    for (auto &shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mu);
+        shard->index.clear();
+        shard->lru.clear();
+        shard->bytes = 0;
+    }
+}
+
+LocalCache::Stats LocalCache::stats() const {
+    Stats total;
+    for (const auto &shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mu);
+        total.hits += shard->hits;
+        total.misses += shard->misses;
+        total.evictions += shard->evictions;
+        total.expirations += shard->expirations;
+        total.entries += shard->lru.size();
+        total.bytes += shard->bytes;
+    }
+    return total;
+}
+
+} // namespace pyracms
@@ -0,0 +1,1377 @@
+#include "services/MarkdownRenderer.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace pyracms {
+
+namespace {
+
+// Block quotes and lists nested deeper than this are read as text, which
+// bounds the recursion when rendering
+constexpr int kMaxNesting = 64;
+
+bool isSpaceChar(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+bool isPunct(char c) {
+    return std::strchr("!\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~", c) != nullptr && c != '\0';
+}
+
+bool isAlpha(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+bool isAlnum(char c) { return isAlpha(c) || isDigit(c); }
+
+bool isBlank(std::string_view s) {
+    return std::all_of(s.begin(), s.end(), [](char c) { return c == ' ' || c == '\t'; });
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && isSpaceChar(s.front())) s.remove_prefix(1);
+    while (!s.empty() && isSpaceChar(s.back())) s.remove_suffix(1);
+    return s;
+}
+
+char lower(char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; }
+
+void escapeHtml(std::string &out, std::string_view text) {
+    for (char c : text) {
+        switch (c) {
+        case '&': out += "&amp;"; break;
+        case '<': out += "&lt;"; break;
+        case '>': out += "&gt;"; break;
+        case '"': out += "&quot;"; break;
+        default: out += c;
+        }
+    }
+}
+
+// Percent-encodes what may not appear in a URL, as cmark does, and escapes
+// it for an attribute
+void escapeHref(std::string &out, std::string_view url) {
+    static const char *hex = "0123456789ABCDEF";
+    for (unsigned char c : url) {
+        if (isAlnum(static_cast<char>(c)) || std::strchr("-_.+!*(),%#@?=;:/$~", c)) {
+            out += static_cast<char>(c);
+        } else if (c == '&') {
+            out += "&amp;";
+        } else if (c == '\'') {
+            out += "&#x27;";
+        } else {
+            out += '%';
+            out += hex[c >> 4];
+            out += hex[c & 15];
+        }
+    }
+}
+
+std::string expandTabs(std::string_view line) {
+    std::string out;
+    out.reserve(line.size());
+    for (char c : line) {
+        if (c == '\t') {
+            out.append(4 - out.size() % 4, ' ');
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+// Length of an entity or numeric character reference at s[pos] ('&'), or 0
+size_t entityLength(std::string_view s, size_t pos) {
+    size_t i = pos + 1;
+    if (i < s.size() && s[i] == '#') {
+        ++i;
+        bool hexRef = i < s.size() && (s[i] == 'x' || s[i] == 'X');
+        if (hexRef) ++i;
+        size_t start = i;
+        while (i < s.size() && (hexRef ? std::isxdigit(static_cast<unsigned char>(s[i])) != 0
+                                       : isDigit(s[i]))) {
+            ++i;
+        }
+        size_t digits = i - start;
+        if (digits == 0 || digits > (hexRef ? 6u : 7u)) return 0;
+    } else {
+        size_t start = i;
+        while (i < s.size() && isAlnum(s[i])) ++i;
+        if (i == start || i - start > 32 || !isAlpha(s[start])) return 0;
+    }
+    return i < s.size() && s[i] == ';' ? i + 1 - pos : 0;
+}
+
+// Backslash escapes resolved; entities are left for the browser
+std::string unescape(std::string_view s) {
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '\\' && i + 1 < s.size() && isPunct(s[i + 1])) ++i;
+        out += s[i];
+    }
+    return out;
+}
+
+// Escapes text that may hold entity references, keeping those intact
+void escapeKeepingEntities(std::string &out, std::string_view s) {
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '&') {
+            if (size_t n = entityLength(s, i)) {
+                out.append(s.substr(i, n));
+                i += n - 1;
+                continue;
+            }
+        }
+        escapeHtml(out, s.substr(i, 1));
+    }
+}
+
+std::string normalizeLabel(std::string_view label) {
+    std::string out;
+    bool space = false;
+    for (char c : trim(label)) {
+        if (isSpaceChar(c)) {
+            space = true;
+            continue;
+        }
+        if (space) out += ' ';
+        space = false;
+        out += lower(c);
+    }
+    return out;
+}
+
+// ── Raw HTML ─────────────────────────────────────────────────────────────────
+
+size_t skipSpaces(std::string_view s, size_t i) {
+    while (i < s.size() && isSpaceChar(s[i])) ++i;
+    return i;
+}
+
+// Length of the open tag, closing tag, comment, processing instruction,
+// declaration or CDATA section at s[pos] ('<'), or 0
+size_t htmlTagLength(std::string_view s, size_t pos) {
+    size_t i = pos + 1;
+    if (i >= s.size()) return 0;
+    auto find = [&](std::string_view end, size_t from) -> size_t {
+        size_t at = s.find(end, from);
+        return at == std::string_view::npos ? 0 : at + end.size() - pos;
+    };
+    if (s.compare(i, 3, "!--") == 0) {
+        if (s.compare(i + 3, 1, ">") == 0 || s.compare(i + 3, 2, "->") == 0) return 0;
+        return find("-->", i + 3);
+    }
+    if (s.compare(i, 8, "![CDATA[") == 0) return find("]]>", i + 8);
+    if (s[i] == '?') return find("?>", i + 1);
+    if (s[i] == '!') return i + 1 < s.size() && isAlpha(s[i + 1]) ? find(">", i + 1) : 0;
+
+    bool closing = s[i] == '/';
+    if (closing) ++i;
+    if (i >= s.size() || !isAlpha(s[i])) return 0;
+    while (i < s.size() && (isAlnum(s[i]) || s[i] == '-')) ++i;
+    if (closing) {
+        i = skipSpaces(s, i);
+        return i < s.size() && s[i] == '>' ? i + 1 - pos : 0;
+    }
+    while (true) {
+        size_t afterSpace = skipSpaces(s, i);
+        if (afterSpace >= s.size()) return 0;
+        if (s[afterSpace] == '>') return afterSpace + 1 - pos;
+        if (s.compare(afterSpace, 2, "/>") == 0) return afterSpace + 2 - pos;
+        // An attribute needs whitespace before it
+        if (afterSpace == i) return 0;
+        i = afterSpace;
+        char c = s[i];
+        if (!(isAlpha(c) || c == '_' || c == ':')) return 0;
+        while (i < s.size() && (isAlnum(s[i]) || std::strchr("_.:-", s[i]))) ++i;
+        size_t valueStart = skipSpaces(s, i);
+        if (valueStart < s.size() && s[valueStart] == '=') {
+            i = skipSpaces(s, valueStart + 1);
+            if (i >= s.size()) return 0;
+            if (s[i] == '"' || s[i] == '\'') {
+                size_t close = s.find(s[i], i + 1);
+                if (close == std::string_view::npos) return 0;
+                i = close + 1;
+            } else {
+                size_t start = i;
+                while (i < s.size() && !isSpaceChar(s[i]) && !std::strchr("\"'=<>`", s[i])) ++i;
+                if (i == start) return 0;
+            }
+        }
+    }
+}
+
+bool startsHtmlBlock(std::string_view line, size_t pos, bool interruptsParagraph) {
+    static const char *blockTags[] = {
+        "address", "article", "aside", "base", "basefont", "blockquote", "body", "caption",
+        "center", "col", "colgroup", "dd", "details", "dialog", "dir", "div", "dl", "dt",
+        "fieldset", "figcaption", "figure", "footer", "form", "frame", "frameset", "h1", "h2",
+        "h3", "h4", "h5", "h6", "head", "header", "hr", "html", "iframe", "legend", "li",
+        "link", "main", "menu", "menuitem", "nav", "noframes", "ol", "optgroup", "option", "p",
+        "param", "pre", "script", "section", "source", "style", "summary", "table", "tbody",
+        "td", "textarea", "tfoot", "th", "thead", "title", "tr", "track", "ul"};
+    if (pos >= line.size() || line[pos] != '<') return false;
+    size_t i = pos + 1;
+    if (i < line.size() && (line[i] == '!' || line[i] == '?')) return true;
+    if (i < line.size() && line[i] == '/') ++i;
+    size_t start = i;
+    while (i < line.size() && isAlnum(line[i])) ++i;
+    if (i == start) return false;
+    std::string name;
+    for (size_t k = start; k < i; ++k) name += lower(line[k]);
+    bool boundary = i == line.size() || line[i] == ' ' || line[i] == '>' ||
+                    line.compare(i, 2, "/>") == 0;
+    if (boundary) {
+        for (const char *tag : blockTags) {
+            if (name == tag) return true;
+        }
+    }
+    // Any other complete tag alone on its line, unless it would cut a
+    // paragraph short
+    if (interruptsParagraph) return false;
+    size_t length = htmlTagLength(line, pos);
+    return length > 0 && isBlank(line.substr(pos + length));
+}
+
+// ── Links ────────────────────────────────────────────────────────────────────
+
+struct Reference {
+    std::string url;
+    std::string title;
+};
+using References = std::unordered_map<std::string, Reference>;
+
+// [label] at s[pos]; on success pos is past the closing bracket
+bool parseLinkLabel(std::string_view s, size_t &pos, std::string_view &label) {
+    if (pos >= s.size() || s[pos] != '[') return false;
+    size_t i = pos + 1;
+    while (i < s.size() && i - pos <= 1000) {
+        if (s[i] == '\\' && i + 1 < s.size()) {
+            i += 2;
+            continue;
+        }
+        if (s[i] == '[') return false;
+        if (s[i] == ']') {
+            label = s.substr(pos + 1, i - pos - 1);
+            pos = i + 1;
+            return true;
+        }
+        ++i;
+    }
+    return false;
+}
+
+bool parseLinkDestination(std::string_view s, size_t &pos, std::string &url) {
+    size_t i = pos;
+    if (i < s.size() && s[i] == '<') {
+        ++i;
+        while (i < s.size() && s[i] != '>' && s[i] != '<' && s[i] != '\n') {
+            if (s[i] == '\\' && i + 1 < s.size()) ++i;
+            ++i;
+        }
+        if (i >= s.size() || s[i] != '>') return false;
+        url = unescape(s.substr(pos + 1, i - pos - 1));
+        pos = i + 1;
+        return true;
+    }
+    int depth = 0;
+    while (i < s.size() && !isSpaceChar(s[i]) && static_cast<unsigned char>(s[i]) >= 0x20) {
+        if (s[i] == '\\' && i + 1 < s.size() && isPunct(s[i + 1])) {
+            i += 2;
+            continue;
+        }
+        if (s[i] == '(') {
+            if (++depth > 32) return false;
+        } else if (s[i] == ')') {
+            if (depth == 0) break;
+            --depth;
+        }
+        ++i;
+    }
+    if (i == pos || depth != 0) return false;
+    url = unescape(s.substr(pos, i - pos));
+    pos = i;
+    return true;
+}
+
+bool parseLinkTitle(std::string_view s, size_t &pos, std::string &title) {
+    if (pos >= s.size()) return false;
+    char open = s[pos];
+    char close = open == '(' ? ')' : open;
+    if (open != '"' && open != '\'' && open != '(') return false;
+    size_t i = pos + 1;
+    while (i < s.size() && s[i] != close) {
+        if (s[i] == '\\' && i + 1 < s.size()) ++i;
+        else if (open == '(' && s[i] == '(') return false;
+        ++i;
+    }
+    if (i >= s.size()) return false;
+    title = unescape(s.substr(pos + 1, i - pos - 1));
+    pos = i + 1;
+    return true;
+}
+
+// Skips spaces and at most one line ending
+size_t skipSpacesAndNewline(std::string_view s, size_t i) {
+    while (i < s.size() && (s[i] == ' ' || s[i] == '\t')) ++i;
+    if (i < s.size() && s[i] == '\n') ++i;
+    while (i < s.size() && (s[i] == ' ' || s[i] == '\t')) ++i;
+    return i;
+}
+
+// Reads one link reference definition from the start of a paragraph;
+// returns the bytes consumed, or 0
+size_t parseReference(std::string_view s, References &refs) {
+    size_t pos = 0;
+    std::string_view label;
+    if (!parseLinkLabel(s, pos, label) || pos >= s.size() || s[pos] != ':') return 0;
+    auto key = normalizeLabel(label);
+    if (key.empty()) return 0;
+    pos = skipSpacesAndNewline(s, pos + 1);
+    std::string url;
+    if (!parseLinkDestination(s, pos, url)) return 0;
+
+    auto lineEnd = [&](size_t i) -> size_t {
+        while (i < s.size() && (s[i] == ' ' || s[i] == '\t')) ++i;
+        if (i == s.size()) return i;
+        return s[i] == '\n' ? i + 1 : std::string_view::npos;
+    };
+    size_t beforeTitle = pos;
+    size_t titleStart = skipSpacesAndNewline(s, pos);
+    std::string title;
+    size_t end = std::string_view::npos;
+    if (titleStart > beforeTitle && parseLinkTitle(s, titleStart, title)) {
+        end = lineEnd(titleStart);
+    }
+    if (end == std::string_view::npos) {
+        // The title is not valid, or not alone on its line: without one
+        title.clear();
+        end = lineEnd(beforeTitle);
+        if (end == std::string_view::npos) return 0;
+    }
+    refs.emplace(key, Reference{std::move(url), std::move(title)});
+    return end;
+}
+
+// ── Inlines ──────────────────────────────────────────────────────────────────
+
+struct Inline {
+    enum Kind { Text, Code, Html, SoftBreak, HardBreak, Emph, Strong, Link, Image };
+    Kind kind = Text;
+    std::string text;
+    std::string url;
+    std::string title;
+    std::list<Inline> children;
+};
+using Inlines = std::list<Inline>;
+
+class InlineParser {
+public:
+    InlineParser(std::string_view text, const References &refs) : s_(text), refs_(refs) {}
+
+    Inlines parse() {
+        while (pos_ < s_.size()) {
+            char c = s_[pos_];
+            switch (c) {
+            case '\n': lineBreak(); break;
+            case '\\': backslash(); break;
+            case '`': codeSpan(); break;
+            case '*':
+            case '_': delimiterRun(c); break;
+            case '[':
+                openBracket(false, 1);
+                break;
+            case '!':
+                if (pos_ + 1 < s_.size() && s_[pos_ + 1] == '[') {
+                    openBracket(true, 2);
+                } else {
+                    addText(std::string(1, c));
+                    ++pos_;
+                }
+                break;
+            case ']': closeBracket(); break;
+            case '<': angle(); break;
+            case '&': entity(); break;
+            default: plainText(); break;
+            }
+        }
+        processEmphasis(0);
+        return std::move(out_);
+    }
+
+private:
+    struct Delimiter {
+        Inlines::iterator node;
+        char ch;
+        int count;
+        int origCount;
+        bool canOpen;
+        bool canClose;
+    };
+
+    struct Bracket {
+        Inlines::iterator node;
+        bool image;
+        bool active;
+        size_t delimiters; // delimiters below this bracket
+        size_t textStart;  // first byte of the link text
+    };
+
+    Inlines::iterator addText(std::string text) {
+        out_.push_back(Inline{Inline::Text, std::move(text), {}, {}, {}});
+        return std::prev(out_.end());
+    }
+
+    void add(Inline::Kind kind, std::string text = {}) {
+        out_.push_back(Inline{kind, std::move(text), {}, {}, {}});
+    }
+
+    void plainText() {
+        size_t start = pos_;
+        while (pos_ < s_.size() && !std::strchr("\n\\`*_[!]<&", s_[pos_])) ++pos_;
+        if (pos_ == start) ++pos_;
+        addText(std::string(s_.substr(start, pos_ - start)));
+    }
+
+    void lineBreak() {
+        bool hard = false;
+        if (!out_.empty() && out_.back().kind == Inline::Text) {
+            auto &text = out_.back().text;
+            size_t spaces = 0;
+            while (spaces < text.size() && text[text.size() - 1 - spaces] == ' ') ++spaces;
+            hard = spaces >= 2;
+            text.resize(text.size() - spaces);
+        }
+        add(hard ? Inline::HardBreak : Inline::SoftBreak);
+        ++pos_;
+        while (pos_ < s_.size() && s_[pos_] == ' ') ++pos_;
+    }
+
+    void backslash() {
+        ++pos_;
+        if (pos_ < s_.size() && s_[pos_] == '\n') {
+            add(Inline::HardBreak);
+            ++pos_;
+            while (pos_ < s_.size() && s_[pos_] == ' ') ++pos_;
+        } else if (pos_ < s_.size() && isPunct(s_[pos_])) {
+            addText(std::string(1, s_[pos_++]));
+        } else {
+            addText("\\");
+        }
+    }
+
+    void codeSpan() {
+        size_t start = pos_;
+        while (pos_ < s_.size() && s_[pos_] == '`') ++pos_;
+        size_t run = pos_ - start;
+        for (size_t i = pos_; i < s_.size();) {
+            if (s_[i] != '`') {
+                ++i;
+                continue;
+            }
+            size_t closeStart = i;
+            while (i < s_.size() && s_[i] == '`') ++i;
+            if (i - closeStart != run) continue;
+            std::string code(s_.substr(pos_, closeStart - pos_));
+            std::replace(code.begin(), code.end(), '\n', ' ');
+            if (code.size() >= 2 && code.front() == ' ' && code.back() == ' ' &&
+                code.find_first_not_of(' ') != std::string::npos) {
+                code = code.substr(1, code.size() - 2);
+            }
+            add(Inline::Code, std::move(code));
+            pos_ = i;
+            return;
+        }
+        addText(std::string(s_.substr(start, run)));
+    }
+
+    void delimiterRun(char c) {
+        size_t start = pos_;
+        while (pos_ < s_.size() && s_[pos_] == c) ++pos_;
+        int count = static_cast<int>(pos_ - start);
+        // Line starts and ends count as whitespace; non-ASCII as letters
+        char before = start > 0 ? s_[start - 1] : '\n';
+        char after = pos_ < s_.size() ? s_[pos_] : '\n';
+        bool beforeSpace = isSpaceChar(before);
+        bool afterSpace = isSpaceChar(after);
+        bool beforePunct = isPunct(before);
+        bool afterPunct = isPunct(after);
+        bool left = !afterSpace && (!afterPunct || beforeSpace || beforePunct);
+        bool right = !beforeSpace && (!beforePunct || afterSpace || afterPunct);
+        bool canOpen = c == '*' ? left : left && (!right || beforePunct);
+        bool canClose = c == '*' ? right : right && (!left || afterPunct);
+        auto node = addText(std::string(s_.substr(start, count)));
+        if (canOpen || canClose) {
+            delims_.push_back(Delimiter{node, c, count, count, canOpen, canClose});
+        }
+    }
+
+    void openBracket(bool image, size_t length) {
+        auto node = addText(image ? "![" : "[");
+        pos_ += length;
+        brackets_.push_back(Bracket{node, image, true, delims_.size(), pos_});
+    }
+
+    void closeBracket() {
+        size_t closeAt = pos_++;
+        if (brackets_.empty()) {
+            addText("]");
+            return;
+        }
+        Bracket bracket = brackets_.back();
+        if (!bracket.active) {
+            brackets_.pop_back();
+            addText("]");
+            return;
+        }
+
+        std::string url;
+        std::string title;
+        bool found = false;
+        size_t after = pos_;
+        if (after < s_.size() && s_[after] == '(') {
+            size_t i = skipSpaces(s_, after + 1);
+            bool ok = true;
+            if (i < s_.size() && s_[i] != ')') ok = parseLinkDestination(s_, i, url);
+            if (ok) {
+                size_t beforeTitle = i;
+                i = skipSpaces(s_, i);
+                if (i > beforeTitle && i < s_.size() && s_[i] != ')') {
+                    ok = parseLinkTitle(s_, i, title);
+                    i = skipSpaces(s_, i);
+                }
+            }
+            if (ok && i < s_.size() && s_[i] == ')') {
+                found = true;
+                pos_ = i + 1;
+            }
+        }
+        if (!found) {
+            url.clear();
+            title.clear();
+            // Full [text][label], collapsed [text][] or shortcut [text]
+            std::string_view label = s_.substr(bracket.textStart, closeAt - bracket.textStart);
+            size_t i = after;
+            std::string_view explicitLabel;
+            bool hasLabel = parseLinkLabel(s_, i, explicitLabel);
+            if (hasLabel && !trim(explicitLabel).empty()) label = explicitLabel;
+            // Labels are at most 999 characters, which also keeps nested
+            // brackets from normalizing ever longer text
+            auto ref = label.size() < 1000 ? refs_.find(normalizeLabel(label)) : refs_.end();
+            if (ref != refs_.end()) {
+                found = true;
+                url = ref->second.url;
+                title = ref->second.title;
+                if (hasLabel) pos_ = i;
+            }
+        }
+        if (!found) {
+            brackets_.pop_back();
+            addText("]");
+            return;
+        }
+
+        processEmphasis(bracket.delimiters);
+        Inline link{bracket.image ? Inline::Image : Inline::Link, {}, url, title, {}};
+        auto it = out_.insert(bracket.node, std::move(link));
+        it->children.splice(it->children.end(), out_, std::next(bracket.node), out_.end());
+        out_.erase(bracket.node);
+        brackets_.pop_back();
+        // No links inside links
+        if (!bracket.image) {
+            for (auto &b : brackets_) {
+                if (!b.image) b.active = false;
+            }
+        }
+    }
+
+    void angle() {
+        size_t end = s_.find('>', pos_);
+        if (end != std::string_view::npos) {
+            auto inner = s_.substr(pos_ + 1, end - pos_ - 1);
+            if (isAutolinkUri(inner)) {
+                addLink(std::string(inner), std::string(inner));
+                pos_ = end + 1;
+                return;
+            }
+            if (isAutolinkEmail(inner)) {
+                addLink("mailto:" + std::string(inner), std::string(inner));
+                pos_ = end + 1;
+                return;
+            }
+        }
+        if (size_t length = htmlTagLength(s_, pos_)) {
+            add(Inline::Html, std::string(s_.substr(pos_, length)));
+            pos_ += length;
+            return;
+        }
+        addText("<");
+        ++pos_;
+    }
+
+    void entity() {
+        if (size_t length = entityLength(s_, pos_)) {
+            add(Inline::Html, std::string(s_.substr(pos_, length)));
+            pos_ += length;
+            return;
+        }
+        addText("&");
+        ++pos_;
+    }
+
+    void addLink(std::string url, std::string text) {
+        Inline link{Inline::Link, {}, std::move(url), {}, {}};
+        link.children.push_back(Inline{Inline::Text, std::move(text), {}, {}, {}});
+        out_.push_back(std::move(link));
+    }
+
+    static bool isAutolinkUri(std::string_view s) {
+        size_t colon = s.find(':');
+        if (colon == std::string_view::npos || colon < 2 || colon > 32 || !isAlpha(s[0])) {
+            return false;
+        }
+        for (size_t i = 1; i < colon; ++i) {
+            if (!isAlnum(s[i]) && !std::strchr("+.-", s[i])) return false;
+        }
+        return std::none_of(s.begin(), s.end(), [](char c) {
+            return static_cast<unsigned char>(c) <= 0x20 || c == '<' || c == '>';
+        });
+    }
+
+    static bool isAutolinkEmail(std::string_view s) {
+        size_t at = s.find('@');
+        if (at == std::string_view::npos || at == 0 || at + 1 >= s.size()) return false;
+        for (size_t i = 0; i < at; ++i) {
+            if (!isAlnum(s[i]) && !std::strchr(".!#$%&'*+/=?^_`{|}~-", s[i])) return false;
+        }
+        for (size_t i = at + 1; i < s.size(); ++i) {
+            if (!isAlnum(s[i]) && s[i] != '-' && s[i] != '.') return false;
+        }
+        return s.back() != '.' && s.back() != '-' && s[at + 1] != '.' && s[at + 1] != '-';
+    }
+
+    // Erases a delimiter, keeping the openers-bottom indexes in step
+    void eraseDelimiter(size_t index, std::array<size_t, 12> &bottoms) {
+        delims_.erase(delims_.begin() + static_cast<std::ptrdiff_t>(index));
+        for (auto &b : bottoms) {
+            if (b > index) --b;
+        }
+    }
+
+    // CommonMark "process emphasis" over the delimiters above stackBottom
+    void processEmphasis(size_t stackBottom) {
+        std::array<size_t, 12> openersBottom;
+        openersBottom.fill(stackBottom);
+        size_t i = stackBottom;
+        while (i < delims_.size()) {
+            if (!delims_[i].canClose) {
+                ++i;
+                continue;
+            }
+            const auto &closer = delims_[i];
+            size_t key = (closer.ch == '*' ? 0 : 6) + (closer.canOpen ? 3 : 0) +
+                         static_cast<size_t>(closer.origCount % 3);
+            size_t opener = i;
+            bool found = false;
+            while (opener > openersBottom[key]) {
+                --opener;
+                const auto &o = delims_[opener];
+                if (o.ch != closer.ch || !o.canOpen) continue;
+                bool oddMatch = (o.canClose || closer.canOpen) &&
+                                (o.origCount + closer.origCount) % 3 == 0 &&
+                                !(o.origCount % 3 == 0 && closer.origCount % 3 == 0);
+                if (!oddMatch) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                openersBottom[key] = i;
+                if (!delims_[i].canOpen) {
+                    eraseDelimiter(i, openersBottom);
+                } else {
+                    ++i;
+                }
+                continue;
+            }
+
+            auto &o = delims_[opener];
+            auto &c = delims_[i];
+            int use = o.count >= 2 && c.count >= 2 ? 2 : 1;
+            o.count -= use;
+            c.count -= use;
+            o.node->text.resize(static_cast<size_t>(o.count));
+            c.node->text.resize(static_cast<size_t>(c.count));
+
+            Inline emph{use == 2 ? Inline::Strong : Inline::Emph, {}, {}, {}, {}};
+            auto it = out_.insert(std::next(o.node), std::move(emph));
+            it->children.splice(it->children.end(), out_, std::next(it), c.node);
+
+            for (size_t k = i; k-- > opener + 1;) eraseDelimiter(k, openersBottom);
+            i = opener + 1;
+            if (delims_[opener].count == 0) {
+                out_.erase(delims_[opener].node);
+                eraseDelimiter(opener, openersBottom);
+                --i;
+            }
+            if (delims_[i].count == 0) {
+                out_.erase(delims_[i].node);
+                eraseDelimiter(i, openersBottom);
+            }
+        }
+        delims_.resize(std::min(delims_.size(), stackBottom));
+    }
+
+    std::string_view s_;
+    const References &refs_;
+    size_t pos_ = 0;
+    Inlines out_;
+    std::vector<Delimiter> delims_;
+    std::vector<Bracket> brackets_;
+};
+
+void plainText(std::string &out, const Inlines &inlines) {
+    for (const auto &in : inlines) {
+        switch (in.kind) {
+        case Inline::Text:
+        case Inline::Code: escapeHtml(out, in.text); break;
+        case Inline::Html: if (in.text[0] == '&') out += in.text; break;
+        case Inline::SoftBreak:
+        case Inline::HardBreak: out += ' '; break;
+        default: plainText(out, in.children);
+        }
+    }
+}
+
+void renderInlines(std::string &out, const Inlines &inlines) {
+    for (const auto &in : inlines) {
+        switch (in.kind) {
+        case Inline::Text: escapeHtml(out, in.text); break;
+        case Inline::Code:
+            out += "<code>";
+            escapeHtml(out, in.text);
+            out += "</code>";
+            break;
+        case Inline::Html: out += in.text; break;
+        case Inline::SoftBreak: out += '\n'; break;
+        case Inline::HardBreak: out += "<br />\n"; break;
+        case Inline::Emph:
+            out += "<em>";
+            renderInlines(out, in.children);
+            out += "</em>";
+            break;
+        case Inline::Strong:
+            out += "<strong>";
+            renderInlines(out, in.children);
+            out += "</strong>";
+            break;
+        case Inline::Link:
+            out += "<a href=\"";
+            escapeHref(out, in.url);
+            out += '"';
+            if (!in.title.empty()) {
+                out += " title=\"";
+                escapeKeepingEntities(out, in.title);
+                out += '"';
+            }
+            out += '>';
+            renderInlines(out, in.children);
+            out += "</a>";
+            break;
+        case Inline::Image:
+            out += "<img src=\"";
+            escapeHref(out, in.url);
+            out += "\" alt=\"";
+            plainText(out, in.children);
+            out += '"';
+            if (!in.title.empty()) {
+                out += " title=\"";
+                escapeKeepingEntities(out, in.title);
+                out += '"';
+            }
+            out += " />";
+            break;
+        }
+    }
+}
+
+// ── Blocks ───────────────────────────────────────────────────────────────────
+
+enum class Block {
+    Document, BlockQuote, List, Item, Paragraph, Heading, CodeBlock, HtmlBlock, ThematicBreak
+};
+
+struct Node {
+    Block kind = Block::Document;
+    Node *parent = nullptr;
+    std::vector<std::unique_ptr<Node>> children;
+    bool open = true;
+    int startLine = 0;
+    bool lastLineBlank = false;
+    std::string text; // paragraph, heading and HTML lines; code content
+
+    int level = 0; // heading
+    // List and item
+    bool ordered = false;
+    char marker = 0; // bullet, or the delimiter after the number
+    int start = 1;
+    bool tight = true;
+    int contentOffset = 0;
+    // Code block
+    bool fenced = false;
+    char fenceChar = 0;
+    size_t fenceLength = 0;
+    size_t fenceIndent = 0;
+    std::string info;
+
+    Node *lastChild() const { return children.empty() ? nullptr : children.back().get(); }
+};
+
+bool canContain(Block parent, Block child) {
+    switch (parent) {
+    case Block::Document:
+    case Block::BlockQuote:
+    case Block::Item: return child != Block::Item;
+    case Block::List: return child == Block::Item;
+    default: return false;
+    }
+}
+
+bool isThematicBreak(std::string_view line, size_t pos) {
+    char c = line[pos];
+    if (c != '*' && c != '-' && c != '_') return false;
+    int count = 0;
+    for (size_t i = pos; i < line.size(); ++i) {
+        if (line[i] == c) {
+            ++count;
+        } else if (line[i] != ' ') {
+            return false;
+        }
+    }
+    return count >= 3;
+}
+
+class BlockParser {
+public:
+    BlockParser() : doc_(std::make_unique<Node>()) { tip_ = doc_.get(); }
+
+    void addLine(std::string_view raw) {
+        ++lineNumber_;
+        line_ = expandTabs(raw);
+        pos_ = 0;
+        oldTip_ = tip_;
+        allClosed_ = false;
+
+        // 1. Continue the open blocks that this line matches
+        Node *container = doc_.get();
+        int depth = 0;
+        while (Node *last = container->lastChild()) {
+            if (!last->open) break;
+            findNextNonspace();
+            bool matched = false;
+            switch (last->kind) {
+            case Block::BlockQuote:
+                matched = indent_ <= 3 && nextNonspace_ < line_.size() &&
+                          line_[nextNonspace_] == '>';
+                if (matched) {
+                    pos_ = nextNonspace_ + 1;
+                    if (pos_ < line_.size() && line_[pos_] == ' ') ++pos_;
+                }
+                break;
+            case Block::List: matched = true; break;
+            case Block::Item:
+                if (blank_) {
+                    matched = !last->children.empty();
+                    if (matched) pos_ = nextNonspace_;
+                } else if (indent_ >= last->contentOffset) {
+                    matched = true;
+                    pos_ += static_cast<size_t>(last->contentOffset);
+                }
+                break;
+            case Block::CodeBlock:
+                if (last->fenced) {
+                    if (indent_ <= 3 && closesFence(*last)) {
+                        finalize(last);
+                        tip_ = last->parent;
+                        return;
+                    }
+                    for (size_t i = 0; i < last->fenceIndent && pos_ < line_.size() &&
+                                       line_[pos_] == ' ';
+                         ++i) {
+                        ++pos_;
+                    }
+                    matched = true;
+                } else if (indent_ >= 4) {
+                    pos_ += 4;
+                    matched = true;
+                } else if (blank_) {
+                    pos_ = nextNonspace_;
+                    matched = true;
+                }
+                break;
+            case Block::HtmlBlock:
+            case Block::Paragraph: matched = !blank_; break;
+            default: break;
+            }
+            if (!matched) break;
+            container = last;
+            if (last->kind == Block::BlockQuote || last->kind == Block::Item) ++depth;
+        }
+        lastMatched_ = container;
+
+        // 2. Open the new blocks the line starts
+        bool maybeLazy = tip_->kind == Block::Paragraph;
+        bool leafDone = false;
+        while (container->kind != Block::CodeBlock && container->kind != Block::HtmlBlock) {
+            findNextNonspace();
+            if (depth >= kMaxNesting) break;
+            char c = nextNonspace_ < line_.size() ? line_[nextNonspace_] : '\0';
+            if (indent_ >= 4) {
+                if (!maybeLazy && !blank_) {
+                    pos_ += 4;
+                    container = addChild(container, Block::CodeBlock);
+                }
+                break;
+            }
+            if (c == '>') {
+                pos_ = nextNonspace_ + 1;
+                if (pos_ < line_.size() && line_[pos_] == ' ') ++pos_;
+                container = addChild(container, Block::BlockQuote);
+                ++depth;
+                continue;
+            }
+            if (c == '#' && atxHeading(container)) {
+                leafDone = true;
+                break;
+            }
+            if ((c == '`' || c == '~') && openFence(container)) {
+                leafDone = true;
+                break;
+            }
+            if (c == '<' && startsHtmlBlock(line_, nextNonspace_,
+                                            container->kind == Block::Paragraph)) {
+                container = addChild(container, Block::HtmlBlock);
+                break;
+            }
+            if (container->kind == Block::Paragraph && (c == '=' || c == '-') &&
+                setextHeading(container)) {
+                leafDone = true;
+                break;
+            }
+            if (isThematicBreak(line_, nextNonspace_)) {
+                auto *hr = addChild(container, Block::ThematicBreak);
+                finalize(hr);
+                tip_ = hr->parent;
+                leafDone = true;
+                break;
+            }
+            if (Node *item = listItem(container)) {
+                container = item;
+                ++depth;
+                continue;
+            }
+            break;
+        }
+
+        // 3. Add the rest of the line to the innermost block
+        findNextNonspace();
+        if (!leafDone && tip_ != lastMatched_ && container == lastMatched_ && !blank_ &&
+            tip_->kind == Block::Paragraph) {
+            // Lazy continuation line
+            tip_->text.append(line_, nextNonspace_, std::string::npos);
+            tip_->text += '\n';
+            return;
+        }
+        closeUnmatched();
+
+        // Blank lines decide whether lists are loose. One inside a fenced
+        // block or right after an empty item's marker does not count.
+        if (blank_ && container->lastChild()) container->lastChild()->lastLineBlank = true;
+        bool lastLineBlank =
+            blank_ && container->kind != Block::BlockQuote &&
+            !(container->kind == Block::CodeBlock && container->fenced) &&
+            !(container->kind == Block::Item && container->children.empty() &&
+              container->startLine == lineNumber_);
+        for (Node *node = container; node; node = node->parent) {
+            node->lastLineBlank = lastLineBlank;
+        }
+        if (leafDone) return;
+
+        switch (container->kind) {
+        case Block::CodeBlock:
+        case Block::HtmlBlock:
+            container->text.append(line_, std::min(pos_, line_.size()), std::string::npos);
+            container->text += '\n';
+            break;
+        case Block::Paragraph:
+            container->text.append(line_, nextNonspace_, std::string::npos);
+            container->text += '\n';
+            break;
+        default:
+            if (!blank_) {
+                container = addChild(container, Block::Paragraph);
+                container->text.append(line_, nextNonspace_, std::string::npos);
+                container->text += '\n';
+            }
+        }
+    }
+
+    std::unique_ptr<Node> finish(References &refs) {
+        while (tip_) {
+            Node *parent = tip_->parent;
+            finalize(tip_);
+            tip_ = parent;
+        }
+        refs = std::move(refs_);
+        return std::move(doc_);
+    }
+
+private:
+    void findNextNonspace() {
+        size_t i = pos_;
+        while (i < line_.size() && line_[i] == ' ') ++i;
+        nextNonspace_ = i;
+        indent_ = static_cast<int>(i - pos_);
+        blank_ = i >= line_.size() || line_[i] == '\n' || line_[i] == '\r';
+    }
+
+    // Finalizes the blocks left open by the previous line that this one
+    // did not continue
+    void closeUnmatched() {
+        if (allClosed_) return;
+        while (oldTip_ != lastMatched_) {
+            Node *parent = oldTip_->parent;
+            finalize(oldTip_);
+            oldTip_ = parent;
+        }
+        tip_ = lastMatched_;
+        allClosed_ = true;
+    }
+
+    Node *addChild(Node *parent, Block kind) {
+        closeUnmatched();
+        while (!canContain(parent->kind, kind)) {
+            Node *up = parent->parent;
+            finalize(parent);
+            parent = up;
+        }
+        auto node = std::make_unique<Node>();
+        node->kind = kind;
+        node->parent = parent;
+        node->startLine = lineNumber_;
+        Node *raw = node.get();
+        parent->children.push_back(std::move(node));
+        tip_ = raw;
+        return raw;
+    }
+
+    void finalize(Node *node) {
+        if (!node->open) return;
+        node->open = false;
+        switch (node->kind) {
+        case Block::Paragraph: {
+            std::string_view text = node->text;
+            while (text.size() > 0 && text[0] == '[') {
+                size_t used = parseReference(text, refs_);
+                if (used == 0) break;
+                text.remove_prefix(used);
+            }
+            node->text = std::string(trim(text));
+            break;
+        }
+        case Block::CodeBlock:
+            if (!node->fenced) {
+                // Trailing blank lines are not part of an indented block
+                auto &text = node->text;
+                while (true) {
+                    size_t lastBreak = text.find_last_of('\n', text.size() >= 2 ? text.size() - 2
+                                                                                : 0);
+                    size_t lineStart = lastBreak == std::string::npos ? 0 : lastBreak + 1;
+                    if (text.empty() ||
+                        !isBlank(std::string_view(text).substr(lineStart,
+                                                               text.size() - 1 - lineStart))) {
+                        break;
+                    }
+                    text.resize(lineStart);
+                }
+            }
+            break;
+        case Block::List: {
+            // Loose if any item, or any block in an item, is followed by a
+            // blank line before its next sibling
+            auto endsWithBlankLine = [](const Node *n) {
+                for (; n; n = n->lastChild()) {
+                    if (n->lastLineBlank) return true;
+                    if (n->kind != Block::List && n->kind != Block::Item) break;
+                }
+                return false;
+            };
+            const auto &items = node->children;
+            for (size_t i = 0; i < items.size() && node->tight; ++i) {
+                bool lastItem = i + 1 == items.size();
+                if (!lastItem && endsWithBlankLine(items[i].get())) node->tight = false;
+                const auto &blocks = items[i]->children;
+                for (size_t j = 0; j < blocks.size() && node->tight; ++j) {
+                    bool last = lastItem && j + 1 == blocks.size();
+                    if (!last && endsWithBlankLine(blocks[j].get())) node->tight = false;
+                }
+            }
+            break;
+        }
+        default: break;
+        }
+    }
+
+    bool closesFence(const Node &code) {
+        size_t i = nextNonspace_;
+        size_t run = 0;
+        while (i < line_.size() && line_[i] == code.fenceChar) {
+            ++i;
+            ++run;
+        }
+        return run >= code.fenceLength && isBlank(std::string_view(line_).substr(i));
+    }
+
+    bool atxHeading(Node *&container) {
+        size_t i = nextNonspace_;
+        int level = 0;
+        while (i < line_.size() && line_[i] == '#' && level < 7) {
+            ++i;
+            ++level;
+        }
+        if (level == 0 || level > 6 || (i < line_.size() && line_[i] != ' ')) return false;
+        std::string_view content = trim(std::string_view(line_).substr(i));
+        // Optional closing sequence
+        size_t k = content.size();
+        while (k > 0 && content[k - 1] == '#') --k;
+        if (k == 0 || content[k - 1] == ' ') content = trim(content.substr(0, k));
+
+        container = addChild(container, Block::Heading);
+        container->level = level;
+        container->text = std::string(content);
+        finalize(container);
+        tip_ = container->parent;
+        return true;
+    }
+
+    bool openFence(Node *&container) {
+        char c = line_[nextNonspace_];
+        size_t i = nextNonspace_;
+        while (i < line_.size() && line_[i] == c) ++i;
+        size_t run = i - nextNonspace_;
+        if (run < 3) return false;
+        std::string_view info = trim(std::string_view(line_).substr(i));
+        if (c == '`' && info.find('`') != std::string_view::npos) return false;
+
+        container = addChild(container, Block::CodeBlock);
+        container->fenced = true;
+        container->fenceChar = c;
+        container->fenceLength = run;
+        container->fenceIndent = static_cast<size_t>(indent_);
+        container->info = unescape(info);
+        return true;
+    }
+
+    bool setextHeading(Node *&container) {
+        char c = line_[nextNonspace_];
+        size_t i = nextNonspace_;
+        while (i < line_.size() && line_[i] == c) ++i;
+        if (!isBlank(std::string_view(line_).substr(i))) return false;
+
+        // Reference definitions are not heading text
+        std::string_view text = container->text;
+        while (text.size() > 0 && text[0] == '[') {
+            size_t used = parseReference(text, refs_);
+            if (used == 0) break;
+            text.remove_prefix(used);
+        }
+        if (trim(text).empty()) {
+            container->text = std::string(text);
+            return false;
+        }
+        container->kind = Block::Heading;
+        container->level = c == '=' ? 1 : 2;
+        container->text = std::string(trim(text));
+        finalize(container);
+        tip_ = container->parent;
+        return true;
+    }
+
+    Node *listItem(Node *container) {
+        size_t i = nextNonspace_;
+        bool ordered = false;
+        char marker = line_[i];
+        int start = 1;
+        if (marker == '-' || marker == '+' || marker == '*') {
+            ++i;
+        } else if (isDigit(marker)) {
+            size_t digits = 0;
+            int number = 0;
+            while (i < line_.size() && isDigit(line_[i]) && digits < 10) {
+                number = number * 10 + (line_[i] - '0');
+                ++i;
+                ++digits;
+            }
+            if (digits > 9 || i >= line_.size() || (line_[i] != '.' && line_[i] != ')')) {
+                return nullptr;
+            }
+            ordered = true;
+            marker = line_[i++];
+            start = number;
+        } else {
+            return nullptr;
+        }
+        if (i < line_.size() && line_[i] != ' ') return nullptr;
+
+        bool restBlank = isBlank(std::string_view(line_).substr(i));
+        if (container->kind == Block::Paragraph && (restBlank || (ordered && start != 1))) {
+            return nullptr;
+        }
+
+        int markerWidth = static_cast<int>(i - nextNonspace_);
+        size_t spaces = 0;
+        while (i + spaces < line_.size() && line_[i + spaces] == ' ') ++spaces;
+        int padding;
+        if (restBlank || spaces >= 5) {
+            // Content starts one space after the marker
+            padding = markerWidth + 1;
+            pos_ = std::min(i + 1, line_.size());
+        } else {
+            padding = markerWidth + static_cast<int>(spaces);
+            pos_ = i + spaces;
+        }
+        int contentOffset = indent_ + padding;
+
+        if (container->kind != Block::List || container->ordered != ordered ||
+            container->marker != marker) {
+            container = addChild(container, Block::List);
+            container->ordered = ordered;
+            container->marker = marker;
+            container->start = start;
+        }
+        Node *item = addChild(container, Block::Item);
+        item->contentOffset = contentOffset;
+        return item;
+    }
+
+    std::unique_ptr<Node> doc_;
+    Node *tip_;
+    Node *oldTip_ = nullptr;
+    Node *lastMatched_ = nullptr;
+    bool allClosed_ = true;
+    References refs_;
+    int lineNumber_ = 0;
+
+    std::string line_;
+    size_t pos_ = 0;
+    size_t nextNonspace_ = 0;
+    int indent_ = 0;
+    bool blank_ = false;
+};
+
+void cr(std::string &out) {
+    if (!out.empty() && out.back() != '\n') out += '\n';
+}
+
+void renderBlock(std::string &out, const Node &node, const References &refs, bool tight) {
+    auto children = [&](bool childTight) {
+        for (const auto &child : node.children) renderBlock(out, *child, refs, childTight);
+    };
+    switch (node.kind) {
+    case Block::Document: children(false); break;
+    case Block::BlockQuote:
+        cr(out);
+        out += "<blockquote>\n";
+        children(false);
+        cr(out);
+        out += "</blockquote>\n";
+        break;
+    case Block::List:
+        cr(out);
+        if (node.ordered) {
+            out += node.start == 1 ? "<ol>\n" : "<ol start=\"" + std::to_string(node.start) + "\">\n";
+        } else {
+            out += "<ul>\n";
+        }
+        for (const auto &item : node.children) renderBlock(out, *item, refs, node.tight);
+        cr(out);
+        out += node.ordered ? "</ol>\n" : "</ul>\n";
+        break;
+    case Block::Item:
+        cr(out);
+        out += "<li>";
+        children(tight);
+        out += "</li>\n";
+        break;
+    case Block::Paragraph:
+        if (node.text.empty()) break;
+        if (tight) {
+            renderInlines(out, InlineParser(node.text, refs).parse());
+        } else {
+            cr(out);
+            out += "<p>";
+            renderInlines(out, InlineParser(node.text, refs).parse());
+            out += "</p>\n";
+        }
+        break;
+    case Block::Heading: {
+        cr(out);
+        auto tag = std::to_string(node.level);
+        out += "<h" + tag + ">";
+        renderInlines(out, InlineParser(node.text, refs).parse());
+        out += "</h" + tag + ">\n";
+        break;
+    }
+    case Block::CodeBlock: {
+        cr(out);
+        out += "<pre><code";
+        auto language = std::string_view(node.info).substr(0, node.info.find(' '));
+        if (!language.empty()) {
+            out += " class=\"language-";
+            escapeKeepingEntities(out, language);
+            out += '"';
+        }
+        out += '>';
+        escapeHtml(out, node.text);
+        out += "</code></pre>\n";
+        break;
+    }
+    case Block::HtmlBlock:
+        cr(out);
+        out += node.text;
+        break;
+    case Block::ThematicBreak:
+        cr(out);
+        out += "<hr />\n";
+        break;
+    }
+}
+
+} // namespace
+
+std::string MarkdownRenderer::render(std::string_view markdown) {
+    BlockParser parser;
+    size_t start = 0;
+    while (start < markdown.size()) {
+        size_t end = markdown.find('\n', start);
+        if (end == std::string_view::npos) end = markdown.size();
+        auto line = markdown.substr(start, end - start);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        parser.addLine(line);
+        start = end + 1;
+    }
+    References refs;
+    auto doc = parser.finish(refs);
+    std::string out;
+    out.reserve(markdown.size() + markdown.size() / 4);
+    renderBlock(out, *doc, refs, false);
+    return out;
+}
+
+} // namespace pyracms
@@ -37,16 +37,17 @@ void NotificationService::createNotification(const DbClientPtr &db,
 void NotificationService::getNotifications(const DbClientPtr &db,
                                             int userId,
                                             bool unreadOnly,
-                                            int limit,
-                                            int offset,
+                                            const PageRequest &page,
                                             ListCallback cb) {
     std::string sql;
     if (unreadOnly) {
         sql = "SELECT * FROM notifications WHERE user_id = $1 AND is_read = FALSE "
-              "ORDER BY created_at DESC LIMIT $2 OFFSET $3";
+              "AND (created_at, id) < ($2::timestamptz, $3::bigint) "
+              "ORDER BY created_at DESC, id DESC LIMIT $4 OFFSET $5";
     } else {
         sql = "SELECT * FROM notifications WHERE user_id = $1 "
-              "ORDER BY created_at DESC LIMIT $2 OFFSET $3";
+              "AND (created_at, id) < ($2::timestamptz, $3::bigint) "
+              "ORDER BY created_at DESC, id DESC LIMIT $4 OFFSET $5";
     }
 
     db->execSqlAsync(
@@ -62,7 +63,7 @@ void NotificationService::getNotifications(const DbClientPtr &db,
         [cb](const drogon::orm::DrogonDbException &) {
             cb({});
         },
-        userId, limit, offset);
+        userId, page.afterKey(), page.afterId(), page.limit, page.skip());
 }
 
 void NotificationService::markRead(const DbClientPtr &db,
@@ -0,0 +1,141 @@
+#include "services/PageCursor.h"
+#include "services/BinaryCodec.h"
+
+#include <charconv>
+#include <limits>
+
+namespace pyracms {
+
+namespace {
+
+constexpr uint8_t kCursorVersion = 1;
+
+// Sort keys are timestamps; anything longer was not made by encode()
+constexpr size_t kMaxKeySize = 64;
+
+constexpr char kBase64Url[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+bool parseInt(std::string_view text, int &out) {
+    int value = 0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc() || end != text.data() + text.size()) return false;
+    out = value;
+    return true;
+}
+
+} // namespace
+
+std::string base64UrlEncode(std::string_view in) {
+    std::string out;
+    out.reserve((in.size() + 2) / 3 * 4);
+    uint32_t acc = 0;
+    int bits = 0;
+    for (unsigned char c : in) {
+        acc = (acc << 8) | c;
+        bits += 8;
+        while (bits >= 6) {
+            bits -= 6;
+            out += kBase64Url[(acc >> bits) & 0x3f];
+        }
+    }
+    if (bits > 0) out += kBase64Url[(acc << (6 - bits)) & 0x3f];
+    return out;
+}
+
+bool base64UrlDecode(std::string_view in, std::string &out) {
+    out.clear();
+    uint32_t acc = 0;
+    int bits = 0;
+    for (char c : in) {
+        int v;
+        if (c >= 'A' && c <= 'Z') v = c - 'A';
+        else if (c >= 'a' && c <= 'z') v = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') v = c - '0' + 52;
+        else if (c == '-') v = 62;
+        else if (c == '_') v = 63;
+        else return false;
+        acc = (acc << 6) | static_cast<uint32_t>(v);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out += static_cast<char>((acc >> bits) & 0xff);
+        }
+    }
+    // Leftover bits are padding and must be zero
+    return bits < 6 && (acc & ((1u << bits) - 1)) == 0;
+}
+
+uint32_t PageCursor::hashScope(std::string_view list, int64_t owner) {
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](unsigned char c) {
+        hash ^= c;
+        hash *= 16777619u;
+    };
+    for (unsigned char c : list) mix(c);
+    mix(0);
+    for (int i = 0; i < 8; ++i) mix(static_cast<unsigned char>(static_cast<uint64_t>(owner) >> (8 * i)));
+    return hash;
+}
+
+std::string PageCursor::encode() const {
+    std::string raw;
+    BinaryWriter w(raw);
+    w.u8(kCursorVersion);
+    w.varint(scope);
+    w.str(key);
+    w.i64(id);
+    return base64UrlEncode(raw);
+}
+
+bool PageCursor::decode(std::string_view text, PageCursor &out) {
+    std::string raw;
+    if (text.empty() || !base64UrlDecode(text, raw)) return false;
+    BinaryReader r(raw);
+    if (r.u8() != kCursorVersion) return false;
+    PageCursor cursor;
+    auto scope = r.varint();
+    if (scope > std::numeric_limits<uint32_t>::max()) return false;
+    cursor.scope = static_cast<uint32_t>(scope);
+    r.str(cursor.key);
+    cursor.id = r.i64();
+    if (!r.ok() || !r.atEnd()) return false;
+    if (cursor.key.empty() || cursor.key.size() > kMaxKeySize) return false;
+    out = std::move(cursor);
+    return true;
+}
+
+bool PageRequest::parse(std::string_view limit, std::string_view offset, std::string_view cursor,
+                        uint32_t scope, PageRequest &out, int defaultLimit) {
+    PageRequest page;
+    page.scope = scope;
+    if (!parseInt(limit, page.limit) || page.limit <= 0) page.limit = defaultLimit;
+    if (!parseInt(offset, page.offset) || page.offset < 0) page.offset = 0;
+    if (!cursor.empty()) {
+        if (!PageCursor::decode(cursor, page.after) || page.after.scope != scope) return false;
+        page.hasCursor = true;
+    }
+    out = std::move(page);
+    return true;
+}
+
+std::string PageRequest::afterKey(bool ascending) const {
+    if (hasCursor) return after.key;
+    return ascending ? "-infinity" : "infinity";
+}
+
+int64_t PageRequest::afterId(bool ascending) const {
+    if (hasCursor) return after.id;
+    return ascending ? std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max();
+}
+
+std::string PageRequest::next(size_t returned, std::string key, int64_t id) const {
+    if (returned < static_cast<size_t>(limit)) return "";
+    PageCursor cursor;
+    cursor.scope = scope;
+    cursor.key = std::move(key);
+    cursor.id = id;
+    return cursor.encode();
+}
+
+} // namespace pyracms
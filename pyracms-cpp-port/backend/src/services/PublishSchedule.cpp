@@ -0,0 +1,78 @@
+#include "services/PublishSchedule.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+namespace pyracms {
+
+namespace {
+
+// Rebuild once the heap holds this many entries beyond twice the live ones
+constexpr size_t kCompactSlack = 64;
+
+} // namespace
+
+std::optional<PublishSchedule::Change> PublishSchedule::Change::decode(std::string_view payload) {
+    auto space = payload.find(' ');
+    auto idText = payload.substr(0, space);
+    Change change;
+    auto [end, ec] = std::from_chars(idText.data(), idText.data() + idText.size(), change.articleId);
+    if (ec != std::errc() || end != idText.data() + idText.size() || change.articleId <= 0) {
+        return std::nullopt;
+    }
+    if (space == std::string_view::npos) return change;
+
+    // PostgreSQL prints the interval's epoch as a plain decimal
+    std::string delayText(payload.substr(space + 1));
+    if (delayText.empty()) return std::nullopt;
+    char *delayEnd = nullptr;
+    double delay = std::strtod(delayText.c_str(), &delayEnd);
+    if (delayEnd != delayText.c_str() + delayText.size() || !std::isfinite(delay)) {
+        return std::nullopt;
+    }
+    change.delaySeconds = delay;
+    return change;
+}
+
+void PublishSchedule::schedule(int articleId, Clock::time_point due) {
+    auto [it, inserted] = due_.try_emplace(articleId, due);
+    if (!inserted) {
+        if (it->second == due) return;
+        it->second = due;
+    }
+    heap_.push({due, articleId});
+    compact();
+}
+
+void PublishSchedule::cancel(int articleId) {
+    due_.erase(articleId);
+    compact();
+}
+
+void PublishSchedule::clear() {
+    due_.clear();
+    heap_ = {};
+}
+
+std::optional<PublishSchedule::Clock::time_point> PublishSchedule::next() {
+    while (!heap_.empty() && !live(heap_.top())) heap_.pop();
+    if (heap_.empty()) return std::nullopt;
+    return heap_.top().due;
+}
+
+bool PublishSchedule::live(const Entry &entry) const {
+    auto it = due_.find(entry.articleId);
+    return it != due_.end() && it->second == entry.due;
+}
+
+void PublishSchedule::compact() {
+    if (heap_.size() <= 2 * due_.size() + kCompactSlack) return;
+    std::vector<Entry> entries;
+    entries.reserve(due_.size());
+    for (const auto &[articleId, due] : due_) entries.push_back({due, articleId});
+    heap_ = decltype(heap_)(std::greater<Entry>(), std::move(entries));
+}
+
+} // namespace pyracms
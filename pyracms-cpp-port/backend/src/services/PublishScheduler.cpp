@@ -0,0 +1,281 @@
+#include "services/PublishScheduler.h"
+#include "services/ArticleService.h"
+#include "services/DbRouter.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace pyracms {
+
+namespace {
+
+// Shared by every node; any key works as long as nothing else uses it
+constexpr int64_t kLeaderLockKey = 0x70797261'7075626cLL; // "pyrapubl"
+constexpr const char *kChannel = "article_schedule";
+// Back-off after a failed query
+constexpr double kRetrySeconds = 5.0;
+// Pause before reloading when a due article did not publish
+constexpr double kReloadSeconds = 0.25;
+
+PublishSchedule::Clock::duration seconds(double s) {
+    return std::chrono::duration_cast<PublishSchedule::Clock::duration>(
+        std::chrono::duration<double>(s));
+}
+
+} // namespace
+
+PublishScheduler &PublishScheduler::instance() {
+    static PublishScheduler scheduler;
+    return scheduler;
+}
+
+trantor::EventLoop *PublishScheduler::loop() const {
+    return drogon::app().getLoop();
+}
+
+void PublishScheduler::start() {
+    const char *resync = std::getenv("PUBLISH_RESYNC_SECONDS");
+    if (resync) resyncSeconds_ = std::atof(resync);
+
+    const auto &connInfo = DbRouter::instance().primaryConnInfo();
+    if (connInfo.empty()) {
+        LOG_WARN << "Publish scheduler: no primary database configured, scheduled articles will not publish";
+        return;
+    }
+    lockClient_ = drogon::orm::DbClient::newPgClient(connInfo, 1);
+    acquire();
+}
+
+void PublishScheduler::onScheduled(int articleId, double delaySeconds) {
+    auto due = Clock::now() + seconds(delaySeconds);
+    loop()->queueInLoop([this, articleId, due]() { apply(articleId, due); });
+}
+
+void PublishScheduler::onUnscheduled(int articleId) {
+    loop()->queueInLoop([this, articleId]() { apply(articleId, std::nullopt); });
+}
+
+PublishScheduler::Stats PublishScheduler::stats() const {
+    Stats s;
+    s.leader = isLeader_.load(std::memory_order_relaxed);
+    s.scheduled = scheduled_.load(std::memory_order_relaxed);
+    s.runs = runs_.load(std::memory_order_relaxed);
+    s.published = published_.load(std::memory_order_relaxed);
+    s.failures = failures_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void PublishScheduler::acquire() {
+    // Blocks in the database until the current leader's session ends, so
+    // followers wait without polling. Re-locking on a session that already
+    // holds the lock returns at once.
+    lockClient_->execSqlAsync(
+        "SELECT pg_advisory_lock($1::bigint), pg_backend_pid() AS pid",
+        [this](const drogon::orm::Result &result) {
+            int pid = result[0]["pid"].as<int>();
+            loop()->queueInLoop([this, pid]() { lead(pid); });
+        },
+        [this](const drogon::orm::DrogonDbException &e) {
+            LOG_WARN << "Publish scheduler: cannot take the leader lock: " << e.base().what();
+            loop()->runAfter(kRetrySeconds, [this]() { acquire(); });
+        },
+        kLeaderLockKey);
+}
+
+void PublishScheduler::lead(int backendPid) {
+    if (leader_) return;
+    leader_ = true;
+    backendPid_ = backendPid;
+    isLeader_.store(true, std::memory_order_relaxed);
+    LOG_INFO << "Publish scheduler: leading";
+
+    listener_ = drogon::orm::DbListener::newPgListener(
+        DbRouter::instance().primaryConnInfo(), loop());
+    listener_->listen(kChannel, [this](const std::string &payload) {
+        auto change = PublishSchedule::Change::decode(payload);
+        if (!change) {
+            LOG_WARN << "Publish scheduler: ignoring notification '" << payload << "'";
+            return;
+        }
+        std::optional<Clock::time_point> due;
+        if (change->delaySeconds) due = Clock::now() + seconds(*change->delaySeconds);
+        apply(change->articleId, due);
+    });
+    load();
+
+    if (resyncSeconds_ > 0) {
+        resyncTimer_ = loop()->runEvery(resyncSeconds_, [this]() {
+            if (leader_) load();
+        });
+    }
+}
+
+void PublishScheduler::stepDown() {
+    if (!leader_) return;
+    leader_ = false;
+    isLeader_.store(false, std::memory_order_relaxed);
+    LOG_WARN << "Publish scheduler: lost the leader lock";
+
+    if (listener_) {
+        listener_->unlisten(kChannel);
+        listener_.reset();
+    }
+    if (timer_) {
+        loop()->invalidateTimer(*timer_);
+        timer_.reset();
+    }
+    if (resyncTimer_) {
+        loop()->invalidateTimer(*resyncTimer_);
+        resyncTimer_.reset();
+    }
+    schedule_.clear();
+    scheduled_.store(0, std::memory_order_relaxed);
+}
+
+void PublishScheduler::load() {
+    if (loading_) return;
+    loading_ = true;
+    changesWhileLoading_.clear();
+
+    // Delays come from the database's clock, like the notifications'
+    DbRouter::instance().primary()->execSqlAsync(
+        "SELECT id, EXTRACT(EPOCH FROM scheduled_at - clock_timestamp())::float8 AS delay "
+        "FROM articles WHERE status = 'scheduled' AND scheduled_at IS NOT NULL",
+        [this](const drogon::orm::Result &result) {
+            auto now = Clock::now();
+            std::vector<std::pair<int, Clock::time_point>> rows;
+            rows.reserve(result.size());
+            for (const auto &row : result) {
+                rows.emplace_back(row["id"].as<int>(), now + seconds(row["delay"].as<double>()));
+            }
+            loop()->queueInLoop([this, rows = std::move(rows)]() {
+                loading_ = false;
+                auto pending = std::move(changesWhileLoading_);
+                changesWhileLoading_.clear();
+                if (!leader_) return;
+                schedule_.clear();
+                for (const auto &[articleId, due] : rows) schedule_.schedule(articleId, due);
+                for (const auto &[articleId, due] : pending) apply(articleId, due);
+                scheduled_.store(schedule_.size(), std::memory_order_relaxed);
+                arm();
+            });
+        },
+        [this](const drogon::orm::DrogonDbException &e) {
+            LOG_ERROR << "Publish scheduler: cannot load the schedule: " << e.base().what();
+            loop()->queueInLoop([this]() {
+                loading_ = false;
+                auto pending = std::move(changesWhileLoading_);
+                changesWhileLoading_.clear();
+                for (const auto &[articleId, due] : pending) apply(articleId, due);
+                loop()->runAfter(kRetrySeconds, [this]() {
+                    if (leader_) load();
+                });
+            });
+        });
+}
+
+void PublishScheduler::apply(int articleId, std::optional<Clock::time_point> due) {
+    if (!leader_) return;
+    if (loading_) {
+        changesWhileLoading_.emplace_back(articleId, due);
+        return;
+    }
+    if (due) {
+        schedule_.schedule(articleId, *due);
+    } else {
+        schedule_.cancel(articleId);
+    }
+    scheduled_.store(schedule_.size(), std::memory_order_relaxed);
+    arm();
+}
+
+void PublishScheduler::arm() {
+    // A run in flight re-arms when it finishes
+    if (!leader_ || publishing_) return;
+
+    auto next = schedule_.next();
+    if (!next) {
+        if (timer_) {
+            loop()->invalidateTimer(*timer_);
+            timer_.reset();
+        }
+        return;
+    }
+    auto due = std::max(*next, notBefore_);
+    if (timer_ && armedFor_ == due) return;
+    if (timer_) loop()->invalidateTimer(*timer_);
+
+    armedFor_ = due;
+    double delay = std::chrono::duration<double>(due - Clock::now()).count();
+    timer_ = loop()->runAfter(std::max(0.0, delay), [this]() {
+        timer_.reset();
+        fire();
+    });
+}
+
+void PublishScheduler::fire() {
+    if (!leader_ || publishing_) return;
+    publishing_ = true;
+
+    // The lock lives as long as the session that took it; a reconnect
+    // behind our back means another node may be leading by now
+    lockClient_->execSqlAsync(
+        "SELECT pg_backend_pid() AS pid",
+        [this](const drogon::orm::Result &result) {
+            int pid = result[0]["pid"].as<int>();
+            loop()->queueInLoop([this, pid]() {
+                if (pid != backendPid_) {
+                    publishing_ = false;
+                    stepDown();
+                    acquire();
+                    return;
+                }
+                publish();
+            });
+        },
+        [this](const drogon::orm::DrogonDbException &e) {
+            LOG_WARN << "Publish scheduler: cannot check the leader lock: " << e.base().what();
+            loop()->queueInLoop([this]() {
+                publishing_ = false;
+                stepDown();
+                acquire();
+            });
+        });
+}
+
+void PublishScheduler::publish() {
+    runs_.fetch_add(1, std::memory_order_relaxed);
+    static ArticleService articleService;
+    articleService.publishDueArticles(
+        DbRouter::instance().primary(),
+        [this](bool success, const std::vector<int> &published) {
+            loop()->queueInLoop([this, success, published]() {
+                publishing_ = false;
+                auto now = Clock::now();
+                if (!success) {
+                    failures_.fetch_add(1, std::memory_order_relaxed);
+                    notBefore_ = now + seconds(kRetrySeconds);
+                    arm();
+                    return;
+                }
+                if (!published.empty()) {
+                    published_.fetch_add(published.size(), std::memory_order_relaxed);
+                    LOG_INFO << "Scheduled publishing: " << published.size() << " articles published";
+                }
+                for (int articleId : published) schedule_.cancel(articleId);
+                scheduled_.store(schedule_.size(), std::memory_order_relaxed);
+
+                // Something we think is due did not publish: the article
+                // changed and its notification has not arrived yet. Reload
+                // instead of firing again straight away.
+                auto next = schedule_.next();
+                if (next && *next <= now) {
+                    notBefore_ = now + seconds(kReloadSeconds);
+                    load();
+                }
+                arm();
+            });
+        });
+}
+
+} // namespace pyracms
@@ -0,0 +1,294 @@
+#include "services/RedisClient.h"
+
+#include <trantor/net/EventLoop.h>
+#include <trantor/net/TcpClient.h>
+#include <trantor/utils/Logger.h>
+
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace pyracms {
+
+namespace {
+
+const RespValue &nilReply() {
+    static const RespValue reply;
+    return reply;
+}
+
+} // namespace
+
+// One TCP connection bound to one event loop. All members are only touched
+// from that loop's thread.
+class RedisClient::Connection : public std::enable_shared_from_this<Connection> {
+public:
+    Connection(RedisClient &owner, trantor::EventLoop *loop) : owner_(owner), loop_(loop) {}
+
+    ~Connection() {
+        loop_->invalidateTimer(timeoutTimer_);
+        failAll();
+    }
+
+    void start() {
+        std::weak_ptr<Connection> weak = shared_from_this();
+        client_ = std::make_shared<trantor::TcpClient>(loop_, owner_.serverAddr_, "RedisClient");
+        client_->enableRetry();
+        client_->setConnectionCallback([weak](const trantor::TcpConnectionPtr &conn) {
+            if (auto self = weak.lock()) self->onConnection(conn);
+        });
+        client_->setConnectionErrorCallback([weak]() {
+            if (auto self = weak.lock()) self->onConnectError();
+        });
+        client_->setMessageCallback([weak](const trantor::TcpConnectionPtr &,
+                                           trantor::MsgBuffer *buf) {
+            if (auto self = weak.lock()) self->onMessage(buf);
+        });
+        timeoutTimer_ = loop_->runEvery(kCommandTimeoutSeconds / 4, [weak]() {
+            if (auto self = weak.lock()) self->checkTimeouts();
+        });
+        state_ = State::Connecting;
+        client_->connect();
+    }
+
+    // Switches this connection to pub/sub mode: subscribeCmd is sent on every
+    // (re)connect and incoming messages go to onMessage instead of the queue.
+    void setSubscription(std::string subscribeCmd, MessageCallback onMessage) {
+        subscribeCmd_ = std::move(subscribeCmd);
+        onPubSubMessage_ = std::move(onMessage);
+    }
+
+    void send(std::string &&payload, ReplyCallback &&cb) {
+        // Fail fast while Redis is unreachable or saturated rather than
+        // queueing unbounded work behind a dead socket.
+        if (state_ == State::Down || inFlight_.size() >= kMaxInFlight) {
+            cb(nilReply());
+            return;
+        }
+        inFlight_.push_back({std::move(cb), std::chrono::steady_clock::now()});
+        if (state_ == State::Up) {
+            conn_->send(std::move(payload));
+        } else {
+            pendingOut_ += payload;
+        }
+    }
+
+private:
+    enum class State { Connecting, Up, Down };
+
+    struct InFlight {
+        ReplyCallback cb;
+        std::chrono::steady_clock::time_point sentAt;
+    };
+
+    void onConnection(const trantor::TcpConnectionPtr &conn) {
+        if (conn->connected()) {
+            conn->setTcpNoDelay(true);
+            conn_ = conn;
+            state_ = State::Up;
+            if (onPubSubMessage_) {
+                conn_->send(subscribeCmd_);
+                return;
+            }
+            owner_.connected_ = true;
+            if (!pendingOut_.empty()) {
+                conn_->send(std::move(pendingOut_));
+                pendingOut_.clear();
+            }
+            return;
+        }
+        // Disconnected — replies for anything in flight will never arrive.
+        // TcpClient reconnects on its own because retry is enabled.
+        conn_.reset();
+        needed_ = 0;
+        state_ = State::Connecting;
+        if (!onPubSubMessage_) owner_.connected_ = false;
+        failAll();
+    }
+
+    void onConnectError() {
+        // Commands queued while connecting have been failed, so their bytes
+        // must not go out on the next connect or replies would be matched to
+        // newer callbacks. Stay Down (failing fast) until TcpClient's own
+        // retry gets through.
+        state_ = State::Down;
+        if (!onPubSubMessage_) owner_.connected_ = false;
+        pendingOut_.clear();
+        failAll();
+    }
+
+    void onMessage(trantor::MsgBuffer *buf) {
+        // Replies are parsed straight out of the socket buffer; a partially
+        // received value leaves needed_ set so it is not rescanned until
+        // enough bytes have arrived to possibly complete it.
+        RespValue reply;
+        while (buf->readableBytes() > 0 && buf->readableBytes() >= needed_) {
+            size_t consumed = 0;
+            auto st = RespReader::parse(buf->peek(), buf->readableBytes(), reply, consumed,
+                                        needed_);
+            if (st == RespReader::Status::Incomplete) return;
+            if (st == RespReader::Status::Ok && onPubSubMessage_) {
+                // ["message", channel, payload]; subscribe confirmations are ignored
+                if (reply.elements.size() == 3 && reply.elements[0].str == "message") {
+                    onPubSubMessage_(reply.elements[2].str);
+                }
+                buf->retrieve(consumed);
+                continue;
+            }
+            if (st == RespReader::Status::ProtocolError || inFlight_.empty()) {
+                LOG_ERROR << "Redis protocol error — dropping connection";
+                buf->retrieveAll();
+                needed_ = 0;
+                conn_->forceClose();
+                return;
+            }
+            // Out-of-band RESP3 pushes are not replies to a queued command
+            if (reply.type == RespValue::Type::Push) {
+                buf->retrieve(consumed);
+                continue;
+            }
+            auto cb = std::move(inFlight_.front().cb);
+            inFlight_.pop_front();
+            cb(reply);
+            buf->retrieve(consumed);
+        }
+    }
+
+    void checkTimeouts() {
+        if (inFlight_.empty()) return;
+        auto age = std::chrono::steady_clock::now() - inFlight_.front().sentAt;
+        if (age < std::chrono::duration<double>(kCommandTimeoutSeconds)) return;
+        LOG_WARN << "Redis command timed out — resetting connection";
+        if (conn_) {
+            conn_->forceClose();
+        } else {
+            pendingOut_.clear();
+            failAll();
+        }
+    }
+
+    void failAll() {
+        auto pending = std::move(inFlight_);
+        inFlight_.clear();
+        for (auto &req : pending) {
+            req.cb(nilReply());
+        }
+    }
+
+    RedisClient &owner_;
+    trantor::EventLoop *loop_;
+    std::shared_ptr<trantor::TcpClient> client_;
+    trantor::TcpConnectionPtr conn_;
+    State state_ = State::Connecting;
+    std::string pendingOut_;
+    std::deque<InFlight> inFlight_;
+    size_t needed_ = 0;
+    std::string subscribeCmd_;
+    MessageCallback onPubSubMessage_;
+    trantor::TimerId timeoutTimer_{0};
+};
+
+RedisClient::RedisClient(std::string host, int port) : host_(std::move(host)), port_(port) {}
+
+RedisClient::~RedisClient() = default;
+
+bool RedisClient::start() {
+    struct addrinfo hints{}, *res;
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    if (getaddrinfo(host_.c_str(), std::to_string(port_).c_str(), &hints, &res) != 0) {
+        return false;
+    }
+    serverAddr_ = trantor::InetAddress(*reinterpret_cast<struct sockaddr_in *>(res->ai_addr));
+
+    // Reachability probe with the same 2-second budget the old client used
+    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    bool ok = false;
+    if (fd >= 0) {
+        struct timeval tv;
+        tv.tv_sec = 2;
+        tv.tv_usec = 0;
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        ok = connect(fd, res->ai_addr, res->ai_addrlen) == 0;
+        ::close(fd);
+    }
+    freeaddrinfo(res);
+
+    if (ok) {
+        fallbackLoop_ = std::make_unique<trantor::EventLoopThread>("RedisFallbackLoop");
+        fallbackLoop_->run();
+    }
+    connected_ = ok;
+    return ok;
+}
+
+bool RedisClient::isConnected() const {
+    return connected_;
+}
+
+std::string RedisClient::encodeCommand(const std::vector<std::string> &args) {
+    size_t size = 16;
+    for (const auto &arg : args) size += arg.size() + 16;
+
+    std::string cmd;
+    cmd.reserve(size);
+    cmd += '*';
+    cmd += std::to_string(args.size());
+    cmd += "\r\n";
+    for (const auto &arg : args) {
+        cmd += '$';
+        cmd += std::to_string(arg.size());
+        cmd += "\r\n";
+        cmd += arg;
+        cmd += "\r\n";
+    }
+    return cmd;
+}
+
+std::shared_ptr<RedisClient::Connection> RedisClient::localConnection(trantor::EventLoop *loop) {
+    // One connection per (client, loop); the loop owns its thread, so a
+    // thread-local map needs no synchronization.
+    thread_local std::unordered_map<const RedisClient *, std::shared_ptr<Connection>> connections;
+    auto &conn = connections[this];
+    if (!conn) {
+        conn = std::make_shared<Connection>(*this, loop);
+        conn->start();
+    }
+    return conn;
+}
+
+void RedisClient::command(const std::vector<std::string> &args, ReplyCallback cb) {
+    if (!fallbackLoop_) {
+        cb(nilReply());
+        return;
+    }
+    auto payload = encodeCommand(args);
+    if (auto *loop = trantor::EventLoop::getEventLoopOfCurrentThread()) {
+        localConnection(loop)->send(std::move(payload), std::move(cb));
+        return;
+    }
+    auto *loop = fallbackLoop_->getLoop();
+    loop->queueInLoop([this, loop, payload = std::move(payload), cb = std::move(cb)]() mutable {
+        localConnection(loop)->send(std::move(payload), std::move(cb));
+    });
+}
+
+void RedisClient::subscribe(const std::string &channel, MessageCallback cb) {
+    if (!fallbackLoop_) return;
+    auto *loop = fallbackLoop_->getLoop();
+    loop->queueInLoop([this, loop, cmd = encodeCommand({"SUBSCRIBE", channel}),
+                       cb = std::move(cb)]() mutable {
+        auto conn = std::make_shared<Connection>(*this, loop);
+        conn->setSubscription(std::move(cmd), std::move(cb));
+        conn->start();
+        subscribers_.push_back(std::move(conn));
+    });
+}
+
+} // namespace pyracms
@@ -0,0 +1,117 @@
+#include "services/RenderService.h"
+#include "services/DbRouter.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace pyracms {
+
+namespace {
+
+constexpr std::chrono::hours kCacheTtl{24};
+
+std::string cacheKey(int revisionId, const std::string &renderer) {
+    return "render:" + std::to_string(revisionId) + ":" + renderer;
+}
+
+// Summary length, summary, then the HTML, as one cache value
+std::string encode(const ArticleRenderer::Output &output) {
+    std::string out;
+    uint32_t size = static_cast<uint32_t>(output.summary.size());
+    out.reserve(sizeof(size) + output.summary.size() + output.html.size());
+    out.append(reinterpret_cast<const char *>(&size), sizeof(size));
+    out += output.summary;
+    out += output.html;
+    return out;
+}
+
+ArticleRenderer::Output decode(const std::string &value) {
+    uint32_t size = 0;
+    std::memcpy(&size, value.data(), sizeof(size));
+    ArticleRenderer::Output output;
+    output.summary = value.substr(sizeof(size), size);
+    output.html = value.substr(sizeof(size) + size);
+    return output;
+}
+
+size_t cacheBudget() {
+    const char *mb = std::getenv("RENDER_CACHE_MB");
+    size_t megabytes = mb ? static_cast<size_t>(std::atoll(mb)) : 64;
+    return megabytes * 1024 * 1024;
+}
+
+} // namespace
+
+RenderService &RenderService::instance() {
+    static RenderService service;
+    return service;
+}
+
+RenderService::RenderService()
+    : cache_(cacheBudget()),
+      loopThread_(std::make_unique<trantor::EventLoopThread>("RenderLoop")) {
+    loopThread_->run();
+}
+
+ArticleRenderer::Output RenderService::render(int revisionId, const std::string &renderer,
+                                              const std::string &content) {
+    auto name = ArticleRenderer::normalize(renderer);
+    auto key = cacheKey(revisionId, name);
+    if (auto hit = cache_.get(key)) {
+        cacheHits_.fetch_add(1, std::memory_order_relaxed);
+        return decode(*hit);
+    }
+    auto output = ArticleRenderer::render(name, content);
+    rendered_.fetch_add(1, std::memory_order_relaxed);
+    cache_.put(key, encode(output), kCacheTtl);
+    store(revisionId, name, output);
+    return output;
+}
+
+void RenderService::renderInBackground(int revisionId, const std::string &renderer,
+                                       std::string content) {
+    loopThread_->getLoop()->queueInLoop(
+        [this, revisionId, name = ArticleRenderer::normalize(renderer),
+         content = std::move(content)]() {
+            auto key = cacheKey(revisionId, name);
+            if (cache_.get(key)) return;
+            auto output = ArticleRenderer::render(name, content);
+            rendered_.fetch_add(1, std::memory_order_relaxed);
+            cache_.put(key, encode(output), kCacheTtl);
+            store(revisionId, name, output);
+        });
+}
+
+void RenderService::store(int revisionId, const std::string &renderer,
+                          const ArticleRenderer::Output &output) {
+    // A render from an older build never replaces a newer one
+    DbRouter::instance().primary()->execSqlAsync(
+        "INSERT INTO article_renders (revision_id, renderer, version, html, summary, "
+        "rendered_at) VALUES ($1, $2, $3, $4, $5, NOW()) "
+        "ON CONFLICT (revision_id, renderer) DO UPDATE SET "
+        "version = EXCLUDED.version, html = EXCLUDED.html, summary = EXCLUDED.summary, "
+        "rendered_at = EXCLUDED.rendered_at "
+        "WHERE article_renders.version < EXCLUDED.version",
+        [this](const drogon::orm::Result &) {
+            stored_.fetch_add(1, std::memory_order_relaxed);
+        },
+        [this, revisionId](const drogon::orm::DrogonDbException &e) {
+            // The revision may have been deleted with its article meanwhile
+            storeFailures_.fetch_add(1, std::memory_order_relaxed);
+            LOG_ERROR << "RenderService: cannot store render of revision " << revisionId
+                      << ": " << e.base().what();
+        },
+        revisionId, renderer, ArticleRenderer::kVersion, output.html, output.summary);
+}
+
+RenderService::Stats RenderService::stats() const {
+    Stats stats;
+    stats.cacheHits = cacheHits_.load(std::memory_order_relaxed);
+    stats.rendered = rendered_.load(std::memory_order_relaxed);
+    stats.stored = stored_.load(std::memory_order_relaxed);
+    stats.storeFailures = storeFailures_.load(std::memory_order_relaxed);
+    stats.cacheBytes = cache_.stats().bytes;
+    return stats;
+}
+
+} // namespace pyracms
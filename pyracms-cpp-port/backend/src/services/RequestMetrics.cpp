@@ -0,0 +1,303 @@
+#include "services/RequestMetrics.h"
+
+#include <cstdio>
+#include <unordered_map>
+
+namespace pyracms {
+
+namespace {
+
+// Status codes tracked individually per route per thread; a route that
+// sees more distinct codes than this lumps the rest under code 0.
+constexpr size_t kStatusSlots = 12;
+
+// Boundaries of the exported Prometheus histogram, in seconds. The internal
+// buckets are much finer; each is counted at the first boundary at or above
+// its upper bound.
+constexpr double kExportBounds[] = {0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+                                    0.1,    0.25,  0.5,    1.0,   2.5,  5.0,   10.0};
+
+constexpr double kExportQuantiles[] = {0.5, 0.95, 0.99};
+
+// Single-writer increment: only the owning thread writes a slab, so a plain
+// load/store pair is enough and avoids a locked read-modify-write.
+template <typename T>
+void bump(std::atomic<T> &counter, T n) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+std::atomic<uint64_t> nextInstanceId{1};
+
+std::string formatSeconds(double seconds) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", seconds);
+    return buf;
+}
+
+} // namespace
+
+// ── Prometheus helpers ───────────────────────────────────────────────────────
+
+std::string escapePrometheusLabel(std::string_view value) {
+    std::string out;
+    out.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+void appendLatencyHistogram(std::string &out, std::string_view name, std::string_view labels,
+                            const std::vector<uint64_t> &counts, uint64_t sumMicros) {
+    std::string prefix(name);
+    std::string sep = labels.empty() ? "" : ",";
+    size_t i = 0;
+    uint64_t cumulative = 0;
+    for (double bound : kExportBounds) {
+        auto boundMicros = static_cast<uint64_t>(bound * 1e6);
+        while (i < counts.size() && LatencyBuckets::upperBound(i) <= boundMicros) {
+            cumulative += counts[i++];
+        }
+        out += prefix + "_bucket{" + std::string(labels) + sep + "le=\"" + formatSeconds(bound) +
+               "\"} " + std::to_string(cumulative) + "\n";
+    }
+    while (i < counts.size()) cumulative += counts[i++];
+    out += prefix + "_bucket{" + std::string(labels) + sep + "le=\"+Inf\"} " +
+           std::to_string(cumulative) + "\n";
+    out += prefix + "_sum{" + std::string(labels) + "} " +
+           formatSeconds(static_cast<double>(sumMicros) / 1e6) + "\n";
+    out += prefix + "_count{" + std::string(labels) + "} " + std::to_string(cumulative) + "\n";
+}
+
+// ── LatencyBuckets ───────────────────────────────────────────────────────────
+
+size_t LatencyBuckets::indexFor(uint64_t micros) {
+    if (micros < static_cast<uint64_t>(kLinear)) return static_cast<size_t>(micros);
+    int exponent = 63 - __builtin_clzll(micros);
+    if (exponent > kMaxExponent) return kCount - 1;
+    auto sub = static_cast<size_t>((micros >> (exponent - kSubBits)) & ((1 << kSubBits) - 1));
+    return kLinear + static_cast<size_t>(exponent - 4) * (1 << kSubBits) + sub;
+}
+
+uint64_t LatencyBuckets::upperBound(size_t i) {
+    if (i < static_cast<size_t>(kLinear)) return i;
+    size_t rel = i - kLinear;
+    int exponent = 4 + static_cast<int>(rel >> kSubBits);
+    uint64_t sub = rel & ((1 << kSubBits) - 1);
+    uint64_t width = uint64_t{1} << (exponent - kSubBits);
+    return (((uint64_t{1} << kSubBits) + sub) << (exponent - kSubBits)) + width - 1;
+}
+
+uint64_t LatencyBuckets::quantile(const std::vector<uint64_t> &counts, double q) {
+    uint64_t total = 0;
+    for (auto n : counts) total += n;
+    if (total == 0) return 0;
+    auto rank = static_cast<uint64_t>(q * static_cast<double>(total));
+    if (rank >= total) rank = total - 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen > rank) return upperBound(i);
+    }
+    return upperBound(counts.size() - 1);
+}
+
+// ── Per-thread recorder ──────────────────────────────────────────────────────
+
+struct RequestMetrics::RouteSlab {
+    explicit RouteSlab(std::string_view route) : name(route) {}
+
+    std::string name;
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sumMicros{0};
+    std::atomic<uint64_t> requestBytes{0};
+    std::atomic<uint64_t> responseBytes{0};
+    // Slot i counts statusCounts[i] responses with code statusCodes[i]; the
+    // extra last count is the overflow bucket.
+    std::array<std::atomic<int>, kStatusSlots> statusCodes{};
+    std::array<std::atomic<uint64_t>, kStatusSlots + 1> statusCounts{};
+    std::array<std::atomic<uint64_t>, LatencyBuckets::kCount> buckets{};
+
+    void recordStatus(int status) {
+        for (size_t i = 0; i < kStatusSlots; ++i) {
+            int code = statusCodes[i].load(std::memory_order_relaxed);
+            if (code == status) {
+                bump(statusCounts[i], uint64_t{1});
+                return;
+            }
+            if (code == 0) {
+                // Publish the count before the code so a scrape never pairs
+                // the new code with a stale count from another slot.
+                bump(statusCounts[i], uint64_t{1});
+                statusCodes[i].store(status, std::memory_order_release);
+                return;
+            }
+        }
+        bump(statusCounts[kStatusSlots], uint64_t{1});
+    }
+};
+
+// Routes are only ever added by the owning thread. It looks them up
+// without the lock (concurrent scrapes only read the map) and takes the
+// lock just to insert, which happens once per route per thread.
+struct RequestMetrics::Recorder {
+    std::atomic<int64_t> inFlight{0};
+    std::mutex mu;
+    std::unordered_map<std::string_view, std::unique_ptr<RouteSlab>> routes;
+
+    RouteSlab &slabFor(std::string_view route) {
+        auto it = routes.find(route);
+        if (it != routes.end()) return *it->second;
+        auto slab = std::make_unique<RouteSlab>(route);
+        std::string_view key(slab->name);
+        std::lock_guard<std::mutex> lock(mu);
+        return *routes.emplace(key, std::move(slab)).first->second;
+    }
+};
+
+// ── RequestMetrics ───────────────────────────────────────────────────────────
+
+RequestMetrics &RequestMetrics::instance() {
+    static RequestMetrics metrics;
+    return metrics;
+}
+
+RequestMetrics::RequestMetrics() : id_(nextInstanceId.fetch_add(1)) {}
+
+RequestMetrics::~RequestMetrics() = default;
+
+RequestMetrics::Recorder &RequestMetrics::localRecorder() {
+    // Keyed by instance id rather than address so a recorder can never be
+    // picked up by a later instance that happens to reuse the memory.
+    thread_local uint64_t cachedId = 0;
+    thread_local Recorder *cached = nullptr;
+    thread_local std::unordered_map<uint64_t, std::shared_ptr<Recorder>> recorders;
+    if (cachedId == id_) return *cached;
+
+    auto &slot = recorders[id_];
+    if (!slot) {
+        slot = std::make_shared<Recorder>();
+        std::lock_guard<std::mutex> lock(recordersMutex_);
+        recorders_.push_back(slot);
+    }
+    cachedId = id_;
+    cached = slot.get();
+    return *cached;
+}
+
+void RequestMetrics::requestStarted() {
+    bump(localRecorder().inFlight, int64_t{1});
+}
+
+void RequestMetrics::requestFinished(std::string_view route, int status, uint64_t latencyMicros,
+                                     uint64_t requestBytes, uint64_t responseBytes) {
+    auto &recorder = localRecorder();
+    bump(recorder.inFlight, int64_t{-1});
+
+    auto &slab = recorder.slabFor(route.empty() ? std::string_view("unmatched") : route);
+    bump(slab.count, uint64_t{1});
+    bump(slab.sumMicros, latencyMicros);
+    bump(slab.requestBytes, requestBytes);
+    bump(slab.responseBytes, responseBytes);
+    bump(slab.buckets[LatencyBuckets::indexFor(latencyMicros)], uint64_t{1});
+    slab.recordStatus(status);
+}
+
+RequestMetrics::Snapshot RequestMetrics::snapshot() const {
+    std::vector<std::shared_ptr<Recorder>> recorders;
+    {
+        std::lock_guard<std::mutex> lock(recordersMutex_);
+        recorders = recorders_;
+    }
+
+    Snapshot snap;
+    for (const auto &recorder : recorders) {
+        snap.inFlight += recorder->inFlight.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(recorder->mu);
+        for (const auto &[name, slab] : recorder->routes) {
+            auto &out = snap.routes[slab->name];
+            out.count += slab->count.load(std::memory_order_relaxed);
+            out.sumMicros += slab->sumMicros.load(std::memory_order_relaxed);
+            out.requestBytes += slab->requestBytes.load(std::memory_order_relaxed);
+            out.responseBytes += slab->responseBytes.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < LatencyBuckets::kCount; ++i) {
+                out.buckets[i] += slab->buckets[i].load(std::memory_order_relaxed);
+            }
+            for (size_t i = 0; i < kStatusSlots; ++i) {
+                int code = slab->statusCodes[i].load(std::memory_order_acquire);
+                if (code == 0) break;
+                out.statuses[code] += slab->statusCounts[i].load(std::memory_order_relaxed);
+            }
+            if (auto other = slab->statusCounts[kStatusSlots].load(std::memory_order_relaxed)) {
+                out.statuses[0] += other;
+            }
+        }
+    }
+    return snap;
+}
+
+std::string RequestMetrics::renderPrometheus() const {
+    auto snap = snapshot();
+    std::string out;
+    out.reserve(256 + snap.routes.size() * 2048);
+
+    out += "# HELP pyracms_http_requests_in_flight Requests currently being handled.\n"
+           "# TYPE pyracms_http_requests_in_flight gauge\n"
+           "pyracms_http_requests_in_flight " +
+           std::to_string(snap.inFlight) + "\n";
+
+    out += "# HELP pyracms_http_request_duration_seconds Request latency by route pattern.\n"
+           "# TYPE pyracms_http_request_duration_seconds histogram\n";
+    for (const auto &[route, r] : snap.routes) {
+        appendLatencyHistogram(out, "pyracms_http_request_duration_seconds",
+                               "route=\"" + escapePrometheusLabel(route) + "\"", r.buckets,
+                               r.sumMicros);
+    }
+
+    out += "# HELP pyracms_http_request_duration_quantile_seconds Latency quantiles from the "
+           "fine-grained histogram.\n"
+           "# TYPE pyracms_http_request_duration_quantile_seconds gauge\n";
+    for (const auto &[route, r] : snap.routes) {
+        auto label = "route=\"" + escapePrometheusLabel(route) + "\"";
+        for (double q : kExportQuantiles) {
+            out += "pyracms_http_request_duration_quantile_seconds{" + label + ",quantile=\"" +
+                   formatSeconds(q) + "\"} " +
+                   formatSeconds(static_cast<double>(r.quantileMicros(q)) / 1e6) + "\n";
+        }
+    }
+
+    out += "# HELP pyracms_http_responses_total Responses by route pattern and status code.\n"
+           "# TYPE pyracms_http_responses_total counter\n";
+    for (const auto &[route, r] : snap.routes) {
+        auto label = "route=\"" + escapePrometheusLabel(route) + "\"";
+        for (const auto &[code, n] : r.statuses) {
+            out += "pyracms_http_responses_total{" + label + ",code=\"" +
+                   (code ? std::to_string(code) : std::string("other")) + "\"} " +
+                   std::to_string(n) + "\n";
+        }
+    }
+
+    out += "# HELP pyracms_http_request_bytes_total Request body bytes by route pattern.\n"
+           "# TYPE pyracms_http_request_bytes_total counter\n";
+    for (const auto &[route, r] : snap.routes) {
+        out += "pyracms_http_request_bytes_total{route=\"" + escapePrometheusLabel(route) + "\"} " +
+               std::to_string(r.requestBytes) + "\n";
+    }
+
+    out += "# HELP pyracms_http_response_bytes_total Response body bytes by route pattern.\n"
+           "# TYPE pyracms_http_response_bytes_total counter\n";
+    for (const auto &[route, r] : snap.routes) {
+        out += "pyracms_http_response_bytes_total{route=\"" + escapePrometheusLabel(route) + "\"} " +
+               std::to_string(r.responseBytes) + "\n";
+    }
+    return out;
+}
+
+} // namespace pyracms
@@ -0,0 +1,252 @@
+#include "services/RespReader.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace pyracms {
+
+namespace {
+
+using Status = RespReader::Status;
+
+bool parseInteger(std::string_view s, long long &out) {
+    if (s.empty()) return false;
+    size_t i = 0;
+    bool negative = false;
+    if (s[0] == '-' || s[0] == '+') {
+        negative = s[0] == '-';
+        i = 1;
+        if (s.size() == 1) return false;
+    }
+    long long v = 0;
+    for (; i < s.size(); ++i) {
+        char c = s[i];
+        if (c < '0' || c > '9') return false;
+        if (v > (std::numeric_limits<long long>::max() - (c - '0')) / 10) return false;
+        v = v * 10 + (c - '0');
+    }
+    out = negative ? -v : v;
+    return true;
+}
+
+// Read the header line starting at pos (after the type byte). On success,
+// line holds its content and pos points past the CRLF.
+Status readLine(const char *data, size_t len, size_t &pos, std::string_view &line,
+                size_t &needed) {
+    const char *start = data + pos;
+    const char *cr = static_cast<const char *>(memchr(start, '\r', len - pos));
+    if (!cr) {
+        needed = len + 2;
+        return Status::Incomplete;
+    }
+    size_t crPos = static_cast<size_t>(cr - data);
+    if (crPos + 1 >= len) {
+        needed = crPos + 2;
+        return Status::Incomplete;
+    }
+    if (data[crPos + 1] != '\n') return Status::ProtocolError;
+    line = std::string_view(start, crPos - pos);
+    pos = crPos + 2;
+    return Status::Ok;
+}
+
+Status parseValue(const char *data, size_t len, size_t &pos, RespValue &out, size_t &needed,
+                  int depth) {
+    if (depth > RespReader::kMaxDepth) return Status::ProtocolError;
+    if (pos >= len) {
+        needed = pos + 3;
+        return Status::Incomplete;
+    }
+
+    char marker = data[pos++];
+    std::string_view line;
+    Status st = readLine(data, len, pos, line, needed);
+    if (st != Status::Ok) return st;
+
+    out.elements.clear();
+    switch (marker) {
+    case '+':
+        out.type = RespValue::Type::SimpleString;
+        out.str = line;
+        return Status::Ok;
+    case '-':
+        out.type = RespValue::Type::Error;
+        out.str = line;
+        return Status::Ok;
+    case ':':
+        out.type = RespValue::Type::Integer;
+        return parseInteger(line, out.integer) ? Status::Ok : Status::ProtocolError;
+    case '(':
+        out.type = RespValue::Type::BigNumber;
+        out.str = line;
+        return Status::Ok;
+    case '_':
+        out.type = RespValue::Type::Nil;
+        return line.empty() ? Status::Ok : Status::ProtocolError;
+    case '#':
+        if (line != "t" && line != "f") return Status::ProtocolError;
+        out.type = RespValue::Type::Boolean;
+        out.boolean = line == "t";
+        return Status::Ok;
+    case ',': {
+        out.type = RespValue::Type::Double;
+        std::string tmp(line);
+        char *end = nullptr;
+        out.number = std::strtod(tmp.c_str(), &end);
+        return end && *end == '\0' && !tmp.empty() ? Status::Ok : Status::ProtocolError;
+    }
+    case '$':
+    case '!':
+    case '=': {
+        long long n;
+        if (!parseInteger(line, n)) return Status::ProtocolError;
+        if (n < 0) {
+            if (marker != '$' || n != -1) return Status::ProtocolError;
+            out.type = RespValue::Type::Nil;
+            return Status::Ok;
+        }
+        if (static_cast<unsigned long long>(n) > RespReader::kMaxBulkLength) {
+            return Status::ProtocolError;
+        }
+        size_t end = pos + static_cast<size_t>(n);
+        if (len < end + 2) {
+            needed = end + 2;
+            return Status::Incomplete;
+        }
+        if (data[end] != '\r' || data[end + 1] != '\n') return Status::ProtocolError;
+        out.str = std::string_view(data + pos, static_cast<size_t>(n));
+        pos = end + 2;
+        if (marker == '$') {
+            out.type = RespValue::Type::BulkString;
+        } else if (marker == '!') {
+            out.type = RespValue::Type::BulkError;
+        } else {
+            // Verbatim strings carry a three-letter format and a colon
+            if (out.str.size() < 4 || out.str[3] != ':') return Status::ProtocolError;
+            out.type = RespValue::Type::VerbatimString;
+            out.str.remove_prefix(4);
+        }
+        return Status::Ok;
+    }
+    case '*':
+    case '~':
+    case '>':
+    case '%':
+    case '|': {
+        long long n;
+        if (!parseInteger(line, n)) return Status::ProtocolError;
+        if (n < 0) {
+            if (marker != '*' || n != -1) return Status::ProtocolError;
+            out.type = RespValue::Type::Nil;
+            return Status::Ok;
+        }
+        if (static_cast<unsigned long long>(n) > RespReader::kMaxAggregateLength) {
+            return Status::ProtocolError;
+        }
+        size_t count = static_cast<size_t>(n);
+        if (marker == '%' || marker == '|') count *= 2;
+        // Each element needs at least three bytes ("_\r\n"); bail out early
+        // rather than allocating for elements that have not arrived.
+        if (len - pos < count * 3) {
+            needed = pos + count * 3;
+            return Status::Incomplete;
+        }
+
+        if (marker == '|') {
+            // Attributes annotate the value that follows; skip them
+            RespValue ignored;
+            for (size_t i = 0; i < count; ++i) {
+                st = parseValue(data, len, pos, ignored, needed, depth + 1);
+                if (st != Status::Ok) return st;
+            }
+            return parseValue(data, len, pos, out, needed, depth);
+        }
+
+        switch (marker) {
+        case '*': out.type = RespValue::Type::Array; break;
+        case '~': out.type = RespValue::Type::Set; break;
+        case '>': out.type = RespValue::Type::Push; break;
+        default: out.type = RespValue::Type::Map; break;
+        }
+        std::vector<RespValue> elements(count);
+        for (auto &element : elements) {
+            st = parseValue(data, len, pos, element, needed, depth + 1);
+            if (st != Status::Ok) return st;
+        }
+        out.elements = std::move(elements);
+        return Status::Ok;
+    }
+    default:
+        return Status::ProtocolError;
+    }
+}
+
+} // namespace
+
+RespReader::Status RespReader::parse(const char *data, size_t len, RespValue &out,
+                                     size_t &consumed, size_t &needed) {
+    size_t pos = 0;
+    needed = 0;
+    Status st = parseValue(data, len, pos, out, needed, 0);
+    consumed = st == Status::Ok ? pos : 0;
+    return st;
+}
+
+void RespReader::feed(const char *data, size_t len) {
+    std::memcpy(prepare(len), data, len);
+    commit(len);
+}
+
+char *RespReader::prepare(size_t len) {
+    compact();
+    if (buf_.size() - end_ < len) {
+        size_t want = end_ + len;
+        buf_.resize(want > buf_.size() * 2 ? want : buf_.size() * 2);
+    }
+    return buf_.data() + end_;
+}
+
+void RespReader::commit(size_t len) {
+    end_ += len;
+}
+
+RespReader::Status RespReader::next(RespValue &out) {
+    begin_ += pendingConsume_;
+    pendingConsume_ = 0;
+    if (begin_ == end_) {
+        begin_ = end_ = 0;
+    }
+    if (buffered() == 0 || buffered() < needed_) return Status::Incomplete;
+
+    size_t consumed = 0;
+    size_t needed = 0;
+    Status st = parse(buf_.data() + begin_, buffered(), out, consumed, needed);
+    if (st == Status::Ok) {
+        pendingConsume_ = consumed;
+        needed_ = 0;
+    } else if (st == Status::Incomplete) {
+        needed_ = needed;
+    }
+    return st;
+}
+
+void RespReader::clear() {
+    begin_ = end_ = needed_ = pendingConsume_ = 0;
+}
+
+void RespReader::compact() {
+    begin_ += pendingConsume_;
+    pendingConsume_ = 0;
+    if (begin_ == 0) return;
+    // Only move bytes once the dead prefix dominates, keeping appends amortized O(1)
+    if (begin_ == end_) {
+        begin_ = end_ = 0;
+    } else if (begin_ >= buf_.size() / 2) {
+        std::memmove(buf_.data(), buf_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+}
+
+} // namespace pyracms
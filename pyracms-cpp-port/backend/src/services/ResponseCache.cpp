@@ -0,0 +1,167 @@
+#include "services/ResponseCache.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+namespace pyracms {
+
+ResponseCache &ResponseCache::instance() {
+    static ResponseCache cache([] {
+        const char *bytes = std::getenv("RESPONSE_CACHE_BYTES");
+        return bytes ? static_cast<size_t>(std::stoull(bytes)) : size_t{32} * 1024 * 1024;
+    }());
+    return cache;
+}
+
+ResponseCache::ResponseCache(size_t byteBudget, size_t shardCount) {
+    if (shardCount == 0) shardCount = 1;
+    shardBudget_ = byteBudget / shardCount;
+    shards_.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+std::string ResponseCache::makeKey(std::string_view route, int tenantId,
+                                   std::vector<std::pair<std::string, std::string>> params) {
+    params.erase(std::remove_if(params.begin(), params.end(),
+                                [](const auto &p) { return p.first == "tenant_id"; }),
+                 params.end());
+    std::sort(params.begin(), params.end());
+
+    std::string key(route);
+    key += '|';
+    key += std::to_string(tenantId);
+    // Length-prefixed so no value can forge a separator
+    for (const auto &[name, value] : params) {
+        key += '|';
+        key += std::to_string(name.size());
+        key += ':';
+        key += name;
+        key += std::to_string(value.size());
+        key += ':';
+        key += value;
+    }
+    return key;
+}
+
+std::atomic<uint64_t> &ResponseCache::generation(const std::string &surrogateKey) const {
+    return generations_[std::hash<std::string>{}(surrogateKey) % kGenerationSlots];
+}
+
+CachedResponse::Stamps ResponseCache::stamp(const std::vector<std::string> &surrogateKeys) const {
+    CachedResponse::Stamps stamps;
+    stamps.reserve(surrogateKeys.size());
+    for (const auto &key : surrogateKeys) {
+        stamps.emplace_back(key, generation(key).load(std::memory_order_acquire));
+    }
+    return stamps;
+}
+
+bool ResponseCache::current(const CachedResponse &response) const {
+    for (const auto &[key, stamped] : response.stamps) {
+        if (generation(key).load(std::memory_order_acquire) != stamped) return false;
+    }
+    return true;
+}
+
+void ResponseCache::purge(const std::string &surrogateKey) {
+    generation(surrogateKey).fetch_add(1, std::memory_order_acq_rel);
+    purges_.fetch_add(1, std::memory_order_relaxed);
+}
+
+ResponseCache::Shard &ResponseCache::shardFor(const std::string &key) {
+    return *shards_[std::hash<std::string>{}(key) % shards_.size()];
+}
+
+void ResponseCache::Shard::unlink(std::list<Slot>::iterator it) {
+    bytes -= it->charge;
+    index.erase(std::string_view(it->key));
+    lru.erase(it);
+}
+
+ResponseCache::Entry ResponseCache::get(const std::string &key) {
+    if (!enabled()) return nullptr;
+    Entry entry;
+    auto &shard = shardFor(key);
+    {
+        std::lock_guard<std::mutex> lock(shard.mu);
+        auto found = shard.index.find(std::string_view(key));
+        if (found != shard.index.end()) {
+            auto it = found->second;
+            if (Clock::now() < it->expiresAt) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it);
+                entry = it->entry;
+            } else {
+                shard.unlink(it);
+            }
+        }
+    }
+
+    // Purged entries are not erased eagerly; they fail this check and are
+    // replaced by the next put, or age out of the LRU.
+    if (!entry || !current(*entry)) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return entry;
+}
+
+ResponseCache::Entry ResponseCache::put(const std::string &key, CachedResponse response,
+                                        std::chrono::milliseconds ttl) {
+    size_t charge = key.size() + response.body.size() + response.contentType.size() +
+                    kEntryOverhead;
+    for (const auto &[name, value] : response.headers) charge += name.size() + value.size();
+    auto entry = std::make_shared<const CachedResponse>(std::move(response));
+    // Built from data that has since been purged: hand it back, don't keep it
+    if (!enabled() || charge > shardBudget_ || ttl.count() <= 0 || !current(*entry)) {
+        return entry;
+    }
+
+    auto &shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mu);
+    auto found = shard.index.find(std::string_view(key));
+    if (found != shard.index.end()) {
+        shard.unlink(found->second);
+    }
+    while (shard.bytes + charge > shardBudget_ && !shard.lru.empty()) {
+        shard.unlink(std::prev(shard.lru.end()));
+        ++shard.evictions;
+    }
+    shard.lru.push_front(Slot{key, entry, Clock::now() + ttl, charge});
+    shard.index.emplace(std::string_view(shard.lru.front().key), shard.lru.begin());
+    shard.bytes += charge;
+    stores_.fetch_add(1, std::memory_order_relaxed);
+    return entry;
+}
+
+ResponseCache::Stats ResponseCache::stats() const {
+    Stats total;
+    for (const auto &shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mu);
+        total.evictions += shard->evictions;
+        total.entries += shard->lru.size();
+        total.bytes += shard->bytes;
+    }
+    total.hits = hits_.load(std::memory_order_relaxed);
+    total.misses = misses_.load(std::memory_order_relaxed);
+    total.stores = stores_.load(std::memory_order_relaxed);
+    total.purges = purges_.load(std::memory_order_relaxed);
+    return total;
+}
+
+std::string ResponseCache::articleKey(int tenantId, const std::string &name) {
+    return "article:" + std::to_string(tenantId) + ":" + name;
+}
+
+std::string ResponseCache::articleListKey(int tenantId) {
+    return "articles:" + std::to_string(tenantId);
+}
+
+std::string ResponseCache::galleryKey(int tenantId) {
+    return "gallery:" + std::to_string(tenantId);
+}
+
+} // namespace pyracms
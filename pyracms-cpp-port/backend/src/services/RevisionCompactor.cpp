@@ -0,0 +1,187 @@
+#include "services/RevisionCompactor.h"
+#include "services/ArticleService.h"
+
+namespace pyracms {
+
+struct RevisionCompactor::Update {
+    int id = 0;
+    int16_t storage = 0;
+    int16_t previousStorage = 0;
+    int baseId = 0;
+    int chain = 0;
+    std::vector<char> body;
+    bool keepContent = false;
+};
+
+RevisionCompactor &RevisionCompactor::instance() {
+    static RevisionCompactor compactor;
+    return compactor;
+}
+
+bool RevisionCompactor::start(const DbClientPtr &db, int batchSize) {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (progress_.running) return false;
+        progress_ = Progress{};
+        progress_.running = true;
+    }
+    LOG_INFO << "Revision compaction started";
+    nextBatch(db, batchSize);
+    return true;
+}
+
+RevisionCompactor::Progress RevisionCompactor::progress() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return progress_;
+}
+
+void RevisionCompactor::finish(const std::string &error) {
+    std::lock_guard<std::mutex> lock(mu_);
+    progress_.running = false;
+    progress_.error = error;
+    if (error.empty()) {
+        LOG_INFO << "Revision compaction finished: " << progress_.articles << " articles, "
+                 << progress_.revisions << " revisions rewritten, " << progress_.bytesBefore
+                 << " -> " << progress_.bytesAfter << " bytes";
+    } else {
+        LOG_ERROR << "Revision compaction failed: " << error;
+    }
+}
+
+void RevisionCompactor::nextBatch(const DbClientPtr &db, int batchSize) {
+    db->execSqlAsync(
+        "SELECT DISTINCT r.article_id FROM article_revisions r "
+        "WHERE r.article_id > $1 AND (r.storage = 0 OR (r.content IS NOT NULL AND r.id <> "
+        "  (SELECT l.id FROM article_revisions l WHERE l.article_id = r.article_id "
+        "   ORDER BY l.created_at DESC, l.id DESC LIMIT 1))) "
+        "ORDER BY r.article_id LIMIT $2",
+        [this, db, batchSize](const drogon::orm::Result &result) {
+            if (result.empty()) {
+                finish("");
+                return;
+            }
+            auto ids = std::make_shared<std::vector<int>>();
+            for (const auto &row : result) ids->push_back(row["article_id"].as<int>());
+            compactBatch(db, batchSize, ids, 0);
+        },
+        [this](const drogon::orm::DrogonDbException &e) {
+            finish(e.base().what());
+        },
+        progress().lastArticleId, batchSize);
+}
+
+void RevisionCompactor::compactBatch(const DbClientPtr &db, int batchSize,
+                                     std::shared_ptr<const std::vector<int>> ids, size_t index) {
+    // One article at a time, then the next batch
+    if (index == ids->size()) {
+        nextBatch(db, batchSize);
+        return;
+    }
+    compactArticle(db, (*ids)[index], [this, db, batchSize, ids, index]() {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (!progress_.running) return;
+            progress_.lastArticleId = (*ids)[index];
+        }
+        compactBatch(db, batchSize, ids, index + 1);
+    });
+}
+
+void RevisionCompactor::compactArticle(const DbClientPtr &db, int articleId,
+                                       std::function<void()> then) {
+    db->execSqlAsync(
+        "SELECT id, storage, base_id, chain, content, body FROM article_revisions "
+        "WHERE article_id = $1 ORDER BY created_at, id",
+        [this, db, articleId, then](const drogon::orm::Result &result) {
+            auto &store = ArticleService::revisions();
+            std::vector<RevisionStore::Row> rows;
+            rows.reserve(result.size());
+            for (const auto &row : result) {
+                rows.push_back(ArticleService::rowToStoredRevision(row));
+            }
+            auto texts = store.rebuildAll(rows);
+            for (const auto &text : texts) {
+                if (text) continue;
+                LOG_ERROR << "Revision compaction: cannot rebuild article " << articleId;
+                std::lock_guard<std::mutex> lock(mu_);
+                ++progress_.failures;
+                then();
+                return;
+            }
+
+            auto updates = std::make_shared<std::vector<Update>>();
+            uint64_t before = 0;
+            uint64_t after = 0;
+            int chain = 0;
+            for (size_t i = 0; i < rows.size(); ++i) {
+                const auto &row = rows[i];
+                bool latest = i + 1 == rows.size();
+                auto encoded = store.encode(*texts[i], i ? &*texts[i - 1] : nullptr, chain);
+                chain = encoded.chain;
+                int baseId = encoded.storage == RevisionStore::Storage::Delta ? rows[i - 1].id : 0;
+
+                before += row.body.size() + (row.content ? row.content->size() : 0);
+                bool unchanged = row.storage == encoded.storage && row.baseId == baseId &&
+                                 result[i]["chain"].as<int>() == chain &&
+                                 (row.content.has_value() == latest);
+                if (unchanged) {
+                    after += row.body.size() + (row.content ? row.content->size() : 0);
+                    continue;
+                }
+                after += encoded.body.size() + (latest ? texts[i]->size() : 0);
+
+                Update update;
+                update.id = row.id;
+                update.storage = static_cast<int16_t>(encoded.storage);
+                update.previousStorage = static_cast<int16_t>(row.storage);
+                update.baseId = baseId;
+                update.chain = chain;
+                update.body.assign(encoded.body.begin(), encoded.body.end());
+                update.keepContent = latest;
+                updates->push_back(std::move(update));
+            }
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                ++progress_.articles;
+                progress_.bytesBefore += before;
+                progress_.bytesAfter += after;
+            }
+            write(db, updates, 0, then);
+        },
+        [this, then](const drogon::orm::DrogonDbException &e) {
+            finish(e.base().what());
+            then();
+        },
+        articleId);
+}
+
+void RevisionCompactor::write(const DbClientPtr &db,
+                              std::shared_ptr<const std::vector<Update>> updates, size_t index,
+                              std::function<void()> then) {
+    if (index == updates->size()) {
+        then();
+        return;
+    }
+    // Oldest first: each row's base is already rewritten, or still as it
+    // was, when the row stops holding its own text
+    const auto &update = (*updates)[index];
+    db->execSqlAsync(
+        "UPDATE article_revisions SET storage = $1, base_id = NULLIF($2, 0), chain = $3, "
+        "body = $4, content = CASE WHEN $5 THEN content ELSE NULL END "
+        "WHERE id = $6 AND storage = $7",
+        [this, db, updates, index, then](const drogon::orm::Result &result) {
+            if (result.affectedRows() > 0) {
+                std::lock_guard<std::mutex> lock(mu_);
+                ++progress_.revisions;
+            }
+            write(db, updates, index + 1, then);
+        },
+        [this, then](const drogon::orm::DrogonDbException &e) {
+            finish(e.base().what());
+            then();
+        },
+        update.storage, update.baseId, update.chain, update.body, update.keepContent,
+        update.id, update.previousStorage);
+}
+
+} // namespace pyracms
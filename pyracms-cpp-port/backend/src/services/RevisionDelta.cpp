@@ -0,0 +1,146 @@
+#include "services/RevisionDelta.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+namespace pyracms {
+
+namespace {
+
+constexpr uint8_t kInsert = 0;
+constexpr uint8_t kCopy = 1;
+constexpr uint64_t kHashBase = 1099511628211ull;
+
+void putVarint(std::string &out, uint64_t v) {
+    while (v >= 0x80) {
+        out += static_cast<char>((v & 0x7F) | 0x80);
+        v >>= 7;
+    }
+    out += static_cast<char>(v);
+}
+
+bool getVarint(std::string_view in, size_t &pos, uint64_t &v) {
+    v = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+        auto byte = static_cast<uint8_t>(in[pos++]);
+        v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+uint64_t hashBlock(const char *p) {
+    uint64_t h = 0;
+    for (size_t i = 0; i < RevisionDelta::kBlockBytes; ++i) {
+        h = h * kHashBase + static_cast<uint8_t>(p[i]);
+    }
+    return h;
+}
+
+void flushInsert(std::string &out, std::string_view literal) {
+    if (literal.empty()) return;
+    out += static_cast<char>(kInsert);
+    putVarint(out, literal.size());
+    out.append(literal);
+}
+
+} // namespace
+
+std::string RevisionDelta::diff(std::string_view base, std::string_view target) {
+    std::string out;
+    putVarint(out, base.size());
+    putVarint(out, target.size());
+
+    // First occurrence of each aligned block
+    std::unordered_map<uint64_t, size_t> blocks;
+    blocks.reserve(base.size() / kBlockBytes + 1);
+    for (size_t at = 0; at + kBlockBytes <= base.size(); at += kBlockBytes) {
+        blocks.emplace(hashBlock(base.data() + at), at);
+    }
+
+    // Weight of the byte leaving the window: kHashBase^(kBlockBytes - 1)
+    uint64_t outWeight = 1;
+    for (size_t i = 1; i < kBlockBytes; ++i) outWeight *= kHashBase;
+
+    size_t literalStart = 0;
+    size_t pos = 0;
+    uint64_t hash = 0;
+    bool hashValid = false;
+    while (pos + kBlockBytes <= target.size() && !blocks.empty()) {
+        if (!hashValid) {
+            hash = hashBlock(target.data() + pos);
+            hashValid = true;
+        }
+        auto it = blocks.find(hash);
+        if (it != blocks.end() &&
+            base.compare(it->second, kBlockBytes, target.substr(pos, kBlockBytes)) == 0) {
+            size_t from = it->second;
+            size_t length = kBlockBytes;
+            while (pos + length < target.size() && from + length < base.size() &&
+                   target[pos + length] == base[from + length]) {
+                ++length;
+            }
+            // Reclaim bytes of the pending literal that match too
+            size_t start = pos;
+            while (start > literalStart && from > 0 && target[start - 1] == base[from - 1]) {
+                --start;
+                --from;
+                ++length;
+            }
+            flushInsert(out, target.substr(literalStart, start - literalStart));
+            out += static_cast<char>(kCopy);
+            putVarint(out, from);
+            putVarint(out, length);
+            pos = start + length;
+            literalStart = pos;
+            hashValid = false;
+            continue;
+        }
+        if (pos + kBlockBytes < target.size()) {
+            hash = (hash - static_cast<uint8_t>(target[pos]) * outWeight) * kHashBase +
+                   static_cast<uint8_t>(target[pos + kBlockBytes]);
+        }
+        ++pos;
+    }
+    flushInsert(out, target.substr(literalStart));
+    return out;
+}
+
+bool RevisionDelta::apply(std::string_view base, std::string_view delta, std::string &out) {
+    size_t pos = 0;
+    uint64_t baseLength = 0;
+    uint64_t targetLength = 0;
+    if (!getVarint(delta, pos, baseLength) || !getVarint(delta, pos, targetLength)) return false;
+    if (baseLength != base.size()) return false;
+
+    // A corrupt length must not size the allocation; operations are checked
+    // against it as they append
+    std::string result;
+    result.reserve(std::min<uint64_t>(targetLength, base.size() + delta.size()));
+    while (pos < delta.size()) {
+        auto op = static_cast<uint8_t>(delta[pos++]);
+        uint64_t a = 0;
+        if (!getVarint(delta, pos, a)) return false;
+        if (op == kInsert) {
+            if (a > delta.size() - pos || a > targetLength - result.size()) return false;
+            result.append(delta.substr(pos, a));
+            pos += a;
+        } else if (op == kCopy) {
+            uint64_t length = 0;
+            if (!getVarint(delta, pos, length)) return false;
+            if (a > base.size() || length > base.size() - a ||
+                length > targetLength - result.size()) {
+                return false;
+            }
+            result.append(base.substr(a, length));
+        } else {
+            return false;
+        }
+    }
+    if (result.size() != targetLength) return false;
+    out = std::move(result);
+    return true;
+}
+
+} // namespace pyracms
@@ -0,0 +1,154 @@
+#include "services/RevisionStore.h"
+#include "services/RevisionDelta.h"
+
+#include <chrono>
+#include <unordered_map>
+#include <zstd.h>
+
+namespace pyracms {
+
+namespace {
+
+// Revisions never change, so cached text only ages out of the LRU
+constexpr std::chrono::hours kCacheTtl{24};
+
+} // namespace
+
+RevisionStore::RevisionStore() : RevisionStore(Options{}) {}
+
+RevisionStore::RevisionStore(Options options)
+    : options_(options), cache_(options.cacheBytes) {
+    if (options_.snapshotInterval < 1) options_.snapshotInterval = 1;
+}
+
+std::string RevisionStore::compress(std::string_view data) const {
+    std::string out(ZSTD_compressBound(data.size()), '\0');
+    size_t size = ZSTD_compress(out.data(), out.size(), data.data(), data.size(),
+                                options_.compressionLevel);
+    // Only fails for a bad level or a short buffer, neither possible here
+    out.resize(ZSTD_isError(size) ? 0 : size);
+    return out;
+}
+
+bool RevisionStore::decompress(std::string_view data, std::string &out, size_t maxBytes) {
+    auto size = ZSTD_getFrameContentSize(data.data(), data.size());
+    if (size == ZSTD_CONTENTSIZE_ERROR || size == ZSTD_CONTENTSIZE_UNKNOWN || size > maxBytes) {
+        return false;
+    }
+    std::string result(static_cast<size_t>(size), '\0');
+    size_t written = ZSTD_decompress(result.data(), result.size(), data.data(), data.size());
+    if (ZSTD_isError(written) || written != result.size()) return false;
+    out = std::move(result);
+    return true;
+}
+
+RevisionStore::Encoded RevisionStore::encode(std::string_view content,
+                                             const std::string *previous,
+                                             int previousChain) const {
+    Encoded encoded;
+    if (previous && previousChain + 1 < options_.snapshotInterval) {
+        auto delta = RevisionDelta::diff(*previous, content);
+        // A rewrite is cheaper to store, and to read, as a snapshot
+        if (delta.size() * 2 <= content.size()) {
+            encoded.storage = Storage::Delta;
+            encoded.chain = previousChain + 1;
+            encoded.body = compress(delta);
+            return encoded;
+        }
+    }
+    encoded.storage = Storage::Snapshot;
+    encoded.chain = 0;
+    encoded.body = compress(content);
+    return encoded;
+}
+
+std::string RevisionStore::cacheKey(int revisionId) {
+    return "rev:" + std::to_string(revisionId);
+}
+
+void RevisionStore::remember(int revisionId, const std::string &content) {
+    cache_.put(cacheKey(revisionId), content, kCacheTtl);
+}
+
+LocalCache::Value RevisionStore::cached(int revisionId) {
+    return cache_.get(cacheKey(revisionId));
+}
+
+std::optional<std::string> RevisionStore::rebuild(const std::vector<Row> &chain) {
+    auto fail = [this]() -> std::optional<std::string> {
+        failures_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    };
+
+    // Walk back to the nearest revision that needs no base
+    std::string text;
+    size_t start = chain.size();
+    for (size_t i = 0; i < chain.size(); ++i) {
+        const auto &row = chain[i];
+        if (i > 0 && chain[i - 1].baseId != row.id) return fail();
+        if (row.content) {
+            text = *row.content;
+        } else if (auto hit = cached(row.id)) {
+            text = *hit;
+        } else if (row.storage == Storage::Snapshot) {
+            if (!decompress(row.body, text)) return fail();
+            if (i > 0) remember(row.id, text);
+        } else if (row.storage == Storage::Delta) {
+            continue;
+        } else {
+            return fail();
+        }
+        start = i;
+        break;
+    }
+    if (start == chain.size()) return fail();
+
+    std::string delta;
+    for (size_t i = start; i-- > 0;) {
+        if (chain[i].storage != Storage::Delta || !decompress(chain[i].body, delta) ||
+            !RevisionDelta::apply(text, delta, text)) {
+            return fail();
+        }
+        deltasApplied_.fetch_add(1, std::memory_order_relaxed);
+    }
+    rebuilds_.fetch_add(1, std::memory_order_relaxed);
+    if (start > 0) remember(chain[0].id, text);
+    return text;
+}
+
+std::vector<std::optional<std::string>> RevisionStore::rebuildAll(const std::vector<Row> &rows) {
+    std::vector<std::optional<std::string>> out(rows.size());
+    std::unordered_map<int, size_t> index;
+    std::string delta;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const auto &row = rows[i];
+        index[row.id] = i;
+        if (row.content) {
+            out[i] = row.content;
+            continue;
+        }
+        std::string text;
+        if (row.storage == Storage::Snapshot) {
+            if (decompress(row.body, text)) out[i] = std::move(text);
+        } else if (row.storage == Storage::Delta) {
+            auto base = index.find(row.baseId);
+            if (base != index.end() && out[base->second] && decompress(row.body, delta) &&
+                RevisionDelta::apply(*out[base->second], delta, text)) {
+                out[i] = std::move(text);
+                deltasApplied_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (!out[i]) failures_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return out;
+}
+
+RevisionStore::Stats RevisionStore::stats() const {
+    Stats s;
+    s.rebuilds = rebuilds_.load(std::memory_order_relaxed);
+    s.deltasApplied = deltasApplied_.load(std::memory_order_relaxed);
+    s.failures = failures_.load(std::memory_order_relaxed);
+    return s;
+}
+
+} // namespace pyracms
@@ -0,0 +1,131 @@
+#include "services/SearchPagination.h"
+#include "services/BinaryCodec.h"
+#include "services/PageCursor.h"
+
+#include <queue>
+
+namespace pyracms {
+
+namespace {
+
+constexpr uint8_t kCursorVersion = 1;
+
+constexpr const char *kSourceTypes[SearchCursor::kSourceCount] = {
+    "article", "forum_post", "snippet", "gamedep"};
+
+} // namespace
+
+int SearchCursor::sourceIndex(std::string_view type) {
+    for (int i = 0; i < kSourceCount; ++i) {
+        if (type == kSourceTypes[i]) return i;
+    }
+    return -1;
+}
+
+const char *SearchCursor::sourceType(int index) {
+    return kSourceTypes[index];
+}
+
+uint32_t SearchCursor::hashQuery(std::string_view query, std::string_view type) {
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](std::string_view s) {
+        for (unsigned char c : s) {
+            hash ^= c;
+            hash *= 16777619u;
+        }
+    };
+    mix(query);
+    mix(std::string_view("\0", 1));
+    mix(type == "all" ? std::string_view() : type);
+    return hash;
+}
+
+std::string SearchCursor::encode() const {
+    std::string raw;
+    BinaryWriter w(raw);
+    w.u8(kCursorVersion);
+    w.varint(queryHash);
+    w.varint(static_cast<uint64_t>(offset));
+    for (const auto &source : sources) {
+        w.u8(static_cast<uint8_t>((source.started ? 1 : 0) | (source.exhausted ? 2 : 0)));
+        if (source.started && !source.exhausted) {
+            w.f64(source.rank);
+            w.i64(source.id);
+        }
+    }
+    BinaryCodec<std::map<std::string, int>>::encode(w, facets);
+    return base64UrlEncode(raw);
+}
+
+bool SearchCursor::decode(std::string_view text, SearchCursor &out) {
+    std::string raw;
+    if (text.empty() || !base64UrlDecode(text, raw)) return false;
+    BinaryReader r(raw);
+    if (r.u8() != kCursorVersion) return false;
+    SearchCursor cursor;
+    cursor.queryHash = static_cast<uint32_t>(r.varint());
+    auto offset = r.varint();
+    if (offset > static_cast<uint64_t>(INT32_MAX)) return false;
+    cursor.offset = static_cast<int>(offset);
+    for (auto &source : cursor.sources) {
+        auto flags = r.u8();
+        if (flags > 3) return false;
+        source.started = flags & 1;
+        source.exhausted = flags & 2;
+        if (source.started && !source.exhausted) {
+            source.rank = r.f64();
+            source.id = static_cast<int>(r.i64());
+        }
+    }
+    BinaryCodec<std::map<std::string, int>>::decode(r, cursor.facets);
+    if (!r.ok() || !r.atEnd()) return false;
+    out = std::move(cursor);
+    return true;
+}
+
+bool rankedBefore(const SearchResultItem &a, int sourceA, const SearchResultItem &b, int sourceB) {
+    if (a.rank != b.rank) return a.rank > b.rank;
+    if (sourceA != sourceB) return sourceA < sourceB;
+    return a.id > b.id;
+}
+
+std::vector<SearchResultItem> mergeSourcePages(const std::vector<SourcePage> &pages, int skip,
+                                               int limit, SearchCursor &cursor) {
+    // Heap of (page, position), best row on top
+    using Head = std::pair<size_t, size_t>;
+    auto worse = [&pages](const Head &a, const Head &b) {
+        const auto &pa = pages[a.first];
+        const auto &pb = pages[b.first];
+        return rankedBefore(pb.items[b.second], pb.source, pa.items[a.second], pa.source);
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(worse)> heap(worse);
+    for (size_t i = 0; i < pages.size(); ++i) {
+        if (!pages[i].items.empty()) heap.emplace(i, 0);
+    }
+
+    std::vector<SearchResultItem> out;
+    out.reserve(limit > 0 ? static_cast<size_t>(limit) : 0);
+    std::vector<size_t> consumed(pages.size(), 0);
+    int taken = 0;
+    while (!heap.empty() && taken < skip + limit) {
+        auto [page, pos] = heap.top();
+        heap.pop();
+        const auto &item = pages[page].items[pos];
+        auto &source = cursor.sources[pages[page].source];
+        source.started = true;
+        source.rank = item.rank;
+        source.id = item.id;
+        consumed[page] = pos + 1;
+        if (taken++ >= skip) out.push_back(item);
+        if (pos + 1 < pages[page].items.size()) heap.emplace(page, pos + 1);
+    }
+
+    for (size_t i = 0; i < pages.size(); ++i) {
+        if (pages[i].exhausted && consumed[i] == pages[i].items.size()) {
+            cursor.sources[pages[i].source].exhausted = true;
+        }
+    }
+    return out;
+}
+
+} // namespace pyracms
@@ -0,0 +1,95 @@
+#include "services/SearchQueryAggregator.h"
+
+#include <algorithm>
+
+namespace pyracms {
+
+SearchQueryAggregator::SearchQueryAggregator(size_t maxKeys)
+    : maxKeys_(std::max<size_t>(maxKeys, 1)) {}
+
+std::string SearchQueryAggregator::normalize(const std::string &query) {
+    std::string out;
+    out.reserve(std::min(query.size(), kMaxQueryBytes));
+    bool space = false;
+    for (unsigned char c : query) {
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v') {
+            space = !out.empty();
+            continue;
+        }
+        if (space) {
+            out += ' ';
+            space = false;
+        }
+        out += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : static_cast<char>(c);
+    }
+    if (out.size() > kMaxQueryBytes) {
+        size_t cut = kMaxQueryBytes;
+        // Back up over continuation bytes to the start of the sequence
+        while (cut > 0 && (static_cast<unsigned char>(out[cut]) & 0xC0) == 0x80) --cut;
+        out.resize(cut);
+        while (!out.empty() && out.back() == ' ') out.pop_back();
+    }
+    return out;
+}
+
+bool SearchQueryAggregator::add(Key key, uint64_t searches, uint64_t resultSum) {
+    auto &shard = shards_[KeyHash()(key) % kShards];
+    std::lock_guard<std::mutex> lock(shard.mu);
+    auto it = shard.counts.find(key);
+    if (it == shard.counts.end()) {
+        // Approximate across shards; a few keys over the cap are harmless
+        if (keys_.load(std::memory_order_relaxed) >= maxKeys_) {
+            dropped_.fetch_add(searches, std::memory_order_relaxed);
+            return false;
+        }
+        it = shard.counts.emplace(std::move(key), Counts{}).first;
+        keys_.fetch_add(1, std::memory_order_relaxed);
+    }
+    it->second.searches += searches;
+    it->second.resultSum += resultSum;
+    return true;
+}
+
+bool SearchQueryAggregator::record(int tenantId, const std::string &query, int resultCount) {
+    auto normalized = normalize(query);
+    if (normalized.empty()) return false;
+    return add({tenantId, std::move(normalized)}, 1,
+               static_cast<uint64_t>(std::max(resultCount, 0)));
+}
+
+std::vector<SearchQueryAggregator::Entry> SearchQueryAggregator::drain() {
+    std::vector<Entry> out;
+    for (auto &shard : shards_) {
+        std::unordered_map<Key, Counts, KeyHash> counts;
+        {
+            std::lock_guard<std::mutex> lock(shard.mu);
+            counts.swap(shard.counts);
+        }
+        keys_.fetch_sub(counts.size(), std::memory_order_relaxed);
+        for (auto &[key, c] : counts) {
+            out.push_back({key.tenantId, key.query, c.searches, c.resultSum});
+        }
+    }
+    return out;
+}
+
+void SearchQueryAggregator::restore(std::vector<Entry> entries) {
+    for (auto &entry : entries) {
+        add({entry.tenantId, std::move(entry.query)}, entry.searches, entry.resultSum);
+    }
+}
+
+bool SearchQueryAggregator::retryable(std::string_view sqlState) {
+    if (sqlState.empty()) return true;
+    auto cls = sqlState.substr(0, 2);
+    return cls == "08" || cls == "53" || cls == "57" || sqlState == "40001" ||
+           sqlState == "40P01";
+}
+
+bool SearchQueryAggregator::flushFailed(std::vector<Entry> entries, std::string_view sqlState) {
+    if (!retryable(sqlState)) return false;
+    restore(std::move(entries));
+    return true;
+}
+
+} // namespace pyracms
@@ -1,96 +1,214 @@
 #include "services/SearchService.h"
+#include "services/AutocompleteService.h"
 #include "services/ElasticsearchService.h"
+#include "services/EmbeddedSearchService.h"
+#include "services/SpellingService.h"
 #include "services/CacheService.h"
+#include "services/CacheCodecs.h"
 
+#include <algorithm>
+#include <array>
 #include <memory>
 #include <mutex>
+#include <sstream>
 
 namespace pyracms {
 
+namespace {
+
+// FROM/WHERE for each type, shared by its page query and its count
+// estimate. $1 is the tenant and $2 the tsquery, except for gamedeps:
+// gamedep_pages has no tenant_id, the catalog is shared by all tenants,
+// so there $1 is the tsquery. Articles are limited to published public
+// ones, as in listings: the vector includes the body, so anything else
+// could be probed by keyword.
+const std::string kArticleMatch =
+    "FROM articles a, to_tsquery('english', $2) query "
+    "WHERE a.tenant_id = $1 AND a.status = 'published' AND a.is_private = false "
+    "AND a.search_vector @@ query ";
+
+const std::string kForumPostMatch =
+    "FROM forum_posts p "
+    "JOIN forum_threads t ON t.id = p.thread_id "
+    "JOIN forums f ON f.id = t.forum_id "
+    "JOIN forum_categories c ON c.id = f.category_id "
+    "CROSS JOIN to_tsquery('english', $2) query "
+    "WHERE c.tenant_id = $1 AND p.search_vector @@ query ";
+
+const std::string kSnippetMatch =
+    "FROM code_snippets s, to_tsquery('english', $2) query "
+    "WHERE s.tenant_id = $1 AND s.visibility = 'public' AND s.search_vector @@ query ";
+
+const std::string kGameDepMatch =
+    "FROM gamedep_pages g, to_tsquery('english', $1) query "
+    "WHERE g.search_vector @@ query ";
+
+// Keyset continuation: rows strictly after the last (rank, id) returned.
+// ts_rank is a real, so the bound is compared as one too.
+std::string keysetPage(const char *vector, const char *id, int firstParam) {
+    auto p = [firstParam](int i) { return "$" + std::to_string(firstParam + i); };
+    return std::string("AND (") + p(1) + " OR (ts_rank(" + vector + ", query), " + id + ") < (" +
+           p(2) + "::real, " + p(3) + ")) ORDER BY rank DESC, " + id + " DESC LIMIT " + p(0);
+}
+
+// Engines that rank globally themselves page by offset alone. Their
+// totalCount may be an estimate, so any full page gets a cursor.
+void setOffsetCursor(SearchResults &results, SearchCursor cursor, int limit) {
+    int returned = static_cast<int>(results.items.size());
+    if (returned == 0 || returned < limit) return;
+    cursor.offset += returned;
+    results.nextCursor = cursor.encode();
+}
+
+} // namespace
+
 bool SearchService::useElasticsearch() {
     const char *engine = std::getenv("SEARCH_ENGINE");
     return engine && std::string(engine) == "elasticsearch" &&
            ElasticsearchService::instance().isConfigured();
 }
 
+void SearchService::indexArticle(int tenantId, int articleId,
+                                 const std::string &name, const std::string &displayName,
+                                 const std::string &content, const std::string &createdAt) {
+    if (ElasticsearchService::instance().isConfigured()) {
+        ElasticsearchService::instance().indexArticle(
+            tenantId, articleId, name, displayName, content, createdAt);
+    }
+    if (EmbeddedSearchService::enabled()) {
+        EmbeddedSearchService::instance().indexArticle(
+            tenantId, articleId, name, displayName, content, createdAt);
+    }
+    if (!useElasticsearch()) {
+        SpellingService::instance().indexText(tenantId, displayName + " " + content);
+    }
+}
+
+void SearchService::removeArticle(int articleId) {
+    if (ElasticsearchService::instance().isConfigured()) {
+        ElasticsearchService::instance().deleteDocument("pyracms_articles", articleId);
+    }
+    if (EmbeddedSearchService::enabled()) {
+        EmbeddedSearchService::instance().deleteDocument("article", articleId);
+    }
+}
+
 void SearchService::search(
     const DbClientPtr &db, int tenantId,
     const std::string &query, const std::string &type,
     int limit, int offset,
     std::function<void(const SearchResults &)> cb) {
 
+    SearchCursor start;
+    start.queryHash = SearchCursor::hashQuery(query, type);
+    start.offset = offset;
+
+    // Elasticsearch matches fuzzily itself; the other engines only match
+    // the words as typed, so a first page with nothing on it is retried
+    // once with the spelling index's corrections
+    if (offset != 0 || useElasticsearch() || !SpellingService::instance().ready()) {
+        runSearch(db, tenantId, query, type, limit, std::move(start), false, std::move(cb));
+        return;
+    }
+    runSearch(db, tenantId, query, type, limit, std::move(start), false,
+        [this, db, tenantId, query, type, limit, cb](const SearchResults &results) {
+            if (!results.items.empty()) {
+                cb(results);
+                return;
+            }
+            auto corrected = SpellingService::instance().correct(tenantId, query);
+            if (corrected.empty()) {
+                cb(results);
+                return;
+            }
+            // The cursor belongs to the corrected query, which later pages
+            // are requested with
+            SearchCursor retry;
+            retry.queryHash = SearchCursor::hashQuery(corrected, type);
+            runSearch(db, tenantId, corrected, type, limit, std::move(retry), false,
+                [results, corrected, cb](const SearchResults &fixed) {
+                    if (fixed.items.empty()) {
+                        cb(results);
+                        return;
+                    }
+                    auto out = fixed;
+                    out.suggestion = corrected;
+                    cb(out);
+                });
+        });
+}
+
+void SearchService::resume(
+    const DbClientPtr &db, int tenantId,
+    const std::string &query, const std::string &type,
+    int limit, const SearchCursor &cursor,
+    std::function<void(const SearchResults &)> cb) {
+
+    runSearch(db, tenantId, query, type, limit, cursor, true, std::move(cb));
+}
+
+void SearchService::runSearch(
+    const DbClientPtr &db, int tenantId,
+    const std::string &query, const std::string &type,
+    int limit, SearchCursor cursor, bool resumed,
+    std::function<void(const SearchResults &)> cb) {
+
+    int offset = cursor.offset;
+
+    // The embedded index answers in-process; caching it in Redis would
+    // only add a round trip
+    if (EmbeddedSearchService::enabled()) {
+        auto results = EmbeddedSearchService::instance().search(tenantId, query, type, limit, offset);
+        setOffsetCursor(results, std::move(cursor), limit);
+        cb(results);
+        return;
+    }
+
     // Delegate to Elasticsearch if configured
     if (useElasticsearch()) {
-        // Check Redis cache first
-        auto cacheKey = CacheService::searchKey(tenantId, query, type);
+        auto finish = [cursor, limit, cb](SearchResults results) {
+            setOffsetCursor(results, cursor, limit);
+            cb(results);
+        };
+        // Check Redis cache first; concurrent misses share one ES query.
+        // No key until the tenant's generation is known: skip the cache.
+        auto cacheKey = CacheService::searchKey(tenantId, query, type, limit, offset);
         auto &cache = CacheService::instance();
-        if (cache.isConnected()) {
-            cache.get(cacheKey, [this, db, tenantId, query, type, limit, offset, cb, cacheKey](
-                const std::string &cached, bool found) {
-                if (found) {
-                    // Parse cached JSON
-                    Json::Value root;
-                    Json::CharReaderBuilder reader;
-                    std::istringstream stream(cached);
-                    std::string errors;
-                    if (Json::parseFromStream(reader, stream, &root, &errors)) {
-                        SearchResults results;
-                        results.query = root["query"].asString();
-                        results.totalCount = root["totalCount"].asInt();
-                        for (const auto &item : root["items"]) {
-                            SearchResultItem sri;
-                            sri.type = item["type"].asString();
-                            sri.id = item["id"].asInt();
-                            sri.title = item["title"].asString();
-                            sri.snippet = item["snippet"].asString();
-                            sri.url = item["url"].asString();
-                            sri.rank = item["rank"].asDouble();
-                            sri.createdAt = item["createdAt"].asString();
-                            results.items.push_back(sri);
-                        }
-                        for (const auto &key : root["facets"].getMemberNames()) {
-                            results.facets[key] = root["facets"][key].asInt();
-                        }
-                        cb(results);
+        if (cache.isConnected() && !cacheKey.empty()) {
+            cache.getOrSet(cacheKey, 60,
+                [tenantId, query, type, limit, offset](CacheService::StringCallback done) {
+                    ElasticsearchService::instance().search(tenantId, query, type, limit, offset,
+                        [done](const SearchResults &results) {
+                            done(encodeBinary(results), true);
+                        });
+                },
+                [tenantId, query, type, limit, offset, finish](const std::string &cached, bool found) {
+                    SearchResults results;
+                    if (found && decodeBinary(cached, results)) {
+                        finish(std::move(results));
                         return;
                     }
-                }
-                // Cache miss — search ES
-                ElasticsearchService::instance().search(tenantId, query, type, limit, offset,
-                    [cb, cacheKey](const SearchResults &results) {
-                        // Cache the result for 60 seconds
-                        Json::Value cacheVal;
-                        cacheVal["query"] = results.query;
-                        cacheVal["totalCount"] = results.totalCount;
-                        cacheVal["items"] = Json::Value(Json::arrayValue);
-                        for (const auto &item : results.items) {
-                            Json::Value ji;
-                            ji["type"] = item.type;
-                            ji["id"] = item.id;
-                            ji["title"] = item.title;
-                            ji["snippet"] = item.snippet;
-                            ji["url"] = item.url;
-                            ji["rank"] = item.rank;
-                            ji["createdAt"] = item.createdAt;
-                            cacheVal["items"].append(ji);
-                        }
-                        cacheVal["facets"] = Json::Value(Json::objectValue);
-                        for (const auto &[k, v] : results.facets) {
-                            cacheVal["facets"][k] = v;
-                        }
-                        Json::StreamWriterBuilder writer;
-                        CacheService::instance().set(cacheKey, Json::writeString(writer, cacheVal), 60, [](bool) {});
-                        cb(results);
-                    });
-            });
+                    // Written by an older schema version — bypass the cache
+                    ElasticsearchService::instance().search(tenantId, query, type, limit, offset,
+                                                            finish);
+                });
             return;
         }
         // No Redis — search ES directly
-        ElasticsearchService::instance().search(tenantId, query, type, limit, offset, cb);
+        ElasticsearchService::instance().search(tenantId, query, type, limit, offset, finish);
         return;
     }
 
     // Fallback: PostgreSQL full-text search
+    searchFederated(db, tenantId, query, type, limit, std::move(cursor), resumed, std::move(cb));
+}
+
+void SearchService::searchFederated(
+    const DbClientPtr &db, int tenantId,
+    const std::string &query, const std::string &type,
+    int limit, SearchCursor cursor, bool resumed,
+    std::function<void(const SearchResults &)> cb) {
+
     // Convert user query to tsquery format
     // Replace spaces with & for AND matching
     std::string tsQuery;
@@ -103,10 +221,31 @@ void SearchService::search(
         first = false;
     }
 
-    if (tsQuery.empty()) {
-        SearchResults empty;
-        empty.query = query;
-        empty.totalCount = 0;
+    SearchResults empty;
+    empty.query = query;
+    empty.totalCount = 0;
+    if (tsQuery.empty() || limit <= 0) {
+        cb(empty);
+        return;
+    }
+
+    // The first page takes each type's top offset+limit and merges them,
+    // which is exactly the global top offset+limit. Later pages resume
+    // every type from its cursor position and need only limit more rows
+    // from each.
+    int skip = resumed ? 0 : cursor.offset;
+    int fetch = resumed ? limit : cursor.offset + limit;
+    bool searchAll = type.empty() || type == "all";
+    std::vector<int> sources;
+    for (int s = 0; s < SearchCursor::kSourceCount; ++s) {
+        if (!resumed && !searchAll && type != SearchCursor::sourceType(s)) {
+            cursor.sources[s].exhausted = true;
+        }
+        if (!cursor.sources[s].exhausted) sources.push_back(s);
+    }
+    if (sources.empty()) {
+        empty.facets = cursor.facets;
+        for (const auto &[facet, count] : cursor.facets) empty.totalCount += count;
         cb(empty);
         return;
     }
@@ -114,82 +253,124 @@ void SearchService::search(
     // Use shared state to collect results from parallel queries
     struct CollectorState {
         std::mutex mu;
-        SearchResults results;
-        int pendingQueries;
+        std::vector<SourcePage> pages;
+        std::array<int, SearchCursor::kSourceCount> estimates;
+        int pendingQueries = 0;
+        SearchCursor cursor;
+        std::string query;
+        int skip = 0;
+        int limit = 0;
+        bool resumed = false;
         std::function<void(const SearchResults &)> cb;
     };
 
     auto state = std::make_shared<CollectorState>();
-    state->results.query = query;
-    state->results.totalCount = 0;
-    state->cb = cb;
+    state->estimates.fill(-1);
+    state->cursor = std::move(cursor);
+    state->query = query;
+    state->skip = skip;
+    state->limit = limit;
+    state->resumed = resumed;
+    state->cb = std::move(cb);
+    state->pendingQueries = static_cast<int>(sources.size()) * (resumed ? 1 : 2);
 
-    // Determine which types to search
-    bool searchAll = type.empty() || type == "all";
-    bool doArticles = searchAll || type == "article";
-    bool doForumPosts = searchAll || type == "forum_post";
-    bool doSnippets = searchAll || type == "snippet";
-    bool doGameDeps = searchAll || type == "gamedep";
-
-    state->pendingQueries = 0;
-    if (doArticles) state->pendingQueries++;
-    if (doForumPosts) state->pendingQueries++;
-    if (doSnippets) state->pendingQueries++;
-    if (doGameDeps) state->pendingQueries++;
-
-    if (state->pendingQueries == 0) {
-        cb(state->results);
-        return;
-    }
+    // Runs on whichever DB thread finishes last
+    auto finish = [](CollectorState &st) {
+        SearchResults results;
+        results.query = st.query;
+        results.totalCount = 0;
+        results.items = mergeSourcePages(st.pages, st.skip, st.limit, st.cursor);
 
-    auto collectResults = [state](const std::vector<SearchResultItem> &items, int count) {
-        std::lock_guard<std::mutex> lock(state->mu);
-        for (const auto &item : items) {
-            state->results.items.push_back(item);
-        }
-        state->results.totalCount += count;
-        // Build facet counts
-        if (!items.empty()) {
-            state->results.facets[items[0].type] += count;
+        // Facets: exact where a type returned everything it had, the
+        // planner's estimate otherwise. Later pages reuse the first page's.
+        if (st.resumed) {
+            results.facets = st.cursor.facets;
+        } else {
+            for (const auto &page : st.pages) {
+                int fetched = static_cast<int>(page.items.size());
+                int count = page.exhausted ? fetched : std::max(fetched, st.estimates[page.source]);
+                if (count > 0) results.facets[SearchCursor::sourceType(page.source)] = count;
+            }
+            st.cursor.facets = results.facets;
         }
-        state->pendingQueries--;
-        if (state->pendingQueries == 0) {
-            // Sort by rank descending
-            std::sort(state->results.items.begin(), state->results.items.end(),
-                [](const SearchResultItem &a, const SearchResultItem &b) {
-                    return a.rank > b.rank;
-                });
-            state->cb(state->results);
+        for (const auto &[facet, count] : results.facets) results.totalCount += count;
+
+        bool more = false;
+        for (const auto &source : st.cursor.sources) more = more || !source.exhausted;
+        if (more && !results.items.empty()) {
+            st.cursor.offset += static_cast<int>(results.items.size());
+            results.nextCursor = st.cursor.encode();
         }
+        st.cb(results);
     };
 
-    if (doArticles) {
-        searchArticles(db, tenantId, tsQuery, limit, offset, collectResults);
-    }
-    if (doForumPosts) {
-        searchForumPosts(db, tenantId, tsQuery, limit, offset, collectResults);
-    }
-    if (doSnippets) {
-        searchSnippets(db, tenantId, tsQuery, limit, offset, collectResults);
+    auto done = [state, finish]() {
+        if (--state->pendingQueries == 0) finish(*state);
+    };
+
+    for (int s : sources) {
+        auto collect = [state, done, s, fetch](const std::vector<SearchResultItem> &items, int count) {
+            std::lock_guard<std::mutex> lock(state->mu);
+            state->pages.push_back({s, items, count < fetch});
+            done();
+        };
+        const auto &after = state->cursor.sources[s];
+        switch (s) {
+        case 0: searchArticles(db, tenantId, tsQuery, after, fetch, collect); break;
+        case 1: searchForumPosts(db, tenantId, tsQuery, after, fetch, collect); break;
+        case 2: searchSnippets(db, tenantId, tsQuery, after, fetch, collect); break;
+        case 3: searchGameDeps(db, tsQuery, after, fetch, collect); break;
+        }
+        if (!resumed) {
+            estimateMatches(db, s, tenantId, tsQuery, [state, done, s](int estimate) {
+                std::lock_guard<std::mutex> lock(state->mu);
+                state->estimates[s] = estimate;
+                done();
+            });
+        }
     }
-    if (doGameDeps) {
-        searchGameDeps(db, tenantId, tsQuery, limit, offset, collectResults);
+}
+
+void SearchService::estimateMatches(
+    const DbClientPtr &db, int source, int tenantId,
+    const std::string &tsQuery, std::function<void(int)> cb) {
+
+    // Planning only; never touches the matching rows
+    auto onPlan = [cb](const drogon::orm::Result &result) {
+        Json::CharReaderBuilder readerBuilder;
+        Json::Value plan;
+        std::istringstream planStream(result.empty() ? "" : result[0]["QUERY PLAN"].as<std::string>());
+        std::string errors;
+        if (Json::parseFromStream(readerBuilder, planStream, &plan, &errors) &&
+            plan.isArray() && plan[0]["Plan"]["Plan Rows"].isNumeric()) {
+            cb(static_cast<int>(plan[0]["Plan"]["Plan Rows"].asDouble()));
+        } else {
+            cb(-1);
+        }
+    };
+    auto onError = [cb](const drogon::orm::DrogonDbException &) { cb(-1); };
+
+    static const std::string kExplain = "EXPLAIN (FORMAT JSON) SELECT 1 ";
+    switch (source) {
+    case 0: db->execSqlAsync(kExplain + kArticleMatch, onPlan, onError, tenantId, tsQuery); break;
+    case 1: db->execSqlAsync(kExplain + kForumPostMatch, onPlan, onError, tenantId, tsQuery); break;
+    case 2: db->execSqlAsync(kExplain + kSnippetMatch, onPlan, onError, tenantId, tsQuery); break;
+    default: db->execSqlAsync(kExplain + kGameDepMatch, onPlan, onError, tsQuery); break;
     }
 }
 
 void SearchService::searchArticles(
     const DbClientPtr &db, int tenantId,
-    const std::string &tsQuery, int limit, int offset,
-    std::function<void(const std::vector<SearchResultItem> &, int)> cb) {
+    const std::string &tsQuery, const SearchCursor::Source &after,
+    int limit, SourceCallback cb) {
 
-    db->execSqlAsync(
+    static const std::string sql =
         "SELECT a.id, a.name, a.display_name, "
-        "ts_rank(to_tsvector('english', a.name || ' ' || a.display_name), to_tsquery('english', $2)) AS rank, "
-        "a.created_at "
-        "FROM articles a "
-        "WHERE a.tenant_id = $1 "
-        "AND to_tsvector('english', a.name || ' ' || a.display_name) @@ to_tsquery('english', $2) "
-        "ORDER BY rank DESC LIMIT $3 OFFSET $4",
+        "ts_rank(a.search_vector, query) AS rank, "
+        "a.created_at " +
+        kArticleMatch + keysetPage("a.search_vector", "a.id", 3);
+    db->execSqlAsync(
+        sql,
         [cb](const drogon::orm::Result &result) {
             std::vector<SearchResultItem> items;
             for (const auto &row : result) {
@@ -208,26 +389,22 @@ void SearchService::searchArticles(
         [cb](const drogon::orm::DrogonDbException &) {
             cb({}, 0);
         },
-        tenantId, tsQuery, limit, offset);
+        tenantId, tsQuery, limit, !after.started, after.rank, after.id);
 }
 
 void SearchService::searchForumPosts(
     const DbClientPtr &db, int tenantId,
-    const std::string &tsQuery, int limit, int offset,
-    std::function<void(const std::vector<SearchResultItem> &, int)> cb) {
+    const std::string &tsQuery, const SearchCursor::Source &after,
+    int limit, SourceCallback cb) {
 
-    db->execSqlAsync(
+    static const std::string sql =
         "SELECT p.id, p.title, "
         "LEFT(p.content, 200) AS snippet, "
-        "ts_rank(to_tsvector('english', p.title || ' ' || p.content), to_tsquery('english', $2)) AS rank, "
-        "p.created_at, p.thread_id "
-        "FROM forum_posts p "
-        "JOIN forum_threads t ON t.id = p.thread_id "
-        "JOIN forums f ON f.id = t.forum_id "
-        "JOIN forum_categories c ON c.id = f.category_id "
-        "WHERE c.tenant_id = $1 "
-        "AND to_tsvector('english', p.title || ' ' || p.content) @@ to_tsquery('english', $2) "
-        "ORDER BY rank DESC LIMIT $3 OFFSET $4",
+        "ts_rank(p.search_vector, query) AS rank, "
+        "p.created_at, p.thread_id " +
+        kForumPostMatch + keysetPage("p.search_vector", "p.id", 3);
+    db->execSqlAsync(
+        sql,
         [cb](const drogon::orm::Result &result) {
             std::vector<SearchResultItem> items;
             for (const auto &row : result) {
@@ -246,23 +423,22 @@ void SearchService::searchForumPosts(
         [cb](const drogon::orm::DrogonDbException &) {
             cb({}, 0);
         },
-        tenantId, tsQuery, limit, offset);
+        tenantId, tsQuery, limit, !after.started, after.rank, after.id);
 }
 
 void SearchService::searchSnippets(
     const DbClientPtr &db, int tenantId,
-    const std::string &tsQuery, int limit, int offset,
-    std::function<void(const std::vector<SearchResultItem> &, int)> cb) {
+    const std::string &tsQuery, const SearchCursor::Source &after,
+    int limit, SourceCallback cb) {
 
-    db->execSqlAsync(
+    static const std::string sql =
         "SELECT s.id, s.title, s.language, "
         "LEFT(s.code, 200) AS snippet, "
-        "ts_rank(to_tsvector('english', s.title || ' ' || s.code), to_tsquery('english', $2)) AS rank, "
-        "s.created_at "
-        "FROM code_snippets s "
-        "WHERE s.tenant_id = $1 AND s.visibility = 'public' "
-        "AND to_tsvector('english', s.title || ' ' || s.code) @@ to_tsquery('english', $2) "
-        "ORDER BY rank DESC LIMIT $3 OFFSET $4",
+        "ts_rank(s.search_vector, query) AS rank, "
+        "s.created_at " +
+        kSnippetMatch + keysetPage("s.search_vector", "s.id", 3);
+    db->execSqlAsync(
+        sql,
         [cb](const drogon::orm::Result &result) {
             std::vector<SearchResultItem> items;
             for (const auto &row : result) {
@@ -281,24 +457,21 @@ void SearchService::searchSnippets(
         [cb](const drogon::orm::DrogonDbException &) {
             cb({}, 0);
         },
-        tenantId, tsQuery, limit, offset);
+        tenantId, tsQuery, limit, !after.started, after.rank, after.id);
 }
 
 void SearchService::searchGameDeps(
-    const DbClientPtr &db, int tenantId,
-    const std::string &tsQuery, int limit, int offset,
-    std::function<void(const std::vector<SearchResultItem> &, int)> cb) {
+    const DbClientPtr &db,
+    const std::string &tsQuery, const SearchCursor::Source &after,
+    int limit, SourceCallback cb) {
 
-    db->execSqlAsync(
+    static const std::string sql =
         "SELECT g.id, g.name, g.display_name, g.description, "
-        "ts_rank(to_tsvector('english', g.name || ' ' || g.display_name || ' ' || g.description), "
-        "to_tsquery('english', $2)) AS rank, "
-        "g.created_at "
-        "FROM gamedep_pages g "
-        "WHERE g.tenant_id = $1 "
-        "AND to_tsvector('english', g.name || ' ' || g.display_name || ' ' || g.description) "
-        "@@ to_tsquery('english', $2) "
-        "ORDER BY rank DESC LIMIT $3 OFFSET $4",
+        "ts_rank(g.search_vector, query) AS rank, "
+        "g.created_at " +
+        kGameDepMatch + keysetPage("g.search_vector", "g.id", 2);
+    db->execSqlAsync(
+        sql,
         [cb](const drogon::orm::Result &result) {
             std::vector<SearchResultItem> items;
             for (const auto &row : result) {
@@ -317,7 +490,7 @@ void SearchService::searchGameDeps(
         [cb](const drogon::orm::DrogonDbException &) {
             cb({}, 0);
         },
-        tenantId, tsQuery, limit, offset);
+        tsQuery, limit, !after.started, after.rank, after.id);
 }
 
 void SearchService::autocomplete(
@@ -327,52 +500,38 @@ void SearchService::autocomplete(
 
     // Delegate to Elasticsearch if configured
     if (useElasticsearch()) {
-        // Check Redis cache
+        // Check Redis cache, unless the tenant's generation is not known yet
         auto cacheKey = CacheService::autocompleteKey(tenantId, prefix);
         auto &cache = CacheService::instance();
-        if (cache.isConnected()) {
-            cache.get(cacheKey, [this, db, tenantId, prefix, limit, cb, cacheKey](
-                const std::string &cached, bool found) {
-                if (found) {
-                    Json::Value root;
-                    Json::CharReaderBuilder reader;
-                    std::istringstream stream(cached);
-                    std::string errors;
-                    if (Json::parseFromStream(reader, stream, &root, &errors)) {
-                        std::vector<AutocompleteItem> items;
-                        for (const auto &item : root) {
-                            AutocompleteItem ai;
-                            ai.text = item["text"].asString();
-                            ai.type = item["type"].asString();
-                            ai.url = item["url"].asString();
-                            items.push_back(ai);
-                        }
+        if (cache.isConnected() && !cacheKey.empty()) {
+            cache.getOrSet(cacheKey, 30,
+                [tenantId, prefix, limit](CacheService::StringCallback done) {
+                    ElasticsearchService::instance().autocomplete(tenantId, prefix, limit,
+                        [done](const std::vector<AutocompleteItem> &items) {
+                            done(encodeBinary(items), true);
+                        });
+                },
+                [tenantId, prefix, limit, cb](const std::string &cached, bool found) {
+                    std::vector<AutocompleteItem> items;
+                    if (found && decodeBinary(cached, items)) {
                         cb(items);
                         return;
                     }
-                }
-                ElasticsearchService::instance().autocomplete(tenantId, prefix, limit,
-                    [cb, cacheKey](const std::vector<AutocompleteItem> &items) {
-                        // Cache for 30 seconds
-                        Json::Value cacheVal(Json::arrayValue);
-                        for (const auto &item : items) {
-                            Json::Value ji;
-                            ji["text"] = item.text;
-                            ji["type"] = item.type;
-                            ji["url"] = item.url;
-                            cacheVal.append(ji);
-                        }
-                        Json::StreamWriterBuilder writer;
-                        CacheService::instance().set(cacheKey, Json::writeString(writer, cacheVal), 30, [](bool) {});
-                        cb(items);
-                    });
-            });
+                    ElasticsearchService::instance().autocomplete(tenantId, prefix, limit, cb);
+                });
             return;
         }
         ElasticsearchService::instance().autocomplete(tenantId, prefix, limit, cb);
         return;
     }
 
+    // In-memory index once it has been built
+    auto &index = AutocompleteService::instance();
+    if (index.ready()) {
+        cb(index.complete(tenantId, prefix, limit));
+        return;
+    }
+
     // Fallback: PostgreSQL prefix search
     auto likePattern = prefix + "%";
 
@@ -394,8 +553,8 @@ void SearchService::autocomplete(
         ") UNION ALL ("
         "  SELECT display_name AS text, 'gamedep' AS type, "
         "  '/gamedep/' || name AS url "
-        "  FROM gamedep_pages WHERE tenant_id = $1 "
-        "  AND LOWER(display_name) LIKE LOWER($2) LIMIT $3"
+        "  FROM gamedep_pages "
+        "  WHERE LOWER(display_name) LIKE LOWER($2) LIMIT $3"
         ") LIMIT $3",
         [cb](const drogon::orm::Result &result) {
             std::vector<AutocompleteItem> items;
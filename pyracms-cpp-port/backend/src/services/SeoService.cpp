@@ -1,7 +1,38 @@
 #include "services/SeoService.h"
+#include "services/RenderService.h"
 
 namespace pyracms {
 
+namespace {
+
+// Joins the newest revision of article a and its stored render; the raw
+// text is only fetched when there is no render to serve
+const std::string kLatestRenderColumns =
+    "lr.id AS revision_id, ar.html, ar.summary, "
+    "CASE WHEN ar.html IS NULL THEN lr.content END AS content ";
+const std::string kLatestRenderJoin =
+    "LEFT JOIN LATERAL ("
+    "  SELECT id, content FROM article_revisions WHERE article_id = a.id "
+    "  ORDER BY created_at DESC, id DESC LIMIT 1) lr ON true "
+    "LEFT JOIN article_renders ar ON ar.revision_id = lr.id "
+    "  AND ar.renderer = COALESCE(NULLIF(LOWER(a.renderer_name), ''), 'markdown') "
+    "  AND ar.version = " + std::to_string(ArticleRenderer::kVersion) + " ";
+
+// The render of a row selected with the columns above: the stored one, or
+// rendered now and stored for next time
+ArticleRenderer::Output renderOf(const drogon::orm::Row &row) {
+    if (!row["html"].isNull()) {
+        return {row["html"].as<std::string>(), row["summary"].as<std::string>()};
+    }
+    // No revision yet, or one being superseded by a concurrent edit
+    if (row["revision_id"].isNull() || row["content"].isNull()) return {};
+    return RenderService::instance().render(row["revision_id"].as<int>(),
+                                            row["renderer_name"].as<std::string>(),
+                                            row["content"].as<std::string>());
+}
+
+} // namespace
+
 std::string SeoService::xmlEscape(const std::string &s) {
     std::string result;
     result.reserve(s.size());
@@ -57,15 +88,15 @@ void SeoService::generateRssFeed(const DbClientPtr &db, int tenantId,
                                   const std::string &siteTitle,
                                   StringCallback cb) {
     db->execSqlAsync(
-        "SELECT a.name, a.display_name, a.created_at, "
-        "  (SELECT content FROM article_revisions WHERE article_id = a.id "
-        "   ORDER BY created_at DESC LIMIT 1) AS content "
-        "FROM articles a "
+        "SELECT a.name, a.display_name, a.created_at, a.renderer_name, " +
+        kLatestRenderColumns +
+        "FROM articles a " + kLatestRenderJoin +
         "WHERE a.tenant_id = $1 AND a.status = 'published' AND a.is_private = false "
         "ORDER BY a.created_at DESC LIMIT 20",
         [this, baseUrl, siteTitle, cb](const drogon::orm::Result &result) {
             std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
-                "<rss version=\"2.0\" xmlns:atom=\"http://www.w3.org/2005/Atom\">\n"
+                "<rss version=\"2.0\" xmlns:atom=\"http://www.w3.org/2005/Atom\" "
+                "xmlns:content=\"http://purl.org/rss/1.0/modules/content/\">\n"
                 "<channel>\n"
                 "  <title>" + xmlEscape(siteTitle) + "</title>\n"
                 "  <link>" + xmlEscape(baseUrl) + "</link>\n"
@@ -77,16 +108,15 @@ void SeoService::generateRssFeed(const DbClientPtr &db, int tenantId,
                 auto name = row["name"].as<std::string>();
                 auto title = row["display_name"].as<std::string>();
                 auto date = row["created_at"].as<std::string>();
-                auto content = row["content"].isNull() ? "" : row["content"].as<std::string>();
-                // Truncate content for description
-                if (content.size() > 500) content = content.substr(0, 500) + "...";
+                auto render = renderOf(row);
 
                 xml += "  <item>\n"
                        "    <title>" + xmlEscape(title) + "</title>\n"
                        "    <link>" + xmlEscape(baseUrl + "/articles/" + name) + "</link>\n"
                        "    <guid>" + xmlEscape(baseUrl + "/articles/" + name) + "</guid>\n"
                        "    <pubDate>" + xmlEscape(date) + "</pubDate>\n"
-                       "    <description>" + xmlEscape(content) + "</description>\n"
+                       "    <description>" + xmlEscape(render.summary) + "</description>\n"
+                       "    <content:encoded>" + xmlEscape(render.html) + "</content:encoded>\n"
                        "  </item>\n";
             }
 
@@ -104,10 +134,9 @@ void SeoService::generateAtomFeed(const DbClientPtr &db, int tenantId,
                                    const std::string &siteTitle,
                                    StringCallback cb) {
     db->execSqlAsync(
-        "SELECT a.name, a.display_name, a.created_at, "
-        "  (SELECT content FROM article_revisions WHERE article_id = a.id "
-        "   ORDER BY created_at DESC LIMIT 1) AS content "
-        "FROM articles a "
+        "SELECT a.name, a.display_name, a.created_at, a.renderer_name, " +
+        kLatestRenderColumns +
+        "FROM articles a " + kLatestRenderJoin +
         "WHERE a.tenant_id = $1 AND a.status = 'published' AND a.is_private = false "
         "ORDER BY a.created_at DESC LIMIT 20",
         [this, baseUrl, siteTitle, cb](const drogon::orm::Result &result) {
@@ -122,15 +151,15 @@ void SeoService::generateAtomFeed(const DbClientPtr &db, int tenantId,
                 auto name = row["name"].as<std::string>();
                 auto title = row["display_name"].as<std::string>();
                 auto date = row["created_at"].as<std::string>();
-                auto content = row["content"].isNull() ? "" : row["content"].as<std::string>();
-                if (content.size() > 500) content = content.substr(0, 500) + "...";
+                auto render = renderOf(row);
 
                 xml += "  <entry>\n"
                        "    <title>" + xmlEscape(title) + "</title>\n"
                        "    <link href=\"" + xmlEscape(baseUrl + "/articles/" + name) + "\"/>\n"
                        "    <id>" + xmlEscape(baseUrl + "/articles/" + name) + "</id>\n"
                        "    <updated>" + xmlEscape(date) + "</updated>\n"
-                       "    <summary>" + xmlEscape(content) + "</summary>\n"
+                       "    <summary>" + xmlEscape(render.summary) + "</summary>\n"
+                       "    <content type=\"html\">" + xmlEscape(render.html) + "</content>\n"
                        "  </entry>\n";
             }
 
@@ -148,10 +177,8 @@ void SeoService::getArticleJsonLd(const DbClientPtr &db, int tenantId,
                                    const std::string &baseUrl,
                                    std::function<void(const Json::Value &)> cb) {
     db->execSqlAsync(
-        "SELECT a.*, u.username AS author_name, "
-        "  (SELECT content FROM article_revisions WHERE article_id = a.id "
-        "   ORDER BY created_at DESC LIMIT 1) AS content "
-        "FROM articles a "
+        "SELECT a.*, u.username AS author_name, " + kLatestRenderColumns +
+        "FROM articles a " + kLatestRenderJoin +
         "LEFT JOIN users u ON u.id = a.user_id "
         "WHERE a.tenant_id = $1 AND a.name = $2",
         [baseUrl, articleName, cb](const drogon::orm::Result &result) {
@@ -174,9 +201,7 @@ void SeoService::getArticleJsonLd(const DbClientPtr &db, int tenantId,
             author["name"] = row["author_name"].isNull() ? "Unknown" : row["author_name"].as<std::string>();
             ld["author"] = author;
 
-            auto content = row["content"].isNull() ? "" : row["content"].as<std::string>();
-            if (content.size() > 200) content = content.substr(0, 200) + "...";
-            ld["description"] = content;
+            ld["description"] = renderOf(row).summary;
 
             cb(ld);
         },
@@ -191,10 +216,9 @@ void SeoService::getOpenGraphData(const DbClientPtr &db, int tenantId,
                                    const std::string &baseUrl,
                                    std::function<void(const Json::Value &)> cb) {
     db->execSqlAsync(
-        "SELECT a.display_name, a.created_at, u.username AS author_name, "
-        "  (SELECT LEFT(content, 200) FROM article_revisions WHERE article_id = a.id "
-        "   ORDER BY created_at DESC LIMIT 1) AS description "
-        "FROM articles a "
+        "SELECT a.display_name, a.created_at, a.renderer_name, u.username AS author_name, " +
+        kLatestRenderColumns +
+        "FROM articles a " + kLatestRenderJoin +
         "LEFT JOIN users u ON u.id = a.user_id "
         "WHERE a.tenant_id = $1 AND a.name = $2",
         [baseUrl, articleName, cb](const drogon::orm::Result &result) {
@@ -207,7 +231,7 @@ void SeoService::getOpenGraphData(const DbClientPtr &db, int tenantId,
             og["og:type"] = "article";
             og["og:title"] = row["display_name"].as<std::string>();
             og["og:url"] = baseUrl + "/articles/" + articleName;
-            og["og:description"] = row["description"].isNull() ? "" : row["description"].as<std::string>();
+            og["og:description"] = renderOf(row).summary;
             og["article:published_time"] = row["created_at"].as<std::string>();
             og["article:author"] = row["author_name"].isNull() ? "" : row["author_name"].as<std::string>();
             cb(og);
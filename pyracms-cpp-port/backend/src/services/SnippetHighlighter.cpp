@@ -0,0 +1,142 @@
+#include "services/SnippetHighlighter.h"
+
+#include <algorithm>
+
+namespace pyracms {
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+bool isContinuation(char c) {
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+} // namespace
+
+std::string SnippetHighlighter::escapeHtml(std::string_view text) {
+    std::string out;
+    out.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+        case '&': out += "&amp;"; break;
+        case '<': out += "&lt;"; break;
+        case '>': out += "&gt;"; break;
+        case '"': out += "&quot;"; break;
+        case '\'': out += "&#39;"; break;
+        default: out += c;
+        }
+    }
+    return out;
+}
+
+SnippetHighlighter::Result SnippetHighlighter::highlight(std::string_view body,
+                                                         const std::vector<TokenSpan> &spans,
+                                                         const std::vector<Positions> &terms,
+                                                         const Options &options) {
+    const size_t width = std::max<size_t>(options.snippetChars, 1);
+
+    // Merge the terms' positions in body order, keeping the first maxMatches
+    struct Match {
+        uint32_t token;
+        uint32_t word;
+    };
+    std::vector<Match> matches;
+    std::vector<size_t> next(terms.size(), 0);
+    uint32_t words = 0;
+    for (const auto &term : terms) words = std::max(words, term.word + 1);
+    while (matches.size() < options.maxMatches) {
+        size_t best = terms.size();
+        for (size_t i = 0; i < terms.size(); ++i) {
+            if (next[i] >= terms[i].size) continue;
+            if (best == terms.size() || terms[i].data[next[i]] < terms[best].data[next[best]]) {
+                best = i;
+            }
+        }
+        if (best == terms.size()) break;
+        uint32_t token = terms[best].data[next[best]++];
+        if (token < spans.size()) matches.push_back({token, terms[best].word});
+    }
+
+    // Slide over the matches for the window with the most distinct words,
+    // then the most matches; ties keep the earliest
+    size_t start = 0;
+    if (!matches.empty()) {
+        std::vector<uint32_t> inWindow(words, 0);
+        size_t distinct = 0;
+        size_t bestWords = 0;
+        size_t bestCount = 0;
+        size_t bestFirst = 0;
+        size_t bestLast = 0;
+        size_t first = 0;
+        for (size_t last = 0; last < matches.size(); ++last) {
+            if (inWindow[matches[last].word]++ == 0) ++distinct;
+            while (first < last &&
+                   spans[matches[last].token].end - spans[matches[first].token].start > width) {
+                if (--inWindow[matches[first].word] == 0) --distinct;
+                ++first;
+            }
+            size_t count = last - first + 1;
+            if (distinct > bestWords || (distinct == bestWords && count > bestCount)) {
+                bestWords = distinct;
+                bestCount = count;
+                bestFirst = first;
+                bestLast = last;
+            }
+        }
+
+        // Spend a third of the spare room on context before the window
+        size_t windowStart = spans[matches[bestFirst].token].start;
+        size_t windowEnd = spans[matches[bestLast].token].end;
+        size_t slack = width > windowEnd - windowStart ? width - (windowEnd - windowStart) : 0;
+        start = windowStart - std::min(windowStart, slack / 3);
+    }
+    size_t end = std::min(body.size(), start + width);
+    if (end - start < width) start = end > width ? end - width : 0;
+
+    // Never cut through a token or a UTF-8 sequence
+    auto containing = [&spans](size_t pos) -> const TokenSpan * {
+        auto it = std::upper_bound(spans.begin(), spans.end(), pos,
+                                   [](size_t p, const TokenSpan &s) { return p < s.end; });
+        return it != spans.end() && it->start < pos ? &*it : nullptr;
+    };
+    if (start > 0) {
+        if (const auto *token = containing(start)) start = token->end;
+    }
+    if (end < body.size()) {
+        if (const auto *token = containing(end)) end = token->start;
+    }
+    while (start < body.size() && isContinuation(body[start])) ++start;
+    while (end > start && end < body.size() && isContinuation(body[end])) --end;
+    while (start < end && isSpace(body[start])) ++start;
+    while (end > start && isSpace(body[end - 1])) --end;
+    end = std::max(start, end);
+
+    Result result;
+    if (start > 0) {
+        result.snippet = "...";
+        result.highlight = "...";
+    }
+    result.snippet.append(body.substr(start, end - start));
+    size_t pos = start;
+    for (const auto &match : matches) {
+        const auto &span = spans[match.token];
+        if (span.start < pos) continue;
+        if (span.end > end) break;
+        result.highlight += escapeHtml(body.substr(pos, span.start - pos));
+        result.highlight += "<mark>";
+        result.highlight += escapeHtml(body.substr(span.start, span.end - span.start));
+        result.highlight += "</mark>";
+        pos = span.end;
+    }
+    result.highlight += escapeHtml(body.substr(pos, end - pos));
+    if (end < body.size()) {
+        result.snippet += "...";
+        result.highlight += "...";
+    }
+    return result;
+}
+
+} // namespace pyracms
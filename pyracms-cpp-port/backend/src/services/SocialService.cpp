@@ -1,11 +1,35 @@
 #include "services/SocialService.h"
 
+#include <limits>
 #include <regex>
 #include <memory>
 #include <mutex>
 
 namespace pyracms {
 
+namespace {
+
+// Feed order among items created at the same instant, lowest last
+int activityRank(const std::string &type) {
+    if (type == "article") return 2;
+    if (type == "forum_post") return 1;
+    return 0;
+}
+
+// Each branch of the feed query continues with its own
+// "(created_at, id) < ($ts, bound)" so it can walk its own index. Rows
+// tied with the cursor's timestamp follow it when their type ranks lower,
+// or within its own type when their id is lower.
+int64_t activityBound(const PageRequest &page, int rank) {
+    if (!page.hasCursor) return page.afterId();
+    int cursorRank = static_cast<int>(page.after.id >> 32);
+    if (rank < cursorRank) return std::numeric_limits<int64_t>::max();
+    if (rank > cursorRank) return std::numeric_limits<int64_t>::min();
+    return page.after.id & 0xffffffff;
+}
+
+} // namespace
+
 void SocialService::followUser(const DbClientPtr &db, int followerId, int followedId,
                                 BoolCallback cb) {
     if (followerId == followedId) {
@@ -55,7 +79,7 @@ void SocialService::isFollowing(const DbClientPtr &db, int followerId, int follo
         followerId, followedId);
 }
 
-void SocialService::getFollowers(const DbClientPtr &db, int userId, int limit, int offset,
+void SocialService::getFollowers(const DbClientPtr &db, int userId, const PageRequest &page,
                                   std::function<void(const std::vector<UserFollowDto> &, int)> cb) {
     db->execSqlAsync(
         "SELECT u.id AS user_id, u.username, u.avatar_url, f.created_at, "
@@ -63,7 +87,8 @@ void SocialService::getFollowers(const DbClientPtr &db, int userId, int limit, i
         "FROM follows f "
         "JOIN users u ON u.id = f.follower_id "
         "WHERE f.followed_id = $1 "
-        "ORDER BY f.created_at DESC LIMIT $2 OFFSET $3",
+        "AND (f.created_at, f.follower_id) < ($2::timestamptz, $3::bigint) "
+        "ORDER BY f.created_at DESC, f.follower_id DESC LIMIT $4 OFFSET $5",
         [cb](const drogon::orm::Result &result) {
             std::vector<UserFollowDto> followers;
             int total = 0;
@@ -81,10 +106,10 @@ void SocialService::getFollowers(const DbClientPtr &db, int userId, int limit, i
         [cb](const drogon::orm::DrogonDbException &) {
             cb({}, 0);
         },
-        userId, limit, offset);
+        userId, page.afterKey(), page.afterId(), page.limit, page.skip());
 }
 
-void SocialService::getFollowing(const DbClientPtr &db, int userId, int limit, int offset,
+void SocialService::getFollowing(const DbClientPtr &db, int userId, const PageRequest &page,
                                   std::function<void(const std::vector<UserFollowDto> &, int)> cb) {
     db->execSqlAsync(
         "SELECT u.id AS user_id, u.username, u.avatar_url, f.created_at, "
@@ -92,7 +117,8 @@ void SocialService::getFollowing(const DbClientPtr &db, int userId, int limit, i
         "FROM follows f "
         "JOIN users u ON u.id = f.followed_id "
         "WHERE f.follower_id = $1 "
-        "ORDER BY f.created_at DESC LIMIT $2 OFFSET $3",
+        "AND (f.created_at, f.followed_id) < ($2::timestamptz, $3::bigint) "
+        "ORDER BY f.created_at DESC, f.followed_id DESC LIMIT $4 OFFSET $5",
         [cb](const drogon::orm::Result &result) {
             std::vector<UserFollowDto> following;
             int total = 0;
@@ -110,26 +136,34 @@ void SocialService::getFollowing(const DbClientPtr &db, int userId, int limit, i
         [cb](const drogon::orm::DrogonDbException &) {
             cb({}, 0);
         },
-        userId, limit, offset);
+        userId, page.afterKey(), page.afterId(), page.limit, page.skip());
 }
 
 void SocialService::getActivityFeed(const DbClientPtr &db, int userId,
-                                     int limit, int offset,
+                                     const PageRequest &page,
                                      std::function<void(const std::vector<ActivityItem> &)> cb) {
+    // No branch can contribute more than a page plus what is skipped, so
+    // each stops early on its (owner, created_at, id) index
     db->execSqlAsync(
         "("
-        "  SELECT 'article' AS type, a.id, a.display_name AS title, "
+        "  SELECT 'article' AS type, 2 AS rank, a.id, a.display_name AS title, "
         "  '' AS summary, a.created_at "
-        "  FROM articles a WHERE a.user_id = $1"
+        "  FROM articles a WHERE a.user_id = $1 "
+        "  AND (a.created_at, a.id) < ($2::timestamptz, $3::bigint) "
+        "  ORDER BY a.created_at DESC, a.id DESC LIMIT $6"
         ") UNION ALL ("
-        "  SELECT 'forum_post' AS type, p.id, COALESCE(p.title, '') AS title, "
+        "  SELECT 'forum_post' AS type, 1 AS rank, p.id, COALESCE(p.title, '') AS title, "
         "  LEFT(p.content, 200) AS summary, p.created_at "
-        "  FROM forum_posts p WHERE p.user_id = $1"
+        "  FROM forum_posts p WHERE p.user_id = $1 "
+        "  AND (p.created_at, p.id) < ($2::timestamptz, $4::bigint) "
+        "  ORDER BY p.created_at DESC, p.id DESC LIMIT $6"
         ") UNION ALL ("
-        "  SELECT 'snippet' AS type, s.id, s.title, "
+        "  SELECT 'snippet' AS type, 0 AS rank, s.id, s.title, "
         "  LEFT(s.code, 200) AS summary, s.created_at "
-        "  FROM code_snippets s WHERE s.author_id = $1"
-        ") ORDER BY created_at DESC LIMIT $2 OFFSET $3",
+        "  FROM code_snippets s WHERE s.author_id = $1 "
+        "  AND (s.created_at, s.id) < ($2::timestamptz, $5::bigint) "
+        "  ORDER BY s.created_at DESC, s.id DESC LIMIT $6"
+        ") ORDER BY created_at DESC, rank DESC, id DESC LIMIT $7 OFFSET $8",
         [cb](const drogon::orm::Result &result) {
             std::vector<ActivityItem> items;
             items.reserve(result.size());
@@ -147,7 +181,12 @@ void SocialService::getActivityFeed(const DbClientPtr &db, int userId,
         [cb](const drogon::orm::DrogonDbException &) {
             cb({});
         },
-        userId, limit, offset);
+        userId, page.afterKey(), activityBound(page, 2), activityBound(page, 1),
+        activityBound(page, 0), page.limit + page.skip(), page.limit, page.skip());
+}
+
+int64_t SocialService::activityCursorId(const ActivityItem &item) {
+    return (static_cast<int64_t>(activityRank(item.type)) << 32) | static_cast<uint32_t>(item.id);
 }
 
 void SocialService::getUserAchievements(const DbClientPtr &db, int userId,
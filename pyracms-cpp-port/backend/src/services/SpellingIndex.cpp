@@ -0,0 +1,298 @@
+#include "services/SpellingIndex.h"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_set>
+
+namespace pyracms {
+
+namespace {
+
+// Recent deletes are merged into the sorted array past this size, or half
+// the array, whichever is larger
+constexpr size_t kMinMergeSize = 4096;
+
+uint64_t hashKey(std::string_view key) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// word itself and every distinct string left by deleting 1..maxDistance
+// characters from it
+std::vector<std::string> deletesOf(std::string_view word, uint32_t maxDistance) {
+    std::vector<std::string> out{std::string(word)};
+    std::vector<std::string> level{std::string(word)};
+    for (uint32_t d = 0; d < maxDistance; ++d) {
+        std::vector<std::string> next;
+        for (const auto &s : level) {
+            if (s.size() <= 1) continue;
+            for (size_t i = 0; i < s.size(); ++i) {
+                next.push_back(s.substr(0, i) + s.substr(i + 1));
+            }
+        }
+        std::sort(next.begin(), next.end());
+        next.erase(std::unique(next.begin(), next.end()), next.end());
+        out.insert(out.end(), next.begin(), next.end());
+        level = std::move(next);
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+// Like Elasticsearch's AUTO fuzziness for the lengths isWord admits
+uint32_t allowedDistance(size_t length, uint32_t maxDistance) {
+    return std::min<uint32_t>(maxDistance, length <= 5 ? 1 : 2);
+}
+
+// The tenant's own dictionary, then the shared one
+std::vector<int> scopes(int tenantId) {
+    if (tenantId == SpellingIndex::kSharedTenant) return {tenantId};
+    return {tenantId, SpellingIndex::kSharedTenant};
+}
+
+std::string lowercase(std::string_view text) {
+    std::string out(text);
+    for (auto &c : out) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return out;
+}
+
+} // namespace
+
+struct SpellingIndex::Dictionary {
+    struct Word {
+        std::string text;
+        uint64_t count = 0;
+    };
+
+    struct Entry {
+        uint64_t hash;
+        uint32_t word;
+        bool operator<(const Entry &o) const {
+            return hash < o.hash || (hash == o.hash && word < o.word);
+        }
+    };
+
+    mutable std::shared_mutex mu;
+    std::vector<Word> words;
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<Entry> sorted;
+    std::unordered_multimap<uint64_t, uint32_t> recent;
+    size_t live = 0;
+
+    template <typename Fn>
+    void candidates(uint64_t hash, Fn &&fn) const {
+        auto it = std::lower_bound(sorted.begin(), sorted.end(), Entry{hash, 0});
+        for (; it != sorted.end() && it->hash == hash; ++it) fn(it->word);
+        auto range = recent.equal_range(hash);
+        for (auto r = range.first; r != range.second; ++r) fn(r->second);
+    }
+
+    void merge() {
+        sorted.reserve(sorted.size() + recent.size());
+        for (const auto &[hash, word] : recent) sorted.push_back(Entry{hash, word});
+        recent.clear();
+        std::sort(sorted.begin(), sorted.end());
+    }
+};
+
+SpellingIndex::SpellingIndex() : SpellingIndex(Options{}) {}
+SpellingIndex::SpellingIndex(Options options) : options_(options) {}
+SpellingIndex::~SpellingIndex() = default;
+
+bool SpellingIndex::isWord(std::string_view word) {
+    if (word.size() < kMinWordBytes || word.size() > kMaxWordBytes) return false;
+    return std::all_of(word.begin(), word.end(), [](char c) { return c >= 'a' && c <= 'z'; });
+}
+
+std::vector<std::string> SpellingIndex::words(std::string_view text) {
+    std::vector<std::string> out;
+    std::string current;
+    auto flush = [&] {
+        if (isWord(current)) out.push_back(current);
+        current.clear();
+    };
+    // Runs split like the search tokenizers; runs with digits or non-ASCII
+    // bytes are not words
+    for (unsigned char c : text) {
+        if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80) {
+            current += static_cast<char>(c);
+        } else if (c >= 'A' && c <= 'Z') {
+            current += static_cast<char>(c - 'A' + 'a');
+        } else {
+            flush();
+        }
+    }
+    flush();
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+uint32_t SpellingIndex::distance(std::string_view a, std::string_view b, uint32_t limit) {
+    const size_t n = a.size();
+    const size_t m = b.size();
+    if ((n > m ? n - m : m - n) > limit) return limit + 1;
+    std::vector<uint32_t> twoBack(m + 1), prev(m + 1), row(m + 1);
+    for (size_t j = 0; j <= m; ++j) prev[j] = static_cast<uint32_t>(j);
+    for (size_t i = 1; i <= n; ++i) {
+        row[0] = static_cast<uint32_t>(i);
+        uint32_t rowMin = row[0];
+        for (size_t j = 1; j <= m; ++j) {
+            uint32_t cost = a[i - 1] == b[j - 1] ? 0 : 1;
+            row[j] = std::min({prev[j] + 1, row[j - 1] + 1, prev[j - 1] + cost});
+            if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) {
+                row[j] = std::min(row[j], twoBack[j - 2] + 1);
+            }
+            rowMin = std::min(rowMin, row[j]);
+        }
+        if (rowMin > limit) return limit + 1;
+        std::swap(twoBack, prev);
+        std::swap(prev, row);
+    }
+    return std::min(prev[m], limit + 1);
+}
+
+std::shared_ptr<SpellingIndex::Dictionary> SpellingIndex::findDictionary(int tenantId) const {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    auto it = dictionaries_.find(tenantId);
+    return it == dictionaries_.end() ? nullptr : it->second;
+}
+
+std::shared_ptr<SpellingIndex::Dictionary> SpellingIndex::dictionary(int tenantId) {
+    if (auto dict = findDictionary(tenantId)) return dict;
+    std::unique_lock<std::shared_mutex> lock(mu_);
+    auto &slot = dictionaries_[tenantId];
+    if (!slot) slot = std::make_shared<Dictionary>();
+    return slot;
+}
+
+void SpellingIndex::add(int tenantId, std::string_view word, uint64_t count) {
+    if (count == 0 || !isWord(word)) return;
+    // Generated before taking the lock
+    auto deletes = deletesOf(word.substr(0, options_.prefixLength), options_.maxDistance);
+
+    auto dictPtr = dictionary(tenantId);
+    auto &dict = *dictPtr;
+    std::unique_lock<std::shared_mutex> lock(dict.mu);
+    auto it = dict.ids.find(std::string(word));
+    if (it != dict.ids.end()) {
+        auto &entry = dict.words[it->second];
+        if (entry.count == 0) ++dict.live;
+        entry.count += count;
+        return;
+    }
+    auto id = static_cast<uint32_t>(dict.words.size());
+    dict.words.push_back({std::string(word), count});
+    dict.ids.emplace(std::string(word), id);
+    ++dict.live;
+    for (const auto &del : deletes) dict.recent.emplace(hashKey(del), id);
+    if (dict.recent.size() > std::max(kMinMergeSize, dict.sorted.size() / 2)) dict.merge();
+}
+
+void SpellingIndex::remove(int tenantId, std::string_view word, uint64_t count) {
+    auto dict = findDictionary(tenantId);
+    if (!dict) return;
+    std::unique_lock<std::shared_mutex> lock(dict->mu);
+    auto it = dict->ids.find(std::string(word));
+    if (it == dict->ids.end()) return;
+    auto &entry = dict->words[it->second];
+    if (entry.count == 0) return;
+    entry.count = entry.count > count ? entry.count - count : 0;
+    if (entry.count == 0) --dict->live;
+}
+
+bool SpellingIndex::contains(int tenantId, std::string_view word) const {
+    for (int id : scopes(tenantId)) {
+        auto dict = findDictionary(id);
+        if (!dict) continue;
+        std::shared_lock<std::shared_mutex> lock(dict->mu);
+        auto it = dict->ids.find(std::string(word));
+        if (it != dict->ids.end() && dict->words[it->second].count > 0) return true;
+    }
+    return false;
+}
+
+void SpellingIndex::lookup(const Dictionary &dict, const Options &options, std::string_view word,
+                           uint32_t maxDistance, std::optional<Suggestion> &best) {
+    std::unordered_set<uint32_t> seen;
+    for (const auto &del : deletesOf(word.substr(0, options.prefixLength), maxDistance)) {
+        dict.candidates(hashKey(del), [&](uint32_t id) {
+            if (!seen.insert(id).second) return;
+            const auto &candidate = dict.words[id];
+            if (candidate.count == 0) return;
+            uint32_t d = distance(word, candidate.text, maxDistance);
+            if (d > maxDistance) return;
+            if (!best || d < best->distance ||
+                (d == best->distance && (candidate.count > best->count ||
+                                         (candidate.count == best->count &&
+                                          candidate.text < best->word)))) {
+                best = Suggestion{candidate.text, d, candidate.count};
+            }
+        });
+    }
+}
+
+std::optional<SpellingIndex::Suggestion> SpellingIndex::suggest(int tenantId,
+                                                                std::string_view word) const {
+    if (!isWord(word)) return std::nullopt;
+    uint32_t maxDistance = allowedDistance(word.size(), options_.maxDistance);
+    std::optional<Suggestion> best;
+    for (int id : scopes(tenantId)) {
+        auto dict = findDictionary(id);
+        if (!dict) continue;
+        std::shared_lock<std::shared_mutex> lock(dict->mu);
+        lookup(*dict, options_, word, maxDistance, best);
+    }
+    return best;
+}
+
+std::string SpellingIndex::correct(int tenantId, std::string_view query) const {
+    std::string out;
+    bool changed = false;
+    size_t i = 0;
+    while (i < query.size()) {
+        if (query[i] == ' ' || query[i] == '\t' || query[i] == '\n' || query[i] == '\r') {
+            ++i;
+            continue;
+        }
+        size_t end = i;
+        while (end < query.size() && query[end] != ' ' && query[end] != '\t' &&
+               query[end] != '\n' && query[end] != '\r') {
+            ++end;
+        }
+        auto token = query.substr(i, end - i);
+        i = end;
+
+        if (!out.empty()) out += ' ';
+        auto word = lowercase(token);
+        if (isWord(word) && !contains(tenantId, word)) {
+            auto suggestion = suggest(tenantId, word);
+            if (suggestion && suggestion->distance > 0) {
+                out += suggestion->word;
+                changed = true;
+                continue;
+            }
+        }
+        out.append(token);
+    }
+    return changed ? out : std::string();
+}
+
+size_t SpellingIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    size_t total = 0;
+    for (const auto &[tenantId, dict] : dictionaries_) {
+        std::shared_lock<std::shared_mutex> dictLock(dict->mu);
+        total += dict->live;
+    }
+    return total;
+}
+
+} // namespace pyracms
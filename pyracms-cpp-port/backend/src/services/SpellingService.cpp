@@ -0,0 +1,138 @@
+#include "services/SpellingService.h"
+
+#include <iterator>
+
+namespace pyracms {
+
+namespace {
+
+// Document frequency of each word, per tenant, over what the SQL search
+// matches. The 'simple' configuration lowercases without stemming, so
+// suggestions are words users actually wrote; tsvector_to_array lists each
+// lexeme of a document once. Words isWord would reject are filtered here
+// rather than shipped.
+std::string wordCounts(const std::string &tenant, const std::string &text,
+                       const std::string &from, const std::string &where = "") {
+    return "SELECT " + tenant + " AS tenant_id, word, COUNT(*) AS documents " + from +
+           " CROSS JOIN LATERAL unnest(tsvector_to_array(to_tsvector('simple', " + text +
+           "))) AS word WHERE word ~ '^[a-z]{3,32}$' " + where + " GROUP BY 1, 2";
+}
+
+struct Source {
+    const char *type;
+    std::string sql;
+};
+
+const Source kSources[] = {
+    {"article",
+     wordCounts(
+         "a.tenant_id",
+         "a.display_name || ' ' || coalesce((SELECT content FROM article_revisions "
+         "WHERE article_id = a.id ORDER BY created_at DESC, id DESC LIMIT 1), '')",
+         "FROM articles a")},
+    {"forum_post",
+     wordCounts(
+         "c.tenant_id", "coalesce(p.title, '') || ' ' || coalesce(p.content, '')",
+         "FROM forum_posts p "
+         "JOIN forum_threads t ON t.id = p.thread_id "
+         "JOIN forums f ON f.id = t.forum_id "
+         "JOIN forum_categories c ON c.id = f.category_id")},
+    {"snippet",
+     wordCounts(
+         "s.tenant_id", "coalesce(s.title, '') || ' ' || coalesce(s.code, '')",
+         "FROM code_snippets s", "AND s.visibility = 'public'")},
+    {"gamedep",
+     wordCounts(
+         std::to_string(SpellingIndex::kSharedTenant),
+         "g.display_name || ' ' || coalesce(g.description, '')",
+         "FROM gamedep_pages g")},
+};
+
+} // namespace
+
+SpellingService &SpellingService::instance() {
+    static SpellingService inst;
+    return inst;
+}
+
+void SpellingService::rebuild(const DbClientPtr &db) {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (rebuilding_) return;
+        rebuilding_ = true;
+        pending_.clear();
+    }
+
+    struct Load {
+        std::mutex mu;
+        std::shared_ptr<SpellingIndex> index = std::make_shared<SpellingIndex>();
+        size_t remaining = std::size(kSources);
+        bool failed = false;
+    };
+    auto load = std::make_shared<Load>();
+
+    auto finish = [this, load](bool ok) {
+        {
+            std::lock_guard<std::mutex> lock(load->mu);
+            if (!ok) load->failed = true;
+            if (--load->remaining > 0) return;
+        }
+        std::lock_guard<std::mutex> lock(mu_);
+        rebuilding_ = false;
+        if (load->failed) {
+            // Keep serving the previous index, if any
+            pending_.clear();
+            return;
+        }
+        for (const auto &op : pending_) applyTo(*load->index, op);
+        pending_.clear();
+        index_ = load->index;
+        ready_ = true;
+        LOG_INFO << "Spelling: indexed " << index_->size() << " words";
+    };
+
+    for (const auto &source : kSources) {
+        db->execSqlAsync(
+            source.sql,
+            [load, finish](const drogon::orm::Result &result) {
+                for (const auto &row : result) {
+                    load->index->add(row["tenant_id"].as<int>(), row["word"].as<std::string>(),
+                                     row["documents"].as<uint64_t>());
+                }
+                finish(true);
+            },
+            [&source, finish](const drogon::orm::DrogonDbException &e) {
+                LOG_ERROR << "Spelling rebuild " << source.type
+                          << " failed: " << e.base().what();
+                finish(false);
+            });
+    }
+}
+
+std::string SpellingService::correct(int tenantId, const std::string &query) const {
+    std::shared_ptr<SpellingIndex> index;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        index = index_;
+    }
+    return index ? index->correct(tenantId, query) : std::string();
+}
+
+size_t SpellingService::size() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return index_ ? index_->size() : 0;
+}
+
+void SpellingService::applyTo(SpellingIndex &index, const Op &op) {
+    for (const auto &word : op.words) index.add(op.tenantId, word);
+}
+
+void SpellingService::indexText(int tenantId, const std::string &text) {
+    Op op{tenantId, SpellingIndex::words(text)};
+    if (op.words.empty()) return;
+    std::lock_guard<std::mutex> lock(mu_);
+    if (index_) applyTo(*index_, op);
+    if (rebuilding_) pending_.push_back(std::move(op));
+}
+
+} // namespace pyracms
@@ -0,0 +1,257 @@
+#include "services/StallWatchdog.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <execinfo.h>
+
+namespace pyracms {
+
+namespace {
+
+constexpr int kMaxFrames = 64;
+// Frames belonging to the signal handler and the kernel trampoline
+constexpr int kHandlerFrames = 2;
+
+// State shared with the signal handler. Captures are serialized on the
+// watchdog thread; the sequence numbers stop a handler that fires after
+// its capture timed out from being mistaken for the next one.
+void *gFrames[kMaxFrames];
+std::atomic<int> gFrameCount{0};
+std::atomic<uint64_t> gRequestedSeq{0};
+std::atomic<uint64_t> gCompletedSeq{0};
+
+int stackSignal() {
+    return SIGRTMIN + 4;
+}
+
+void onStackSignal(int) {
+    int savedErrno = errno;
+    uint64_t seq = gRequestedSeq.load(std::memory_order_acquire);
+    gFrameCount.store(backtrace(gFrames, kMaxFrames), std::memory_order_relaxed);
+    gCompletedSeq.store(seq, std::memory_order_release);
+    errno = savedErrno;
+}
+
+// SA_RESTART restarts most interrupted syscalls; the few that return
+// EINTR regardless (epoll_wait, nanosleep) are already retried by trantor
+// and libstdc++.
+void installSignalHandler() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        // backtrace() loads libgcc on first use, which is not safe inside a
+        // signal handler, so warm it up here.
+        void *warm[1];
+        backtrace(warm, 1);
+
+        struct sigaction sa {};
+        sa.sa_handler = onStackSignal;
+        sigemptyset(&sa.sa_mask);
+        sa.sa_flags = SA_RESTART;
+        sigaction(stackSignal(), &sa, nullptr);
+    });
+}
+
+// "module(_ZN3foo3barEv+0x1f) [0x...]" -> "module(foo::bar()+0x1f) [0x...]"
+std::string demangleFrame(const char *symbol) {
+    std::string frame(symbol);
+    auto open = frame.find('(');
+    auto plus = frame.find('+', open);
+    if (open == std::string::npos || plus == std::string::npos || plus == open + 1) {
+        return frame;
+    }
+    auto mangled = frame.substr(open + 1, plus - open - 1);
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+    if (status == 0 && demangled) {
+        frame.replace(open + 1, plus - open - 1, demangled);
+    }
+    std::free(demangled);
+    return frame;
+}
+
+int64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               StallWatchdog::Clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+struct StallWatchdog::Loop {
+    std::string name;
+    Post post;
+
+    // Written once by the loop's first ping
+    pthread_t thread{};
+    std::atomic<bool> threadKnown{false};
+
+    std::atomic<bool> pending{false};
+    std::atomic<int64_t> sentAtMicros{0};
+    bool reported = false; // watchdog thread only
+
+    // Written by the loop thread only
+    std::atomic<uint64_t> maxLagMicros{0};
+    std::atomic<uint64_t> sumMicros{0};
+    std::array<std::atomic<uint64_t>, LatencyBuckets::kCount> buckets{};
+
+    // Written by the watchdog thread only
+    std::atomic<uint64_t> stalls{0};
+};
+
+StallWatchdog &StallWatchdog::instance() {
+    static StallWatchdog watchdog;
+    return watchdog;
+}
+
+StallWatchdog::StallWatchdog() = default;
+
+StallWatchdog::~StallWatchdog() {
+    stop();
+}
+
+void StallWatchdog::addLoop(std::string name, Post post) {
+    auto loop = std::make_shared<Loop>();
+    loop->name = std::move(name);
+    loop->post = std::move(post);
+    loops_.push_back(std::move(loop));
+}
+
+void StallWatchdog::start(std::chrono::milliseconds interval,
+                          std::chrono::milliseconds threshold, ReportCallback onStall) {
+    if (thread_.joinable() || loops_.empty()) return;
+    installSignalHandler();
+    interval_ = interval;
+    threshold_ = threshold;
+    onStall_ = std::move(onStall);
+    stopping_ = false;
+    thread_ = std::thread([this] { run(); });
+}
+
+void StallWatchdog::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+void StallWatchdog::run() {
+    std::unique_lock<std::mutex> lock(mu_);
+    while (!wake_.wait_for(lock, interval_, [this] { return stopping_; })) {
+        lock.unlock();
+        for (const auto &loop : loops_) check(loop);
+        lock.lock();
+    }
+}
+
+void StallWatchdog::check(const std::shared_ptr<Loop> &entry) {
+    auto &loop = *entry;
+    if (!loop.pending.load(std::memory_order_acquire)) {
+        loop.reported = false;
+        loop.sentAtMicros.store(nowMicros(), std::memory_order_relaxed);
+        loop.pending.store(true, std::memory_order_release);
+        loop.post([self = entry] {
+            if (!self->threadKnown.load(std::memory_order_relaxed)) {
+                self->thread = pthread_self();
+                self->threadKnown.store(true, std::memory_order_release);
+            }
+            auto sentAt = self->sentAtMicros.load(std::memory_order_relaxed);
+            auto lag = static_cast<uint64_t>(std::max<int64_t>(0, nowMicros() - sentAt));
+            auto bump = [](std::atomic<uint64_t> &c, uint64_t n) {
+                c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            };
+            bump(self->buckets[LatencyBuckets::indexFor(lag)], 1);
+            bump(self->sumMicros, lag);
+            if (lag > self->maxLagMicros.load(std::memory_order_relaxed)) {
+                self->maxLagMicros.store(lag, std::memory_order_relaxed);
+            }
+            self->pending.store(false, std::memory_order_release);
+        });
+        return;
+    }
+
+    if (loop.reported) return;
+    auto waited = std::chrono::microseconds(
+        nowMicros() - loop.sentAtMicros.load(std::memory_order_relaxed));
+    if (waited < threshold_) return;
+
+    loop.reported = true;
+    loop.stalls.store(loop.stalls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    StallReport report;
+    report.loop = loop.name;
+    report.stalledFor = std::chrono::duration_cast<std::chrono::milliseconds>(waited);
+    if (loop.threadKnown.load(std::memory_order_acquire)) {
+        report.stack = captureStack(loop.thread);
+    }
+    if (onStall_) onStall_(report);
+}
+
+std::vector<std::string> StallWatchdog::captureStack(pthread_t thread) {
+    uint64_t seq = gRequestedSeq.fetch_add(1, std::memory_order_acq_rel) + 1;
+    if (pthread_kill(thread, stackSignal()) != 0) return {};
+
+    auto deadline = Clock::now() + std::chrono::milliseconds(200);
+    while (gCompletedSeq.load(std::memory_order_acquire) != seq) {
+        if (Clock::now() >= deadline) return {};
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    int count = gFrameCount.load(std::memory_order_relaxed);
+    std::vector<std::string> stack;
+    char **symbols = backtrace_symbols(gFrames, count);
+    if (!symbols) return stack;
+    for (int i = kHandlerFrames; i < count; ++i) stack.push_back(demangleFrame(symbols[i]));
+    std::free(symbols);
+    return stack;
+}
+
+std::vector<StallWatchdog::LoopSnapshot> StallWatchdog::snapshot() const {
+    std::vector<LoopSnapshot> out;
+    out.reserve(loops_.size());
+    for (const auto &loop : loops_) {
+        LoopSnapshot snap;
+        snap.name = loop->name;
+        snap.stalls = loop->stalls.load(std::memory_order_relaxed);
+        snap.maxLagMicros = loop->maxLagMicros.load(std::memory_order_relaxed);
+        snap.sumMicros = loop->sumMicros.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < LatencyBuckets::kCount; ++i) {
+            snap.buckets[i] = loop->buckets[i].load(std::memory_order_relaxed);
+        }
+        out.push_back(std::move(snap));
+    }
+    return out;
+}
+
+std::string StallWatchdog::renderPrometheus() const {
+    auto loops = snapshot();
+    if (loops.empty()) return {};
+
+    std::string out;
+    out += "# HELP pyracms_event_loop_lag_seconds Delay before a queued task runs on each "
+           "event loop.\n"
+           "# TYPE pyracms_event_loop_lag_seconds histogram\n";
+    for (const auto &loop : loops) {
+        appendLatencyHistogram(out, "pyracms_event_loop_lag_seconds",
+                               "loop=\"" + escapePrometheusLabel(loop.name) + "\"",
+                               loop.buckets, loop.sumMicros);
+    }
+    out += "# HELP pyracms_event_loop_max_lag_seconds Largest lag seen on each event loop.\n"
+           "# TYPE pyracms_event_loop_max_lag_seconds gauge\n";
+    for (const auto &loop : loops) {
+        out += "pyracms_event_loop_max_lag_seconds{loop=\"" + escapePrometheusLabel(loop.name) +
+               "\"} " + std::to_string(static_cast<double>(loop.maxLagMicros) / 1e6) + "\n";
+    }
+    out += "# HELP pyracms_event_loop_stalls_total Pings that waited past the stall threshold.\n"
+           "# TYPE pyracms_event_loop_stalls_total counter\n";
+    for (const auto &loop : loops) {
+        out += "pyracms_event_loop_stalls_total{loop=\"" + escapePrometheusLabel(loop.name) +
+               "\"} " + std::to_string(loop.stalls) + "\n";
+    }
+    return out;
+}
+
+} // namespace pyracms
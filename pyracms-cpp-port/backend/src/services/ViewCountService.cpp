@@ -0,0 +1,98 @@
+#include "services/ViewCountService.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace pyracms {
+
+namespace {
+
+constexpr size_t kRowsPerStatement = 1000;
+
+const char *tableName(ViewCounter::Table table) {
+    switch (table) {
+    case ViewCounter::Table::Article:
+        return "articles";
+    case ViewCounter::Table::ForumThread:
+        return "forum_threads";
+    case ViewCounter::Table::GameDepPage:
+        return "gamedep_pages";
+    }
+    return "";
+}
+
+// Ids and counts are integers the process produced, so they are written
+// into the statement directly rather than bound one parameter per value
+std::string updateStatement(ViewCounter::Table table,
+                            std::vector<ViewCounter::Delta>::const_iterator from,
+                            std::vector<ViewCounter::Delta>::const_iterator to) {
+    std::string values;
+    for (auto it = from; it != to; ++it) {
+        if (!values.empty()) values += ", ";
+        values += "(" + std::to_string(it->id) + ", " + std::to_string(it->views) + ")";
+    }
+    std::string name = tableName(table);
+    return "UPDATE " + name + " t SET view_count = COALESCE(t.view_count, 0) + v.views "
+           "FROM (VALUES " + values + ") AS v(id, views) WHERE t.id = v.id";
+}
+
+} // namespace
+
+std::atomic<uint64_t> ViewCountService::flushed_{0};
+std::atomic<uint64_t> ViewCountService::failed_{0};
+
+ViewCounter &ViewCountService::counter() {
+    static ViewCounter counter;
+    return counter;
+}
+
+void ViewCountService::flush(const DbClientPtr &db, std::function<void()> done) {
+    auto deltas = std::make_shared<const std::vector<ViewCounter::Delta>>(counter().drain());
+
+    // Statements cover runs of one table, at most kRowsPerStatement rows
+    std::vector<std::pair<size_t, size_t>> batches;
+    for (size_t from = 0; from < deltas->size();) {
+        size_t to = from;
+        while (to < deltas->size() && to - from < kRowsPerStatement &&
+               (*deltas)[to].table == (*deltas)[from].table) {
+            ++to;
+        }
+        batches.emplace_back(from, to);
+        from = to;
+    }
+    if (batches.empty()) {
+        if (done) done();
+        return;
+    }
+
+    auto remaining = std::make_shared<std::atomic<size_t>>(batches.size());
+    auto finish = [remaining, done]() {
+        if (remaining->fetch_sub(1) == 1 && done) done();
+    };
+    for (const auto &[from, to] : batches) {
+        auto first = deltas->begin() + static_cast<std::ptrdiff_t>(from);
+        auto last = deltas->begin() + static_cast<std::ptrdiff_t>(to);
+        db->execSqlAsync(
+            updateStatement(first->table, first, last),
+            [deltas, from, to, finish](const drogon::orm::Result &) {
+                std::vector<ViewCounter::Delta> written(
+                    deltas->begin() + static_cast<std::ptrdiff_t>(from),
+                    deltas->begin() + static_cast<std::ptrdiff_t>(to));
+                uint64_t views = 0;
+                for (const auto &delta : written) views += static_cast<uint64_t>(delta.views);
+                counter().commit(written);
+                flushed_.fetch_add(views, std::memory_order_relaxed);
+                finish();
+            },
+            [deltas, from, to, finish](const drogon::orm::DrogonDbException &e) {
+                LOG_ERROR << "View count flush failed: " << e.base().what();
+                counter().restore(std::vector<ViewCounter::Delta>(
+                    deltas->begin() + static_cast<std::ptrdiff_t>(from),
+                    deltas->begin() + static_cast<std::ptrdiff_t>(to)));
+                failed_.fetch_add(1, std::memory_order_relaxed);
+                finish();
+            });
+    }
+}
+
+} // namespace pyracms
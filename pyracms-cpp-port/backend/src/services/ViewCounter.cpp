@@ -0,0 +1,74 @@
+#include "services/ViewCounter.h"
+
+#include <algorithm>
+
+namespace pyracms {
+
+void ViewCounter::record(Table table, int id, int64_t views) {
+    if (views <= 0) return;
+    auto k = key(table, id);
+    auto &s = shard(k);
+    std::lock_guard<std::mutex> lock(s.mu);
+    auto [it, inserted] = s.live.try_emplace(k, 0);
+    if (inserted) keys_.fetch_add(1, std::memory_order_relaxed);
+    it->second += views;
+}
+
+int64_t ViewCounter::pending(Table table, int id) const {
+    auto k = key(table, id);
+    const auto &s = shard(k);
+    std::lock_guard<std::mutex> lock(s.mu);
+    int64_t total = 0;
+    if (auto it = s.live.find(k); it != s.live.end()) total += it->second;
+    if (auto it = s.inFlight.find(k); it != s.inFlight.end()) total += it->second;
+    return total;
+}
+
+std::vector<ViewCounter::Delta> ViewCounter::drain() {
+    std::vector<Delta> out;
+    for (auto &s : shards_) {
+        std::lock_guard<std::mutex> lock(s.mu);
+        keys_.fetch_sub(s.live.size(), std::memory_order_relaxed);
+        for (const auto &[k, views] : s.live) {
+            s.inFlight[k] += views;
+            out.push_back({static_cast<Table>(k >> 32), static_cast<int>(static_cast<uint32_t>(k)),
+                           views});
+        }
+        s.live.clear();
+    }
+    std::sort(out.begin(), out.end(), [](const Delta &a, const Delta &b) {
+        return a.table != b.table ? a.table < b.table : a.id < b.id;
+    });
+    return out;
+}
+
+void ViewCounter::commit(const std::vector<Delta> &deltas) {
+    for (const auto &delta : deltas) {
+        auto k = key(delta.table, delta.id);
+        auto &s = shard(k);
+        std::lock_guard<std::mutex> lock(s.mu);
+        auto it = s.inFlight.find(k);
+        if (it == s.inFlight.end()) continue;
+        it->second -= delta.views;
+        if (it->second <= 0) s.inFlight.erase(it);
+    }
+}
+
+void ViewCounter::restore(const std::vector<Delta> &deltas) {
+    // Moved back under one lock, so pending() never misses them
+    for (const auto &delta : deltas) {
+        auto k = key(delta.table, delta.id);
+        auto &s = shard(k);
+        std::lock_guard<std::mutex> lock(s.mu);
+        auto it = s.inFlight.find(k);
+        if (it == s.inFlight.end()) continue;
+        int64_t views = std::min(it->second, delta.views);
+        it->second -= views;
+        if (it->second <= 0) s.inFlight.erase(it);
+        auto [live, inserted] = s.live.try_emplace(k, 0);
+        if (inserted) keys_.fetch_add(1, std::memory_order_relaxed);
+        live->second += views;
+    }
+}
+
+} // namespace pyracms
@@ -132,12 +132,13 @@ void WebhookService::deleteWebhook(const DbClientPtr &db, int webhookId,
 }
 
 void WebhookService::getDeliveries(
-    const DbClientPtr &db, int webhookId, int limit, int offset,
+    const DbClientPtr &db, int webhookId, const PageRequest &page,
     std::function<void(const std::vector<WebhookDeliveryDto> &)> cb) {
 
     db->execSqlAsync(
         "SELECT * FROM webhook_deliveries WHERE webhook_id = $1 "
-        "ORDER BY delivered_at DESC LIMIT $2 OFFSET $3",
+        "AND (delivered_at, id) < ($2::timestamptz, $3::bigint) "
+        "ORDER BY delivered_at DESC, id DESC LIMIT $4 OFFSET $5",
         [cb](const drogon::orm::Result &result) {
             std::vector<WebhookDeliveryDto> deliveries;
             for (const auto &row : result) {
@@ -157,7 +158,7 @@ void WebhookService::getDeliveries(
         [cb](const drogon::orm::DrogonDbException &) {
             cb({});
         },
-        webhookId, limit, offset);
+        webhookId, page.afterKey(), page.afterId(), page.limit, page.skip());
 }
 
 std::string WebhookService::computeHmac(const std::string &payload,
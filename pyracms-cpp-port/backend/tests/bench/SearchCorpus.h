@@ -0,0 +1,279 @@
+#pragma once
+
+// Reproducible synthetic search corpus and ground truth for bench_search.
+//
+// Documents and queries are drawn from a Zipfian vocabulary of "w<rank>"
+// words, so a few terms appear almost everywhere and most are rare, as in
+// real text. Words of that shape are single tokens for every engine (no
+// stemming or splitting), which keeps the engines comparable.
+//
+// std::mt19937_64 produces the same sequence on every standard library;
+// the distributions do not, so values are derived from raw engine output
+// by hand. The same config therefore yields the same corpus everywhere.
+
+#include "services/EmbeddedIndex.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace pyracms::bench {
+
+class Rng {
+public:
+    explicit Rng(uint64_t seed) : engine_(seed) {}
+
+    // Uniform in [0, 1)
+    double uniform() { return static_cast<double>(engine_() >> 11) * 0x1.0p-53; }
+    size_t below(size_t n) { return std::min(static_cast<size_t>(uniform() * n), n - 1); }
+    // Log-uniform in [lo, hi], for long-tailed lengths
+    size_t logUniform(size_t lo, size_t hi) {
+        double v = std::exp(std::log(static_cast<double>(lo)) +
+                            uniform() * (std::log(static_cast<double>(hi) + 1) -
+                                         std::log(static_cast<double>(lo))));
+        return std::clamp(static_cast<size_t>(v), lo, hi);
+    }
+
+private:
+    std::mt19937_64 engine_;
+};
+
+// Ranks 0..n-1 with P(rank) proportional to 1 / (rank + 1)^s
+class Zipf {
+public:
+    Zipf(size_t n, double s) {
+        cdf_.reserve(n);
+        double sum = 0;
+        for (size_t rank = 0; rank < n; ++rank) {
+            sum += 1.0 / std::pow(static_cast<double>(rank + 1), s);
+            cdf_.push_back(sum);
+        }
+        for (auto &c : cdf_) c /= sum;
+    }
+
+    size_t operator()(Rng &rng) const {
+        auto it = std::upper_bound(cdf_.begin(), cdf_.end(), rng.uniform());
+        return std::min(static_cast<size_t>(it - cdf_.begin()), cdf_.size() - 1);
+    }
+
+private:
+    std::vector<double> cdf_;
+};
+
+struct CorpusConfig {
+    uint64_t seed = 42;
+    size_t documents = 50000;
+    size_t tenants = 8;
+    size_t vocabulary = 50000;
+    double termSkew = 1.0;   // Zipf exponent for words
+    double tenantSkew = 0.8; // larger tenants hold more documents and queries
+    size_t queries = 1000;
+};
+
+struct Query {
+    int tenantId;
+    std::string text;
+};
+
+struct Corpus {
+    std::vector<std::pair<int, IndexedDocument>> documents; // tenant id, document
+    std::vector<Query> queries;
+};
+
+// Shapes of the four searchable types: share of the corpus and word counts
+struct DocumentShape {
+    const char *type;
+    double share;
+    size_t titleMin, titleMax;
+    size_t bodyMin, bodyMax;
+};
+
+constexpr std::array<DocumentShape, 4> kShapes = {{
+    {"article", 0.25, 3, 8, 150, 1500},
+    {"forum_post", 0.50, 3, 10, 10, 300},
+    {"snippet", 0.20, 2, 6, 10, 120},
+    {"gamedep", 0.05, 1, 3, 20, 80},
+}};
+
+inline int typeIndex(const std::string &type) {
+    for (size_t i = 0; i < kShapes.size(); ++i) {
+        if (type == kShapes[i].type) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// One number per (type, id), as the engines identify documents
+inline uint64_t documentKey(int type, int id) {
+    return (static_cast<uint64_t>(type) << 32) | static_cast<uint32_t>(id);
+}
+
+inline Corpus generateCorpus(const CorpusConfig &config) {
+    Rng rng(config.seed);
+    Zipf words(config.vocabulary, config.termSkew);
+    Zipf tenants(config.tenants, config.tenantSkew);
+    auto text = [&](size_t count) {
+        std::string out;
+        for (size_t i = 0; i < count; ++i) {
+            if (i > 0) out += ' ';
+            out += 'w';
+            out += std::to_string(words(rng) + 1);
+        }
+        return out;
+    };
+
+    Corpus corpus;
+    corpus.documents.reserve(config.documents);
+    std::array<int, kShapes.size()> nextId{};
+    for (size_t i = 0; i < config.documents; ++i) {
+        double pick = rng.uniform();
+        size_t s = 0;
+        while (s + 1 < kShapes.size() && pick >= kShapes[s].share) pick -= kShapes[s++].share;
+        const auto &shape = kShapes[s];
+
+        IndexedDocument doc;
+        doc.type = shape.type;
+        doc.id = ++nextId[s];
+        doc.title = text(shape.titleMin + rng.below(shape.titleMax - shape.titleMin + 1));
+        doc.content = text(rng.logUniform(shape.bodyMin, shape.bodyMax));
+        doc.url = "/" + doc.type + "/" + std::to_string(doc.id);
+        doc.createdAt = "2024-01-01T00:00:00Z";
+        corpus.documents.emplace_back(static_cast<int>(tenants(rng)) + 1, std::move(doc));
+    }
+
+    // Queries favour popular words but skip the head, which behaves like
+    // stop words: 1 to 3 words, shorter queries being more common
+    corpus.queries.reserve(config.queries);
+    for (size_t i = 0; i < config.queries; ++i) {
+        double pick = rng.uniform();
+        size_t count = pick < 0.5 ? 1 : pick < 0.85 ? 2 : 3;
+        Query query{static_cast<int>(tenants(rng)) + 1, {}};
+        for (size_t w = 0; w < count; ++w) {
+            if (w > 0) query.text += ' ';
+            size_t rank = std::min(10 + words(rng), config.vocabulary - 1);
+            query.text += "w" + std::to_string(rank + 1);
+        }
+        corpus.queries.push_back(std::move(query));
+    }
+    return corpus;
+}
+
+// Exhaustive BM25 with the embedded index's parameters: disjunctive, title
+// terms counted titleWeight times. Every document of the tenant is scored.
+class GroundTruth {
+public:
+    struct Hit {
+        double score;
+        uint64_t key;
+    };
+
+    explicit GroundTruth(const Corpus &corpus, const EmbeddedIndex::Options &options = {})
+        : options_(options) {
+        for (const auto &[tenantId, doc] : corpus.documents) {
+            auto &tenant = tenants_[tenantId];
+            std::unordered_map<uint32_t, uint32_t> tf;
+            uint32_t length = 0;
+            for (const auto &token : EmbeddedIndex::tokenize(doc.title)) {
+                tf[termId(token)] += options.titleWeight;
+                length += options.titleWeight;
+            }
+            for (const auto &token : EmbeddedIndex::tokenize(doc.content)) {
+                ++tf[termId(token)];
+                ++length;
+            }
+            Doc entry{documentKey(typeIndex(doc.type), doc.id), length, {tf.begin(), tf.end()}};
+            std::sort(entry.terms.begin(), entry.terms.end());
+            for (const auto &term : entry.terms) ++tenant.df[term.first];
+            tenant.totalLength += length;
+            tenant.docs.push_back(std::move(entry));
+        }
+    }
+
+    // All matching documents, best first
+    std::vector<Hit> search(const Query &query) const {
+        std::vector<Hit> hits;
+        auto t = tenants_.find(query.tenantId);
+        if (t == tenants_.end()) return hits;
+        const auto &tenant = t->second;
+
+        auto tokens = EmbeddedIndex::tokenize(query.text);
+        std::sort(tokens.begin(), tokens.end());
+        tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+        const double n = static_cast<double>(tenant.docs.size());
+        const double avgLength = std::max(1.0, static_cast<double>(tenant.totalLength) / n);
+        std::vector<std::pair<uint32_t, double>> terms; // term id, idf
+        for (const auto &token : tokens) {
+            auto id = dictionary_.find(token);
+            if (id == dictionary_.end()) continue;
+            auto df = tenant.df.find(id->second);
+            if (df == tenant.df.end()) continue;
+            double d = df->second;
+            terms.emplace_back(id->second, std::log(1 + (n - d + 0.5) / (d + 0.5)));
+        }
+
+        for (const auto &doc : tenant.docs) {
+            double score = 0;
+            bool matched = false;
+            for (const auto &[id, idf] : terms) {
+                auto it = std::lower_bound(doc.terms.begin(), doc.terms.end(),
+                                           std::make_pair(id, 0u));
+                if (it == doc.terms.end() || it->first != id) continue;
+                double tf = it->second;
+                score += idf * tf * (options_.k1 + 1) /
+                         (tf + options_.k1 * (1 - options_.b + options_.b * doc.length / avgLength));
+                matched = true;
+            }
+            if (matched) hits.push_back({score, doc.key});
+        }
+        std::sort(hits.begin(), hits.end(),
+                  [](const Hit &a, const Hit &b) { return a.score > b.score; });
+        return hits;
+    }
+
+    // Fraction of the true top k found in results. Documents tied with the
+    // k-th score all count as relevant, so tie order cannot cost recall.
+    static double recallAt(size_t k, const std::vector<Hit> &truth,
+                           const std::vector<uint64_t> &results) {
+        size_t wanted = std::min(k, truth.size());
+        if (wanted == 0) return 1.0;
+        double cutoff = truth[wanted - 1].score * (1 - 1e-9);
+        size_t found = 0;
+        for (size_t i = 0; i < results.size() && i < k; ++i) {
+            for (const auto &hit : truth) {
+                if (hit.score < cutoff) break;
+                if (hit.key == results[i]) {
+                    ++found;
+                    break;
+                }
+            }
+        }
+        return static_cast<double>(std::min(found, wanted)) / static_cast<double>(wanted);
+    }
+
+private:
+    struct Doc {
+        uint64_t key;
+        uint32_t length;
+        std::vector<std::pair<uint32_t, uint32_t>> terms; // term id, weighted tf; sorted
+    };
+    struct Tenant {
+        std::vector<Doc> docs;
+        std::unordered_map<uint32_t, uint32_t> df;
+        uint64_t totalLength = 0;
+    };
+
+    uint32_t termId(const std::string &token) {
+        return dictionary_.emplace(token, static_cast<uint32_t>(dictionary_.size())).first->second;
+    }
+
+    EmbeddedIndex::Options options_;
+    std::unordered_map<std::string, uint32_t> dictionary_;
+    std::unordered_map<int, Tenant> tenants_;
+};
+
+} // namespace pyracms::bench
@@ -0,0 +1,129 @@
+// Encode/decode cost of the binary cache codec versus the jsoncpp round
+// trip SearchService used for cached SearchResults before it.
+//
+// Build with -DBUILD_BENCHMARKS=ON and run ./bench_cache_codec.
+
+#include "services/CacheCodecs.h"
+
+#include <json/json.h>
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+
+using namespace pyracms;
+
+namespace {
+
+SearchResults makeResults(int n) {
+    SearchResults results;
+    results.query = "event loop latency";
+    results.totalCount = n;
+    for (int i = 0; i < n; ++i) {
+        SearchResultItem item;
+        item.type = i % 2 ? "forum_post" : "article";
+        item.id = 1000 + i;
+        item.title = "Result title number " + std::to_string(i);
+        item.snippet = std::string(180, 'a' + i % 26);
+        item.url = "/articles/result-" + std::to_string(i);
+        item.rank = 1.0 / (i + 1);
+        item.createdAt = "2024-05-06 07:08:09.123456";
+        results.items.push_back(item);
+    }
+    results.facets["article"] = (n + 1) / 2;
+    results.facets["forum_post"] = n / 2;
+    return results;
+}
+
+// The pre-codec serialization, copied from SearchService
+std::string jsonEncode(const SearchResults &results) {
+    Json::Value cacheVal;
+    cacheVal["query"] = results.query;
+    cacheVal["totalCount"] = results.totalCount;
+    cacheVal["items"] = Json::Value(Json::arrayValue);
+    for (const auto &item : results.items) {
+        Json::Value ji;
+        ji["type"] = item.type;
+        ji["id"] = item.id;
+        ji["title"] = item.title;
+        ji["snippet"] = item.snippet;
+        ji["url"] = item.url;
+        ji["rank"] = item.rank;
+        ji["createdAt"] = item.createdAt;
+        cacheVal["items"].append(ji);
+    }
+    cacheVal["facets"] = Json::Value(Json::objectValue);
+    for (const auto &[k, v] : results.facets) {
+        cacheVal["facets"][k] = v;
+    }
+    Json::StreamWriterBuilder writer;
+    return Json::writeString(writer, cacheVal);
+}
+
+bool jsonDecode(const std::string &cached, SearchResults &results) {
+    Json::Value root;
+    Json::CharReaderBuilder reader;
+    std::istringstream stream(cached);
+    std::string errors;
+    if (!Json::parseFromStream(reader, stream, &root, &errors)) return false;
+    results.query = root["query"].asString();
+    results.totalCount = root["totalCount"].asInt();
+    for (const auto &item : root["items"]) {
+        SearchResultItem sri;
+        sri.type = item["type"].asString();
+        sri.id = item["id"].asInt();
+        sri.title = item["title"].asString();
+        sri.snippet = item["snippet"].asString();
+        sri.url = item["url"].asString();
+        sri.rank = item["rank"].asDouble();
+        sri.createdAt = item["createdAt"].asString();
+        results.items.push_back(sri);
+    }
+    for (const auto &key : root["facets"].getMemberNames()) {
+        results.facets[key] = root["facets"][key].asInt();
+    }
+    return true;
+}
+
+template <typename F>
+double usPerOp(int iterations, F &&fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) fn();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+}
+
+volatile size_t sink = 0;
+
+void runCase(int items, int iterations) {
+    auto results = makeResults(items);
+    auto json = jsonEncode(results);
+    auto binary = encodeBinary(results);
+
+    double jsonEnc = usPerOp(iterations, [&] { sink += jsonEncode(results).size(); });
+    double binEnc = usPerOp(iterations, [&] { sink += encodeBinary(results).size(); });
+    double jsonDec = usPerOp(iterations, [&] {
+        SearchResults out;
+        jsonDecode(json, out);
+        sink += out.items.size();
+    });
+    double binDec = usPerOp(iterations, [&] {
+        SearchResults out;
+        decodeBinary(binary, out);
+        sink += out.items.size();
+    });
+
+    std::printf("%5d items  size %7zu / %7zu B  encode %8.2f / %7.2f us  decode %8.2f / %7.2f us\n",
+                items, json.size(), binary.size(), jsonEnc, binEnc, jsonDec, binDec);
+}
+
+} // namespace
+
+int main() {
+    std::printf("SearchResults, jsoncpp / binary\n");
+    runCase(1, 50000);
+    runCase(20, 10000);
+    runCase(100, 2000);
+    runCase(1000, 200);
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Parse throughput of RespReader versus the single-recv parser that
+// CacheService::execCommand used before the streaming reader.
+//
+// Build with -DBUILD_BENCHMARKS=ON and run ./bench_resp_reader.
+
+#include "services/RespReader.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace pyracms;
+
+namespace {
+
+// Verbatim port of the old reply handling: copy the recv buffer into a
+// string, then substr the payload out. Only understands scalar replies.
+std::string legacyParse(const char *buf, size_t n) {
+    std::string response(buf, n);
+    if (response.empty()) return "";
+    if (response[0] == '$') {
+        if (response[1] == '-') return "";
+        auto crlfPos = response.find("\r\n");
+        if (crlfPos == std::string::npos) return "";
+        int len = std::stoi(response.substr(1, crlfPos - 1));
+        if (len < 0) return "";
+        return response.substr(crlfPos + 2, len);
+    }
+    if (response[0] == '+' || response[0] == ':') {
+        auto crlfPos = response.find("\r\n");
+        return response.substr(1, crlfPos - 1);
+    }
+    return "";
+}
+
+std::string bulk(size_t size) {
+    std::string payload(size, 'x');
+    return "$" + std::to_string(size) + "\r\n" + payload + "\r\n";
+}
+
+template <typename F>
+double secondsFor(F &&fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+volatile size_t sink = 0;
+
+void runCase(const char *name, const std::string &wire, size_t iterations) {
+    double legacy = secondsFor([&] {
+        for (size_t i = 0; i < iterations; ++i) {
+            sink += legacyParse(wire.data(), wire.size()).size();
+        }
+    });
+
+    // The reader hands out a view, so copying into a std::string is what a
+    // CacheService::get caller pays; measure both.
+    RespValue v;
+    size_t consumed = 0;
+    size_t needed = 0;
+    double zeroCopy = secondsFor([&] {
+        for (size_t i = 0; i < iterations; ++i) {
+            RespReader::parse(wire.data(), wire.size(), v, consumed, needed);
+            sink += v.str.size();
+        }
+    });
+    double withCopy = secondsFor([&] {
+        for (size_t i = 0; i < iterations; ++i) {
+            RespReader::parse(wire.data(), wire.size(), v, consumed, needed);
+            sink += std::string(v.str).size();
+        }
+    });
+
+    double mb = static_cast<double>(wire.size() * iterations) / (1024.0 * 1024.0);
+    std::printf("%-16s %12.0f %12.0f %12.0f MB/s\n", name, mb / legacy, mb / zeroCopy,
+                mb / withCopy);
+}
+
+void runPipelined(size_t replies, size_t valueSize, size_t fragment) {
+    std::string wire;
+    for (size_t i = 0; i < replies; ++i) wire += bulk(valueSize);
+
+    size_t parsed = 0;
+    double elapsed = secondsFor([&] {
+        RespReader reader;
+        RespValue v;
+        for (size_t pos = 0; pos < wire.size(); pos += fragment) {
+            reader.feed(wire.data() + pos, std::min(fragment, wire.size() - pos));
+            while (reader.next(v) == RespReader::Status::Ok) ++parsed;
+        }
+    });
+    std::printf("pipelined %zu x %zuB in %zuB reads: %.0f replies/s (%zu parsed)\n", replies,
+                valueSize, fragment, static_cast<double>(parsed) / elapsed, parsed);
+}
+
+} // namespace
+
+int main() {
+    std::printf("%-16s %12s %12s %12s\n", "reply", "legacy", "zero-copy", "copy-out");
+    runCase("+OK", "+OK\r\n", 2000000);
+    runCase("$16", bulk(16), 2000000);
+    runCase("$1K", bulk(1024), 500000);
+    runCase("$64K", bulk(64 * 1024), 5000);
+    runCase("$1M", bulk(1024 * 1024), 300);
+
+    std::printf("\n");
+    runPipelined(100000, 64, 16 * 1024);
+    runPipelined(200, 256 * 1024, 64 * 1024);
+    return 0;
+}
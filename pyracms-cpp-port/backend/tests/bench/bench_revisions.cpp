@@ -0,0 +1,183 @@
+// Storage and rebuild latency of delta-compressed article revisions
+// (RevisionStore) against storing every revision in full.
+//
+// A synthetic wiki-style history: one article edited thousands of times,
+// mostly small edits with the occasional rewrite of a section. For each
+// snapshot interval it reports the stored bytes, the encode cost per
+// revision, and getRevision-style rebuild latency for random revisions
+// with no cache and with the default cache, plus the cost of rebuilding
+// the whole history as listRevisions does.
+//
+// Build with -DBUILD_BENCHMARKS=ON and run ./bench_revisions [revisions].
+
+#include "services/RevisionStore.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pyracms;
+
+namespace {
+
+const std::vector<std::string> kWords = {
+    "the", "of", "and", "server", "drogon", "request", "tenant", "article", "cache",
+    "latency", "postgres", "index", "render", "markdown", "event", "loop", "thread",
+    "revision", "delta", "snapshot", "compression", "query", "plan", "page", "user"};
+
+std::string sentence(std::mt19937 &rng) {
+    std::string out;
+    size_t words = 8 + rng() % 16;
+    for (size_t i = 0; i < words; ++i) {
+        if (i) out += ' ';
+        out += kWords[rng() % kWords.size()];
+    }
+    return out + ". ";
+}
+
+std::string section(std::mt19937 &rng) {
+    std::string out = "## " + kWords[rng() % kWords.size()] + "\n\n";
+    for (int i = 0; i < 12; ++i) out += sentence(rng);
+    return out + "\n\n";
+}
+
+std::vector<std::string> makeHistory(int revisions) {
+    std::mt19937 rng(2024);
+    std::string text;
+    for (int i = 0; i < 16; ++i) text += section(rng);
+
+    std::vector<std::string> history{text};
+    while (static_cast<int>(history.size()) < revisions) {
+        size_t at = rng() % text.size();
+        unsigned kind = rng() % 100;
+        if (kind < 40) {
+            text.insert(at, sentence(rng));
+        } else if (kind < 75) {
+            text.erase(at, std::min<size_t>(text.size() - at, 20 + rng() % 120));
+        } else if (kind < 97) {
+            text.replace(at, std::min<size_t>(text.size() - at, 10), sentence(rng));
+        } else {
+            // Rewrite a section; keeps the article around the same size
+            size_t length = std::min<size_t>(text.size() - at, 1500);
+            text.replace(at, length, section(rng));
+        }
+        history.push_back(text);
+    }
+    return history;
+}
+
+struct Stored {
+    std::vector<RevisionStore::Row> rows; // oldest first, id = index + 1
+    size_t bytes = 0;
+    double encodeUs = 0;
+};
+
+Stored encodeAll(const RevisionStore &store, const std::vector<std::string> &history) {
+    Stored stored;
+    int chain = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < history.size(); ++i) {
+        auto encoded = store.encode(history[i], i ? &history[i - 1] : nullptr, chain);
+        chain = encoded.chain;
+        RevisionStore::Row row;
+        row.id = static_cast<int>(i) + 1;
+        row.baseId = encoded.storage == RevisionStore::Storage::Delta ? static_cast<int>(i) : 0;
+        row.storage = encoded.storage;
+        row.body = std::move(encoded.body);
+        stored.bytes += row.body.size();
+        stored.rows.push_back(std::move(row));
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    stored.encodeUs = std::chrono::duration<double, std::micro>(elapsed).count() /
+                      static_cast<double>(history.size());
+    // The newest revision also keeps its text, as in article_revisions
+    stored.rows.back().content = history.back();
+    stored.bytes += history.back().size();
+    return stored;
+}
+
+// What the recursive query in ArticleService::getRevision returns
+std::vector<RevisionStore::Row> chainOf(const Stored &stored, int id) {
+    std::vector<RevisionStore::Row> chain;
+    for (int at = id; at > 0;) {
+        const auto &row = stored.rows[at - 1];
+        chain.push_back(row);
+        if (row.content || row.storage != RevisionStore::Storage::Delta) break;
+        at = row.baseId;
+    }
+    return chain;
+}
+
+struct Latency {
+    double p50 = 0;
+    double p99 = 0;
+};
+
+// Random revisions, skewed towards recent ones like real traffic
+Latency rebuildLatency(RevisionStore &store, const Stored &stored, int lookups) {
+    std::mt19937 rng(7);
+    std::vector<double> us;
+    us.reserve(lookups);
+    int n = static_cast<int>(stored.rows.size());
+    for (int i = 0; i < lookups; ++i) {
+        int back = static_cast<int>(std::min<double>(n - 1, std::exponential_distribution<>(
+                                                                 8.0 / n)(rng)));
+        int id = n - back;
+        auto chain = chainOf(stored, id);
+        auto start = std::chrono::steady_clock::now();
+        auto text = store.rebuild(chain);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        if (!text) {
+            std::fprintf(stderr, "rebuild of %d failed\n", id);
+            std::exit(1);
+        }
+        us.push_back(std::chrono::duration<double, std::micro>(elapsed).count());
+    }
+    std::sort(us.begin(), us.end());
+    return {us[us.size() / 2], us[us.size() * 99 / 100]};
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int revisions = argc > 1 ? std::atoi(argv[1]) : 3000;
+    auto history = makeHistory(revisions);
+    size_t raw = 0;
+    for (const auto &text : history) raw += text.size();
+    std::printf("%d revisions of a ~%zu KB article, %.1f MB stored in full\n\n", revisions,
+                history.back().size() / 1024, raw / 1048576.0);
+
+    std::printf("interval  stored KB  ratio  encode us/rev   no cache p50/p99 us"
+                "   cached p50/p99 us   whole history ms\n");
+    for (int interval : {1, 8, 16, 32, 64}) {
+        RevisionStore::Options options;
+        options.snapshotInterval = interval;
+        RevisionStore encoder(options);
+        auto stored = encodeAll(encoder, history);
+
+        options.cacheBytes = 0;
+        RevisionStore uncached(options);
+        auto cold = rebuildLatency(uncached, stored, 2000);
+
+        RevisionStore cached(RevisionStore::Options{interval, 3, 32 * 1024 * 1024});
+        auto warm = rebuildLatency(cached, stored, 2000);
+
+        auto start = std::chrono::steady_clock::now();
+        auto all = cached.rebuildAll(stored.rows);
+        double allMs = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - start).count();
+        if (all.size() != history.size() || !all.front() || *all.front() != history.front()) {
+            std::fprintf(stderr, "rebuildAll failed\n");
+            return 1;
+        }
+
+        std::printf("%8d  %9zu  %4.0fx  %13.1f  %9.1f / %7.1f  %8.1f / %7.1f  %17.1f\n",
+                    interval, stored.bytes / 1024, static_cast<double>(raw) / stored.bytes,
+                    stored.encodeUs, cold.p50, cold.p99, warm.p50, warm.p99, allMs);
+    }
+    return 0;
+}
@@ -0,0 +1,444 @@
+// Search latency and relevance across the SearchService backends.
+//
+// Generates a synthetic multi-tenant corpus (see SearchCorpus.h), loads it
+// into each backend, replays the query log and prints QPS, p50/p95/p99
+// latency and recall@10 against an exhaustive BM25 ground truth.
+//
+// Build with -DBUILD_BENCHMARKS=ON and run ./bench_search. The embedded
+// index always runs. Set BENCH_PG_URL (a libpq conninfo) to include
+// PostgreSQL full-text search, and BENCH_ES_URL (e.g. http://localhost:9200)
+// to include Elasticsearch or a compatible stand-in such as OpenSearch.
+// Each loads into scratch space (schema / index bench_search) that is
+// dropped afterwards, so point them at throwaway instances.
+//
+// Other knobs, all optional: BENCH_DOCS, BENCH_TENANTS, BENCH_VOCABULARY,
+// BENCH_QUERIES, BENCH_ROUNDS (timed passes over the log), BENCH_SEED, and
+// BENCH_MIN_RECALL, which makes the run exit 1 if any backend's mean
+// recall@10 falls below it.
+//
+// PostgreSQL and Elasticsearch run the query shapes SearchService and
+// ElasticsearchService send (prefix AND tsquery ranked by ts_rank;
+// best_fields multi_match with title^3 and fuzziness), so their recall
+// against BM25 measures how far their ranking drifts from it, and is
+// below 1 by design. Track it across runs rather than against the
+// embedded index.
+
+#include "SearchCorpus.h"
+
+#include <curl/curl.h>
+#include <json/json.h>
+#include <libpq-fe.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+using namespace pyracms;
+using namespace pyracms::bench;
+
+namespace {
+
+constexpr size_t kTopK = 10;
+
+size_t envSize(const char *name, size_t fallback) {
+    const char *value = std::getenv(name);
+    return value && *value ? static_cast<size_t>(std::strtoull(value, nullptr, 10)) : fallback;
+}
+
+template <typename F>
+double secondsFor(F &&fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+class Backend {
+public:
+    virtual ~Backend() = default;
+    virtual const char *name() const = 0;
+    virtual void load(const Corpus &corpus) = 0;
+    // Keys (documentKey) of the top kTopK results, best first
+    virtual std::vector<uint64_t> search(const Query &query) = 0;
+};
+
+// ── Embedded ─────────────────────────────────────────────────────────────────
+
+class EmbeddedBackend : public Backend {
+public:
+    const char *name() const override { return "embedded"; }
+
+    void load(const Corpus &corpus) override {
+        for (const auto &[tenantId, doc] : corpus.documents) index_.upsert(tenantId, doc);
+    }
+
+    std::vector<uint64_t> search(const Query &query) override {
+        std::vector<uint64_t> keys;
+        for (const auto &item : index_.search(query.tenantId, query.text, "", kTopK, 0).items) {
+            keys.push_back(documentKey(typeIndex(item.type), item.id));
+        }
+        return keys;
+    }
+
+private:
+    EmbeddedIndex index_;
+};
+
+// ── PostgreSQL ───────────────────────────────────────────────────────────────
+
+// One table for all four types, with the weighted stored vector and GIN
+// index of 013_search_vectors.sql, queried per tenant like each of
+// SearchService's per-type queries.
+class PostgresBackend : public Backend {
+public:
+    explicit PostgresBackend(const std::string &conninfo) : conn_(PQconnectdb(conninfo.c_str())) {
+        if (PQstatus(conn_) != CONNECTION_OK) {
+            std::string error = PQerrorMessage(conn_);
+            PQfinish(conn_);
+            throw std::runtime_error("PostgreSQL: " + error);
+        }
+    }
+    ~PostgresBackend() override {
+        PQclear(PQexec(conn_, "DROP SCHEMA IF EXISTS bench_search CASCADE"));
+        PQfinish(conn_);
+    }
+
+    const char *name() const override { return "postgres"; }
+
+    void load(const Corpus &corpus) override {
+        exec("SET client_min_messages = warning");
+        exec("DROP SCHEMA IF EXISTS bench_search CASCADE");
+        exec("CREATE SCHEMA bench_search");
+        exec("CREATE TABLE bench_search.docs ("
+             "tenant_id INTEGER NOT NULL, type SMALLINT NOT NULL, id INTEGER NOT NULL, "
+             "title TEXT NOT NULL, content TEXT NOT NULL, "
+             "search_vector tsvector GENERATED ALWAYS AS ("
+             "setweight(to_tsvector('english', title), 'A') || "
+             "setweight(to_tsvector('english', content), 'B')) STORED, "
+             "PRIMARY KEY (type, id))");
+
+        // COPY text format; the corpus has no tabs, newlines or backslashes
+        check(PQexec(conn_, "COPY bench_search.docs (tenant_id, type, id, title, content) "
+                            "FROM STDIN"),
+              PGRES_COPY_IN);
+        std::string batch;
+        for (const auto &[tenantId, doc] : corpus.documents) {
+            batch += std::to_string(tenantId) + '\t' + std::to_string(typeIndex(doc.type)) + '\t' +
+                     std::to_string(doc.id) + '\t' + doc.title + '\t' + doc.content + '\n';
+            if (batch.size() > (1 << 20)) flushCopy(batch);
+        }
+        flushCopy(batch);
+        if (PQputCopyEnd(conn_, nullptr) != 1) fail("COPY");
+        check(PQgetResult(conn_), PGRES_COMMAND_OK);
+        while (PGresult *rest = PQgetResult(conn_)) PQclear(rest);
+
+        exec("CREATE INDEX ON bench_search.docs USING GIN(search_vector)");
+        exec("CREATE INDEX ON bench_search.docs (tenant_id)");
+        exec("ANALYZE bench_search.docs");
+        check(PQprepare(conn_, "search",
+                        "SELECT d.type, d.id, ts_rank(d.search_vector, query) AS rank "
+                        "FROM bench_search.docs d, to_tsquery('english', $2) query "
+                        "WHERE d.tenant_id = $1 AND d.search_vector @@ query "
+                        "ORDER BY rank DESC, d.id DESC LIMIT $3",
+                        3, nullptr),
+              PGRES_COMMAND_OK);
+    }
+
+    std::vector<uint64_t> search(const Query &query) override {
+        // Same tsquery SearchService builds: every word, as a prefix
+        std::string tsQuery;
+        std::istringstream words(query.text);
+        std::string word;
+        while (words >> word) tsQuery += (tsQuery.empty() ? "" : " & ") + word + ":*";
+
+        auto tenant = std::to_string(query.tenantId);
+        auto limit = std::to_string(kTopK);
+        const char *params[] = {tenant.c_str(), tsQuery.c_str(), limit.c_str()};
+        PGresult *result = PQexecPrepared(conn_, "search", 3, params, nullptr, nullptr, 0);
+        check(result, PGRES_TUPLES_OK, false);
+        std::vector<uint64_t> keys;
+        for (int row = 0; row < PQntuples(result); ++row) {
+            keys.push_back(documentKey(std::atoi(PQgetvalue(result, row, 0)),
+                                       std::atoi(PQgetvalue(result, row, 1))));
+        }
+        PQclear(result);
+        return keys;
+    }
+
+private:
+    [[noreturn]] void fail(const std::string &what) {
+        throw std::runtime_error("PostgreSQL " + what + ": " + PQerrorMessage(conn_));
+    }
+    void check(PGresult *result, ExecStatusType expected, bool clear = true) {
+        bool ok = PQresultStatus(result) == expected;
+        if (!ok || clear) PQclear(result);
+        if (!ok) fail("query");
+    }
+    void exec(const char *sql) { check(PQexec(conn_, sql), PGRES_COMMAND_OK); }
+    void flushCopy(std::string &batch) {
+        if (PQputCopyData(conn_, batch.data(), static_cast<int>(batch.size())) != 1) fail("COPY");
+        batch.clear();
+    }
+
+    PGconn *conn_;
+};
+
+// ── Elasticsearch ────────────────────────────────────────────────────────────
+
+size_t appendBody(char *data, size_t size, size_t count, void *out) {
+    static_cast<std::string *>(out)->append(data, size * count);
+    return size * count;
+}
+
+class ElasticsearchBackend : public Backend {
+public:
+    explicit ElasticsearchBackend(std::string url) : url_(std::move(url)), curl_(curl_easy_init()) {
+        if (!curl_) throw std::runtime_error("Elasticsearch: curl_easy_init failed");
+        while (!url_.empty() && url_.back() == '/') url_.pop_back();
+    }
+    ~ElasticsearchBackend() override {
+        try {
+            request("DELETE", "/bench_search", "");
+        } catch (const std::exception &) {
+            // Best effort; the index is only scratch space
+        }
+        curl_easy_cleanup(curl_);
+    }
+
+    const char *name() const override { return "elasticsearch"; }
+
+    void load(const Corpus &corpus) override {
+        request("DELETE", "/bench_search", "");
+        // The fields the search query reads, mapped as in indexDefinition()
+        expectOk(request("PUT", "/bench_search", R"({
+            "settings": {"number_of_shards": 1, "number_of_replicas": 0,
+                         "refresh_interval": "-1"},
+            "mappings": {"properties": {
+                "tenant_id": {"type": "integer"},
+                "type": {"type": "keyword"},
+                "title": {"type": "text"},
+                "content": {"type": "text"}
+            }}
+        })"),
+                 "create index");
+
+        Json::StreamWriterBuilder writer;
+        writer["indentation"] = "";
+        std::string bulk;
+        size_t pending = 0;
+        auto flush = [&] {
+            if (pending == 0) return;
+            auto response = request("POST", "/bench_search/_bulk", bulk, "application/x-ndjson");
+            expectOk(response, "bulk");
+            if (response.second["errors"].asBool()) {
+                throw std::runtime_error("Elasticsearch: bulk item failed");
+            }
+            bulk.clear();
+            pending = 0;
+        };
+        for (const auto &[tenantId, doc] : corpus.documents) {
+            Json::Value action;
+            action["index"]["_id"] = std::to_string(documentKey(typeIndex(doc.type), doc.id));
+            Json::Value source;
+            source["tenant_id"] = tenantId;
+            source["type"] = doc.type;
+            source["title"] = doc.title;
+            source["content"] = doc.content;
+            bulk += Json::writeString(writer, action) + '\n' + Json::writeString(writer, source) + '\n';
+            if (++pending == 2000) flush();
+        }
+        flush();
+        expectOk(request("PUT", "/bench_search/_settings", R"({"index": {"refresh_interval": "1s"}})"),
+                 "settings");
+        expectOk(request("POST", "/bench_search/_refresh", ""), "refresh");
+    }
+
+    std::vector<uint64_t> search(const Query &query) override {
+        Json::Value body;
+        Json::Value tenant;
+        tenant["term"]["tenant_id"] = query.tenantId;
+        body["query"]["bool"]["filter"].append(tenant);
+        Json::Value match;
+        match["multi_match"]["query"] = query.text;
+        match["multi_match"]["fields"].append("title^3");
+        match["multi_match"]["fields"].append("content");
+        match["multi_match"]["type"] = "best_fields";
+        match["multi_match"]["fuzziness"] = "AUTO";
+        body["query"]["bool"]["must"].append(match);
+        body["size"] = static_cast<Json::UInt64>(kTopK);
+        body["_source"] = false;
+
+        Json::StreamWriterBuilder writer;
+        writer["indentation"] = "";
+        auto response = request("POST", "/bench_search/_search", Json::writeString(writer, body));
+        expectOk(response, "search");
+        std::vector<uint64_t> keys;
+        for (const auto &hit : response.second["hits"]["hits"]) {
+            keys.push_back(std::strtoull(hit["_id"].asCString(), nullptr, 10));
+        }
+        return keys;
+    }
+
+private:
+    using Response = std::pair<long, Json::Value>;
+
+    Response request(const char *method, const std::string &path, const std::string &body,
+                     const char *contentType = "application/json") {
+        std::string text;
+        std::string header = std::string("Content-Type: ") + contentType;
+        curl_slist *headers = curl_slist_append(nullptr, header.c_str());
+        curl_easy_reset(curl_);
+        curl_easy_setopt(curl_, CURLOPT_URL, (url_ + path).c_str());
+        curl_easy_setopt(curl_, CURLOPT_CUSTOMREQUEST, method);
+        curl_easy_setopt(curl_, CURLOPT_HTTPHEADER, headers);
+        if (!body.empty()) {
+            curl_easy_setopt(curl_, CURLOPT_POSTFIELDS, body.c_str());
+            curl_easy_setopt(curl_, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.size()));
+        }
+        curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, appendBody);
+        curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &text);
+        CURLcode code = curl_easy_perform(curl_);
+        curl_slist_free_all(headers);
+        if (code != CURLE_OK) {
+            throw std::runtime_error(std::string("Elasticsearch: ") + curl_easy_strerror(code));
+        }
+
+        long status = 0;
+        curl_easy_getinfo(curl_, CURLINFO_RESPONSE_CODE, &status);
+        Json::Value json;
+        std::istringstream stream(text);
+        Json::CharReaderBuilder reader;
+        std::string errors;
+        Json::parseFromStream(reader, stream, &json, &errors);
+        return {status, json};
+    }
+
+    static void expectOk(const Response &response, const char *what) {
+        if (response.first < 200 || response.first >= 300) {
+            throw std::runtime_error(std::string("Elasticsearch ") + what + " failed with HTTP " +
+                                     std::to_string(response.first));
+        }
+    }
+
+    std::string url_;
+    CURL *curl_;
+};
+
+// ── Replay ───────────────────────────────────────────────────────────────────
+
+struct Report {
+    double loadSeconds = 0;
+    double qps = 0;
+    double p50 = 0;
+    double p95 = 0;
+    double p99 = 0;
+    double recall = 0;
+};
+
+double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+Report run(Backend &backend, const Corpus &corpus,
+           const std::vector<std::vector<GroundTruth::Hit>> &truth, size_t rounds) {
+    Report report;
+    report.loadSeconds = secondsFor([&] { backend.load(corpus); });
+
+    // The untimed first pass warms caches and scores recall
+    double recallSum = 0;
+    for (size_t i = 0; i < corpus.queries.size(); ++i) {
+        recallSum += GroundTruth::recallAt(kTopK, truth[i], backend.search(corpus.queries[i]));
+    }
+    report.recall = corpus.queries.empty() ? 1.0 : recallSum / static_cast<double>(corpus.queries.size());
+
+    std::vector<double> latencies;
+    latencies.reserve(corpus.queries.size() * rounds);
+    double total = 0;
+    for (size_t round = 0; round < rounds; ++round) {
+        for (const auto &query : corpus.queries) {
+            double seconds = secondsFor([&] { backend.search(query); });
+            latencies.push_back(seconds * 1000);
+            total += seconds;
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+    report.qps = total > 0 ? static_cast<double>(latencies.size()) / total : 0;
+    report.p50 = percentile(latencies, 0.50);
+    report.p95 = percentile(latencies, 0.95);
+    report.p99 = percentile(latencies, 0.99);
+    return report;
+}
+
+} // namespace
+
+int main() {
+    CorpusConfig config;
+    config.seed = envSize("BENCH_SEED", config.seed);
+    config.documents = envSize("BENCH_DOCS", config.documents);
+    config.tenants = std::max<size_t>(envSize("BENCH_TENANTS", config.tenants), 1);
+    config.vocabulary = std::max<size_t>(envSize("BENCH_VOCABULARY", config.vocabulary), 16);
+    config.queries = envSize("BENCH_QUERIES", config.queries);
+    size_t rounds = std::max<size_t>(envSize("BENCH_ROUNDS", 5), 1);
+    const char *minRecall = std::getenv("BENCH_MIN_RECALL");
+
+    Corpus corpus;
+    double generateSeconds = secondsFor([&] { corpus = generateCorpus(config); });
+    std::printf("corpus: %zu documents, %zu tenants, %zu-word vocabulary, seed %llu (%.1f s)\n",
+                config.documents, config.tenants, config.vocabulary,
+                static_cast<unsigned long long>(config.seed), generateSeconds);
+
+    std::vector<std::vector<GroundTruth::Hit>> truth;
+    size_t unmatched = 0;
+    double truthSeconds = secondsFor([&] {
+        GroundTruth exhaustive(corpus);
+        for (const auto &query : corpus.queries) {
+            truth.push_back(exhaustive.search(query));
+            if (truth.back().empty()) ++unmatched;
+        }
+    });
+    std::printf("ground truth: %zu queries, %zu without matches (%.1f s)\n\n",
+                corpus.queries.size(), unmatched, truthSeconds);
+
+    std::vector<std::unique_ptr<Backend>> backends;
+    backends.push_back(std::make_unique<EmbeddedBackend>());
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    try {
+        if (const char *pg = std::getenv("BENCH_PG_URL")) {
+            backends.push_back(std::make_unique<PostgresBackend>(pg));
+        }
+        if (const char *es = std::getenv("BENCH_ES_URL")) {
+            backends.push_back(std::make_unique<ElasticsearchBackend>(es));
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    std::printf("%-14s %8s %10s %9s %9s %9s %10s\n", "backend", "load s", "QPS", "p50 ms",
+                "p95 ms", "p99 ms", "recall@10");
+    int status = 0;
+    for (auto &backend : backends) {
+        try {
+            auto report = run(*backend, corpus, truth, rounds);
+            std::printf("%-14s %8.1f %10.0f %9.3f %9.3f %9.3f %10.4f\n", backend->name(),
+                        report.loadSeconds, report.qps, report.p50, report.p95, report.p99,
+                        report.recall);
+            if (minRecall && report.recall < std::atof(minRecall)) {
+                std::fprintf(stderr, "%s: recall@10 %.4f is below BENCH_MIN_RECALL %s\n",
+                             backend->name(), report.recall, minRecall);
+                status = 1;
+            }
+        } catch (const std::exception &e) {
+            std::fprintf(stderr, "%s: %s\n", backend->name(), e.what());
+            status = 1;
+        }
+        backend.reset();
+    }
+    curl_global_cleanup();
+    return status;
+}
@@ -0,0 +1,104 @@
+-- PostgreSQL FTS latency: expression index versus stored search_vector
+--
+-- Seeds 1M forum-post-shaped rows into a scratch schema and times the
+-- search query shape SearchService used before 013_search_vectors.sql
+-- (to_tsvector in both WHERE and ts_rank, served by an expression GIN
+-- index) against the current one (stored weighted tsvector with its own
+-- GIN index). Prints p50/p99 per query and variant.
+--
+--   psql -d pyracms_bench -f tests/bench/bench_search_fts.sql
+--
+-- Run against a throwaway database: seeding takes a few minutes and
+-- several GB of disk. Everything lives in schema bench_fts, which is
+-- dropped at the end.
+
+\set ON_ERROR_STOP on
+\timing off
+
+DROP SCHEMA IF EXISTS bench_fts CASCADE;
+CREATE SCHEMA bench_fts;
+SET search_path = bench_fts;
+
+-- Words are "w<n>" with n drawn log-uniformly from 1..5000, so rank
+-- frequency roughly follows Zipf's law: w1 is in most rows, w4000 in few.
+CREATE TABLE posts (
+    id SERIAL PRIMARY KEY,
+    title TEXT NOT NULL,
+    content TEXT NOT NULL
+);
+
+INSERT INTO posts (title, content)
+SELECT
+    (SELECT string_agg('w' || floor(exp(random() * ln(5000)))::int, ' ')
+     FROM generate_series(1, 6) WHERE g > 0),
+    (SELECT string_agg('w' || floor(exp(random() * ln(5000)))::int, ' ')
+     FROM generate_series(1, 80) WHERE g > 0)
+FROM generate_series(1, 1000000) g;
+
+-- Before: expression index, as in 009_creative_features.sql
+CREATE INDEX posts_expr_idx ON posts
+    USING GIN(to_tsvector('english', title || ' ' || content));
+
+-- After: stored weighted vector, as in 013_search_vectors.sql
+ALTER TABLE posts ADD COLUMN search_vector tsvector
+    GENERATED ALWAYS AS (
+        setweight(to_tsvector('english', title), 'A') ||
+        setweight(to_tsvector('english', content), 'B')
+    ) STORED;
+CREATE INDEX posts_vector_idx ON posts USING GIN(search_vector);
+
+VACUUM ANALYZE posts;
+
+CREATE TABLE timings (variant TEXT, query TEXT, micros DOUBLE PRECISION);
+
+DO $$
+DECLARE
+    queries TEXT[] := ARRAY['w2500', 'w300', 'w40', 'w7 & w900', 'w12:*'];
+    q TEXT;
+    started TIMESTAMPTZ;
+    ignored INTEGER;
+    iteration INTEGER;
+BEGIN
+    FOREACH q IN ARRAY queries LOOP
+        FOR iteration IN 1..60 LOOP
+            started := clock_timestamp();
+            SELECT count(*) INTO ignored FROM (
+                SELECT id, ts_rank(to_tsvector('english', title || ' ' || content),
+                                   to_tsquery('english', q)) AS rank
+                FROM posts
+                WHERE to_tsvector('english', title || ' ' || content) @@ to_tsquery('english', q)
+                ORDER BY rank DESC LIMIT 20
+            ) r;
+            -- The first rounds warm the cache and are not recorded
+            IF iteration > 10 THEN
+                INSERT INTO timings VALUES ('expression', q,
+                    extract(epoch FROM clock_timestamp() - started) * 1e6);
+            END IF;
+
+            started := clock_timestamp();
+            SELECT count(*) INTO ignored FROM (
+                SELECT id, ts_rank(search_vector, query) AS rank
+                FROM posts, to_tsquery('english', q) query
+                WHERE search_vector @@ query
+                ORDER BY rank DESC LIMIT 20
+            ) r;
+            IF iteration > 10 THEN
+                INSERT INTO timings VALUES ('search_vector', q,
+                    extract(epoch FROM clock_timestamp() - started) * 1e6);
+            END IF;
+        END LOOP;
+    END LOOP;
+END;
+$$;
+
+SELECT query,
+       variant,
+       (SELECT count(*) FROM posts WHERE search_vector @@ to_tsquery('english', t.query)) AS matches,
+       round((percentile_cont(0.5) WITHIN GROUP (ORDER BY micros) / 1000)::numeric, 2) AS p50_ms,
+       round((percentile_cont(0.99) WITHIN GROUP (ORDER BY micros) / 1000)::numeric, 2) AS p99_ms
+FROM timings t
+GROUP BY query, variant
+ORDER BY query, variant;
+
+RESET search_path;
+DROP SCHEMA bench_fts CASCADE;
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include "services/AutocompleteIndex.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+
+using namespace pyracms;
+
+namespace {
+
+AutocompleteEntry entry(const std::string &type, int id, const std::string &text, uint64_t weight) {
+    return {type, id, text, "/" + type + "/" + std::to_string(id), weight};
+}
+
+std::vector<std::string> texts(const std::vector<AutocompleteItem> &items) {
+    std::vector<std::string> out;
+    for (const auto &item : items) out.push_back(item.text);
+    return out;
+}
+
+} // namespace
+
+// ── Lookup ───────────────────────────────────────────────────────────────────
+
+TEST(AutocompleteIndexTest, MatchesPrefixIgnoringCase) {
+    AutocompleteIndex index;
+    index.upsert(1, entry("article", 1, "Drogon Framework", 5));
+    index.upsert(1, entry("article", 2, "drone racing", 3));
+    index.upsert(1, entry("article", 3, "Postgres tuning", 9));
+
+    EXPECT_EQ(texts(index.complete(1, "DRO", 10)),
+              (std::vector<std::string>{"Drogon Framework", "drone racing"}));
+    EXPECT_EQ(texts(index.complete(1, "drog", 10)), std::vector<std::string>{"Drogon Framework"});
+    EXPECT_TRUE(index.complete(1, "drx", 10).empty());
+    EXPECT_TRUE(index.complete(1, "drogon framework!", 10).empty());
+
+    auto items = index.complete(1, "post", 10);
+    ASSERT_EQ(items.size(), 1u);
+    EXPECT_EQ(items[0].type, "article");
+    EXPECT_EQ(items[0].url, "/article/3");
+}
+
+TEST(AutocompleteIndexTest, RanksByWeightAndHonoursLimit) {
+    AutocompleteIndex index;
+    index.upsert(1, entry("article", 1, "game a", 10));
+    index.upsert(1, entry("article", 2, "game b", 50));
+    index.upsert(1, entry("article", 3, "gamedev", 30));
+    index.upsert(1, entry("article", 4, "games", 40));
+    index.upsert(1, entry("article", 5, "game", 20));
+
+    EXPECT_EQ(texts(index.complete(1, "game", 3)),
+              (std::vector<std::string>{"game b", "games", "gamedev"}));
+    EXPECT_EQ(texts(index.complete(1, "", 2)), (std::vector<std::string>{"game b", "games"}));
+    EXPECT_TRUE(index.complete(1, "game", 0).empty());
+}
+
+TEST(AutocompleteIndexTest, TenantsAreIsolatedButShareTheSharedTenant) {
+    AutocompleteIndex index;
+    index.upsert(1, entry("article", 1, "alpha", 1));
+    index.upsert(2, entry("article", 2, "alps", 1));
+    index.upsert(AutocompleteIndex::kSharedTenant, entry("gamedep", 3, "alien swarm", 5));
+
+    EXPECT_EQ(texts(index.complete(1, "al", 10)),
+              (std::vector<std::string>{"alien swarm", "alpha"}));
+    EXPECT_EQ(texts(index.complete(2, "al", 10)),
+              (std::vector<std::string>{"alien swarm", "alps"}));
+    EXPECT_EQ(texts(index.complete(3, "al", 10)), std::vector<std::string>{"alien swarm"});
+}
+
+// ── Updates ──────────────────────────────────────────────────────────────────
+
+TEST(AutocompleteIndexTest, UpsertRenamesInPlace) {
+    AutocompleteIndex index;
+    index.upsert(1, entry("article", 1, "old title", 1));
+    index.upsert(1, entry("article", 1, "new title", 1));
+    EXPECT_TRUE(index.complete(1, "old", 10).empty());
+    EXPECT_EQ(texts(index.complete(1, "new", 10)), std::vector<std::string>{"new title"});
+    EXPECT_EQ(index.size(), 1u);
+
+    // Same text, different case: stays put but shows the new spelling
+    index.upsert(1, entry("article", 1, "New Title", 1));
+    EXPECT_EQ(texts(index.complete(1, "new", 10)), std::vector<std::string>{"New Title"});
+}
+
+TEST(AutocompleteIndexTest, SameTextDifferentDocumentsCoexist) {
+    AutocompleteIndex index;
+    index.upsert(1, entry("article", 1, "faq", 1));
+    index.upsert(1, entry("forum_post", 1, "faq", 2));
+    auto items = index.complete(1, "faq", 10);
+    ASSERT_EQ(items.size(), 2u);
+    EXPECT_EQ(items[0].type, "forum_post");
+    EXPECT_EQ(items[1].type, "article");
+}
+
+TEST(AutocompleteIndexTest, RemovePrunesAndLowersWeights) {
+    AutocompleteIndex index;
+    index.upsert(1, entry("article", 1, "cat", 100));
+    index.upsert(1, entry("article", 2, "car", 5));
+    index.upsert(1, entry("article", 3, "dog", 50));
+
+    EXPECT_EQ(texts(index.complete(1, "", 1)), std::vector<std::string>{"cat"});
+    EXPECT_TRUE(index.remove(1, "article", 1));
+    EXPECT_FALSE(index.remove(1, "article", 1));
+    EXPECT_FALSE(index.remove(9, "article", 1));
+    EXPECT_EQ(texts(index.complete(1, "", 1)), std::vector<std::string>{"dog"});
+    EXPECT_EQ(texts(index.complete(1, "ca", 10)), std::vector<std::string>{"car"});
+    EXPECT_EQ(index.size(), 2u);
+
+    // Freed slots and nodes are reused cleanly
+    index.upsert(1, entry("article", 4, "cattle", 7));
+    EXPECT_EQ(texts(index.complete(1, "ca", 10)), (std::vector<std::string>{"cattle", "car"}));
+}
+
+TEST(AutocompleteIndexTest, SetWeightReorders) {
+    AutocompleteIndex index;
+    index.upsert(1, entry("article", 1, "red", 10));
+    index.upsert(1, entry("article", 2, "rest", 20));
+    EXPECT_TRUE(index.setWeight(1, "article", 1, 30));
+    EXPECT_EQ(texts(index.complete(1, "re", 10)), (std::vector<std::string>{"red", "rest"}));
+    EXPECT_TRUE(index.setWeight(1, "article", 1, 1));
+    EXPECT_EQ(texts(index.complete(1, "re", 10)), (std::vector<std::string>{"rest", "red"}));
+    EXPECT_FALSE(index.setWeight(1, "article", 99, 1));
+}
+
+// Random inserts, renames, reweights and removals against a brute-force
+// model; results must match the model's top-N exactly.
+TEST(AutocompleteIndexTest, MatchesBruteForceUnderChurn) {
+    std::mt19937 rng(11);
+    const std::string alphabet = "abc";
+    auto randomText = [&] {
+        std::string s;
+        int len = 1 + static_cast<int>(rng() % 6);
+        for (int i = 0; i < len; ++i) s += alphabet[rng() % alphabet.size()];
+        return s;
+    };
+
+    AutocompleteIndex index;
+    std::map<int, AutocompleteEntry> model;
+    for (int step = 0; step < 4000; ++step) {
+        int id = static_cast<int>(rng() % 200);
+        switch (rng() % 4) {
+        case 0:
+        case 1: {
+            auto e = entry("article", id, randomText(), rng() % 1000);
+            model[id] = e;
+            index.upsert(1, e);
+            break;
+        }
+        case 2:
+            EXPECT_EQ(index.remove(1, "article", id), model.erase(id) == 1);
+            break;
+        default: {
+            uint64_t w = rng() % 1000;
+            auto it = model.find(id);
+            if (it != model.end()) it->second.weight = w;
+            EXPECT_EQ(index.setWeight(1, "article", id, w), it != model.end());
+        }
+        }
+
+        if (step % 50 != 0) continue;
+        ASSERT_EQ(index.size(), model.size());
+        for (const std::string prefix : {"", "a", "ab", "cab", "bbb"}) {
+            std::vector<const AutocompleteEntry *> expected;
+            for (const auto &[_, e] : model) {
+                if (e.text.compare(0, prefix.size(), prefix) == 0) expected.push_back(&e);
+            }
+            std::stable_sort(expected.begin(), expected.end(),
+                             [](const auto *a, const auto *b) { return a->weight > b->weight; });
+            auto got = index.complete(1, prefix, 8);
+            ASSERT_EQ(got.size(), std::min<size_t>(8, expected.size())) << prefix;
+            for (size_t i = 0; i < got.size(); ++i) {
+                // Ties may come back in any order; weights must not
+                auto it = std::find_if(model.begin(), model.end(), [&](const auto &kv) {
+                    return kv.second.url == got[i].url;
+                });
+                ASSERT_NE(it, model.end());
+                EXPECT_EQ(it->second.weight, expected[i]->weight) << prefix << " #" << i;
+                EXPECT_EQ(it->second.text.compare(0, prefix.size(), prefix), 0);
+            }
+        }
+    }
+}
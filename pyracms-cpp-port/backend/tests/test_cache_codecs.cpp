@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "services/CacheCodecs.h"
+
+#include <limits>
+
+using namespace pyracms;
+
+namespace {
+
+SearchResults sampleResults() {
+    SearchResults results;
+    results.query = "drogon tutorial";
+    results.totalCount = 2;
+    results.items.push_back({"article", 12, "Getting started", "getting-started",
+                             "/articles/getting-started", 0.75, "2024-01-02 03:04:05",
+                             "getting-<mark>started</mark>"});
+    results.items.push_back({"forum_post", -3, "", std::string("bin\0ary", 7),
+                             "/forum/thread/9", -1.5e-9, "", ""});
+    results.facets["article"] = 1;
+    results.facets["forum_post"] = 1;
+    results.nextCursor = "AQID";
+    results.suggestion = "drogon tutorial";
+    return results;
+}
+
+} // namespace
+
+// ── Primitives ───────────────────────────────────────────────────────────────
+
+TEST(BinaryCodecTest, VarintRoundTripAtBoundaries) {
+    std::string buf;
+    BinaryWriter w(buf);
+    const uint64_t values[] = {0, 127, 128, 16383, 16384, std::numeric_limits<uint64_t>::max()};
+    for (auto v : values) w.varint(v);
+
+    BinaryReader r(buf);
+    for (auto v : values) EXPECT_EQ(r.varint(), v);
+    EXPECT_TRUE(r.ok());
+    EXPECT_TRUE(r.atEnd());
+}
+
+TEST(BinaryCodecTest, SignedIntegersUseZigzag) {
+    std::string buf;
+    BinaryWriter w(buf);
+    w.i64(-1);
+    EXPECT_EQ(buf.size(), 1u);
+    w.i64(std::numeric_limits<int64_t>::min());
+    w.i64(std::numeric_limits<int64_t>::max());
+
+    BinaryReader r(buf);
+    EXPECT_EQ(r.i64(), -1);
+    EXPECT_EQ(r.i64(), std::numeric_limits<int64_t>::min());
+    EXPECT_EQ(r.i64(), std::numeric_limits<int64_t>::max());
+}
+
+TEST(BinaryCodecTest, ReadPastEndFailsSticky) {
+    BinaryReader r(std::string_view("\x05" "ab", 3));
+    EXPECT_TRUE(r.str().empty());
+    EXPECT_FALSE(r.ok());
+    EXPECT_EQ(r.u8(), 0);
+    EXPECT_FALSE(r.ok());
+}
+
+// ── DTO round trips ──────────────────────────────────────────────────────────
+
+TEST(CacheCodecsTest, SearchResultsRoundTrip) {
+    auto original = sampleResults();
+    SearchResults decoded;
+    ASSERT_TRUE(decodeBinary(encodeBinary(original), decoded));
+
+    EXPECT_EQ(decoded.query, original.query);
+    EXPECT_EQ(decoded.totalCount, original.totalCount);
+    ASSERT_EQ(decoded.items.size(), 2u);
+    EXPECT_EQ(decoded.items[0].title, "Getting started");
+    EXPECT_DOUBLE_EQ(decoded.items[0].rank, 0.75);
+    EXPECT_EQ(decoded.items[0].highlight, "getting-<mark>started</mark>");
+    EXPECT_EQ(decoded.items[1].id, -3);
+    EXPECT_EQ(decoded.items[1].snippet, std::string("bin\0ary", 7));
+    EXPECT_DOUBLE_EQ(decoded.items[1].rank, -1.5e-9);
+    EXPECT_EQ(decoded.facets, original.facets);
+    EXPECT_EQ(decoded.nextCursor, "AQID");
+    EXPECT_EQ(decoded.suggestion, "drogon tutorial");
+}
+
+TEST(CacheCodecsTest, AutocompleteListRoundTrip) {
+    std::vector<AutocompleteItem> items = {{"Drogon", "article", "/articles/drogon"},
+                                           {"Dragons", "gamedep", "/gamedep/dragons"}};
+    std::vector<AutocompleteItem> decoded;
+    ASSERT_TRUE(decodeBinary(encodeBinary(items), decoded));
+    ASSERT_EQ(decoded.size(), 2u);
+    EXPECT_EQ(decoded[1].url, "/gamedep/dragons");
+}
+
+TEST(CacheCodecsTest, ArticleListRoundTrip) {
+    ArticleDto a{1, "home", "Home", false, true, 7, "markdown", 42,
+                 "2024-01-01", "published", "2024-01-01", ""};
+    std::vector<ArticleDto> decoded;
+    ASSERT_TRUE(decodeBinary(encodeBinary(std::vector<ArticleDto>{a, a}), decoded));
+    ASSERT_EQ(decoded.size(), 2u);
+    EXPECT_EQ(decoded[0].name, "home");
+    EXPECT_TRUE(decoded[0].hideDisplayName);
+    EXPECT_FALSE(decoded[0].isPrivate);
+    EXPECT_EQ(decoded[1].viewCount, 42);
+}
+
+TEST(CacheCodecsTest, EmptyListRoundTrip) {
+    std::vector<AutocompleteItem> decoded{{"stale", "", ""}};
+    ASSERT_TRUE(decodeBinary(encodeBinary(std::vector<AutocompleteItem>{}), decoded));
+    EXPECT_TRUE(decoded.empty());
+}
+
+// ── Rejection ────────────────────────────────────────────────────────────────
+
+TEST(CacheCodecsTest, RejectsLegacyJson) {
+    SearchResults decoded;
+    EXPECT_FALSE(decodeBinary(R"({"query":"x","totalCount":0})", decoded));
+}
+
+TEST(CacheCodecsTest, RejectsOtherType) {
+    std::vector<AutocompleteItem> decoded;
+    EXPECT_FALSE(decodeBinary(encodeBinary(sampleResults()), decoded));
+}
+
+TEST(CacheCodecsTest, RejectsOtherVersion) {
+    auto wire = encodeBinary(sampleResults());
+    wire[2] = static_cast<char>(BinaryCodec<SearchResults>::kVersion + 1);
+    SearchResults decoded;
+    EXPECT_FALSE(decodeBinary(wire, decoded));
+}
+
+TEST(CacheCodecsTest, RejectsTruncatedAndTrailingBytes) {
+    auto wire = encodeBinary(sampleResults());
+    SearchResults decoded;
+    for (size_t len = 0; len < wire.size(); ++len) {
+        EXPECT_FALSE(decodeBinary(std::string_view(wire.data(), len), decoded)) << len;
+    }
+    EXPECT_FALSE(decodeBinary(wire + "x", decoded));
+}
+
+TEST(CacheCodecsTest, RejectsHugeCountWithoutAllocating) {
+    std::string wire;
+    BinaryWriter w(wire);
+    w.u8(kBinaryCodecMagic);
+    w.u8(BinaryCodec<std::vector<AutocompleteItem>>::kTag);
+    w.u8(BinaryCodec<std::vector<AutocompleteItem>>::kVersion);
+    w.varint(uint64_t(1) << 60);
+    std::vector<AutocompleteItem> decoded;
+    EXPECT_FALSE(decodeBinary(wire, decoded));
+}
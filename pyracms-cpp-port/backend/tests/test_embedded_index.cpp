@@ -0,0 +1,258 @@
+#include <gtest/gtest.h>
+#include "services/EmbeddedIndex.h"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <unistd.h>
+
+using namespace pyracms;
+
+namespace {
+
+IndexedDocument article(int id, const std::string &title, const std::string &content) {
+    return IndexedDocument{"article", id, title, content, "/articles/a" + std::to_string(id),
+                           "2024-01-01"};
+}
+
+std::string tempPath(const std::string &name) {
+    return "/tmp/pyracms_" + name + "_" + std::to_string(getpid()) + ".idx";
+}
+
+std::vector<int> ids(const SearchResults &results) {
+    std::vector<int> out;
+    for (const auto &item : results.items) out.push_back(item.id);
+    return out;
+}
+
+} // namespace
+
+// ── Tokenizer ────────────────────────────────────────────────────────────────
+
+TEST(EmbeddedIndexTest, TokenizeLowercasesAndSplits) {
+    auto tokens = EmbeddedIndex::tokenize("Hello, World! C++17 isn't-bad");
+    std::vector<std::string> expected = {"hello", "world", "c", "17", "isn", "t", "bad"};
+    EXPECT_EQ(tokens, expected);
+}
+
+TEST(EmbeddedIndexTest, TokenizeKeepsUtf8InsideTokens) {
+    auto tokens = EmbeddedIndex::tokenize("caf\xc3\xa9 au lait");
+    ASSERT_EQ(tokens.size(), 3u);
+    EXPECT_EQ(tokens[0], "caf\xc3\xa9");
+}
+
+// ── PostingList ──────────────────────────────────────────────────────────────
+
+TEST(PostingListTest, CursorWalksAndSeeksAcrossBlocks) {
+    PostingList list;
+    for (uint32_t doc = 0; doc < 1000; doc += 3) list.append(doc, doc % 7 + 1, 10);
+    EXPECT_EQ(list.size(), 334u);
+
+    PostingList::Cursor walk(list);
+    uint32_t expected = 0;
+    for (; !walk.done(); walk.next(), expected += 3) {
+        ASSERT_EQ(walk.doc(), expected);
+        ASSERT_EQ(walk.tf(), expected % 7 + 1);
+    }
+    EXPECT_EQ(expected, 1002u);
+
+    PostingList::Cursor seek(list);
+    seek.seek(500); // between postings, several blocks ahead
+    ASSERT_FALSE(seek.done());
+    EXPECT_EQ(seek.doc(), 501u);
+    seek.seek(501); // no-op
+    EXPECT_EQ(seek.doc(), 501u);
+    seek.seek(5000);
+    EXPECT_TRUE(seek.done());
+}
+
+TEST(PostingListTest, GapsCompressBelowRawSize) {
+    PostingList list;
+    for (uint32_t doc = 0; doc < 10000; ++doc) list.append(doc, 1, 10);
+    EXPECT_LT(list.bytes(), 10000u * 8 / 3);
+}
+
+// ── Search ───────────────────────────────────────────────────────────────────
+
+TEST(EmbeddedIndexTest, TitleMatchesOutrankBodyMatches) {
+    EmbeddedIndex index;
+    index.upsert(1, article(1, "Cooking basics", "how to use a compiler for dinner"));
+    index.upsert(1, article(2, "Compiler internals", "parsing and code generation"));
+    auto results = index.search(1, "compiler", "", 10, 0);
+    EXPECT_EQ(ids(results), (std::vector<int>{2, 1}));
+    EXPECT_EQ(results.totalCount, 2);
+    EXPECT_EQ(results.facets["article"], 2);
+}
+
+TEST(EmbeddedIndexTest, TenantsAreIsolated) {
+    EmbeddedIndex index;
+    index.upsert(1, article(1, "drogon", ""));
+    index.upsert(2, article(2, "drogon", ""));
+    EXPECT_EQ(ids(index.search(1, "drogon", "", 10, 0)), std::vector<int>{1});
+    EXPECT_TRUE(index.search(3, "drogon", "", 10, 0).items.empty());
+}
+
+TEST(EmbeddedIndexTest, TypeFilterAndFacets) {
+    EmbeddedIndex index;
+    index.upsert(1, article(1, "redis cache", ""));
+    index.upsert(1, IndexedDocument{"snippet", 7, "redis client", "", "/snippets/7", ""});
+    auto all = index.search(1, "redis", "all", 10, 0);
+    EXPECT_EQ(all.items.size(), 2u);
+    EXPECT_EQ(all.facets["snippet"], 1);
+    auto snippets = index.search(1, "redis", "snippet", 10, 0);
+    ASSERT_EQ(snippets.items.size(), 1u);
+    EXPECT_EQ(snippets.items[0].type, "snippet");
+    EXPECT_EQ(snippets.totalCount, 1);
+}
+
+TEST(EmbeddedIndexTest, UnknownWordsExpandAsPrefixes) {
+    EmbeddedIndex index;
+    index.upsert(1, article(1, "Elasticsearch tuning", ""));
+    EXPECT_EQ(ids(index.search(1, "elastic", "", 10, 0)), std::vector<int>{1});
+}
+
+TEST(EmbeddedIndexTest, UpsertReplacesAndRemoveDeletes) {
+    EmbeddedIndex index;
+    EXPECT_TRUE(index.upsert(1, article(1, "old title", "")));
+    EXPECT_FALSE(index.upsert(1, article(1, "old title", "")));
+    EXPECT_TRUE(index.upsert(1, article(1, "new title", "")));
+    EXPECT_TRUE(index.search(1, "old", "", 10, 0).items.empty());
+    EXPECT_EQ(ids(index.search(1, "new", "", 10, 0)), std::vector<int>{1});
+    EXPECT_EQ(index.stats().documents, 1u);
+
+    EXPECT_TRUE(index.remove("article", 1));
+    EXPECT_TRUE(index.search(1, "new", "", 10, 0).items.empty());
+    EXPECT_FALSE(index.remove("article", 1));
+}
+
+TEST(EmbeddedIndexTest, RetainOnlyDropsDocumentsMissingFromTheDatabase) {
+    EmbeddedIndex index;
+    for (int id = 1; id <= 4; ++id) index.upsert(1, article(id, "shared", ""));
+    EXPECT_EQ(index.retainOnly(1, "article", {2, 4}), 2u);
+    EXPECT_EQ(ids(index.search(1, "shared", "", 10, 0)), (std::vector<int>{2, 4}));
+}
+
+TEST(EmbeddedIndexTest, CompactionKeepsLiveDocuments) {
+    EmbeddedIndex index;
+    for (int round = 0; round < 5; ++round) {
+        for (int id = 0; id < 50; ++id) {
+            index.upsert(1, article(id, "doc " + std::to_string(id), "round " + std::to_string(round)));
+        }
+    }
+    auto stats = index.stats();
+    EXPECT_EQ(stats.documents, 50u);
+    EXPECT_LE(stats.tombstones, 64u);
+    EXPECT_EQ(index.search(1, "round", "", 100, 0).items.size(), 50u);
+    // "0" only survives in the title of doc 0; earlier rounds' bodies are gone
+    EXPECT_EQ(ids(index.search(1, "0", "", 100, 0)), std::vector<int>{0});
+}
+
+TEST(EmbeddedIndexTest, WandMatchesExhaustiveRanking) {
+    EmbeddedIndex index;
+    std::mt19937 rng(42);
+    std::vector<std::string> vocab;
+    for (int i = 0; i < 200; ++i) vocab.push_back("w" + std::to_string(i));
+    // Zipf-ish: low word ids are far more common
+    std::vector<double> weights;
+    for (int i = 1; i <= 200; ++i) weights.push_back(1.0 / i);
+    std::discrete_distribution<int> word(weights.begin(), weights.end());
+    for (int id = 0; id < 3000; ++id) {
+        std::string title, body;
+        for (int i = 0; i < 3; ++i) title += vocab[word(rng)] + " ";
+        for (int i = 0; i < 30; ++i) body += vocab[word(rng)] + " ";
+        index.upsert(1, article(id, title, body));
+    }
+    for (const char *query : {"w0 w57", "w3 w120 w199", "w1", "w150 w151 w2"}) {
+        auto top = index.search(1, query, "", 10, 0);
+        auto all = index.search(1, query, "", 3000, 0);
+        ASSERT_GE(all.items.size(), top.items.size());
+        for (size_t i = 0; i < top.items.size(); ++i) {
+            EXPECT_EQ(top.items[i].id, all.items[i].id) << query << " rank " << i;
+            EXPECT_DOUBLE_EQ(top.items[i].rank, all.items[i].rank);
+        }
+        auto page = index.search(1, query, "", 5, 5);
+        for (size_t i = 0; i < page.items.size(); ++i) {
+            EXPECT_EQ(page.items[i].id, all.items[i + 5].id) << query;
+        }
+    }
+}
+
+// ── Snapshots ────────────────────────────────────────────────────────────────
+
+TEST(EmbeddedIndexTest, SnippetsShowTheBestMatchingWindow) {
+    EmbeddedIndex index;
+    std::string body;
+    for (int i = 0; i < 2000; ++i) body += "filler words here ";
+    body += "the Drogon framework & its <loop> ";
+    for (int i = 0; i < 50; ++i) body += "tail words ";
+    index.upsert(1, article(1, "Guide", body));
+
+    auto results = index.search(1, "drogon loop", "", 10, 0);
+    ASSERT_EQ(results.items.size(), 1u);
+    const auto &item = results.items[0];
+    EXPECT_LE(item.snippet.size(), 200u + 6);
+    EXPECT_NE(item.snippet.find("Drogon framework & its <loop>"), std::string::npos);
+    EXPECT_NE(item.highlight.find("<mark>Drogon</mark> framework &amp; its &lt;<mark>loop</mark>&gt;"),
+              std::string::npos);
+    EXPECT_EQ(item.snippet.rfind("...", 0), 0u);
+
+    // Title-only matches fall back to the start of the body
+    auto title = index.search(1, "guide", "", 10, 0).items[0];
+    EXPECT_EQ(title.snippet.rfind("filler words", 0), 0u);
+    EXPECT_EQ(title.highlight.find("<mark>"), std::string::npos);
+}
+
+TEST(EmbeddedIndexTest, SnippetsSurviveCompaction) {
+    EmbeddedIndex index;
+    index.upsert(1, article(1, "first", "alpha beta gamma"));
+    // The 64th replacement compacts the tenant
+    for (int round = 0; round <= 64; ++round) {
+        index.upsert(1, article(2, "churn", "round " + std::to_string(round)));
+    }
+    EXPECT_EQ(index.stats().tombstones, 0u);
+    EXPECT_EQ(index.search(1, "gamma", "", 10, 0).items[0].highlight,
+              "alpha beta <mark>gamma</mark>");
+}
+
+TEST(EmbeddedIndexTest, SnapshotRoundTrip) {
+    auto path = tempPath("roundtrip");
+    EmbeddedIndex index;
+    for (int id = 0; id < 300; ++id) {
+        index.upsert(id % 3, article(id, "title " + std::to_string(id % 10), "shared body text"));
+    }
+    index.remove(0, "article", 3);
+    ASSERT_TRUE(index.save(path));
+
+    EmbeddedIndex restored;
+    ASSERT_TRUE(restored.load(path));
+    EXPECT_EQ(restored.tenants(), (std::vector<int>{0, 1, 2}));
+    EXPECT_EQ(restored.stats().documents, index.stats().documents);
+    for (int tenant = 0; tenant < 3; ++tenant) {
+        EXPECT_EQ(ids(restored.search(tenant, "title 3 body", "", 20, 0)),
+                  ids(index.search(tenant, "title 3 body", "", 20, 0)));
+    }
+    EXPECT_EQ(restored.search(1, "body", "", 1, 0).items[0].highlight,
+              index.search(1, "body", "", 1, 0).items[0].highlight);
+    // Still writable after loading
+    restored.upsert(1, article(1000, "fresh", ""));
+    EXPECT_EQ(ids(restored.search(1, "fresh", "", 10, 0)), std::vector<int>{1000});
+    std::remove(path.c_str());
+}
+
+TEST(EmbeddedIndexTest, CorruptSnapshotIsRejected) {
+    auto path = tempPath("corrupt");
+    EmbeddedIndex index;
+    index.upsert(1, article(1, "kept", "body"));
+    ASSERT_TRUE(index.save(path));
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(-3, std::ios::end);
+        f.put('\xff');
+    }
+    EmbeddedIndex target;
+    target.upsert(5, article(9, "existing", ""));
+    EXPECT_FALSE(target.load(path));
+    EXPECT_EQ(ids(target.search(5, "existing", "", 10, 0)), std::vector<int>{9});
+    EXPECT_FALSE(target.load(path + ".missing"));
+    std::remove(path.c_str());
+}
@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include "services/ElasticsearchBulkQueue.h"
+
+using namespace pyracms;
+
+namespace {
+
+BulkOp indexOp(int id, const std::string &source = "{\"title\":\"t\"}") {
+    BulkOp op;
+    op.index = "pyracms_articles";
+    op.id = std::to_string(id);
+    op.source = source;
+    return op;
+}
+
+BulkOp deleteOp(int id) {
+    BulkOp op;
+    op.action = BulkOp::Action::Delete;
+    op.index = "pyracms_articles";
+    op.id = std::to_string(id);
+    return op;
+}
+
+std::vector<std::string> ids(const std::vector<BulkOp> &batch) {
+    std::vector<std::string> out;
+    for (const auto &op : batch) out.push_back(op.id);
+    return out;
+}
+
+} // namespace
+
+// ── Encoding ─────────────────────────────────────────────────────────────────
+
+TEST(ElasticsearchBulkQueueTest, EncodesNdjson) {
+    auto create = indexOp(3, "{\"b\":2}");
+    create.action = BulkOp::Action::Create;
+    auto body = ElasticsearchBulkQueue::encode({indexOp(1, "{\"a\":1}"), deleteOp(2), create});
+    EXPECT_EQ(body,
+              "{\"index\":{\"_index\":\"pyracms_articles\",\"_id\":\"1\"}}\n"
+              "{\"a\":1}\n"
+              "{\"delete\":{\"_index\":\"pyracms_articles\",\"_id\":\"2\"}}\n"
+              "{\"create\":{\"_index\":\"pyracms_articles\",\"_id\":\"3\"}}\n"
+              "{\"b\":2}\n");
+}
+
+TEST(ElasticsearchBulkQueueTest, ItemSuccessDependsOnAction) {
+    auto create = indexOp(1);
+    create.action = BulkOp::Action::Create;
+    EXPECT_TRUE(ElasticsearchBulkQueue::succeeded(indexOp(1), 201));
+    EXPECT_FALSE(ElasticsearchBulkQueue::succeeded(indexOp(1), 409));
+    EXPECT_TRUE(ElasticsearchBulkQueue::succeeded(create, 409));
+    EXPECT_FALSE(ElasticsearchBulkQueue::succeeded(create, 404));
+    EXPECT_TRUE(ElasticsearchBulkQueue::succeeded(deleteOp(1), 404));
+}
+
+// ── Queueing ─────────────────────────────────────────────────────────────────
+
+TEST(ElasticsearchBulkQueueTest, CoalescesOperationsOnTheSameDocument) {
+    ElasticsearchBulkQueue queue(10, 3);
+    EXPECT_TRUE(queue.tryPush(indexOp(1, "{\"v\":1}")));
+    EXPECT_TRUE(queue.tryPush(indexOp(2)));
+    EXPECT_TRUE(queue.tryPush(indexOp(1, "{\"v\":2}")));
+    EXPECT_EQ(queue.size(), 2u);
+
+    auto batch = queue.takeBatch(10, 1 << 20);
+    ASSERT_EQ(batch.size(), 2u);
+    EXPECT_EQ(batch[0].source, "{\"v\":2}");
+    EXPECT_EQ(queue.stats().coalesced, 1u);
+}
+
+TEST(ElasticsearchBulkQueueTest, RejectsWhenFullButStillCoalesces) {
+    ElasticsearchBulkQueue queue(2, 3);
+    EXPECT_TRUE(queue.tryPush(indexOp(1)));
+    EXPECT_TRUE(queue.tryPush(indexOp(2)));
+    EXPECT_FALSE(queue.tryPush(indexOp(3)));
+    EXPECT_TRUE(queue.tryPush(deleteOp(2)));
+    EXPECT_EQ(queue.stats().rejected, 1u);
+}
+
+TEST(ElasticsearchBulkQueueTest, BatchesByCountAndBytes) {
+    ElasticsearchBulkQueue queue(100, 3);
+    for (int i = 0; i < 10; ++i) queue.tryPush(indexOp(i, std::string(100, 'x')));
+
+    EXPECT_EQ(queue.takeBatch(4, 1 << 20).size(), 4u);
+    // Roughly 150 bytes per op with overhead
+    EXPECT_EQ(queue.takeBatch(100, 400).size(), 2u);
+    // An op larger than the byte budget still goes out alone
+    EXPECT_EQ(queue.takeBatch(100, 1).size(), 1u);
+    EXPECT_EQ(queue.size(), 3u);
+}
+
+TEST(ElasticsearchBulkQueueTest, HoldsBackDocumentsInFlight) {
+    ElasticsearchBulkQueue queue(10, 3);
+    queue.tryPush(indexOp(1, "{\"v\":1}"));
+    auto first = queue.takeBatch(10, 1 << 20);
+    queue.tryPush(indexOp(1, "{\"v\":2}"));
+    queue.tryPush(indexOp(2));
+
+    // Document 1 waits for its earlier batch
+    EXPECT_EQ(ids(queue.takeBatch(10, 1 << 20)), std::vector<std::string>{"2"});
+    queue.complete(std::move(first), {200});
+    auto next = queue.takeBatch(10, 1 << 20);
+    ASSERT_EQ(next.size(), 1u);
+    EXPECT_EQ(next[0].source, "{\"v\":2}");
+}
+
+// ── Completion and retry ─────────────────────────────────────────────────────
+
+TEST(ElasticsearchBulkQueueTest, RetriesTransientFailuresAtTheFront) {
+    ElasticsearchBulkQueue queue(10, 3);
+    for (int i = 1; i <= 4; ++i) queue.tryPush(indexOp(i));
+    auto batch = queue.takeBatch(3, 1 << 20);
+    queue.tryPush(indexOp(5));
+
+    auto outcome = queue.complete(std::move(batch), {201, 429, 503});
+    EXPECT_EQ(outcome.succeeded, 1u);
+    EXPECT_EQ(outcome.retried, 2u);
+    auto retry = queue.takeBatch(10, 1 << 20);
+    EXPECT_EQ(ids(retry), (std::vector<std::string>{"2", "3", "4", "5"}));
+    EXPECT_EQ(retry[0].attempts, 1);
+    EXPECT_EQ(retry[2].attempts, 0);
+}
+
+TEST(ElasticsearchBulkQueueTest, DropsPermanentFailuresAndExhaustedRetries) {
+    ElasticsearchBulkQueue queue(10, 2);
+    queue.tryPush(indexOp(1));
+    queue.tryPush(indexOp(2));
+    queue.tryPush(deleteOp(3));
+
+    // Mapping error: never retried. Missing document on delete: fine.
+    auto outcome = queue.complete(queue.takeBatch(10, 1 << 20), {400, 500, 404});
+    EXPECT_EQ(outcome.dropped, 1u);
+    EXPECT_EQ(outcome.retried, 1u);
+    EXPECT_EQ(outcome.succeeded, 1u);
+
+    // Whole-request failure on the last attempt
+    outcome = queue.complete(queue.takeBatch(10, 1 << 20), {});
+    EXPECT_EQ(outcome.dropped, 1u);
+    EXPECT_EQ(queue.size(), 0u);
+    EXPECT_EQ(queue.stats().dropped, 2u);
+}
+
+TEST(ElasticsearchBulkQueueTest, NewerOperationSupersedesRetry) {
+    ElasticsearchBulkQueue queue(10, 5);
+    queue.tryPush(indexOp(1, "{\"v\":1}"));
+    auto batch = queue.takeBatch(10, 1 << 20);
+    queue.tryPush(indexOp(1, "{\"v\":2}"));
+    queue.complete(std::move(batch), {503});
+
+    auto next = queue.takeBatch(10, 1 << 20);
+    ASSERT_EQ(next.size(), 1u);
+    EXPECT_EQ(next[0].source, "{\"v\":2}");
+}
+
+// ── Backpressure ─────────────────────────────────────────────────────────────
+
+TEST(ElasticsearchBulkQueueTest, WhenRoomResumesAsBatchesDrain) {
+    ElasticsearchBulkQueue queue(4, 3);
+    int resumed = 0;
+    queue.whenRoom(2, [&] { ++resumed; });
+    EXPECT_EQ(resumed, 1);
+
+    for (int i = 0; i < 4; ++i) queue.tryPush(indexOp(i));
+    queue.whenRoom(3, [&] { ++resumed; });
+    queue.whenRoom(1, [&] { ++resumed; }); // queued behind the first waiter
+    EXPECT_EQ(resumed, 1);
+
+    queue.takeBatch(1, 1 << 20);
+    EXPECT_EQ(resumed, 1);
+    queue.takeBatch(2, 1 << 20);
+    EXPECT_EQ(resumed, 2); // 1 queued + 3 fits; 1 more would not
+    queue.takeBatch(1, 1 << 20);
+    EXPECT_EQ(resumed, 3);
+}
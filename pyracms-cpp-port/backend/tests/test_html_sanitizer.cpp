@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "services/ArticleRenderer.h"
+#include "services/HtmlSanitizer.h"
+
+#include <string>
+
+using namespace pyracms;
+
+namespace {
+
+std::string clean(const std::string &html) { return HtmlSanitizer::sanitize(html); }
+
+} // namespace
+
+// ── HtmlSanitizer ────────────────────────────────────────────────────────────
+
+TEST(HtmlSanitizerTest, KeepsAllowedMarkup) {
+    const std::string html =
+        "<h2>Title</h2>\n<p>Some <em>text</em> with <code>code</code>.</p>\n"
+        "<ul>\n<li>one</li>\n</ul>\n<pre><code class=\"language-cpp\">int x;\n</code></pre>\n"
+        "<hr />\n<img src=\"/a.png\" alt=\"a\" />";
+    EXPECT_EQ(clean(html), html);
+}
+
+TEST(HtmlSanitizerTest, DropsScriptsWithTheirContent) {
+    EXPECT_EQ(clean("a<script>alert(1)</script>b"), "ab");
+    EXPECT_EQ(clean("a<SCRIPT type=x>alert('</p>')</SCRIPT >b"), "ab");
+    EXPECT_EQ(clean("a<style>p{}</style><iframe src=x></iframe>b"), "ab");
+    EXPECT_EQ(clean("a<script>never closed"), "a");
+    EXPECT_EQ(clean("<svg><script>alert(1)</script></svg>ok"), "ok");
+}
+
+TEST(HtmlSanitizerTest, DropsUnknownTagsButKeepsText) {
+    EXPECT_EQ(clean("<form><input value=x>name</form>"), "name");
+    EXPECT_EQ(clean("<font color=red>red</font>"), "red");
+    EXPECT_EQ(clean("a<!-- hidden -->b<!DOCTYPE html><?php x ?>c"), "abc");
+}
+
+TEST(HtmlSanitizerTest, DropsEventHandlersAndUnknownAttributes) {
+    EXPECT_EQ(clean("<p onclick=\"x()\" style=\"color:red\" id=a>t</p>"), "<p>t</p>");
+    EXPECT_EQ(clean("<img src=/a.png onerror=alert(1)>"), "<img src=\"/a.png\" />");
+    EXPECT_EQ(clean("<code class=\"x\">a</code>"), "<code>a</code>");
+    EXPECT_EQ(clean("<td colspan=\"2\" rowspan=\"x\">a</td>"), "<td colspan=\"2\">a</td>");
+}
+
+TEST(HtmlSanitizerTest, RejectsScriptUrls) {
+    EXPECT_EQ(clean("<a href=\"javascript:alert(1)\">x</a>"),
+              "<a rel=\"nofollow noopener\">x</a>");
+    EXPECT_EQ(clean("<a href=\"JaVaScRiPt:alert(1)\">x</a>"),
+              "<a rel=\"nofollow noopener\">x</a>");
+    EXPECT_EQ(clean("<a href=\"java&#x09;script:alert(1)\">x</a>"),
+              "<a rel=\"nofollow noopener\">x</a>");
+    EXPECT_EQ(clean("<a href=\"&#106;avascript:alert(1)\">x</a>"),
+              "<a rel=\"nofollow noopener\">x</a>");
+    EXPECT_EQ(clean("<a href=\"javascript&colon;alert(1)\">x</a>"),
+              "<a rel=\"nofollow noopener\">x</a>");
+    EXPECT_EQ(clean("<img src=\"data:image/svg+xml,<svg>\">"), "<img />");
+    // Re-encoded entities stay text rather than becoming live again
+    EXPECT_EQ(clean("<a href=\"&amp;#106;avascript:x\">x</a>"),
+              "<a href=\"&amp;#106;avascript:x\" rel=\"nofollow noopener\">x</a>");
+}
+
+TEST(HtmlSanitizerTest, AllowsWebAndRelativeUrls) {
+    EXPECT_TRUE(HtmlSanitizer::isSafeUrl("https://example.com/a?b=c"));
+    EXPECT_TRUE(HtmlSanitizer::isSafeUrl("HTTP://example.com"));
+    EXPECT_TRUE(HtmlSanitizer::isSafeUrl("mailto:a@example.com"));
+    EXPECT_TRUE(HtmlSanitizer::isSafeUrl("/articles/x"));
+    EXPECT_TRUE(HtmlSanitizer::isSafeUrl("#top"));
+    EXPECT_TRUE(HtmlSanitizer::isSafeUrl("page?q=a:b"));
+    EXPECT_FALSE(HtmlSanitizer::isSafeUrl("vbscript:x"));
+    EXPECT_FALSE(HtmlSanitizer::isSafeUrl(" \x01javascript:x"));
+}
+
+TEST(HtmlSanitizerTest, BalancesTags) {
+    EXPECT_EQ(clean("<p><em>open"), "<p><em>open</em></p>");
+    EXPECT_EQ(clean("<p>a</em>b</p>"), "<p>ab</p>");
+    EXPECT_EQ(clean("<div><p>a</div>b"), "<div><p>a</p></div>b");
+    EXPECT_EQ(clean("<br><hr/>"), "<br /><hr />");
+}
+
+TEST(HtmlSanitizerTest, EscapesStrayMarkupCharacters) {
+    EXPECT_EQ(clean("1 < 2 > 0 & AT&T &amp; &#169;"), "1 &lt; 2 &gt; 0 &amp; AT&amp;T &amp; &#169;");
+    EXPECT_EQ(clean("<a href=\"x\"title=y"), "&lt;a href=\"x\"title=y");
+    EXPECT_EQ(clean("<p title='a\"b'>t</p>"), "<p>t</p>");
+    EXPECT_EQ(clean("<abbr title='a\"b<'>t</abbr>"), "<abbr title=\"a&quot;b&lt;\">t</abbr>");
+}
+
+TEST(HtmlSanitizerTest, DecodesEntities) {
+    EXPECT_EQ(HtmlSanitizer::decodeEntities("&lt;a&gt; &amp; &#65;&#x42; &eacute; &#0;"),
+              "<a> & AB &eacute; \xEF\xBF\xBD");
+}
+
+// ── ArticleRenderer ──────────────────────────────────────────────────────────
+
+TEST(ArticleRendererTest, NormalizesRendererNames) {
+    EXPECT_EQ(ArticleRenderer::normalize("Markdown"), "markdown");
+    EXPECT_EQ(ArticleRenderer::normalize("HTML"), "html");
+    EXPECT_EQ(ArticleRenderer::normalize(""), "markdown");
+}
+
+TEST(ArticleRendererTest, RendersMarkdownThroughTheSanitizer) {
+    auto out = ArticleRenderer::render("markdown",
+                                       "# Hi\n\n[x](javascript:alert(1)) <script>bad()</script>");
+    EXPECT_EQ(out.html, "<h1>Hi</h1>\n<p><a rel=\"nofollow noopener\">x</a> </p>\n");
+    EXPECT_EQ(out.summary, "Hi x");
+}
+
+TEST(ArticleRendererTest, SanitizesHtmlArticles) {
+    auto out = ArticleRenderer::render("HTML", "<p onclick=x>Hello <b>there</b></p>");
+    EXPECT_EQ(out.html, "<p>Hello <b>there</b></p>");
+    EXPECT_EQ(out.summary, "Hello there");
+}
+
+TEST(ArticleRendererTest, OtherRenderersFallBackToEscapedText) {
+    auto out = ArticleRenderer::render("bbcode", "[b]bold[/b] <i>\nline two\n\nnext");
+    EXPECT_EQ(out.html, "<p>[b]bold[/b] &lt;i&gt;<br />\nline two</p>\n<p>next</p>\n");
+}
+
+TEST(ArticleRendererTest, SummariesAreCutAtWordBoundaries) {
+    std::string text;
+    for (int i = 0; i < 100; ++i) text += "word ";
+    auto summary = ArticleRenderer::summarize("<p>" + text + "</p>", 22);
+    EXPECT_EQ(summary, "word word word word\xE2\x80\xA6");
+
+    // Never splits a multi-byte character
+    summary = ArticleRenderer::summarize("<p>\xC3\xA9\xC3\xA9\xC3\xA9\xC3\xA9</p>", 5);
+    EXPECT_EQ(summary, "\xC3\xA9\xC3\xA9\xE2\x80\xA6");
+
+    EXPECT_EQ(ArticleRenderer::summarize("<h1>A</h1><p>b &amp; <em>c</em></p>"), "A b & c");
+}
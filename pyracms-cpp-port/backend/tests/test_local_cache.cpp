@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include "services/InvalidationBus.h"
+#include "services/LocalCache.h"
+
+#include <thread>
+
+using namespace pyracms;
+using namespace std::chrono_literals;
+
+// ── LocalCache ───────────────────────────────────────────────────────────────
+
+TEST(LocalCacheTest, MissOnEmptyCache) {
+    LocalCache cache(1 << 20);
+    EXPECT_EQ(cache.get("missing"), nullptr);
+    EXPECT_EQ(cache.stats().misses, 1u);
+}
+
+TEST(LocalCacheTest, PutThenGetReturnsValue) {
+    LocalCache cache(1 << 20);
+    cache.put("articles:1:g0:20:0", "[...]", 10s);
+    auto hit = cache.get("articles:1:g0:20:0");
+    ASSERT_NE(hit, nullptr);
+    EXPECT_EQ(*hit, "[...]");
+    EXPECT_EQ(cache.stats().hits, 1u);
+}
+
+TEST(LocalCacheTest, PutReplacesExistingValue) {
+    LocalCache cache(1 << 20);
+    cache.put("k", "old", 10s);
+    cache.put("k", "new", 10s);
+    EXPECT_EQ(*cache.get("k"), "new");
+    EXPECT_EQ(cache.stats().entries, 1u);
+}
+
+TEST(LocalCacheTest, EraseRemovesEntry) {
+    LocalCache cache(1 << 20);
+    cache.put("k", "v", 10s);
+    cache.erase("k");
+    EXPECT_EQ(cache.get("k"), nullptr);
+    EXPECT_EQ(cache.stats().bytes, 0u);
+}
+
+TEST(LocalCacheTest, ExpiredEntryIsAMiss) {
+    LocalCache cache(1 << 20);
+    cache.put("k", "v", 1ms);
+    std::this_thread::sleep_for(5ms);
+    EXPECT_EQ(cache.get("k"), nullptr);
+    EXPECT_EQ(cache.stats().expirations, 1u);
+}
+
+TEST(LocalCacheTest, NonPositiveTtlIsNotStored) {
+    LocalCache cache(1 << 20);
+    auto v = cache.put("k", "v", 0ms);
+    EXPECT_EQ(*v, "v");
+    EXPECT_EQ(cache.get("k"), nullptr);
+}
+
+TEST(LocalCacheTest, StaysWithinByteBudget) {
+    const size_t budget = 64 * 1024;
+    LocalCache cache(budget, 4);
+    std::string value(1000, 'x');
+    for (int i = 0; i < 1000; ++i) {
+        cache.put("key" + std::to_string(i), value, 10s);
+    }
+    auto stats = cache.stats();
+    EXPECT_LE(stats.bytes, budget);
+    EXPECT_GT(stats.evictions, 0u);
+}
+
+TEST(LocalCacheTest, EvictsLeastRecentlyUsed) {
+    // One shard so eviction order is deterministic
+    const size_t charge = 1 + 100 + LocalCache::kEntryOverhead;
+    LocalCache cache(charge * 2, 1);
+    std::string value(100, 'x');
+    cache.put("a", value, 10s);
+    cache.put("b", value, 10s);
+    ASSERT_NE(cache.get("a"), nullptr); // a is now most recent
+    cache.put("c", value, 10s);
+    EXPECT_NE(cache.get("a"), nullptr);
+    EXPECT_EQ(cache.get("b"), nullptr);
+    EXPECT_NE(cache.get("c"), nullptr);
+}
+
+TEST(LocalCacheTest, OversizedValueBypassesCache) {
+    LocalCache cache(1024, 1);
+    auto v = cache.put("big", std::string(4096, 'x'), 10s);
+    EXPECT_EQ(v->size(), 4096u);
+    EXPECT_EQ(cache.get("big"), nullptr);
+}
+
+TEST(LocalCacheTest, HitSurvivesConcurrentErase) {
+    LocalCache cache(1 << 20);
+    cache.put("k", "payload", 10s);
+    auto hit = cache.get("k");
+    cache.erase("k");
+    EXPECT_EQ(*hit, "payload");
+}
+
+// ── InvalidationMessage ──────────────────────────────────────────────────────
+
+TEST(InvalidationMessageTest, KeyRoundTripKeepsSpaces) {
+    InvalidationMessage msg;
+    msg.origin = "node-1";
+    msg.key = "search:3:g2:hello world:all";
+    auto decoded = InvalidationMessage::decode(msg.encode());
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->kind, InvalidationMessage::Kind::Key);
+    EXPECT_EQ(decoded->origin, "node-1");
+    EXPECT_EQ(decoded->key, "search:3:g2:hello world:all");
+}
+
+TEST(InvalidationMessageTest, GenerationRoundTrip) {
+    InvalidationMessage msg;
+    msg.kind = InvalidationMessage::Kind::Generation;
+    msg.origin = "n";
+    msg.tenantId = 7;
+    msg.ns = 2;
+    msg.generation = 41;
+    auto decoded = InvalidationMessage::decode(msg.encode());
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->kind, InvalidationMessage::Kind::Generation);
+    EXPECT_EQ(decoded->tenantId, 7);
+    EXPECT_EQ(decoded->ns, 2);
+    EXPECT_EQ(decoded->generation, 41);
+}
+
+TEST(InvalidationMessageTest, SurrogateRoundTrip) {
+    InvalidationMessage msg;
+    msg.kind = InvalidationMessage::Kind::Surrogate;
+    msg.origin = "n";
+    msg.key = "article:3:home page";
+    auto decoded = InvalidationMessage::decode(msg.encode());
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->kind, InvalidationMessage::Kind::Surrogate);
+    EXPECT_EQ(decoded->key, "article:3:home page");
+}
+
+TEST(InvalidationMessageTest, RejectsGarbage) {
+    EXPECT_FALSE(InvalidationMessage::decode("").has_value());
+    EXPECT_FALSE(InvalidationMessage::decode("X a b").has_value());
+    EXPECT_FALSE(InvalidationMessage::decode("G n 1 two 3").has_value());
+}
+
+// ── Cross-node invalidation over the local bus ───────────────────────────────
+
+TEST(LocalInvalidationBusTest, DeleteOnOneNodeEvictsOtherNodes) {
+    LocalInvalidationBus bus;
+    LocalCache nodeA(1 << 20);
+    LocalCache nodeB(1 << 20);
+    auto wire = [&bus](LocalCache &cache, const std::string &self) {
+        bus.subscribe([&cache, self](const std::string &message) {
+            auto msg = InvalidationMessage::decode(message);
+            if (msg && msg->origin != self && msg->kind == InvalidationMessage::Kind::Key) {
+                cache.erase(msg->key);
+            }
+        });
+    };
+    wire(nodeA, "a");
+    wire(nodeB, "b");
+
+    nodeA.put("article:1:home", "v1", 10s);
+    nodeB.put("article:1:home", "v1", 10s);
+
+    nodeA.erase("article:1:home");
+    InvalidationMessage msg;
+    msg.origin = "a";
+    msg.key = "article:1:home";
+    bus.publish(msg.encode());
+
+    EXPECT_EQ(nodeA.get("article:1:home"), nullptr);
+    EXPECT_EQ(nodeB.get("article:1:home"), nullptr);
+}
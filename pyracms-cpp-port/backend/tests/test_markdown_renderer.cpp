@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+#include "services/MarkdownRenderer.h"
+
+#include <string>
+
+using namespace pyracms;
+
+namespace {
+
+std::string md(const std::string &text) { return MarkdownRenderer::render(text); }
+
+} // namespace
+
+// ── Leaf blocks ──────────────────────────────────────────────────────────────
+
+TEST(MarkdownRendererTest, Paragraphs) {
+    EXPECT_EQ(md("aaa\nbbb\n\nccc"), "<p>aaa\nbbb</p>\n<p>ccc</p>\n");
+    EXPECT_EQ(md("   leading spaces\n"), "<p>leading spaces</p>\n");
+    EXPECT_EQ(md(""), "");
+}
+
+TEST(MarkdownRendererTest, AtxHeadings) {
+    EXPECT_EQ(md("# foo"), "<h1>foo</h1>\n");
+    EXPECT_EQ(md("###### foo"), "<h6>foo</h6>\n");
+    EXPECT_EQ(md("####### foo"), "<p>####### foo</p>\n");
+    EXPECT_EQ(md("#5 bolt"), "<p>#5 bolt</p>\n");
+    EXPECT_EQ(md("## foo ##"), "<h2>foo</h2>\n");
+    EXPECT_EQ(md("# foo#"), "<h1>foo#</h1>\n");
+    EXPECT_EQ(md("#"), "<h1></h1>\n");
+}
+
+TEST(MarkdownRendererTest, SetextHeadings) {
+    EXPECT_EQ(md("Foo *bar*\n========="), "<h1>Foo <em>bar</em></h1>\n");
+    EXPECT_EQ(md("Foo\nbar\n---"), "<h2>Foo\nbar</h2>\n");
+    EXPECT_EQ(md("Foo\n= ="), "<p>Foo\n= =</p>\n");
+}
+
+TEST(MarkdownRendererTest, ThematicBreaks) {
+    EXPECT_EQ(md("***\n---\n___"), "<hr />\n<hr />\n<hr />\n");
+    EXPECT_EQ(md(" - - -"), "<hr />\n");
+    EXPECT_EQ(md("Foo\n***\nbar"), "<p>Foo</p>\n<hr />\n<p>bar</p>\n");
+    EXPECT_EQ(md("--"), "<p>--</p>\n");
+}
+
+TEST(MarkdownRendererTest, CodeBlocks) {
+    EXPECT_EQ(md("    a simple\n      indented code block"),
+              "<pre><code>a simple\n  indented code block\n</code></pre>\n");
+    EXPECT_EQ(md("    chunk1\n\n    chunk2\n\n\n"),
+              "<pre><code>chunk1\n\nchunk2\n</code></pre>\n");
+    EXPECT_EQ(md("```\n<\n >\n```"), "<pre><code>&lt;\n &gt;\n</code></pre>\n");
+    EXPECT_EQ(md("~~~~ ruby startline=3\ndef foo(x)\n~~~~"),
+              "<pre><code class=\"language-ruby\">def foo(x)\n</code></pre>\n");
+    EXPECT_EQ(md("``` ```\naaa"), "<p><code> </code>\naaa</p>\n");
+    // An unclosed fence runs to the end of its container
+    EXPECT_EQ(md("> ```\n> aaa\n\nbbb"),
+              "<blockquote>\n<pre><code>aaa\n</code></pre>\n</blockquote>\n<p>bbb</p>\n");
+    EXPECT_EQ(md("  ```\n  aaa\naaa\n  ```"), "<pre><code>aaa\naaa\n</code></pre>\n");
+}
+
+TEST(MarkdownRendererTest, IndentedCodeCannotInterruptAParagraph) {
+    EXPECT_EQ(md("Foo\n    bar"), "<p>Foo\nbar</p>\n");
+}
+
+TEST(MarkdownRendererTest, HtmlBlocks) {
+    EXPECT_EQ(md("<div>\n*hello*\n</div>\n\n*world*"),
+              "<div>\n*hello*\n</div>\n<p><em>world</em></p>\n");
+    EXPECT_EQ(md("<!-- comment -->\n\nok"), "<!-- comment -->\n<p>ok</p>\n");
+    // Only block-level tags may interrupt a paragraph
+    EXPECT_EQ(md("Foo\n<a href=\"bar\">\nbaz"), "<p>Foo\n<a href=\"bar\">\nbaz</p>\n");
+}
+
+TEST(MarkdownRendererTest, LinkReferenceDefinitions) {
+    EXPECT_EQ(md("[foo]: /url \"title\"\n\n[foo]"),
+              "<p><a href=\"/url\" title=\"title\">foo</a></p>\n");
+    EXPECT_EQ(md("[Foo bar]:\n<my url>\n'title'\n\n[foo  BAR]"),
+              "<p><a href=\"my%20url\" title=\"title\">foo  BAR</a></p>\n");
+    EXPECT_EQ(md("[foo]: /url 'title\n\nwith blank line'\n\n[foo]"),
+              "<p>[foo]: /url 'title</p>\n<p>with blank line'</p>\n<p>[foo]</p>\n");
+    // The first definition of a label wins
+    EXPECT_EQ(md("[foo]: first\n[foo]: second\n\n[foo]"),
+              "<p><a href=\"first\">foo</a></p>\n");
+}
+
+// ── Container blocks ─────────────────────────────────────────────────────────
+
+TEST(MarkdownRendererTest, BlockQuotes) {
+    EXPECT_EQ(md("> # Foo\n> bar\n> baz"),
+              "<blockquote>\n<h1>Foo</h1>\n<p>bar\nbaz</p>\n</blockquote>\n");
+    EXPECT_EQ(md("> bar\nbaz\n> foo"), "<blockquote>\n<p>bar\nbaz\nfoo</p>\n</blockquote>\n");
+    EXPECT_EQ(md("> foo\n---"), "<blockquote>\n<p>foo</p>\n</blockquote>\n<hr />\n");
+    EXPECT_EQ(md(">"), "<blockquote>\n</blockquote>\n");
+}
+
+TEST(MarkdownRendererTest, TightAndLooseLists) {
+    EXPECT_EQ(md("- foo\n- bar\n+ baz"),
+              "<ul>\n<li>foo</li>\n<li>bar</li>\n</ul>\n<ul>\n<li>baz</li>\n</ul>\n");
+    EXPECT_EQ(md("- a\n- b\n\n- c"),
+              "<ul>\n<li>\n<p>a</p>\n</li>\n<li>\n<p>b</p>\n</li>\n<li>\n<p>c</p>\n</li>\n</ul>\n");
+    EXPECT_EQ(md("- a\n\n  b\n- c"),
+              "<ul>\n<li>\n<p>a</p>\n<p>b</p>\n</li>\n<li>\n<p>c</p>\n</li>\n</ul>\n");
+    EXPECT_EQ(md("- a\n  - b\n\n    c\n- d"),
+              "<ul>\n<li>a\n<ul>\n<li>\n<p>b</p>\n<p>c</p>\n</li>\n</ul>\n</li>\n<li>d</li>\n</ul>\n");
+}
+
+TEST(MarkdownRendererTest, OrderedLists) {
+    EXPECT_EQ(md("1. foo\n2. bar\n3) baz"),
+              "<ol>\n<li>foo</li>\n<li>bar</li>\n</ol>\n<ol start=\"3\">\n<li>baz</li>\n</ol>\n");
+    // Only a list starting at 1 may interrupt a paragraph
+    EXPECT_EQ(md("The number of windows in my house is\n14.  The number of doors is 6."),
+              "<p>The number of windows in my house is\n14.  The number of doors is 6.</p>\n");
+    EXPECT_EQ(md("1234567890. not ok"), "<p>1234567890. not ok</p>\n");
+}
+
+TEST(MarkdownRendererTest, ListItemContentOffsets) {
+    EXPECT_EQ(md("- one\n\n two"), "<ul>\n<li>one</li>\n</ul>\n<p>two</p>\n");
+    EXPECT_EQ(md("- one\n\n  two"), "<ul>\n<li>\n<p>one</p>\n<p>two</p>\n</li>\n</ul>\n");
+    EXPECT_EQ(md("-    one\n\n     two"),
+              "<ul>\n<li>\n<p>one</p>\n<p>two</p>\n</li>\n</ul>\n");
+    EXPECT_EQ(md("1.     indented code\n\n   paragraph"),
+              "<ol>\n<li>\n<pre><code>indented code\n</code></pre>\n<p>paragraph</p>\n</li>\n</ol>\n");
+    EXPECT_EQ(md("-\n  foo\n-\n  ```\n  bar\n  ```\n-\n      baz"),
+              "<ul>\n<li>foo</li>\n<li>\n<pre><code>bar\n</code></pre>\n</li>\n"
+              "<li>\n<pre><code>baz\n</code></pre>\n</li>\n</ul>\n");
+}
+
+TEST(MarkdownRendererTest, TabsExpandToFourColumns) {
+    EXPECT_EQ(md("\tfoo\tbaz"), "<pre><code>foo baz\n</code></pre>\n");
+    EXPECT_EQ(md("-\tfoo\n\n\tbar"), "<ul>\n<li>\n<p>foo</p>\n<p>bar</p>\n</li>\n</ul>\n");
+}
+
+// ── Inlines ──────────────────────────────────────────────────────────────────
+
+TEST(MarkdownRendererTest, BackslashEscapesAndEntities) {
+    EXPECT_EQ(md("\\*not emphasized*"), "<p>*not emphasized*</p>\n");
+    EXPECT_EQ(md("\\\\*emphasis*"), "<p>\\<em>emphasis</em></p>\n");
+    EXPECT_EQ(md("&copy; &#35; &#x22; &nope AT&T"),
+              "<p>&copy; &#35; &#x22; &amp;nope AT&amp;T</p>\n");
+}
+
+TEST(MarkdownRendererTest, CodeSpans) {
+    EXPECT_EQ(md("`foo`"), "<p><code>foo</code></p>\n");
+    EXPECT_EQ(md("`` foo ` bar ``"), "<p><code>foo ` bar</code></p>\n");
+    EXPECT_EQ(md("`foo\nbar`"), "<p><code>foo bar</code></p>\n");
+    EXPECT_EQ(md("`<a>`"), "<p><code>&lt;a&gt;</code></p>\n");
+    EXPECT_EQ(md("```foo``"), "<p>```foo``</p>\n");
+}
+
+TEST(MarkdownRendererTest, Emphasis) {
+    EXPECT_EQ(md("*foo bar*"), "<p><em>foo bar</em></p>\n");
+    EXPECT_EQ(md("a * foo bar*"), "<p>a * foo bar*</p>\n");
+    EXPECT_EQ(md("foo*bar*"), "<p>foo<em>bar</em></p>\n");
+    EXPECT_EQ(md("foo_bar_"), "<p>foo_bar_</p>\n");
+    EXPECT_EQ(md("**foo bar**"), "<p><strong>foo bar</strong></p>\n");
+    EXPECT_EQ(md("*foo**bar**baz*"), "<p><em>foo<strong>bar</strong>baz</em></p>\n");
+    EXPECT_EQ(md("***foo***"), "<p><em><strong>foo</strong></em></p>\n");
+    EXPECT_EQ(md("**foo*"), "<p>*<em>foo</em></p>\n");
+    EXPECT_EQ(md("*foo**"), "<p><em>foo</em>*</p>\n");
+    // The rule of three
+    EXPECT_EQ(md("*foo**bar*"), "<p><em>foo**bar</em></p>\n");
+    EXPECT_EQ(md("foo***bar***baz"), "<p>foo<em><strong>bar</strong></em>baz</p>\n");
+    EXPECT_EQ(md("*(**foo**)*"), "<p><em>(<strong>foo</strong>)</em></p>\n");
+    EXPECT_EQ(md("_foo_bar_baz_"), "<p><em>foo_bar_baz</em></p>\n");
+}
+
+TEST(MarkdownRendererTest, Links) {
+    EXPECT_EQ(md("[link](/uri \"title\")"),
+              "<p><a href=\"/uri\" title=\"title\">link</a></p>\n");
+    EXPECT_EQ(md("[link]()"), "<p><a href=\"\">link</a></p>\n");
+    EXPECT_EQ(md("[link](<foo bar>)"), "<p><a href=\"foo%20bar\">link</a></p>\n");
+    EXPECT_EQ(md("[link](foo(and(bar)))"), "<p><a href=\"foo(and(bar))\">link</a></p>\n");
+    EXPECT_EQ(md("[link *foo **bar***](/uri)"),
+              "<p><a href=\"/uri\">link <em>foo <strong>bar</strong></em></a></p>\n");
+    // No links inside links; the inner one wins
+    EXPECT_EQ(md("[foo [bar](/uri)](/uri)"), "<p>[foo <a href=\"/uri\">bar</a>](/uri)</p>\n");
+    EXPECT_EQ(md("*[foo*](/uri)"), "<p>*<a href=\"/uri\">foo*</a></p>\n");
+    EXPECT_EQ(md("[link](/u?a=1&b=2)"), "<p><a href=\"/u?a=1&amp;b=2\">link</a></p>\n");
+}
+
+TEST(MarkdownRendererTest, ReferenceLinks) {
+    const std::string defs = "\n\n[bar]: /url \"title\"";
+    EXPECT_EQ(md("[foo][bar]" + defs), "<p><a href=\"/url\" title=\"title\">foo</a></p>\n");
+    EXPECT_EQ(md("[bar][]" + defs), "<p><a href=\"/url\" title=\"title\">bar</a></p>\n");
+    EXPECT_EQ(md("[BAR]" + defs), "<p><a href=\"/url\" title=\"title\">BAR</a></p>\n");
+    EXPECT_EQ(md("[baz]" + defs), "<p>[baz]</p>\n");
+}
+
+TEST(MarkdownRendererTest, Images) {
+    EXPECT_EQ(md("![foo *bar*](/url \"title\")"),
+              "<p><img src=\"/url\" alt=\"foo bar\" title=\"title\" /></p>\n");
+    EXPECT_EQ(md("![foo ![bar](/b)](/f)"), "<p><img src=\"/f\" alt=\"foo bar\" /></p>\n");
+}
+
+TEST(MarkdownRendererTest, AutolinksAndRawHtml) {
+    EXPECT_EQ(md("<http://foo.bar.baz/test?q=hello&id=22&boolean>"),
+              "<p><a href=\"http://foo.bar.baz/test?q=hello&amp;id=22&amp;boolean\">"
+              "http://foo.bar.baz/test?q=hello&amp;id=22&amp;boolean</a></p>\n");
+    EXPECT_EQ(md("<foo@bar.example.com>"),
+              "<p><a href=\"mailto:foo@bar.example.com\">foo@bar.example.com</a></p>\n");
+    EXPECT_EQ(md("<a href=\"x\">*hi*</a>"), "<p><a href=\"x\"><em>hi</em></a></p>\n");
+    EXPECT_EQ(md("<33> <__>"), "<p>&lt;33&gt; &lt;__&gt;</p>\n");
+}
+
+TEST(MarkdownRendererTest, LineBreaks) {
+    EXPECT_EQ(md("foo  \nbar"), "<p>foo<br />\nbar</p>\n");
+    EXPECT_EQ(md("foo\\\nbar"), "<p>foo<br />\nbar</p>\n");
+    EXPECT_EQ(md("foo \n   bar"), "<p>foo\nbar</p>\n");
+    EXPECT_EQ(md("foo  "), "<p>foo</p>\n");
+}
+
+// ── Robustness ───────────────────────────────────────────────────────────────
+
+TEST(MarkdownRendererTest, PathologicalInputStaysBounded) {
+    // Deep nesting is capped rather than recursed into without limit
+    std::string quotes(10000 * 2, ' ');
+    for (size_t i = 0; i < quotes.size(); i += 2) quotes[i] = '>';
+    auto html = md(quotes + "x");
+    EXPECT_NE(html.find("x"), std::string::npos);
+
+    EXPECT_FALSE(md(std::string(50000, '*') + "a").empty());
+    EXPECT_FALSE(md(std::string(50000, '[') + "a").empty());
+    EXPECT_FALSE(md(std::string(20000, '`') + "a").empty());
+
+    std::string nested;
+    for (int i = 0; i < 5000; ++i) nested += "*a **b ";
+    EXPECT_FALSE(md(nested).empty());
+}
+
+TEST(MarkdownRendererTest, CrLfLineEndings) {
+    EXPECT_EQ(md("# Title\r\n\r\nbody\r\n"), "<h1>Title</h1>\n<p>body</p>\n");
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include "services/PageCursor.h"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace pyracms;
+
+namespace {
+
+using Row = std::pair<std::string, int64_t>; // (created_at, id)
+
+// What "WHERE (created_at, id) < ($k, $i) ORDER BY created_at DESC, id DESC
+// LIMIT n OFFSET m" returns; 'infinity' sorts after every timestamp
+std::vector<Row> query(std::vector<Row> rows, const PageRequest &page) {
+    std::sort(rows.begin(), rows.end(), std::greater<Row>());
+    std::vector<Row> out;
+    auto key = page.afterKey();
+    auto id = page.afterId();
+    int skip = page.skip();
+    for (const auto &row : rows) {
+        if (key != "infinity" && row >= Row(key, id)) continue;
+        if (skip > 0) {
+            --skip;
+            continue;
+        }
+        if (static_cast<int>(out.size()) == page.limit) break;
+        out.push_back(row);
+    }
+    return out;
+}
+
+} // namespace
+
+// ── Cursor encoding ──────────────────────────────────────────────────────────
+
+TEST(PageCursorTest, RoundTrip) {
+    PageCursor cursor;
+    cursor.scope = PageCursor::hashScope("followers", 42);
+    cursor.key = "2025-03-01 12:00:00.123456+00";
+    cursor.id = 9001;
+
+    auto text = cursor.encode();
+    EXPECT_EQ(text.find_first_not_of(
+                  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"),
+              std::string::npos);
+
+    PageCursor decoded;
+    ASSERT_TRUE(PageCursor::decode(text, decoded));
+    EXPECT_EQ(decoded.scope, cursor.scope);
+    EXPECT_EQ(decoded.key, cursor.key);
+    EXPECT_EQ(decoded.id, 9001);
+}
+
+TEST(PageCursorTest, KeepsWideIds) {
+    PageCursor cursor;
+    cursor.key = "2025-03-01 12:00:00+00";
+    cursor.id = (int64_t{2} << 32) | 77;
+    PageCursor decoded;
+    ASSERT_TRUE(PageCursor::decode(cursor.encode(), decoded));
+    EXPECT_EQ(decoded.id, cursor.id);
+}
+
+TEST(PageCursorTest, RejectsGarbage) {
+    PageCursor cursor;
+    cursor.key = "2025-03-01 12:00:00+00";
+    cursor.id = 5;
+    auto text = cursor.encode();
+
+    PageCursor out;
+    EXPECT_FALSE(PageCursor::decode("", out));
+    EXPECT_FALSE(PageCursor::decode("not a cursor!", out));
+    EXPECT_FALSE(PageCursor::decode(text.substr(0, text.size() - 2), out));
+    EXPECT_FALSE(PageCursor::decode(text + "AAAA", out));
+    EXPECT_FALSE(PageCursor::decode("Ag", out)); // wrong version
+
+    // An empty or oversized key was never a row's sort key
+    cursor.key.clear();
+    EXPECT_FALSE(PageCursor::decode(cursor.encode(), out));
+    cursor.key.assign(100, '1');
+    EXPECT_FALSE(PageCursor::decode(cursor.encode(), out));
+}
+
+TEST(PageCursorTest, ScopesDifferByListAndOwner) {
+    EXPECT_EQ(PageCursor::hashScope("followers", 1), PageCursor::hashScope("followers", 1));
+    EXPECT_NE(PageCursor::hashScope("followers", 1), PageCursor::hashScope("following", 1));
+    EXPECT_NE(PageCursor::hashScope("followers", 1), PageCursor::hashScope("followers", 2));
+}
+
+// ── Page requests ────────────────────────────────────────────────────────────
+
+TEST(PageRequestTest, ParsesLimitAndOffset) {
+    PageRequest page;
+    ASSERT_TRUE(PageRequest::parse("50", "100", "", 1, page));
+    EXPECT_EQ(page.limit, 50);
+    EXPECT_EQ(page.skip(), 100);
+    EXPECT_FALSE(page.hasCursor);
+    EXPECT_EQ(page.afterKey(), "infinity");
+    EXPECT_EQ(page.afterId(), std::numeric_limits<int64_t>::max());
+    EXPECT_EQ(page.afterKey(true), "-infinity");
+    EXPECT_EQ(page.afterId(true), std::numeric_limits<int64_t>::min());
+
+    ASSERT_TRUE(PageRequest::parse("", "", "", 1, page));
+    EXPECT_EQ(page.limit, PageRequest::kDefaultLimit);
+    EXPECT_EQ(page.skip(), 0);
+
+    ASSERT_TRUE(PageRequest::parse("-3", "x", "", 1, page));
+    EXPECT_EQ(page.limit, PageRequest::kDefaultLimit);
+    EXPECT_EQ(page.skip(), 0);
+
+    ASSERT_TRUE(PageRequest::parse("", "", "", 1, page, 50));
+    EXPECT_EQ(page.limit, 50);
+}
+
+TEST(PageRequestTest, CursorTakesPrecedenceOverOffset) {
+    auto scope = PageCursor::hashScope("articles", 1);
+    PageRequest first;
+    ASSERT_TRUE(PageRequest::parse("2", "", "", scope, first));
+    auto next = first.next(2, "2025-01-01 00:00:00+00", 10);
+    ASSERT_FALSE(next.empty());
+
+    PageRequest page;
+    ASSERT_TRUE(PageRequest::parse("2", "40", next, scope, page));
+    EXPECT_TRUE(page.hasCursor);
+    EXPECT_EQ(page.skip(), 0);
+    EXPECT_EQ(page.afterKey(), "2025-01-01 00:00:00+00");
+    EXPECT_EQ(page.afterId(), 10);
+}
+
+TEST(PageRequestTest, RejectsCursorsFromOtherLists) {
+    PageRequest first;
+    ASSERT_TRUE(PageRequest::parse("", "", "", PageCursor::hashScope("articles", 1), first));
+    auto next = first.next(20, "2025-01-01 00:00:00+00", 10);
+
+    PageRequest page;
+    EXPECT_FALSE(PageRequest::parse("", "", next, PageCursor::hashScope("articles", 2), page));
+    EXPECT_FALSE(PageRequest::parse("", "", "garbage", PageCursor::hashScope("articles", 1), page));
+}
+
+TEST(PageRequestTest, ShortPageEndsTheList) {
+    PageRequest page;
+    ASSERT_TRUE(PageRequest::parse("10", "", "", 1, page));
+    EXPECT_TRUE(page.next(9, "2025-01-01 00:00:00+00", 3).empty());
+    EXPECT_FALSE(page.next(10, "2025-01-01 00:00:00+00", 3).empty());
+}
+
+// ── Walking a list ───────────────────────────────────────────────────────────
+
+TEST(PageRequestTest, CursorWalkMatchesOffsetWalk) {
+    // Plenty of rows share a timestamp so the id has to break ties
+    std::mt19937 rng(7);
+    std::vector<Row> rows;
+    for (int64_t id = 1; id <= 500; ++id) {
+        rows.emplace_back("2025-01-0" + std::to_string(1 + rng() % 9) + " 00:00:00+00", id);
+    }
+    auto scope = PageCursor::hashScope("comments", 1);
+
+    for (int limit : {1, 7, 20, 500, 501}) {
+        std::vector<Row> byCursor;
+        std::string cursor;
+        do {
+            PageRequest page;
+            ASSERT_TRUE(PageRequest::parse(std::to_string(limit), "", cursor, scope, page));
+            auto got = query(rows, page);
+            byCursor.insert(byCursor.end(), got.begin(), got.end());
+            cursor = got.empty() ? "" : page.next(got.size(), got.back().first, got.back().second);
+        } while (!cursor.empty());
+
+        std::vector<Row> byOffset;
+        for (int offset = 0;; offset += limit) {
+            PageRequest page;
+            ASSERT_TRUE(PageRequest::parse(std::to_string(limit), std::to_string(offset), "",
+                                           scope, page));
+            auto got = query(rows, page);
+            byOffset.insert(byOffset.end(), got.begin(), got.end());
+            if (static_cast<int>(got.size()) < limit) break;
+        }
+
+        EXPECT_EQ(byCursor.size(), rows.size()) << "limit " << limit;
+        EXPECT_EQ(byCursor, byOffset) << "limit " << limit;
+    }
+}
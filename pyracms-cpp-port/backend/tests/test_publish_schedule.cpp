@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "services/PublishSchedule.h"
+
+#include <map>
+#include <random>
+
+using namespace pyracms;
+
+namespace {
+
+using Clock = PublishSchedule::Clock;
+
+Clock::time_point at(int seconds) {
+    return Clock::time_point() + std::chrono::seconds(seconds);
+}
+
+} // namespace
+
+// ── Due times ────────────────────────────────────────────────────────────────
+
+TEST(PublishScheduleTest, EmptyHasNothingNext) {
+    PublishSchedule schedule;
+    EXPECT_FALSE(schedule.next());
+    EXPECT_EQ(schedule.size(), 0u);
+}
+
+TEST(PublishScheduleTest, NextIsTheEarliest) {
+    PublishSchedule schedule;
+    schedule.schedule(1, at(30));
+    schedule.schedule(2, at(10));
+    schedule.schedule(3, at(20));
+    EXPECT_EQ(schedule.next(), at(10));
+    EXPECT_EQ(schedule.size(), 3u);
+}
+
+TEST(PublishScheduleTest, ReschedulingMovesTheArticle) {
+    PublishSchedule schedule;
+    schedule.schedule(1, at(10));
+    schedule.schedule(2, at(20));
+    schedule.schedule(1, at(30));
+    EXPECT_EQ(schedule.next(), at(20));
+    EXPECT_EQ(schedule.size(), 2u);
+
+    schedule.schedule(1, at(5));
+    EXPECT_EQ(schedule.next(), at(5));
+}
+
+TEST(PublishScheduleTest, CancelledArticlesAreSkipped) {
+    PublishSchedule schedule;
+    schedule.schedule(1, at(10));
+    schedule.schedule(2, at(20));
+    schedule.cancel(1);
+    EXPECT_EQ(schedule.next(), at(20));
+    schedule.cancel(2);
+    EXPECT_FALSE(schedule.next());
+    schedule.cancel(3); // never scheduled
+    EXPECT_EQ(schedule.size(), 0u);
+}
+
+TEST(PublishScheduleTest, ClearDropsEverything) {
+    PublishSchedule schedule;
+    schedule.schedule(1, at(10));
+    schedule.clear();
+    EXPECT_FALSE(schedule.next());
+    schedule.schedule(1, at(20));
+    EXPECT_EQ(schedule.next(), at(20));
+}
+
+TEST(PublishScheduleTest, ChurnMatchesAReferenceModel) {
+    // Heavy rescheduling of a few articles also exercises compaction
+    std::mt19937 rng(11);
+    PublishSchedule schedule;
+    std::map<int, int> model;
+    for (int step = 0; step < 20000; ++step) {
+        int id = 1 + static_cast<int>(rng() % 50);
+        if (rng() % 4 == 0) {
+            schedule.cancel(id);
+            model.erase(id);
+        } else {
+            int due = static_cast<int>(rng() % 1000);
+            schedule.schedule(id, at(due));
+            model[id] = due;
+        }
+        if (step % 97 == 0) {
+            std::optional<Clock::time_point> expected;
+            for (const auto &[_, due] : model) {
+                if (!expected || at(due) < *expected) expected = at(due);
+            }
+            ASSERT_EQ(schedule.next(), expected) << "step " << step;
+            ASSERT_EQ(schedule.size(), model.size());
+        }
+    }
+}
+
+// ── Notifications ────────────────────────────────────────────────────────────
+
+TEST(PublishScheduleTest, DecodesChanges) {
+    auto scheduled = PublishSchedule::Change::decode("42 3600.250000");
+    ASSERT_TRUE(scheduled);
+    EXPECT_EQ(scheduled->articleId, 42);
+    ASSERT_TRUE(scheduled->delaySeconds);
+    EXPECT_DOUBLE_EQ(*scheduled->delaySeconds, 3600.25);
+
+    auto overdue = PublishSchedule::Change::decode("7 -12.5");
+    ASSERT_TRUE(overdue);
+    EXPECT_DOUBLE_EQ(*overdue->delaySeconds, -12.5);
+
+    auto cancelled = PublishSchedule::Change::decode("42");
+    ASSERT_TRUE(cancelled);
+    EXPECT_EQ(cancelled->articleId, 42);
+    EXPECT_FALSE(cancelled->delaySeconds);
+}
+
+TEST(PublishScheduleTest, RejectsMalformedChanges) {
+    EXPECT_FALSE(PublishSchedule::Change::decode(""));
+    EXPECT_FALSE(PublishSchedule::Change::decode("abc"));
+    EXPECT_FALSE(PublishSchedule::Change::decode("0"));
+    EXPECT_FALSE(PublishSchedule::Change::decode("12x 5"));
+    EXPECT_FALSE(PublishSchedule::Change::decode("12 "));
+    EXPECT_FALSE(PublishSchedule::Change::decode("12 5s"));
+    EXPECT_FALSE(PublishSchedule::Change::decode("12 nan"));
+}
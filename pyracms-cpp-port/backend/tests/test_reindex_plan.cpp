@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+#include "services/ReindexPlan.h"
+
+using namespace pyracms;
+
+TEST(ReindexPlanTest, EmptyTableHasNoRanges) {
+    EXPECT_TRUE(splitIdRange(1, 0, 4).empty());
+}
+
+TEST(ReindexPlanTest, RangesCoverIdsExactlyOnce) {
+    auto ranges = splitIdRange(7, 1006, 4);
+    ASSERT_EQ(ranges.size(), 4u);
+    EXPECT_EQ(ranges.front().lo, 6);
+    EXPECT_EQ(ranges.back().hi, 1006);
+    for (size_t i = 1; i < ranges.size(); ++i) {
+        EXPECT_EQ(ranges[i].lo, ranges[i - 1].hi);
+        EXPECT_EQ(ranges[i].hi - ranges[i].lo, 250);
+    }
+}
+
+TEST(ReindexPlanTest, NeverMoreRangesThanIds) {
+    auto ranges = splitIdRange(5, 6, 8);
+    ASSERT_EQ(ranges.size(), 2u);
+    EXPECT_EQ(ranges[0].lo, 4);
+    EXPECT_EQ(ranges[0].hi, 5);
+    EXPECT_EQ(ranges[1].hi, 6);
+
+    EXPECT_EQ(splitIdRange(1, 100, 0).size(), 1u);
+}
+
+TEST(ReindexPlanTest, ThroughputCountsOnlyThisRun) {
+    EXPECT_DOUBLE_EQ(docsPerSecond(1500, 500, 10.0), 100.0);
+    EXPECT_DOUBLE_EQ(docsPerSecond(500, 500, 10.0), 0.0);
+    EXPECT_DOUBLE_EQ(docsPerSecond(1500, 0, 0.0), 0.0);
+}
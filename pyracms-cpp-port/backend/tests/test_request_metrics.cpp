@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include "services/RequestMetrics.h"
+
+#include <thread>
+#include <vector>
+
+using namespace pyracms;
+
+// ── LatencyBuckets ───────────────────────────────────────────────────────────
+
+TEST(LatencyBucketsTest, SmallValuesAreExact) {
+    for (uint64_t v = 0; v < 16; ++v) {
+        EXPECT_EQ(LatencyBuckets::upperBound(LatencyBuckets::indexFor(v)), v);
+    }
+}
+
+TEST(LatencyBucketsTest, EveryValueFitsItsBucket) {
+    for (uint64_t v = 1; v < (uint64_t{1} << 36); v = v * 3 / 2 + 1) {
+        size_t i = LatencyBuckets::indexFor(v);
+        ASSERT_LT(i, LatencyBuckets::kCount);
+        EXPECT_LE(v, LatencyBuckets::upperBound(i));
+        if (i > 0) {
+            EXPECT_GT(v, LatencyBuckets::upperBound(i - 1));
+        }
+    }
+}
+
+TEST(LatencyBucketsTest, RelativeErrorIsBounded) {
+    for (uint64_t v = 16; v < 10'000'000; v = v * 5 / 4 + 7) {
+        auto bound = LatencyBuckets::upperBound(LatencyBuckets::indexFor(v));
+        EXPECT_LE(static_cast<double>(bound - v) / static_cast<double>(v), 0.125);
+    }
+}
+
+TEST(LatencyBucketsTest, HugeValuesClampToLastBucket) {
+    EXPECT_EQ(LatencyBuckets::indexFor(~uint64_t{0}), LatencyBuckets::kCount - 1);
+}
+
+// ── RequestMetrics ───────────────────────────────────────────────────────────
+
+TEST(RequestMetricsTest, RecordsPerRoute) {
+    RequestMetrics metrics;
+    metrics.requestStarted();
+    metrics.requestFinished("/api/articles", 200, 1500, 0, 4096);
+    metrics.requestStarted();
+    metrics.requestFinished("/api/articles", 404, 500, 10, 20);
+    metrics.requestStarted();
+    metrics.requestFinished("/api/search", 200, 90000, 0, 100);
+
+    auto snap = metrics.snapshot();
+    EXPECT_EQ(snap.inFlight, 0);
+    ASSERT_EQ(snap.routes.size(), 2u);
+    const auto &articles = snap.routes.at("/api/articles");
+    EXPECT_EQ(articles.count, 2u);
+    EXPECT_EQ(articles.sumMicros, 2000u);
+    EXPECT_EQ(articles.requestBytes, 10u);
+    EXPECT_EQ(articles.responseBytes, 4116u);
+    EXPECT_EQ(articles.statuses.at(200), 1u);
+    EXPECT_EQ(articles.statuses.at(404), 1u);
+}
+
+TEST(RequestMetricsTest, TracksInFlight) {
+    RequestMetrics metrics;
+    metrics.requestStarted();
+    metrics.requestStarted();
+    metrics.requestFinished("/a", 200, 1, 0, 0);
+    EXPECT_EQ(metrics.snapshot().inFlight, 1);
+}
+
+TEST(RequestMetricsTest, UnmatchedRequestsShareOneRoute) {
+    RequestMetrics metrics;
+    metrics.requestFinished("", 404, 1, 0, 0);
+    EXPECT_EQ(metrics.snapshot().routes.count("unmatched"), 1u);
+}
+
+TEST(RequestMetricsTest, ExcessStatusCodesGoToOverflow) {
+    RequestMetrics metrics;
+    for (int code = 200; code < 230; ++code) {
+        metrics.requestFinished("/r", code, 1, 0, 0);
+    }
+    auto snap = metrics.snapshot();
+    const auto &route = snap.routes.at("/r");
+    uint64_t total = 0;
+    for (const auto &[code, n] : route.statuses) total += n;
+    EXPECT_EQ(total, 30u);
+    EXPECT_GT(route.statuses.at(0), 0u);
+}
+
+TEST(RequestMetricsTest, MergesThreads) {
+    RequestMetrics metrics;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&metrics, t] {
+            for (int i = 0; i < 1000; ++i) {
+                metrics.requestStarted();
+                metrics.requestFinished("/api/articles", 200, static_cast<uint64_t>(t * 100 + i),
+                                        0, 1);
+            }
+        });
+    }
+    for (auto &t : threads) t.join();
+    auto snap = metrics.snapshot();
+    EXPECT_EQ(snap.inFlight, 0);
+    EXPECT_EQ(snap.routes.at("/api/articles").count, 4000u);
+    EXPECT_EQ(snap.routes.at("/api/articles").responseBytes, 4000u);
+}
+
+TEST(RequestMetricsTest, QuantilesFollowDistribution) {
+    RequestMetrics metrics;
+    for (int i = 1; i <= 100; ++i) {
+        metrics.requestFinished("/q", 200, static_cast<uint64_t>(i) * 1000, 0, 0);
+    }
+    auto snap = metrics.snapshot();
+    const auto &route = snap.routes.at("/q");
+    auto p50 = route.quantileMicros(0.5);
+    auto p99 = route.quantileMicros(0.99);
+    EXPECT_GE(p50, 50000u);
+    EXPECT_LE(p50, 57000u);
+    EXPECT_GE(p99, 99000u);
+    EXPECT_LE(p99, 113000u);
+}
+
+TEST(RequestMetricsTest, RendersPrometheusText) {
+    RequestMetrics metrics;
+    metrics.requestFinished("/api/articles/{name}", 200, 700, 0, 50);
+    metrics.requestFinished("/api/articles/{name}", 200, 3000, 0, 50);
+    auto text = metrics.renderPrometheus();
+
+    EXPECT_NE(text.find("# TYPE pyracms_http_request_duration_seconds histogram"),
+              std::string::npos);
+    EXPECT_NE(text.find("pyracms_http_request_duration_seconds_bucket{route=\"/api/articles/"
+                        "{name}\",le=\"0.001\"} 1\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("pyracms_http_request_duration_seconds_bucket{route=\"/api/articles/"
+                        "{name}\",le=\"+Inf\"} 2\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("pyracms_http_responses_total{route=\"/api/articles/{name}\",code=\"200\"} 2"),
+              std::string::npos);
+    EXPECT_NE(text.find("pyracms_http_response_bytes_total{route=\"/api/articles/{name}\"} 100"),
+              std::string::npos);
+}
+
+TEST(RequestMetricsTest, EscapesLabelValues) {
+    RequestMetrics metrics;
+    metrics.requestFinished("/a\"b", 200, 1, 0, 0);
+    EXPECT_NE(metrics.renderPrometheus().find("route=\"/a\\\"b\""), std::string::npos);
+}
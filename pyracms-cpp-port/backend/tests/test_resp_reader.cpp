@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include "services/RespReader.h"
+
+#include <string>
+
+using namespace pyracms;
+
+// ── Scalars ──────────────────────────────────────────────────────────────────
+
+TEST(RespReaderTest, ParsesSimpleString) {
+    RespReader reader;
+    reader.feed("+OK\r\n");
+    RespValue v;
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_EQ(v.type, RespValue::Type::SimpleString);
+    EXPECT_EQ(v.str, "OK");
+}
+
+TEST(RespReaderTest, ParsesError) {
+    RespReader reader;
+    reader.feed("-ERR unknown command\r\n");
+    RespValue v;
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_TRUE(v.isError());
+    EXPECT_EQ(v.str, "ERR unknown command");
+}
+
+TEST(RespReaderTest, ParsesNegativeInteger) {
+    RespReader reader;
+    reader.feed(":-42\r\n");
+    RespValue v;
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_EQ(v.type, RespValue::Type::Integer);
+    EXPECT_EQ(v.integer, -42);
+}
+
+TEST(RespReaderTest, ParsesNilBulkString) {
+    RespReader reader;
+    reader.feed("$-1\r\n");
+    RespValue v;
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_TRUE(v.isNil());
+}
+
+TEST(RespReaderTest, BulkStringMayContainCrlf) {
+    RespReader reader;
+    reader.feed("$8\r\nab\r\ncd\r\n\r\n");
+    RespValue v;
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_EQ(v.str, "ab\r\ncd\r\n");
+}
+
+// ── Large values and partial reads ───────────────────────────────────────────
+
+TEST(RespReaderTest, BulkStringLargerThanOldBufferIsNotTruncated) {
+    std::string payload(100000, 'x');
+    std::string wire = "$" + std::to_string(payload.size()) + "\r\n" + payload + "\r\n";
+
+    RespReader reader;
+    RespValue v;
+    // Deliver in 1000-byte fragments the way a socket would
+    for (size_t pos = 0; pos < wire.size(); pos += 1000) {
+        EXPECT_EQ(reader.next(v), RespReader::Status::Incomplete);
+        reader.feed(wire.data() + pos, std::min<size_t>(1000, wire.size() - pos));
+    }
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_EQ(v.str.size(), payload.size());
+    EXPECT_EQ(v.str, payload);
+    EXPECT_EQ(reader.next(v), RespReader::Status::Incomplete);
+}
+
+TEST(RespReaderTest, ByteAtATimeFeedYieldsSameValue) {
+    std::string wire = "*2\r\n$3\r\nfoo\r\n:7\r\n";
+    RespReader reader;
+    RespValue v;
+    for (char c : wire) {
+        EXPECT_EQ(reader.next(v), RespReader::Status::Incomplete);
+        reader.feed(&c, 1);
+    }
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    ASSERT_EQ(v.elements.size(), 2u);
+    EXPECT_EQ(v.elements[0].str, "foo");
+    EXPECT_EQ(v.elements[1].integer, 7);
+}
+
+TEST(RespReaderTest, PipelinedRepliesStayInOrder) {
+    RespReader reader;
+    reader.feed("+OK\r\n$5\r\nhello\r\n:1\r\n$-1\r\n");
+    RespValue v;
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_EQ(v.str, "OK");
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_EQ(v.str, "hello");
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_EQ(v.integer, 1);
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_TRUE(v.isNil());
+    EXPECT_EQ(reader.next(v), RespReader::Status::Incomplete);
+    EXPECT_EQ(reader.buffered(), 0u);
+}
+
+TEST(RespReaderTest, ParseReportsNeededBytesForPartialBulk) {
+    std::string wire = "$10\r\nabc";
+    RespValue v;
+    size_t consumed = 0;
+    size_t needed = 0;
+    EXPECT_EQ(RespReader::parse(wire.data(), wire.size(), v, consumed, needed),
+              RespReader::Status::Incomplete);
+    EXPECT_EQ(needed, 17u);
+}
+
+// ── Aggregates ───────────────────────────────────────────────────────────────
+
+TEST(RespReaderTest, ParsesNestedArrays) {
+    RespReader reader;
+    reader.feed("*2\r\n*2\r\n:1\r\n:2\r\n*1\r\n+x\r\n");
+    RespValue v;
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    ASSERT_EQ(v.type, RespValue::Type::Array);
+    ASSERT_EQ(v.elements.size(), 2u);
+    EXPECT_EQ(v.elements[0].elements[1].integer, 2);
+    EXPECT_EQ(v.elements[1].elements[0].str, "x");
+}
+
+TEST(RespReaderTest, ParsesEmptyAndNilArrays) {
+    RespReader reader;
+    reader.feed("*0\r\n*-1\r\n");
+    RespValue v;
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_EQ(v.type, RespValue::Type::Array);
+    EXPECT_TRUE(v.elements.empty());
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_TRUE(v.isNil());
+}
+
+// ── RESP3 ────────────────────────────────────────────────────────────────────
+
+TEST(RespReaderTest, ParsesResp3Scalars) {
+    RespReader reader;
+    reader.feed("_\r\n#t\r\n,3.5\r\n(12345678901234567890\r\n=8\r\ntxt:abcd\r\n!3\r\nbad\r\n");
+    RespValue v;
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_TRUE(v.isNil());
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_TRUE(v.boolean);
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_DOUBLE_EQ(v.number, 3.5);
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_EQ(v.str, "12345678901234567890");
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_EQ(v.type, RespValue::Type::VerbatimString);
+    EXPECT_EQ(v.str, "abcd");
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_TRUE(v.isError());
+    EXPECT_EQ(v.str, "bad");
+}
+
+TEST(RespReaderTest, ParsesMapAsKeyValuePairs) {
+    RespReader reader;
+    reader.feed("%2\r\n+a\r\n:1\r\n+b\r\n:2\r\n");
+    RespValue v;
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    ASSERT_EQ(v.type, RespValue::Type::Map);
+    ASSERT_EQ(v.elements.size(), 4u);
+    EXPECT_EQ(v.elements[2].str, "b");
+    EXPECT_EQ(v.elements[3].integer, 2);
+}
+
+TEST(RespReaderTest, ParsesPush) {
+    RespReader reader;
+    reader.feed(">3\r\n$7\r\nmessage\r\n$2\r\nch\r\n$4\r\nbody\r\n");
+    RespValue v;
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_EQ(v.type, RespValue::Type::Push);
+    ASSERT_EQ(v.elements.size(), 3u);
+    EXPECT_EQ(v.elements[2].str, "body");
+}
+
+TEST(RespReaderTest, SkipsAttributes) {
+    RespReader reader;
+    reader.feed("|1\r\n+ttl\r\n:3600\r\n$3\r\nval\r\n");
+    RespValue v;
+    ASSERT_EQ(reader.next(v), RespReader::Status::Ok);
+    EXPECT_EQ(v.type, RespValue::Type::BulkString);
+    EXPECT_EQ(v.str, "val");
+}
+
+// ── Malformed input ──────────────────────────────────────────────────────────
+
+TEST(RespReaderTest, RejectsUnknownTypeByte) {
+    RespReader reader;
+    reader.feed("?what\r\n");
+    RespValue v;
+    EXPECT_EQ(reader.next(v), RespReader::Status::ProtocolError);
+}
+
+TEST(RespReaderTest, RejectsBadBulkTerminator) {
+    RespReader reader;
+    reader.feed("$3\r\nabcXY");
+    RespValue v;
+    EXPECT_EQ(reader.next(v), RespReader::Status::ProtocolError);
+}
+
+TEST(RespReaderTest, RejectsExcessiveNesting) {
+    std::string wire;
+    for (int i = 0; i <= RespReader::kMaxDepth + 1; ++i) wire += "*1\r\n";
+    wire += ":1\r\n";
+    RespReader reader;
+    reader.feed(wire);
+    RespValue v;
+    EXPECT_EQ(reader.next(v), RespReader::Status::ProtocolError);
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include "services/ResponseCache.h"
+
+#include <thread>
+
+using namespace pyracms;
+using namespace std::chrono_literals;
+
+namespace {
+
+CachedResponse response(const std::string &body, CachedResponse::Stamps stamps = {}) {
+    CachedResponse r;
+    r.contentType = "application/json; charset=utf-8";
+    r.body = body;
+    r.stamps = std::move(stamps);
+    return r;
+}
+
+} // namespace
+
+// ── Keys ─────────────────────────────────────────────────────────────────────
+
+TEST(ResponseCacheKeyTest, ParameterOrderDoesNotMatter) {
+    auto a = ResponseCache::makeKey("/api/articles", 1, {{"limit", "20"}, {"offset", "0"}});
+    auto b = ResponseCache::makeKey("/api/articles", 1, {{"offset", "0"}, {"limit", "20"}});
+    EXPECT_EQ(a, b);
+}
+
+TEST(ResponseCacheKeyTest, TenantSeparatesEntries) {
+    auto a = ResponseCache::makeKey("/api/articles", 1, {{"tenant_id", "1"}});
+    auto b = ResponseCache::makeKey("/api/articles", 2, {{"tenant_id", "2"}});
+    EXPECT_NE(a, b);
+    EXPECT_EQ(a, ResponseCache::makeKey("/api/articles", 1, {}));
+}
+
+TEST(ResponseCacheKeyTest, ValuesCannotForgeSeparators) {
+    auto a = ResponseCache::makeKey("/feed", 1, {{"a", "1|1:b1:2"}});
+    auto b = ResponseCache::makeKey("/feed", 1, {{"a", "1"}, {"b", "2"}});
+    EXPECT_NE(a, b);
+}
+
+// ── Store ────────────────────────────────────────────────────────────────────
+
+TEST(ResponseCacheTest, PutThenGet) {
+    ResponseCache cache(1 << 20);
+    cache.put("k", response("[1,2]"), 10s);
+    auto hit = cache.get("k");
+    ASSERT_NE(hit, nullptr);
+    EXPECT_EQ(hit->body, "[1,2]");
+    EXPECT_EQ(cache.stats().hits, 1u);
+    EXPECT_EQ(cache.stats().stores, 1u);
+}
+
+TEST(ResponseCacheTest, MissCounted) {
+    ResponseCache cache(1 << 20);
+    EXPECT_EQ(cache.get("missing"), nullptr);
+    EXPECT_EQ(cache.stats().misses, 1u);
+}
+
+TEST(ResponseCacheTest, ExpiredEntryIsDropped) {
+    ResponseCache cache(1 << 20);
+    cache.put("k", response("x"), 5ms);
+    std::this_thread::sleep_for(20ms);
+    EXPECT_EQ(cache.get("k"), nullptr);
+    EXPECT_EQ(cache.stats().entries, 0u);
+}
+
+TEST(ResponseCacheTest, ZeroBudgetDisables) {
+    ResponseCache cache(0);
+    EXPECT_FALSE(cache.enabled());
+    cache.put("k", response("x"), 10s);
+    EXPECT_EQ(cache.get("k"), nullptr);
+}
+
+TEST(ResponseCacheTest, EvictsLeastRecentlyUsedOverBudget) {
+    size_t one = 1 + 100 + 31 + ResponseCache::kEntryOverhead;
+    ResponseCache cache(one * 2, 1);
+    cache.put("a", response(std::string(100, 'a')), 10s);
+    cache.put("b", response(std::string(100, 'b')), 10s);
+    ASSERT_NE(cache.get("a"), nullptr); // b is now least recently used
+    cache.put("c", response(std::string(100, 'c')), 10s);
+    EXPECT_NE(cache.get("a"), nullptr);
+    EXPECT_EQ(cache.get("b"), nullptr);
+    EXPECT_NE(cache.get("c"), nullptr);
+    EXPECT_EQ(cache.stats().evictions, 1u);
+}
+
+// ── Surrogate keys ───────────────────────────────────────────────────────────
+
+TEST(ResponseCacheTest, PurgeInvalidatesTaggedEntriesOnly) {
+    ResponseCache cache(1 << 20);
+    auto list = ResponseCache::articleListKey(1);
+    auto other = ResponseCache::articleListKey(2);
+    cache.put("t1", response("one", cache.stamp({list})), 10s);
+    cache.put("t2", response("two", cache.stamp({other})), 10s);
+
+    cache.purge(list);
+    EXPECT_EQ(cache.get("t1"), nullptr);
+    EXPECT_NE(cache.get("t2"), nullptr);
+    EXPECT_EQ(cache.stats().purges, 1u);
+}
+
+TEST(ResponseCacheTest, AnyStampedKeyInvalidates) {
+    ResponseCache cache(1 << 20);
+    auto article = ResponseCache::articleKey(1, "home");
+    cache.put("k", response("x", cache.stamp({article, ResponseCache::articleListKey(1)})), 10s);
+    cache.purge(article);
+    EXPECT_EQ(cache.get("k"), nullptr);
+}
+
+TEST(ResponseCacheTest, PurgeDuringBuildIsNotStored) {
+    ResponseCache cache(1 << 20);
+    auto stamps = cache.stamp({ResponseCache::kCatalog});
+    // A write lands between the stamp and the store
+    cache.purge(ResponseCache::kCatalog);
+    auto entry = cache.put("catalog", response("stale", stamps), 10s);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(cache.get("catalog"), nullptr);
+    EXPECT_EQ(cache.stats().stores, 0u);
+}
+
+TEST(ResponseCacheTest, RebuiltEntryAfterPurgeIsServed) {
+    ResponseCache cache(1 << 20);
+    cache.put("k", response("old", cache.stamp({ResponseCache::kCatalog})), 10s);
+    cache.purge(ResponseCache::kCatalog);
+    cache.put("k", response("new", cache.stamp({ResponseCache::kCatalog})), 10s);
+    auto hit = cache.get("k");
+    ASSERT_NE(hit, nullptr);
+    EXPECT_EQ(hit->body, "new");
+}
+
+TEST(ResponseCacheTest, ManyPurgedKeysShareTheGenerationTable) {
+    // Purging more distinct keys than there are slots must keep working:
+    // entries stamped afterwards are current, and a purge still reaches them
+    ResponseCache cache(1 << 20);
+    for (size_t i = 0; i < 4 * ResponseCache::kGenerationSlots; ++i) {
+        cache.purge(ResponseCache::articleKey(1, "page-" + std::to_string(i)));
+    }
+    auto article = ResponseCache::articleKey(1, "home");
+    cache.put("k", response("x", cache.stamp({article})), 10s);
+    EXPECT_NE(cache.get("k"), nullptr);
+    cache.purge(article);
+    EXPECT_EQ(cache.get("k"), nullptr);
+}
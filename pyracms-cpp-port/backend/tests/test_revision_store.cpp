@@ -0,0 +1,265 @@
+#include <gtest/gtest.h>
+#include "services/RevisionDelta.h"
+#include "services/RevisionStore.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pyracms;
+
+namespace {
+
+std::string paragraph(std::mt19937 &rng, size_t words) {
+    static const std::vector<std::string> vocab = {
+        "drogon", "postgres", "article", "revision", "the", "of", "tenant",
+        "render", "cache", "server", "request", "and", "markdown", "delta"};
+    std::string out;
+    for (size_t i = 0; i < words; ++i) {
+        if (!out.empty()) out += ' ';
+        out += vocab[rng() % vocab.size()];
+    }
+    return out + "\n\n";
+}
+
+// A small edit somewhere in text: an insert, a delete or a replacement
+std::string edit(std::mt19937 &rng, std::string text) {
+    size_t at = text.empty() ? 0 : rng() % text.size();
+    switch (rng() % 3) {
+    case 0:
+        text.insert(at, paragraph(rng, 5 + rng() % 20));
+        break;
+    case 1:
+        text.erase(at, 1 + rng() % 40);
+        break;
+    default:
+        text.replace(at, std::min<size_t>(text.size() - at, 10), paragraph(rng, 3));
+    }
+    return text;
+}
+
+// Encodes history as ArticleService would, returning the rows newest first
+std::vector<RevisionStore::Row> encodeHistory(const RevisionStore &store,
+                                              const std::vector<std::string> &history) {
+    std::vector<RevisionStore::Row> rows;
+    int chain = 0;
+    for (size_t i = 0; i < history.size(); ++i) {
+        auto encoded = store.encode(history[i], i ? &history[i - 1] : nullptr, chain);
+        chain = encoded.chain;
+        RevisionStore::Row row;
+        row.id = static_cast<int>(i) + 1;
+        row.baseId = encoded.storage == RevisionStore::Storage::Delta ? static_cast<int>(i) : 0;
+        row.storage = encoded.storage;
+        row.body = std::move(encoded.body);
+        rows.push_back(std::move(row));
+    }
+    return rows;
+}
+
+// The rows rebuild() needs for revision id, as the recursive query returns
+std::vector<RevisionStore::Row> chainOf(const std::vector<RevisionStore::Row> &rows, int id) {
+    std::vector<RevisionStore::Row> chain;
+    for (int at = id; at > 0;) {
+        const auto &row = rows[at - 1];
+        chain.push_back(row);
+        if (row.storage != RevisionStore::Storage::Delta) break;
+        at = row.baseId;
+    }
+    return chain;
+}
+
+} // namespace
+
+// ── Deltas ───────────────────────────────────────────────────────────────────
+
+TEST(RevisionDeltaTest, RoundTripsRandomEdits) {
+    std::mt19937 rng(42);
+    std::string text = paragraph(rng, 400);
+    for (int i = 0; i < 200; ++i) {
+        auto next = edit(rng, text);
+        auto delta = RevisionDelta::diff(text, next);
+        std::string out;
+        ASSERT_TRUE(RevisionDelta::apply(text, delta, out)) << i;
+        ASSERT_EQ(out, next) << i;
+        text = std::move(next);
+    }
+}
+
+TEST(RevisionDeltaTest, SmallEditsGiveSmallDeltas) {
+    std::mt19937 rng(7);
+    std::string base = paragraph(rng, 2000);
+    std::string target = base;
+    target.insert(base.size() / 2, "a new sentence in the middle. ");
+
+    auto delta = RevisionDelta::diff(base, target);
+    EXPECT_LT(delta.size(), 80u);
+
+    std::string out;
+    ASSERT_TRUE(RevisionDelta::apply(base, delta, out));
+    EXPECT_EQ(out, target);
+}
+
+TEST(RevisionDeltaTest, HandlesEmptyAndUnrelatedTexts) {
+    for (auto [base, target] : std::vector<std::pair<std::string, std::string>>{
+             {"", ""}, {"", "new"}, {"old text", ""}, {"abc", "xyz"}}) {
+        std::string out = "junk";
+        ASSERT_TRUE(RevisionDelta::apply(base, RevisionDelta::diff(base, target), out));
+        EXPECT_EQ(out, target);
+    }
+}
+
+TEST(RevisionDeltaTest, RejectsCorruptDeltas) {
+    std::string base(1000, 'x');
+    for (size_t i = 0; i < base.size(); ++i) base[i] = static_cast<char>('a' + i % 26);
+    std::string target = base.substr(100) + "tail";
+    auto delta = RevisionDelta::diff(base, target);
+
+    std::string out;
+    EXPECT_FALSE(RevisionDelta::apply(base.substr(1), delta, out));
+    EXPECT_FALSE(RevisionDelta::apply(base, delta.substr(0, delta.size() - 1), out));
+    EXPECT_FALSE(RevisionDelta::apply(base, "", out));
+
+    auto badOp = delta;
+    badOp[badOp.size() - 6] = '\x07';
+    EXPECT_FALSE(RevisionDelta::apply(base, badOp, out));
+
+    // A copy past the end of the base
+    std::string pastEnd = delta.substr(0, 4);
+    pastEnd += std::string("\x01\x90\x10\x10", 4);
+    EXPECT_FALSE(RevisionDelta::apply(base, pastEnd, out));
+}
+
+// ── Encoding ─────────────────────────────────────────────────────────────────
+
+TEST(RevisionStoreTest, SnapshotsEveryIntervalRevisions) {
+    RevisionStore store({4, 3, 1 << 20});
+    std::mt19937 rng(1);
+    std::vector<std::string> history{paragraph(rng, 300)};
+    for (int i = 0; i < 11; ++i) history.push_back(edit(rng, history.back()));
+
+    auto rows = encodeHistory(store, history);
+    std::vector<RevisionStore::Storage> kinds;
+    for (const auto &row : rows) kinds.push_back(row.storage);
+    using S = RevisionStore::Storage;
+    EXPECT_EQ(kinds, (std::vector<S>{S::Snapshot, S::Delta, S::Delta, S::Delta, S::Snapshot,
+                                     S::Delta, S::Delta, S::Delta, S::Snapshot, S::Delta,
+                                     S::Delta, S::Delta}));
+}
+
+TEST(RevisionStoreTest, RewritesAreStoredAsSnapshots) {
+    RevisionStore store;
+    std::mt19937 rng(2);
+    std::string first = paragraph(rng, 200);
+    std::string second = paragraph(rng, 200);
+    auto encoded = store.encode(second, &first, 0);
+    EXPECT_EQ(encoded.storage, RevisionStore::Storage::Snapshot);
+    EXPECT_EQ(encoded.chain, 0);
+
+    std::string out;
+    ASSERT_TRUE(RevisionStore::decompress(encoded.body, out));
+    EXPECT_EQ(out, second);
+}
+
+// ── Rebuilding ───────────────────────────────────────────────────────────────
+
+TEST(RevisionStoreTest, RebuildsEveryRevision) {
+    RevisionStore store({8, 3, 1 << 20});
+    std::mt19937 rng(3);
+    std::vector<std::string> history{paragraph(rng, 500)};
+    for (int i = 0; i < 40; ++i) history.push_back(edit(rng, history.back()));
+    auto rows = encodeHistory(store, history);
+
+    for (int id = static_cast<int>(history.size()); id >= 1; --id) {
+        auto chain = chainOf(rows, id);
+        EXPECT_LE(chain.size(), 8u);
+        auto text = store.rebuild(chain);
+        ASSERT_TRUE(text) << id;
+        EXPECT_EQ(*text, history[id - 1]) << id;
+    }
+    auto stats = store.stats();
+    EXPECT_EQ(stats.failures, 0u);
+    EXPECT_GT(stats.deltasApplied, 0u);
+}
+
+TEST(RevisionStoreTest, CachedRevisionsShortenLaterRebuilds) {
+    RevisionStore store({16, 3, 1 << 20});
+    std::mt19937 rng(4);
+    std::vector<std::string> history{paragraph(rng, 500)};
+    for (int i = 0; i < 10; ++i) history.push_back(edit(rng, history.back()));
+    auto rows = encodeHistory(store, history);
+
+    ASSERT_TRUE(store.rebuild(chainOf(rows, 6)));
+    auto applied = store.stats().deltasApplied;
+    EXPECT_EQ(applied, 5u);
+    EXPECT_TRUE(store.cached(6));
+    EXPECT_TRUE(store.cached(1));
+
+    // Revision 9 stops at the cached revision 6
+    auto text = store.rebuild(chainOf(rows, 9));
+    ASSERT_TRUE(text);
+    EXPECT_EQ(*text, history[8]);
+    EXPECT_EQ(store.stats().deltasApplied - applied, 3u);
+}
+
+TEST(RevisionStoreTest, PlainRowsAnchorChains) {
+    RevisionStore store;
+    RevisionStore::Row plain;
+    plain.id = 1;
+    plain.content = "the original text";
+    EXPECT_EQ(store.rebuild({plain}), plain.content);
+
+    RevisionStore::Row delta;
+    delta.id = 2;
+    delta.baseId = 1;
+    delta.storage = RevisionStore::Storage::Delta;
+    delta.body = store.compress(RevisionDelta::diff(*plain.content, "the edited text"));
+    EXPECT_EQ(store.rebuild({delta, plain}), std::optional<std::string>("the edited text"));
+}
+
+TEST(RevisionStoreTest, BrokenChainsAndCorruptBodiesFail) {
+    RevisionStore store;
+    std::mt19937 rng(5);
+    std::vector<std::string> history{paragraph(rng, 100)};
+    for (int i = 0; i < 3; ++i) history.push_back(edit(rng, history.back()));
+    auto rows = encodeHistory(store, history);
+
+    auto chain = chainOf(rows, 4);
+    ASSERT_EQ(chain.size(), 4u);
+    EXPECT_FALSE(store.rebuild({chain[0], chain[1]}));
+    EXPECT_FALSE(store.rebuild({chain[0], chain[2], chain[3]}));
+    EXPECT_FALSE(store.rebuild({}));
+
+    auto corrupt = chain;
+    corrupt[1].body[corrupt[1].body.size() / 2] ^= 0x5a;
+    corrupt[1].body.resize(corrupt[1].body.size() - 3);
+    EXPECT_FALSE(store.rebuild(corrupt));
+    EXPECT_EQ(store.stats().failures, 4u);
+
+    std::string out;
+    EXPECT_FALSE(RevisionStore::decompress("not zstd", out));
+}
+
+TEST(RevisionStoreTest, RebuildsWholeHistories) {
+    RevisionStore store({5, 3, 1 << 20});
+    std::mt19937 rng(6);
+    std::vector<std::string> history{paragraph(rng, 300)};
+    for (int i = 0; i < 17; ++i) history.push_back(edit(rng, history.back()));
+    auto rows = encodeHistory(store, history);
+    // The newest revision keeps its text in full
+    rows.back().content = history.back();
+
+    auto texts = store.rebuildAll(rows);
+    ASSERT_EQ(texts.size(), history.size());
+    for (size_t i = 0; i < history.size(); ++i) {
+        ASSERT_TRUE(texts[i]) << i;
+        EXPECT_EQ(*texts[i], history[i]) << i;
+    }
+
+    rows[6].body = "garbage";
+    texts = store.rebuildAll(rows);
+    // Deltas up to the next snapshot are lost with it
+    EXPECT_TRUE(texts[5]);
+    for (size_t i = 6; i < 10; ++i) EXPECT_FALSE(texts[i]) << i;
+    EXPECT_EQ(*texts[10], history[10]);
+    EXPECT_EQ(store.stats().failures, 4u);
+}
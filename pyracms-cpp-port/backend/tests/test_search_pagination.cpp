@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include "services/SearchPagination.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace pyracms;
+
+namespace {
+
+SearchResultItem row(int source, int id, double rank) {
+    return SearchResultItem{SearchCursor::sourceType(source), id, "", "", "", rank, "", ""};
+}
+
+// A source's full match list in query order: rank desc, id desc
+std::vector<SearchResultItem> sortedSource(int source, std::vector<std::pair<int, double>> rows) {
+    std::vector<SearchResultItem> out;
+    for (auto [id, rank] : rows) out.push_back(row(source, id, rank));
+    std::sort(out.begin(), out.end(), [source](const auto &a, const auto &b) {
+        return rankedBefore(a, source, b, source);
+    });
+    return out;
+}
+
+// What a source's keyset query returns for the given cursor position
+SourcePage fetch(int source, const std::vector<SearchResultItem> &all,
+                 const SearchCursor::Source &after, int count) {
+    SourcePage page;
+    page.source = source;
+    for (const auto &item : all) {
+        if (after.started && !rankedBefore(row(source, after.id, after.rank), source, item, source)) {
+            continue;
+        }
+        if (static_cast<int>(page.items.size()) == count) break;
+        page.items.push_back(item);
+    }
+    page.exhausted = static_cast<int>(page.items.size()) < count;
+    return page;
+}
+
+std::vector<int> ids(const std::vector<SearchResultItem> &items) {
+    std::vector<int> out;
+    for (const auto &item : items) out.push_back(item.id);
+    return out;
+}
+
+} // namespace
+
+// ── Cursor encoding ──────────────────────────────────────────────────────────
+
+TEST(SearchCursorTest, RoundTrip) {
+    SearchCursor cursor;
+    cursor.queryHash = SearchCursor::hashQuery("drogon", "all");
+    cursor.offset = 40;
+    cursor.sources[0] = {true, false, 0.0607927, 123};
+    cursor.sources[2] = {true, true, 0, 0};
+    cursor.facets = {{"article", 1200}, {"snippet", 3}};
+
+    auto text = cursor.encode();
+    EXPECT_EQ(text.find_first_not_of(
+                  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"),
+              std::string::npos);
+
+    SearchCursor decoded;
+    ASSERT_TRUE(SearchCursor::decode(text, decoded));
+    EXPECT_EQ(decoded.queryHash, cursor.queryHash);
+    EXPECT_EQ(decoded.offset, 40);
+    EXPECT_TRUE(decoded.sources[0].started);
+    EXPECT_DOUBLE_EQ(decoded.sources[0].rank, 0.0607927);
+    EXPECT_EQ(decoded.sources[0].id, 123);
+    EXPECT_FALSE(decoded.sources[1].started);
+    EXPECT_TRUE(decoded.sources[2].exhausted);
+    EXPECT_EQ(decoded.facets, cursor.facets);
+}
+
+TEST(SearchCursorTest, RejectsMalformedInput) {
+    SearchCursor cursor;
+    cursor.offset = 20;
+    auto text = cursor.encode();
+    SearchCursor out;
+    EXPECT_FALSE(SearchCursor::decode("", out));
+    EXPECT_FALSE(SearchCursor::decode("not a cursor!", out));
+    EXPECT_FALSE(SearchCursor::decode(text.substr(0, text.size() - 2), out));
+    EXPECT_FALSE(SearchCursor::decode(text + "AAAA", out));
+    auto versioned = text;
+    versioned[0] = versioned[0] == 'B' ? 'C' : 'B';
+    EXPECT_FALSE(SearchCursor::decode(versioned, out));
+}
+
+TEST(SearchCursorTest, QueryHashSeparatesSearches) {
+    EXPECT_EQ(SearchCursor::hashQuery("a", "all"), SearchCursor::hashQuery("a", ""));
+    EXPECT_NE(SearchCursor::hashQuery("a", "article"), SearchCursor::hashQuery("a", ""));
+    EXPECT_NE(SearchCursor::hashQuery("ab", ""), SearchCursor::hashQuery("a", "b"));
+}
+
+// ── Merge ────────────────────────────────────────────────────────────────────
+
+TEST(SearchMergeTest, MergesInGlobalRankOrder) {
+    std::vector<SourcePage> pages = {
+        {0, sortedSource(0, {{1, 0.9}, {2, 0.5}, {3, 0.1}}), true},
+        {1, sortedSource(1, {{10, 0.7}, {11, 0.5}}), true},
+        {3, sortedSource(3, {{20, 0.95}}), true},
+    };
+    SearchCursor cursor;
+    auto merged = mergeSourcePages(pages, 0, 10, cursor);
+    // Equal ranks break by source, then id
+    EXPECT_EQ(ids(merged), (std::vector<int>{20, 1, 10, 2, 11, 3}));
+    EXPECT_TRUE(cursor.sources[0].exhausted);
+    EXPECT_TRUE(cursor.sources[1].exhausted);
+    EXPECT_FALSE(cursor.sources[2].started);
+}
+
+TEST(SearchMergeTest, SkipAndLimitSliceTheMergedList) {
+    std::vector<SourcePage> pages = {
+        {0, sortedSource(0, {{1, 0.9}, {2, 0.5}, {3, 0.1}}), false},
+        {1, sortedSource(1, {{10, 0.7}, {11, 0.3}, {12, 0.2}}), false},
+    };
+    SearchCursor cursor;
+    auto merged = mergeSourcePages(pages, 2, 2, cursor);
+    EXPECT_EQ(ids(merged), (std::vector<int>{2, 11}));
+    // Positions cover the skipped rows too
+    EXPECT_EQ(cursor.sources[0].id, 2);
+    EXPECT_EQ(cursor.sources[1].id, 11);
+    EXPECT_FALSE(cursor.sources[0].exhausted);
+}
+
+TEST(SearchMergeTest, PartlyConsumedExhaustedPageIsNotExhausted) {
+    std::vector<SourcePage> pages = {{0, sortedSource(0, {{1, 0.9}, {2, 0.5}}), true}};
+    SearchCursor cursor;
+    mergeSourcePages(pages, 0, 1, cursor);
+    EXPECT_FALSE(cursor.sources[0].exhausted);
+    mergeSourcePages(pages, 0, 2, cursor);
+    EXPECT_TRUE(cursor.sources[0].exhausted);
+}
+
+// Paging with cursors must visit every match exactly once, in the same
+// order as one big sorted list, even with rank ties across sources.
+TEST(SearchMergeTest, KeysetPagingMatchesFullSort) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> coarse(0, 20); // plenty of ties
+    std::vector<std::vector<SearchResultItem>> sources(SearchCursor::kSourceCount);
+    std::vector<std::pair<SearchResultItem, int>> everything;
+    for (int s = 0; s < SearchCursor::kSourceCount; ++s) {
+        std::vector<std::pair<int, double>> rows;
+        for (int id = 0; id < 30 + s * 17; ++id) rows.emplace_back(id, coarse(rng) / 20.0);
+        sources[s] = sortedSource(s, rows);
+        for (const auto &item : sources[s]) everything.emplace_back(item, s);
+    }
+    std::sort(everything.begin(), everything.end(), [](const auto &a, const auto &b) {
+        return rankedBefore(a.first, a.second, b.first, b.second);
+    });
+
+    const int limit = 7;
+    std::vector<std::pair<int, int>> seen; // (source, id)
+    SearchCursor cursor;
+    for (int pageNo = 0; pageNo < 100; ++pageNo) {
+        std::vector<SourcePage> pages;
+        for (int s = 0; s < SearchCursor::kSourceCount; ++s) {
+            if (!cursor.sources[s].exhausted) {
+                pages.push_back(fetch(s, sources[s], cursor.sources[s], limit));
+            }
+        }
+        auto merged = mergeSourcePages(pages, 0, limit, cursor);
+        for (const auto &item : merged) {
+            seen.emplace_back(SearchCursor::sourceIndex(item.type), item.id);
+        }
+        // Round-trip the cursor as a client would
+        ASSERT_TRUE(SearchCursor::decode(cursor.encode(), cursor));
+        if (merged.size() < static_cast<size_t>(limit)) break;
+    }
+
+    ASSERT_EQ(seen.size(), everything.size());
+    for (size_t i = 0; i < seen.size(); ++i) {
+        EXPECT_EQ(seen[i].first, everything[i].second) << i;
+        EXPECT_EQ(seen[i].second, everything[i].first.id) << i;
+    }
+}
+
+TEST(SearchMergeTest, FirstPageWithOffsetMatchesFullSort) {
+    std::vector<SourcePage> pages = {
+        {0, sortedSource(0, {{1, 0.8}, {2, 0.6}, {3, 0.4}, {4, 0.2}}), true},
+        {2, sortedSource(2, {{5, 0.7}, {6, 0.5}, {7, 0.3}}), true},
+    };
+    SearchCursor cursor;
+    EXPECT_EQ(ids(mergeSourcePages(pages, 3, 3, cursor)), (std::vector<int>{6, 3, 7}));
+    SearchCursor again;
+    EXPECT_EQ(ids(mergeSourcePages(pages, 6, 3, again)), std::vector<int>{4});
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "services/SearchQueryAggregator.h"
+
+#include <algorithm>
+#include <thread>
+
+using namespace pyracms;
+
+namespace {
+
+const SearchQueryAggregator::Entry *find(const std::vector<SearchQueryAggregator::Entry> &entries,
+                                         int tenantId, const std::string &query) {
+    auto it = std::find_if(entries.begin(), entries.end(), [&](const auto &e) {
+        return e.tenantId == tenantId && e.query == query;
+    });
+    return it == entries.end() ? nullptr : &*it;
+}
+
+} // namespace
+
+TEST(SearchQueryAggregatorTest, NormalizesCaseAndWhitespace) {
+    EXPECT_EQ(SearchQueryAggregator::normalize("  Hello \t  WORLD\n"), "hello world");
+    EXPECT_EQ(SearchQueryAggregator::normalize("Ünïcode Stays"), "Ünïcode stays");
+    EXPECT_EQ(SearchQueryAggregator::normalize(" \t "), "");
+}
+
+TEST(SearchQueryAggregatorTest, TruncatesOnACharacterBoundary) {
+    // 499 ASCII bytes then a two-byte character straddling the limit
+    std::string query(499, 'a');
+    query += "\xC3\xA9tail";
+    auto normalized = SearchQueryAggregator::normalize(query);
+    EXPECT_EQ(normalized, std::string(499, 'a'));
+}
+
+TEST(SearchQueryAggregatorTest, CountsSearchesPerTenantAndQuery) {
+    SearchQueryAggregator agg;
+    EXPECT_TRUE(agg.record(1, "Drogon", 10));
+    EXPECT_TRUE(agg.record(1, "drogon ", 20));
+    EXPECT_TRUE(agg.record(2, "drogon", 5));
+    EXPECT_FALSE(agg.record(1, "   ", 5));
+    EXPECT_EQ(agg.size(), 2u);
+
+    auto entries = agg.drain();
+    ASSERT_EQ(entries.size(), 2u);
+    auto *first = find(entries, 1, "drogon");
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first->searches, 2u);
+    EXPECT_EQ(first->resultSum, 30u);
+    EXPECT_EQ(find(entries, 2, "drogon")->searches, 1u);
+
+    EXPECT_EQ(agg.size(), 0u);
+    EXPECT_TRUE(agg.drain().empty());
+}
+
+TEST(SearchQueryAggregatorTest, DropsNewQueriesWhenFull) {
+    SearchQueryAggregator agg(2);
+    agg.record(1, "a", 1);
+    agg.record(1, "b", 1);
+    EXPECT_FALSE(agg.record(1, "c", 1));
+    EXPECT_TRUE(agg.record(1, "a", 1)); // buffered queries still count
+    EXPECT_EQ(agg.dropped(), 1u);
+
+    agg.drain();
+    EXPECT_TRUE(agg.record(1, "c", 1));
+}
+
+TEST(SearchQueryAggregatorTest, RestoreMergesWithNewerCounts) {
+    SearchQueryAggregator agg;
+    agg.record(1, "q", 3);
+    auto failed = agg.drain();
+    agg.record(1, "q", 4);
+    agg.restore(std::move(failed));
+
+    auto entries = agg.drain();
+    ASSERT_EQ(entries.size(), 1u);
+    EXPECT_EQ(entries[0].searches, 2u);
+    EXPECT_EQ(entries[0].resultSum, 7u);
+}
+
+TEST(SearchQueryAggregatorTest, ClassifiesFlushErrors) {
+    EXPECT_TRUE(SearchQueryAggregator::retryable(""));      // connection lost
+    EXPECT_TRUE(SearchQueryAggregator::retryable("08006")); // connection_failure
+    EXPECT_TRUE(SearchQueryAggregator::retryable("40P01")); // deadlock_detected
+    EXPECT_TRUE(SearchQueryAggregator::retryable("57P01")); // admin_shutdown
+    EXPECT_FALSE(SearchQueryAggregator::retryable("23503")); // foreign_key_violation
+    EXPECT_FALSE(SearchQueryAggregator::retryable("22001")); // string_data_right_truncation
+    EXPECT_FALSE(SearchQueryAggregator::retryable("42P01")); // undefined_table
+}
+
+TEST(SearchQueryAggregatorTest, UnknownTenantDoesNotBlockLaterFlushes) {
+    SearchQueryAggregator agg;
+    agg.record(999999, "x", 0); // no such tenant
+    agg.record(1, "a", 2);
+    // The batch fails on the tenants foreign key and is dropped, not retried
+    EXPECT_FALSE(agg.flushFailed(agg.drain(), "23503"));
+    EXPECT_EQ(agg.size(), 0u);
+
+    agg.record(1, "b", 1);
+    auto entries = agg.drain();
+    ASSERT_EQ(entries.size(), 1u);
+    EXPECT_EQ(entries[0].query, "b");
+}
+
+TEST(SearchQueryAggregatorTest, TransientFailuresAreRetried) {
+    SearchQueryAggregator agg;
+    agg.record(1, "a", 2);
+    EXPECT_TRUE(agg.flushFailed(agg.drain(), "08006"));
+    agg.record(1, "a", 3);
+
+    auto entries = agg.drain();
+    ASSERT_EQ(entries.size(), 1u);
+    EXPECT_EQ(entries[0].searches, 2u);
+    EXPECT_EQ(entries[0].resultSum, 5u);
+}
+
+TEST(SearchQueryAggregatorTest, ConcurrentRecordsAreAllCounted) {
+    SearchQueryAggregator agg;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&agg]() {
+            for (int i = 0; i < 1000; ++i) agg.record(i % 3, "query " + std::to_string(i % 50), 1);
+        });
+    }
+    for (auto &thread : threads) thread.join();
+
+    uint64_t searches = 0;
+    for (const auto &entry : agg.drain()) searches += entry.searches;
+    EXPECT_EQ(searches, 8000u);
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include "services/SnippetHighlighter.h"
+
+#include <cctype>
+#include <string>
+
+using namespace pyracms;
+
+namespace {
+
+struct Tokenized {
+    std::vector<TokenSpan> spans;
+    std::vector<std::string> tokens;
+};
+
+// Word runs of ASCII letters, as offsets into text
+Tokenized spansOf(const std::string &text) {
+    Tokenized out;
+    size_t i = 0;
+    while (i < text.size()) {
+        if (!std::isalnum(static_cast<unsigned char>(text[i])) &&
+            static_cast<unsigned char>(text[i]) < 0x80) {
+            ++i;
+            continue;
+        }
+        size_t start = i;
+        while (i < text.size() && (std::isalnum(static_cast<unsigned char>(text[i])) ||
+                                   static_cast<unsigned char>(text[i]) >= 0x80)) {
+            ++i;
+        }
+        out.spans.push_back({static_cast<uint32_t>(start), static_cast<uint32_t>(i)});
+        out.tokens.push_back(text.substr(start, i - start));
+    }
+    return out;
+}
+
+std::vector<uint32_t> positionsOf(const Tokenized &t, const std::string &token) {
+    std::vector<uint32_t> out;
+    for (size_t i = 0; i < t.tokens.size(); ++i) {
+        if (t.tokens[i] == token) out.push_back(static_cast<uint32_t>(i));
+    }
+    return out;
+}
+
+SnippetHighlighter::Options width(size_t chars) {
+    SnippetHighlighter::Options options;
+    options.snippetChars = chars;
+    return options;
+}
+
+} // namespace
+
+TEST(SnippetHighlighterTest, EscapesHtml) {
+    EXPECT_EQ(SnippetHighlighter::escapeHtml("<a href=\"x\">'&'</a>"),
+              "&lt;a href=&quot;x&quot;&gt;&#39;&amp;&#39;&lt;/a&gt;");
+}
+
+TEST(SnippetHighlighterTest, ShortBodiesAreReturnedWhole) {
+    std::string body = "one two three";
+    auto t = spansOf(body);
+    auto two = positionsOf(t, "two");
+    auto result = SnippetHighlighter::highlight(body, t.spans, {{two.data(), two.size(), 0}}, width(200));
+    EXPECT_EQ(result.snippet, body);
+    EXPECT_EQ(result.highlight, "one <mark>two</mark> three");
+}
+
+TEST(SnippetHighlighterTest, NoMatchesFallsBackToTheStart) {
+    std::string body = "alpha beta gamma delta epsilon";
+    auto t = spansOf(body);
+    auto result = SnippetHighlighter::highlight(body, t.spans, {}, width(13));
+    EXPECT_EQ(result.snippet, "alpha beta...");
+    EXPECT_EQ(result.highlight, "alpha beta...");
+}
+
+TEST(SnippetHighlighterTest, PrefersTheWindowWithMoreDistinctWords) {
+    // "cat" repeats early; the only place with both words is near the end
+    std::string body;
+    for (int i = 0; i < 10; ++i) body += "cat cat cat filler ";
+    for (int i = 0; i < 20; ++i) body += "padding ";
+    body += "a cat and a dog met";
+    auto t = spansOf(body);
+    auto cat = positionsOf(t, "cat");
+    auto dog = positionsOf(t, "dog");
+    auto result = SnippetHighlighter::highlight(
+        body, t.spans, {{cat.data(), cat.size(), 0}, {dog.data(), dog.size(), 1}}, width(40));
+    EXPECT_NE(result.highlight.find("<mark>cat</mark> and a <mark>dog</mark>"), std::string::npos);
+    EXPECT_EQ(result.snippet.rfind("...", 0), 0u);
+    EXPECT_LE(result.snippet.size(), 40u + 3);
+}
+
+TEST(SnippetHighlighterTest, CutsOnTokenAndCharacterBoundaries) {
+    std::string body = "caf\xC3\xA9 cr\xC3\xA8me br\xC3\xBBl\xC3\xA9" "e match na\xC3\xAFve r\xC3\xA9sum\xC3\xA9 end";
+    auto t = spansOf(body);
+    auto match = positionsOf(t, "match");
+    for (size_t chars = 6; chars < body.size(); ++chars) {
+        auto result = SnippetHighlighter::highlight(body, t.spans, {{match.data(), match.size(), 0}},
+                                                    width(chars));
+        EXPECT_NE(result.highlight.find("<mark>match</mark>"), std::string::npos) << chars;
+        // Every cut lands between tokens, so both ends are whole words
+        auto text = result.snippet;
+        if (text.rfind("...", 0) == 0) text = text.substr(3);
+        if (text.size() >= 3 && text.compare(text.size() - 3, 3, "...") == 0) {
+            text.resize(text.size() - 3);
+        }
+        auto inner = spansOf(text);
+        for (const auto &token : inner.tokens) {
+            EXPECT_NE((" " + body + " ").find(" " + token + " "), std::string::npos)
+                << chars << " " << token;
+        }
+    }
+}
+
+TEST(SnippetHighlighterTest, BoundsTheMatchesConsidered) {
+    std::string body;
+    for (int i = 0; i < 5000; ++i) body += "hit ";
+    body += "rare hit";
+    auto t = spansOf(body);
+    auto hit = positionsOf(t, "hit");
+    auto rare = positionsOf(t, "rare");
+    auto options = width(30);
+    options.maxMatches = 64;
+    // "rare" lies past the first 64 matches, so only the early hits are seen
+    auto result = SnippetHighlighter::highlight(
+        body, t.spans, {{hit.data(), hit.size(), 0}, {rare.data(), rare.size(), 1}}, options);
+    EXPECT_EQ(result.snippet.find("rare"), std::string::npos);
+    EXPECT_EQ(result.snippet.rfind("hit", 0), 0u);
+}
+
+TEST(SnippetHighlighterTest, PrefixExpansionsCountAsOneWord) {
+    // Two expansions of one word must not beat two different query words
+    std::string body = "drogon drop filler filler filler filler drogon loop";
+    auto t = spansOf(body);
+    auto drogon = positionsOf(t, "drogon");
+    auto drop = positionsOf(t, "drop");
+    auto loop = positionsOf(t, "loop");
+    auto result = SnippetHighlighter::highlight(
+        body, t.spans,
+        {{drogon.data(), drogon.size(), 0}, {drop.data(), drop.size(), 0}, {loop.data(), loop.size(), 1}},
+        width(12));
+    EXPECT_EQ(result.highlight, "...<mark>drogon</mark> <mark>loop</mark>");
+}
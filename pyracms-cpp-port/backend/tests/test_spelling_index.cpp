@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include "services/SpellingIndex.h"
+
+#include <string>
+#include <vector>
+
+using namespace pyracms;
+
+// ── Distance ─────────────────────────────────────────────────────────────────
+
+TEST(SpellingIndexTest, DistanceCountsTranspositionsAsOneEdit) {
+    EXPECT_EQ(SpellingIndex::distance("drogon", "drogon", 2), 0u);
+    EXPECT_EQ(SpellingIndex::distance("drogon", "dorgon", 2), 1u);
+    EXPECT_EQ(SpellingIndex::distance("drogon", "drgon", 2), 1u);
+    EXPECT_EQ(SpellingIndex::distance("drogon", "dragons", 2), 2u);
+    EXPECT_EQ(SpellingIndex::distance("drogon", "python", 2), 3u);
+    EXPECT_EQ(SpellingIndex::distance("abc", "abcdefgh", 2), 3u);
+}
+
+// ── Suggestions ──────────────────────────────────────────────────────────────
+
+TEST(SpellingIndexTest, SuggestsWordsWithinTheAllowedDistance) {
+    SpellingIndex index;
+    index.add(1, "postgres", 4);
+    index.add(1, "drogon", 2);
+    index.add(1, "game", 7);
+
+    auto s = index.suggest(1, "postgers");
+    ASSERT_TRUE(s);
+    EXPECT_EQ(s->word, "postgres");
+    EXPECT_EQ(s->distance, 1u);
+    EXPECT_EQ(s->count, 4u);
+
+    s = index.suggest(1, "drugen");
+    ASSERT_TRUE(s);
+    EXPECT_EQ(s->word, "drogon");
+    EXPECT_EQ(s->distance, 2u);
+
+    // Words of five letters or fewer get a single edit
+    s = index.suggest(1, "gmae");
+    ASSERT_TRUE(s);
+    EXPECT_EQ(s->word, "game");
+    EXPECT_FALSE(index.suggest(1, "gxmx"));
+
+    EXPECT_FALSE(index.suggest(1, "unrelated"));
+    EXPECT_FALSE(index.suggest(1, "ga"));
+}
+
+TEST(SpellingIndexTest, PrefersCloserThenMoreFrequentWords) {
+    SpellingIndex index;
+    index.add(1, "render", 1);
+    index.add(1, "tender", 5);
+    index.add(1, "renders", 50);
+
+    auto s = index.suggest(1, "rendr");
+    ASSERT_TRUE(s);
+    EXPECT_EQ(s->word, "render");
+
+    s = index.suggest(1, "xender");
+    ASSERT_TRUE(s);
+    EXPECT_EQ(s->word, "tender");
+
+    s = index.suggest(1, "render");
+    ASSERT_TRUE(s);
+    EXPECT_EQ(s->word, "render");
+    EXPECT_EQ(s->distance, 0u);
+}
+
+TEST(SpellingIndexTest, MatchesEditsBeyondThePrefix) {
+    SpellingIndex index;
+    index.add(1, "configuration");
+
+    auto s = index.suggest(1, "configuratoin");
+    ASSERT_TRUE(s);
+    EXPECT_EQ(s->word, "configuration");
+    s = index.suggest(1, "cnofiguration");
+    ASSERT_TRUE(s);
+    EXPECT_EQ(s->word, "configuration");
+}
+
+TEST(SpellingIndexTest, KeepsTenantsApartAndSharesTheSharedTenant) {
+    SpellingIndex index;
+    index.add(1, "tenantone");
+    index.add(2, "tenanttwo");
+    index.add(SpellingIndex::kSharedTenant, "tetris");
+
+    EXPECT_TRUE(index.suggest(1, "tenantine"));
+    EXPECT_FALSE(index.suggest(2, "tenantine"));
+    EXPECT_TRUE(index.contains(2, "tetris"));
+
+    auto s = index.suggest(2, "tertis");
+    ASSERT_TRUE(s);
+    EXPECT_EQ(s->word, "tetris");
+    EXPECT_TRUE(index.suggest(SpellingIndex::kSharedTenant, "tertis"));
+}
+
+TEST(SpellingIndexTest, RemovedWordsStopBeingSuggested) {
+    SpellingIndex index;
+    index.add(1, "kubernetes", 2);
+    EXPECT_EQ(index.size(), 1u);
+
+    index.remove(1, "kubernetes");
+    EXPECT_TRUE(index.contains(1, "kubernetes"));
+    index.remove(1, "kubernetes");
+    EXPECT_FALSE(index.contains(1, "kubernetes"));
+    EXPECT_FALSE(index.suggest(1, "kubernets"));
+    EXPECT_EQ(index.size(), 0u);
+
+    index.add(1, "kubernetes");
+    EXPECT_TRUE(index.suggest(1, "kubernets"));
+    EXPECT_EQ(index.size(), 1u);
+}
+
+TEST(SpellingIndexTest, FindsWordsAddedAcrossMerges) {
+    SpellingIndex index;
+    std::vector<std::string> words;
+    for (char a = 'a'; a <= 'z'; ++a) {
+        for (char b = 'a'; b <= 'z'; ++b) {
+            words.push_back(std::string("word") + a + b + "zz");
+        }
+    }
+    // Several merges of the recent deletes into the sorted array
+    for (const auto &word : words) index.add(7, word);
+    EXPECT_EQ(index.size(), words.size());
+
+    for (size_t i = 0; i < words.size(); i += 37) {
+        auto typo = words[i];
+        typo.erase(typo.size() - 1);
+        auto s = index.suggest(7, typo);
+        ASSERT_TRUE(s) << typo;
+        EXPECT_EQ(s->distance, 1u);
+        EXPECT_TRUE(index.contains(7, words[i]));
+    }
+}
+
+// ── Queries ──────────────────────────────────────────────────────────────────
+
+TEST(SpellingIndexTest, CorrectsOnlyUnknownWords) {
+    SpellingIndex index;
+    index.add(1, "postgres");
+    index.add(1, "tuning");
+    index.add(1, "guide");
+
+    EXPECT_EQ(index.correct(1, "Postgers  tunning guide"), "postgres tuning guide");
+    EXPECT_EQ(index.correct(1, "postgres tuning"), "");
+    // Unknown words without a suggestion, and non-words, are kept
+    EXPECT_EQ(index.correct(1, "postgers zzzzzz c++ v2"), "postgres zzzzzz c++ v2");
+    EXPECT_EQ(index.correct(1, "zzzzzz"), "");
+    EXPECT_EQ(index.correct(2, "postgers"), "");
+    EXPECT_EQ(index.correct(1, ""), "");
+}
+
+TEST(SpellingIndexTest, ExtractsDistinctWordsFromText) {
+    EXPECT_EQ(SpellingIndex::words("The Drogon framework, the DROGON way: v2 on x86 <b>fast</b>"),
+              (std::vector<std::string>{"drogon", "fast", "framework", "the", "way"}));
+    EXPECT_EQ(SpellingIndex::words("café naïve ok"), std::vector<std::string>{});
+    EXPECT_TRUE(SpellingIndex::words("").empty());
+    EXPECT_TRUE(SpellingIndex::isWord("abc"));
+    EXPECT_FALSE(SpellingIndex::isWord("Abc"));
+    EXPECT_FALSE(SpellingIndex::isWord(std::string(33, 'a')));
+}
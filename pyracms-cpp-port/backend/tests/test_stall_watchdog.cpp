@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "services/StallWatchdog.h"
+
+#include <deque>
+
+using namespace pyracms;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Minimal stand-in for an event loop: one thread draining a task queue
+class FakeLoop {
+public:
+    FakeLoop() : thread_([this] { run(); }) {}
+    ~FakeLoop() {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stopping_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+    }
+
+    void post(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            tasks_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mu_);
+        while (true) {
+            cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) return;
+            auto task = std::move(tasks_.front());
+            tasks_.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+uint64_t totalPings(const StallWatchdog::LoopSnapshot &loop) {
+    uint64_t n = 0;
+    for (auto c : loop.buckets) n += c;
+    return n;
+}
+
+} // namespace
+
+TEST(StallWatchdogTest, RecordsLagForHealthyLoop) {
+    FakeLoop loop;
+    StallWatchdog watchdog;
+    watchdog.addLoop("io0", [&loop](std::function<void()> f) { loop.post(std::move(f)); });
+    int stalls = 0;
+    watchdog.start(5ms, 500ms, [&stalls](const StallWatchdog::StallReport &) { ++stalls; });
+    std::this_thread::sleep_for(100ms);
+    watchdog.stop();
+
+    auto snap = watchdog.snapshot();
+    ASSERT_EQ(snap.size(), 1u);
+    EXPECT_GT(totalPings(snap[0]), 3u);
+    EXPECT_EQ(snap[0].stalls, 0u);
+    EXPECT_EQ(stalls, 0);
+}
+
+TEST(StallWatchdogTest, ReportsStallWithStackOnce) {
+    FakeLoop loop;
+    StallWatchdog watchdog;
+    watchdog.addLoop("io1", [&loop](std::function<void()> f) { loop.post(std::move(f)); });
+
+    std::mutex mu;
+    std::vector<StallWatchdog::StallReport> reports;
+    watchdog.start(5ms, 40ms, [&](const StallWatchdog::StallReport &r) {
+        std::lock_guard<std::mutex> lock(mu);
+        reports.push_back(r);
+    });
+    std::this_thread::sleep_for(30ms); // let the first ping learn the thread
+    loop.post([] {
+        auto until = std::chrono::steady_clock::now() + 200ms;
+        while (std::chrono::steady_clock::now() < until) {
+        }
+    });
+    std::this_thread::sleep_for(300ms);
+    watchdog.stop();
+
+    std::lock_guard<std::mutex> lock(mu);
+    ASSERT_EQ(reports.size(), 1u);
+    EXPECT_EQ(reports[0].loop, "io1");
+    EXPECT_GE(reports[0].stalledFor, 40ms);
+    EXPECT_FALSE(reports[0].stack.empty());
+
+    auto snap = watchdog.snapshot();
+    EXPECT_EQ(snap[0].stalls, 1u);
+    EXPECT_GE(snap[0].maxLagMicros, 100000u);
+}
+
+TEST(StallWatchdogTest, RendersPerLoopSeries) {
+    FakeLoop loop;
+    StallWatchdog watchdog;
+    watchdog.addLoop("main", [&loop](std::function<void()> f) { loop.post(std::move(f)); });
+    watchdog.start(5ms, 500ms, nullptr);
+    std::this_thread::sleep_for(30ms);
+    watchdog.stop();
+
+    auto text = watchdog.renderPrometheus();
+    EXPECT_NE(text.find("# TYPE pyracms_event_loop_lag_seconds histogram"), std::string::npos);
+    EXPECT_NE(text.find("pyracms_event_loop_lag_seconds_bucket{loop=\"main\",le=\"+Inf\"}"),
+              std::string::npos);
+    EXPECT_NE(text.find("pyracms_event_loop_stalls_total{loop=\"main\"} 0"), std::string::npos);
+}
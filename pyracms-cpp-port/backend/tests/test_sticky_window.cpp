@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include "services/StickyWindow.h"
+
+using namespace pyracms;
+using namespace std::chrono_literals;
+
+TEST(StickyWindowTest, InactiveUntilMarked) {
+    StickyWindow sticky(5s);
+    EXPECT_FALSE(sticky.active(42));
+}
+
+TEST(StickyWindowTest, ActiveWithinWindow) {
+    StickyWindow sticky(5s);
+    auto now = StickyWindow::Clock::now();
+    sticky.mark(42, now);
+    EXPECT_TRUE(sticky.active(42, now + 4s));
+    EXPECT_FALSE(sticky.active(42, now + 6s));
+}
+
+TEST(StickyWindowTest, OtherKeysUnaffected) {
+    StickyWindow sticky(5s, 1 << 16);
+    auto now = StickyWindow::Clock::now();
+    sticky.mark(1, now);
+    int collisions = 0;
+    for (uint64_t key = 2; key < 1000; ++key) collisions += sticky.active(key, now);
+    EXPECT_LT(collisions, 50);
+}
+
+TEST(StickyWindowTest, LaterMarkExtendsWindow) {
+    StickyWindow sticky(5s);
+    auto now = StickyWindow::Clock::now();
+    sticky.mark(7, now);
+    sticky.mark(7, now + 3s);
+    EXPECT_TRUE(sticky.active(7, now + 7s));
+}
+
+TEST(StickyWindowTest, EarlierMarkDoesNotShortenWindow) {
+    StickyWindow sticky(5s);
+    auto now = StickyWindow::Clock::now();
+    sticky.mark(7, now + 3s);
+    sticky.mark(7, now);
+    EXPECT_TRUE(sticky.active(7, now + 7s));
+}
+
+TEST(StickyWindowTest, ZeroWindowDisables) {
+    StickyWindow sticky(0s);
+    sticky.mark(1);
+    EXPECT_FALSE(sticky.active(1));
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "services/ViewCounter.h"
+
+#include <thread>
+#include <vector>
+
+using namespace pyracms;
+
+using Table = ViewCounter::Table;
+
+TEST(ViewCounterTest, CountsViewsPerRow) {
+    ViewCounter counter;
+    counter.record(Table::Article, 7);
+    counter.record(Table::Article, 7);
+    counter.record(Table::ForumThread, 7);
+    counter.record(Table::GameDepPage, 9, 5);
+    counter.record(Table::Article, 8, 0);
+
+    EXPECT_EQ(counter.pending(Table::Article, 7), 2);
+    EXPECT_EQ(counter.pending(Table::ForumThread, 7), 1);
+    EXPECT_EQ(counter.pending(Table::GameDepPage, 9), 5);
+    EXPECT_EQ(counter.pending(Table::Article, 8), 0);
+    EXPECT_EQ(counter.size(), 3u);
+}
+
+TEST(ViewCounterTest, DrainsInTableAndIdOrder) {
+    ViewCounter counter;
+    counter.record(Table::GameDepPage, 1);
+    counter.record(Table::Article, 30);
+    counter.record(Table::ForumThread, 2);
+    counter.record(Table::Article, 4, 3);
+
+    auto deltas = counter.drain();
+    ASSERT_EQ(deltas.size(), 4u);
+    EXPECT_EQ(deltas[0].table, Table::Article);
+    EXPECT_EQ(deltas[0].id, 4);
+    EXPECT_EQ(deltas[0].views, 3);
+    EXPECT_EQ(deltas[1].id, 30);
+    EXPECT_EQ(deltas[2].table, Table::ForumThread);
+    EXPECT_EQ(deltas[3].table, Table::GameDepPage);
+    EXPECT_EQ(counter.size(), 0u);
+    EXPECT_TRUE(counter.drain().empty());
+}
+
+TEST(ViewCounterTest, InFlightViewsStayPendingUntilCommitted) {
+    ViewCounter counter;
+    counter.record(Table::Article, 1, 4);
+    auto deltas = counter.drain();
+
+    // Views recorded during the write land in the next drain
+    counter.record(Table::Article, 1);
+    EXPECT_EQ(counter.pending(Table::Article, 1), 5);
+
+    counter.commit(deltas);
+    EXPECT_EQ(counter.pending(Table::Article, 1), 1);
+    auto next = counter.drain();
+    ASSERT_EQ(next.size(), 1u);
+    EXPECT_EQ(next[0].views, 1);
+}
+
+TEST(ViewCounterTest, FailedWritesAreDrainedAgain) {
+    ViewCounter counter;
+    counter.record(Table::ForumThread, 3, 2);
+    auto deltas = counter.drain();
+    counter.record(Table::ForumThread, 3);
+
+    counter.restore(deltas);
+    EXPECT_EQ(counter.pending(Table::ForumThread, 3), 3);
+    auto again = counter.drain();
+    ASSERT_EQ(again.size(), 1u);
+    EXPECT_EQ(again[0].views, 3);
+    counter.commit(again);
+    EXPECT_EQ(counter.pending(Table::ForumThread, 3), 0);
+}
+
+TEST(ViewCounterTest, ConcurrentViewsAreNotLost) {
+    ViewCounter counter;
+    constexpr int kThreads = 8;
+    constexpr int kViews = 20000;
+    int64_t drained = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&counter, t] {
+            for (int i = 0; i < kViews; ++i) counter.record(Table::Article, (i + t) % 50);
+        });
+    }
+    // Flushes racing the writers
+    for (int i = 0; i < 20; ++i) {
+        auto deltas = counter.drain();
+        for (const auto &d : deltas) drained += d.views;
+        counter.commit(deltas);
+    }
+    for (auto &thread : threads) thread.join();
+    for (const auto &d : counter.drain()) drained += d.views;
+    EXPECT_EQ(drained, int64_t{kThreads} * kViews);
+}
@@ -32,6 +32,7 @@ interface SearchResult {
   id: number
   title: string
   snippet: string
+  highlight?: string
   url: string
   rank: number
   createdAt: string
@@ -91,6 +92,10 @@ export default function SearchPage() {
     useState('all')
   const [page, setPage] = useState(1)
   const [loading, setLoading] = useState(false)
+  const [corrected, setCorrected] =
+    useState<{ from: string, to: string } | null>(
+      null,
+    )
 
   const performSearch = useCallback(
     async (
@@ -123,11 +128,24 @@ export default function SearchPage() {
           res.data.totalCount || 0,
         )
         setFacets(res.data.facets || {})
+        // Results are for the corrected query;
+        // later pages must ask for it
+        if (res.data.suggestion) {
+          setCorrected({
+            from: q, to: res.data.suggestion,
+          })
+          setQuery(res.data.suggestion)
+          router.replace(
+            `/search?q=${encodeURIComponent(
+              res.data.suggestion,
+            )}`,
+          )
+        }
       } catch {
         setResults([])
       }
       setLoading(false)
-    }, [],
+    }, [router],
   )
 
   useEffect(() => {
@@ -143,6 +161,7 @@ export default function SearchPage() {
 
   const handleSearch = (q: string) => {
     setQuery(q)
+    setCorrected(null)
     setPage(1)
     performSearch(q, activeType, 1)
     router.push(
@@ -201,6 +220,19 @@ export default function SearchPage() {
           </Grid>
 
           <Grid item xs={12} md={9}>
+            {corrected && (
+              <Typography
+                color="text.secondary"
+                data-testid="search-corrected"
+                sx={{ mb: 2 }}
+              >
+                {`Showing results for "${
+                  corrected.to
+                }" — no results for "${
+                  corrected.from
+                }"`}
+              </Typography>
+            )}
             {loading ? (
               <Typography
                 color="text.secondary"
@@ -329,7 +361,8 @@ export default function SearchPage() {
                             component="span"
                             dangerouslySetInnerHTML={{
                               __html:
-                                highlightMatch(
+                                r.highlight
+                                || highlightMatch(
                                   r.snippet
                                     || '',
                                   query,
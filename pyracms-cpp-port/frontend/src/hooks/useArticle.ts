@@ -28,7 +28,8 @@ export function useArticle(name: string, tenantId: number | null) {
         const a = res.data
         setArticle({
           title: a.displayName || a.name,
-          content: a.content || '',
+          // Rendered and sanitized server-side
+          content: a.html || a.content || '',
           author: a.authorUsername || 'Unknown',
           createdDate: a.createdAt?.split('T')[0] || '',
           renderer: a.rendererName || 'html',